@@ -0,0 +1,158 @@
+// Decoding benchmark for ACM and MVE files, built on demand:
+//     cmake --build . --target falltergeist_bench_audio
+//     falltergeist_bench_audio [--repeat N] [--acm file]... [--mve file]...
+// Files are given as paths in the game data (e.g. sound/music/07desert.acm, art/cuts/intro.mve).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "../src/Exception.h"
+#include "../src/Format/Acm/File.h"
+#include "../src/Format/Mve/File.h"
+#include "../src/Logger.h"
+#include "../src/ResourceManager.h"
+#include "../src/UI/MvePlayer.h"
+
+using namespace Falltergeist;
+
+namespace
+{
+    std::atomic<size_t> allocations{0};
+
+    struct Result
+    {
+        double seconds = 0;
+        size_t units = 0;
+        size_t allocations = 0;
+    };
+
+    template <typename Function>
+    Result measure(Function function)
+    {
+        Result result;
+        size_t before = allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        result.units = function();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.allocations = allocations.load() - before;
+        return result;
+    }
+
+    void report(const std::string& filename, const Result& result, const char* unit)
+    {
+        std::cout << std::left << std::setw(40) << filename << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(14) << (result.seconds > 0 ? result.units / result.seconds : 0) << ' ' << unit << "/sec"
+                  << std::setw(10) << result.allocations << " allocations" << std::endl;
+    }
+
+    size_t decodeAcm(const std::string& filename)
+    {
+        auto acm = ResourceManager::getInstance()->acmFileStream(filename);
+        if (!acm) {
+            throw Exception("Can't open " + filename);
+        }
+        std::vector<uint16_t> samples(4096);
+        size_t total = 0;
+        acm->rewind();
+        while (size_t read = acm->readSamples(samples.data(), samples.size())) {
+            total += read;
+        }
+        return total;
+    }
+
+    size_t decodeMve(const std::string& filename)
+    {
+        auto mve = ResourceManager::getInstance()->mveFileType(filename);
+        if (!mve) {
+            throw Exception("Can't open " + filename);
+        }
+        UI::MvePlayer player(mve, false);
+        // the audio has to be taken out, otherwise the queue fills up and the decoder drops samples
+        std::vector<uint8_t> audio(4096);
+        while (player.decodeTick()) {
+            while (player.getAudio(audio.data(), static_cast<uint32_t>(audio.size())) > 0) {
+            }
+        }
+        return player.frame();
+    }
+}
+
+void* operator new(size_t size)
+{
+    allocations++;
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+int main(int argc, char* argv[])
+{
+    Logger::setLevel(Logger::Level::LOG_WARNING);
+
+    std::vector<std::string> acmFiles;
+    std::vector<std::string> mveFiles;
+    int repeat = 3;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--acm") {
+            acmFiles.push_back(argv[i + 1]);
+        } else if (option == "--mve") {
+            mveFiles.push_back(argv[i + 1]);
+        } else if (option == "--repeat") {
+            repeat = std::max(1, std::atoi(argv[i + 1]));
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+    if (acmFiles.empty() && mveFiles.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--repeat N] [--acm file]... [--mve file]..." << std::endl;
+        return 1;
+    }
+
+    try {
+        // the best run is reported, the first one also pays for reading the file
+        for (auto& filename : acmFiles) {
+            Result best;
+            for (int i = 0; i < repeat; i++) {
+                auto result = measure([&filename]() { return decodeAcm(filename); });
+                if (i == 0 || result.seconds < best.seconds) {
+                    best = result;
+                }
+            }
+            report(filename, best, "samples");
+        }
+        for (auto& filename : mveFiles) {
+            Result best;
+            for (int i = 0; i < repeat; i++) {
+                auto result = measure([&filename]() { return decodeMve(filename); });
+                if (i == 0 || result.seconds < best.seconds) {
+                    best = result;
+                }
+            }
+            report(filename, best, "frames");
+        }
+    } catch (const Exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    ResourceManager::getInstance()->shutdown();
+    return 0;
+}
@@ -0,0 +1,591 @@
+// Benchmarks of engine hot paths on fixed fixtures, built on demand:
+//     cmake --build . --target falltergeist_bench
+//     falltergeist_bench [--repeat N] [--filter text] [--map name]
+// Path finding, light, combat AI, MSG and INI cases run on generated fixtures and need no game data.
+// Combat AI decisions are checked before they are timed, a wrong one fails the run.
+// DAT, FRM and script cases read fixed files of the game data, scripts are the ones of the given map (artemple by default)
+// and run in a headless game, translated ones are compared with the interpreter.
+// Cases whose name contains the --filter text are run, all of them without it.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/Exception.h"
+#include "../src/Format/Dat/Stream.h"
+#include "../src/Format/Frm/File.h"
+#include "../src/Format/Int/File.h"
+#include "../src/Format/Msg/File.h"
+#include "../src/Game/Benchmark.h"
+#include "../src/Game/CombatAI.h"
+#include "../src/Game/CritterObject.h"
+#include "../src/Game/Game.h"
+#include "../src/Game/GenericSceneryObject.h"
+#include "../src/Game/Location.h"
+#include "../src/Game/LocationElevation.h"
+#include "../src/Ini/File.h"
+#include "../src/Ini/Parser.h"
+#include "../src/Logger.h"
+#include "../src/PathFinding/DistanceField.h"
+#include "../src/PathFinding/Hexagon.h"
+#include "../src/PathFinding/HexagonGrid.h"
+#include "../src/ResourceManager.h"
+#include "../src/Settings.h"
+#include "../src/UI/ResourceManager.h"
+#include "../src/UI/TextArea.h"
+#include "../src/VFS/MemoryDriver.h"
+#include "../src/VM/NativeScripts.h"
+#include "../src/VM/Script.h"
+#include "../src/VM/Stack.h"
+#include "../src/VM/StackValue.h"
+
+using namespace Falltergeist;
+
+namespace
+{
+    std::atomic<size_t> allocations{0};
+
+    struct Result
+    {
+        double seconds = 0;
+        size_t units = 0;
+        size_t allocations = 0;
+    };
+
+    template <typename Function>
+    Result measure(Function function)
+    {
+        Result result;
+        size_t before = allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        result.units = function();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.allocations = allocations.load() - before;
+        return result;
+    }
+
+    void report(const std::string& name, const Result& result, const char* unit)
+    {
+        double units = std::max<size_t>(result.units, 1);
+        std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(14) << (result.seconds > 0 ? result.units / result.seconds : 0) << ' ' << unit << "/sec"
+                  << std::setprecision(1) << std::setw(12) << result.seconds * 1e9 / units << " ns/" << unit
+                  << std::setprecision(2) << std::setw(10) << result.allocations / units << " allocations/" << unit << std::endl;
+    }
+
+    // Deterministic across platforms, unlike the standard distributions
+    class Random
+    {
+        public:
+            explicit Random(uint32_t seed) : _state(seed)
+            {
+            }
+
+            uint32_t next(uint32_t range)
+            {
+                _state = _state * 1664525 + 1013904223;
+                return (_state >> 8) % range;
+            }
+
+        private:
+            uint32_t _state;
+    };
+
+    // Grid with scenery objects placed on it the way a location places them
+    class GridFixture
+    {
+        public:
+            Hexagon* at(unsigned int x, unsigned int y)
+            {
+                return grid.at(y * HexagonGrid::MAP_COLUMNS + x);
+            }
+
+            void block(Hexagon* hexagon)
+            {
+                auto object = _place(hexagon);
+                object->setCanWalkThru(false);
+                object->setCanLightThru(false);
+                grid.updateBlocking(hexagon);
+            }
+
+            void light(Hexagon* hexagon, unsigned int radius, unsigned int intensity)
+            {
+                auto object = _place(hexagon);
+                object->setCanWalkThru(true);
+                object->setCanLightThru(true);
+                object->setLightRadius(radius);
+                object->setLightIntensity(intensity);
+                lights.push_back(hexagon);
+            }
+
+            std::vector<Hexagon*> lights;
+            HexagonGrid grid;
+
+        private:
+            std::vector<std::unique_ptr<Game::GenericSceneryObject>> _objects;
+
+            Game::Object* _place(Hexagon* hexagon)
+            {
+                _objects.push_back(std::make_unique<Game::GenericSceneryObject>());
+                auto object = _objects.back().get();
+                object->setHexagon(hexagon);
+                hexagon->objects()->push_back(object);
+                return object;
+            }
+    };
+
+    struct Route
+    {
+        unsigned int fromX, fromY, toX, toY;
+    };
+
+    // short routes stay within the bounded search, long ones go through the cluster map
+    const std::vector<Route> ROUTES = {
+        {100, 100, 108, 104},
+        {90, 120, 110, 95},
+        {20, 20, 180, 180},
+        {180, 30, 25, 170},
+        {10, 100, 190, 100},
+    };
+
+    void fillScattered(GridFixture& fixture)
+    {
+        Random random(1);
+        for (unsigned int y = 0; y != HexagonGrid::MAP_ROWS; ++y) {
+            for (unsigned int x = 0; x != HexagonGrid::MAP_COLUMNS; ++x) {
+                if (random.next(100) < 25) {
+                    fixture.block(fixture.at(x, y));
+                }
+            }
+        }
+    }
+
+    // vertical walls every 20 columns with a gap at alternating ends, routes have to snake through all of them
+    void fillWalls(GridFixture& fixture)
+    {
+        for (unsigned int x = 15; x < HexagonGrid::MAP_COLUMNS; x += 20) {
+            bool gapAtTop = (x / 20) % 2 == 0;
+            for (unsigned int y = 0; y != HexagonGrid::MAP_ROWS; ++y) {
+                if (gapAtTop ? y > 4 : y < HexagonGrid::MAP_ROWS - 5) {
+                    fixture.block(fixture.at(x, y));
+                }
+            }
+        }
+    }
+
+    // every target walled in, each search exhausts all it may explore
+    void fillEnclosed(GridFixture& fixture)
+    {
+        for (auto& route : ROUTES) {
+            for (auto hexagon : fixture.grid.ring(fixture.at(route.toX, route.toY), 2)) {
+                if (hexagon) {
+                    fixture.block(hexagon);
+                }
+            }
+        }
+    }
+
+    // Two squads facing each other across a field with some cover
+    class SkirmishFixture
+    {
+        public:
+            SkirmishFixture() : ai(&fixture.grid)
+            {
+                Random random(4);
+                for (unsigned int y = 70; y != 130; ++y) {
+                    for (unsigned int x = 70; x != 130; ++x) {
+                        if (random.next(100) < 10) {
+                            fixture.block(fixture.at(x, y));
+                        }
+                    }
+                }
+                for (unsigned int i = 0; i != 8; ++i) {
+                    attackers.push_back(_place(fixture.at(85 + random.next(5), 85 + 4 * i)));
+                    defenders.push_back(_place(fixture.at(112 + random.next(5), 85 + 4 * i)));
+                }
+            }
+
+            GridFixture fixture;
+            Game::CombatAI ai;
+            std::vector<Game::CritterObject*> attackers;
+            std::vector<Game::CritterObject*> defenders;
+
+        private:
+            std::vector<std::unique_ptr<Game::CritterObject>> _critters;
+
+            Game::CritterObject* _place(Hexagon* hexagon)
+            {
+                _critters.push_back(std::make_unique<Game::CritterObject>());
+                auto critter = _critters.back().get();
+                critter->setHitPoints(30);
+                critter->setActionPoints(8);
+                critter->setCanWalkThru(false);
+                critter->setHexagon(hexagon);
+                hexagon->objects()->push_back(critter);
+                fixture.grid.updateBlocking(hexagon);
+                return critter;
+            }
+    };
+
+    // Decisions with enough time to finish have to pick an enemy, a hexagon within the action points
+    // and report the line of fire the grid traces from the target
+    size_t checkDecisions(SkirmishFixture& skirmish)
+    {
+        size_t failures = 0;
+        skirmish.ai.beginRound();
+        for (auto critter : skirmish.attackers) {
+            auto decision = skirmish.ai.decide(critter, skirmish.defenders, std::chrono::seconds(10));
+            auto& grid = skirmish.fixture.grid;
+            bool valid = decision.complete && decision.destination
+                && std::find(skirmish.defenders.begin(), skirmish.defenders.end(), decision.target) != skirmish.defenders.end()
+                && grid.reachable(critter, critter->hexagon(), Game::CombatAI::MAX_REACH).cost(decision.destination) <= (unsigned int) critter->actionPoints()
+                && decision.lineOfFire == (decision.destination == decision.target->hexagon() || grid.canShoot(decision.target->hexagon(), decision.destination));
+            if (!valid) {
+                std::cerr << "CombatAI decision of the critter at " << critter->hexagon()->number() << " is wrong" << std::endl;
+                failures++;
+            }
+        }
+        return failures;
+    }
+
+    size_t findPaths(GridFixture& fixture, std::vector<Hexagon*>& path)
+    {
+        for (auto& route : ROUTES) {
+            auto from = fixture.at(route.fromX, route.fromY);
+            auto to = fixture.at(route.toX, route.toY);
+            // endpoints of the scattered layout may have been blocked
+            if (fixture.grid.canWalkThru(to)) {
+                fixture.grid.findPath(from, to, path);
+            }
+        }
+        return ROUTES.size();
+    }
+
+    size_t applyLights(GridFixture& fixture)
+    {
+        for (auto hexagon : fixture.lights) {
+            fixture.grid.initLight(hexagon, true);
+        }
+        for (auto hexagon : fixture.lights) {
+            fixture.grid.initLight(hexagon, false);
+        }
+        return fixture.lights.size() * 2;
+    }
+
+    // Files handed to the parsers are served from memory, so only parsing is measured
+    class MemoryFixture
+    {
+        public:
+            void add(const std::string& name, const std::string& contents)
+            {
+                auto file = _driver.open(name, VFS::IFile::OpenMode::WriteTruncate);
+                file->write(contents.data(), static_cast<unsigned int>(contents.size()));
+            }
+
+            Format::Dat::Stream stream(const std::string& name)
+            {
+                return Format::Dat::Stream(_driver.open(name, VFS::IFile::OpenMode::Read));
+            }
+
+        private:
+            VFS::MemoryDriver _driver;
+    };
+
+    // messages are mostly numbered densely with a few gaps and outliers, like the game ones
+    std::string generateMsg(std::vector<unsigned int>& numbers)
+    {
+        Random random(2);
+        std::string contents;
+        unsigned int number = 100;
+        for (unsigned int i = 0; i != 1500; ++i) {
+            number += random.next(8) == 0 ? 2 + random.next(5) : 1;
+            numbers.push_back(number);
+            contents += "{" + std::to_string(number) + "}{}{Message number " + std::to_string(number) + ", which is about as long as most.}\r\n";
+        }
+        numbers.push_back(32020);
+        contents += "{32020}{}{Outlier}\r\n";
+        return contents;
+    }
+
+    std::string generateIni()
+    {
+        std::string contents;
+        for (unsigned int section = 0; section != 40; ++section) {
+            contents += "[section" + std::to_string(section) + "]\n";
+            contents += "; comment line\n";
+            for (unsigned int key = 0; key != 5; ++key) {
+                std::string index = std::to_string(key);
+                contents += "flag" + index + "=" + (key % 2 ? "true" : "false") + "\n";
+                contents += "count" + index + " = " + std::to_string(section * 100 + key) + "\n";
+                contents += "scale" + index + "=" + std::to_string(key) + ".5\n";
+                contents += "name" + index + "=some text value " + index + "\n";
+                contents += "list" + index + "=1,2,3," + index + "\n";
+            }
+        }
+        return contents;
+    }
+
+    std::string readFile(const std::string& name)
+    {
+        auto file = ResourceManager::getInstance()->vfs()->open(name);
+        if (!file) {
+            throw Exception("Can't open " + name);
+        }
+        std::string contents(file->size(), '\0');
+        file->seek(0, VFS::IFile::SeekFrom::Begin);
+        contents.resize(file->read(&contents[0], static_cast<unsigned int>(contents.size())));
+        return contents;
+    }
+
+    // compressed in master.dat
+    const std::vector<std::string> DAT_FILES = {
+        "maps/artemple.map",
+        "art/intrface/iface.frm",
+        "art/critters/hmjmpsaa.frm",
+        "proto/items/items.lst",
+    };
+
+    const std::vector<std::string> FRM_FILES = {
+        "art/intrface/iface.frm",
+        "art/critters/hmjmpsaa.frm",
+        "art/critters/hmjmpsab.frm",
+    };
+}
+
+void* operator new(size_t size)
+{
+    allocations++;
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+int main(int argc, char* argv[])
+{
+    Logger::setLevel(Logger::Level::LOG_WARNING);
+    // game objects of the fixtures would create the game instance without a logger
+    std::shared_ptr<ILogger> logger = std::make_shared<Logger>();
+    auto game = Game::Game::getInstance(logger);
+
+    std::string filter;
+    std::string map = "artemple";
+    int repeat = 5;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--filter") {
+            filter = argv[i + 1];
+        } else if (option == "--map") {
+            map = argv[i + 1];
+        } else if (option == "--repeat") {
+            repeat = std::max(1, std::atoi(argv[i + 1]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--repeat N] [--filter text] [--map name]" << std::endl;
+            return 1;
+        }
+    }
+
+    // the best run is reported, the first one also warms up caches
+    auto run = [&](const std::string& name, const char* unit, auto function) {
+        if (name.find(filter) == std::string::npos) {
+            return;
+        }
+        Result best;
+        for (int i = 0; i < repeat; i++) {
+            auto result = measure(function);
+            if (i == 0 || result.seconds < best.seconds) {
+                best = result;
+            }
+        }
+        report(name, best, unit);
+    };
+
+    {
+        std::vector<Hexagon*> path;
+        GridFixture open;
+        run("findPath/open", "path", [&]() { return findPaths(open, path); });
+
+        GridFixture scattered;
+        fillScattered(scattered);
+        run("findPath/scattered", "path", [&]() { return findPaths(scattered, path); });
+
+        GridFixture walls;
+        fillWalls(walls);
+        run("findPath/walls", "path", [&]() { return findPaths(walls, path); });
+
+        GridFixture enclosed;
+        fillEnclosed(enclosed);
+        run("findPath/unreachable", "path", [&]() { return findPaths(enclosed, path); });
+
+        // light sources of a lit town: lamps every few hexes among some walls
+        GridFixture lit;
+        Random random(3);
+        for (unsigned int i = 0; i != 4000; ++i) {
+            lit.block(lit.at(random.next(HexagonGrid::MAP_COLUMNS), random.next(HexagonGrid::MAP_ROWS)));
+        }
+        for (unsigned int i = 0; i != 300; ++i) {
+            lit.light(lit.at(random.next(HexagonGrid::MAP_COLUMNS), random.next(HexagonGrid::MAP_ROWS)), 2 + random.next(7), 32768 + random.next(32768));
+        }
+        run("initLight", "light", [&]() { return applyLights(lit); });
+
+        SkirmishFixture skirmish;
+        if (checkDecisions(skirmish) != 0) {
+            return 1;
+        }
+        run("CombatAI/decide", "decision", [&]() {
+            // a new round traces the lines of fire again, like every round of a fight does
+            skirmish.ai.beginRound();
+            for (auto critter : skirmish.attackers) {
+                skirmish.ai.decide(critter, skirmish.defenders);
+            }
+            return skirmish.attackers.size();
+        });
+    }
+
+    try {
+        MemoryFixture memory;
+        std::vector<unsigned int> numbers;
+        memory.add("fixture.msg", generateMsg(numbers));
+        memory.add("fixture.ini", generateIni());
+
+        run("Msg::File/parse", "file", [&]() {
+            Format::Msg::File msg(memory.stream("fixture.msg"));
+            return 1;
+        });
+        Format::Msg::File msg(memory.stream("fixture.msg"));
+        run("Msg::File::message", "lookup", [&]() {
+            size_t length = 0;
+            for (unsigned int i = 0; i != 100; ++i) {
+                for (auto number : numbers) {
+                    length += msg.message(number)->text().size();
+                }
+            }
+            return length > 0 ? numbers.size() * 100 : 0;
+        });
+
+        std::string ini = generateIni();
+        run("Ini::Parser", "file", [&]() {
+            std::istringstream stream(ini);
+            Ini::Parser parser(stream);
+            return parser.parse() ? 1 : 0;
+        });
+    } catch (const Exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    bool needsData = false;
+    for (auto name : {"Dat::Stream/inflate", "Frm::File/decode", "VM::Script/initialize"}) {
+        needsData = needsData || std::string(name).find(filter) != std::string::npos;
+    }
+    if (!needsData) {
+        return 0;
+    }
+
+    try {
+        run("Dat::Stream/inflate", "byte", [&]() {
+            size_t total = 0;
+            for (auto& name : DAT_FILES) {
+                Format::Dat::Stream stream(ResourceManager::getInstance()->vfs()->open(name));
+                total += stream.size();
+            }
+            return total;
+        });
+
+        auto palette = ResourceManager::getInstance()->palFileType("color.pal");
+        MemoryFixture memory;
+        for (auto& name : FRM_FILES) {
+            memory.add(name, readFile(name));
+        }
+        run("Frm::File/decode", "file", [&]() {
+            for (auto& name : FRM_FILES) {
+                Format::Frm::File frm(memory.stream(name));
+                frm.directions();
+                frm.rgba(palette);
+            }
+            return FRM_FILES.size();
+        });
+
+        // scripts need a location to run in, their start procedures are run again in fresh VMs
+        if (std::string("VM::Script/initialize").find(filter) != std::string::npos) {
+            auto settings = std::make_unique<Settings>();
+            settings->setHeadless(true);
+            Logger::setLevel(Logger::Level::LOG_ERROR);
+
+            game->setUIResourceManager(std::make_shared<UI::ResourceManager>());
+            game->init(std::move(settings));
+
+            auto location = Game::Benchmark(logger).load(map);
+            if (!location) {
+                throw Exception("No such map: " + map);
+            }
+            std::vector<Game::Object*> owners;
+            for (auto object : *location->elevations()->at(location->defaultElevationIndex())->objects()) {
+                if (object->script()) {
+                    owners.push_back(object);
+                }
+            }
+            run("VM::Script/initialize", "script", [&]() {
+                for (auto owner : owners) {
+                    VM::Script script(owner->script()->script(), owner);
+                    script.initialize();
+                }
+                return owners.size();
+            });
+
+            // translations compiled into the game have to leave the VM like the interpreter does
+            if (VM::NativeScripts::size() != 0) {
+                auto state = [](VM::Script& script) {
+                    std::string text = std::to_string(script.programCounter()) + ":";
+                    for (auto& value : *script.dataStack()->values()) {
+                        text += " " + value.toString();
+                    }
+                    return text;
+                };
+                size_t mismatches = 0;
+                for (auto owner : owners) {
+                    VM::NativeScripts::setEnabled(false);
+                    VM::Script interpreted(owner->script()->script(), owner);
+                    interpreted.initialize();
+                    VM::NativeScripts::setEnabled(true);
+                    VM::Script native(owner->script()->script(), owner);
+                    native.initialize();
+                    if (state(interpreted) != state(native)) {
+                        std::cerr << "Native translation differs: " << owner->script()->script()->filename() << std::endl
+                                  << "    interpreted " << state(interpreted) << std::endl
+                                  << "    native      " << state(native) << std::endl;
+                        mismatches++;
+                    }
+                }
+                if (mismatches != 0) {
+                    game->shutdown();
+                    ResourceManager::getInstance()->shutdown();
+                    return 1;
+                }
+            }
+            game->shutdown();
+        }
+    } catch (const Exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    ResourceManager::getInstance()->shutdown();
+    return 0;
+}
@@ -1,6 +1,8 @@
 #shader fragment
 #version 120
 uniform sampler2D tex;
+uniform sampler2D palette;
+uniform bool indexed;
 uniform vec4 fade;
 uniform int cnt[6];
 uniform int global_light;
@@ -16,6 +18,22 @@ bool almosteq(in float val, in float val2)
     return (val >= (val2-0.05) && val <= (val2 + 0.05));
 }
 
+// indexed textures hold palette indexes in the first channel
+// the palette holds the current colors of the animated indexes, those are not lit
+bool animatedColor;
+vec4 sampleColor(in vec2 tc)
+{
+    vec4 color = texture2D(tex, tc);
+    animatedColor = false;
+    if (indexed)
+    {
+        float index = floor(color.r * 255.0 + 0.5);
+        animatedColor = index >= 229.0 && index <= 254.0;
+        color = texture2D(palette, vec2((index + 0.5) / 256.0, 0.5));
+    }
+    return color;
+}
+
 void main(void)
 {
 
@@ -58,7 +76,7 @@ void main(void)
         fireFastPalette[3] = vec3(0.48, 0.0, 0.0);
         fireFastPalette[4] = vec3(0.27, 0.0, 0.0);
 
-    vec4 origColor = texture2D(tex, UV);
+    vec4 origColor = sampleColor(UV);
 
     if (outline == 0)
     {
@@ -110,7 +128,11 @@ void main(void)
         else
         {
 
-            if (almosteq(origColor.a,0.2) && almosteq(origColor.r, 0.6))
+            if (animatedColor)
+            {
+                origColor.a = 1.0;
+            }
+            else if (almosteq(origColor.a,0.2) && almosteq(origColor.r, 0.6))
             {
                 int index = int(origColor.b * 255.0) / 51;
 
@@ -186,11 +208,11 @@ void main(void)
         vec2 off = 1.0 / texSize;
         vec2 tc = UV.st;
 
-        vec4 c = texture2D(tex, tc);
-        vec4 n = texture2D(tex, vec2(tc.x, tc.y - off.y));
-        vec4 e = texture2D(tex, vec2(tc.x + off.x, tc.y));
-        vec4 s = texture2D(tex, vec2(tc.x, tc.y + off.y));
-        vec4 w = texture2D(tex, vec2(tc.x - off.x, tc.y));
+        vec4 c = sampleColor(tc);
+        vec4 n = sampleColor(vec2(tc.x, tc.y - off.y));
+        vec4 e = sampleColor(vec2(tc.x + off.x, tc.y));
+        vec4 s = sampleColor(vec2(tc.x, tc.y + off.y));
+        vec4 w = sampleColor(vec2(tc.x - off.x, tc.y));
 
         float ua = 0.0;
         if (c.a == 0.0 && ( n.a != 0.0 || e.a!=0.0 || s.a!=0.0 || w.a!=0.0))
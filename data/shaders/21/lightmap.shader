@@ -19,10 +19,14 @@ uniform mat4 MVP;
 attribute vec2 Position;
 attribute float lights;
 uniform vec2 offset;
+uniform float ambient;
 varying float fLight;
 
 void main(void)
 {
-  fLight = lights;
+  // hexagons lit no more than the ambient level count as unlit, lights are in percents of (65536 - 655) / 100,
+  // the added half keeps exact multiples from being rounded down
+  float light = lights <= ambient ? 655.0 : lights;
+  fLight = floor((light + 0.5) / 648.0) / 100.0;
   gl_Position = MVP*vec4(Position-offset, 0.0, 1.0);
 }
@@ -2,16 +2,20 @@
 #version 120
 
 uniform sampler2D tex;
+uniform sampler2D palette;
+uniform bool indexed;
 uniform sampler2D eggTex;
 uniform vec4 fade;
 uniform int cnt[6];
 uniform int global_light;
 uniform int trans;
 uniform bool doegg;
+// top left corner of the egg on the screen
 uniform vec2 eggpos;
 uniform int outline;
 uniform vec2 texSize;
 varying vec2 UV;
+varying vec2 ScreenPos;
 
 
 bool almosteq(in float val, in float val2)
@@ -19,6 +23,22 @@ bool almosteq(in float val, in float val2)
     return (val >= (val2-0.05) && val <= (val2 + 0.05));
 }
 
+// indexed textures hold palette indexes in the first channel
+// the palette holds the current colors of the animated indexes, those are not lit
+bool animatedColor;
+vec4 sampleColor(in vec2 tc)
+{
+    vec4 color = texture2D(tex, tc);
+    animatedColor = false;
+    if (indexed)
+    {
+        float index = floor(color.r * 255.0 + 0.5);
+        animatedColor = index >= 229.0 && index <= 254.0;
+        color = texture2D(palette, vec2((index + 0.5) / 256.0, 0.5));
+    }
+    return color;
+}
+
 void main(void)
 {
 
@@ -66,7 +86,7 @@ void main(void)
             vec3(0.27, 0.0, 0.0)
         );
 
-    vec4 origColor = texture2D(tex, UV);
+    vec4 origColor = sampleColor(UV);
 
     if (outline == 0)
     {
@@ -116,7 +136,11 @@ void main(void)
         else
         {
 
-            if (almosteq(origColor.a, 0.2) && almosteq(origColor.r, 0.6))
+            if (animatedColor)
+            {
+                origColor.a = 1.0;
+            }
+            else if (almosteq(origColor.a, 0.2) && almosteq(origColor.r, 0.6))
             {
                 int index = int(origColor.b * 255.0) / 51;
 
@@ -187,11 +211,11 @@ void main(void)
         vec2 off = 1.0 / texSize;
         vec2 tc = UV.st;
 
-        vec4 c = texture2D(tex, tc);
-        vec4 n = texture2D(tex, vec2(tc.x, tc.y - off.y));
-        vec4 e = texture2D(tex, vec2(tc.x + off.x, tc.y));
-        vec4 s = texture2D(tex, vec2(tc.x, tc.y + off.y));
-        vec4 w = texture2D(tex, vec2(tc.x - off.x, tc.y));
+        vec4 c = sampleColor(tc);
+        vec4 n = sampleColor(vec2(tc.x, tc.y - off.y));
+        vec4 e = sampleColor(vec2(tc.x + off.x, tc.y));
+        vec4 s = sampleColor(vec2(tc.x, tc.y + off.y));
+        vec4 w = sampleColor(vec2(tc.x - off.x, tc.y));
 
         float ua = 0.0;
         if (c.a == 0.0 && ( n.a != 0.0 || e.a!=0.0 || s.a!=0.0 || w.a!=0.0))
@@ -209,22 +233,12 @@ void main(void)
 
     if (doegg && outline == 0)
     {
-        float texel_x = eggpos.x * (1. / 256.0);
-        float texel_y = eggpos.y * (1. / 128.0);
-
-        vec2 pos = UV;
-        pos.x /= (256.0 / texSize.x);
-        pos.y /= (texSize.y / 128.0);
-        pos.x -= texel_x;
-        pos.y -= texel_y;
-
-        vec2 pixelpos = pos;
-        pixelpos.x *= 256.0;
-        pixelpos.y *= 128.0;
+        // the egg is tested in screen pixels, so sprites in any atlas page share it
+        vec2 pixelpos = floor(ScreenPos - eggpos);
 
         if (pixelpos.x>=0 && pixelpos.x<129 && pixelpos.y>=0 && pixelpos.y<98)
         {
-            vec4 pixel2 = texture2D(eggTex, pos);
+            vec4 pixel2 = texture2D(eggTex, (pixelpos + 0.5) / vec2(129.0, 98.0));
             if (pixel2.a < gl_FragColor.a)
             {
                 gl_FragColor.a = pixel2.a;
@@ -240,9 +254,11 @@ uniform mat4 MVP;
 attribute vec2 Position;
 attribute vec2 TexCoord;
 varying vec2 UV;
+varying vec2 ScreenPos;
 
 void main(void)
 {
   UV = TexCoord;
+  ScreenPos = Position;
   gl_Position = MVP*vec4(Position, 0.0, 1.0);
 }
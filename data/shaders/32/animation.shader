@@ -1,16 +1,36 @@
 #shader fragment
 #version 150
 uniform sampler2D tex;
+uniform sampler2D palette;
+uniform bool indexed;
 uniform vec4 fade;
 uniform int cnt[6];
 uniform int global_light;
 uniform int trans;
 uniform int outline;
+// id of the object while rendering into the picking buffer, 0 otherwise
+uniform int pick;
 uniform float texStart;
 uniform float texHeight;
 in vec2 UV;
 out vec4 fragColor;
 
+// indexed textures hold palette indexes in the red channel
+// the palette holds the current colors of the animated indexes, those are not lit
+bool animatedColor;
+vec4 sampleColor(in vec2 tc)
+{
+    vec4 color = texture(tex, tc);
+    animatedColor = false;
+    if (indexed)
+    {
+        int index = int(round(color.r * 255.0));
+        animatedColor = index >= 229 && index <= 254;
+        color = texelFetch(palette, ivec2(index, 0), 0);
+    }
+    return color;
+}
+
 void main(void)
 {
 
@@ -53,7 +73,18 @@ void main(void)
         fireFastPalette[3] = vec3(0.48, 0.0, 0.0);
         fireFastPalette[4] = vec3(0.27, 0.0, 0.0);
 
-    vec4 origColor = texture(tex, UV);
+    vec4 origColor = sampleColor(UV);
+
+    // the id is written wherever the sprite covers the screen, see Graphics::PickingPass
+    if (pick != 0)
+    {
+        if (origColor.a == 0.0)
+        {
+            discard;
+        }
+        fragColor = vec4(float(pick & 255), float((pick >> 8) & 255), float((pick >> 16) & 255), 255.0) / 255.0;
+        return;
+    }
 
     if (outline == 0)
     {
@@ -105,7 +136,11 @@ void main(void)
         else
         {
 
-            if (origColor.a == 0.2 && origColor.r == 0.6)
+            if (animatedColor)
+            {
+                origColor.a = 1.0;
+            }
+            else if (origColor.a == 0.2 && origColor.r == 0.6)
             {
                 int index = int(round(origColor.b * 255.0)) / 51;
 
@@ -182,11 +217,11 @@ void main(void)
         vec2 off = 1.0 / texSize;
         vec2 tc = UV.st;
 
-        vec4 c = texture(tex, tc);
-        vec4 n = texture(tex, vec2(tc.x, tc.y - off.y));
-        vec4 e = texture(tex, vec2(tc.x + off.x, tc.y));
-        vec4 s = texture(tex, vec2(tc.x, tc.y + off.y));
-        vec4 w = texture(tex, vec2(tc.x - off.x, tc.y));
+        vec4 c = sampleColor(tc);
+        vec4 n = sampleColor(vec2(tc.x, tc.y - off.y));
+        vec4 e = sampleColor(vec2(tc.x + off.x, tc.y));
+        vec4 s = sampleColor(vec2(tc.x, tc.y + off.y));
+        vec4 w = sampleColor(vec2(tc.x - off.x, tc.y));
 
         float ua = 0.0;
         if (c.a == 0.0 && ( n.a != 0.0 || e.a!=0.0 || s.a!=0.0 || w.a!=0.0))
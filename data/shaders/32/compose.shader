@@ -0,0 +1,81 @@
+#shader fragment
+#version 150
+
+// the frame at the game resolution
+uniform sampler2D tex;
+uniform vec2 texSize;
+// nearest neighbour unless set, xBR level 1 edges otherwise
+uniform bool xbr;
+uniform vec4 fade;
+uniform float gamma;
+in vec2 UV;
+out vec4 fragColor;
+
+vec3 pixel(ivec2 position)
+{
+    return texelFetch(tex, clamp(position, ivec2(0), ivec2(texSize) - 1), 0).rgb;
+}
+
+float distance3(vec3 a, vec3 b)
+{
+    return dot(abs(a - b), vec3(0.299, 0.587, 0.114));
+}
+
+// Corner of the pixel E closest to the output position, the neighbours are mirrored so the corner is the one
+// between F (right) and H (below). The corner takes the color across an edge running through it.
+vec3 xbrColor(vec2 position)
+{
+    ivec2 e = ivec2(floor(position));
+    vec2 offset = fract(position) - 0.5;
+    ivec2 dx = ivec2(offset.x < 0.0 ? -1 : 1, 0);
+    ivec2 dy = ivec2(0, offset.y < 0.0 ? -1 : 1);
+
+    vec3 E = pixel(e);
+    vec3 B = pixel(e - dy);
+    vec3 C = pixel(e + dx - dy);
+    vec3 D = pixel(e - dx);
+    vec3 F = pixel(e + dx);
+    vec3 G = pixel(e - dx + dy);
+    vec3 H = pixel(e + dy);
+    vec3 I = pixel(e + dx + dy);
+    vec3 F4 = pixel(e + 2 * dx);
+    vec3 I4 = pixel(e + 2 * dx + dy);
+    vec3 H5 = pixel(e + 2 * dy);
+    vec3 I5 = pixel(e + dx + 2 * dy);
+
+    float edge = distance3(E, C) + distance3(E, G) + distance3(I, H5) + distance3(I, F4) + 4.0 * distance3(H, F);
+    float across = distance3(H, D) + distance3(H, I5) + distance3(F, I4) + distance3(F, B) + 4.0 * distance3(E, I);
+    if (edge >= across || E == F || E == H)
+    {
+        return E;
+    }
+
+    vec3 corner = distance3(E, F) <= distance3(E, H) ? F : H;
+    // the part of the pixel beyond the diagonal through the corner, smoothed over an output pixel
+    float side = abs(offset.x) + abs(offset.y);
+    float width = fwidth(side);
+    return mix(E, mix(E, corner, 0.5), smoothstep(0.5 - width, 0.5 + width, side));
+}
+
+void main(void)
+{
+    vec2 position = UV * texSize;
+    vec3 color = xbr ? xbrColor(position) : pixel(ivec2(floor(position)));
+
+    color = pow(color, vec3(1.0 / gamma));
+    fragColor = vec4(mix(color, fade.rgb, fade.a), 1.0);
+}
+
+#shader vertex
+#version 150
+
+uniform mat4 MVP;
+in vec2 Position;
+in vec2 TexCoord;
+out vec2 UV;
+
+void main(void)
+{
+  UV = TexCoord;
+  gl_Position = MVP*vec4(Position, 0.0, 1.0);
+}
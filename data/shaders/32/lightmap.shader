@@ -17,13 +17,25 @@ void main(void)
 #version 150
 
 uniform mat4 MVP;
-in vec2 Position;
 in float lights;
 uniform vec2 offset;
+uniform float ambient;
 out float fLight;
 
+// vertices are the hexagons in the order of their numbers, positions follow Hexagon::positionOf()
+vec2 hexagonPosition(int number)
+{
+  int hx = number % 200;
+  int hy = number / 200;
+  int odd = hx & 1;
+  return vec2(4800 + 16*(hy + 1) - 24*hx - 8*odd, 12*(hy + 1) + 6*hx + 12 - 6*odd);
+}
+
 void main(void)
 {
-  fLight = lights;
-  gl_Position = MVP*vec4(Position-offset, 0.0, 1.0);
+  // hexagons lit no more than the ambient level count as unlit, lights are in percents of (65536 - 655) / 100,
+  // the added half keeps exact multiples from being rounded down
+  float light = lights <= ambient ? 655.0 : lights;
+  fLight = floor((light + 0.5) / 648.0) / 100.0;
+  gl_Position = MVP*vec4(hexagonPosition(gl_VertexID) - offset, 0.0, 1.0);
 }
@@ -0,0 +1,40 @@
+#shader fragment
+#version 150
+
+uniform sampler2D tex;
+uniform vec4 color;
+uniform vec4 fade;
+in vec2 UV;
+out vec4 fragColor;
+
+void main(void)
+{
+    vec2 off = 1.0 / vec2(textureSize(tex, 0));
+
+    // outside of the mask and next to it
+    if (texture(tex, UV).a != 0.0
+        || (texture(tex, vec2(UV.x, UV.y - off.y)).a == 0.0
+            && texture(tex, vec2(UV.x + off.x, UV.y)).a == 0.0
+            && texture(tex, vec2(UV.x, UV.y + off.y)).a == 0.0
+            && texture(tex, vec2(UV.x - off.x, UV.y)).a == 0.0))
+    {
+        discard;
+    }
+
+    fragColor = mix(color, fade, fade.a);
+    fragColor.a = color.a;
+}
+
+#shader vertex
+#version 150
+
+uniform mat4 MVP;
+in vec2 Position;
+in vec2 TexCoord;
+out vec2 UV;
+
+void main(void)
+{
+  UV = TexCoord;
+  gl_Position = MVP*vec4(Position, 0.0, 1.0);
+}
@@ -2,17 +2,39 @@
 #version 150
 
 uniform sampler2D tex;
+uniform sampler2D palette;
+uniform bool indexed;
 uniform sampler2D eggTex;
 uniform vec4 fade;
 uniform int cnt[6];
 uniform int global_light;
 uniform int trans;
 uniform bool doegg;
+// top left corner of the egg on the screen
 uniform vec2 eggpos;
 uniform int outline;
+// id of the object while rendering into the picking buffer, 0 otherwise
+uniform int pick;
 in vec2 UV;
+in vec2 ScreenPos;
 out vec4 fragColor;
 
+// indexed textures hold palette indexes in the red channel
+// the palette holds the current colors of the animated indexes, those are not lit
+bool animatedColor;
+vec4 sampleColor(in vec2 tc)
+{
+    vec4 color = texture(tex, tc);
+    animatedColor = false;
+    if (indexed)
+    {
+        int index = int(round(color.r * 255.0));
+        animatedColor = index >= 229 && index <= 254;
+        color = texelFetch(palette, ivec2(index, 0), 0);
+    }
+    return color;
+}
+
 void main(void)
 {
 
@@ -60,7 +82,18 @@ void main(void)
             vec3(0.27, 0.0, 0.0)
         );
 
-    vec4 origColor = texture(tex, UV);
+    vec4 origColor = sampleColor(UV);
+
+    // the id is written wherever the sprite covers the screen, see Graphics::PickingPass
+    if (pick != 0)
+    {
+        if (origColor.a == 0.0)
+        {
+            discard;
+        }
+        fragColor = vec4(float(pick & 255), float((pick >> 8) & 255), float((pick >> 16) & 255), 255.0) / 255.0;
+        return;
+    }
 
     if (outline == 0)
     {
@@ -110,7 +143,11 @@ void main(void)
         else
         {
 
-            if (origColor.a == 0.2 && origColor.r == 0.6)
+            if (animatedColor)
+            {
+                origColor.a = 1.0;
+            }
+            else if (origColor.a == 0.2 && origColor.r == 0.6)
             {
                 int index = int(round(origColor.b * 255.0)) / 51;
 
@@ -181,11 +218,11 @@ void main(void)
         vec2 off = 1.0 / texSize;
         vec2 tc = UV.st;
 
-        vec4 c = texture(tex, tc);
-        vec4 n = texture(tex, vec2(tc.x, tc.y - off.y));
-        vec4 e = texture(tex, vec2(tc.x + off.x, tc.y));
-        vec4 s = texture(tex, vec2(tc.x, tc.y + off.y));
-        vec4 w = texture(tex, vec2(tc.x - off.x, tc.y));
+        vec4 c = sampleColor(tc);
+        vec4 n = sampleColor(vec2(tc.x, tc.y - off.y));
+        vec4 e = sampleColor(vec2(tc.x + off.x, tc.y));
+        vec4 s = sampleColor(vec2(tc.x, tc.y + off.y));
+        vec4 w = sampleColor(vec2(tc.x - off.x, tc.y));
 
         float ua = 0.0;
         if (c.a == 0.0 && ( n.a != 0.0 || e.a!=0.0 || s.a!=0.0 || w.a!=0.0))
@@ -203,12 +240,8 @@ void main(void)
 
     if (doegg && outline == 0)
     {
-        ivec2 size = textureSize(tex,0);
-
-        ivec2 pixelpos = ivec2(UV.x*size.x, UV.y*size.y );
-
-        pixelpos = pixelpos-ivec2(eggpos);
-
+        // the egg is tested in screen pixels, so sprites in any atlas page share it
+        ivec2 pixelpos = ivec2(floor(ScreenPos - eggpos));
 
         if (pixelpos.x>=0 && pixelpos.x<129 && pixelpos.y>=0 && pixelpos.y<98)
         {
@@ -229,9 +262,11 @@ uniform mat4 MVP;
 in vec2 Position;
 in vec2 TexCoord;
 out vec2 UV;
+out vec2 ScreenPos;
 
 void main(void)
 {
   UV = TexCoord;
+  ScreenPos = Position;
   gl_Position = MVP*vec4(Position, 0.0, 1.0);
 }
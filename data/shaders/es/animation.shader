@@ -0,0 +1,241 @@
+#shader fragment
+#version 100
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+uniform sampler2D tex;
+uniform sampler2D palette;
+uniform bool indexed;
+uniform vec4 fade;
+uniform int cnt[6];
+uniform int global_light;
+uniform int trans;
+uniform int outline;
+uniform float texStart;
+uniform float texHeight;
+uniform vec2 texSize;
+varying vec2 UV;
+
+bool almosteq(in float val, in float val2)
+{
+    return (val >= (val2-0.05) && val <= (val2 + 0.05));
+}
+
+// GLSL ES 1.00 has no integer mod and no array constructors
+int wrap(in int value, in int count)
+{
+    return value - (value / count) * count;
+}
+
+vec3 monitorsColor(in int i)
+{
+    if (i == 0) return vec3(0.42, 0.42, 0.43);
+    if (i == 1) return vec3(0.38, 0.40, 0.49);
+    if (i == 2) return vec3(0.34, 0.42, 0.56);
+    if (i == 3) return vec3(0.00, 0.57, 0.63);
+    return vec3(0.42, 0.73, 1.00);
+}
+
+vec3 slimeColor(in int i)
+{
+    if (i == 0) return vec3(0.00, 0.42, 0.00);
+    if (i == 1) return vec3(0.04, 0.45, 0.02);
+    if (i == 2) return vec3(0.10, 0.48, 0.05);
+    return vec3(0.16, 0.51, 0.10);
+}
+
+vec3 shoreColor(in int i)
+{
+    if (i == 0) return vec3(0.32, 0.24, 0.16);
+    if (i == 1) return vec3(0.29, 0.23, 0.16);
+    if (i == 2) return vec3(0.26, 0.21, 0.15);
+    if (i == 3) return vec3(0.24, 0.20, 0.15);
+    if (i == 4) return vec3(0.21, 0.18, 0.14);
+    return vec3(0.20, 0.16, 0.14);
+}
+
+vec3 fireSlowColor(in int i)
+{
+    if (i == 0) return vec3(1.00, 0.00, 0.00);
+    if (i == 1) return vec3(0.84, 0.00, 0.00);
+    if (i == 2) return vec3(0.57, 0.16, 0.04);
+    if (i == 3) return vec3(1.00, 0.46, 0.00);
+    return vec3(1.00, 0.23, 0.00);
+}
+
+vec3 fireFastColor(in int i)
+{
+    if (i == 0) return vec3(0.27, 0.0, 0.0);
+    if (i == 1) return vec3(0.48, 0.0, 0.0);
+    if (i == 2) return vec3(0.70, 0.0, 0.0);
+    if (i == 3) return vec3(0.48, 0.0, 0.0);
+    return vec3(0.27, 0.0, 0.0);
+}
+
+// colors of RGBA textures marked as animated, cycled by cnt
+vec3 animatedRGB(in vec4 color)
+{
+    int index = int(color.b * 255.0) / 51;
+    if (index < 0) index = 0;
+    if (index > 5) index = 5;
+
+    if (almosteq(color.g, 0.0))
+    {
+        return slimeColor(wrap((index > 3 ? 3 : index) + cnt[0], 4));
+    }
+    if (almosteq(color.g, 0.2))
+    {
+        return monitorsColor(wrap((index > 4 ? 4 : index) + cnt[1], 5));
+    }
+    if (almosteq(color.g, 0.4))
+    {
+        return fireSlowColor(wrap((index > 4 ? 4 : index) + cnt[2], 5));
+    }
+    if (almosteq(color.g, 0.6))
+    {
+        return fireFastColor(wrap((index > 4 ? 4 : index) + cnt[3], 5));
+    }
+    if (almosteq(color.g, 0.8))
+    {
+        return shoreColor(wrap(index + cnt[4], 6));
+    }
+    if (almosteq(color.g, 1.0))
+    {
+        return vec3(float(cnt[5] * 4) / 255.0, 0.0, 0.0);
+    }
+    return color.rgb;
+}
+
+// indexed textures hold palette indexes in the first channel
+// the palette holds the current colors of the animated indexes, those are not lit
+bool animatedColor;
+vec4 sampleColor(in vec2 tc)
+{
+    vec4 color = texture2D(tex, tc);
+    animatedColor = false;
+    if (indexed)
+    {
+        float index = floor(color.r * 255.0 + 0.5);
+        animatedColor = index >= 229.0 && index <= 254.0;
+        color = texture2D(palette, vec2((index + 0.5) / 256.0, 0.5));
+    }
+    return color;
+}
+
+void main(void)
+{
+    vec4 origColor = sampleColor(UV);
+
+    if (outline == 0)
+    {
+        float light = float(global_light) / 100.0;
+        if (trans == 3) // glass
+        {
+            if (origColor.a > 0.0)
+            {
+                origColor.a = 0.5;
+            }
+            origColor.rgb = origColor.rgb * light;
+        }
+        else if (trans == 4) // steam
+        {
+            if (origColor.a > 0.0)
+            {
+                float gray = dot(origColor.rgb, vec3(0.21, 0.72, 0.07));
+                origColor.rgb = vec3(gray, gray, gray);
+                origColor.a = 0.75;
+            }
+            origColor.rgb = origColor.rgb * light;
+        }
+        else if (trans == 5) // energy
+        {
+            origColor.rgb = vec3(0.78, 0.78, 0.0);
+            if (origColor.a > 0.0)
+            {
+                origColor.a = 0.5;
+            }
+            origColor.rgb = origColor.rgb * light;
+        }
+        else if (trans == 6) // red
+        {
+            origColor.rgb = vec3(1.0, 0.0, 0.0);
+            if (origColor.a > 0.0)
+            {
+                origColor.a = 0.5;
+            }
+            origColor.rgb = origColor.rgb * light;
+        }
+        else if (animatedColor)
+        {
+            origColor.a = 1.0;
+        }
+        else if (almosteq(origColor.a, 0.2) && almosteq(origColor.r, 0.6))
+        {
+            origColor.rgb = animatedRGB(origColor);
+            origColor.a = 1.0;
+        }
+        else
+        {
+            // add light
+            origColor.rgb = origColor.rgb * light;
+        }
+    }
+    else
+    {
+        vec4 outlineColor = vec4(0.0, 0.0, 0.0, 0.0);
+        if (outline == 1) // red, animated
+        {
+            float texPos = UV.y - texStart;
+            float prop = texHeight / 5.0;
+            int idx = int(texPos / prop);
+            if (idx > 4) idx = 4;
+            outlineColor = vec4(fireFastColor(wrap(idx + cnt[3], 5)), 1.0);
+        }
+        else if (outline == 2) // yellow
+        {
+            outlineColor = vec4(1.0, 1.0, 0.0, 1.0);
+        }
+        else if (outline == 3) // green
+        {
+            outlineColor = vec4(0.0, 1.0, 0.0, 1.0);
+        }
+        vec2 off = 1.0 / texSize;
+        vec2 tc = UV.st;
+
+        vec4 c = sampleColor(tc);
+        vec4 n = sampleColor(vec2(tc.x, tc.y - off.y));
+        vec4 e = sampleColor(vec2(tc.x + off.x, tc.y));
+        vec4 s = sampleColor(vec2(tc.x, tc.y + off.y));
+        vec4 w = sampleColor(vec2(tc.x - off.x, tc.y));
+
+        if (c.a == 0.0 && (n.a != 0.0 || e.a != 0.0 || s.a != 0.0 || w.a != 0.0))
+        {
+            origColor = outlineColor;
+        }
+        else
+        {
+            origColor = vec4(0.0, 0.0, 0.0, 0.0);
+        }
+    }
+
+    gl_FragColor = mix(origColor, fade, fade.a);
+    gl_FragColor.a = origColor.a;
+}
+
+#shader vertex
+#version 100
+
+uniform mat4 MVP;
+uniform vec2 offset;
+attribute vec2 Position;
+attribute vec2 TexCoord;
+varying vec2 UV;
+
+void main(void)
+{
+  UV = TexCoord;
+  gl_Position = MVP*vec4(Position+offset, 0.0, 1.0);
+}
@@ -0,0 +1,25 @@
+#shader fragment
+#version 100
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+uniform vec4 color;
+
+void main(void)
+{
+  gl_FragColor = color;
+}
+
+#shader vertex
+#version 100
+
+uniform mat4 MVP;
+attribute vec2 Position;
+
+void main(void)
+{
+  gl_Position = MVP*vec4(Position, 0.0, 1.0);
+}
@@ -0,0 +1,37 @@
+#shader fragment
+#version 100
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+uniform vec4 fade;
+varying float fLight;
+
+void main(void)
+{
+   vec4 origColor = vec4(fLight/2.0+0.5, fLight/2.0+0.5, fLight/2.2+0.5, 1.0);
+
+   gl_FragColor = mix(origColor, fade, fade.a);
+   gl_FragColor.a = origColor.a;
+}
+
+#shader vertex
+#version 100
+
+uniform mat4 MVP;
+attribute vec2 Position;
+attribute float lights;
+uniform vec2 offset;
+uniform float ambient;
+varying float fLight;
+
+void main(void)
+{
+  // hexagons lit no more than the ambient level count as unlit, lights are in percents of (65536 - 655) / 100,
+  // the added half keeps exact multiples from being rounded down
+  float light = lights <= ambient ? 655.0 : lights;
+  fLight = floor((light + 0.5) / 648.0) / 100.0;
+  gl_Position = MVP*vec4(Position-offset, 0.0, 1.0);
+}
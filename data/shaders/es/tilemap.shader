@@ -0,0 +1,44 @@
+#shader fragment
+#version 100
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+// tile atlases are indexed on GLES, one byte per texel and the colors come from the palette
+uniform sampler2D tex;
+uniform sampler2D palette;
+uniform vec4 fade;
+uniform int global_light;
+varying vec2 UV;
+
+void main(void)
+{
+    float index = floor(texture2D(tex, UV).r * 255.0 + 0.5);
+    vec4 origColor = texture2D(palette, vec2((index + 0.5) / 256.0, 0.5));
+
+    // the palette holds the current colors of the animated indexes, those are not lit
+    if (index < 229.0 || index > 254.0)
+    {
+        origColor.rgb = origColor.rgb * float(global_light) / 100.0;
+    }
+
+    gl_FragColor = mix(origColor, fade, fade.a);
+    gl_FragColor.a = origColor.a;
+}
+
+#shader vertex
+#version 100
+
+uniform mat4 MVP;
+attribute vec2 Position;
+attribute vec2 TexCoord;
+uniform vec2 offset;
+varying vec2 UV;
+
+void main(void)
+{
+  UV = TexCoord;
+  gl_Position = MVP*vec4(Position-offset, 0.0, 1.0);
+}
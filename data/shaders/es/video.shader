@@ -0,0 +1,30 @@
+#shader fragment
+#version 100
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+uniform sampler2D uTexture;
+varying vec2 texturePosition;
+
+void main(void)
+{
+    gl_FragColor = texture2D(uTexture, texturePosition);
+}
+
+#shader vertex
+#version 100
+
+attribute vec2 aPosition;
+attribute vec2 aTexturePosition;
+
+uniform mat4 uProjectionMatrix;
+varying vec2 texturePosition;
+
+void main(void)
+{
+    gl_Position = uProjectionMatrix * vec4(aPosition, 0.0, 1.0);
+    texturePosition = aTexturePosition;
+}
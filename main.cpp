@@ -1,23 +1,277 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
 #include <memory>
+#include <string>
+#include <thread>
+#include "src/DataValidator.h"
+#include "src/CrossPlatform.h"
 #include "src/Exception.h"
+#include "src/Game/Benchmark.h"
 #include "src/Game/Game.h"
+#include "src/Game/Replay.h"
 #include "src/Logger.h"
+#include "src/ResourceManager.h"
 #include "src/Settings.h"
 #include "src/State/Start.h"
+#include "src/TextureBaker.h"
 #include "src/UI/ResourceManager.h"
+#include "src/VFS/DatArchiveDriver.h"
+#include "src/VFS/DatArchiveIndex.h"
+#include "src/VFS/PackedArchiveDriver.h"
 
 using namespace Falltergeist;
 
+namespace
+{
+    // falltergeist --benchmark <map> [--frames N] [--output file]
+    // Without --output the JSON report goes to stdout and only critical records are logged
+    int benchmark(std::shared_ptr<ILogger> logger, int argc, char* argv[])
+    {
+        std::string map;
+        std::string output;
+        unsigned int frames = 1000;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string option = argv[i];
+            if (option == "--benchmark") {
+                map = argv[i + 1];
+            } else if (option == "--frames") {
+                frames = static_cast<unsigned int>(std::max(1, std::atoi(argv[i + 1])));
+            } else if (option == "--output") {
+                output = argv[i + 1];
+            } else {
+                std::cerr << "Unknown option " << option << std::endl;
+                return 1;
+            }
+        }
+        if (map.empty()) {
+            std::cerr << "Usage: " << argv[0] << " --benchmark <map> [--frames N] [--output file]" << std::endl;
+            return 1;
+        }
+
+        auto settings = std::make_unique<Settings>();
+        settings->setHeadless(true);
+        settings->setVsync(false);
+        // settings apply the configured log level
+        Logger::setLevel(output.empty() ? Logger::Level::LOG_CRITICAL : Logger::Level::LOG_WARNING);
+
+        auto game = Game::Game::getInstance(logger);
+        game->setUIResourceManager(std::make_shared<UI::ResourceManager>());
+        game->init(std::move(settings));
+
+        bool found;
+        if (output.empty()) {
+            found = Game::Benchmark(logger).run(map, frames, std::cout);
+        } else {
+            std::ofstream stream(output);
+            if (!stream) {
+                std::cerr << "Can't write " << output << std::endl;
+                return 1;
+            }
+            found = Game::Benchmark(logger).run(map, frames, stream);
+        }
+        game->shutdown();
+        return found ? 0 : 1;
+    }
+
+    // falltergeist --replay <file> [--output file]
+    // Plays a session recorded with --record in the headless mode and reports its frame times like the benchmark
+    int replay(std::shared_ptr<ILogger> logger, int argc, char* argv[])
+    {
+        std::string filename;
+        std::string output;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string option = argv[i];
+            if (option == "--replay") {
+                filename = argv[i + 1];
+            } else if (option == "--output") {
+                output = argv[i + 1];
+            } else {
+                std::cerr << "Unknown option " << option << std::endl;
+                return 1;
+            }
+        }
+        Game::Replay recorded;
+        if (filename.empty() || !recorded.read(filename)) {
+            std::cerr << "Usage: " << argv[0] << " --replay <file recorded with --record> [--output file]" << std::endl;
+            return 1;
+        }
+
+        auto settings = std::make_unique<Settings>();
+        settings->setHeadless(true);
+        settings->setVsync(false);
+        settings->setSimulationRate(recorded.simulationRate());
+        Logger::setLevel(output.empty() ? Logger::Level::LOG_CRITICAL : Logger::Level::LOG_WARNING);
+
+        auto game = Game::Game::getInstance(logger);
+        game->setUIResourceManager(std::make_shared<UI::ResourceManager>());
+        game->init(std::move(settings));
+
+        if (output.empty()) {
+            Game::Benchmark(logger).replay(recorded, filename, std::cout);
+        } else {
+            std::ofstream stream(output);
+            if (!stream) {
+                std::cerr << "Can't write " << output << std::endl;
+                return 1;
+            }
+            Game::Benchmark(logger).replay(recorded, filename, stream);
+        }
+        game->shutdown();
+        return 0;
+    }
+
+    // falltergeist --validate-data [--threads N] [--output file]
+    // Parses every entry of the DAT files without starting the game, fails if any of them is broken
+    int validateData(std::shared_ptr<ILogger> logger, int argc, char* argv[])
+    {
+        std::string output;
+        unsigned int threads = std::thread::hardware_concurrency();
+        for (int i = 2; i < argc; i += 2) {
+            std::string option = argv[i];
+            if (i + 1 == argc) {
+                std::cerr << "Usage: " << argv[0] << " --validate-data [--threads N] [--output file]" << std::endl;
+                return 1;
+            } else if (option == "--threads") {
+                threads = static_cast<unsigned int>(std::max(1, std::atoi(argv[i + 1])));
+            } else if (option == "--output") {
+                output = argv[i + 1];
+            } else {
+                std::cerr << "Unknown option " << option << std::endl;
+                return 1;
+            }
+        }
+        // broken entries are listed in the report
+        Logger::setLevel(output.empty() ? Logger::Level::LOG_CRITICAL : Logger::Level::LOG_WARNING);
+
+        size_t failures;
+        if (output.empty()) {
+            failures = DataValidator(logger).run(threads, std::cout);
+        } else {
+            std::ofstream stream(output);
+            if (!stream) {
+                std::cerr << "Can't write " << output << std::endl;
+                return 1;
+            }
+            failures = DataValidator(logger).run(threads, stream);
+        }
+        return failures == 0 ? 0 : 1;
+    }
+
+    // falltergeist --bake [--threads N] [--output file]
+    // Bakes the images of the DAT files into the texture pack read by the resource manager, a JSON summary goes to stdout
+    int bake(std::shared_ptr<ILogger> logger, int argc, char* argv[])
+    {
+        std::string output;
+        unsigned int threads = std::thread::hardware_concurrency();
+        for (int i = 2; i < argc; i += 2) {
+            std::string option = argv[i];
+            if (i + 1 == argc) {
+                std::cerr << "Usage: " << argv[0] << " --bake [--threads N] [--output file]" << std::endl;
+                return 1;
+            } else if (option == "--threads") {
+                threads = static_cast<unsigned int>(std::max(1, std::atoi(argv[i + 1])));
+            } else if (option == "--output") {
+                output = argv[i + 1];
+            } else {
+                std::cerr << "Unknown option " << option << std::endl;
+                return 1;
+            }
+        }
+        Logger::setLevel(Logger::Level::LOG_WARNING);
+
+        if (output.empty()) {
+            output = ResourceManager::getInstance()->texturePackPath();
+        }
+        if (output.empty()) {
+            std::cerr << "No cache directory for the texture pack, use --output" << std::endl;
+            return 1;
+        }
+        return TextureBaker(logger).run(output, threads, std::cout) ? 0 : 1;
+    }
+
+    // falltergeist --repack-data
+    // Repacks every DAT file with LZ4 into the cache directory, the packs are mounted instead from the next start on
+    int repackData(std::shared_ptr<ILogger> logger)
+    {
+        Logger::setLevel(Logger::Level::LOG_WARNING);
+        auto resourceManager = ResourceManager::getInstance();
+
+        std::vector<std::future<std::string>> jobs;
+        for (auto& filename : CrossPlatform::findFalloutDataFiles()) {
+            std::string path = CrossPlatform::findFalloutDataPath() + "/" + filename;
+            std::string packPath = resourceManager->packedArchivePath(filename);
+            if (packPath.empty()) {
+                std::cerr << "No cache directory for the packed archives" << std::endl;
+                return 1;
+            }
+            // archives are packed concurrently, the error is returned
+            jobs.push_back(std::async(std::launch::async, [filename, path, packPath]() -> std::string {
+                try {
+                    auto started = std::chrono::steady_clock::now();
+                    auto index = VFS::DatArchiveIndex::load(path);
+                    VFS::DatArchiveDriver archive(path, index);
+                    VFS::PackedArchiveDriver::write(packPath, path, archive, index->paths());
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+                    std::cout << (filename + ": " + std::to_string(index->size()) + " files packed in " + std::to_string(seconds) + " s\n") << std::flush;
+                } catch (const Exception& e) {
+                    return filename + ": " + e.what();
+                }
+                return "";
+            }));
+        }
+
+        int result = 0;
+        for (auto& job : jobs) {
+            auto error = job.get();
+            if (!error.empty()) {
+                logger->error() << "[REPACK] " << error << std::endl;
+                result = 1;
+            }
+        }
+        return result;
+    }
+}
+
 int main(int argc, char* argv[])
 {
     std::shared_ptr<ILogger> logger = std::make_shared<Logger>();
 
     try
     {
+        if (argc > 1 && std::string(argv[1]) == "--benchmark")
+        {
+            return benchmark(logger, argc, argv);
+        }
+        if (argc > 1 && std::string(argv[1]) == "--replay")
+        {
+            return replay(logger, argc, argv);
+        }
+        if (argc > 1 && std::string(argv[1]) == "--validate-data")
+        {
+            return validateData(logger, argc, argv);
+        }
+        if (argc > 1 && std::string(argv[1]) == "--bake")
+        {
+            return bake(logger, argc, argv);
+        }
+        if (argc > 1 && std::string(argv[1]) == "--repack-data")
+        {
+            return repackData(logger);
+        }
+
         auto game = Game::Game::getInstance(logger);
         auto uiResourceManager = std::make_shared<UI::ResourceManager>();
         game->setUIResourceManager(uiResourceManager);
         game->init(std::unique_ptr<Settings>(new Settings()));
+        // falltergeist --record <file>
+        if (argc > 2 && std::string(argv[1]) == "--record")
+        {
+            game->record(argv[2]);
+        }
         game->setState(new State::Start(uiResourceManager, logger));
         game->run();
         game->shutdown();
@@ -33,4 +287,3 @@ int main(int argc, char* argv[])
     }
     return 1;
 }
-
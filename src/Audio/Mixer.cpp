@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <string>
 #include <SDL.h>
 #include "../Audio/Mixer.h"
@@ -5,6 +9,8 @@
 #include "../Exception.h"
 #include "../Format/Acm/File.h"
 #include "../Game/Game.h"
+#include "../MemoryStats.h"
+#include "../Metrics.h"
 #include "../ResourceManager.h"
 #include "../Settings.h"
 #include "../UI/MvePlayer.h"
@@ -15,19 +21,44 @@ namespace Falltergeist
     {
         using Game::Game;
 
-        Mixer::Mixer(std::shared_ptr<ILogger> logger)
+        namespace
+        {
+            // about one and a half seconds of 22050 Hz stereo
+            const size_t DECODED_SAMPLES = 65536;
+
+            // samples per channel decoded at once
+            const size_t DECODE_CHUNK = 4096;
+
+            // channels mixed at most, however many sounds are triggered
+            const int MAX_VOICES = 16;
+
+            // sounds quieter than this are not played at all
+            const float INAUDIBLE_GAIN = 0.05f;
+        }
+
+        Mixer::Mixer(std::shared_ptr<ILogger> logger) : _decoded(DECODED_SAMPLES)
         {
             this->logger = std::move(logger);
             _init();
+            _decodeBuffer.resize(DECODE_CHUNK * 2);
+            _decoder = std::thread([this]() { _decoderLoop(); });
         }
 
         Mixer::~Mixer()
         {
-            for (auto& x: _sfx)
+            Mix_HookMusic(NULL,NULL);
+            Mix_HaltChannel(-1);
+            for (auto& sound : _sfx)
             {
-                Mix_FreeChunk(x.second);
+                _freeSound(sound);
             }
-            Mix_HookMusic(NULL,NULL);
+            {
+                std::lock_guard<std::mutex> lock(_decoderMutex);
+                _decoderStopping = true;
+                _music.reset();
+            }
+            _decoderWake.notify_one();
+            _decoder.join();
             Mix_CloseAudio();
         }
 
@@ -48,13 +79,15 @@ namespace Falltergeist
                 throw Exception(Mix_GetError());
             }
             logger->info() << message + "[OK]" << std::endl;
-            int frequency = 0, channels = 0;
-            Mix_QuerySpec(&frequency, &_format, &channels);
+            Mix_QuerySpec(&_frequency, &_format, &_channels);
+            Mix_AllocateChannels(MAX_VOICES);
+            _voices.assign(MAX_VOICES, {Priority::AMBIENT, 0.0f});
+            _sfxBudget = static_cast<size_t>(Game::getInstance()->settings()->sfxCacheSize()) * 1024 * 1024;
         }
 
         void Mixer::stopMusic()
         {
-            Mix_HookMusic(NULL, NULL);
+            _startStream(nullptr, false, false, true);
         }
 
         std::function<void(void*, uint8_t*, uint32_t)> musicCallback;
@@ -64,141 +97,274 @@ namespace Falltergeist
             musicCallback(udata, stream, len);
         }
 
-        void Mixer::_musicCallback(void *udata, uint8_t *stream, uint32_t len)
+        void Mixer::_startStream(std::shared_ptr<Format::Acm::File> acm, bool mono, bool loop, bool applyVolume)
         {
-            if (_paused) {
-                return;
-            }
-
-            auto pacm = (Format::Acm::File*)(udata);
-            if (pacm->samplesLeft() <= 0)
+            // waits for a running callback, the ring buffer is not read until the stream is hooked again
+            Mix_HookMusic(NULL, NULL);
             {
-                if (_loop)
-                {
-                    pacm->rewind();
-                }
-                else
-                {
-                    Mix_HookMusic(NULL,NULL);
+                std::lock_guard<std::mutex> lock(_decoderMutex);
+                _music = std::move(acm);
+                _mono = mono;
+                _loop = loop;
+                _applyVolume = applyVolume;
+                _decoded.clear();
+                _decodingFinished = false;
+                if (!_music) {
                     return;
                 }
+                _music->rewind();
+                // the first callback shouldn't wait for the decoder thread
+                _decodeChunk();
             }
+            _decoderWake.notify_one();
+            musicCallback = std::bind(&Mixer::_streamCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+            Mix_HookMusic(myMusicPlayer, nullptr);
+        }
 
-            // music is stereo. just fetch
-            Base::Buffer<uint16_t> tmp(len / 2);
-            pacm->readSamples(tmp.data(), len / 2);
-            SDL_memset(stream, 0, len);
-            SDL_MixAudioFormat(stream, (uint8_t*)tmp.data(), _format, len, static_cast<int>(SDL_MIX_MAXVOLUME * _musicVolume));
+        void Mixer::_decoderLoop()
+        {
+            std::unique_lock<std::mutex> lock(_decoderMutex);
+            while (!_decoderStopping) {
+                if (!_music || _decodingFinished || _decoded.space() < DECODE_CHUNK * 2) {
+                    // the audio callback doesn't notify, the decoder polls for space well within the buffered time
+                    _decoderWake.wait_for(lock, std::chrono::milliseconds(10));
+                    continue;
+                }
+                _decodeChunk();
+            }
         }
 
-        void Mixer::playACMMusic(const std::string& filename, bool loop)
+        void Mixer::_decodeChunk()
         {
-            Mix_HookMusic(NULL, NULL);
-            auto acm = ResourceManager::getInstance()->acmFileType(Game::getInstance()->settings()->musicPath()+filename);
-            if (!acm) {
-                return;
+            if (_music->samplesLeft() <= 0) {
+                if (!_loop) {
+                    _decodingFinished = true;
+                    return;
+                }
+                _music->rewind();
             }
-            _lastMusic = filename;
-            _loop = loop;
-            musicCallback = std::bind(&Mixer::_musicCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
-            acm->rewind();
-            Mix_HookMusic(myMusicPlayer, (void *)acm);
+
+            size_t count = std::min(DECODE_CHUNK * 2, _decoded.space());
+            if (_mono) {
+                count = _music->readSamples(_decodeBuffer.data(), count / 2);
+                // expand in place from the back
+                for (size_t i = count; i-- > 0;) {
+                    _decodeBuffer[i * 2] = _decodeBuffer[i];
+                    _decodeBuffer[i * 2 + 1] = _decodeBuffer[i];
+                }
+                count *= 2;
+            } else {
+                count = _music->readSamples(_decodeBuffer.data(), count);
+            }
+            _decoded.write(_decodeBuffer.data(), count);
         }
 
-        void Mixer::_speechCallback(void *udata, uint8_t *stream, uint32_t len)
+        void Mixer::_streamCallback(void *udata, uint8_t *stream, uint32_t len)
         {
             if (_paused) {
                 return;
             }
 
-            auto pacm = (Format::Acm::File*)(udata);
-            if (pacm->samplesLeft() <= 0)
-            {
+            size_t samples = len / 2;
+            if (_decoded.size() == 0 && _decodingFinished) {
                 Mix_HookMusic(NULL,NULL);
                 return;
             }
 
-            Base::Buffer<uint16_t> tmp(len / 2);
-            uint16_t* sstr = (uint16_t*)stream;
-            pacm->readSamples(tmp.data(), len / 4);
-            for (size_t i = 0; i < len / 4; i++)
-            {
-                sstr[i*2] = tmp[i];
-                sstr[i*2 + 1] = tmp[i];
+            if (!_applyVolume) {
+                size_t count = _decoded.read(reinterpret_cast<uint16_t*>(stream), samples);
+                SDL_memset(stream + count * 2, 0, len - count * 2);
+                return;
+            }
+
+            if (_callbackBuffer.size() < samples) {
+                _callbackBuffer.resize(samples);
             }
+            size_t count = _decoded.read(_callbackBuffer.data(), samples);
+            SDL_memset(stream, 0, len);
+            SDL_MixAudioFormat(stream, (uint8_t*)_callbackBuffer.data(), _format, static_cast<uint32_t>(count * 2), static_cast<int>(SDL_MIX_MAXVOLUME * _musicVolume));
         }
 
-        void Mixer::playACMSpeech(const std::string& filename)
+        void Mixer::playACMMusic(const std::string& filename, bool loop)
         {
-            Mix_HookMusic(NULL, NULL);
-            auto acm = ResourceManager::getInstance()->acmFileType("sound/speech/"+filename);
+            // tracks are played once in a while and stay out of the resource cache, the stream is dropped when the next one starts
+            std::shared_ptr<Format::Acm::File> acm = ResourceManager::getInstance()->acmFileStream(Game::getInstance()->settings()->musicPath()+filename);
             if (!acm) {
+                _startStream(nullptr, false, false, false);
                 return;
             }
-            musicCallback = std::bind(&Mixer::_speechCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
-            acm->rewind();
-            Mix_HookMusic(myMusicPlayer, (void *)acm);
+            _lastMusic = filename;
+            _startStream(std::move(acm), false, loop, true);
         }
 
-        void Mixer::_movieCallback(void *udata, uint8_t *stream, uint32_t len)
+        void Mixer::playACMSpeech(const std::string& filename)
         {
-            auto pmve = (UI::MvePlayer*)(udata);
-            if (pmve->samplesLeft() <= 0)
-            {
-                logger->debug() << "[AUDIO] buffer underrun?" << std::endl;
-                Mix_HookMusic(NULL, NULL);
+            std::shared_ptr<Format::Acm::File> acm = ResourceManager::getInstance()->acmFileStream("sound/speech/"+filename);
+            if (!acm) {
+                _startStream(nullptr, false, false, false);
                 return;
             }
+            _startStream(std::move(acm), true, false, false);
+        }
 
+        void Mixer::_movieCallback(void *udata, uint8_t *stream, uint32_t len)
+        {
+            // stays hooked through underruns, the movie clock stops while silence is played
+            auto pmve = (UI::MvePlayer*)(udata);
             pmve->getAudio(stream, len);
         }
 
         void Mixer::playMovieMusic(UI::MvePlayer* mve)
         {
+            _startStream(nullptr, false, false, true);
             musicCallback = std::bind(&Mixer::_movieCallback,this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
             Mix_HookMusic(myMusicPlayer, reinterpret_cast<void *>(mve));
         }
 
         void Mixer::playACMSound(const std::string& filename)
         {
-            auto acm = ResourceManager::getInstance()->acmFileType(filename);
-            if (!acm) {
+            auto chunk = _sound(filename);
+            if (!chunk) {
                 return;
             }
-            logger->debug() << "[Mixer] playing: " << acm->filename() << std::endl;
-            Mix_Chunk *chunk = NULL;
+            logger->debug() << "[Mixer] playing: " << filename << std::endl;
+            _playVoice(chunk, Priority::INTERFACE, 1.0f, 0.0f);
+        }
 
-            auto it = _sfx.find(acm->filename());
-            if (it != _sfx.end())
-            {
-                chunk=it->second;
+        void Mixer::playACMSound(const std::string& filename, const Graphics::Point& position, Priority priority)
+        {
+            float gain = 1.0f;
+            float pan = 0.0f;
+            if (_hasListener && _listenerRange.width() > 0 && _listenerRange.height() > 0) {
+                // in view sizes, the edge of the view is 0.5 away
+                float x = static_cast<float>(position.x() - _listener.x()) / _listenerRange.width();
+                float y = static_cast<float>(position.y() - _listener.y()) / _listenerRange.height();
+                float distance = std::sqrt(x * x + y * y);
+                // full volume in view, silent a view further away
+                gain = std::min(1.0f, std::max(0.0f, 1.5f - distance));
+                // never entirely in one ear
+                pan = std::min(1.0f, std::max(-1.0f, x * 2.0f)) * 0.8f;
+            }
+            if (gain < INAUDIBLE_GAIN) {
+                return;
             }
 
-            if (!chunk)
-            {
-                auto samples = acm->samples();
+            auto chunk = _sound(filename);
+            if (!chunk) {
+                return;
+            }
+            logger->debug() << "[Mixer] playing: " << filename << " gain=" << gain << " pan=" << pan << std::endl;
+            _playVoice(chunk, priority, gain, pan);
+        }
+
+        void Mixer::setListener(const Graphics::Point& position, const Graphics::Size& range)
+        {
+            _listener = position;
+            _listenerRange = range;
+            _hasListener = true;
+        }
+
+        void Mixer::_playVoice(Mix_Chunk* chunk, Priority priority, float gain, float pan)
+        {
+            int channel = -1;
+            int victim = -1;
+            for (int i = 0; i != MAX_VOICES; ++i) {
+                if (!Mix_Playing(i)) {
+                    channel = i;
+                    break;
+                }
+                auto& voice = _voices[i];
+                if (victim < 0 || voice.priority < _voices[victim].priority
+                    || (voice.priority == _voices[victim].priority && voice.gain < _voices[victim].gain)) {
+                    victim = i;
+                }
+            }
 
-                Base::Buffer<uint16_t> tmpSamples(samples);
-                auto cnt = acm->readSamples(tmpSamples.data(), samples) * 2;
+            if (channel < 0) {
+                auto& voice = _voices[victim];
+                if (voice.priority > priority || (voice.priority == priority && voice.gain >= gain)) {
+                    logger->debug() << "[Mixer] all channels are busy with more important sounds" << std::endl;
+                    return;
+                }
+                Mix_HaltChannel(victim);
+                channel = victim;
+            }
 
-                SDL_AudioCVT cvt;
-                SDL_BuildAudioCVT(&cvt, AUDIO_S16LSB, 1, 22050, AUDIO_S16LSB, 2, 22050); //convert from mono to stereo
+            _voices[channel] = {priority, gain};
+            Mix_Volume(channel, static_cast<int>(MIX_MAX_VOLUME * gain));
+            Mix_SetPanning(channel,
+                static_cast<Uint8>(255 * std::min(1.0f, 1.0f - pan)),
+                static_cast<Uint8>(255 * std::min(1.0f, 1.0f + pan)));
+            Mix_PlayChannel(channel, chunk, 0);
+        }
 
-                cvt.buf = (Uint8*)malloc(cnt * cvt.len_mult);
-                memcpy(cvt.buf, tmpSamples.data(), cnt);
-                cvt.len = static_cast<int>(cnt);
-                SDL_ConvertAudio(&cvt);
+        void Mixer::preloadACMSound(const std::string& filename)
+        {
+            _sound(filename);
+        }
 
-                // make SDL_mixer chunk
-                chunk = Mix_QuickLoad_RAW(cvt.buf, static_cast<uint32_t>(cvt.len * cvt.len_ratio));
-                // TODO: make this configurable
-                if (_sfx.size() > 100) {
-                    Mix_FreeChunk(_sfx.begin()->second);
-                    _sfx.erase(_sfx.begin());
+        Mix_Chunk* Mixer::_sound(const std::string& filename)
+        {
+            static auto& hits = Metrics::counter("sounds.hits");
+            static auto& misses = Metrics::counter("sounds.misses");
+            auto it = _sfxIndex.find(filename);
+            if (it != _sfxIndex.end()) {
+                if (Metrics::enabled()) {
+                    hits.add();
                 }
-                _sfx.insert(std::pair<std::string, Mix_Chunk*>(acm->filename(), chunk));
+                _sfx.splice(_sfx.begin(), _sfx, it->second);
+                return it->second->chunk;
+            }
+            if (Metrics::enabled()) {
+                misses.add();
             }
-            Mix_PlayChannel(-1, chunk, 0);
+
+            // the decoded samples are cached below, the compressed file isn't kept
+            auto acm = ResourceManager::getInstance()->acmFileStream(filename);
+            if (!acm || acm->samples() <= 0) {
+                return nullptr;
+            }
+
+            // sound effects are mono 22050 Hz, converted once into the format of the device
+            SDL_AudioCVT cvt;
+            if (SDL_BuildAudioCVT(&cvt, AUDIO_S16LSB, 1, 22050, _format, static_cast<Uint8>(_channels), _frequency) < 0) {
+                logger->error() << "[Mixer] can't convert " << filename << ": " << SDL_GetError() << std::endl;
+                return nullptr;
+            }
+
+            acm->rewind();
+            size_t bytes = static_cast<size_t>(acm->samples()) * 2;
+            cvt.buf = static_cast<Uint8*>(malloc(bytes * cvt.len_mult));
+            cvt.len = static_cast<int>(acm->readSamples(reinterpret_cast<uint16_t*>(cvt.buf), acm->samples()) * 2);
+            if (SDL_ConvertAudio(&cvt) < 0) {
+                logger->error() << "[Mixer] can't convert " << filename << ": " << SDL_GetError() << std::endl;
+                free(cvt.buf);
+                return nullptr;
+            }
+
+            Sound sound = {filename, Mix_QuickLoad_RAW(cvt.buf, static_cast<uint32_t>(cvt.len_cvt)), cvt.buf, static_cast<size_t>(cvt.len_cvt)};
+            _sfx.push_front(sound);
+            _sfxIndex[filename] = _sfx.begin();
+            _sfxBytes += sound.bytes;
+            MemoryStats::add(MemoryStats::Category::SOUNDS, sound.bytes);
+
+            // the new sound stays even if it alone exceeds the budget
+            while (_sfxBytes > _sfxBudget && _sfx.size() > 1) {
+                auto& victim = _sfx.back();
+                _sfxBytes -= victim.bytes;
+                _sfxIndex.erase(victim.filename);
+                _freeSound(victim);
+                _sfx.pop_back();
+            }
+            return sound.chunk;
+        }
+
+        void Mixer::_freeSound(Sound& sound)
+        {
+            // halts the channels still playing it
+            Mix_FreeChunk(sound.chunk);
+            free(sound.samples);
+            MemoryStats::remove(MemoryStats::Category::SOUNDS, sound.bytes);
         }
 
         void Mixer::stopSounds()
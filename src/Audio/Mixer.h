@@ -1,14 +1,30 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 #include <SDL_mixer.h>
+#include "../Base/RingBuffer.h"
+#include "../Graphics/Point.h"
+#include "../Graphics/Size.h"
 #include "../ILogger.h"
 
 namespace Falltergeist
 {
+    namespace Format
+    {
+        namespace Acm
+        {
+            class File;
+        }
+    }
     namespace UI
     {
         class MvePlayer;
@@ -18,6 +34,14 @@ namespace Falltergeist
         class Mixer
         {
             public:
+                // Which sound keeps its channel when all of them are taken
+                enum class Priority
+                {
+                    AMBIENT = 0,
+                    WORLD,
+                    INTERFACE
+                };
+
                 Mixer(std::shared_ptr<ILogger> logger);
                 ~Mixer();
                 void stopMusic();
@@ -25,6 +49,12 @@ namespace Falltergeist
                 void playACMMusic(const std::string& filename, bool loop = false);
                 void playACMSpeech(const std::string& filename);
                 void playACMSound(const std::string& filename);
+                // Plays a sound of the map, attenuated and panned by its distance to the listener (in map pixels)
+                void playACMSound(const std::string& filename, const Graphics::Point& position, Priority priority = Priority::WORLD);
+                // Center and size of the view positional sounds are heard from
+                void setListener(const Graphics::Point& position, const Graphics::Size& range);
+                // Decodes a sound effect into the cache without playing it
+                void preloadACMSound(const std::string& filename);
                 void playMovieMusic(UI::MvePlayer* mve);
                 void pauseMusic();
                 void resumeMusic();
@@ -41,15 +71,70 @@ namespace Falltergeist
 
             private:
                 void _init();
-                void _musicCallback(void* udata, uint8_t* stream, uint32_t len);
-                void _speechCallback(void* udata, uint8_t* stream, uint32_t len);
+                // Plays music and speech decoded ahead by the decoder thread
+                void _streamCallback(void* udata, uint8_t* stream, uint32_t len);
                 void _movieCallback(void* udata, uint8_t* stream, uint32_t len);
-                std::unordered_map<std::string, Mix_Chunk*> _sfx;
-                bool _paused = false;
+                // Replaces the music or speech, nullptr stops it
+                void _startStream(std::shared_ptr<Format::Acm::File> acm, bool mono, bool loop, bool applyVolume);
+                void _decoderLoop();
+                // Decodes the next samples of _music into _decoded, _decoderMutex has to be locked
+                void _decodeChunk();
+                struct Sound
+                {
+                    std::string filename;
+                    Mix_Chunk* chunk;
+                    // converted samples, not owned by the chunk
+                    uint8_t* samples;
+                    size_t bytes;
+                };
+                // Returns the cached or newly decoded sound effect, nullptr if it can't be loaded
+                Mix_Chunk* _sound(const std::string& filename);
+                void _freeSound(Sound& sound);
+
+                struct Voice
+                {
+                    Priority priority;
+                    float gain;
+                };
+                // by channel; when they are all taken a new sound replaces the least important one or is dropped
+                std::vector<Voice> _voices;
+                Graphics::Point _listener;
+                Graphics::Size _listenerRange;
+                bool _hasListener = false;
+                // pan from -1 (left) to 1 (right)
+                void _playVoice(Mix_Chunk* chunk, Priority priority, float gain, float pan);
+                // most recently played first
+                std::list<Sound> _sfx;
+                std::unordered_map<std::string, std::list<Sound>::iterator> _sfxIndex;
+                size_t _sfxBytes = 0;
+                size_t _sfxBudget = 0;
+                // Music or speech which is being played, pinned in the resource cache
+                std::shared_ptr<Format::Acm::File> _music;
+                std::atomic<bool> _paused{false};
                 bool _loop = false;
+                // speech is mono, the decoder duplicates it into both channels
+                bool _mono = false;
+                // speech is played at full volume
+                bool _applyVolume = true;
+
+                // interleaved stereo samples, written by the decoder thread and read by the audio callback
+                Base::RingBuffer<uint16_t> _decoded;
+                // set by the decoder when it reached the end of a stream which doesn't loop
+                std::atomic<bool> _decodingFinished{false};
+                std::thread _decoder;
+                // guards _music and the stream settings against the decoder thread
+                std::mutex _decoderMutex;
+                std::condition_variable _decoderWake;
+                bool _decoderStopping = false;
+                // decoder scratch buffer
+                std::vector<uint16_t> _decodeBuffer;
+                // audio callback scratch buffer, sized by the first callback
+                std::vector<uint16_t> _callbackBuffer;
 
                 double _musicVolume = 1.0;
                 SDL_AudioFormat _format;
+                int _frequency = 0;
+                int _channels = 0;
                 std::string _lastMusic = "";
                 std::shared_ptr<ILogger> logger;
         };
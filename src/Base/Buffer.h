@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstddef>
+#include <type_traits>
+#include "../Base/ScratchPool.h"
 
 namespace Falltergeist
 {
@@ -9,25 +11,29 @@ namespace Falltergeist
         // A thin wrapper over plain C-array.
         // Handles allocation and deallocation of the underlying buffer.
         // Does not perform any kind of initialization of allocated memory.
+        // Memory comes from the ScratchPool of the thread, so buffers of decoders created one after another reuse it.
         template <typename T>
         class Buffer
         {
+            static_assert(std::is_trivial<T>::value, "Buffer memory is not initialized");
+
             public:
                 // Creates new empty buffer
-                Buffer<T>() : _size(0), _buf(nullptr)
+                Buffer<T>() : _size(0), _bytes(0), _buf(nullptr)
                 {
                 }
 
                 // Creates new buffer with given size
-                Buffer<T>(size_t size) : _size(size)
+                Buffer<T>(size_t size) : _size(0), _bytes(0), _buf(nullptr)
                 {
-                    _buf = new T[size];
+                    resize(size);
                 }
 
                 // Constructs by moving buffer pointer from another Buffer object
-                Buffer<T>(Buffer<T>&& other) : _size(other._size), _buf(other._buf)
+                Buffer<T>(Buffer<T>&& other) : _size(other._size), _bytes(other._bytes), _buf(other._buf)
                 {
                     other._size = 0;
+                    other._bytes = 0;
                     other._buf = nullptr;
                 }
 
@@ -36,8 +42,10 @@ namespace Falltergeist
                 {
                     _cleanUpBuffer();
                     _size = other._size;
+                    _bytes = other._bytes;
                     _buf = other._buf;
                     other._size = 0;
+                    other._bytes = 0;
                     other._buf = nullptr;
                     return *this;
                 }
@@ -72,18 +80,20 @@ namespace Falltergeist
                 }
 
                 // Reallocate the underlying buffer to the specified size
-                // All data in buffer will be discarded
+                // All data in buffer will be discarded. The memory is kept if it is big enough already
                 void resize(size_t newSize)
                 {
+                    if (newSize > 0 && newSize * sizeof(T) <= _bytes)
+                    {
+                        _size = newSize;
+                        return;
+                    }
                     _cleanUpBuffer();
                     _size = newSize;
                     if (newSize > 0)
                     {
-                        _buf = new T[newSize];
-                    }
-                    else
-                    {
-                        _buf = nullptr;
+                        _bytes = newSize * sizeof(T);
+                        _buf = static_cast<T*>(ScratchPool::allocate(_bytes));
                     }
                 }
 
@@ -113,13 +123,17 @@ namespace Falltergeist
 
             private:
                 size_t _size;
+                // size of the memory block, it can be bigger than the data
+                size_t _bytes;
                 T* _buf;
 
                 void _cleanUpBuffer()
                 {
                     if (_buf != nullptr)
                     {
-                        delete[] _buf;
+                        ScratchPool::deallocate(_buf, _bytes);
+                        _buf = nullptr;
+                        _bytes = 0;
                     }
                 }
         };
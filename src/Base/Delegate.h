@@ -1,18 +1,76 @@
 #pragma once
 
-#include <functional>
+#include <memory>
 #include <vector>
+#include "../Base/Function.h"
 
 namespace Falltergeist
 {
     namespace Base
     {
+        /**
+         * Copies of a delegate share its functors until one of them is changed,
+         * so scheduling an event with a copy of the handler doesn't allocate
+         * The first functors are stored inline with the shared count, a delegate with a handler or two
+         * takes one allocation and an empty one none
+         */
         template <typename ...ArgT>
         class Delegate
         {
             public:
-                using Functor = std::function<void(ArgT...)>;
-                using FunctorCollection = std::vector<Functor>;
+                using Functor = Function<void(ArgT...)>;
+
+                class FunctorCollection
+                {
+                    public:
+                        static const size_t INLINE_FUNCTORS = 2;
+
+                        void push_back(Functor func)
+                        {
+                            if (_size < INLINE_FUNCTORS)
+                            {
+                                _inline[_size++] = std::move(func);
+                                return;
+                            }
+                            if (_spilled.empty())
+                            {
+                                _spilled.reserve(INLINE_FUNCTORS * 2);
+                                for (auto& inlineFunc : _inline)
+                                {
+                                    _spilled.push_back(std::move(inlineFunc));
+                                    inlineFunc = nullptr;
+                                }
+                            }
+                            _spilled.push_back(std::move(func));
+                            _size++;
+                        }
+
+                        const Functor* begin() const
+                        {
+                            return _spilled.empty() ? _inline : _spilled.data();
+                        }
+
+                        const Functor* end() const
+                        {
+                            return begin() + _size;
+                        }
+
+                        size_t size() const
+                        {
+                            return _size;
+                        }
+
+                        bool empty() const
+                        {
+                            return _size == 0;
+                        }
+
+                    private:
+                        Functor _inline[INLINE_FUNCTORS];
+                        // all functors once there are more than fit inline
+                        std::vector<Functor> _spilled;
+                        size_t _size = 0;
+                };
 
                 Delegate<ArgT...>() {}
 
@@ -23,12 +81,18 @@ namespace Falltergeist
 
                 void add(Functor func)
                 {
-                    _functors.emplace_back(std::move(func));
+                    _mutableFunctors().push_back(std::move(func));
                 }
 
                 void add(const Delegate<ArgT...>& other)
                 {
-                    for (auto& func : other.functors())
+                    // keeps the functors alive if other is this delegate
+                    auto functors = other._functors;
+                    if (!functors)
+                    {
+                        return;
+                    }
+                    for (auto& func : *functors)
                     {
                         add(func);
                     }
@@ -36,18 +100,31 @@ namespace Falltergeist
 
                 void clear()
                 {
-                    _functors.clear();
+                    _functors.reset();
                 }
 
                 void invoke(ArgT... args)
                 {
-                    for (auto& func : _functors)
+                    // functors may change the delegate while being called
+                    auto functors = _functors;
+                    if (!functors)
+                    {
+                        return;
+                    }
+                    for (auto& func : *functors)
                     {
                         func(args...);
                     }
                 }
 
                 const FunctorCollection& functors() const
+                {
+                    static const FunctorCollection empty;
+                    return _functors ? *_functors : empty;
+                }
+
+                // Functors as they are now, unaffected by later changes of the delegate
+                std::shared_ptr<const FunctorCollection> shared() const
                 {
                     return _functors;
                 }
@@ -84,11 +161,24 @@ namespace Falltergeist
 
                 explicit operator bool () const
                 {
-                    return _functors.size() > 0;
+                    return _functors && !_functors->empty();
                 }
 
             private:
-                FunctorCollection _functors;
+                std::shared_ptr<FunctorCollection> _functors;
+
+                FunctorCollection& _mutableFunctors()
+                {
+                    if (!_functors)
+                    {
+                        _functors = std::make_shared<FunctorCollection>();
+                    }
+                    else if (_functors.use_count() > 1)
+                    {
+                        _functors = std::make_shared<FunctorCollection>(*_functors);
+                    }
+                    return *_functors;
+                }
         };
     }
 }
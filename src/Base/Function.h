@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        template <typename Signature>
+        class Function;
+
+        // Callable wrapper like std::function, callables of up to four pointers are stored inline without allocation.
+        // Lambdas capturing this and a few values or binds of a member function fit, larger ones go to the heap.
+        template <typename R, typename ...ArgT>
+        class Function<R(ArgT...)>
+        {
+            public:
+                Function<R(ArgT...)>() {}
+
+                Function<R(ArgT...)>(std::nullptr_t) {}
+
+                template <typename F, typename = std::enable_if_t<
+                    !std::is_same<std::decay_t<F>, Function<R(ArgT...)>>::value && std::is_invocable_r<R, std::decay_t<F>&, ArgT...>::value
+                >>
+                Function<R(ArgT...)>(F&& func)
+                {
+                    using Callable = std::decay_t<F>;
+                    if (_isInline<Callable>())
+                    {
+                        new (_storage) Callable(std::forward<F>(func));
+                        _operations = &Inline<Callable>::operations;
+                    }
+                    else
+                    {
+                        *reinterpret_cast<Callable**>(_storage) = new Callable(std::forward<F>(func));
+                        _operations = &Heap<Callable>::operations;
+                    }
+                }
+
+                Function<R(ArgT...)>(const Function<R(ArgT...)>& other)
+                {
+                    if (other._operations)
+                    {
+                        other._operations->copy(other._storage, _storage);
+                        _operations = other._operations;
+                    }
+                }
+
+                Function<R(ArgT...)>(Function<R(ArgT...)>&& other) noexcept
+                {
+                    _take(other);
+                }
+
+                ~Function<R(ArgT...)>()
+                {
+                    _reset();
+                }
+
+                Function<R(ArgT...)>& operator=(const Function<R(ArgT...)>& other)
+                {
+                    if (this != &other)
+                    {
+                        Function<R(ArgT...)> copy(other);
+                        _reset();
+                        _take(copy);
+                    }
+                    return *this;
+                }
+
+                Function<R(ArgT...)>& operator=(Function<R(ArgT...)>&& other) noexcept
+                {
+                    if (this != &other)
+                    {
+                        _reset();
+                        _take(other);
+                    }
+                    return *this;
+                }
+
+                Function<R(ArgT...)>& operator=(std::nullptr_t)
+                {
+                    _reset();
+                    return *this;
+                }
+
+                R operator()(ArgT... args) const
+                {
+                    return _operations->invoke(const_cast<unsigned char*>(_storage), std::forward<ArgT>(args)...);
+                }
+
+                explicit operator bool() const
+                {
+                    return _operations != nullptr;
+                }
+
+            private:
+                static const size_t INLINE_SIZE = 4 * sizeof(void*);
+
+                struct Operations
+                {
+                    R (*invoke)(void* storage, ArgT&&... args);
+                    void (*copy)(const void* from, void* to);
+                    // leaves nothing to destroy in from
+                    void (*move)(void* from, void* to);
+                    void (*destroy)(void* storage);
+                };
+
+                template <typename F>
+                struct Inline
+                {
+                    static R invoke(void* storage, ArgT&&... args)
+                    {
+                        return (*static_cast<F*>(storage))(std::forward<ArgT>(args)...);
+                    }
+
+                    static void copy(const void* from, void* to)
+                    {
+                        new (to) F(*static_cast<const F*>(from));
+                    }
+
+                    static void move(void* from, void* to)
+                    {
+                        new (to) F(std::move(*static_cast<F*>(from)));
+                        static_cast<F*>(from)->~F();
+                    }
+
+                    static void destroy(void* storage)
+                    {
+                        static_cast<F*>(storage)->~F();
+                    }
+
+                    static constexpr Operations operations = {&invoke, &copy, &move, &destroy};
+                };
+
+                template <typename F>
+                struct Heap
+                {
+                    static R invoke(void* storage, ArgT&&... args)
+                    {
+                        return (**static_cast<F**>(storage))(std::forward<ArgT>(args)...);
+                    }
+
+                    static void copy(const void* from, void* to)
+                    {
+                        *static_cast<F**>(to) = new F(**static_cast<F* const*>(from));
+                    }
+
+                    static void move(void* from, void* to)
+                    {
+                        *static_cast<F**>(to) = *static_cast<F**>(from);
+                    }
+
+                    static void destroy(void* storage)
+                    {
+                        delete *static_cast<F**>(storage);
+                    }
+
+                    static constexpr Operations operations = {&invoke, &copy, &move, &destroy};
+                };
+
+                alignas(std::max_align_t) unsigned char _storage[INLINE_SIZE];
+                const Operations* _operations = nullptr;
+
+                template <typename F>
+                static constexpr bool _isInline()
+                {
+                    return sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible<F>::value;
+                }
+
+                void _take(Function<R(ArgT...)>& other)
+                {
+                    if (other._operations)
+                    {
+                        other._operations->move(other._storage, _storage);
+                        _operations = other._operations;
+                        other._operations = nullptr;
+                    }
+                }
+
+                void _reset()
+                {
+                    if (_operations)
+                    {
+                        _operations->destroy(_storage);
+                        _operations = nullptr;
+                    }
+                }
+        };
+    }
+}
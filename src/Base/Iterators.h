@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <iterator>
 #include <list>
 #include <memory>
 #include <vector>
@@ -115,5 +117,72 @@ namespace Falltergeist
             const_reverse_iterator crbegin()    { return vector_ptr_decorator::const_reverse_iterator(_cont.crbegin()); }
             const_reverse_iterator crend()      { return vector_ptr_decorator::const_reverse_iterator(_cont.crend()); }
         };
+
+        /**
+         * Decorator for vector of objects stored by value that returns plain pointers to them when iterating,
+         * so containers can switch from unique_ptr's to contiguous storage without changing the code iterating over them.
+         */
+        template <typename T>
+        class vector_value_decorator
+        {
+            std::vector<T>& _cont;
+
+        public:
+            class iterator
+            {
+                T* _ptr;
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = T*;
+                using difference_type = std::ptrdiff_t;
+                using pointer = T**;
+                using reference = T*;
+
+                iterator(T* ptr) : _ptr(ptr)
+                {
+                }
+
+                iterator& operator ++()
+                {
+                    ++_ptr;
+                    return *this;
+                }
+
+                iterator operator ++(int)
+                {
+                    iterator result(*this);
+                    ++_ptr;
+                    return result;
+                }
+
+                bool operator ==(const iterator& rhs) const
+                {
+                    return _ptr == rhs._ptr;
+                }
+
+                bool operator !=(const iterator& rhs) const
+                {
+                    return _ptr != rhs._ptr;
+                }
+
+                T* operator ->() const
+                {
+                    return _ptr;
+                }
+
+                T* operator *() const
+                {
+                    return _ptr;
+                }
+            };
+
+            vector_value_decorator(std::vector<T>& vec) : _cont(vec)
+            {
+            }
+
+            iterator begin()                    { return iterator(_cont.data()); }
+            iterator end()                      { return iterator(_cont.data() + _cont.size()); }
+        };
     }
 }
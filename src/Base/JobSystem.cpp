@@ -0,0 +1,297 @@
+#include "../Base/JobSystem.h"
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        thread_local JobSystem* JobSystem::_currentSystem = nullptr;
+        thread_local size_t JobSystem::_currentWorker = 0;
+
+        JobSystem::Group::Group(JobSystem& jobs) : _jobs(jobs)
+        {
+        }
+
+        JobSystem::Group::~Group()
+        {
+            // jobs refer to the group until they finish
+            try
+            {
+                wait();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        void JobSystem::Group::wait()
+        {
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    if (_pending == 0)
+                    {
+                        break;
+                    }
+                }
+                // jobs for the main thread may be what the group waits for
+                if (_jobs.isMainThread())
+                {
+                    _jobs.runMainThreadJobs();
+                }
+                if (!_jobs.runOne())
+                {
+                    // the running jobs are left to the workers, a queued one wakes them and not this thread
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _done.wait_for(lock, std::chrono::milliseconds(1), [this]() { return _pending == 0; });
+                }
+            }
+
+            std::exception_ptr exception;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                std::swap(exception, _exception);
+            }
+            if (exception)
+            {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        void JobSystem::Group::_add()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending++;
+        }
+
+        void JobSystem::Group::_finish(std::exception_ptr exception)
+        {
+            std::vector<std::function<void()>> continuations;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (exception && !_exception)
+                {
+                    _exception = exception;
+                }
+                if (--_pending == 0)
+                {
+                    continuations.swap(_continuations);
+                    _done.notify_all();
+                }
+            }
+            // each continuation queues its job, the group may be gone once it's notified
+            for (auto& continuation : continuations)
+            {
+                continuation();
+            }
+        }
+
+        JobSystem::JobSystem(unsigned int threads) : _mainThread(std::this_thread::get_id())
+        {
+            for (unsigned int i = 0; i != threads; ++i)
+            {
+                _workers.push_back(std::make_unique<Worker>());
+            }
+            // workers start once all queues exist, they steal from each other right away
+            for (size_t i = 0; i != _workers.size(); ++i)
+            {
+                _workers[i]->thread = std::thread([this, i]() { _work(i); });
+            }
+        }
+
+        JobSystem::~JobSystem()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_sleepMutex);
+                _stopping = true;
+            }
+            _wake.notify_all();
+            for (auto& worker : _workers)
+            {
+                worker->thread.join();
+            }
+            // without workers the queued jobs are still there
+            while (runOne())
+            {
+            }
+            runMainThreadJobs();
+        }
+
+        void JobSystem::run(std::function<void()> job, Group* group)
+        {
+            if (group)
+            {
+                group->_add();
+            }
+            _push({std::move(job), group});
+        }
+
+        void JobSystem::runAfter(Group& dependency, std::function<void()> job, Group* group)
+        {
+            if (group)
+            {
+                group->_add();
+            }
+            {
+                std::lock_guard<std::mutex> lock(dependency._mutex);
+                if (dependency._pending != 0)
+                {
+                    auto shared = std::make_shared<Job>(Job{std::move(job), group});
+                    dependency._continuations.push_back([this, shared]() { _push(std::move(*shared)); });
+                    return;
+                }
+            }
+            _push({std::move(job), group});
+        }
+
+        void JobSystem::runOnMainThread(std::function<void()> job, Group* group)
+        {
+            if (group)
+            {
+                group->_add();
+            }
+            std::lock_guard<std::mutex> lock(_mainMutex);
+            _mainJobs.push_back({std::move(job), group});
+        }
+
+        void JobSystem::runMainThreadJobs()
+        {
+            // jobs queued by these wait for the next call
+            std::vector<Job> jobs;
+            {
+                std::lock_guard<std::mutex> lock(_mainMutex);
+                jobs.swap(_mainJobs);
+            }
+            for (auto& job : jobs)
+            {
+                _execute(job);
+            }
+        }
+
+        bool JobSystem::runOne()
+        {
+            Job job;
+            if (!_pop(job))
+            {
+                return false;
+            }
+            _execute(job);
+            return true;
+        }
+
+        unsigned int JobSystem::size() const
+        {
+            return static_cast<unsigned int>(_workers.size());
+        }
+
+        bool JobSystem::isMainThread() const
+        {
+            return std::this_thread::get_id() == _mainThread;
+        }
+
+        void JobSystem::_push(Job job)
+        {
+            if (_workers.empty())
+            {
+                // nobody else would run it, the main jobs queue is drained by waiting threads and the main loop
+                std::lock_guard<std::mutex> lock(_mainMutex);
+                _mainJobs.push_back(std::move(job));
+                return;
+            }
+
+            // a worker keeps the jobs it queues, they are the ones most likely still cached
+            size_t index = _currentSystem == this ? _currentWorker : _next++ % _workers.size();
+            {
+                std::lock_guard<std::mutex> lock(_workers[index]->mutex);
+                _workers[index]->jobs.push_back(std::move(job));
+            }
+            {
+                std::lock_guard<std::mutex> lock(_sleepMutex);
+                _queued++;
+            }
+            _wake.notify_one();
+        }
+
+        bool JobSystem::_pop(Job& job)
+        {
+            if (_workers.empty())
+            {
+                std::lock_guard<std::mutex> lock(_mainMutex);
+                if (_mainJobs.empty())
+                {
+                    return false;
+                }
+                job = std::move(_mainJobs.front());
+                _mainJobs.erase(_mainJobs.begin());
+                return true;
+            }
+
+            size_t first = _currentSystem == this ? _currentWorker : 0;
+            if (_currentSystem == this)
+            {
+                auto& own = *_workers[first];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (!own.jobs.empty())
+                {
+                    job = std::move(own.jobs.back());
+                    own.jobs.pop_back();
+                    _queued--;
+                    return true;
+                }
+            }
+            for (size_t i = 0; i != _workers.size(); ++i)
+            {
+                auto& other = *_workers[(first + i) % _workers.size()];
+                std::lock_guard<std::mutex> lock(other.mutex);
+                if (!other.jobs.empty())
+                {
+                    job = std::move(other.jobs.front());
+                    other.jobs.pop_front();
+                    _queued--;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void JobSystem::_execute(Job& job)
+        {
+            if (!job.group)
+            {
+                job.function();
+                return;
+            }
+            std::exception_ptr exception;
+            try
+            {
+                job.function();
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+            // the function may hold what the group protects, it's gone before the group hears of it
+            job.function = nullptr;
+            job.group->_finish(exception);
+        }
+
+        void JobSystem::_work(size_t index)
+        {
+            _currentSystem = this;
+            _currentWorker = index;
+            while (true)
+            {
+                if (runOne())
+                {
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(_sleepMutex);
+                if (_stopping && _queued == 0)
+                {
+                    return;
+                }
+                _wake.wait(lock, [this]() { return _stopping || _queued != 0; });
+            }
+        }
+    }
+}
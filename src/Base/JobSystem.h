@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        // Worker threads shared by the whole engine. Every worker takes the jobs of its own queue newest first and steals
+        // the oldest ones of the others once it runs out, jobs queued by other threads are spread over the workers.
+        // Jobs queued with runOnMainThread() wait for runMainThreadJobs(), called by the main loop once a frame,
+        // for work which needs the GL context or SDL.
+        // Jobs which are still queued when the system is destroyed are executed before the workers are joined.
+        class JobSystem
+        {
+            public:
+                // Counts its unfinished jobs, usually the jobs of one frame. Jobs queued with runAfter() start once
+                // every job of the group finished, wait() executes queued jobs on the calling thread meanwhile.
+                class Group
+                {
+                    public:
+                        Group(JobSystem& jobs);
+                        // Waits for the jobs, an exception of one of them is only rethrown by wait()
+                        ~Group();
+
+                        Group(const Group&) = delete;
+                        Group& operator=(const Group&) = delete;
+
+                        // Returns once every job of the group finished. The first exception thrown by one of them
+                        // is rethrown, the other jobs still run.
+                        void wait();
+
+                    private:
+                        friend class JobSystem;
+
+                        JobSystem& _jobs;
+                        std::mutex _mutex;
+                        std::condition_variable _done;
+                        unsigned int _pending = 0;
+                        std::exception_ptr _exception;
+                        std::vector<std::function<void()>> _continuations;
+
+                        void _add();
+                        void _finish(std::exception_ptr exception);
+                };
+
+                // A system without workers executes jobs on the threads waiting for them
+                JobSystem(unsigned int threads);
+                ~JobSystem();
+
+                JobSystem(const JobSystem&) = delete;
+                JobSystem& operator=(const JobSystem&) = delete;
+
+                // Queues the job as part of the group. Exceptions of jobs outside of any group end the program.
+                void run(std::function<void()> job, Group* group = nullptr);
+
+                // Queues the job once every job of the dependency finished, as part of the group
+                void runAfter(Group& dependency, std::function<void()> job, Group* group = nullptr);
+
+                // Queues the job for runMainThreadJobs(), as part of the group
+                void runOnMainThread(std::function<void()> job, Group* group = nullptr);
+
+                // Executes the jobs queued for the main thread until now, main thread only
+                void runMainThreadJobs();
+
+                // Queues the given job and returns a future for its result, like ThreadPool::enqueue().
+                // Exceptions thrown by the job are rethrown from future::get().
+                template <typename Function>
+                std::future<std::invoke_result_t<Function>> enqueue(Function&& function)
+                {
+                    typedef std::invoke_result_t<Function> Result;
+
+                    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+                    auto future = task->get_future();
+                    run([task]() { (*task)(); });
+                    return future;
+                }
+
+                // Executes one queued job on the calling thread, false if there was none
+                bool runOne();
+
+                // Number of worker threads, the thread waiting for a group works too
+                unsigned int size() const;
+
+                bool isMainThread() const;
+
+            private:
+                struct Job
+                {
+                    std::function<void()> function;
+                    Group* group = nullptr;
+                };
+
+                struct Worker
+                {
+                    std::mutex mutex;
+                    std::deque<Job> jobs;
+                    std::thread thread;
+                };
+
+                std::vector<std::unique_ptr<Worker>> _workers;
+
+                // queued jobs of all workers, workers sleep while there are none
+                std::atomic<size_t> _queued{0};
+                std::atomic<size_t> _next{0};
+                std::mutex _sleepMutex;
+                std::condition_variable _wake;
+                bool _stopping = false;
+
+                std::mutex _mainMutex;
+                std::vector<Job> _mainJobs;
+                std::thread::id _mainThread;
+
+                static thread_local JobSystem* _currentSystem;
+                static thread_local size_t _currentWorker;
+
+                void _push(Job job);
+                bool _pop(Job& job);
+                void _execute(Job& job);
+                void _work(size_t index);
+        };
+    }
+}
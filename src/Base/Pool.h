@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        // Fixed size blocks allocated in slabs of Count and reused through a free list.
+        // Memory is returned to the system only when the pool is destroyed.
+        template <size_t Size, size_t Count = 64>
+        class Pool
+        {
+            public:
+                Pool<Size, Count>() = default;
+
+                Pool<Size, Count>(const Pool<Size, Count>&) = delete;
+                Pool<Size, Count>& operator= (const Pool<Size, Count>&) = delete;
+
+                void* allocate()
+                {
+                    if (!_free) {
+                        _grow();
+                    }
+                    Block* block = _free;
+                    _free = block->next;
+                    return block;
+                }
+
+                void deallocate(void* pointer)
+                {
+                    Block* block = static_cast<Block*>(pointer);
+                    block->next = _free;
+                    _free = block;
+                }
+
+            private:
+                union Block
+                {
+                    Block* next;
+                    alignas(std::max_align_t) unsigned char data[Size];
+                };
+
+                std::vector<std::unique_ptr<Block[]>> _slabs;
+                Block* _free = nullptr;
+
+                void _grow()
+                {
+                    _slabs.emplace_back(new Block[Count]);
+                    Block* slab = _slabs.back().get();
+                    for (size_t i = 0; i != Count; ++i) {
+                        slab[i].next = _free;
+                        _free = &slab[i];
+                    }
+                }
+        };
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        // Lock-free queue of trivially copyable values for exactly one producer and one consumer thread.
+        // Capacity is rounded up to a power of two, values are copied in and out in blocks.
+        template <typename T>
+        class RingBuffer
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "RingBuffer copies values with memcpy");
+
+            public:
+                RingBuffer<T>(size_t capacity)
+                {
+                    size_t size = 1;
+                    while (size < capacity)
+                    {
+                        size <<= 1;
+                    }
+                    _buffer.resize(size);
+                    _mask = size - 1;
+                }
+
+                RingBuffer<T>(const RingBuffer<T>&) = delete;
+                RingBuffer<T>& operator= (const RingBuffer<T>&) = delete;
+
+                // Producer: copies up to count values, returns how many fit
+                size_t write(const T* values, size_t count)
+                {
+                    size_t tail = _tail.load(std::memory_order_relaxed);
+                    size_t head = _head.load(std::memory_order_acquire);
+                    count = std::min(count, _buffer.size() - (tail - head));
+
+                    size_t start = tail & _mask;
+                    size_t first = std::min(count, _buffer.size() - start);
+                    std::memcpy(&_buffer[start], values, first * sizeof(T));
+                    std::memcpy(&_buffer[0], values + first, (count - first) * sizeof(T));
+
+                    _tail.store(tail + count, std::memory_order_release);
+                    return count;
+                }
+
+                // Consumer: copies up to count values, returns how many were available
+                size_t read(T* values, size_t count)
+                {
+                    size_t head = _head.load(std::memory_order_relaxed);
+                    size_t tail = _tail.load(std::memory_order_acquire);
+                    count = std::min(count, tail - head);
+
+                    size_t start = head & _mask;
+                    size_t first = std::min(count, _buffer.size() - start);
+                    std::memcpy(values, &_buffer[start], first * sizeof(T));
+                    std::memcpy(values + first, &_buffer[0], (count - first) * sizeof(T));
+
+                    _head.store(head + count, std::memory_order_release);
+                    return count;
+                }
+
+                // Values waiting to be read
+                size_t size() const
+                {
+                    return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+                }
+
+                // Values which can be written without overwriting unread ones
+                size_t space() const
+                {
+                    return _buffer.size() - size();
+                }
+
+                size_t capacity() const
+                {
+                    return _buffer.size();
+                }
+
+                // Drops unread values, neither side may be using the buffer meanwhile
+                void clear()
+                {
+                    _head.store(0, std::memory_order_relaxed);
+                    _tail.store(0, std::memory_order_release);
+                }
+
+            private:
+                std::vector<T> _buffer;
+                size_t _mask = 0;
+                // positions only grow, the difference is the fill level even after they wrap around
+                std::atomic<size_t> _head{0};
+                std::atomic<size_t> _tail{0};
+        };
+    }
+}
@@ -0,0 +1,101 @@
+#include <new>
+#include "../Base/ScratchPool.h"
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        namespace
+        {
+            const size_t MIN_CLASS = 8;  // log2 of ScratchPool::MIN_SIZE
+            const size_t MAX_CLASS = 24; // log2 of ScratchPool::MAX_SIZE
+            const size_t CLASSES = MAX_CLASS - MIN_CLASS + 1;
+
+            static_assert(size_t(1) << MIN_CLASS == ScratchPool::MIN_SIZE, "MIN_CLASS doesn't match MIN_SIZE");
+            static_assert(size_t(1) << MAX_CLASS == ScratchPool::MAX_SIZE, "MAX_CLASS doesn't match MAX_SIZE");
+
+            // free blocks are linked through their first bytes
+            struct Block
+            {
+                Block* next;
+            };
+
+            struct Cache
+            {
+                Block* free[CLASSES] = {};
+                size_t bytes = 0;
+
+                ~Cache();
+            };
+
+            // buffers of thread-local or static objects can be freed after the cache of their thread is gone,
+            // the flag is trivially destructible so it can still be read then
+            thread_local bool destroyed = false;
+            thread_local Cache cache;
+
+            Cache::~Cache()
+            {
+                for (size_t i = 0; i != CLASSES; ++i) {
+                    while (free[i]) {
+                        Block* block = free[i];
+                        free[i] = block->next;
+                        ::operator delete(block);
+                    }
+                }
+                bytes = 0;
+                destroyed = true;
+            }
+
+            size_t sizeClass(size_t size)
+            {
+                size_t result = MIN_CLASS;
+                while ((size_t(1) << result) < size) {
+                    result++;
+                }
+                return result;
+            }
+        }
+
+        void* ScratchPool::allocate(size_t& size)
+        {
+            if (size < MIN_SIZE || size > MAX_SIZE) {
+                return ::operator new(size);
+            }
+
+            size_t index = sizeClass(size);
+            size = size_t(1) << index;
+            if (!destroyed) {
+                Block*& head = cache.free[index - MIN_CLASS];
+                if (head) {
+                    Block* block = head;
+                    head = block->next;
+                    cache.bytes -= size;
+                    return block;
+                }
+            }
+            return ::operator new(size);
+        }
+
+        void ScratchPool::deallocate(void* pointer, size_t size)
+        {
+            if (!pointer) {
+                return;
+            }
+            if (size < MIN_SIZE || size > MAX_SIZE || destroyed || cache.bytes + size > CACHE_SIZE) {
+                ::operator delete(pointer);
+                return;
+            }
+
+            Block* block = static_cast<Block*>(pointer);
+            Block*& head = cache.free[sizeClass(size) - MIN_CLASS];
+            block->next = head;
+            head = block;
+            cache.bytes += size;
+        }
+
+        size_t ScratchPool::cachedBytes()
+        {
+            return destroyed ? 0 : cache.bytes;
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        // Thread-local cache of memory blocks for short-lived buffers of decoders.
+        // Sizes between MIN_SIZE and MAX_SIZE are rounded up to a power of two and freed blocks are kept in a list per size,
+        // so decoding one file after another reuses the same memory. Other sizes go straight to the general allocator.
+        // A block may be freed on another thread than it was allocated on, it joins the cache of that thread.
+        class ScratchPool
+        {
+            public:
+                static const size_t MIN_SIZE = 256;
+                static const size_t MAX_SIZE = 16 * 1024 * 1024;
+                // bytes kept by the cache of one thread, blocks are freed once it is full
+                static const size_t CACHE_SIZE = 32 * 1024 * 1024;
+
+                // Returns a block of at least size bytes, size is set to the usable size of the block
+                static void* allocate(size_t& size);
+
+                // Takes back a block, size has to be the one returned by allocate()
+                static void deallocate(void* pointer, size_t size);
+
+                // Bytes kept by the cache of the calling thread
+                static size_t cachedBytes();
+        };
+    }
+}
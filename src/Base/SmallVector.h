@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        // Vector of trivially copyable values keeping up to N of them inside itself, so short lists need no allocation.
+        // Past N values move to the heap like in std::vector, the order of values is kept by erase().
+        template <typename T, size_t N>
+        class SmallVector
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "SmallVector copies values with memcpy");
+            static_assert(N > 0, "SmallVector needs room for at least one value");
+
+            public:
+                using value_type = T;
+                using iterator = T*;
+                using const_iterator = const T*;
+                using reverse_iterator = std::reverse_iterator<iterator>;
+                using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+                SmallVector() = default;
+
+                SmallVector(const SmallVector& other)
+                {
+                    _assign(other);
+                }
+
+                SmallVector(SmallVector&& other) noexcept
+                {
+                    _take(other);
+                }
+
+                ~SmallVector()
+                {
+                    _free();
+                }
+
+                SmallVector& operator=(const SmallVector& other)
+                {
+                    if (this != &other)
+                    {
+                        _size = 0;
+                        _assign(other);
+                    }
+                    return *this;
+                }
+
+                SmallVector& operator=(SmallVector&& other) noexcept
+                {
+                    if (this != &other)
+                    {
+                        _free();
+                        _take(other);
+                    }
+                    return *this;
+                }
+
+                iterator begin() { return data(); }
+                iterator end() { return data() + _size; }
+                const_iterator begin() const { return data(); }
+                const_iterator end() const { return data() + _size; }
+                reverse_iterator rbegin() { return reverse_iterator(end()); }
+                reverse_iterator rend() { return reverse_iterator(begin()); }
+                const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+                const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+                T* data() { return _heap() ? _storage.heap : _storage.values; }
+                const T* data() const { return _heap() ? _storage.heap : _storage.values; }
+
+                size_t size() const { return _size; }
+                bool empty() const { return _size == 0; }
+                size_t capacity() const { return _capacity; }
+
+                T& operator[](size_t index) { return data()[index]; }
+                const T& operator[](size_t index) const { return data()[index]; }
+
+                T& front() { return data()[0]; }
+                T& back() { return data()[_size - 1]; }
+
+                void push_back(const T& value)
+                {
+                    if (_size == _capacity)
+                    {
+                        // the value may be one of ours, it's copied before the values move
+                        T copy = value;
+                        reserve(_capacity * 2);
+                        data()[_size++] = copy;
+                        return;
+                    }
+                    data()[_size++] = value;
+                }
+
+                void pop_back()
+                {
+                    _size--;
+                }
+
+                iterator erase(const_iterator position)
+                {
+                    return erase(position, position + 1);
+                }
+
+                iterator erase(const_iterator first, const_iterator last)
+                {
+                    T* values = data();
+                    size_t from = static_cast<size_t>(first - values);
+                    size_t to = static_cast<size_t>(last - values);
+                    std::memmove(values + from, values + to, (_size - to) * sizeof(T));
+                    _size -= static_cast<uint32_t>(to - from);
+                    return values + from;
+                }
+
+                void clear()
+                {
+                    _size = 0;
+                }
+
+                void reserve(size_t capacity)
+                {
+                    if (capacity <= _capacity)
+                    {
+                        return;
+                    }
+                    T* values = new T[capacity];
+                    std::memcpy(values, data(), _size * sizeof(T));
+                    _free();
+                    _storage.heap = values;
+                    _capacity = static_cast<uint32_t>(capacity);
+                }
+
+            private:
+                union Storage
+                {
+                    T values[N];
+                    T* heap;
+                } _storage;
+                uint32_t _size = 0;
+                uint32_t _capacity = N;
+
+                bool _heap() const
+                {
+                    return _capacity > N;
+                }
+
+                void _free()
+                {
+                    if (_heap())
+                    {
+                        delete[] _storage.heap;
+                        _capacity = N;
+                    }
+                }
+
+                void _assign(const SmallVector& other)
+                {
+                    reserve(other._size);
+                    std::memcpy(data(), other.data(), other._size * sizeof(T));
+                    _size = other._size;
+                }
+
+                // other is left empty, a heap block changes hands
+                void _take(SmallVector& other)
+                {
+                    _storage = other._storage;
+                    _size = other._size;
+                    _capacity = other._capacity;
+                    other._size = 0;
+                    other._capacity = N;
+                }
+        };
+    }
+}
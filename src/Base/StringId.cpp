@@ -0,0 +1,109 @@
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include "../Base/StringId.h"
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        namespace
+        {
+            // strings are stored in chunks which are never moved, so readers index them without locking
+            const uint32_t CHUNK_SIZE = 4096;
+            const uint32_t CHUNKS = 4096;
+
+            struct Table
+            {
+                std::shared_mutex mutex;
+                // keys view the strings in the chunks
+                std::unordered_map<std::string_view, uint32_t> ids;
+                std::atomic<std::string*> chunks[CHUNKS] = {};
+                uint32_t count = 0;
+
+                Table()
+                {
+                    add(std::string());
+                }
+
+                // the unique lock has to be held
+                uint32_t add(const std::string& value)
+                {
+                    if (count == CHUNK_SIZE * CHUNKS)
+                    {
+                        throw std::length_error("String table is full");
+                    }
+                    auto& chunk = chunks[count / CHUNK_SIZE];
+                    if (!chunk.load(std::memory_order_relaxed))
+                    {
+                        chunk.store(new std::string[CHUNK_SIZE], std::memory_order_release);
+                    }
+                    auto& stored = chunk.load(std::memory_order_relaxed)[count % CHUNK_SIZE];
+                    stored = value;
+                    ids.emplace(std::string_view(stored), count);
+                    return count++;
+                }
+            };
+
+            // never destroyed, ids may be used by other static objects until the very end
+            Table& table()
+            {
+                static Table* table = new Table();
+                return *table;
+            }
+        }
+
+        StringId::StringId(const std::string& value)
+        {
+            if (value.empty())
+            {
+                return;
+            }
+            if (find(value, *this))
+            {
+                return;
+            }
+            auto& strings = table();
+            std::unique_lock<std::shared_mutex> lock(strings.mutex);
+            // somebody could have added it in the meantime
+            auto it = strings.ids.find(std::string_view(value));
+            _id = it != strings.ids.end() ? it->second : strings.add(value);
+        }
+
+        bool StringId::find(const std::string& value, StringId& id)
+        {
+            auto& strings = table();
+            std::shared_lock<std::shared_mutex> lock(strings.mutex);
+            auto it = strings.ids.find(std::string_view(value));
+            if (it == strings.ids.end())
+            {
+                return false;
+            }
+            id._id = it->second;
+            return true;
+        }
+
+        StringId StringId::fromId(uint32_t id)
+        {
+            StringId result;
+            result._id = id;
+            return result;
+        }
+
+        const std::string& StringId::str() const
+        {
+            return table().chunks[_id / CHUNK_SIZE].load(std::memory_order_acquire)[_id % CHUNK_SIZE];
+        }
+
+        size_t StringId::count()
+        {
+            auto& strings = table();
+            std::shared_lock<std::shared_mutex> lock(strings.mutex);
+            return strings.count;
+        }
+    }
+}
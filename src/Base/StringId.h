@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        // Handle of a string in the engine wide string table. Equal strings share one id, so ids are compared
+        // and hashed as integers. Strings are never removed from the table and references to them stay valid.
+        // Interning is thread-safe, reading the string of an id doesn't lock.
+        class StringId
+        {
+            public:
+                // The empty string
+                StringId() {}
+
+                explicit StringId(const std::string& value);
+
+                // Id of the string if it was interned before, false otherwise. Nothing is added to the table.
+                static bool find(const std::string& value, StringId& id);
+
+                static StringId fromId(uint32_t id);
+
+                uint32_t id() const
+                {
+                    return _id;
+                }
+
+                const std::string& str() const;
+
+                bool empty() const
+                {
+                    return _id == 0;
+                }
+
+                bool operator==(const StringId& other) const
+                {
+                    return _id == other._id;
+                }
+
+                bool operator!=(const StringId& other) const
+                {
+                    return _id != other._id;
+                }
+
+                // Number of interned strings
+                static size_t count();
+
+            private:
+                uint32_t _id = 0;
+        };
+    }
+}
+
+namespace std
+{
+    template <>
+    struct hash<Falltergeist::Base::StringId>
+    {
+        size_t operator()(const Falltergeist::Base::StringId& value) const
+        {
+            return value.id();
+        }
+    };
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        // Fixed size pool of worker threads executing queued jobs in FIFO order.
+        // Jobs which are still queued when the pool is destroyed are executed before the workers are joined.
+        class ThreadPool
+        {
+            public:
+                ThreadPool(unsigned int threads)
+                {
+                    if (threads == 0)
+                    {
+                        threads = 1;
+                    }
+                    for (unsigned int i = 0; i != threads; ++i)
+                    {
+                        _workers.emplace_back([this]() { _work(); });
+                    }
+                }
+
+                ThreadPool(const ThreadPool&) = delete;
+
+                ThreadPool& operator=(const ThreadPool&) = delete;
+
+                ~ThreadPool()
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _stopping = true;
+                    }
+                    _condition.notify_all();
+                    for (auto& worker : _workers)
+                    {
+                        worker.join();
+                    }
+                }
+
+                // Queues the given job and returns a future for its result.
+                // Exceptions thrown by the job are rethrown from future::get().
+                template <typename Function>
+                std::future<std::invoke_result_t<Function>> enqueue(Function&& function)
+                {
+                    typedef std::invoke_result_t<Function> Result;
+
+                    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+                    auto future = task->get_future();
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _jobs.emplace([task]() { (*task)(); });
+                    }
+                    _condition.notify_one();
+                    return future;
+                }
+
+                unsigned int size() const
+                {
+                    return static_cast<unsigned int>(_workers.size());
+                }
+
+            private:
+                std::vector<std::thread> _workers;
+
+                std::queue<std::function<void()>> _jobs;
+
+                std::mutex _mutex;
+
+                std::condition_variable _condition;
+
+                bool _stopping = false;
+
+                void _work()
+                {
+                    while (true)
+                    {
+                        std::function<void()> job;
+                        {
+                            std::unique_lock<std::mutex> lock(_mutex);
+                            _condition.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+                            if (_jobs.empty())
+                            {
+                                return;
+                            }
+                            job = std::move(_jobs.front());
+                            _jobs.pop();
+                        }
+                        job();
+                    }
+                }
+        };
+    }
+}
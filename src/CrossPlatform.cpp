@@ -24,7 +24,9 @@
 #if defined(_WIN32) || defined(WIN32)
     #include <shlobj.h>
     #include <windows.h>
+    #include <psapi.h>
 #elif defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
     #include <sys/stat.h>
     #include <sys/types.h>
     #include <unistd.h>
@@ -147,15 +149,8 @@ namespace Falltergeist
             directories.push_back(directory);
         }
 
-        try {
-            std::vector<std::string> cdDrives = getCdDrivePaths();
-            directories.insert(directories.end(), cdDrives.begin(), cdDrives.end());
-        } catch (const Exception& e) {
-            Logger::error("") << e.what() << std::endl;
-        }
-
-        for (auto &directory : directories) {
-            if (std::all_of(
+        auto hasDataFiles = [](const std::string& directory) {
+            return std::all_of(
                 _necessaryDatFiles.begin(),
                 _necessaryDatFiles.end(),
                 [directory](const std::string& file) {
@@ -166,9 +161,26 @@ namespace Falltergeist
                         Logger::info("") << "Searching in directory: " << directory << " " << file << " [NOT FOUND]" << std::endl;
                         return false;
                     }
-                })
-                )
-            {
+                });
+        };
+
+        for (auto &directory : directories) {
+            if (hasDataFiles(directory)) {
+                _falloutDataPath = directory;
+                return _falloutDataPath;
+            }
+        }
+
+        // Probing CD drives is slow and may spin up a disc, so they are only searched as a last resort
+        std::vector<std::string> cdDrives;
+        try {
+            cdDrives = getCdDrivePaths();
+        } catch (const Exception& e) {
+            Logger::error("") << e.what() << std::endl;
+        }
+
+        for (auto &directory : cdDrives) {
+            if (hasDataFiles(directory)) {
                 _falloutDataPath = directory;
                 return _falloutDataPath;
             }
@@ -355,6 +367,30 @@ namespace Falltergeist
         return false;
     }
 
+    size_t CrossPlatform::getPeakMemoryUsage()
+    {
+    #if defined(_WIN32) || defined(WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return counters.PeakWorkingSetSize;
+        }
+        return 0;
+    #elif defined(__unix__) || defined(__APPLE__)
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+        #if defined(__APPLE__)
+            return static_cast<size_t>(usage.ru_maxrss);
+        #else
+            // kilobytes everywhere except macOS
+            return static_cast<size_t>(usage.ru_maxrss) * 1024;
+        #endif
+    #else
+        return 0;
+    #endif
+    }
+
     std::string CrossPlatform::getConfigPath()
     {
     #if defined(__unix__)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <list>
 #include <string>
 #include <vector>
@@ -25,6 +26,9 @@ namespace Falltergeist
 
             static bool fileExists(std::string file);
 
+            // Largest resident set size of the process so far in bytes, 0 if the platform can't tell
+            static size_t getPeakMemoryUsage();
+
         protected:
             CrossPlatform() = default;
             ~CrossPlatform() = default;
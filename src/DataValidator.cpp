@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "Base/ThreadPool.h"
+#include "CrossPlatform.h"
+#include "DataValidator.h"
+#include "Exception.h"
+#include "Format/Aaf/File.h"
+#include "Format/Acm/File.h"
+#include "Format/Bio/File.h"
+#include "Format/Dat/Stream.h"
+#include "Format/Fon/File.h"
+#include "Format/Frm/File.h"
+#include "Format/Gam/File.h"
+#include "Format/Gcd/File.h"
+#include "Format/Int/File.h"
+#include "Format/Lip/File.h"
+#include "Format/Lst/File.h"
+#include "Format/Map/File.h"
+#include "Format/Msg/File.h"
+#include "Format/Msk/File.h"
+#include "Format/Mve/Chunk.h"
+#include "Format/Mve/File.h"
+#include "Format/Pal/File.h"
+#include "Format/Pro/File.h"
+#include "Format/Rix/File.h"
+#include "Format/Sve/File.h"
+#include "ResourceManager.h"
+#include "VFS/DatArchiveDriver.h"
+#include "VFS/DatArchiveIndex.h"
+#include "VFS/MappedDatArchiveDriver.h"
+
+namespace Falltergeist
+{
+    using namespace Format;
+
+    namespace
+    {
+        struct Archive
+        {
+            std::string filename;
+            std::unique_ptr<VFS::IDriver> driver;
+            std::vector<std::string> paths;
+        };
+
+        struct FormatStats
+        {
+            size_t files = 0;
+            size_t failures = 0;
+            unsigned long long bytes = 0;
+            double seconds = 0.0;
+        };
+
+        struct Failure
+        {
+            std::string archive;
+            std::string path;
+            std::string error;
+        };
+
+        std::string jsonString(const std::string& value)
+        {
+            std::string result = "\"";
+            for (char c : value) {
+                if (c == '"' || c == '\\') {
+                    result += '\\';
+                }
+                result += (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+            }
+            return result + "\"";
+        }
+
+        // Extension deciding the parser, entries without a parser are only inflated
+        std::string format(const std::string& path)
+        {
+            auto dot = path.rfind('.');
+            if (dot == std::string::npos || path.find('/', dot) != std::string::npos) {
+                return "other";
+            }
+            std::string extension = path.substr(dot + 1);
+            if (extension.size() == 3 && extension.compare(0, 2, "fr") == 0 && extension[2] >= '0' && extension[2] <= '5') {
+                return "frm";
+            }
+            static const char* PARSED[] = {
+                "aaf", "acm", "bio", "fon", "frm", "gam", "gcd", "int", "lip", "lst", "map", "msg", "msk", "mve", "pal", "pro", "rix", "sve"
+            };
+            for (auto parsed : PARSED) {
+                if (extension == parsed) {
+                    return extension;
+                }
+            }
+            return "other";
+        }
+
+        // _readObject dereferences the prototypes of items and scenery
+        Pro::File* prototype(uint32_t PID)
+        {
+            auto file = ResourceManager::getInstance()->proFileType(PID);
+            if (!file) {
+                throw Exception("no prototype " + std::to_string(PID));
+            }
+            return file;
+        }
+
+        void parse(const std::string& format, Dat::Stream&& stream)
+        {
+            if (format == "aaf") {
+                Aaf::File file(std::move(stream));
+            } else if (format == "acm") {
+                Acm::File file(std::move(stream));
+                file.init();
+                std::vector<uint16_t> samples(4096);
+                while (file.samplesLeft() > 0) {
+                    if (file.readSamples(samples.data(), samples.size()) == 0) {
+                        throw Exception(std::to_string(file.samplesLeft()) + " samples can't be decoded");
+                    }
+                }
+            } else if (format == "bio") {
+                Bio::File file(std::move(stream));
+            } else if (format == "fon") {
+                Fon::File file(std::move(stream));
+            } else if (format == "frm") {
+                Frm::File file(std::move(stream));
+                file.directions();
+            } else if (format == "gam") {
+                Gam::File file(std::move(stream));
+            } else if (format == "gcd") {
+                Gcd::File file(std::move(stream));
+            } else if (format == "int") {
+                Int::File file(std::move(stream));
+            } else if (format == "lip") {
+                Lip::File file(std::move(stream));
+            } else if (format == "lst") {
+                Lst::File file(std::move(stream));
+            } else if (format == "map") {
+                Map::File file(std::move(stream));
+                file.init(&prototype);
+            } else if (format == "msg") {
+                Msg::File file(std::move(stream));
+            } else if (format == "msk") {
+                Msk::File file(std::move(stream));
+            } else if (format == "mve") {
+                Mve::File file(std::move(stream));
+                while (file.getNextChunk()) {
+                }
+            } else if (format == "pal") {
+                Pal::File file(std::move(stream));
+            } else if (format == "pro") {
+                Pro::File file(std::move(stream));
+            } else if (format == "rix") {
+                Rix::File file(std::move(stream));
+            } else if (format == "sve") {
+                Sve::File file(std::move(stream));
+            }
+        }
+
+        // Returns the unpacked size, throws if the entry can't be read or parsed
+        size_t validate(VFS::IDriver& driver, const std::string& path, const std::string& format)
+        {
+            auto file = driver.open(path, VFS::IFile::OpenMode::Read);
+            if (!file || !file->isOpened()) {
+                throw Exception("can't be opened");
+            }
+            size_t size = file->size();
+
+            // inflating stops at corrupt data without an error, leaving the stream short
+            Dat::Stream stream(file);
+            if (stream.size() != size) {
+                throw Exception("inflated " + std::to_string(stream.size()) + " of " + std::to_string(size) + " bytes");
+            }
+            parse(format, std::move(stream));
+            return size;
+        }
+    }
+
+    DataValidator::DataValidator(std::shared_ptr<ILogger> logger) : _logger(std::move(logger))
+    {
+    }
+
+    size_t DataValidator::run(unsigned int threads, std::ostream& report)
+    {
+        // map objects need their prototypes, which the resource manager reads from the mounted archives
+        std::string cachePath = ResourceManager::getInstance()->cachePath();
+
+        std::vector<Archive> archives;
+        for (auto& filename : CrossPlatform::findFalloutDataFiles()) {
+            std::string path = CrossPlatform::findFalloutDataPath() + "/" + filename;
+            auto index = VFS::DatArchiveIndex::load(path, cachePath.empty() ? "" : cachePath + "/" + filename + ".idx");
+
+            Archive archive;
+            archive.filename = filename;
+            archive.paths = index->paths();
+            try {
+                archive.driver = std::make_unique<VFS::MappedDatArchiveDriver>(path, index);
+            } catch (const Exception& e) {
+                _logger->warning() << "[VALIDATOR] " << e.what() << ", falling back to stream based DAT reader" << std::endl;
+                archive.driver = std::make_unique<VFS::DatArchiveDriver>(path, index);
+            }
+            archives.push_back(std::move(archive));
+        }
+
+        // workers take entries one at a time, big and small ones even out this way
+        std::vector<std::pair<size_t, size_t>> entries;
+        for (size_t i = 0; i != archives.size(); ++i) {
+            for (size_t j = 0; j != archives[i].paths.size(); ++j) {
+                entries.emplace_back(i, j);
+            }
+        }
+
+        std::atomic<size_t> next{0};
+        std::mutex mutex;
+        std::map<std::string, FormatStats> stats;
+        std::vector<Failure> failures;
+
+        auto started = std::chrono::steady_clock::now();
+        {
+            Base::ThreadPool pool(threads);
+            std::vector<std::future<void>> workers;
+            for (unsigned int i = 0; i != pool.size(); ++i) {
+                workers.push_back(pool.enqueue([&]() {
+                    std::map<std::string, FormatStats> workerStats;
+                    std::vector<Failure> workerFailures;
+                    for (size_t entry = next++; entry < entries.size(); entry = next++) {
+                        auto& archive = archives[entries[entry].first];
+                        auto& path = archive.paths[entries[entry].second];
+                        auto entryFormat = format(path);
+                        auto& formatStats = workerStats[entryFormat];
+
+                        auto entryStarted = std::chrono::steady_clock::now();
+                        try {
+                            formatStats.bytes += validate(*archive.driver, path, entryFormat);
+                        } catch (const std::exception& e) {
+                            formatStats.failures++;
+                            workerFailures.push_back({archive.filename, path, e.what()});
+                        }
+                        formatStats.files++;
+                        formatStats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - entryStarted).count();
+                    }
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for (auto& it : workerStats) {
+                        auto& total = stats[it.first];
+                        total.files += it.second.files;
+                        total.failures += it.second.failures;
+                        total.bytes += it.second.bytes;
+                        total.seconds += it.second.seconds;
+                    }
+                    failures.insert(failures.end(), workerFailures.begin(), workerFailures.end());
+                }));
+            }
+            for (auto& worker : workers) {
+                worker.get();
+            }
+            threads = pool.size();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::sort(failures.begin(), failures.end(), [](const Failure& a, const Failure& b) {
+            return a.archive != b.archive ? a.archive < b.archive : a.path < b.path;
+        });
+
+        unsigned long long bytes = 0;
+        for (auto& it : stats) {
+            bytes += it.second.bytes;
+        }
+
+        report << std::fixed << std::setprecision(3);
+        report << "{\"archives\": " << archives.size()
+            << ", \"files\": " << entries.size()
+            << ", \"failures\": " << failures.size()
+            << ", \"threads\": " << threads
+            << ", \"seconds\": " << seconds
+            << ", \"mb_per_second\": " << (seconds > 0.0 ? bytes / seconds / 1048576.0 : 0.0)
+            << ", \"formats\": {";
+        bool first = true;
+        for (auto& it : stats) {
+            // time is summed over the threads, so this is the throughput of a single one
+            auto& formatStats = it.second;
+            report << (first ? "" : ", ") << jsonString(it.first) << ": {\"files\": " << formatStats.files
+                << ", \"failures\": " << formatStats.failures
+                << ", \"bytes\": " << formatStats.bytes
+                << ", \"seconds\": " << formatStats.seconds
+                << ", \"mb_per_second\": " << (formatStats.seconds > 0.0 ? formatStats.bytes / formatStats.seconds / 1048576.0 : 0.0)
+                << "}";
+            first = false;
+        }
+        report << "}, \"errors\": [";
+        first = true;
+        for (auto& failure : failures) {
+            report << (first ? "" : ", ") << "{\"archive\": " << jsonString(failure.archive)
+                << ", \"path\": " << jsonString(failure.path)
+                << ", \"error\": " << jsonString(failure.error) << "}";
+            first = false;
+        }
+        report << "]}" << std::endl;
+
+        for (auto& failure : failures) {
+            _logger->error() << "[VALIDATOR] " << failure.archive << ": " << failure.path << ": " << failure.error << std::endl;
+        }
+        return failures.size();
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include "ILogger.h"
+
+namespace Falltergeist
+{
+    /**
+     * Reads every entry of every Fallout DAT file, shadowed ones included, and parses it with the parser of its format.
+     * Entries are spread over threads which inflate them straight from the archives, so a run is also a stress test
+     * of the readers. Entries which can't be inflated in full or fail to parse are reported with the bytes and time
+     * spent on every format.
+     */
+    class DataValidator
+    {
+        public:
+            DataValidator(std::shared_ptr<ILogger> logger);
+
+            // Writes the JSON report, returns the number of failed entries
+            size_t run(unsigned int threads, std::ostream& report);
+
+        private:
+            std::shared_ptr<ILogger> _logger;
+    };
+}
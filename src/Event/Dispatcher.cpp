@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <type_traits>
 #include <memory>
 #include <utility>
@@ -10,72 +11,121 @@ namespace Falltergeist
 {
     namespace Event
     {
-
-        Dispatcher::AbstractTask::AbstractTask(EventTarget* target) : target(target) {}
-
-        template <typename T>
-        Dispatcher::Task<T>::Task(EventTarget* target, std::unique_ptr<T> event, Base::Delegate<T*> handler)
-            : AbstractTask(target), event(std::move(event)), handler(handler)
+        namespace
         {
-            static_assert(std::is_base_of<Event, T>::value, "T should be derived from Event::Event.");
+            const size_t INITIAL_TASKS = 256;
         }
 
+        thread_local Dispatcher::Buffer* Dispatcher::_recording = nullptr;
+
         template <typename T>
-        void Dispatcher::Task<T>::perform()
+        void Dispatcher::_perform(Task& task)
         {
-            for (auto& func : handler.functors())
+            auto event = static_cast<T*>(task.event.get());
+            auto functors = static_cast<const typename Base::Delegate<T*>::FunctorCollection*>(task.functors.get());
+            for (auto& func : *functors)
             {
-                func(event.get());
+                func(event);
                 // handler may call stopPropagation() - to stop other handlers from executing
                 // also, target may be deleted by any handler, so we should check that on every iteration
-                if (event->isHandled() || target == nullptr) {
+                if (event->isHandled() || task.target == nullptr) {
                     break;
                 }
             }
         }
 
         template<typename T>
-        void Dispatcher::scheduleEvent(EventTarget* target, std::unique_ptr<T> eventArg, Base::Delegate<T*> handlerArg)
+        void Dispatcher::scheduleEvent(EventTarget* target, std::unique_ptr<T> eventArg, const Base::Delegate<T*>& handlerArg)
         {
-            _scheduledTasks.emplace_back(std::make_unique<Task<T>>(target, std::move(eventArg), std::move(handlerArg)));
+            static_assert(std::is_base_of<Event, T>::value, "T should be derived from Event::Event.");
+            Task task;
+            task.target = target;
+            task.event = std::move(eventArg);
+            task.functors = handlerArg.shared();
+            task.perform = &Dispatcher::_perform<T>;
+            if (_recording) {
+                _recording->_tasks.push_back(std::move(task));
+                return;
+            }
+            _push(std::move(task));
+        }
+
+        void Dispatcher::record(Buffer* buffer)
+        {
+            _recording = buffer;
+        }
+
+        void Dispatcher::replay(Buffer& buffer, size_t first, size_t last)
+        {
+            for (size_t i = first; i != last; ++i)
+            {
+                _push(std::move(buffer._tasks[i]));
+            }
         }
 
         void Dispatcher::processScheduledEvents()
         {
-            while (!_scheduledTasks.empty())
+            // events scheduled by the handlers are processed in the same call, after the ones already queued
+            while (_count > 0)
             {
-                swap(_tasksInProcess, _scheduledTasks);
-                for (auto& task : _tasksInProcess)
-                {
-                    // after previous tasks this target might already be "dead"
-                    if (task->target == nullptr) {
-                        continue;
-                    }
-                    task->perform();
+                Task task = std::move(_tasks[_head]);
+                _head = (_head + 1) % _tasks.size();
+                _count--;
+
+                // after previous tasks this target might already be "dead"
+                if (task.target == nullptr || !task.functors) {
+                    continue;
+                }
+                _performing.push_back(&task);
+                task.perform(task);
+                _performing.pop_back();
+                if (task.target) {
+                    task.target->_scheduledTasks--;
                 }
-                _tasksInProcess.clear();
             }
         }
 
         void Dispatcher::blockEventHandlers(EventTarget* eventTarget)
         {
-            _scheduledTasks.remove_if([eventTarget](std::unique_ptr<Dispatcher::AbstractTask>& task)
+            // most targets are destroyed with nothing pending, the others stop the search at their last task
+            auto block = [eventTarget](Task& task)
+            {
+                if (task.target == eventTarget) {
+                    task.target = nullptr;
+                    eventTarget->_scheduledTasks--;
+                }
+            };
+            for (auto it = _performing.rbegin(); eventTarget->_scheduledTasks != 0 && it != _performing.rend(); ++it)
             {
-                return (task->target == eventTarget);
-            });
-            for (auto& task : _tasksInProcess)
+                block(**it);
+            }
+            for (size_t i = 0; eventTarget->_scheduledTasks != 0 && i != _count; ++i)
             {
-                if (task->target == eventTarget)
-                {
-                    task->target = nullptr;
+                block(_tasks[(_head + i) % _tasks.size()]);
+            }
+        }
+
+        void Dispatcher::_push(Task task)
+        {
+            if (_count == _tasks.size()) {
+                std::vector<Task> tasks(std::max(INITIAL_TASKS, _tasks.size() * 2));
+                for (size_t i = 0; i != _count; ++i) {
+                    tasks[i] = std::move(_tasks[(_head + i) % _tasks.size()]);
                 }
+                _tasks.swap(tasks);
+                _head = 0;
+            }
+            if (task.target) {
+                task.target->_scheduledTasks++;
             }
+            _tasks[(_head + _count) % _tasks.size()] = std::move(task);
+            _count++;
         }
 
         // instantiations for all event types..
-        template void Dispatcher::scheduleEvent<Event>(EventTarget*, std::unique_ptr<Event>, Base::Delegate<Event*>);
-        template void Dispatcher::scheduleEvent<Mouse>(EventTarget*, std::unique_ptr<Mouse>, Base::Delegate<Mouse*>);
-        template void Dispatcher::scheduleEvent<Keyboard>(EventTarget*, std::unique_ptr<Keyboard>, Base::Delegate<Keyboard*>);
-        template void Dispatcher::scheduleEvent<State>(EventTarget*, std::unique_ptr<State>, Base::Delegate<State*>);
+        template void Dispatcher::scheduleEvent<Event>(EventTarget*, std::unique_ptr<Event>, const Base::Delegate<Event*>&);
+        template void Dispatcher::scheduleEvent<Mouse>(EventTarget*, std::unique_ptr<Mouse>, const Base::Delegate<Mouse*>&);
+        template void Dispatcher::scheduleEvent<Keyboard>(EventTarget*, std::unique_ptr<Keyboard>, const Base::Delegate<Keyboard*>&);
+        template void Dispatcher::scheduleEvent<State>(EventTarget*, std::unique_ptr<State>, const Base::Delegate<State*>&);
     }
 }
@@ -1,5 +1,7 @@
-#include <list>
+#pragma once
+
 #include <memory>
+#include <vector>
 #include "../Event/Event.h"
 #include "../Event/EventTarget.h"
 
@@ -9,38 +11,68 @@ namespace Falltergeist
     {
         class Dispatcher
         {
+            private:
+                struct Task
+                {
+                    // nullptr once the target is deleted
+                    EventTarget* target = nullptr;
+                    std::unique_ptr<Event> event;
+                    // functors of the handler when the event was scheduled, shared with the handler
+                    std::shared_ptr<const void> functors;
+                    void (*perform)(Task& task) = nullptr;
+                };
+
             public:
+                // Events recorded by a worker thread, queued later by the main thread in the order they were scheduled
+                class Buffer
+                {
+                    public:
+                        size_t size() const
+                        {
+                            return _tasks.size();
+                        }
+
+                        void clear()
+                        {
+                            _tasks.clear();
+                        }
+
+                    private:
+                        friend class Dispatcher;
+                        std::vector<Task> _tasks;
+                };
+
                 Dispatcher() {}
                 Dispatcher(const Dispatcher&) = delete;
                 void operator=(const Dispatcher&) = delete;
 
                 template<typename T>
-                void scheduleEvent(EventTarget* target, std::unique_ptr<T> eventArg, Base::Delegate<T*> handlerArg);
+                void scheduleEvent(EventTarget* target, std::unique_ptr<T> eventArg, const Base::Delegate<T*>& handlerArg);
 
                 void processScheduledEvents();
                 void blockEventHandlers(EventTarget* eventTarget);
 
-            private:
-                struct AbstractTask
-                {
-                    explicit AbstractTask(EventTarget* target);
-                    virtual ~AbstractTask() = default;
-                    virtual void perform() = 0;
+                // Until called again with nullptr, events scheduled on the calling thread go to the buffer instead of the queue
+                static void record(Buffer* buffer);
 
-                    EventTarget* target;
-                };
+                // Queues the recorded events from first to last, main thread only
+                void replay(Buffer& buffer, size_t first, size_t last);
+
+            private:
+                static thread_local Buffer* _recording;
 
                 template <typename T>
-                struct Task : AbstractTask
-                {
-                    Task(EventTarget* target, std::unique_ptr<T> event, Base::Delegate<T*> handler);
-                    void perform() override;
+                static void _perform(Task& task);
 
-                    std::unique_ptr<T> event;
-                    Base::Delegate<T*> handler;
-                };
+                // ring buffer of scheduled tasks, doubled when full
+                std::vector<Task> _tasks;
+                size_t _head = 0;
+                size_t _count = 0;
+
+                // tasks taken out of the buffer (which may grow while they run), more than one if processing is nested
+                std::vector<Task*> _performing;
 
-                std::list<std::unique_ptr<AbstractTask>> _scheduledTasks, _tasksInProcess;
+                void _push(Task task);
         };
     }
 }
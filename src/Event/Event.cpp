@@ -1,9 +1,53 @@
+#include <mutex>
+#include "../Base/Pool.h"
 #include "../Event/Event.h"
 
 namespace Falltergeist
 {
     namespace Event
     {
+        namespace
+        {
+            // large enough for mouse, keyboard and state events
+            const size_t POOLED_EVENT_SIZE = 128;
+
+            // never destroyed, events can outlive static objects at exit
+            Base::Pool<POOLED_EVENT_SIZE, 256>* pool()
+            {
+                static auto pool = new Base::Pool<POOLED_EVENT_SIZE, 256>();
+                return pool;
+            }
+
+            // objects thinking on worker threads emit events as well
+            std::mutex& poolMutex()
+            {
+                static auto mutex = new std::mutex();
+                return *mutex;
+            }
+        }
+
+        void* Event::operator new(size_t size)
+        {
+            if (size > POOLED_EVENT_SIZE) {
+                return ::operator new(size);
+            }
+            std::lock_guard<std::mutex> lock(poolMutex());
+            return pool()->allocate();
+        }
+
+        void Event::operator delete(void* pointer, size_t size)
+        {
+            if (!pointer) {
+                return;
+            }
+            if (size > POOLED_EVENT_SIZE) {
+                ::operator delete(pointer);
+                return;
+            }
+            std::lock_guard<std::mutex> lock(poolMutex());
+            pool()->deallocate(pointer);
+        }
+
         Event::Event(const std::string& name) : _name(name) {
         }
 
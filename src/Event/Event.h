@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include "../Event/IEvent.h"
 
@@ -18,6 +19,11 @@ namespace Falltergeist {
 
             virtual ~Event() override = default;
 
+            // Events of every type up to a fixed size are allocated from a shared pool
+            static void* operator new(size_t size);
+
+            static void operator delete(void* pointer, size_t size);
+
             const std::string& name() const override;
 
             bool isHandled() const override;
@@ -16,7 +16,10 @@ namespace Falltergeist
         EventTarget::~EventTarget()
         {
             // notify Event Dispatcher that this target was deleted, it should not process any further events for this object
-            _eventDispatcher->blockEventHandlers(this);
+            // objects created outside of an initialized game (benchmarks) have no dispatcher
+            if (_eventDispatcher) {
+                _eventDispatcher->blockEventHandlers(this);
+            }
         }
 
         template<typename T>
@@ -25,7 +28,7 @@ namespace Falltergeist
             static_assert(std::is_base_of<Event, T>::value, "T should be derived from Event::Event.");
             if (handler)
             {
-                _eventDispatcher->scheduleEvent<T>(this, std::move(event), handler); // handler copy is necessary here
+                _eventDispatcher->scheduleEvent<T>(this, std::move(event), handler); // functors are shared, not copied
             }
         }
 
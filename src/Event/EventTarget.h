@@ -23,7 +23,11 @@ namespace Falltergeist
                 void emitEvent(std::unique_ptr<T> event, const Base::Delegate<T*>& handler);
 
             private:
+                friend class Dispatcher;
+
                 Dispatcher* _eventDispatcher;
+                // tasks of the dispatcher queued or running for this target, so destroying a target without any skips the search
+                unsigned int _scheduledTasks = 0;
         };
     }
 }
@@ -13,6 +13,7 @@ namespace Falltergeist
         {
             _button = event._button;
             _position = event._position;
+            _offset = event._offset;
             _shiftPressed = event._shiftPressed;
             _controlPressed = event._controlPressed;
             _altPressed = event._altPressed;
@@ -92,6 +93,16 @@ namespace Falltergeist
             _position = position;
         }
 
+        const Point& Mouse::offset() const
+        {
+            return _offset;
+        }
+
+        void Mouse::setOffset(const Point& offset)
+        {
+            _offset = offset;
+        }
+
         bool Mouse::obstacle() const
         {
             return _obstacle;
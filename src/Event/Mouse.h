@@ -47,6 +47,12 @@ namespace Falltergeist
                 const Point& position() const;
                 void setPosition(const Point& position);
 
+                /**
+                 * Motion since the previous move event, the moves of a frame are merged into its last one.
+                 */
+                const Point& offset() const;
+                void setOffset(const Point& offset);
+
                 /**
                  * @brief Which button was pressed during mouse button events.
                  */
@@ -98,6 +104,8 @@ namespace Falltergeist
                 Type _type;
 
                 Point _position;
+
+                Point _offset;
         };
     }
 }
@@ -22,6 +22,7 @@ namespace Falltergeist
                         return 0;
                     }
                 }
+                _state.resize(_blockSize);
                 return 1;
             }
 
@@ -55,133 +56,148 @@ namespace Falltergeist
                 }
             }
 
+            // The transforms below run row by row over all the columns of a wide subband, the columns are independent.
+            // Inner loops walk contiguous memory and get vectorized by the compiler, the results are the same
+            // as of the column by column loops of the original code, which are still faster for narrow subbands.
+            static const int WIDE_SUBBAND = 16;
+
             void Decoder::_sub4d3fcc(short *memory, int *buffer, int sbSize,
                     int blocks)
             {
-                int row0 = 0, row1 = 0, row2 = 0, row3 = 0, db0 = 0, db1 = 0;
-                int i = 0;
                 int sbSize2 = sbSize * 2, sbSize3 = sbSize * 3;
                 if (blocks == 2)
                 {
-                    for (i = 0; i < sbSize; i++)
+                    int *row0 = buffer, *row1 = buffer + sbSize;
+                    for (int i = 0; i < sbSize; i++)
                     {
-                        row0 = buffer[0];
-                        row1 = buffer[sbSize];
-                        buffer[0] = buffer[0] + memory[0] + 2 * memory[1];
-                        buffer[sbSize] = 2 * row0 - memory[1] - buffer[sbSize];
-                        memory[0] = (short) row0;
-                        memory[1] = (short) row1;
+                        int r0 = row0[i], r1 = row1[i];
+                        int m0 = memory[i * 2], m1 = memory[i * 2 + 1];
+                        row0[i] = r0 + m0 + 2 * m1;
+                        row1[i] = 2 * r0 - m1 - r1;
+                        memory[i * 2] = (short) r0;
+                        memory[i * 2 + 1] = (short) r1;
+                    }
+                    return;
+                }
 
-                        memory += 2;
-                        buffer++;
+                if (blocks == 4)
+                {
+                    int *row0 = buffer, *row1 = buffer + sbSize, *row2 = buffer + sbSize2, *row3 = buffer + sbSize3;
+                    for (int i = 0; i < sbSize; i++)
+                    {
+                        int r0 = row0[i], r1 = row1[i], r2 = row2[i], r3 = row3[i];
+                        int m0 = memory[i * 2], m1 = memory[i * 2 + 1];
+                        row0[i] = m0 + 2 * m1 + r0;
+                        row1[i] = -m1 + 2 * r0 - r1;
+                        row2[i] = r0 + 2 * r1 + r2;
+                        row3[i] = -r1 + 2 * r2 - r3;
+                        memory[i * 2] = (short) r2;
+                        memory[i * 2 + 1] = (short) r3;
                     }
+                    return;
                 }
-                else
-                    if (blocks == 4)
+
+                if (sbSize < WIDE_SUBBAND)
+                {
+                    int row0 = 0, row1 = 0, row2 = 0, row3 = 0, db0 = 0, db1 = 0;
+                    for (int i = 0; i < sbSize; i++)
                     {
-                        for (i = 0; i < sbSize; i++)
+                        int *buffPtr = buffer;
+                        if ((blocks >> 1) & 1)
                         {
-                            row0 = buffer[0];
-                            row1 = buffer[sbSize];
-                            row2 = buffer[sbSize2];
-                            row3 = buffer[sbSize3];
-
-                            buffer[0] = memory[0] + 2 * memory[1] + row0;
-                            buffer[sbSize] = -memory[1] + 2 * row0 - row1;
-                            buffer[sbSize2] = row0 + 2 * row1 + row2;
-                            buffer[sbSize3] = -row1 + 2 * row2 - row3;
+                            row0 = buffPtr[0];
+                            row1 = buffPtr[sbSize];
 
-                            memory[0] = (short) row2;
-                            memory[1] = (short) row3;
+                            buffPtr[0] = memory[0] + 2 * memory[1] + row0;
+                            buffPtr[sbSize] = -memory[1] + 2 * row0 - row1;
+                            buffPtr += sbSize2;
 
-                            memory += 2;
-                            buffer++;
+                            db0 = row0;
+                            db1 = row1;
                         }
-                    }
-                    else
-                    {
-                        for (i = 0; i < sbSize; i++)
+                        else
                         {
-                            int *buffPtr = buffer;
-                            if ((blocks >> 1) & 1)
-                            {
-                                row0 = buffPtr[0];
-                                row1 = buffPtr[sbSize];
-
-                                buffPtr[0] = memory[0] + 2 * memory[1] + row0;
-                                buffPtr[sbSize] = -memory[1] + 2 * row0 - row1;
-                                buffPtr += sbSize2;
-
-                                db0 = row0;
-                                db1 = row1;
-                            }
-                            else
-                            {
-                                db0 = memory[0];
-                                db1 = memory[1];
-                            }
-
-                            for (int j = 0; j < (blocks >> 2); j++)
-                            {
-                                row0 = buffPtr[0];
-                                buffPtr[0] = db0 + 2 * db1 + row0;
-                                buffPtr += sbSize;
-                                row1 = buffPtr[0];
-                                buffPtr[0] = -db1 + 2 * row0 - row1;
-                                buffPtr += sbSize;
-                                row2 = buffPtr[0];
-                                buffPtr[0] = row0 + 2 * row1 + row2;
-                                buffPtr += sbSize;
-                                row3 = buffPtr[0];
-                                buffPtr[0] = -row1 + 2 * row2 -
-                                        row3;
-                                buffPtr += sbSize;
-
-                                db0 = row2;
-                                db1 = row3;
-                            }
-                            memory[0] = (short) row2;
-                            memory[1] = (short) row3;
-                            memory += 2;
-                            buffer++;
+                            db0 = memory[0];
+                            db1 = memory[1];
                         }
-                    }
-            }
-
-            void Decoder::_sub4d420c(int *memory, int *buffer, int sbSize,
-                    int blocks)
-            {
-                int row0 = 0, row1 = 0, row2 = 0, row3 = 0, db0 = 0, db1 = 0;
-                int i = 0;
-                int sbSize2 = sbSize * 2, sbSize3 = sbSize * 3;
-                if (blocks == 4)
-                {
-                    for (i = 0; i < sbSize; i++)
-                    {
-                        row0 = buffer[0];
-                        row1 = buffer[sbSize];
-                        row2 = buffer[sbSize2];
-                        row3 = buffer[sbSize3];
-
-                        buffer[0] = memory[0] + 2 * memory[1] + row0;
-                        buffer[sbSize] = -memory[1] + 2 * row0 - row1;
-                        buffer[sbSize2] = row0 + 2 * row1 + row2;
-                        buffer[sbSize3] = -row1 + 2 * row2 - row3;
 
-                        memory[0] = row2;
-                        memory[1] = row3;
+                        for (int j = 0; j < (blocks >> 2); j++)
+                        {
+                            row0 = buffPtr[0];
+                            buffPtr[0] = db0 + 2 * db1 + row0;
+                            buffPtr += sbSize;
+                            row1 = buffPtr[0];
+                            buffPtr[0] = -db1 + 2 * row0 - row1;
+                            buffPtr += sbSize;
+                            row2 = buffPtr[0];
+                            buffPtr[0] = row0 + 2 * row1 + row2;
+                            buffPtr += sbSize;
+                            row3 = buffPtr[0];
+                            buffPtr[0] = -row1 + 2 * row2 - row3;
+                            buffPtr += sbSize;
 
+                            db0 = row2;
+                            db1 = row3;
+                        }
+                        memory[0] = (short) row2;
+                        memory[1] = (short) row3;
                         memory += 2;
                         buffer++;
                     }
+                    return;
+                }
+
+                // the state carried between rows is not truncated to short until the end
+                int *db0 = _state.data(), *db1 = _state.data() + sbSize;
+                int *rows = buffer;
+                if ((blocks >> 1) & 1)
+                {
+                    int *row0 = rows, *row1 = rows + sbSize;
+                    for (int i = 0; i < sbSize; i++)
+                    {
+                        int r0 = row0[i], r1 = row1[i];
+                        row0[i] = memory[i * 2] + 2 * memory[i * 2 + 1] + r0;
+                        row1[i] = -memory[i * 2 + 1] + 2 * r0 - r1;
+                        db0[i] = r0;
+                        db1[i] = r1;
+                    }
+                    rows += sbSize2;
                 }
                 else
                 {
-                    for (i = 0; i < sbSize; i++)
+                    for (int i = 0; i < sbSize; i++)
+                    {
+                        db0[i] = memory[i * 2];
+                        db1[i] = memory[i * 2 + 1];
+                    }
+                }
+
+                int groups = blocks >> 2;
+                for (int j = 0; j < groups; j++)
+                {
+                    _transformRows(rows, db0, db1, sbSize);
+                    rows += sbSize * 4;
+                }
+
+                for (int i = 0; i < sbSize; i++)
+                {
+                    // the original leaves zeros behind if there were no rows to transform
+                    memory[i * 2] = groups ? (short) db0[i] : 0;
+                    memory[i * 2 + 1] = groups ? (short) db1[i] : 0;
+                }
+            }
+
+            void Decoder::_sub4d420c(int *memory, int *buffer, int sbSize,
+                    int blocks)
+            {
+                if (sbSize < WIDE_SUBBAND)
+                {
+                    int row0 = 0, row1 = 0, row2 = 0, row3 = 0;
+                    for (int i = 0; i < sbSize; i++)
                     {
                         int *buffPtr = buffer;
-                        db0 = memory[0];
-                        db1 = memory[1];
+                        int db0 = memory[0];
+                        int db1 = memory[1];
                         for (int j = 0; j < (blocks >> 2); j++)
                         {
                             row0 = buffPtr[0];
@@ -194,8 +210,7 @@ namespace Falltergeist
                             buffPtr[0] = row0 + 2 * row1 + row2;
                             buffPtr += sbSize;
                             row3 = buffPtr[0];
-                            buffPtr[0] = -row1 + 2 * row2 -
-                                    row3;
+                            buffPtr[0] = -row1 + 2 * row2 - row3;
                             buffPtr += sbSize;
 
                             db0 = row2;
@@ -207,6 +222,44 @@ namespace Falltergeist
                         memory += 2;
                         buffer++;
                     }
+                    return;
+                }
+
+                int *db0 = _state.data(), *db1 = _state.data() + sbSize;
+                for (int i = 0; i < sbSize; i++)
+                {
+                    db0[i] = memory[i * 2];
+                    db1[i] = memory[i * 2 + 1];
+                }
+
+                int groups = blocks >> 2;
+                int *rows = buffer;
+                for (int j = 0; j < groups; j++)
+                {
+                    _transformRows(rows, db0, db1, sbSize);
+                    rows += sbSize * 4;
+                }
+
+                for (int i = 0; i < sbSize; i++)
+                {
+                    memory[i * 2] = groups ? db0[i] : 0;
+                    memory[i * 2 + 1] = groups ? db1[i] : 0;
+                }
+            }
+
+            void Decoder::_transformRows(int *rows, int *__restrict db0, int *__restrict db1, int sbSize)
+            {
+                int *__restrict row0 = rows, *__restrict row1 = rows + sbSize;
+                int *__restrict row2 = rows + sbSize * 2, *__restrict row3 = rows + sbSize * 3;
+                for (int i = 0; i < sbSize; i++)
+                {
+                    int r0 = row0[i], r1 = row1[i], r2 = row2[i], r3 = row3[i];
+                    row0[i] = db0[i] + 2 * db1[i] + r0;
+                    row1[i] = -db1[i] + 2 * r0 - r1;
+                    row2[i] = r0 + 2 * r1 + r2;
+                    row3[i] = -r1 + 2 * r2 - r3;
+                    db0[i] = r2;
+                    db1[i] = r3;
                 }
             }
 
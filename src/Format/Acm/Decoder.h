@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <vector>
+
 namespace Falltergeist
 {
     namespace Format
@@ -24,10 +26,15 @@ namespace Falltergeist
                 private:
                     int _levels, _blockSize;
                     int *_memoryBuffer;
+                    // two values per column of the widest subband, carried from row to row
+                    std::vector<int> _state;
 
                     void _sub4d3fcc(short *memory, int *buffer, int sbSize, int blocks);
 
                     void _sub4d420c(int *memory, int *buffer, int sbSize, int blocks);
+
+                    // Transforms the next four rows of a subband
+                    void _transformRows(int *rows, int *db0, int *db1, int sbSize);
             };
         }
     }
@@ -3,6 +3,7 @@
 // and then adapted for Falltergeist. All credit goes to the original authors.
 // Link to the plugin: https://github.com/gemrb/gemrb/tree/8e759bc6874a80d4a8d73bf79603624465b3aeb0/gemrb/plugins/ACMReader
 
+#include <algorithm>
 #include "../Acm/File.h"
 #include "../Acm/Decoder.h"
 #include "../Acm/General.h"
@@ -98,11 +99,14 @@ namespace Falltergeist
                             break;
                         }
                     }
-                    *buffer = ( short ) ( (*_values) >> _levels);
-                    _values++;
-                    buffer++;
-                    res += 1;
-                    _samplesReady--;
+                    size_t ready = std::min(count - res, (size_t) _samplesReady);
+                    for (size_t i = 0; i < ready; i++) {
+                        buffer[i] = ( short ) (_values[i] >> _levels);
+                    }
+                    _values += ready;
+                    buffer += ready;
+                    res += ready;
+                    _samplesReady -= (int) ready;
                 }
                 return res;
             }
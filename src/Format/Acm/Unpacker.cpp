@@ -3,6 +3,7 @@
 // and then adapted for Falltergeist. All credit goes to the original authors.
 // Link to the plugin: https://github.com/gemrb/gemrb/tree/8e759bc6874a80d4a8d73bf79603624465b3aeb0/gemrb/plugins/ACMReader
 
+#include <array>
 #include <cstdlib>
 #include "../../Format/Dat/Stream.h"
 #include "Unpacker.h"
@@ -69,9 +70,140 @@ namespace Falltergeist
                     &ValueUnpacker::return0, &ValueUnpacker::return0
             };
 
+            // Prefix codes of the k* fillers, decoded from the low bits of the bit buffer.
+            // Each filler reads from a table of all the possible peeked values instead of branching per value.
+            static FillerCode k1_3bitsCode(unsigned int bits)
+            {
+                if ((bits & 1) == 0) {
+                    return {0, 1, true};
+                }
+                if ((bits & 2) == 0) {
+                    return {0, 2, false};
+                }
+                return {(signed char) ((bits & 4) ? 1 : -1), 3, false};
+            }
+
+            static FillerCode k1_2bitsCode(unsigned int bits)
+            {
+                if ((bits & 1) == 0) {
+                    return {0, 1, false};
+                }
+                return {(signed char) ((bits & 2) ? 1 : -1), 2, false};
+            }
+
+            static FillerCode k2_4bitsCode(unsigned int bits)
+            {
+                if ((bits & 1) == 0) {
+                    return {0, 1, true};
+                }
+                if ((bits & 2) == 0) {
+                    return {0, 2, false};
+                }
+                return {(signed char) ((bits & 8) ? ((bits & 4) ? 2 : 1) : ((bits & 4) ? -1 : -2)), 4, false};
+            }
+
+            static FillerCode k2_3bitsCode(unsigned int bits)
+            {
+                if ((bits & 1) == 0) {
+                    return {0, 1, false};
+                }
+                return {(signed char) ((bits & 4) ? ((bits & 2) ? 2 : 1) : ((bits & 2) ? -1 : -2)), 3, false};
+            }
+
+            static FillerCode k3_5bitsCode(unsigned int bits)
+            {
+                if ((bits & 1) == 0) {
+                    return {0, 1, true};
+                }
+                if ((bits & 2) == 0) {
+                    return {0, 2, false};
+                }
+                if ((bits & 4) == 0) {
+                    return {(signed char) ((bits & 8) ? 1 : -1), 4, false};
+                }
+                int val = (bits & 0x18) >> 3;
+                if (val >= 2) {
+                    val += 3;
+                }
+                return {(signed char) (-3 + val), 5, false};
+            }
+
+            static FillerCode k3_4bitsCode(unsigned int bits)
+            {
+                if ((bits & 1) == 0) {
+                    return {0, 1, false};
+                }
+                if ((bits & 2) == 0) {
+                    return {(signed char) ((bits & 4) ? 1 : -1), 3, false};
+                }
+                int val = (bits & 0xC) >> 2;
+                if (val >= 2) {
+                    val += 3;
+                }
+                return {(signed char) (-3 + val), 4, false};
+            }
+
+            static FillerCode k4_5bitsCode(unsigned int bits)
+            {
+                if ((bits & 1) == 0) {
+                    return {0, 1, true};
+                }
+                if ((bits & 2) == 0) {
+                    return {0, 2, false};
+                }
+                int val = (bits & 0x1C) >> 2;
+                if (val >= 4) {
+                    val++;
+                }
+                return {(signed char) (-4 + val), 5, false};
+            }
+
+            static FillerCode k4_4bitsCode(unsigned int bits)
+            {
+                if ((bits & 1) == 0) {
+                    return {0, 1, false};
+                }
+                int val = (bits & 0xE) >> 1;
+                if (val >= 4) {
+                    val++;
+                }
+                return {(signed char) (-4 + val), 4, false};
+            }
+
+            template <int Bits, FillerCode (*Rule)(unsigned int)>
+            static const FillerCode* codes()
+            {
+                static const std::array<FillerCode, 1 << Bits> table = []() {
+                    std::array<FillerCode, 1 << Bits> result;
+                    for (unsigned int bits = 0; bits != result.size(); ++bits)
+                    {
+                        result[bits] = Rule(bits);
+                    }
+                    return result;
+                }();
+                return table.data();
+            }
+
             inline void ValueUnpacker::_prepareBits(int bits)
             {
-                while (bits > _availBits)
+                if (bits <= _availBits)
+                {
+                    return;
+                }
+
+                // take as many whole bytes as fit, so most requests don't refill at all
+                int bytes = (64 - _availBits) >> 3;
+                if (UNPACKER_BUFFER_SIZE - _bufferBitOffset >= (size_t) bytes)
+                {
+                    for (int i = 0; i < bytes; i++)
+                    {
+                        _nextBits |= ((uint64_t) _bitsBuffer[_bufferBitOffset++] << _availBits);
+                        _availBits += 8;
+                    }
+                    return;
+                }
+
+                while (_availBits <= 56)
                 {
                     unsigned char one_byte = 0;
                     if (_bufferBitOffset == UNPACKER_BUFFER_SIZE)
@@ -98,7 +230,7 @@ namespace Falltergeist
                     {
                         one_byte = 0;
                     }
-                    _nextBits |= ((unsigned int) one_byte << _availBits);
+                    _nextBits |= ((uint64_t) one_byte << _availBits);
                     _availBits += 8;
                 }
             }
@@ -106,12 +238,33 @@ namespace Falltergeist
             int ValueUnpacker::_getBits(int bits)
             {
                 _prepareBits(bits);
-                int res = _nextBits;
+                int res = (int) (_nextBits & ((1u << bits) - 1));
                 _availBits -= bits;
                 _nextBits >>= bits;
                 return res;
             }
 
+            template <int Bits>
+            inline void ValueUnpacker::_fillCodes(int pass, const FillerCode* codes)
+            {
+                for (int i = 0; i < _subblocks; i++)
+                {
+                    _prepareBits(Bits);
+                    const FillerCode& code = codes[_nextBits & ((1 << Bits) - 1)];
+                    _availBits -= code.bits;
+                    _nextBits >>= code.bits;
+                    // _buffMiddle[0] is always zero
+                    _blockPtr[i * _sbSize + pass] = _buffMiddle[code.value];
+                    if (code.pair)
+                    {
+                        if ((++i) == _subblocks) {
+                            break;
+                        }
+                        _blockPtr[i * _sbSize + pass] = 0;
+                    }
+                }
+            }
+
             int ValueUnpacker::init()
             {
                 //using malloc, supposed to be faster
@@ -190,35 +343,7 @@ namespace Falltergeist
                 // column with number pass is filled with zeros, and also +/-1, zeros are repeated frequently
                 // efficiency (bits per value): 3-p0-2.5*p00, p00 - cnt of paired zeros, p0 - cnt of single zeros.
                 // it makes sense to use, when the freqnecy of paired zeros (p00) is greater than 2/3
-                for (int i = 0; i < _subblocks; i++)
-                {
-                    _prepareBits(3);
-                    if ((_nextBits & 1) == 0)
-                    {
-                        _availBits--;
-                        _nextBits >>= 1;
-                        _blockPtr[i * _sbSize + pass] = 0;
-                        if ((++i) == _subblocks) {
-                            break;
-                        }
-                        _blockPtr[i * _sbSize + pass] = 0;
-                    }
-                    else
-                        if ((_nextBits & 2) == 0)
-                        {
-                            _availBits -= 2;
-                            _nextBits >>= 2;
-                            _blockPtr[i * _sbSize + pass] = 0;
-                        }
-                        else
-                        {
-                            _blockPtr[i * _sbSize + pass] = (_nextBits & 4) ?
-                                    _buffMiddle[1] :
-                                    _buffMiddle[-1];
-                            _availBits -= 3;
-                            _nextBits >>= 3;
-                        }
-                }
+                _fillCodes<3>(pass, codes<3, k1_3bitsCode>());
                 return 1;
             }
 
@@ -227,24 +352,7 @@ namespace Falltergeist
                 // column is filled with zero and +/-1
                 // efficiency: 2-P0. P0 - cnt of any zero (P0 = p0 + p00)
                 // use it when P0 > 1/3
-                for (int i = 0; i < _subblocks; i++)
-                {
-                    _prepareBits(2);
-                    if ((_nextBits & 1) == 0)
-                    {
-                        _availBits--;
-                        _nextBits >>= 1;
-                        _blockPtr[i * _sbSize + pass] = 0;
-                    }
-                    else
-                    {
-                        _blockPtr[i * _sbSize + pass] = (_nextBits & 2) ?
-                                _buffMiddle[1] :
-                                _buffMiddle[-1];
-                        _availBits -= 2;
-                        _nextBits >>= 2;
-                    }
-                }
+                _fillCodes<2>(pass, codes<2, k1_2bitsCode>());
                 return 1;
             }
 
@@ -278,35 +386,7 @@ namespace Falltergeist
                 // -2, -1, 0, 1, 2, and repeating zeros
                 // efficiency: 4-2*p0-3.5*p00, p00 - cnt of paired zeros, p0 - cnt of single zeros.
                 //  makes sense to use when p00>2/3
-                for (int i = 0; i < _subblocks; i++)
-                {
-                    _prepareBits(4);
-                    if ((_nextBits & 1) == 0)
-                    {
-                        _availBits--;
-                        _nextBits >>= 1;
-                        _blockPtr[i * _sbSize + pass] = 0;
-                        if ((++i) == _subblocks) {
-                            break;
-                        }
-                        _blockPtr[i * _sbSize + pass] = 0;
-                    }
-                    else
-                        if ((_nextBits & 2) == 0)
-                        {
-                            _availBits -= 2;
-                            _nextBits >>= 2;
-                            _blockPtr[i * _sbSize + pass] = 0;
-                        }
-                        else
-                        {
-                            _blockPtr[i * _sbSize + pass] = (_nextBits & 8) ?
-                                    ((_nextBits & 4) ? _buffMiddle[2] : _buffMiddle[1]) :
-                                    ((_nextBits & 4) ? _buffMiddle[-1] : _buffMiddle[-2]);
-                            _availBits -= 4;
-                            _nextBits >>= 4;
-                        }
-                }
+                _fillCodes<4>(pass, codes<4, k2_4bitsCode>());
                 return 1;
             }
 
@@ -315,24 +395,7 @@ namespace Falltergeist
                 // -2, -1, 0, 1, 2
                 // efficiency: 3-2*P0, P0 - cnt of any zero (P0 = p0 + p00)
                 // use when P0>1/3
-                for (int i = 0; i < _subblocks; i++)
-                {
-                    _prepareBits(3);
-                    if ((_nextBits & 1) == 0)
-                    {
-                        _availBits--;
-                        _nextBits >>= 1;
-                        _blockPtr[i * _sbSize + pass] = 0;
-                    }
-                    else
-                    {
-                        _blockPtr[i * _sbSize + pass] = (_nextBits & 4) ?
-                                ((_nextBits & 2) ? _buffMiddle[2] : _buffMiddle[1]) :
-                                ((_nextBits & 2) ? _buffMiddle[-1] : _buffMiddle[-2]);
-                        _availBits -= 3;
-                        _nextBits >>= 3;
-                    }
-                }
+                _fillCodes<3>(pass, codes<3, k2_3bitsCode>());
                 return 1;
             }
 
@@ -366,46 +429,7 @@ namespace Falltergeist
                 // fills with values: -3, -2, -1, 0, 1, 2, 3, and double zeros
                 // efficiency: 5-3*p0-4.5*p00-p1, p00 - cnt of paired zeros, p0 - cnt of single zeros, p1 - cnt of +/- 1.
                 // can be used when frequency of paired zeros (p00) is greater than 2/3
-                for (int i = 0; i < _subblocks; i++)
-                {
-                    _prepareBits(5);
-                    if ((_nextBits & 1) == 0)
-                    {
-                        _availBits--;
-                        _nextBits >>= 1;
-                        _blockPtr[i * _sbSize + pass] = 0;
-                        if ((++i) == _subblocks) {
-                            break;
-                        }
-                        _blockPtr[i * _sbSize + pass] = 0;
-                    }
-                    else
-                        if ((_nextBits & 2) == 0)
-                        {
-                            _availBits -= 2;
-                            _nextBits >>= 2;
-                            _blockPtr[i * _sbSize + pass] = 0;
-                        }
-                        else
-                            if ((_nextBits & 4) == 0)
-                            {
-                                _blockPtr[i * _sbSize + pass] = (_nextBits & 8) ?
-                                        _buffMiddle[1] :
-                                        _buffMiddle[-1];
-                                _availBits -= 4;
-                                _nextBits >>= 4;
-                            }
-                            else
-                            {
-                                _availBits -= 5;
-                                int val = (_nextBits & 0x18) >> 3;
-                                _nextBits >>= 5;
-                                if (val >= 2) {
-                                    val += 3;
-                                }
-                                _blockPtr[i * _sbSize + pass] = _buffMiddle[-3 + val];
-                            }
-                }
+                _fillCodes<5>(pass, codes<5, k3_5bitsCode>());
                 return 1;
             }
 
@@ -413,35 +437,7 @@ namespace Falltergeist
             {
                 // fills with values: -3, -2, -1, 0, 1, 2, 3.
                 // efficiency: 4-3*P0-p1, P0 - cnt of all zeros (P0 = p0 + p00), p1 - cnt of +/- 1.
-                for (int i = 0; i < _subblocks; i++)
-                {
-                    _prepareBits(4);
-                    if ((_nextBits & 1) == 0)
-                    {
-                        _availBits--;
-                        _nextBits >>= 1;
-                        _blockPtr[i * _sbSize + pass] = 0;
-                    }
-                    else
-                        if ((_nextBits & 2) == 0)
-                        {
-                            _availBits -= 3;
-                            _blockPtr[i * _sbSize + pass] = (_nextBits & 4) ?
-                                    _buffMiddle[1] :
-                                    _buffMiddle[-1];
-                            _nextBits >>= 3;
-                        }
-                        else
-                        {
-                            int val = (_nextBits & 0xC) >> 2;
-                            _availBits -= 4;
-                            _nextBits >>= 4;
-                            if (val >= 2) {
-                                val += 3;
-                            }
-                            _blockPtr[i * _sbSize + pass] = _buffMiddle[-3 + val];
-                        }
-                }
+                _fillCodes<4>(pass, codes<4, k3_4bitsCode>());
                 return 1;
             }
 
@@ -450,37 +446,7 @@ namespace Falltergeist
                 // fills with values: +/-4, +/-3, +/-2, +/-1, 0, and double zeros
                 // efficiency: 5-3*p0-4.5*p00, p00 - cnt of paired zeros, p0 - cnt of single zeros.
                 // makes sense to use when p00>2/3
-                for (int i = 0; i < _subblocks; i++)
-                {
-                    _prepareBits(5);
-                    if ((_nextBits & 1) == 0)
-                    {
-                        _availBits--;
-                        _nextBits >>= 1;
-                        _blockPtr[i * _sbSize + pass] = 0;
-                        if ((++i) == _subblocks) {
-                            break;
-                        }
-                        _blockPtr[i * _sbSize + pass] = 0;
-                    }
-                    else
-                        if ((_nextBits & 2) == 0)
-                        {
-                            _availBits -= 2;
-                            _nextBits >>= 2;
-                            _blockPtr[i * _sbSize + pass] = 0;
-                        }
-                        else
-                        {
-                            int val = (_nextBits & 0x1C) >> 2;
-                            if (val >= 4) {
-                                val++;
-                            }
-                            _blockPtr[i * _sbSize + pass] = _buffMiddle[-4 + val];
-                            _availBits -= 5;
-                            _nextBits >>= 5;
-                        }
-                }
+                _fillCodes<5>(pass, codes<5, k4_5bitsCode>());
                 return 1;
             }
 
@@ -488,26 +454,7 @@ namespace Falltergeist
             {
                 // fills with values: +/-4, +/-3, +/-2, +/-1, 0, and double zeros
                 // efficiency: 4-3*P0, P0 - cnt of all zeros (both single and paired).
-                for (int i = 0; i < _subblocks; i++)
-                {
-                    _prepareBits(4);
-                    if ((_nextBits & 1) == 0)
-                    {
-                        _availBits--;
-                        _nextBits >>= 1;
-                        _blockPtr[i * _sbSize + pass] = 0;
-                    }
-                    else
-                    {
-                        int val = (_nextBits & 0xE) >> 1;
-                        _availBits -= 4;
-                        _nextBits >>= 4;
-                        if (val >= 4) {
-                            val++;
-                        }
-                        _blockPtr[i * _sbSize + pass] = _buffMiddle[-4 + val];
-                    }
-                }
+                _fillCodes<4>(pass, codes<4, k4_4bitsCode>());
                 return 1;
             }
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include "../Dat/Item.h"
 
 #define UNPACKER_BUFFER_SIZE 16384
@@ -19,6 +20,14 @@ namespace Falltergeist
 
         namespace Acm
         {
+            // Amplitude index and length of a prefix code, a pair code stands for two zeros
+            struct FillerCode
+            {
+                signed char value;
+                unsigned char bits;
+                bool pair;
+            };
+
             class ValueUnpacker
             {
                 public:
@@ -51,7 +60,7 @@ namespace Falltergeist
                     int _levels, _subblocks;
                     Dat::Stream *stream;
                     // Bits
-                    unsigned int _nextBits; // new bits
+                    uint64_t _nextBits; // new bits
                     int _availBits; // count of new bits
                     unsigned char _bitsBuffer[UNPACKER_BUFFER_SIZE];
                     size_t _bufferBitOffset;
@@ -63,6 +72,10 @@ namespace Falltergeist
                     // Reading routines
                     void _prepareBits(int bits); // request bits
                     int _getBits(int bits); // request and return next bits
+
+                    // Fills column #pass with values of the prefix codes peeked Bits at a time
+                    template <int Bits>
+                    void _fillCodes(int pass, const FillerCode* codes);
             };
 
             typedef int (ValueUnpacker::*FillerProc)(int pass, int ind);
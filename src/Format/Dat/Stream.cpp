@@ -1,9 +1,12 @@
 ﻿#include "../../Format/Dat/Stream.h"
 #include <string.h> // for memcpy
 #include <algorithm>
-#include "../../Format/Dat/Entry.h"
-#include "../../Format/Dat/File.h"
-#include "zlib.h"
+#include "../../VFS/IFile.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FALLTERGEIST_STREAM_SSSE3
+#include <immintrin.h>
+#endif
 
 namespace Falltergeist
 {
@@ -11,100 +14,199 @@ namespace Falltergeist
     {
         namespace Dat
         {
+            namespace
+            {
+                // size of data kept in memory by streamed mode
+                const size_t STREAM_CHUNK_SIZE = 64 * 1024;
+
+                // the shifts compile to bswap / rev
+                void swapScalar(uint8_t* bytes, size_t size, size_t valueSize)
+                {
+                    if (valueSize == 2)
+                    {
+                        for (size_t i = 0; i + 2 <= size; i += 2)
+                        {
+                            uint16_t value;
+                            memcpy(&value, bytes + i, 2);
+                            value = static_cast<uint16_t>(value << 8 | value >> 8);
+                            memcpy(bytes + i, &value, 2);
+                        }
+                        return;
+                    }
+                    for (size_t i = 0; i + 4 <= size; i += 4)
+                    {
+                        uint32_t value;
+                        memcpy(&value, bytes + i, 4);
+                        value = value << 24 | (value & 0xFF00) << 8 | (value >> 8 & 0xFF00) | value >> 24;
+                        memcpy(bytes + i, &value, 4);
+                    }
+                }
+
+#ifdef FALLTERGEIST_STREAM_SSSE3
+                __attribute__((target("ssse3")))
+                void swapSsse3(uint8_t* bytes, size_t size, size_t valueSize)
+                {
+                    const __m128i order = valueSize == 2
+                        ? _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)
+                        : _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+                    size_t i = 0;
+                    for (; i + 16 <= size; i += 16)
+                    {
+                        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + i), _mm_shuffle_epi8(values, order));
+                    }
+                    swapScalar(bytes + i, size - i, valueSize);
+                }
+
+                bool hasSsse3()
+                {
+                    static const bool supported = __builtin_cpu_supports("ssse3");
+                    return supported;
+                }
+#endif
+            }
+
             Stream::Stream(Stream&& other) :
                     _buffer(std::move(other._buffer)),
-                    _endianness(other._endianness)
+                    _view(std::move(other._view)),
+                    _endianness(other._endianness),
+                    _bufferOffset(other._bufferOffset),
+                    _size(other._size),
+                    _file(std::move(other._file))
             {
-                auto cBuf = _buffer.data();
-                setg(cBuf, cBuf, cBuf + _buffer.size());
+                setg(other.eback(), other.gptr(), other.egptr());
+                other.setg(nullptr, nullptr, nullptr);
+                other._size = 0;
             }
 
             Stream& Stream::operator= (Stream&& other)
             {
                 _buffer = std::move(other._buffer);
                 _endianness = other._endianness;
-                auto cBuf = _buffer.data();
-                setg(cBuf, cBuf, cBuf + _buffer.size());
+                _bufferOffset = other._bufferOffset;
+                _size = other._size;
+                _file = std::move(other._file);
+                _view = std::move(other._view);
+                setg(other.eback(), other.gptr(), other.egptr());
+                other.setg(nullptr, nullptr, nullptr);
+                other._size = 0;
                 return *this;
             }
 
-            Stream::Stream(std::ifstream& stream)
+            Stream::Stream(std::shared_ptr<VFS::IFile> file, Mode mode)
             {
-                stream.seekg(0, std::ios::end);
-                auto size = static_cast<size_t>(stream.tellg());
-                stream.seekg(0, std::ios::beg);
+                _size = file->size();
 
-                _buffer.resize(size);
-                auto cBuf = _buffer.data();
-                stream.read(cBuf, size);
-                setg(cBuf, cBuf, cBuf + size);
+                if (mode == Mode::Streamed) {
+                    _file = file;
+                    _buffer.resize(std::min(_size, STREAM_CHUNK_SIZE));
+                    auto cBuf = _buffer.data();
+                    setg(cBuf, cBuf, cBuf);
+                    return;
+                }
+
+                // No copy is needed if the file is already in memory, otherwise it is read into a block
+                // which can be shared with items parsed from the stream
+                _view = file->contents();
+                if (!_view) {
+                    auto block = std::make_shared<Base::Buffer<char>>(_size);
+                    file->seek(0, VFS::IFile::SeekFrom::Begin);
+                    _size = file->read(block->data(), static_cast<unsigned int>(_size));
+                    _view = std::shared_ptr<const unsigned char>(block, reinterpret_cast<const unsigned char*>(block->data()));
+                }
+
+                // Stream never writes to its get area
+                auto cBuf = const_cast<char*>(reinterpret_cast<const char*>(_view.get()));
+                setg(cBuf, cBuf, cBuf + _size);
             }
 
-            Stream::Stream(Entry& datFileEntry)
+            bool Stream::_readNextChunk()
             {
-                auto size = datFileEntry.unpackedSize();
-                _buffer.resize(size);
                 auto cBuf = _buffer.data();
+                _bufferOffset += egptr() - eback();
 
-                auto datFile = datFileEntry.datFile();
-                unsigned int oldPos = datFile->position();
-                datFile->setPosition(datFileEntry.dataOffset());
-
-                if (datFileEntry.compressed()) {
-                    Base::Buffer<char> packedData(datFileEntry.packedSize());
-                    datFile->readBytes(packedData.data(), datFileEntry.packedSize());
-
-                    // unpacking
-                    z_stream zStream;
-                    zStream.total_in = datFileEntry.packedSize();
-                    zStream.avail_in = datFileEntry.packedSize();
-                    zStream.next_in = reinterpret_cast<unsigned char*>(packedData.data());
-                    zStream.total_out = zStream.avail_out = static_cast<uint32_t>(_buffer.size());
-                    zStream.next_out = reinterpret_cast<unsigned char*>(_buffer.data());
-                    zStream.zalloc = Z_NULL;
-                    zStream.zfree = Z_NULL;
-                    zStream.opaque = Z_NULL;
-                    inflateInit(&zStream);            // zlib function
-                    inflate(&zStream, Z_FINISH);      // zlib function
-                    inflateEnd(&zStream);             // zlib function
-                } else {
-                    datFile->readBytes(cBuf, size);
+                size_t chunkSize = std::min(_buffer.size(), _size - _bufferOffset);
+                if (chunkSize == 0) {
+                    setg(cBuf, cBuf, cBuf);
+                    return false;
                 }
 
-                datFile->setPosition(oldPos);
-                setg(cBuf, cBuf, cBuf + size);
+                _file->seek(static_cast<unsigned int>(_bufferOffset), VFS::IFile::SeekFrom::Begin);
+                chunkSize = _file->read(cBuf, static_cast<unsigned int>(chunkSize));
+                setg(cBuf, cBuf, cBuf + chunkSize);
+                return chunkSize > 0;
+            }
+
+            void Stream::_rewind()
+            {
+                _bufferOffset = 0;
+                auto cBuf = _buffer.data();
+                setg(cBuf, cBuf, cBuf);
             }
 
             size_t Stream::size() const
             {
-                return _buffer.size();
+                return _size;
+            }
+
+            std::shared_ptr<const uint8_t> Stream::data(size_t position) const
+            {
+                if (!_view || position > _size)
+                {
+                    return nullptr;
+                }
+                return std::shared_ptr<const uint8_t>(_view, _view.get() + position);
             }
 
             std::streambuf::int_type Stream::underflow()
             {
                 if (gptr() == egptr())
                 {
-                    return traits_type::eof();
+                    if (_file == nullptr || !_readNextChunk())
+                    {
+                        return traits_type::eof();
+                    }
                 }
                 return traits_type::to_int_type(*gptr());
             }
 
             Stream& Stream::setPosition(size_t pos)
             {
-                auto cBuf = _buffer.data();
-                setg(cBuf, cBuf + pos, cBuf + _buffer.size());
+                if (_file == nullptr)
+                {
+                    setg(eback(), eback() + std::min(pos, _size), egptr());
+                    return *this;
+                }
+
+                if (pos < _bufferOffset)
+                {
+                    _rewind();
+                }
+                // unpack forward until requested position is within current chunk
+                while (pos > _bufferOffset + (egptr() - eback()))
+                {
+                    if (!_readNextChunk())
+                    {
+                        break;
+                    }
+                }
+                size_t chunkSize = egptr() - eback();
+                setg(eback(), eback() + std::min(pos - std::min(pos, _bufferOffset), chunkSize), egptr());
                 return *this;
             }
 
             size_t Stream::position() const
             {
-                return gptr() - eback();
+                return _bufferOffset + (gptr() - eback());
             }
 
             Stream& Stream::skipBytes(size_t numberOfBytes)
             {
-                auto cBuf = _buffer.data();
-                setg(cBuf, gptr() + numberOfBytes, cBuf + _buffer.size());
+                if (_file != nullptr)
+                {
+                    return setPosition(position() + numberOfBytes);
+                }
+                setg(eback(), gptr() + std::min(numberOfBytes, static_cast<size_t>(egptr() - gptr())), egptr());
                 return *this;
             }
 
@@ -114,6 +216,19 @@ namespace Falltergeist
                 return *this;
             }
 
+            void Stream::_swapBytes(void* values, size_t size, size_t valueSize)
+            {
+                auto bytes = static_cast<uint8_t*>(values);
+#ifdef FALLTERGEIST_STREAM_SSSE3
+                if (size >= 16 && hasSsse3())
+                {
+                    swapSsse3(bytes, size, valueSize);
+                    return;
+                }
+#endif
+                swapScalar(bytes, size, valueSize);
+            }
+
             Stream& Stream::operator>>(uint32_t &value)
             {
                 char* buff = reinterpret_cast<char*>(&value);
@@ -3,23 +3,39 @@
 #include <fstream>
 #include <string>
 #include <memory>
+#include <type_traits>
 #include "../../Base/Buffer.h"
 #include "../../Format/Enums.h"
 
+namespace Falltergeist
+{
+    namespace VFS
+    {
+        class IFile;
+    }
+}
+
 namespace Falltergeist
 {
     namespace Format
     {
         namespace Dat
         {
-            class Entry;
-
-            // An abstract data stream for binary resource files loaded from either Dat file or a file system
+            // An abstract data stream for binary resource files loaded through the virtual file system
             class Stream: public std::streambuf
             {
                 public:
-                    Stream(std::ifstream& stream);
-                    Stream(Dat::Entry& datFileEntry);
+                    // How contents of the file are made available
+                    enum class Mode
+                    {
+                        // the whole file is read into memory at once,
+                        // or viewed in place if the file is already resident in memory (e.g. memory mapped)
+                        Buffered,
+                        // the file is read in fixed-size chunks on demand, memory usage is bounded
+                        Streamed
+                    };
+
+                    Stream(std::shared_ptr<VFS::IFile> file, Mode mode = Mode::Buffered);
 
                     Stream(Stream&& other);
                     Stream(const Stream&) = delete;
@@ -34,6 +50,10 @@ namespace Falltergeist
                     size_t position() const;
                     size_t size() const;
 
+                    // Contents of the file starting at the given position, sharing ownership of the backing storage,
+                    // so parsed items can keep referencing it instead of copying. nullptr in streamed mode.
+                    std::shared_ptr<const uint8_t> data(size_t position = 0) const;
+
                     size_t bytesRemains();
 
                     ENDIANNESS endianness();
@@ -53,9 +73,38 @@ namespace Falltergeist
                     Stream& operator>>(uint8_t &value);
                     Stream& operator>>(int8_t &value);
 
+                    // Reads count consecutive values in the endianness of the stream, byte-swapped at once
+                    template <typename T>
+                    Stream& readArray(T* destination, size_t count)
+                    {
+                        static_assert(std::is_integral<T>::value && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4),
+                                      "readArray() reads 8, 16 and 32 bit integers");
+                        readBytes(reinterpret_cast<uint8_t*>(destination), count * sizeof(T));
+                        if (sizeof(T) > 1 && _endianness == ENDIANNESS::BIG)
+                        {
+                            _swapBytes(destination, count * sizeof(T), sizeof(T));
+                        }
+                        return *this;
+                    }
+
                 private:
+                    // current chunk in streamed mode
                     Base::Buffer<char> _buffer;
+                    // whole file in buffered mode: memory mapping or a block read from the file
+                    std::shared_ptr<const unsigned char> _view;
                     ENDIANNESS _endianness = ENDIANNESS::BIG;
+                    // position of the first byte of _buffer within the file
+                    size_t _bufferOffset = 0;
+                    size_t _size = 0;
+
+                    // streamed mode only
+                    std::shared_ptr<VFS::IFile> _file;
+
+                    // reads next chunk of the file into _buffer, returns false if there is nothing left to read
+                    bool _readNextChunk();
+                    void _rewind();
+                    // reverses the bytes of every value of the given size (2 or 4) in place
+                    static void _swapBytes(void* values, size_t size, size_t valueSize);
             };
         }
     }
@@ -99,6 +99,26 @@ enum class PROCEDURE_FLAG
     INLINE      = 0x40
 };
 
+// Procedures called by the engine, resolved once per script file
+enum class PROCEDURE
+{
+    CRITTER = 0,
+    DESCRIPTION,
+    DESTROY,
+    LOOK_AT,
+    MAP_ENTER,
+    MAP_EXIT,
+    MAP_UPDATE,
+    PICKUP,
+    SPATIAL,
+    TALK,
+    TIMED_EVENT,
+    USE,
+    USE_OBJ_ON,
+    USE_SKILL_ON,
+    COUNT
+};
+
 enum class OBJECT_TYPE
 {
     ITEM = 0,
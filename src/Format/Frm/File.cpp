@@ -1,8 +1,11 @@
 ﻿#include <algorithm>
+#include <mutex>
 #include "../Enums.h"
 #include "../Dat/Stream.h"
 #include "../Frm/File.h"
 #include "../Pal/File.h"
+#include "../../Graphics/HitMask.h"
+#include "../../Graphics/PaletteExpansion.h"
 
 namespace Falltergeist
 {
@@ -10,6 +13,15 @@ namespace Falltergeist
     {
         namespace Frm
         {
+            namespace
+            {
+                // FRM files are big endian
+                uint16_t readUint16(const uint8_t* data)
+                {
+                    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+                }
+            }
+
             File::File(Dat::Stream&& stream)
             {
                 stream.setPosition(0);
@@ -22,15 +34,11 @@ namespace Falltergeist
                 uint16_t shiftX[6];
                 uint16_t shiftY[6];
                 uint32_t dataOffset[6];
-                for (unsigned int i = 0; i != 6; ++i) {
-                    shiftX[i] = stream.uint16();
-                }
-                for (unsigned int i = 0; i != 6; ++i) {
-                    shiftY[i] = stream.uint16();
-                }
+                stream.readArray(shiftX, 6);
+                stream.readArray(shiftY, 6);
+                stream.readArray(dataOffset, 6);
                 for (unsigned int i = 0; i != 6; ++i)
                 {
-                    dataOffset[i] = stream.uint32();
                     if (i > 0 && dataOffset[i-1] == dataOffset[i])
                     {
                         continue;
@@ -42,33 +50,60 @@ namespace Falltergeist
                     direction.setShiftX(shiftX[i]);
                     direction.setShiftY(shiftY[i]);
                 }
+                _decoded = std::make_unique<std::once_flag[]>(_directions.size());
 
-                // for each direction
-                for (auto& direction : _directions)
+                // Frames reference the contents in place when the whole file is in memory, otherwise it is read once
+                _size = stream.size();
+                _data = stream.data();
+                if (!_data)
                 {
-                    // jump to frames data at frames area
-                    stream.setPosition(direction.dataOffset() + 62);
+                    std::shared_ptr<uint8_t> data(new uint8_t[_size], std::default_delete<uint8_t[]>());
+                    stream.setPosition(0);
+                    stream.readBytes(data.get(), _size);
+                    _data = std::move(data);
+                }
+            }
+
+            void File::_decodeDirection(size_t index) const
+            {
+                std::call_once(_decoded[index], [this, index]()
+                {
+                    auto& direction = _directions[index];
+                    const uint8_t* data = _data.get();
 
-                    // read all frames
+                    // frames data follows the header
+                    size_t position = direction.dataOffset() + 62;
                     for (unsigned i = 0; i != _framesPerDirection; ++i)
                     {
-                        uint16_t width = stream.uint16();
-                        uint16_t height = stream.uint16();
-
-                        direction.frames().emplace_back(width, height);
-                        auto& frame = direction.frames().back();
+                        // a truncated file leaves the remaining frames empty
+                        if (position + 12 > _size)
+                        {
+                            direction.frames().emplace_back();
+                            continue;
+                        }
 
-                        // Number of pixels for this frame
+                        uint16_t width = readUint16(data + position);
+                        uint16_t height = readUint16(data + position + 2);
+                        // Number of pixels for this frame at position + 4
                         // We don't need this, because we already have width*height
-                        stream.uint32();
+                        int16_t offsetX = static_cast<int16_t>(readUint16(data + position + 8));
+                        int16_t offsetY = static_cast<int16_t>(readUint16(data + position + 10));
+                        position += 12;
 
-                        frame.setOffsetX(stream.int16());
-                        frame.setOffsetY(stream.int16());
+                        size_t pixels = width * height;
+                        if (position + pixels <= _size) {
+                            direction.frames().emplace_back(width, height, std::shared_ptr<const uint8_t>(_data, data + position));
+                        } else {
+                            direction.frames().emplace_back(width, height);
+                            std::copy(data + position, data + _size, direction.frames().back().data());
+                        }
+                        position += pixels;
 
-                        // Pixels data
-                        stream.readBytes(frame.data(), frame.width() * frame.height());
+                        auto& frame = direction.frames().back();
+                        frame.setOffsetX(offsetX);
+                        frame.setOffsetY(offsetY);
                     }
-                }
+                });
             }
 
             uint32_t File::version() const
@@ -93,12 +128,32 @@ namespace Falltergeist
 
             const std::vector<Direction>& File::directions() const
             {
+                for (size_t i = 0; i != _directions.size(); ++i)
+                {
+                    _decodeDirection(i);
+                }
                 return _directions;
             }
 
+            const Direction& File::direction(unsigned int index) const
+            {
+                if (index >= _directions.size())
+                {
+                    index = 0;
+                }
+                _decodeDirection(index);
+                return _directions.at(index);
+            }
+
+            size_t File::directionsCount() const
+            {
+                return _directions.size();
+            }
+
             uint16_t File::width() const
             {
-                return std::max_element(_directions.begin(), _directions.end(), [](const Direction& a, const Direction& b)
+                auto& directions = this->directions();
+                return std::max_element(directions.begin(), directions.end(), [](const Direction& a, const Direction& b)
                 {
                     return a.width() < b.width();
                 })->width();
@@ -107,7 +162,7 @@ namespace Falltergeist
             uint16_t File::height() const
             {
                 uint16_t height = 0;
-                for (auto& direction : _directions)
+                for (auto& direction : directions())
                 {
                     height += direction.height();
                 }
@@ -127,73 +182,108 @@ namespace Falltergeist
 
                 uint16_t w = width();
 
+                uint32_t palette[256];
+                for (unsigned i = 0; i != 256; ++i)
+                {
+                    palette[i] = *palFile->color(i);
+                }
+
+                size_t positionY = 1;
+                for (auto& direction : directions())
+                {
+                    size_t positionX = 1;
+                    for (auto& frame : direction.frames())
+                    {
+                        for (uint16_t y = 0; y != frame.height(); ++y)
+                        {
+                            Graphics::expandPalette(
+                                frame.indexes() + y*frame.width(),
+                                &_rgba[((y + positionY)*w) + positionX],
+                                frame.width(),
+                                palette
+                            );
+                        }
+                        positionX += frame.width() + 2;
+                    }
+                    positionY += direction.height();
+                }
+                return _rgba.data();
+            }
+
+            std::vector<uint8_t> File::indexes() const
+            {
+                uint16_t w = width();
+
+                // index 0 is transparent in every palette
+                std::vector<uint8_t> indexes(w*height(), 0);
+
                 size_t positionY = 1;
-                for (auto& direction : _directions)
+                for (auto& direction : directions())
                 {
                     size_t positionX = 1;
                     for (auto& frame : direction.frames())
                     {
-                        // TODO: more efficient way to generate texture?
                         for (uint16_t y = 0; y != frame.height(); ++y)
                         {
                             for (uint16_t x = 0; x != frame.width(); ++x)
                             {
-                                _rgba[((y + positionY)*w) + x + positionX] = *palFile->color(frame.index(x, y));
+                                indexes[((y + positionY)*w) + x + positionX] = frame.index(x, y);
                             }
                         }
                         positionX += frame.width() + 2;
                     }
                     positionY += direction.height();
                 }
-                return _rgba.data();
+                return indexes;
             }
 
-            std::vector<bool>& File::mask(Pal::File* palFile)
+            std::shared_ptr<const Graphics::HitMask> File::mask(Pal::File* palFile)
             {
-                if (!_mask.empty()) {
+                if (_mask) {
                     return _mask;
                 }
 
-                uint16_t w = width();
-                uint16_t h = height();
+                bool opaqueIndexes[256];
+                for (unsigned i = 0; i != 256; ++i)
+                {
+                    opaqueIndexes[i] = palFile->color(i)->alpha() > 0;
+                }
 
-                _mask.resize(w*h, true);
+                auto mask = std::make_shared<Graphics::HitMask>(Graphics::Size(width(), height()));
 
                 unsigned positionY = 1;
-                for (auto& direction : _directions)
+                for (auto& direction : directions())
                 {
                     unsigned positionX = 1;
                     for (auto& frame : direction.frames())
                     {
-                        // TODO: optimize
+                        const uint8_t* indexes = frame.indexes();
                         for (unsigned y = 0; y != frame.height(); ++y)
                         {
                             for (unsigned x = 0; x != frame.width(); ++x)
                             {
-                                _mask[((y + positionY)*w) + x + positionX] = (palFile->color(frame.index(x, y))->alpha() > 0);
+                                if (opaqueIndexes[indexes[y*frame.width() + x]])
+                                {
+                                    mask->setOpaque(x + positionX, y + positionY);
+                                }
                             }
                         }
                         positionX += frame.width() + 2;
                     }
                     positionY += direction.height();
                 }
+                _mask = mask;
                 return _mask;
             }
 
             int16_t File::offsetX(unsigned int direction, unsigned int frame) const
             {
-                if (direction >= _directions.size()) {
-                    direction = 0;
-                }
-                return _directions.at(direction).frames().at(frame).offsetX();
+                return this->direction(direction).frames().at(frame).offsetX();
             }
 
             int16_t File::offsetY(unsigned int direction, unsigned int frame) const
             {
-                if (direction >= _directions.size()) {
-                    direction = 0;
-                }
-                return _directions.at(direction).frames().at(frame).offsetY();
+                return this->direction(direction).frames().at(frame).offsetY();
             }
         }
     }
@@ -1,6 +1,8 @@
 ﻿#pragma once
 
 #include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include "../Dat/Item.h"
 #include "../Frm/Direction.h"
@@ -8,6 +10,10 @@
 
 namespace Falltergeist
 {
+    namespace Graphics
+    {
+        class HitMask;
+    }
     namespace Format
     {
         namespace Dat
@@ -40,10 +46,20 @@ namespace Falltergeist
                     int16_t offsetY(unsigned int direction = 0, unsigned int frame = 0) const;
 
                     uint32_t* rgba(Pal::File* palFile);
-                    std::vector<bool>& mask(Pal::File* palFile);
+                    // Palette indexes laid out like rgba(), not cached
+                    std::vector<uint8_t> indexes() const;
+                    // Pixels which are not transparent in the palette, built once and shared with textures
+                    std::shared_ptr<const Graphics::HitMask> mask(Pal::File* palFile);
 
+                    // Decodes the frames of all directions which were not requested yet
                     const std::vector<Direction>& directions() const;
 
+                    // Frames of a direction are decoded the first time it is requested.
+                    // Falls back to direction 0 for directions the file doesn't have, like offsetX() does.
+                    const Direction& direction(unsigned int index) const;
+
+                    size_t directionsCount() const;
+
                 protected:
                     std::vector<uint32_t> _rgba;
                     uint32_t _version = 0;
@@ -52,8 +68,17 @@ namespace Falltergeist
                     uint16_t _actionFrame = 0;
                     bool _animatedPalette = false;
 
-                    std::vector<Direction> _directions;
-                    std::vector<bool> _mask;
+                    // Frames are filled in by _decodeDirection(), safe to call from any thread
+                    mutable std::vector<Direction> _directions;
+                    std::unique_ptr<std::once_flag[]> _decoded;
+
+                    // Contents of the whole file, referenced by the frames
+                    std::shared_ptr<const uint8_t> _data;
+                    size_t _size = 0;
+
+                    std::shared_ptr<const Graphics::HitMask> _mask;
+
+                    void _decodeDirection(size_t index) const;
             };
         }
     }
@@ -12,6 +12,12 @@ namespace Falltergeist
                 _height = height;
             }
 
+            Frame::Frame(uint16_t width, uint16_t height, std::shared_ptr<const uint8_t> indexes) : _sharedIndexes(std::move(indexes))
+            {
+                _width = width;
+                _height = height;
+            }
+
             uint16_t Frame::width() const
             {
                 return _width;
@@ -48,9 +54,20 @@ namespace Falltergeist
                     return 0;
                 }
 
+                if (_sharedIndexes) {
+                    return _sharedIndexes.get()[_width*y + x];
+                }
                 return _indexes.at(_width*y + x);
             }
 
+            const uint8_t* Frame::indexes() const
+            {
+                if (_sharedIndexes) {
+                    return _sharedIndexes.get();
+                }
+                return _indexes.data();
+            }
+
             uint8_t* Frame::data()
             {
                 return _indexes.data();
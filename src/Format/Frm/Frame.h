@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace Falltergeist
@@ -14,6 +15,8 @@ namespace Falltergeist
                 public:
                     Frame() = default;
                     Frame(uint16_t width, uint16_t height);
+                    // Frame referencing width * height indexes in shared storage, nothing is copied
+                    Frame(uint16_t width, uint16_t height, std::shared_ptr<const uint8_t> indexes);
                     Frame(const Frame& other) = delete;
                     Frame(Frame&& other) = default;
                     Frame& operator= (const Frame&) = delete;
@@ -31,6 +34,10 @@ namespace Falltergeist
 
                     uint8_t index(uint16_t x, uint16_t y) const;
 
+                    // Row-major width * height indexes
+                    const uint8_t* indexes() const;
+
+                    // Writable indexes, only frames which own their indexes can be written to
                     uint8_t* data();
 
                 protected:
@@ -39,6 +46,7 @@ namespace Falltergeist
                     int16_t _offsetX = 0;
                     int16_t _offsetY = 0;
                     std::vector<uint8_t> _indexes;
+                    std::shared_ptr<const uint8_t> _sharedIndexes;
             };
         }
     }
@@ -78,11 +78,13 @@ namespace Falltergeist
                 if (_GVARmode)
                 {
                     _GVARS.insert(std::make_pair(name, std::stoi(value)));
+                    _GVARValues.push_back(std::stoi(value));
                     return;
                 }
                 else if(_MVARmode)
                 {
                     _MVARS.insert(std::make_pair(name, std::stoi(value)));
+                    _MVARValues.push_back(std::stoi(value));
                     return;
                 }
                 else
@@ -101,6 +103,16 @@ namespace Falltergeist
                 return &_MVARS;
             }
 
+            const std::vector<int>& File::GVARValues() const
+            {
+                return _GVARValues;
+            }
+
+            const std::vector<int>& File::MVARValues() const
+            {
+                return _MVARValues;
+            }
+
             int File::GVAR(std::string name)
             {
                 if (_GVARS.find(name) != _GVARS.end())
@@ -121,26 +133,18 @@ namespace Falltergeist
 
             int File::GVAR(unsigned int number)
             {
-                unsigned int i = 0;
-                for (auto gvar : _GVARS)
+                if (number < _GVARValues.size())
                 {
-                    if (i == number) {
-                        return gvar.second;
-                    }
-                    i++;
+                    return _GVARValues[number];
                 }
                 throw Exception("File::GVAR(number) - not found: " + std::to_string(number));
             }
 
             int File::MVAR(unsigned int number)
             {
-                unsigned int i = 0;
-                for (auto mvar : _MVARS)
+                if (number < _MVARValues.size())
                 {
-                    if (i == number) {
-                        return mvar.second;
-                    }
-                    i++;
+                    return _MVARValues[number];
                 }
                 throw Exception("File::MVAR(number) - not found: " + std::to_string(number));
             }
@@ -2,6 +2,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "../Dat/Item.h"
 
 namespace Falltergeist
@@ -21,6 +22,9 @@ namespace Falltergeist
                     File(Dat::Stream&& stream);
                     std::map<std::string, int>* GVARS();
                     std::map<std::string, int>* MVARS();
+                    // Values in the order of declaration, which is how scripts number the variables
+                    const std::vector<int>& GVARValues() const;
+                    const std::vector<int>& MVARValues() const;
                     int GVAR(std::string name);
                     int GVAR(unsigned int number);
                     int MVAR(std::string name);
@@ -29,6 +33,8 @@ namespace Falltergeist
                 protected:
                     std::map<std::string, int> _GVARS;
                     std::map<std::string, int> _MVARS;
+                    std::vector<int> _GVARValues;
+                    std::vector<int> _MVARValues;
                     bool _GVARmode = false;
                     bool _MVARmode = false;
                     void _parseLine(std::string line);
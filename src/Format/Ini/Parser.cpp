@@ -9,7 +9,7 @@ namespace Falltergeist
     {
         namespace Ini
         {
-            Parser::Parser(std::istream &stream) : _stream(stream), _section("")
+            Parser::Parser(std::string_view text) : _text(text), _section("")
             {
             }
 
@@ -20,56 +20,59 @@ namespace Falltergeist
             Array Parser::parseArray(const std::string& str)
             {
                 Array ret;
-                for (std::string& value : Parser::split(',', str))
+                std::string_view rest = str;
+                while (true)
                 {
-                    std::string key = "";
-                    Parser::trim(value);
+                    size_t comma = rest.find(',');
+                    std::string_view value = trimmed(rest.substr(0, comma));
+                    std::string_view key;
                     // skip empty values
-                    if (value.size() == 0)
+                    if (value.size() != 0)
                     {
-                        continue;
-                    }
-                    // check for associative
-                    size_t colon = value.find(':');
-                    if (colon != std::string::npos)
-                    {
-                        key = value.substr(0, colon);
-                        Parser::rtrim(key);
-                        value = value.substr(colon + 1);
-                        Parser::ltrim(value);
+                        // check for associative
+                        size_t colon = value.find(':');
+                        if (colon != std::string_view::npos)
+                        {
+                            key = rtrimmed(value.substr(0, colon));
+                            value = ltrimmed(value.substr(colon + 1));
+                        }
+                        if (value.size() > 0)
+                        {
+                            ret.emplace_back(std::string(key), Value(std::string(value)));
+                        }
                     }
-                    if (value.size() > 0)
+                    if (comma == std::string_view::npos)
                     {
-                        ret.push_back(std::make_pair(key, value));
+                        break;
                     }
+                    rest.remove_prefix(comma + 1);
                 }
                 return ret;
             }
 
-            void Parser::_stripComments(std::string& line)
+            std::string_view Parser::_stripComments(std::string_view line)
             {
-                auto pos = line.find(";");
-                if (pos != std::string::npos)
-                {
-                    line.erase(pos);
-                }
+                return line.substr(0, line.find(';'));
             }
 
             std::unique_ptr<File> Parser::parse()
             {
                 auto ini = std::unique_ptr<File>(new File());
-                std::string line;
+                std::string_view text = _text;
+                std::string_view line;
+
+                // sections are only created once they get a property, like File::section() does on first access
+                Section* section = nullptr;
 
-                while (std::getline(_stream, line))
+                while (nextLine(text, line))
                 {
                     // Lines starting with "#" or ";" are treated as comments and ignored
-                    if (line[0] == '#' || line[0] == ';') {
+                    if (!line.empty() && (line[0] == '#' || line[0] == ';')) {
                         continue;
                     }
 
                     // Prepare line
-                    _stripComments(line);
-                    trim(line);
+                    line = trimmed(_stripComments(line));
 
                     // Skip empty lines
                     if (line.length() == 0) {
@@ -77,28 +80,31 @@ namespace Falltergeist
                     }
 
                     // Found section
-                    if (*line.begin() == '[' && *line.rbegin() == ']')
+                    if (line.front() == '[' && line.back() == ']')
                     {
-                        _section = line.substr(1, line.length() - 2);
+                        _section = std::string(line.substr(1, line.length() - 2));
+                        section = nullptr;
 
                         continue;
                     }
 
                     auto eqPos = line.find('=');
-                    if (eqPos == std::string::npos)
+                    if (eqPos == std::string_view::npos)
                     {
                         continue;
                     }
 
-                    auto name  = line.substr(0, eqPos);
-                    auto value = line.substr(eqPos + 1);
-                    rtrim(name);
-                    ltrim(value);
+                    std::string name(rtrimmed(line.substr(0, eqPos)));
+                    std::string value(ltrimmed(line.substr(eqPos + 1)));
 
                     // Property names are case-insensitive
                     toLower(name);
 
-                    ini->section(_section).setProperty(name, value);
+                    if (section == nullptr)
+                    {
+                        section = &ini->section(_section);
+                    }
+                    section->setProperty(name, value);
                 }
 
                 return ini;
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "../../Format/Ini/Value.h"
 #include "../../Format/Txt/Parser.h"
@@ -22,7 +23,7 @@ namespace Falltergeist
             class Parser : public Txt::Parser
             {
                 public:
-                    Parser(std::istream &stream);
+                    Parser(std::string_view text);
                     ~Parser();
 
                     std::unique_ptr<File> parse();
@@ -30,11 +31,11 @@ namespace Falltergeist
                     static Array parseArray(const std::string& value);
 
                 private:
-                    std::istream &_stream; // stream to parse
+                    std::string_view _text; // text to parse
                     std::string  _section; // current section
 
                 protected:
-                    void _stripComments(std::string& line);
+                    std::string_view _stripComments(std::string_view line);
             };
         }
     }
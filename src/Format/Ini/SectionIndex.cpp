@@ -0,0 +1,137 @@
+#include "../Ini/File.h"
+#include "../Ini/Parser.h"
+#include "../Ini/SectionIndex.h"
+
+namespace Falltergeist
+{
+    namespace Format
+    {
+        namespace Ini
+        {
+            SectionIndex::SectionIndex(std::string text) : _text(std::move(text))
+            {
+                std::string_view rest = _text;
+                std::string_view line;
+                std::string name;
+                size_t begin = 0;
+                bool hasProperties = false;
+
+                // same rules as Parser::parse(), but only headers and the presence of properties are looked at
+                auto addSpan = [this, &name, &begin, &hasProperties](size_t end)
+                {
+                    if (!hasProperties)
+                    {
+                        return;
+                    }
+                    auto it = _sectionIdxMap.find(name);
+                    if (it == _sectionIdxMap.end())
+                    {
+                        it = _sectionIdxMap.emplace(name, _sections.size()).first;
+                        _sections.push_back({name, {}});
+                    }
+                    _sections[it->second].spans.push_back({begin, end});
+                };
+
+                while (true)
+                {
+                    size_t offset = _text.size() - rest.size();
+                    if (!Parser::nextLine(rest, line))
+                    {
+                        break;
+                    }
+                    if (!line.empty() && (line[0] == '#' || line[0] == ';'))
+                    {
+                        continue;
+                    }
+                    line = Parser::trimmed(line.substr(0, line.find(';')));
+                    if (line.length() == 0)
+                    {
+                        continue;
+                    }
+                    if (line.front() == '[' && line.back() == ']')
+                    {
+                        addSpan(offset);
+                        name = std::string(line.substr(1, line.length() - 2));
+                        begin = _text.size() - rest.size();
+                        hasProperties = false;
+                        continue;
+                    }
+                    if (line.find('=') != std::string_view::npos)
+                    {
+                        hasProperties = true;
+                    }
+                }
+                addSpan(_text.size());
+            }
+
+            size_t SectionIndex::size() const
+            {
+                return _sections.size();
+            }
+
+            const std::string& SectionIndex::name(size_t index) const
+            {
+                return _sections.at(index).name;
+            }
+
+            bool SectionIndex::find(const std::string& name, size_t& index) const
+            {
+                auto it = _sectionIdxMap.find(name);
+                if (it == _sectionIdxMap.end())
+                {
+                    return false;
+                }
+                index = it->second;
+                return true;
+            }
+
+            Section SectionIndex::section(size_t index) const
+            {
+                auto& entry = _sections.at(index);
+                Section section(entry.name);
+                for (auto& span : entry.spans)
+                {
+                    // spans have no section headers, their properties end up in the unnamed section
+                    Parser parser(std::string_view(_text).substr(span.begin, span.end - span.begin));
+                    auto file = parser.parse();
+                    for (auto& property : file->section(""))
+                    {
+                        section.setProperty(property.first, property.second);
+                    }
+                }
+                return section;
+            }
+
+            std::string SectionIndex::propertyString(size_t index, const std::string& name, const std::string& def) const
+            {
+                std::string value = def;
+                for (auto& span : _sections.at(index).spans)
+                {
+                    std::string_view rest = std::string_view(_text).substr(span.begin, span.end - span.begin);
+                    std::string_view line;
+                    while (Parser::nextLine(rest, line))
+                    {
+                        if (!line.empty() && (line[0] == '#' || line[0] == ';'))
+                        {
+                            continue;
+                        }
+                        line = Parser::trimmed(line.substr(0, line.find(';')));
+                        auto eqPos = line.find('=');
+                        if (eqPos == std::string_view::npos)
+                        {
+                            continue;
+                        }
+                        std::string property(Parser::rtrimmed(line.substr(0, eqPos)));
+                        Parser::toLower(property);
+                        // later properties replace earlier ones, as in Section::setProperty()
+                        if (property == name)
+                        {
+                            value = std::string(Parser::ltrimmed(line.substr(eqPos + 1)));
+                        }
+                    }
+                }
+                return value;
+            }
+        }
+    }
+}
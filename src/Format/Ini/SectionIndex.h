@@ -0,0 +1,64 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "../Ini/Section.h"
+
+namespace Falltergeist
+{
+    namespace Format
+    {
+        namespace Ini
+        {
+            /**
+             * @brief Offsets of the sections in INI text.
+             * The text is only split into sections, properties of a section are parsed when it is asked for.
+             * Sections are numbered in the order File would have them, sections without properties are left out
+             * and the properties of sections with the same name are merged.
+             */
+            class SectionIndex
+            {
+                public:
+                    SectionIndex(std::string text = "");
+
+                    size_t size() const;
+
+                    const std::string& name(size_t index) const;
+
+                    /**
+                     * Looks up the section with given name, returns false if there is none.
+                     */
+                    bool find(const std::string& name, size_t& index) const;
+
+                    /**
+                     * Parses all properties of the section.
+                     */
+                    Section section(size_t index) const;
+
+                    /**
+                     * Returns value of a single property of the section without parsing the others, or def if it doesn't have it.
+                     */
+                    std::string propertyString(size_t index, const std::string& name, const std::string& def = "") const;
+
+                private:
+                    struct Span
+                    {
+                        size_t begin;
+                        size_t end;
+                    };
+
+                    struct Entry
+                    {
+                        std::string name;
+                        std::vector<Span> spans;
+                    };
+
+                    // offsets into the text, they stay valid when the index is moved
+                    std::string _text;
+                    std::vector<Entry> _sections;
+                    std::map<std::string, size_t> _sectionIdxMap;
+            };
+        }
+    }
+}
@@ -1,6 +1,7 @@
 ﻿#include "../../Format/Dat/Stream.h"
 #include "../../Format/Int/File.h"
 #include "../../Exception.h"
+#include <algorithm>
 
 namespace Falltergeist
 {
@@ -8,6 +9,37 @@ namespace Falltergeist
     {
         namespace Int
         {
+            namespace
+            {
+                // in the order of PROCEDURE
+                const char* const KNOWN_PROCEDURES[] = {
+                    "critter_p_proc",
+                    "description_p_proc",
+                    "destroy_p_proc",
+                    "look_at_p_proc",
+                    "map_enter_p_proc",
+                    "map_exit_p_proc",
+                    "map_update_p_proc",
+                    "pickup_p_proc",
+                    "spatial_p_proc",
+                    "talk_p_proc",
+                    "timed_event_p_proc",
+                    "use_p_proc",
+                    "use_obj_on_p_proc",
+                    "use_skill_on_p_proc",
+                };
+                static_assert(sizeof(KNOWN_PROCEDURES) / sizeof(KNOWN_PROCEDURES[0]) == (size_t)PROCEDURE::COUNT, "every known procedure needs a name");
+
+                // names are padded with zeros, which are dropped
+                std::string readName(Dat::Stream& stream, uint16_t length)
+                {
+                    std::string name(length, '\0');
+                    stream.readArray(reinterpret_cast<uint8_t*>(&name[0]), length);
+                    name.erase(std::remove(name.begin(), name.end(), '\0'), name.end());
+                    return name;
+                }
+            }
+
             File::File(Dat::Stream&& stream) : _stream(std::move(stream))
             {
                 _stream.setPosition(0);
@@ -19,18 +51,23 @@ namespace Falltergeist
                 uint32_t proceduresCount = _stream.uint32();
 
                 std::vector<uint32_t> procedureNameOffsets;
+                procedureNameOffsets.reserve(proceduresCount);
 
+                // six values per procedure
+                std::vector<uint32_t> procedureTable(proceduresCount * 6);
+                _stream.readArray(procedureTable.data(), procedureTable.size());
                 for (unsigned i = 0; i != proceduresCount; ++i)
                 {
                     _procedures.emplace_back();
                     auto& procedure = _procedures.back();
+                    const uint32_t* fields = &procedureTable[i * 6];
 
-                    procedureNameOffsets.push_back(_stream.uint32());
-                    procedure.setFlags(_stream.uint32());
-                    procedure.setDelay(_stream.uint32());
-                    procedure.setConditionOffset(_stream.uint32());
-                    procedure.setBodyOffset(_stream.uint32());
-                    procedure.setArgumentsCounter(_stream.uint32());
+                    procedureNameOffsets.push_back(fields[0]);
+                    procedure.setFlags(fields[1]);
+                    procedure.setDelay(fields[2]);
+                    procedure.setConditionOffset(fields[3]);
+                    procedure.setBodyOffset(fields[4]);
+                    procedure.setArgumentsCounter(fields[5]);
                 }
 
                 // Identifiers table
@@ -42,16 +79,10 @@ namespace Falltergeist
                     j += 2;
 
                     uint32_t nameOffset = j + 4;
-                    std::string name;
-                    for (unsigned i = 0; i != nameLength; ++i, ++j)
-                    {
-                        uint8_t ch = _stream.uint8();
-                        if (ch != 0) {
-                            name.push_back(ch);
-                        }
-                    }
+                    std::string name = readName(_stream, nameLength);
+                    j += nameLength;
 
-                    _identifiers.insert(std::make_pair(nameOffset, name)); // names of functions and variables
+                    _identifiers.add(nameOffset, Base::StringId(name)); // names of functions and variables
                 }
 
                 _stream.skipBytes(4); // signature 0xFFFFFFFF
@@ -59,6 +90,14 @@ namespace Falltergeist
                 for (unsigned i = 0; i != procedureNameOffsets.size(); ++i)
                 {
                     _procedures.at(i).setName(_identifiers.at(procedureNameOffsets.at(i)));
+                    // the first one wins, as with the linear search
+                    _procedureIndexes.emplace(_procedures.at(i).nameId(), i);
+                }
+
+                for (size_t i = 0; i != _knownProcedures.size(); ++i)
+                {
+                    auto procedure = this->procedure(KNOWN_PROCEDURES[i]);
+                    _knownProcedures[i] = procedure ? (int)(procedure - _procedures.data()) : -1;
                 }
 
                 // STRINGS TABLE
@@ -72,25 +111,95 @@ namespace Falltergeist
                         uint16_t length = _stream.uint16();
                         j += 2;
                         uint32_t nameOffset = j + 4;
-                        std::string name;
-                        for (unsigned i = 0; i != length; ++i, ++j)
-                        {
-                            uint8_t ch = _stream.uint8();
-                            if (ch != 0) {
-                                name.push_back(ch);
+                        std::string name = readName(_stream, length);
+                        j += length;
+                        _strings.add(nameOffset, Base::StringId(name));
+                    }
+                }
+
+                _decode();
+            }
+
+            void File::_decode()
+            {
+                std::vector<uint8_t> bytes(_stream.size());
+                _stream.setPosition(0);
+                _stream.readBytes(bytes.data(), bytes.size());
+
+                _hash = 0xcbf29ce484222325ull;
+                for (auto byte : bytes)
+                {
+                    _hash = (_hash ^ byte) * 0x100000001b3ull;
+                }
+
+                // big endian, like everything else in .INT files
+                auto read16 = [&bytes](size_t offset) -> uint16_t {
+                    return (uint16_t)(bytes[offset] << 8 | bytes[offset + 1]);
+                };
+                auto read32 = [&read16](size_t offset) -> uint32_t {
+                    return (uint32_t)read16(offset) << 16 | read16(offset + 2);
+                };
+
+                _instructions.resize(bytes.size() > 1 ? bytes.size() - 1 : 0);
+                for (size_t offset = 0; offset != _instructions.size(); ++offset)
+                {
+                    auto& instruction = _instructions[offset];
+                    instruction.opcode = read16(offset);
+                    instruction.length = 2;
+                    instruction.operand = 0;
+                    instruction.fused = 0;
+                    switch (instruction.opcode)
+                    {
+                        case 0x9001: // push_d string
+                        case 0xA001: // push_d float
+                        case 0xC001: // push_d integer
+                            if (offset + 6 <= bytes.size()) {
+                                instruction.operand = read32(offset + 2);
+                                instruction.length = 6;
                             }
-                        }
-                        _strings.insert(std::make_pair(nameOffset, name));
+                            break;
+                        default:
+                            break;
+                    }
+                }
+
+                // peephole pass, pushed integers consumed right away by the next opcode run as one instruction
+                // jumping to the next opcode still runs it alone, it has an instruction of its own
+                for (size_t offset = 0; offset + 6 < _instructions.size(); ++offset)
+                {
+                    auto& instruction = _instructions[offset];
+                    if (instruction.opcode != 0xC001 || instruction.length != 6) {
+                        continue;
+                    }
+                    switch (_instructions[offset + 6].opcode)
+                    {
+                        case 0x8032: // op_fetch
+                            instruction.fused = 0xF001;
+                            break;
+                        case 0x8031: // op_store
+                            instruction.fused = 0xF002;
+                            break;
+                        case 0x8012: // op_fetch_global
+                            instruction.fused = 0xF003;
+                            break;
+                        case 0x8013: // op_store_global
+                            instruction.fused = 0xF004;
+                            break;
+                        case 0x8004: // op_jmp
+                            instruction.fused = 0xF005;
+                            break;
+                        default:
+                            break;
                     }
                 }
             }
 
-            const std::map<unsigned int, std::string>& File::identifiers() const
+            const StringTable& File::identifiers() const
             {
                 return _identifiers;
             }
 
-            const std::map<unsigned int, std::string>& File::strings() const
+            const StringTable& File::strings() const
             {
                 return _strings;
             }
@@ -110,14 +219,17 @@ namespace Falltergeist
                 return _stream.size();
             }
 
-            uint16_t File::readOpcode()
+            const File::Instruction& File::instruction(size_t offset) const
             {
-                return _stream.uint16();
+                if (offset >= _instructions.size()) {
+                    throw Exception("Int::File::instruction() - offset out of range: " + std::to_string(offset));
+                }
+                return _instructions[offset];
             }
 
-            uint32_t File::readValue()
+            uint64_t File::hash() const
             {
-                return _stream.uint32();
+                return _hash;
             }
 
             const std::vector<Procedure>& File::procedures() const
@@ -127,14 +239,28 @@ namespace Falltergeist
 
             const Procedure* File::procedure(const std::string& name) const
             {
-                for (auto& procedure : _procedures)
+                // a name which was never interned can't be the name of a procedure
+                Base::StringId id;
+                if (!Base::StringId::find(name, id))
                 {
-                    if (procedure.name() == name)
-                    {
-                        return &procedure;
-                    }
+                    return nullptr;
+                }
+                auto it = _procedureIndexes.find(id);
+                if (it == _procedureIndexes.end())
+                {
+                    return nullptr;
+                }
+                return &_procedures[it->second];
+            }
+
+            const Procedure* File::procedure(PROCEDURE id) const
+            {
+                int index = _knownProcedures.at((size_t)id);
+                if (index < 0)
+                {
+                    return nullptr;
                 }
-                return nullptr;
+                return &_procedures[index];
             }
         }
     }
@@ -1,11 +1,15 @@
 ﻿#pragma once
 
-#include <map>
+#include <array>
 #include <string>
+#include <unordered_map>
 #include <vector>
+#include "../../Base/StringId.h"
+#include "../../Format/Enums.h"
 #include "../../Format/Dat/Item.h"
 #include "../../Format/Dat/Stream.h"
 #include "../../Format/Int/Procedure.h"
+#include "../../Format/Int/StringTable.h"
 
 namespace Falltergeist
 {
@@ -23,8 +27,12 @@ namespace Falltergeist
                     // returns procedure with a given name or nullptr if none found
                     const Procedure* procedure(const std::string& name) const;
 
-                    const std::map<unsigned int, std::string>& identifiers() const;
-                    const std::map<unsigned int, std::string>& strings() const;
+                    // returns one of the procedures called by the engine or nullptr if the script has none
+                    const Procedure* procedure(PROCEDURE id) const;
+
+                    // Names of functions and variables and string constants by their offset in the tables
+                    const StringTable& identifiers() const;
+                    const StringTable& strings() const;
 
                     // current position in script file
                     size_t position() const;
@@ -35,21 +43,41 @@ namespace Falltergeist
                     // the size of script file
                     size_t size() const;
 
-                    // read the next opcode
-                    uint16_t readOpcode();
+                    // Instruction starting at an offset of the script file
+                    struct Instruction
+                    {
+                        // inline value of the push opcodes
+                        uint32_t operand;
+                        uint16_t opcode;
+                        // the next instruction starts at offset + length
+                        uint16_t length;
+                        // pseudo opcode running this and the next instruction at once (0xF0xx), 0 if there is none
+                        uint16_t fused;
+                    };
+
+                    // returns the decoded instruction at the given offset, throws if it's outside of the file
+                    const Instruction& instruction(size_t offset) const;
 
-                    // read the next value
-                    uint32_t readValue();
+                    // FNV-1a of the file contents, identifies the file a native translation was made from
+                    uint64_t hash() const;
 
                 protected:
                     Dat::Stream _stream;
 
                     std::vector<Procedure> _procedures;
+                    std::unordered_map<Base::StringId, size_t> _procedureIndexes;
+                    // indexes of the engine procedures, -1 if missing
+                    std::array<int, (size_t)PROCEDURE::COUNT> _knownProcedures;
+
+                    StringTable _identifiers;
+                    StringTable _strings;
+
+                    // decoded once for every offset, jump targets are only known while running
+                    std::vector<Instruction> _instructions;
+
+                    uint64_t _hash = 0;
 
-                    std::map<unsigned int, std::string> _functions;
-                    std::vector<unsigned int> _functionsOffsets;
-                    std::map<unsigned int, std::string> _identifiers;
-                    std::map<unsigned int, std::string> _strings;
+                    void _decode();
             };
         }
     }
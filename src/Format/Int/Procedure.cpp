@@ -95,12 +95,17 @@ namespace Falltergeist
                 return flags() & (unsigned)PROCEDURE_FLAG::INLINE;
             }
 
-            std::string Procedure::name() const
+            const std::string& Procedure::name() const
+            {
+                return _name.str();
+            }
+
+            Base::StringId Procedure::nameId() const
             {
                 return _name;
             }
 
-            void Procedure::setName(const std::string& name)
+            void Procedure::setName(Base::StringId name)
             {
                 _name = name;
             }
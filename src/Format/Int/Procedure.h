@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <string>
+#include "../../Base/StringId.h"
 #include "../../Format/Enums.h"
 
 namespace Falltergeist
@@ -30,8 +31,9 @@ namespace Falltergeist
                     uint32_t argumentsCounter();
                     void setArgumentsCounter(uint32_t value);
 
-                    std::string name() const;
-                    void setName(const std::string& name);
+                    const std::string& name() const;
+                    Base::StringId nameId() const;
+                    void setName(Base::StringId name);
 
                     bool isTimed();
                     bool isConditional();
@@ -42,7 +44,7 @@ namespace Falltergeist
                     bool isInline();
 
                 protected:
-                    std::string _name;
+                    Base::StringId _name;
                     uint32_t _flags = 0;
                     uint32_t _delay = 0; // delay for timed procedures
                     uint32_t _conditionOffset = 0; // offset of condition in code for conditional procedures
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "../../Format/Int/StringTable.h"
+
+namespace Falltergeist
+{
+    namespace Format
+    {
+        namespace Int
+        {
+            void StringTable::add(uint32_t offset, Base::StringId string)
+            {
+                if (!_entries.empty() && _entries.back().offset >= offset)
+                {
+                    throw std::logic_error("StringTable::add() - offsets are not increasing");
+                }
+                _entries.push_back({offset, string});
+            }
+
+            const Base::StringId* StringTable::find(uint32_t offset) const
+            {
+                auto it = std::lower_bound(_entries.begin(), _entries.end(), offset, [](const Entry& entry, uint32_t value) {
+                    return entry.offset < value;
+                });
+                if (it == _entries.end() || it->offset != offset)
+                {
+                    return nullptr;
+                }
+                return &it->string;
+            }
+
+            Base::StringId StringTable::at(uint32_t offset) const
+            {
+                auto string = find(offset);
+                if (!string)
+                {
+                    throw std::out_of_range("StringTable::at() - no string at offset " + std::to_string(offset));
+                }
+                return *string;
+            }
+
+            std::string_view StringTable::view(uint32_t offset) const
+            {
+                return at(offset).str();
+            }
+
+            size_t StringTable::size() const
+            {
+                return _entries.size();
+            }
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "../../Base/StringId.h"
+
+namespace Falltergeist
+{
+    namespace Format
+    {
+        namespace Int
+        {
+            // Strings of a script table by their offset in it. Entries are one flat array in offset order,
+            // the strings themselves are interned and shared with every other script.
+            class StringTable
+            {
+                public:
+                    // offsets have to be added in increasing order, as they are read from the file
+                    void add(uint32_t offset, Base::StringId string);
+
+                    // nullptr if no string starts at the offset
+                    const Base::StringId* find(uint32_t offset) const;
+
+                    // throws std::out_of_range if no string starts at the offset
+                    Base::StringId at(uint32_t offset) const;
+
+                    std::string_view view(uint32_t offset) const;
+
+                    size_t size() const;
+
+                private:
+                    struct Entry
+                    {
+                        uint32_t offset;
+                        Base::StringId string;
+                    };
+
+                    std::vector<Entry> _entries;
+            };
+        }
+    }
+}
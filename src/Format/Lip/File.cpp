@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "../../Exception.h"
 #include "../../Format/Dat/Stream.h"
 #include "../../Format/Lip/File.h"
@@ -23,6 +24,9 @@ namespace Falltergeist
                 stream.readBytes(_acmName, 8);
                 stream.readBytes(_unknown5, 4);
 
+                _phonemes.reserve(_phonemesCount);
+                _markerSamples.reserve(_markersCount);
+                _markerTimestamps.reserve(_markersCount);
                 for (uint32_t i=0; i < _phonemesCount; i++)
                 {
                     uint8_t phoneme = 0;
@@ -68,6 +72,18 @@ namespace Falltergeist
             {
                 return _phonemes;
             }
+
+            int File::advance(uint32_t time, uint32_t& cursor) const
+            {
+                auto count = std::min(_phonemes.size(), _markerTimestamps.size());
+                int phoneme = -1;
+                while (cursor < count && _markerTimestamps[cursor] <= time)
+                {
+                    phoneme = _phonemes[cursor];
+                    ++cursor;
+                }
+                return phoneme;
+            }
         }
     }
 }
@@ -26,6 +26,10 @@ namespace Falltergeist
                     std::vector<uint32_t>& timestamps();
                     std::vector<uint8_t>& phonemes();
 
+                    // Moves the cursor past the markers reached at the given time in milliseconds and returns the
+                    // phoneme of the last of them, -1 if the cursor didn't move. Talking heads keep the cursor, starting at 0
+                    int advance(uint32_t time, uint32_t& cursor) const;
+
                 protected:
                     uint32_t _version;
                     uint32_t _unknown1;
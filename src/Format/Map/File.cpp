@@ -15,6 +15,7 @@ namespace Falltergeist
 
             void File::init(ProFileTypeLoaderCallback callback)
             {
+                std::lock_guard<std::mutex> lock(_initMutex);
                 if (_initialized) {
                     return;
                 }
@@ -56,27 +57,28 @@ namespace Falltergeist
                 stream.skipBytes(4*44); // unkonwn
 
                 // MVAR AND SVAR SECTION
-                _MVARS.reserve(_MVARsize);
-                for (unsigned int i = 0; i != _MVARsize; ++i)
-                {
-                    _MVARS.push_back(stream.int32());
-                }
+                _MVARS.resize(_MVARsize);
+                stream.readArray(_MVARS.data(), _MVARS.size());
 
-                _LVARS.reserve(_LVARsize);
-                for (unsigned int i = 0; i != _LVARsize; ++i)
-                {
-                    _LVARS.push_back(stream.int32());
-                }
+                _LVARS.resize(_LVARsize);
+                stream.readArray(_LVARS.data(), _LVARS.size());
 
                 // TILES SECTION
+                // roof and floor tiles alternate, read all of an elevation at once
+                std::vector<uint16_t> tiles(2 * 10000);
                 for (unsigned int i = 0; i < elevations; i++)
                 {
                     _elevations.emplace_back();
+                    auto& roofTiles = _elevations.back().roofTiles();
+                    auto& floorTiles = _elevations.back().floorTiles();
+                    roofTiles.resize(10000);
+                    floorTiles.resize(10000);
 
+                    stream.readArray(tiles.data(), tiles.size());
                     for (unsigned i = 0; i < 10000; i++)
                     {
-                        _elevations.back().roofTiles().push_back(stream.uint16());
-                        _elevations.back().floorTiles().push_back(stream.uint16());
+                        roofTiles[i] = tiles[2 * i];
+                        floorTiles[i] = tiles[2 * i + 1];
                     }
                 }
 
@@ -123,20 +125,10 @@ namespace Falltergeist
                                 default:
                                     break;
                             }
-                            stream.uint32(); //flags
+                            stream.skipBytes(4); //flags
                             script.setScriptId(stream.int32());
-                            stream.uint32(); //unknown 5
-                            stream.uint32(); //oid == object->OID
-                            stream.uint32(); //local var offset
-                            stream.uint32(); //loal var cnt
-                            stream.uint32(); //unknown 9
-                            stream.uint32(); //unknown 10
-                            stream.uint32(); //unknown 11
-                            stream.uint32(); //unknown 12
-                            stream.uint32(); //unknown 13
-                            stream.uint32(); //unknown 14
-                            stream.uint32(); //unknown 15
-                            stream.uint32(); //unknown 16
+                            // unknown 5, oid == object->OID, local var offset, local var cnt, unknown 9 - 16
+                            stream.skipBytes(4 * 12);
 
                             if (j < count)
                             {
@@ -181,29 +173,33 @@ namespace Falltergeist
 
             std::unique_ptr<Object> File::_readObject(Dat::Stream& stream, ProFileTypeLoaderCallback callback)
             {
+                // fields common to all objects
+                uint32_t fields[22];
+                stream.readArray(fields, 22);
+
                 auto object = std::make_unique<Object>();
-                object->setOID(stream.uint32());
-                object->setHexPosition(stream.int32());
-                object->setX(stream.uint32());
-                object->setY(stream.uint32());
-                object->setSx(stream.uint32());
-                object->setSy(stream.uint32());
-                object->setFrameNumber(stream.uint32());
-                object->setOrientation(stream.uint32());
-                uint32_t FID = stream.uint32();
+                object->setOID(fields[0]);
+                object->setHexPosition(static_cast<int32_t>(fields[1]));
+                object->setX(fields[2]);
+                object->setY(fields[3]);
+                object->setSx(fields[4]);
+                object->setSy(fields[5]);
+                object->setFrameNumber(fields[6]);
+                object->setOrientation(fields[7]);
+                uint32_t FID = fields[8];
                 object->setFrmTypeId(FID >> 24);
                 object->setFrmId(0x00FFFFFF & FID);
-                object->setFlags(stream.uint32());
-                object->setElevation(stream.uint32());
-                uint32_t PID = stream.uint32();
+                object->setFlags(fields[9]);
+                object->setElevation(fields[10]);
+                uint32_t PID = fields[11];
                 object->setObjectTypeId(PID >> 24);
                 object->setObjectId(0x00FFFFFF & PID);
-                object->setCombatId(stream.uint32());
-                object->setLightRadius(stream.uint32());
-                object->setLightIntensity(stream.uint32());
-                object->setOutline(stream.uint32());
+                object->setCombatId(fields[12]);
+                object->setLightRadius(fields[13]);
+                object->setLightIntensity(fields[14]);
+                object->setOutline(fields[15]);
 
-                int32_t SID = stream.int32();
+                int32_t SID = static_cast<int32_t>(fields[16]);
                 if (SID != -1)
                 {
                     for (auto& script : _scripts)
@@ -216,16 +212,16 @@ namespace Falltergeist
                     }
                 }
 
-                SID = stream.int32();
+                SID = static_cast<int32_t>(fields[17]);
                 if (SID != -1)
                 {
                     object->setScriptId(SID);
                 }
 
-                object->setInventorySize(stream.uint32());
-                object->setMaxInventorySize(stream.uint32());
-                object->setUnknown12(stream.uint32());
-                object->setUnknown13(stream.uint32());
+                object->setInventorySize(fields[18]);
+                object->setMaxInventorySize(fields[19]);
+                object->setUnknown12(fields[20]);
+                object->setUnknown13(fields[21]);
 
                 switch ((OBJECT_TYPE)object->objectTypeId())
                 {
@@ -257,16 +253,12 @@ namespace Falltergeist
                         }
                         break;
                     case OBJECT_TYPE::CRITTER:
-                        stream.uint32(); //reaction to player - saves only
-                        stream.uint32(); //current mp - saves only
-                        stream.uint32(); //combat results - saves only
-                        stream.uint32(); //damage last turn - saves only
+                        // reaction to player, current mp, combat results, damage last turn - saves only
+                        stream.skipBytes(4 * 4);
                         object->setAIPacket(stream.uint32()); // AI packet - is it different from .pro? well, it can be
-                        stream.uint32(); // team - always 1? saves only?
-                        stream.uint32(); // who hit me - saves only
-                        stream.uint32(); // hit points - saves only, otherwise = value from .pro
-                        stream.uint32(); // rad - always 0 - saves only
-                        stream.uint32(); // poison - always 0 - saves only
+                        // team - always 1? saves only?, who hit me - saves only,
+                        // hit points - saves only, otherwise = value from .pro, rad and poison - always 0 - saves only
+                        stream.skipBytes(4 * 5);
                         object->setFrmId(FID & 0x00000FFF);
                         object->setObjectID1((FID & 0x0000F000) >> 12);
                         object->setObjectID2((FID & 0x00FF0000) >> 16);
@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <mutex>
 #include <string>
 #include <vector>
 #include "../Dat/Item.h"
@@ -33,6 +34,7 @@ namespace Falltergeist
                     File(Dat::Stream&& stream);
 
                     // TODO: get rid of two-step initialization
+                    // Maps may be initialized by a loader thread, concurrent calls wait for the first one
                     void init(ProFileTypeLoaderCallback callback);
 
                     const std::vector<Elevation>& elevations() const;
@@ -58,6 +60,8 @@ namespace Falltergeist
 
                     bool _initialized = false;
 
+                    std::mutex _initMutex;
+
                     std::vector<Elevation> _elevations;
                     std::vector<Script> _scripts;
                     std::vector<int32_t> _MVARS;
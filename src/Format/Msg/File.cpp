@@ -1,4 +1,5 @@
-﻿#include <string>
+﻿#include <algorithm>
+#include <string>
 #include "../../Exception.h"
 #include "../../Format/Msg/File.h"
 #include "../../Format/Dat/Stream.h"
@@ -78,19 +79,79 @@ namespace Falltergeist
                         _messages.push_back(message);
                     }
                 }
+
+                _buildIndex();
             }
 
-            Message* File::message(unsigned int number)
+            void File::_buildIndex()
             {
+                if (_messages.empty())
+                {
+                    return;
+                }
+
+                unsigned int first = _messages.front().number();
+                unsigned int last = first;
                 for (auto& message : _messages)
                 {
-                    if (message.number() == number)
+                    first = std::min(first, message.number());
+                    last = std::max(last, message.number());
+                }
+
+                // most files number their messages in steps of 1 to 10, a few have isolated numbers far apart
+                size_t range = static_cast<size_t>(last - first) + 1;
+                if (range <= _messages.size() * 16)
+                {
+                    _first = first;
+                    _dense.assign(range, -1);
+                    // going backwards, so the first of duplicated numbers wins like in the original linear search
+                    for (int i = static_cast<int>(_messages.size()) - 1; i >= 0; i--)
                     {
-                        return &message;
+                        _dense[_messages[i].number() - first] = i;
                     }
+                    return;
+                }
+
+                _sorted.reserve(_messages.size());
+                for (size_t i = 0; i < _messages.size(); i++)
+                {
+                    _sorted.emplace_back(_messages[i].number(), static_cast<int>(i));
+                }
+                std::sort(_sorted.begin(), _sorted.end());
+            }
+
+            Message* File::message(unsigned int number)
+            {
+                if (auto message = tryMessage(number))
+                {
+                    return message;
                 }
                 throw Exception("File::message() - number is out of range: " + std::to_string(number));
             }
+
+            Message* File::tryMessage(unsigned int number)
+            {
+                if (!_dense.empty())
+                {
+                    if (number < _first || number - _first >= _dense.size() || _dense[number - _first] < 0)
+                    {
+                        return nullptr;
+                    }
+                    return &_messages[_dense[number - _first]];
+                }
+
+                auto it = std::lower_bound(_sorted.begin(), _sorted.end(), std::make_pair(number, -1));
+                if (it == _sorted.end() || it->first != number)
+                {
+                    return nullptr;
+                }
+                return &_messages[it->second];
+            }
+
+            std::vector<Message>* File::messages()
+            {
+                return &_messages;
+            }
         }
     }
 }
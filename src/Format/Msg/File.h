@@ -20,10 +20,25 @@ namespace Falltergeist
                 public:
                     File(Dat::Stream&& stream);
 
+                    // Throws if there is no message with the number
                     Message* message(unsigned int number);
 
+                    // nullptr if there is no message with the number
+                    Message* tryMessage(unsigned int number);
+
+                    std::vector<Message>* messages();
+
                 private:
                     std::vector<Message> _messages;
+
+                    // Compact numbers are looked up directly: position of the message for every number from _first on, -1 for gaps
+                    std::vector<int> _dense;
+                    unsigned int _first = 0;
+
+                    // Otherwise (number, position) pairs sorted by number
+                    std::vector<std::pair<unsigned int, int>> _sorted;
+
+                    void _buildIndex();
             };
         }
     }
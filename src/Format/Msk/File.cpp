@@ -0,0 +1,45 @@
+﻿#include "../Dat/Stream.h"
+#include "../Msk/File.h"
+
+namespace Falltergeist
+{
+    namespace Format
+    {
+        namespace Msk
+        {
+            File::File(Dat::Stream&& stream)
+            {
+                stream.setPosition(0);
+
+                // no header, the size gives the number of rows
+                _height = static_cast<uint16_t>(stream.size() / ROW_BYTES);
+                _bits.resize(static_cast<size_t>(_height) * ROW_BYTES);
+                stream.readBytes(_bits.data(), _bits.size());
+            }
+
+            uint16_t File::width() const
+            {
+                return ROW_BYTES * 8;
+            }
+
+            uint16_t File::height() const
+            {
+                return _height;
+            }
+
+            bool File::blocked(unsigned int x, unsigned int y) const
+            {
+                if (x >= width() || y >= _height)
+                {
+                    return false;
+                }
+                return (_bits[y * ROW_BYTES + x / 8] & (0x80 >> (x % 8))) != 0;
+            }
+
+            const std::vector<uint8_t>& File::bits() const
+            {
+                return _bits;
+            }
+        }
+    }
+}
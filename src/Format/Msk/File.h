@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../Dat/Item.h"
+
+namespace Falltergeist
+{
+    namespace Format
+    {
+        namespace Dat
+        {
+            class Stream;
+        }
+
+        namespace Msk
+        {
+            /**
+             * Walk mask of a world map tile: one bit per pixel, set where travelling is blocked.
+             * Rows are 44 bytes, the most significant bit of a byte is its leftmost pixel.
+             */
+            class File : public Dat::Item
+            {
+                public:
+                    static const unsigned int ROW_BYTES = 44;
+
+                    File(Dat::Stream&& stream);
+
+                    uint16_t width() const;
+                    uint16_t height() const;
+
+                    bool blocked(unsigned int x, unsigned int y) const;
+
+                    // ROW_BYTES bytes of every row, top to bottom
+                    const std::vector<uint8_t>& bits() const;
+
+                protected:
+                    uint16_t _height = 0;
+                    std::vector<uint8_t> _bits;
+            };
+        }
+    }
+}
@@ -59,15 +59,9 @@ namespace Falltergeist
                             {
                                 _armorClass = stream.uint32();
                                 // Damage resist
-                                for (unsigned int i = 0; i != 7; ++i)
-                                {
-                                    _damageResist.at(i) = stream.uint32();
-                                }
+                                stream.readArray(_damageResist.data(), 7);
                                 // Damage threshold
-                                for (unsigned int i = 0; i != 7; ++i)
-                                {
-                                    _damageThreshold.at(i) = stream.uint32();
-                                }
+                                stream.readArray(_damageThreshold.data(), 7);
                                 _perk           = stream.int32();
                                 _armorMaleFID   = stream.int32();
                                 _armorFemaleFID = stream.int32();
@@ -75,31 +69,15 @@ namespace Falltergeist
                             }
                             case ITEM_TYPE::CONTAINER:
                             {
-                                stream.uint32(); // max size
-                                stream.uint32(); // containter flags
+                                stream.skipBytes(4 * 2); // max size, containter flags
                                 break;
                             }
                             case ITEM_TYPE::DRUG:
                             {
-                                stream.uint32(); // Stat0
-                                stream.uint32(); // Stat1
-                                stream.uint32(); // Stat2
-                                stream.uint32(); // Stat0 ammount
-                                stream.uint32(); // Stat1 ammount
-                                stream.uint32(); // Stat2 ammount
-                                // first delayed effect
-                                stream.uint32(); // delay in game minutes
-                                stream.uint32(); // Stat0 ammount
-                                stream.uint32(); // Stat1 ammount
-                                stream.uint32(); // Stat2 ammount
-                                // second delayed effect
-                                stream.uint32(); // delay in game minutes
-                                stream.uint32(); // Stat0 ammount
-                                stream.uint32(); // Stat1 ammount
-                                stream.uint32(); // Stat2 ammount
-                                stream.uint32(); // addiction chance
-                                stream.uint32(); // addiction perk
-                                stream.uint32(); // addiction delay
+                                // Stat0 - Stat2 and their ammounts
+                                // first and second delayed effect: delay in game minutes and Stat0 - Stat2 ammounts
+                                // addiction chance, perk and delay
+                                stream.skipBytes(4 * 17);
                                 break;
                             }
                             case ITEM_TYPE::WEAPON:
@@ -134,14 +112,10 @@ namespace Falltergeist
                     {
                         _critterHeadFID = stream.int32();
 
-                        stream.uint32(); // ai packet number
-                        stream.uint32(); // team number
+                        stream.skipBytes(4 * 2); // ai packet number, team number
                         _critterFlags = stream.uint32();
 
-                        for (unsigned int i = 0; i != 7; ++i)
-                        {
-                            _critterStats.at(i) = stream.uint32();
-                        }
+                        stream.readArray(_critterStats.data(), _critterStats.size());
                         _critterHitPointsMax = stream.uint32();
                         _critterActionPoints = stream.uint32();
                         _critterArmorClass   = stream.uint32();
@@ -154,66 +128,29 @@ namespace Falltergeist
                         stream.uint32(); // Better criticals
 
                         // Damage threshold
-                        for (unsigned int i = 0; i != 7; ++i)
-                        {
-                            _damageThreshold.at(i) = stream.uint32();
-                        }
+                        stream.readArray(_damageThreshold.data(), 7);
                         // Damage resist
-                        for (unsigned int i = 0; i != 9; ++i)
-                        {
-                            _damageResist.at(i) = stream.uint32();
-                        }
+                        stream.readArray(_damageResist.data(), 9);
 
                         _critterAge = stream.uint32(); // age
                         _critterGender = stream.uint32(); // sex
 
-                        for (unsigned int i = 0; i != 7; ++i)
-                        {
-                            _critterStatsBonus.at(i) = stream.uint32();
-                        }
-
-                        stream.uint32(); // Bonus Health points
-                        stream.uint32(); // Bonus Action points
-                        stream.uint32(); // Bonus Armor class
-                        stream.uint32(); // Bonus Unused
-                        stream.uint32(); // Bonus Melee damage
-                        stream.uint32(); // Bonus Carry weight
-                        stream.uint32(); // Bonus Sequence
-                        stream.uint32(); // Bonus Healing rate
-                        stream.uint32(); // Bonus Critical chance
-                        stream.uint32(); // Bonus Better criticals
+                        stream.readArray(_critterStatsBonus.data(), _critterStatsBonus.size());
 
+                        // Bonus Health points, Action points, Armor class, Unused, Melee damage, Carry weight,
+                        // Sequence, Healing rate, Critical chance, Better criticals
+                        stream.skipBytes(4 * 10);
                         // Bonus Damage threshold
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-
+                        stream.skipBytes(4 * 8);
                         // Bonus Damage resistance
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-                        stream.uint32();
-
-                        stream.uint32(); // Bonus age
-                        stream.uint32(); // Bonus sex
-
-                        for (unsigned int i = 0; i != 18; ++i) {
-                            _critterSkills.at(i) = stream.uint32();
-                        }
+                        stream.skipBytes(4 * 8);
+                        // Bonus age, Bonus sex
+                        stream.skipBytes(4 * 2);
+
+                        stream.readArray(_critterSkills.data(), _critterSkills.size());
 
-                        stream.uint32(); // body type
-                        stream.uint32(); // experience for kill
-                        stream.uint32(); // kill type
-                        stream.uint32(); // damage type
+                        // body type, experience for kill, kill type, damage type
+                        stream.skipBytes(4 * 4);
                         break;
                     }
                     case OBJECT_TYPE::SCENERY:
@@ -317,27 +254,27 @@ namespace Falltergeist
                 return _SID & 0x0000FFFF;
             }
 
-            std::vector<uint32_t>* File::critterStats()
+            std::array<uint32_t, 7>* File::critterStats()
             {
                 return &_critterStats;
             }
 
-            std::vector<uint32_t>* File::critterStatsBonus()
+            std::array<uint32_t, 7>* File::critterStatsBonus()
             {
                 return &_critterStatsBonus;
             }
 
-            std::vector<uint32_t>* File::critterSkills()
+            std::array<uint32_t, 18>* File::critterSkills()
             {
                 return &_critterSkills;
             }
 
-            std::vector<uint32_t>* File::damageResist()
+            std::array<uint32_t, 9>* File::damageResist()
             {
                 return &_damageResist;
             }
 
-            std::vector<uint32_t>* File::damageThreshold()
+            std::array<uint32_t, 9>* File::damageThreshold()
             {
                 return &_damageThreshold;
             }
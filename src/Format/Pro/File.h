@@ -1,6 +1,6 @@
 #pragma once
 
-#include <vector>
+#include <array>
 #include "../Dat/Item.h"
 
 namespace Falltergeist
@@ -62,11 +62,11 @@ namespace Falltergeist
                     uint32_t critterAge() const;
                     uint32_t critterGender() const;
 
-                    std::vector<uint32_t>* critterStats();
-                    std::vector<uint32_t>* critterStatsBonus();
-                    std::vector<uint32_t>* critterSkills();
-                    std::vector<uint32_t>* damageResist();
-                    std::vector<uint32_t>* damageThreshold();
+                    std::array<uint32_t, 7>* critterStats();
+                    std::array<uint32_t, 7>* critterStatsBonus();
+                    std::array<uint32_t, 18>* critterSkills();
+                    std::array<uint32_t, 9>* damageResist();
+                    std::array<uint32_t, 9>* damageThreshold();
 
                 protected:
                     uint8_t _soundId = 0;
@@ -116,11 +116,11 @@ namespace Falltergeist
                     uint32_t _weight = 0;
                     uint32_t _basePrice = 0;
 
-                    std::vector<uint32_t> _critterStats = {0, 0, 0, 0, 0, 0, 0};
-                    std::vector<uint32_t> _critterStatsBonus = {0, 0, 0, 0, 0, 0, 0};
-                    std::vector<uint32_t> _critterSkills = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-                    std::vector<uint32_t> _damageResist = {0, 0, 0, 0, 0, 0, 0, 0, 0};
-                    std::vector<uint32_t> _damageThreshold = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+                    std::array<uint32_t, 7> _critterStats = {};
+                    std::array<uint32_t, 7> _critterStatsBonus = {};
+                    std::array<uint32_t, 18> _critterSkills = {};
+                    std::array<uint32_t, 9> _damageResist = {};
+                    std::array<uint32_t, 9> _damageThreshold = {};
             };
         }
     }
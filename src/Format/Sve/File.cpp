@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "../../Exception.h"
 #include "../Dat/Stream.h"
 #include "../Sve/File.h"
@@ -36,6 +37,10 @@ namespace Falltergeist
                 {
                     _addString(line);
                 }
+
+                // the first line given for a frame is kept, like the map they used to be read into
+                std::stable_sort(_lines.begin(), _lines.end(), [](const Line& a, const Line& b) { return a.frame < b.frame; });
+                _lines.erase(std::unique(_lines.begin(), _lines.end(), [](const Line& a, const Line& b) { return a.frame == b.frame; }), _lines.end());
             }
 
             void File::_addString(std::string line)
@@ -45,21 +50,24 @@ namespace Falltergeist
                 {
                     auto frame = line.substr(0, pos);
                     line = line.substr(pos+1);
-                    _subs.insert(std::pair<int,std::string>(std::stoi(frame),line));
+                    _lines.push_back(Line{static_cast<unsigned int>(std::stoi(frame)), line});
                 }
             }
 
-            std::pair<int,std::string> File::getSubLine(int frame)
+            const std::vector<File::Line>& File::lines() const
             {
-                auto it = _subs.lower_bound(frame);
-                if (it != _subs.end())
-                {
-                    return *it;
-                }
-                else
+                return _lines;
+            }
+
+            const File::Line* File::advance(unsigned int frame, size_t& cursor) const
+            {
+                const Line* shown = nullptr;
+                while (cursor < _lines.size() && _lines[cursor].frame <= frame)
                 {
-                    return std::pair<int,std::string>(999999, "");
+                    shown = &_lines[cursor];
+                    ++cursor;
                 }
+                return shown;
             }
         }
     }
@@ -1,8 +1,8 @@
 #pragma once
 
 #include <cstdint>
-#include <map>
 #include <string>
+#include <vector>
 #include "../Dat/Item.h"
 
 namespace Falltergeist
@@ -19,11 +19,23 @@ namespace Falltergeist
             class File : public Dat::Item
             {
                 public:
+                    struct Line
+                    {
+                        unsigned int frame;
+                        std::string text;
+                    };
+
                     File(Dat::Stream&& stream);
-                    std::pair<int,std::string> getSubLine(int frame);
+
+                    // Sorted by frame, a frame appears once
+                    const std::vector<Line>& lines() const;
+
+                    // Moves the cursor past the lines shown by the given frame and returns the last of them,
+                    // nullptr if the cursor didn't move. Players keep the cursor, starting at 0, frames only grow
+                    const Line* advance(unsigned int frame, size_t& cursor) const;
 
                 protected:
-                    std::map<int,std::string> _subs;
+                    std::vector<Line> _lines;
                     void _addString(std::string line);
             };
         }
@@ -11,21 +11,22 @@ namespace Falltergeist
             template <typename ItemType>
             CSVBasedFile<ItemType>::CSVBasedFile(Dat::Stream&& stream)
             {
-                std::istream istr(&stream);
-                _parseText(istr);
+                std::string storage;
+                _parseText(Parser::text(stream, storage));
             }
 
             template <typename ItemType>
-            const std::list<ItemType>& CSVBasedFile<ItemType>::items() const
+            const std::vector<ItemType>& CSVBasedFile<ItemType>::items() const
             {
                 return _items;
             }
 
             template <typename ItemType>
-            void CSVBasedFile<ItemType>::_parseText(std::istream& istr)
+            void CSVBasedFile<ItemType>::_parseText(std::string_view text)
             {
-                CSVParser parser(istr);
+                CSVParser parser(text);
                 auto csv = parser.parse();
+                _items.reserve(csv->size());
                 for (auto& row : *csv)
                 {
                     try
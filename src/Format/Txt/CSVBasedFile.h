@@ -1,6 +1,6 @@
 #pragma once
 
-#include <list>
+#include <string_view>
 #include <vector>
 #include "../Dat/Item.h"
 
@@ -178,10 +178,10 @@ namespace Falltergeist
                 public:
                     CSVBasedFile(Dat::Stream&& stream);
 
-                    const std::list<ItemType>& items() const;
+                    const std::vector<ItemType>& items() const;
 
                 protected:
-                    void _parseText(std::istream& istr);
+                    void _parseText(std::string_view text);
 
                     /**
                      * Parses next item
@@ -189,7 +189,7 @@ namespace Falltergeist
                      */
                     ItemType _parseItem(const std::vector<Ini::Value>& row);
 
-                    std::list<ItemType> _items;
+                    std::vector<ItemType> _items;
             };
 
             typedef CSVBasedFile<EndDeath> EndDeathFile;
@@ -1,5 +1,4 @@
 #include <algorithm>
-#include <sstream>
 #include "CSVParser.h"
 
 namespace Falltergeist
@@ -8,7 +7,7 @@ namespace Falltergeist
     {
         namespace Txt
         {
-            CSVParser::CSVParser(std::istream &stream) : _stream(stream)
+            CSVParser::CSVParser(std::string_view text) : _text(text)
             {
             }
 
@@ -17,56 +16,42 @@ namespace Falltergeist
             }
 
 
-            void CSVParser::_stripComments(std::string& line)
+            std::string_view CSVParser::_stripComments(std::string_view line)
             {
-                size_t pos = line.find(";"), pos2 = line.find("#");
-                if (pos != std::string::npos)
-                {
-                    if (pos2 != std::string::npos)
-                    {
-                        line.erase(std::min(pos, pos2));
-                    }
-                    else
-                    {
-                        line.erase(pos);
-                    }
-                }
-                else if (pos2 != std::string::npos)
-                {
-                    line.erase(pos2);
-                }
+                return line.substr(0, std::min(line.find(';'), line.find('#')));
             }
 
             std::unique_ptr<CSVFile> CSVParser::parse()
             {
                 auto csv = std::unique_ptr<CSVFile>(new CSVFile());
-                std::string line;
+                std::string_view text = _text;
+                std::string_view line;
 
-                while (std::getline(_stream, line))
+                while (nextLine(text, line))
                 {
                     // Lines starting with "#" or ";" are treated as comments and ignored
-                    if (line[0] == '#' || line[0] == ';') {
+                    if (!line.empty() && (line[0] == '#' || line[0] == ';')) {
                         continue;
                     }
 
                     // Prepare line
-                    _stripComments(line);
-                    trim(line);
+                    line = trimmed(_stripComments(line));
 
                     // Skip empty lines
                     if (line.length() == 0) {
                         continue;
                     }
 
-                    std::vector<Ini::Value> values;
-                    auto splitLine = split(',', line);
-
                     // trim and copy values
-                    for (auto& val : splitLine)
+                    std::vector<Ini::Value> values;
+                    values.reserve(std::count(line.begin(), line.end(), ',') + 1);
+                    size_t start = 0, end = 0;
+                    while ((end = line.find(',', start)) != std::string_view::npos)
                     {
-                        trim(val);
-                        values.push_back(val);
+                        values.emplace_back(std::string(trimmed(line.substr(start, end - start))));
+                        start = end + 1;
                     }
+                    values.emplace_back(std::string(trimmed(line.substr(start))));
 
                     csv->push_back(std::move(values));
                 }
@@ -1,8 +1,8 @@
 #pragma once
 
-#include <list>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "../Ini/Value.h"
 #include "../Txt/Parser.h"
@@ -13,7 +13,7 @@ namespace Falltergeist
     {
         namespace Txt
         {
-            typedef std::list<std::vector<Ini::Value>> CSVFile;
+            typedef std::vector<std::vector<Ini::Value>> CSVFile;
 
             /**
              * @brief Parser of CSV files.
@@ -21,16 +21,16 @@ namespace Falltergeist
             class CSVParser : public Parser
             {
                 public:
-                    CSVParser(std::istream &stream);
+                    CSVParser(std::string_view text);
                     ~CSVParser();
 
                     std::unique_ptr<CSVFile> parse();
 
                 private:
-                    std::istream &_stream; // stream to parse
+                    std::string_view _text; // text to parse
 
                 protected:
-                    void _stripComments(std::string& line);
+                    std::string_view _stripComments(std::string_view line);
             };
         }
     }
@@ -10,15 +10,38 @@ namespace Falltergeist
         {
             CityFile::CityFile(Dat::Stream&& stream)
             {
-                std::istream istr(&stream);
-                _parseText(istr);
+                std::string storage;
+                auto text = Txt::Parser::text(stream, storage);
+                _sections = Ini::SectionIndex(storage.empty() ? std::string(text) : std::move(storage));
+                _cities.resize(_sections.size());
+                _parsed.resize(_sections.size(), false);
             }
 
             const std::vector<City>& CityFile::cities() const
             {
+                for (size_t i = 0; i != _cities.size(); ++i)
+                {
+                    city(i);
+                }
                 return _cities;
             }
 
+            const City& CityFile::city(size_t index) const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_parsed.at(index))
+                {
+                    _cities[index] = _parseCity(_sections.section(index));
+                    _parsed[index] = true;
+                }
+                return _cities[index];
+            }
+
+            size_t CityFile::count() const
+            {
+                return _cities.size();
+            }
+
             City::Size CityFile::_sizeByName(std::string name) const
             {
                 Ini::Parser::toLower(name);
@@ -37,43 +60,38 @@ namespace Falltergeist
             }
 
 
-            void CityFile::_parseText(std::istream& stream)
+            City CityFile::_parseCity(Ini::Section section) const
             {
-                Ini::Parser parser(stream);
-                auto file = parser.parse();
-                for (auto section : file->sections())
+                City city;
+                city.name = section["area_name"];
+                auto coords = section["world_pos"].toArray();
+                if (coords.size() >= 2)
                 {
-                    City city;
-                    city.name = section["area_name"];
-                    auto coords = section["world_pos"].toArray();
-                    if (coords.size() >= 2)
-                    {
-                        city.worldX = coords[0].second.toInt();
-                        city.worldY = coords[1].second.toInt();
-                    }
-                    city.startState = section["start_state"].toBool();
-                    city.size = _sizeByName(section["size"]);
-                    city.townMapArtIdx = section["townmap_art_idx"].toInt();
-                    city.townMapLabelArtIdx = section["townmap_label_art_idx"].toInt();
-                    // parse entrances
-                    for (auto prop : section.listByMask("entrance_%d"))
+                    city.worldX = coords[0].second.toInt();
+                    city.worldY = coords[1].second.toInt();
+                }
+                city.startState = section["start_state"].toBool();
+                city.size = _sizeByName(section["size"]);
+                city.townMapArtIdx = section["townmap_art_idx"].toInt();
+                city.townMapLabelArtIdx = section["townmap_label_art_idx"].toInt();
+                // parse entrances
+                for (auto prop : section.listByMask("entrance_%d"))
+                {
+                    auto entranceArray = prop.get().toArray();
+                    if (entranceArray.size() >= 7)
                     {
-                        auto entranceArray = prop.get().toArray();
-                        if (entranceArray.size() >= 7)
-                        {
-                            CityEntrance entrance;
-                            entrance.startState = entranceArray[0].second.toBool();
-                            entrance.townMapX = entranceArray[1].second.toInt();
-                            entrance.townMapY = entranceArray[2].second.toInt();
-                            entrance.mapName = entranceArray[3].second.str();
-                            entrance.elevation = entranceArray[4].second.toInt();
-                            entrance.tileNum = entranceArray[5].second.toInt();
-                            entrance.orientation = entranceArray[6].second.toInt();
-                            city.entrances.push_back(entrance);
-                        }
+                        CityEntrance entrance;
+                        entrance.startState = entranceArray[0].second.toBool();
+                        entrance.townMapX = entranceArray[1].second.toInt();
+                        entrance.townMapY = entranceArray[2].second.toInt();
+                        entrance.mapName = entranceArray[3].second.str();
+                        entrance.elevation = entranceArray[4].second.toInt();
+                        entrance.tileNum = entranceArray[5].second.toInt();
+                        entrance.orientation = entranceArray[6].second.toInt();
+                        city.entrances.push_back(entrance);
                     }
-                    _cities.push_back(city);
                 }
+                return city;
             }
         }
     }
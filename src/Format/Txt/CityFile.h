@@ -1,7 +1,10 @@
 #pragma once
 
+#include <mutex>
+#include <string>
 #include <vector>
 #include "../Dat/Item.h"
+#include "../Ini/SectionIndex.h"
 
 namespace Falltergeist
 {
@@ -79,13 +82,25 @@ namespace Falltergeist
                 public:
                     CityFile(Dat::Stream&& stream);
 
+                    /**
+                     * Cities are parsed from their sections on first access, this parses all of them.
+                     */
                     const std::vector<City>& cities() const;
 
-                protected:
-                    std::vector<City> _cities;
+                    /**
+                     * @throws std::out_of_range if there is no such city
+                     */
+                    const City& city(size_t index) const;
+
+                    size_t count() const;
 
+                protected:
+                    Ini::SectionIndex _sections;
+                    mutable std::vector<City> _cities;
+                    mutable std::vector<bool> _parsed;
+                    mutable std::mutex _mutex;
 
-                    void _parseText(std::istream& istr);
+                    City _parseCity(Ini::Section section) const;
 
                     City::Size _sizeByName(std::string name) const;
             };
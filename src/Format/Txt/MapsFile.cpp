@@ -10,60 +10,91 @@ namespace Falltergeist
         {
             MapsFile::MapsFile(Dat::Stream&& stream)
             {
-                std::istream istr(&stream);
-                _parseText(istr);
+                std::string storage;
+                auto text = Txt::Parser::text(stream, storage);
+                _sections = Ini::SectionIndex(storage.empty() ? std::string(text) : std::move(storage));
+                _maps.resize(_sections.size());
+                _parsed.resize(_sections.size(), false);
             }
 
             const std::vector<Map>& MapsFile::maps() const
             {
+                for (size_t i = 0; i != _maps.size(); ++i)
+                {
+                    map(i);
+                }
                 return _maps;
             }
 
-            void MapsFile::_parseText(std::istream& stream)
+            const Map& MapsFile::map(size_t index) const
             {
-                Ini::Parser parser(stream);
-                auto file = parser.parse();
-                for (auto section : file->sections())
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_parsed.at(index))
                 {
-                    Map map = Map();
-                    map.name = section["map_name"];
-                    map.lookupName = section["lookup_name"];
-                    map.music = section["music"];
-                    parser.toLower(map.music);
-                    for (auto pair : section["ambient_sfx"].toArray())
+                    _maps[index] = _parseMap(_sections.section(index));
+                    _parsed[index] = true;
+                }
+                return _maps[index];
+            }
+
+            size_t MapsFile::count() const
+            {
+                return _maps.size();
+            }
+
+            bool MapsFile::find(const std::string& name, size_t& index) const
+            {
+                for (size_t i = 0; i != _sections.size(); ++i)
+                {
+                    if (_sections.propertyString(i, "map_name") == name)
                     {
-                        parser.toLower(pair.first);
-                        map.ambientSfx[pair.first] = static_cast<unsigned char>(pair.second.toInt());
+                        index = i;
+                        return true;
                     }
-                    map.saved = section["saved"].toBool();
-                    auto canRest = section["can_rest_here"].toArray();
-                    if (canRest.size() >= Map::NUM_ELEVATIONS)
+                }
+                return false;
+            }
+
+            Map MapsFile::_parseMap(Ini::Section section) const
+            {
+                Map map = Map();
+                map.name = section["map_name"];
+                map.lookupName = section["lookup_name"];
+                map.music = section["music"];
+                Ini::Parser::toLower(map.music);
+                for (auto pair : section["ambient_sfx"].toArray())
+                {
+                    Ini::Parser::toLower(pair.first);
+                    map.ambientSfx[pair.first] = static_cast<unsigned char>(pair.second.toInt());
+                }
+                map.saved = section["saved"].toBool();
+                auto canRest = section["can_rest_here"].toArray();
+                if (canRest.size() >= Map::NUM_ELEVATIONS)
+                {
+                    for (int i = 0; i < Map::NUM_ELEVATIONS; i++)
                     {
-                        for (int i = 0; i < Map::NUM_ELEVATIONS; i++)
-                        {
-                            map.canRestHere[i] = canRest[i].second.toBool();
-                        }
+                        map.canRestHere[i] = canRest[i].second.toBool();
                     }
+                }
 
-                    for (auto prop : section.listByMask("random_start_point_%d"))
+                for (auto prop : section.listByMask("random_start_point_%d"))
+                {
+                    MapStartPoint point = MapStartPoint();
+                    for (auto pair : prop.get().toArray())
                     {
-                        MapStartPoint point = MapStartPoint();
-                        for (auto pair : prop.get().toArray())
+                        if (pair.first == "elev")
+                        {
+                            point.elevation = pair.second.toInt();
+                        }
+                        else if (pair.first == "tile_num")
                         {
-                            if (pair.first == "elev")
-                            {
-                                point.elevation = pair.second.toInt();
-                            }
-                            else if (pair.first == "tile_num")
-                            {
-                                point.tileNum = pair.second.toInt();
-                            }
+                            point.tileNum = pair.second.toInt();
                         }
-                        map.randomStartPoints.push_back(point);
                     }
-
-                    _maps.push_back(map);
+                    map.randomStartPoints.push_back(point);
                 }
+
+                return map;
             }
         }
     }
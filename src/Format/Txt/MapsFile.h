@@ -1,8 +1,11 @@
 #pragma once
 
 #include <map>
+#include <mutex>
+#include <string>
 #include <vector>
 #include "../Dat/Item.h"
+#include "../Ini/SectionIndex.h"
 
 namespace Falltergeist
 {
@@ -53,12 +56,30 @@ namespace Falltergeist
                 public:
                     MapsFile(Dat::Stream&& stream);
 
+                    /**
+                     * Maps are parsed from their sections on first access, this parses all of them.
+                     */
                     const std::vector<Map>& maps() const;
 
+                    /**
+                     * @throws std::out_of_range if there is no such map
+                     */
+                    const Map& map(size_t index) const;
+
+                    size_t count() const;
+
+                    /**
+                     * Looks up a map by its map_name without parsing the other maps, returns false if there is none.
+                     */
+                    bool find(const std::string& name, size_t& index) const;
+
                 protected:
-                    std::vector<Map> _maps;
+                    Ini::SectionIndex _sections;
+                    mutable std::vector<Map> _maps;
+                    mutable std::vector<bool> _parsed;
+                    mutable std::mutex _mutex;
 
-                    void _parseText(std::istream& istr);
+                    Map _parseMap(Ini::Section section) const;
             };
         }
     }
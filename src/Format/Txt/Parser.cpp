@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <cctype>
 #include <functional>
+#include "../Dat/Stream.h"
 #include "../Txt/Parser.h"
 
 namespace Falltergeist
@@ -45,6 +47,64 @@ namespace Falltergeist
             {
                 std::transform(line.begin(), line.end(), line.begin(), ::tolower);
             }
+
+            std::string_view Parser::trimmed(std::string_view value)
+            {
+                return ltrimmed(rtrimmed(value));
+            }
+
+            std::string_view Parser::rtrimmed(std::string_view value)
+            {
+                size_t size = value.size();
+                while (size > 0 && std::isspace(static_cast<unsigned char>(value[size - 1])))
+                {
+                    size--;
+                }
+                return value.substr(0, size);
+            }
+
+            std::string_view Parser::ltrimmed(std::string_view value)
+            {
+                size_t start = 0;
+                while (start < value.size() && std::isspace(static_cast<unsigned char>(value[start])))
+                {
+                    start++;
+                }
+                return value.substr(start);
+            }
+
+            bool Parser::nextLine(std::string_view& text, std::string_view& line)
+            {
+                if (text.empty())
+                {
+                    return false;
+                }
+                size_t end = text.find('\n');
+                if (end == std::string_view::npos)
+                {
+                    line = text;
+                    text = std::string_view();
+                }
+                else
+                {
+                    line = text.substr(0, end);
+                    text.remove_prefix(end + 1);
+                }
+                return true;
+            }
+
+            std::string_view Parser::text(Dat::Stream& stream, std::string& storage)
+            {
+                auto data = stream.data();
+                if (data)
+                {
+                    return std::string_view(reinterpret_cast<const char*>(data.get()), stream.size());
+                }
+                storage.resize(stream.size());
+                stream.setPosition(0);
+                stream.readBytes(reinterpret_cast<uint8_t*>(&storage[0]), storage.size());
+                return storage;
+            }
         }
     }
 }
@@ -1,12 +1,18 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Falltergeist
 {
     namespace Format
     {
+        namespace Dat
+        {
+            class Stream;
+        }
+
         namespace Txt
         {
             /**
@@ -24,6 +30,20 @@ namespace Falltergeist
                     static void ltrim(std::string& value);
 
                     static void toLower(std::string& value);
+
+                    // Views of the same text without the leading and trailing whitespace
+                    static std::string_view trimmed(std::string_view value);
+
+                    static std::string_view rtrimmed(std::string_view value);
+
+                    static std::string_view ltrimmed(std::string_view value);
+
+                    // Moves the next line of text (without the line break) to line, returns false at the end of the text
+                    static bool nextLine(std::string_view& text, std::string_view& line);
+
+                    // Whole contents of the stream. Views the stream buffer in place while the stream is alive if possible,
+                    // otherwise the contents are read into storage, which has to outlive the view.
+                    static std::string_view text(Dat::Stream& stream, std::string& storage);
             };
         }
     }
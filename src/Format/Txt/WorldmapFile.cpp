@@ -1,3 +1,4 @@
+#include <cctype>
 #include <sstream>
 #include "../Dat/Stream.h"
 #include "../Ini/File.h"
@@ -16,105 +17,276 @@ namespace Falltergeist
             const char* NumericExpression::GLOBAL      = "Global";         // game global variable value
             const char* NumericExpression::RAND        = "Rand";           // a random value between 0 and 99
 
-            void WorldmapFile::_parseText(std::istream& stream)
+            bool CompiledCondition::evaluate(const ConditionContext& context, const std::vector<std::string>& symbols) const
             {
-                Ini::Parser parser(stream);
-                auto file = parser.parse();
-
-                for (auto pairs : file->section("Data"))
+                for (auto& term : terms)
                 {
-                    auto& str = pairs.second.str();
-                    if (str[str.size() - 1] == '%')
+                    int left = _value(term.left, context, symbols);
+                    if (term.op == LogicalExpression::Operator::NONE)
+                    {
+                        if (!left)
+                        {
+                            return false;
+                        }
+                        continue;
+                    }
+                    int right = _value(term.right, context, symbols);
+                    bool holds = false;
+                    switch (term.op)
+                    {
+                        case LogicalExpression::Operator::EQ:
+                            holds = left == right;
+                            break;
+                        case LogicalExpression::Operator::NE:
+                            holds = left != right;
+                            break;
+                        case LogicalExpression::Operator::GT:
+                            holds = left > right;
+                            break;
+                        case LogicalExpression::Operator::LT:
+                            holds = left < right;
+                            break;
+                        case LogicalExpression::Operator::GTE:
+                            holds = left >= right;
+                            break;
+                        case LogicalExpression::Operator::LTE:
+                            holds = left <= right;
+                            break;
+                        default:
+                            break;
+                    }
+                    if (!holds)
                     {
-                        chanceNames[pairs.first] = static_cast<unsigned char>(pairs.second.toInt());
+                        return false;
                     }
                 }
-                for (auto pair : file->section("Data")["terrain_types"].toArray())
+                return true;
+            }
+
+            bool CompiledCondition::empty() const
+            {
+                return terms.empty();
+            }
+
+            int CompiledCondition::_value(const ConditionOperand& operand, const ConditionContext& context, const std::vector<std::string>& symbols)
+            {
+                switch (operand.type)
+                {
+                    case ConditionOperand::Type::PLAYER:
+                        return operand.symbol >= 0 ? context.player(static_cast<unsigned int>(operand.symbol)) : 0;
+                    case ConditionOperand::Type::TIME_OF_DAY:
+                        return context.timeOfDay();
+                    case ConditionOperand::Type::GLOBAL:
+                        if (operand.symbol >= 0)
+                        {
+                            return context.global(symbols.at(static_cast<size_t>(operand.symbol)));
+                        }
+                        return operand.value >= 0 ? context.global(static_cast<unsigned int>(operand.value)) : 0;
+                    case ConditionOperand::Type::RAND:
+                        return context.random();
+                    default:
+                        return operand.value;
+                }
+            }
+
+            void WorldmapFile::_parseText(std::string text)
+            {
+                // encounter sections make up most of the file, they are only indexed here
+                _sections = Ini::SectionIndex(std::move(text));
+
+                size_t data = 0;
+                if (_sections.find("Data", data))
                 {
-                    TerrainType terType = TerrainType();
-                    terType.travelDelay = pair.second.toInt();
-                    std::string sect = "Random Maps: " + pair.first;
-                    if (file->hasSection(sect))
+                    auto section = _sections.section(data);
+                    for (auto pairs : section)
                     {
-                        for (auto& ref : file->section(sect).listByMask("map_%02d"))
+                        auto& str = pairs.second.str();
+                        if (!str.empty() && str[str.size() - 1] == '%')
                         {
-                            terType.randomMaps.push_back(ref.get().str());
+                            chanceNames[pairs.first] = static_cast<unsigned char>(pairs.second.toInt());
                         }
                     }
-                    terrainTypes[pair.first] = std::move(terType);
+                    for (auto pair : section["terrain_types"].toArray())
+                    {
+                        TerrainType terType = TerrainType();
+                        terType.travelDelay = pair.second.toInt();
+                        size_t randomMaps = 0;
+                        if (_sections.find("Random Maps: " + pair.first, randomMaps))
+                        {
+                            for (auto& ref : _sections.section(randomMaps).listByMask("map_%02d"))
+                            {
+                                terType.randomMaps.push_back(ref.get().str());
+                            }
+                        }
+                        terrainTypes[pair.first] = std::move(terType);
+                    }
                 }
-                numHorizontalTiles = file->section("Tile Data")["num_horizontal_tiles"].toInt();
-                for (auto section : file->sections())
+                size_t tileData = 0;
+                numHorizontalTiles = _sections.find("Tile Data", tileData)
+                    ? _sections.section(tileData)["num_horizontal_tiles"].toInt()
+                    : 0;
+
+                for (size_t i = 0; i != _sections.size(); ++i)
                 {
+                    auto& sectionName = _sections.name(i);
                     const std::string encStr = "Encounter:";
-                    auto pos = section.name().find(encStr);
-                    if (pos == 0)
+                    if (sectionName.find(encStr) == 0)
                     {
-                        std::string name = section.name().substr(encStr.size(), std::string::npos);
-                        parser.trim(name);
-                        Encounter enc = Encounter();
-                        for (auto pair : section["position"].toArray())
+                        std::string name = sectionName.substr(encStr.size(), std::string::npos);
+                        Ini::Parser::trim(name);
+                        auto id = encounterTypeIds.find(name);
+                        if (id != encounterTypeIds.end())
                         {
-                            parser.toLower(pair.first);
-                            if (pair.first.size() == 0)
-                            {
-                                enc.position = pair.second.str();
-                            }
-                            else if (pair.first == "spacing")
-                            {
-                                enc.spacing = pair.second.toInt();
-                            }
-                            else if (pair.first == "distance")
-                            {
-                                try
-                                {
-                                    Lexer lexer(pair.second.str());
-                                    enc.distance = _parseNumericExpression(lexer);
-                                }
-                                catch (const std::ios::failure&)
-                                {
-                                    // TODO: warnings
-                                }
-                            }
+                            _encounterTypeSections[id->second] = i;
                         }
-                        for (auto& ref : section.listByMask("type_%02d"))
+                        else
                         {
-                            enc.objects.push_back(_parseEncounterObject(ref.get()));
+                            encounterTypeIds[name] = static_cast<unsigned int>(_encounterTypeSections.size());
+                            _encounterTypeSections.push_back(i);
                         }
-                        encounterTypes[name] = std::move(enc);
                     }
-                    else if (section.name().find("Encounter Table") == 0)
+                    else if (sectionName.find("Encounter Table") == 0)
                     {
-                        EncounterTable table = EncounterTable();
-                        table.lookupName = section["lookup_name"];
-                        for (auto pair : section["maps"].toArray())
+                        std::string lookupName = _sections.propertyString(i, "lookup_name");
+                        auto id = encounterTableIds.find(lookupName);
+                        if (id != encounterTableIds.end())
                         {
-                            std::string mapName = pair.second.str();
-                            Ini::Parser::trim(mapName);
-                            table.maps.push_back(std::move(mapName));
+                            _encounterTableSections[id->second] = i;
                         }
-                        for (auto& ref : section.listByMask("enc_%02d"))
+                        else
                         {
-                            table.encounters.push_back(_parseEncounterTableEntry(ref.get()));
+                            encounterTableIds[lookupName] = static_cast<unsigned int>(_encounterTableSections.size());
+                            _encounterTableSections.push_back(i);
                         }
-                        encounterTables[table.lookupName] = std::move(table);
                     }
-                    else if (section.name().find("Tile") == 0 && section.name() != "Tile Data")
+                    else if (sectionName.find("Tile") == 0 && sectionName != "Tile Data")
                     {
+                        auto section = _sections.section(i);
                         WorldmapTile tile = WorldmapTile();
                         tile.artIdx = section["art_idx"].toInt();
                         tile.encounterDifficulty = section["encounter_difficulty"].toInt();
                         tile.walkMaskName = section["walk_mask_name"];
-                        for (int i = 0; i < WorldmapTile::SUBTILES_X; i++)
+                        for (int x = 0; x < WorldmapTile::SUBTILES_X; x++)
                         {
-                            for (int j = 0; j < WorldmapTile::SUBTILES_Y; j++)
+                            for (int y = 0; y < WorldmapTile::SUBTILES_Y; y++)
                             {
-                                tile.subtiles[i][j] = _parseSubtile(section[std::to_string(i) + "_" + std::to_string(j)]);
+                                tile.subtiles[x][y] = _parseSubtile(section[std::to_string(x) + "_" + std::to_string(y)]);
                             }
                         }
                         tiles.push_back(std::move(tile));
                     }
                 }
+                _encounterTypes.resize(_encounterTypeSections.size());
+                _encounterTables.resize(_encounterTableSections.size());
+                _resolveIds();
+            }
+
+            const Encounter& WorldmapFile::encounterType(unsigned int id)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto& type = _encounterTypes.at(id);
+                if (!type)
+                {
+                    type = std::make_unique<Encounter>(_parseEncounterType(_sections.section(_encounterTypeSections[id])));
+                }
+                return *type;
+            }
+
+            const EncounterTable& WorldmapFile::encounterTable(unsigned int id)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto& table = _encounterTables.at(id);
+                if (!table)
+                {
+                    table = std::make_unique<EncounterTable>(_parseEncounterTable(_sections.section(_encounterTableSections[id])));
+                }
+                return *table;
+            }
+
+            Encounter WorldmapFile::_parseEncounterType(const Ini::Section& section)
+            {
+                const std::string encStr = "Encounter:";
+                std::string name = section.name().substr(encStr.size(), std::string::npos);
+                Ini::Parser::trim(name);
+                Encounter enc = Encounter();
+                for (auto pair : section.propertyArray("position"))
+                {
+                    Ini::Parser::toLower(pair.first);
+                    if (pair.first.size() == 0)
+                    {
+                        enc.position = pair.second.str();
+                    }
+                    else if (pair.first == "spacing")
+                    {
+                        enc.spacing = pair.second.toInt();
+                    }
+                    else if (pair.first == "distance")
+                    {
+                        try
+                        {
+                            Lexer lexer(pair.second.str());
+                            enc.distance = _parseNumericExpression(lexer);
+                        }
+                        catch (const std::ios::failure&)
+                        {
+                            // TODO: warnings
+                        }
+                    }
+                }
+                for (auto& ref : section.listByMask("type_%02d"))
+                {
+                    enc.objects.push_back(_parseEncounterObject(ref.get()));
+                }
+                enc.name = name;
+                return enc;
+            }
+
+            EncounterTable WorldmapFile::_parseEncounterTable(const Ini::Section& section)
+            {
+                EncounterTable table = EncounterTable();
+                table.lookupName = section.propertyString("lookup_name");
+                for (auto pair : section.propertyArray("maps"))
+                {
+                    std::string mapName = pair.second.str();
+                    Ini::Parser::trim(mapName);
+                    table.maps.push_back(std::move(mapName));
+                }
+                for (auto& ref : section.listByMask("enc_%02d"))
+                {
+                    table.encounters.push_back(_parseEncounterTableEntry(ref.get()));
+                }
+
+                // every type is indexed by now, so the names of the groups are replaced right away
+                auto resolveGroups = [this](std::vector<EncounterGroup>& groups)
+                {
+                    for (auto& group : groups)
+                    {
+                        auto id = encounterTypeIds.find(group.encounterType);
+                        group.encounterTypeId = id != encounterTypeIds.end() ? static_cast<int>(id->second) : -1;
+                    }
+                };
+                for (auto& entry : table.encounters)
+                {
+                    resolveGroups(entry.team1);
+                    resolveGroups(entry.team2);
+                }
+                return table;
+            }
+
+            void WorldmapFile::_resolveIds()
+            {
+                for (auto& tile : tiles)
+                {
+                    for (int i = 0; i < WorldmapTile::SUBTILES_X; i++)
+                    {
+                        for (int j = 0; j < WorldmapTile::SUBTILES_Y; j++)
+                        {
+                            auto& subtile = tile.subtiles[i][j];
+                            auto id = encounterTableIds.find(subtile.encounterTable);
+                            subtile.encounterTableId = id != encounterTableIds.end() ? static_cast<int>(id->second) : -1;
+                        }
+                    }
+                }
             }
 
             EncounterObject WorldmapFile::_parseEncounterObject(const Ini::Value& val)
@@ -268,7 +440,7 @@ namespace Falltergeist
                 return grp;
             }
 
-            Condition WorldmapFile::_parseCondition(const std::string& value)
+            CompiledCondition WorldmapFile::_parseCondition(const std::string& value)
             {
                 Condition cond;
                 Lexer lexer(value);
@@ -284,7 +456,74 @@ namespace Falltergeist
                 {
                     // TODO: warnings?
                 }
-                return cond;
+
+                CompiledCondition compiled;
+                for (auto& expression : cond)
+                {
+                    CompiledCondition::Term term;
+                    term.op = expression._operator;
+                    term.left = _compileOperand(expression._leftOperand);
+                    if (term.op != LogicalExpression::Operator::NONE)
+                    {
+                        term.right = _compileOperand(expression._rightOperand);
+                    }
+                    else if (term.left.type == ConditionOperand::Type::RAND)
+                    {
+                        // If(Rand(30%)) holds with the given chance
+                        term.op = LogicalExpression::Operator::LT;
+                        term.right.value = term.left.value;
+                    }
+                    compiled.terms.push_back(term);
+                }
+                return compiled;
+            }
+
+            ConditionOperand WorldmapFile::_compileOperand(const NumericExpression& expression)
+            {
+                ConditionOperand operand;
+                // numbers like 30% are read up to the sign
+                operand.value = expression.arg.toInt();
+                if (expression.func == NumericExpression::PLAYER)
+                {
+                    operand.type = ConditionOperand::Type::PLAYER;
+                    operand.symbol = static_cast<int>(_symbol(expression.arg.str()));
+                }
+                else if (expression.func == NumericExpression::TIME_OF_DAY)
+                {
+                    operand.type = ConditionOperand::Type::TIME_OF_DAY;
+                }
+                else if (expression.func == NumericExpression::GLOBAL)
+                {
+                    operand.type = ConditionOperand::Type::GLOBAL;
+                    auto& name = expression.arg.str();
+                    if (!name.empty() && !std::isdigit(static_cast<unsigned char>(name[0])))
+                    {
+                        operand.symbol = static_cast<int>(_symbol(name));
+                    }
+                }
+                else if (expression.func == NumericExpression::RAND)
+                {
+                    operand.type = ConditionOperand::Type::RAND;
+                }
+                else if (expression.func != NumericExpression::CONSTANT)
+                {
+                    // unknown functions were never evaluated, they count as 0
+                    operand.value = 0;
+                }
+                return operand;
+            }
+
+            unsigned int WorldmapFile::_symbol(const std::string& name)
+            {
+                auto it = _symbolIds.find(name);
+                if (it != _symbolIds.end())
+                {
+                    return it->second;
+                }
+                auto id = static_cast<unsigned int>(symbols.size());
+                symbols.push_back(name);
+                _symbolIds.emplace(name, id);
+                return id;
             }
 
             LogicalExpression WorldmapFile::_parseLogicalExpression(Lexer& lexer)
@@ -430,8 +669,9 @@ namespace Falltergeist
 
             WorldmapFile::WorldmapFile(Dat::Stream&& stream)
             {
-                std::istream istr(&stream);
-                _parseText(istr);
+                std::string storage;
+                auto text = Txt::Parser::text(stream, storage);
+                _parseText(storage.empty() ? std::string(text) : std::move(storage));
             }
         }
     }
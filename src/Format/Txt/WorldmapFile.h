@@ -1,9 +1,15 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <string>
+#include <string_view>
 #include <vector>
 #include "../Dat/Item.h"
+#include "../Ini/SectionIndex.h"
 #include "../Ini/Value.h"
 
 namespace Falltergeist
@@ -58,6 +64,65 @@ namespace Falltergeist
             // Conditions consist of "sub-conditions" (Terms), delimited by "And".
             typedef std::vector<LogicalExpression> Condition;
 
+            /**
+             * Operand of a compiled condition, the function name is resolved to a type and the argument to a number.
+             */
+            struct ConditionOperand
+            {
+                enum class Type : uint8_t
+                {
+                    CONSTANT = 0, PLAYER, TIME_OF_DAY, GLOBAL, RAND
+                };
+
+                Type type = Type::CONSTANT;
+                // the constant, the number of the global variable or the percent chance of Rand
+                int value = 0;
+                // index in WorldmapFile::symbols of the argument given by name (player stats, named globals), -1 if none
+                int symbol = -1;
+            };
+
+            /**
+             * Values conditions are evaluated against, provided by the game.
+             */
+            class ConditionContext
+            {
+                public:
+                    virtual ~ConditionContext() = default;
+
+                    // Value of the player stat, perk, trait or skill named by the symbol
+                    virtual int player(unsigned int symbol) const = 0;
+                    virtual int timeOfDay() const = 0;
+                    virtual int global(unsigned int number) const = 0;
+                    virtual int global(const std::string& name) const = 0;
+                    // Between 0 and 99
+                    virtual int random() const = 0;
+            };
+
+            /**
+             * Condition compiled when WORLDMAP.TXT is parsed, so evaluating it does no string lookups
+             * besides globals given by name.
+             */
+            class CompiledCondition
+            {
+                public:
+                    struct Term
+                    {
+                        LogicalExpression::Operator op = LogicalExpression::Operator::NONE;
+                        ConditionOperand left;
+                        ConditionOperand right;
+                    };
+
+                    // Every term has to hold, an empty condition always does
+                    bool evaluate(const ConditionContext& context, const std::vector<std::string>& symbols) const;
+
+                    bool empty() const;
+
+                    std::vector<Term> terms;
+
+                private:
+                    static int _value(const ConditionOperand& operand, const ConditionContext& context, const std::vector<std::string>& symbols);
+            };
+
             /**
              * Inventory item of object.
              */
@@ -83,7 +148,7 @@ namespace Falltergeist
                 int distance = -1;
                 bool dead = false;
                 std::vector<InventoryItem> items;
-                Condition condition;
+                CompiledCondition condition;
             };
 
 
@@ -92,6 +157,7 @@ namespace Falltergeist
              */
             struct Encounter
             {
+                std::string name;
                 /**
                  * Type of positioning: surrounding, wedge, etc.
                  */
@@ -118,6 +184,8 @@ namespace Falltergeist
             struct EncounterGroup
             {
                 std::string encounterType;
+                // index in WorldmapFile::encounterTypes, -1 if there is no such type
+                int encounterTypeId = -1;
                 unsigned int minCount;
                 unsigned int maxCount;
             };
@@ -151,7 +219,7 @@ namespace Falltergeist
                  */
                 unsigned char chance = 0;
                 int counter = -1;
-                Condition condition;
+                CompiledCondition condition;
                 std::vector<EncounterGroup> team1;
                 // used only when FIGHTING
                 std::vector<EncounterGroup> team2;
@@ -198,6 +266,8 @@ namespace Falltergeist
                 unsigned char afternoonChance;
                 unsigned char nightChance;
                 std::string encounterTable;
+                // index in WorldmapFile::encounterTables, -1 if there is no such table
+                int encounterTableId = -1;
             };
 
             /**
@@ -225,13 +295,27 @@ namespace Falltergeist
 
                     std::map<std::string, unsigned char> chanceNames;
                     std::map<std::string, TerrainType> terrainTypes;
-                    std::map<std::string, Encounter> encounterTypes;
-                    std::map<std::string, EncounterTable> encounterTables;
+                    // types and tables are referred to by their index, the maps give the index of a name
+                    std::map<std::string, unsigned int> encounterTypeIds;
+                    std::map<std::string, unsigned int> encounterTableIds;
                     std::vector<WorldmapTile> tiles;
+                    // names used as arguments of conditions, ConditionOperand::symbol is an index into it.
+                    // Grows as encounter tables are parsed
+                    std::vector<std::string> symbols;
+
+                    /**
+                     * Encounter types and tables are parsed from their sections on first access.
+                     * @throws std::out_of_range if there is no such type or table
+                     */
+                    const Encounter& encounterType(unsigned int id);
+                    const EncounterTable& encounterTable(unsigned int id);
 
                 protected:
 
-                    void _parseText(std::istream& istr);
+                    void _parseText(std::string text);
+
+                    Encounter _parseEncounterType(const Ini::Section& section);
+                    EncounterTable _parseEncounterTable(const Ini::Section& section);
 
                     EncounterObject _parseEncounterObject(const Ini::Value&);
                     InventoryItem _parseInventoryItem(const std::string&);
@@ -239,7 +323,11 @@ namespace Falltergeist
                     EncounterTableEntry _parseEncounterTableEntry(const Ini::Value&);
                     EncounterGroup _parseEncounterGroup(Lexer& lexer);
 
-                    Condition _parseCondition(const std::string&);
+                    CompiledCondition _parseCondition(const std::string&);
+                    ConditionOperand _compileOperand(const NumericExpression& expression);
+                    unsigned int _symbol(const std::string& name);
+                    // Replaces names of encounter tables of subtiles by their indexes, once every section is indexed
+                    void _resolveIds();
                     LogicalExpression _parseLogicalExpression(Lexer& lexer);
                     NumericExpression _parseNumericExpression(Lexer& lexer);
 
@@ -249,6 +337,17 @@ namespace Falltergeist
 
                     unsigned char _chanceByName(std::string);
                     LogicalExpression::Operator _operatorByLexem(int lexem);
+
+                private:
+                    std::map<std::string, unsigned int> _symbolIds;
+
+                    Ini::SectionIndex _sections;
+                    // the section each type and table id is parsed from
+                    std::vector<size_t> _encounterTypeSections;
+                    std::vector<size_t> _encounterTableSections;
+                    std::vector<std::unique_ptr<Encounter>> _encounterTypes;
+                    std::vector<std::unique_ptr<EncounterTable>> _encounterTables;
+                    std::mutex _mutex;
             };
         }
     }
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "FrameStats.h"
+#include "Logger.h"
+
+namespace Falltergeist
+{
+    namespace
+    {
+        // quarter milliseconds up to 100 ms, longer frames share the last bucket
+        const float BUCKET_WIDTH = 0.25f;
+        const unsigned int BUCKETS = 400;
+
+        // entries of each kind written to the log per hitch
+        const size_t LOGGED_ENTRIES = 10;
+
+        struct State
+        {
+            unsigned int counts[BUCKETS + 1] = {};
+            // bucket of each frame in the window, oldest at next once it's full
+            std::vector<uint16_t> window;
+            size_t next = 0;
+
+            unsigned long long frame = 0;
+            unsigned int hitches = 0;
+            FrameStats::Clock::duration threshold = FrameStats::Clock::duration::zero();
+
+            std::mutex resourcesMutex;
+            std::vector<std::string> resources;
+            // calls by "script:procedure"
+            std::unordered_map<std::string, unsigned int> scripts;
+            std::vector<std::string> states;
+        };
+
+        State& stats()
+        {
+            static State stats;
+            return stats;
+        }
+
+        void logEntries(std::ostream& stream, const char* title, const std::vector<std::string>& entries)
+        {
+            if (entries.empty()) {
+                return;
+            }
+            stream << std::endl << "  " << title << " (" << entries.size() << "):";
+            for (size_t i = 0; i != entries.size() && i != LOGGED_ENTRIES; ++i) {
+                stream << (i ? ", " : " ") << entries[i];
+            }
+            if (entries.size() > LOGGED_ENTRIES) {
+                stream << " and " << entries.size() - LOGGED_ENTRIES << " more";
+            }
+        }
+    }
+
+    std::atomic<bool> FrameStats::_enabled{false};
+
+    void FrameStats::setHitchThreshold(unsigned int milliseconds)
+    {
+        stats().threshold = std::chrono::milliseconds(milliseconds);
+        _enabled.store(milliseconds > 0, std::memory_order_relaxed);
+    }
+
+    void FrameStats::resource(const std::string& filename)
+    {
+        if (!enabled()) {
+            return;
+        }
+        auto& current = stats();
+        std::lock_guard<std::mutex> lock(current.resourcesMutex);
+        current.resources.push_back(filename);
+    }
+
+    void FrameStats::script(const std::string& filename, const std::string& procedure)
+    {
+        if (!enabled()) {
+            return;
+        }
+        stats().scripts[filename + ":" + procedure]++;
+    }
+
+    void FrameStats::state(const std::string& name)
+    {
+        if (!enabled()) {
+            return;
+        }
+        stats().states.push_back(name);
+    }
+
+    void FrameStats::frame(Clock::duration time)
+    {
+        auto& current = stats();
+        float milliseconds = std::chrono::duration<float, std::milli>(time).count();
+
+        auto bucket = static_cast<uint16_t>(std::min(static_cast<unsigned int>(milliseconds / BUCKET_WIDTH), BUCKETS));
+        if (current.window.size() < FRAMES) {
+            current.window.push_back(bucket);
+        } else {
+            current.counts[current.window[current.next]]--;
+            current.window[current.next] = bucket;
+            current.next = (current.next + 1) % FRAMES;
+        }
+        current.counts[bucket]++;
+        current.frame++;
+
+        if (enabled() && time > current.threshold) {
+            current.hitches++;
+
+            std::vector<std::string> resources;
+            {
+                std::lock_guard<std::mutex> lock(current.resourcesMutex);
+                resources = std::move(current.resources);
+            }
+            // most frequent calls first
+            std::vector<std::pair<std::string, unsigned int>> calls(current.scripts.begin(), current.scripts.end());
+            std::sort(calls.begin(), calls.end(), [](const std::pair<std::string, unsigned int>& a, const std::pair<std::string, unsigned int>& b) {
+                return a.second > b.second;
+            });
+            std::vector<std::string> scripts;
+            for (auto& call : calls) {
+                scripts.push_back(call.first + (call.second > 1 ? " x" + std::to_string(call.second) : ""));
+            }
+
+            auto& log = Logger::warning("FRAME");
+            log << "Hitch of " << milliseconds << " ms in frame " << current.frame << ", p99 " << percentile(0.99f) << " ms";
+            logEntries(log, "loaded", resources);
+            logEntries(log, "scripts", scripts);
+            logEntries(log, "states pushed", current.states);
+            log << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(current.resourcesMutex);
+            current.resources.clear();
+        }
+        current.scripts.clear();
+        current.states.clear();
+    }
+
+    float FrameStats::percentile(float part)
+    {
+        auto& current = stats();
+        if (current.window.empty()) {
+            return 0.0f;
+        }
+
+        auto wanted = static_cast<size_t>(std::ceil(part * current.window.size()));
+        size_t seen = 0;
+        for (unsigned int bucket = 0; bucket != BUCKETS; ++bucket) {
+            seen += current.counts[bucket];
+            if (seen >= wanted) {
+                return (bucket + 1) * BUCKET_WIDTH;
+            }
+        }
+        return BUCKETS * BUCKET_WIDTH;
+    }
+
+    unsigned int FrameStats::hitches()
+    {
+        return stats().hitches;
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace Falltergeist
+{
+    /**
+     * FrameStats keeps a histogram of the frame times of the last frames and reports hitches. While the detector
+     * is enabled, the resources loaded, script procedures run and states pushed during a frame are collected,
+     * and a frame taking longer than the threshold logs them as a warning. Collecting costs a single check if disabled.
+     */
+    class FrameStats final
+    {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            // size of the rolling window of the histogram
+            static const unsigned int FRAMES = 600;
+
+            static bool enabled()
+            {
+                return _enabled.load(std::memory_order_relaxed);
+            }
+
+            // 0 disables the hitch detector, the histogram is kept anyway
+            static void setHitchThreshold(unsigned int milliseconds);
+
+            // Any thread
+            static void resource(const std::string& filename);
+
+            // Main thread only, like the following ones
+            static void script(const std::string& filename, const std::string& procedure);
+
+            static void state(const std::string& name);
+
+            // Ends the frame which took the given time, logs what happened during it if that's a hitch
+            static void frame(Clock::duration time);
+
+            // Frame time in milliseconds which the given part of the frames in the window didn't exceed, 0.99 for p99
+            static float percentile(float part);
+
+            static unsigned int hitches();
+
+        private:
+            static std::atomic<bool> _enabled;
+    };
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include "../Format/Enums.h"
 #include "../Game/ItemObject.h"
 
@@ -36,8 +37,8 @@ namespace Falltergeist
                 void setArmorClass(unsigned int value);
 
             protected:
-                std::vector<int> _damageResist = {0, 0, 0, 0, 0, 0, 0, 0, 0};
-                std::vector<int> _damageThreshold = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+                std::array<int, 9> _damageResist = {};
+                std::array<int, 9> _damageThreshold = {};
                 int _perk = -1;
                 unsigned int _maleFID = 0;
                 unsigned int _femaleFID = 0;
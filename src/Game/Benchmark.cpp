@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <vector>
+#include "../CrossPlatform.h"
+#include "../Game/Benchmark.h"
+#include "../Game/DudeObject.h"
+#include "../Game/Game.h"
+#include "../Game/Location.h"
+#include "../Game/Replay.h"
+#include "../Helpers/GameLocationHelper.h"
+#include "../ResourceManager.h"
+#include "../Settings.h"
+#include "../State/Location.h"
+#include "../State/Start.h"
+#include "../UI/ResourceManager.h"
+#include "../UI/TextArea.h"
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        namespace
+        {
+            // the map name is given on the command line, everything else in the report is numbers
+            std::string jsonString(const std::string& value)
+            {
+                std::string result = "\"";
+                for (char c : value) {
+                    if (c == '"' || c == '\\') {
+                        result += '\\';
+                    }
+                    result += (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+                }
+                return result + "\"";
+            }
+        }
+
+        Benchmark::Benchmark(std::shared_ptr<ILogger> logger) : _logger(std::move(logger))
+        {
+        }
+
+        std::shared_ptr<Location> Benchmark::load(const std::string& map)
+        {
+            auto game = Game::getInstance();
+
+            if (!game->player()) {
+                auto player = std::make_shared<DudeObject>();
+                player->loadFromGCDFile(ResourceManager::getInstance()->gcdFileType("premade/combat.gcd"));
+                game->setPlayer(player);
+            }
+
+            Helpers::GameLocationHelper gameLocationHelper(_logger);
+            auto location = gameLocationHelper.getByName(map);
+            if (!location) {
+                _logger->error() << "[BENCHMARK] No such map: " << map << std::endl;
+                return nullptr;
+            }
+
+            auto locationState = new State::Location(
+                game->player(),
+                game->mouse(),
+                game->settings(),
+                game->renderer(),
+                game->mixer(),
+                game->gameTime(),
+                std::make_shared<UI::ResourceManager>(),
+                _logger
+            );
+            locationState->setElevation(location->defaultElevationIndex());
+            locationState->setLocation(location);
+            game->setState(locationState);
+
+            // map enter scripts run in the first think
+            game->think(1000.0f / game->settings()->simulationRate());
+            return location;
+        }
+
+        bool Benchmark::run(const std::string& map, unsigned int frames, std::ostream& report)
+        {
+            using Clock = std::chrono::steady_clock;
+            using Milliseconds = std::chrono::duration<double, std::milli>;
+
+            auto game = Game::getInstance();
+            report << std::fixed << std::setprecision(3);
+
+            auto loadStart = Clock::now();
+            if (!load(map)) {
+                report << "{\"map\": " << jsonString(map) << ", \"error\": \"no such map\"}" << std::endl;
+                return false;
+            }
+            double loadTime = Milliseconds(Clock::now() - loadStart).count();
+
+            const float step = 1000.0f / game->settings()->simulationRate();
+            std::vector<double> times;
+            times.reserve(frames);
+            for (unsigned int i = 0; i != frames; ++i) {
+                auto frameStart = Clock::now();
+                game->think(step);
+                game->render();
+                ResourceManager::getInstance()->trim();
+                times.push_back(Milliseconds(Clock::now() - frameStart).count());
+            }
+
+            report << "{\"map\": " << jsonString(map)
+                   << ", \"frames\": " << frames
+                   << ", \"load_ms\": " << loadTime;
+            _report(report, std::move(times));
+            return true;
+        }
+
+        void Benchmark::replay(const Replay& replay, const std::string& name, std::ostream& report)
+        {
+            using Clock = std::chrono::steady_clock;
+            using Milliseconds = std::chrono::duration<double, std::milli>;
+
+            auto game = Game::getInstance();
+            report << std::fixed << std::setprecision(3);
+
+            auto uiResourceManager = std::make_shared<UI::ResourceManager>();
+            game->setState(new State::Start(uiResourceManager, _logger));
+            game->startReplay(replay);
+
+            const float step = 1000.0f / replay.simulationRate();
+            auto event = replay.events().begin();
+            std::vector<double> times;
+            times.reserve(replay.frames().size());
+            for (auto& frame : replay.frames()) {
+                auto frameStart = Clock::now();
+                for (uint32_t i = 0; i != frame.events; ++i, ++event) {
+                    game->handleReplayed(*event);
+                }
+                for (uint32_t i = 0; i != frame.steps; ++i) {
+                    game->think(step);
+                }
+                game->render();
+                ResourceManager::getInstance()->trim();
+                times.push_back(Milliseconds(Clock::now() - frameStart).count());
+            }
+
+            report << "{\"replay\": " << jsonString(name)
+                   << ", \"frames\": " << times.size();
+            _report(report, std::move(times));
+        }
+
+        void Benchmark::_report(std::ostream& report, std::vector<double> times) const
+        {
+            if (!times.empty()) {
+                std::sort(times.begin(), times.end());
+                // nearest rank, so a single slow frame out of 100 is the p99
+                size_t p99 = static_cast<size_t>(std::ceil(times.size() * 0.99)) - 1;
+                report << ", \"frame_ms\": {"
+                       << "\"min\": " << times.front()
+                       << ", \"avg\": " << std::accumulate(times.begin(), times.end(), 0.0) / times.size()
+                       << ", \"p99\": " << times[p99]
+                       << ", \"max\": " << times.back()
+                       << "}";
+            }
+            report << ", \"peak_rss_bytes\": " << CrossPlatform::getPeakMemoryUsage() << "}" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "../ILogger.h"
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        class Location;
+        class Replay;
+
+        /**
+         * Loads a single location into an initialized game and runs it for a fixed number of frames.
+         * Input is not handled and logic advances by one simulation step per frame, so runs are comparable.
+         * A replay runs the recorded session from the start screen instead, with its inputs and steps.
+         */
+        class Benchmark
+        {
+            public:
+                Benchmark(std::shared_ptr<ILogger> logger);
+
+                // Makes the map the only state and runs its map enter scripts, nullptr if there is no such map
+                std::shared_ptr<Location> load(const std::string& map);
+
+                // Returns false if the map doesn't exist, the report is written either way
+                bool run(const std::string& map, unsigned int frames, std::ostream& report);
+
+                // The game has to be initialized at the simulation rate of the replay
+                void replay(const Replay& replay, const std::string& name, std::ostream& report);
+
+            private:
+                std::shared_ptr<ILogger> _logger;
+
+                // Adds the frame time statistics and the memory used, closing the JSON object
+                void _report(std::ostream& report, std::vector<double> times) const;
+        };
+    }
+}
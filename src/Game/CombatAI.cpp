@@ -0,0 +1,148 @@
+#include <algorithm>
+#include "../Game/CombatAI.h"
+#include "../Game/CritterObject.h"
+#include "../PathFinding/DistanceField.h"
+#include "../PathFinding/Hexagon.h"
+#include "../PathFinding/HexagonGrid.h"
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        namespace
+        {
+            // a clear shot outweighs walking the whole turn, every enemy able to shoot back costs a few hexagons
+            const int LINE_OF_FIRE = 50;
+            const int THREAT = 8;
+            const int WALKED = 1;
+            const int TARGET_DISTANCE = 1;
+            // without a shot the critter closes in on its target along the target's distance field
+            const int APPROACH = 2;
+        }
+
+        const std::chrono::microseconds CombatAI::DEFAULT_BUDGET(2000);
+
+        CombatAI::CombatAI(HexagonGrid* grid) : _grid(grid)
+        {
+        }
+
+        CombatAI::~CombatAI() = default;
+
+        void CombatAI::beginRound()
+        {
+            // fire maps are kept allocated, bumping the round invalidates what they traced
+            _round++;
+        }
+
+        void CombatAI::forget(CritterObject* critter)
+        {
+            _fireMaps.erase(critter);
+        }
+
+        bool CombatAI::_canShoot(CritterObject* enemy, Hexagon* hexagon)
+        {
+            auto& map = _fireMaps[enemy];
+            if (map.round != _round || map.from != enemy->hexagon()) {
+                if (map.lines.empty()) {
+                    map.lines.resize(_grid->size());
+                }
+                std::fill(map.lines.begin(), map.lines.end(), 0);
+                map.round = _round;
+                map.from = enemy->hexagon();
+            }
+            auto& line = map.lines[hexagon->index()];
+            if (!line) {
+                line = (hexagon == map.from || _grid->canShoot(map.from, hexagon)) ? 2 : 1;
+            }
+            return line == 2;
+        }
+
+        CombatAI::Decision CombatAI::decide(CritterObject* critter, const std::vector<CritterObject*>& enemies, Clock::duration budget)
+        {
+            const auto deadline = Clock::now() + budget;
+            Decision best;
+            Hexagon* position = critter->hexagon();
+            if (!position) {
+                return best;
+            }
+
+            _targets.clear();
+            for (auto enemy : enemies) {
+                if (enemy != critter && enemy->hexagon() && enemy->hitPoints() > 0) {
+                    _targets.push_back(enemy);
+                }
+            }
+            if (_targets.empty()) {
+                best.destination = position;
+                best.complete = true;
+                return best;
+            }
+
+            // first pass: the nearest enemy from where the critter stands, always there when the budget runs out
+            auto nearest = *std::min_element(_targets.begin(), _targets.end(), [this, position](CritterObject* a, CritterObject* b) {
+                return _grid->distance(position, a->hexagon()) < _grid->distance(position, b->hexagon());
+            });
+            best.target = nearest;
+            best.destination = position;
+            best.lineOfFire = _canShoot(nearest, position);
+            best.score = (best.lineOfFire ? LINE_OF_FIRE : 0) - TARGET_DISTANCE * (int) _grid->distance(position, nearest->hexagon());
+            if (Clock::now() >= deadline) {
+                return best;
+            }
+
+            // then every hexagon the critter can walk to, nearest first
+            const unsigned int reach = std::min<unsigned int>(std::max(critter->actionPoints(), 0), MAX_REACH);
+            // kept by the grid for each critter, a critter which didn't move since its last decision reuses it
+            auto& reachable = _grid->reachable(critter, position, reach);
+            _candidates.clear();
+            _candidates.push_back(position);
+            for (unsigned int radius = 1; radius <= reach; ++radius) {
+                for (auto hexagon : _grid->ring(position, radius)) {
+                    if (hexagon && reachable.cost(hexagon) <= reach) {
+                        _candidates.push_back(hexagon);
+                    }
+                }
+            }
+
+            bool first = true;
+            for (auto candidate : _candidates) {
+                if (Clock::now() >= deadline) {
+                    return best;
+                }
+
+                int threat = 0;
+                for (auto enemy : _targets) {
+                    if (_canShoot(enemy, candidate)) {
+                        threat++;
+                    }
+                }
+                const int walked = (int) reachable.cost(candidate);
+
+                for (auto target : _targets) {
+                    const bool lineOfFire = _canShoot(target, candidate);
+                    int score = -THREAT * threat - WALKED * walked - TARGET_DISTANCE * (int) _grid->distance(candidate, target->hexagon());
+                    if (lineOfFire) {
+                        score += LINE_OF_FIRE;
+                    } else {
+                        // shared by every critter chasing the target, recomputed only when it has moved
+                        auto approach = _grid->distanceField(target, target->hexagon()).cost(candidate);
+                        if (approach == DistanceField::UNREACHABLE) {
+                            continue;
+                        }
+                        score -= APPROACH * (int) approach;
+                    }
+                    // the rough guess ignored the threat, so it isn't comparable with the scored candidates
+                    if (first || score > best.score) {
+                        first = false;
+                        best.target = target;
+                        best.destination = candidate;
+                        best.lineOfFire = lineOfFire;
+                        best.score = score;
+                    }
+                }
+            }
+            best.complete = true;
+            return best;
+        }
+    }
+}
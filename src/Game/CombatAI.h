@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Falltergeist
+{
+    class Hexagon;
+    class HexagonGrid;
+
+    namespace Game
+    {
+        class CritterObject;
+
+        /**
+         * @brief Decides where a critter moves and whom it attacks in its combat turn
+         *
+         * Caches are kept per combat round: whether an enemy can shoot a hexagon is traced once and shared by all
+         * critters fighting that enemy, walking costs come from the distance fields of the hexagon grid.
+         * A decision is refined step by step (nearest enemy, reachable hexagons, their cover and lines of fire)
+         * and the best one found so far is returned when the time budget is spent, so a turn takes bounded time
+         * however crowded the map.
+         */
+        class CombatAI final
+        {
+            public:
+                using Clock = std::chrono::steady_clock;
+
+                static const std::chrono::microseconds DEFAULT_BUDGET;
+
+                struct Decision
+                {
+                    CritterObject* target = nullptr;
+                    // hexagon to walk to, the one the critter stands on to stay
+                    Hexagon* destination = nullptr;
+                    // the target can be shot from the destination
+                    bool lineOfFire = false;
+                    int score = 0;
+                    // every candidate was scored before the budget was spent
+                    bool complete = false;
+                };
+
+                // farthest a critter walks in one turn, whatever its action points
+                static const unsigned int MAX_REACH = 30;
+
+                explicit CombatAI(HexagonGrid* grid);
+                ~CombatAI();
+
+                // Starts a round of combat, critters moved since the last one
+                void beginRound();
+
+                // Walks at most actionPoints hexagons, enemies which are dead or off the map are ignored
+                Decision decide(CritterObject* critter, const std::vector<CritterObject*>& enemies,
+                                Clock::duration budget = DEFAULT_BUDGET);
+
+                // Has to be called when the critter leaves the map
+                void forget(CritterObject* critter);
+
+            private:
+                struct FireMap
+                {
+                    Hexagon* from = nullptr;
+                    // 0 not traced yet in the round, 1 blocked, 2 clear
+                    std::vector<uint8_t> lines;
+                    uint32_t round = 0;
+                };
+
+                HexagonGrid* _grid;
+                uint32_t _round = 1;
+                std::unordered_map<const CritterObject*, FireMap> _fireMaps;
+
+                std::vector<Hexagon*> _candidates;
+                std::vector<CritterObject*> _targets;
+
+                // Whether the enemy can shoot the hexagon from where it stands now
+                bool _canShoot(CritterObject* enemy, Hexagon* hexagon);
+        };
+    }
+}
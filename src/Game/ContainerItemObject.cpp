@@ -13,7 +13,7 @@ namespace Falltergeist
             _subtype = Subtype::CONTAINER;
         }
 
-        std::vector<ItemObject*>* ContainerItemObject::inventory()
+        Inventory* ContainerItemObject::inventory()
         {
             return &_inventory;
         }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <vector>
+#include "../Game/Inventory.h"
 #include "../Game/ItemObject.h"
 
 namespace Falltergeist
@@ -16,7 +16,7 @@ namespace Falltergeist
                 ContainerItemObject();
                 ~ContainerItemObject() = default;
 
-                std::vector<ItemObject*>* inventory();
+                Inventory* inventory();
 
                 void use_p_proc(CritterObject* usedBy) override;
 
@@ -27,7 +27,7 @@ namespace Falltergeist
                 void setOpened(bool opened);
 
             protected:
-                std::vector<ItemObject*> _inventory;
+                Inventory _inventory;
                 bool _opened = false;
                 bool _locked = false;
         };
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <string>
 #include <memory>
@@ -13,6 +14,7 @@
 #include "../Graphics/CritterAnimationFactory.h"
 #include "../PathFinding/Hexagon.h"
 #include "../ResourceManager.h"
+#include "../Simulation.h"
 #include "../State/Location.h"
 #include "../UI/AnimationFrame.h"
 #include "../UI/TextArea.h"
@@ -29,7 +31,7 @@ namespace Falltergeist
             _setupNextIdleAnim();
         }
 
-        std::vector<ItemObject*>* CritterObject::inventory()
+        Inventory* CritterObject::inventory()
         {
             return &_inventory;
         }
@@ -308,6 +310,7 @@ namespace Falltergeist
         void CritterObject::setHitPoints(int value)
         {
             _hitPoints = value;
+            ++_revision;
         }
 
         int CritterObject::hitPointsMax() const
@@ -352,10 +355,7 @@ namespace Falltergeist
 
         unsigned int CritterObject::carryWeight() const
         {
-            unsigned int weight = 0;
-            for (auto item : _inventory) {
-                weight += item->weight();
-            }
+            unsigned int weight = _inventory.weight();
 
             if (auto armor = dynamic_cast<ItemObject*>(armorSlot())) {
                 weight += armor->weight();
@@ -474,10 +474,10 @@ namespace Falltergeist
 
         void CritterObject::talk_p_proc()
         {
-            if (_script && _script->hasFunction("talk_p_proc")) {
+            if (_script && _script->hasFunction(PROCEDURE::TALK)) {
                 _script
                     ->setSourceObject(Game::getInstance()->player().get())
-                    ->call("talk_p_proc")
+                    ->call(PROCEDURE::TALK)
                 ;
             }
         }
@@ -488,15 +488,26 @@ namespace Falltergeist
 
         void CritterObject::combat_p_proc()
         {
+            wakeUp();
         }
 
         void CritterObject::critter_p_proc()
         {
-            if (_script && _script->hasFunction("critter_p_proc")) {
-                _script->call("critter_p_proc");
+            if (_script && _script->hasFunction(PROCEDURE::CRITTER)) {
+                _script->call(PROCEDURE::CRITTER);
             }
         }
 
+        void CritterObject::wakeUp(unsigned int milliseconds)
+        {
+            _awakeUntil = std::max(_awakeUntil, Simulation::ticks() + milliseconds);
+        }
+
+        bool CritterObject::awake() const
+        {
+            return Simulation::ticks() < _awakeUntil;
+        }
+
         void CritterObject::is_dropping_p_proc()
         {
         }
@@ -511,6 +522,11 @@ namespace Falltergeist
             return &_movementQueue;
         }
 
+        bool CritterObject::parallelThink() const
+        {
+            return false;
+        }
+
         void CritterObject::think(const float &deltaTime)
         {
             if (!movementQueue()->empty()) {
@@ -527,7 +543,7 @@ namespace Falltergeist
             } else {
                 auto anim = (UI::Animation*)ui();
                 if (!_moving && (!anim || !anim->playing())) {
-                    if (SDL_GetTicks() > _nextIdleAnim) {
+                    if (Simulation::ticks() > _nextIdleAnim) {
                         setActionAnimation("aa");
                         _setupNextIdleAnim();
                     }
@@ -782,6 +798,12 @@ namespace Falltergeist
             setActionAnimation("aa")->stop();
         }
 
+        void CritterObject::_invalidateUi()
+        {
+            // the animation drives movement and idle animations, it's needed whether the critter is seen or not
+            _generateUi();
+        }
+
         void CritterObject::setRadiationLevel(int radiationLevel)
         {
             this->_radiationLevel = radiationLevel;
@@ -847,7 +869,7 @@ namespace Falltergeist
 
         void CritterObject::_setupNextIdleAnim()
         {
-            _nextIdleAnim = SDL_GetTicks() + 10000 + (rand() % 7000);
+            _nextIdleAnim = Simulation::ticks() + 10000 + (Simulation::random() % 7000);
         }
 
         unsigned CritterObject::age() const
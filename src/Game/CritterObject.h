@@ -1,7 +1,9 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include "../Format/Enums.h"
+#include "../Game/Inventory.h"
 #include "../Game/Object.h"
 
 namespace Falltergeist
@@ -26,7 +28,7 @@ namespace Falltergeist
                 CritterObject();
                 ~CritterObject() = default;
 
-                std::vector<ItemObject*>* inventory(); // critter's own inventory
+                Inventory* inventory(); // critter's own inventory
                 void setOrientation(Orientation value) override;
 
                 std::vector<Hexagon*>* movementQueue();
@@ -124,10 +126,17 @@ namespace Falltergeist
                 virtual void is_dropping_p_proc();
 
                 void think(const float &deltaTime) override;
+                // moving critters create their animations and walk the hexagon grid
+                bool parallelThink() const override;
                 virtual void onMovementAnimationEnded(Event::Event* event);
                 virtual void onMovementAnimationFrame(Event::Event* event);
 
                 virtual bool running() const;
+
+                // Keeps critter_p_proc running for a while wherever the critter is,
+                // called for its timer events, spatial triggers and combat
+                void wakeUp(unsigned int milliseconds = 10000);
+                bool awake() const;
                 virtual void setRunning(bool value);
 
                 virtual void stopMovement();
@@ -200,19 +209,21 @@ namespace Falltergeist
                 bool _canKnockdown; // can be knocked down
 
                 unsigned int _nextIdleAnim = 0;
+                unsigned int _awakeUntil = 0;
                 unsigned _age = 0;
 
                 HAND _currentHand = HAND::RIGHT;
                 unsigned int _carryWeightMax = 0;
 
-                std::vector<int> _stats = {0, 0, 0, 0, 0, 0, 0};
-                std::vector<int> _statsBonus = {0, 0, 0, 0, 0, 0, 0};
-                std::vector<int> _skillsTagged = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-                std::vector<int> _skillsGainedValue = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-                std::vector<int> _traitsTagged = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-                std::vector<int> _damageResist = {0, 0, 0, 0, 0, 0, 0, 0, 0};
-                std::vector<int> _damageThreshold = {0, 0, 0, 0, 0, 0, 0, 0, 0};
-                std::vector<ItemObject*> _inventory;
+                // indexed by STAT, SKILL, TRAIT and DAMAGE, stored inline in the critter
+                std::array<int, 7> _stats = {};
+                std::array<int, 7> _statsBonus = {};
+                std::array<int, 18> _skillsTagged = {};
+                std::array<int, 18> _skillsGainedValue = {};
+                std::array<int, 16> _traitsTagged = {};
+                std::array<int, 9> _damageResist = {};
+                std::array<int, 9> _damageThreshold = {};
+                Inventory _inventory;
                 std::vector<Hexagon*> _movementQueue;
 
                 ArmorItemObject* _armorSlot = 0;
@@ -222,6 +233,7 @@ namespace Falltergeist
                 virtual std::unique_ptr<UI::Animation> _generateMovementAnimation();
                 void _setupNextIdleAnim();
                 void _generateUi() override;
+                void _invalidateUi() override;
         };
     }
 }
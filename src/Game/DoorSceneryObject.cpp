@@ -3,6 +3,7 @@
 #include "../Event/Event.h"
 #include "../Game/Game.h"
 #include "../Logger.h"
+#include "../PathFinding/HexagonGrid.h"
 #include "../State/Location.h"
 #include "../UI/Animation.h"
 #include "../UI/AnimationQueue.h"
@@ -30,6 +31,12 @@ namespace Falltergeist
                 _opened = value;
                 setCanLightThru(_opened);
 
+                // doors placed on the map change what the grid lets through
+                auto location = Game::getInstance()->locationState();
+                if (location && hexagon()) {
+                    location->hexagonGrid()->updateBlocking(hexagon());
+                }
+
                 if (auto queue = dynamic_cast<UI::AnimationQueue*>(this->ui())) {
                     queue->currentAnimation()->setReverse(value);
                 }
@@ -59,7 +66,7 @@ namespace Falltergeist
                         queue->start();
                         queue->animationEndedHandler().add([=](Event::Event*) { onOpeningAnimationEnded(queue); });
                         if (_soundId) {
-                            Game::getInstance()->mixer()->playACMSound(std::string("sound/sfx/sodoors") + _soundId + ".acm");
+                            playSound(std::string("sound/sfx/sodoors") + _soundId + ".acm");
                         }
                     }
                 } else {
@@ -67,12 +74,12 @@ namespace Falltergeist
                         queue->start();
                         queue->animationEndedHandler().add([=](Event::Event*) { onClosingAnimationEnded(queue); });
                         if (_soundId) {
-                            Game::getInstance()->mixer()->playACMSound(std::string("sound/sfx/scdoors") + _soundId + ".acm");
+                            playSound(std::string("sound/sfx/scdoors") + _soundId + ".acm");
                         }
                     }
                 }
             } else if (_soundId) {
-                Game::getInstance()->mixer()->playACMSound(std::string("sound/sfx/sldoors") + _soundId + ".acm");
+                playSound(std::string("sound/sfx/sldoors") + _soundId + ".acm");
             }
         }
 
@@ -87,7 +94,7 @@ namespace Falltergeist
             target->animationEndedHandler().clear();
             target->stop();
             target->currentAnimation()->setReverse(true);
-            Game::getInstance()->locationState()->initLight();
+            Game::getInstance()->locationState()->updateLight({hexagon()}, 0);
             Logger::info("") << "Door opened: " << opened() << std::endl;
         }
 
@@ -97,7 +104,7 @@ namespace Falltergeist
             target->animationEndedHandler().clear();
             target->stop();
             target->currentAnimation()->setReverse(false);
-            Game::getInstance()->locationState()->initLight();
+            Game::getInstance()->locationState()->updateLight({hexagon()}, 0);
             Logger::info("") << "Door opened: " << opened() << std::endl;
         }
     }
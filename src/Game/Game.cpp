@@ -1,28 +1,51 @@
 #include <algorithm>
 #include <sstream>
+#include <cstdlib>
 #include <ctime>
+#include <future>
 #include <memory>
+#include <thread>
+#include <typeinfo>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
 #include <SDL_image.h>
 #include "../Audio/Mixer.h"
+#include "../Base/JobSystem.h"
 #include "../CrossPlatform.h"
 #include "../Event/Dispatcher.h"
 #include "../Event/State.h"
 #include "../Exception.h"
 #include "../Format/Gam/File.h"
+#include "../FrameStats.h"
 #include "../Game/DudeObject.h"
 #include "../Game/Game.h"
+#include "../Game/Replay.h"
+#include "../Game/SaveFile.h"
 #include "../Game/Time.h"
+#include "../Game/WorldmapTerrain.h"
 #include "../Graphics/AnimatedPalette.h"
+#include "../Helpers/GameLocationHelper.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/RendererConfig.h"
 #include "../Input/Mouse.h"
 #include "../Input/SdlMouse.h"
+#include "../MemoryStats.h"
+#include "../Metrics.h"
 #include "../ResourceManager.h"
 #include "../Settings.h"
+#include "../Simulation.h"
 #include "../State/State.h"
 #include "../State/Location.h"
+#include "../State/LocationCache.h"
+#include "../Trace.h"
 #include "../UI/FpsCounter.h"
+#include "../UI/FrameStatsCounter.h"
+#include "../UI/MemoryStatsCounter.h"
+#include "../UI/RenderStatsCounter.h"
+#include "../UI/Base.h"
 #include "../UI/TextArea.h"
+#include "../VM/Profiler.h"
 #include "../Graphics/SdlWindow.h"
 
 namespace Falltergeist
@@ -31,6 +54,81 @@ namespace Falltergeist
     {
         Game* Game::_instance = nullptr;
 
+        namespace
+        {
+            using Clock = std::chrono::steady_clock;
+
+            // while fast-forwarding, a frame is presented after the logic ran this long
+            const auto FAST_FORWARD_FRAME = std::chrono::milliseconds(100);
+
+            double millisecondsSince(Clock::time_point start)
+            {
+                return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            }
+
+            // Durations of the startup steps. Background tasks report how long they ran
+            // and how long the main thread had to wait for them.
+            class StartupReport
+            {
+                public:
+                    StartupReport() : _started(Clock::now()), _last(_started)
+                    {
+                    }
+
+                    // Main thread time since the previous step
+                    void step(const std::string& name)
+                    {
+                        _steps << " " << name << " " << millisecondsSince(_last) << " ms,";
+                        _last = Clock::now();
+                    }
+
+                    template <class T>
+                    T wait(const std::string& name, std::future<std::pair<T, double>>& task)
+                    {
+                        auto result = task.get();
+                        _steps << " " << name << " " << result.second << " ms (waited " << millisecondsSince(_last) << " ms),";
+                        _last = Clock::now();
+                        return std::move(result.first);
+                    }
+
+                    void write(ILogger* logger)
+                    {
+                        logger->info() << "[GAME] Startup:" << _steps.str() << " total " << millisecondsSince(_started) << " ms" << std::endl;
+                    }
+
+                private:
+                    Clock::time_point _started;
+                    Clock::time_point _last;
+                    std::ostringstream _steps;
+            };
+
+            // Class name of the state without namespaces
+            std::string stateName(const State::State* state)
+            {
+                std::string name = typeid(*state).name();
+#ifdef __GNUG__
+                int status = 0;
+                if (char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status)) {
+                    name = demangled;
+                    free(demangled);
+                }
+#endif
+                auto separator = name.rfind(':');
+                return separator == std::string::npos ? name : name.substr(separator + 1);
+            }
+
+            // Runs the task on its own thread, the result comes with the duration of the task in milliseconds
+            template <class F>
+            auto startupTask(F task) -> std::future<std::pair<decltype(task()), double>>
+            {
+                return std::async(std::launch::async, [task]() {
+                    auto started = Clock::now();
+                    auto result = task();
+                    return std::make_pair(std::move(result), millisecondsSince(started));
+                });
+            }
+        }
+
         Game::Game() {
         }
 
@@ -59,11 +157,26 @@ namespace Falltergeist
                 return;
             }
             _initialized = true;
+            _initStarted = Clock::now();
+            StartupReport startup;
 
             _settings = std::move(settings);
 
             _eventDispatcher = std::make_unique<Event::Dispatcher>();
 
+            // the main thread works on the jobs it waits for, so it counts as one of the threads
+            unsigned int threads = std::thread::hardware_concurrency();
+            _jobs = std::make_unique<Base::JobSystem>(threads > 1 ? std::min(threads - 1, 7u) : 0);
+
+            // DAT archives are indexed while the window and the GL context are created.
+            // Nothing else may touch the resource manager until the task is joined, its singleton isn't thread-safe.
+            const size_t cacheBudget = static_cast<size_t>(_settings->resourceCacheSize()) * 1024 * 1024;
+            auto resources = startupTask([cacheBudget]() {
+                auto resourceManager = ResourceManager::getInstance();
+                resourceManager->setCacheBudget(cacheBudget);
+                return resourceManager;
+            });
+
             auto rendererConfig = createRendererConfigFromSettings();
 
             std::string version = CrossPlatform::getVersion();
@@ -75,8 +188,22 @@ namespace Falltergeist
                     Graphics::Size(rendererConfig->width(), rendererConfig->height())
                 ),
                 rendererConfig->isFullscreen(),
-                logger()
+                logger(),
+                _settings->headless(),
+                rendererConfig->isGles()
             );
+            startup.step("window");
+
+            // The audio device is opened while the renderer starts, the video subsystem is initialized by now
+            if (_settings->headless()) {
+                // an explicitly chosen driver is kept
+                SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+            }
+            auto audio = startupTask([this]() {
+                auto mixer = std::make_shared<Audio::Mixer>(logger());
+                mixer->setMusicVolume(_settings->musicVolume());
+                return mixer;
+            });
 
             auto sdlMouse = std::make_shared<Input::SdlMouse>(sdlWindow);
             sdlMouse->setCursorState(Input::IMouse::CursorState::Hidden);
@@ -92,19 +219,43 @@ namespace Falltergeist
 
             SDL_setenv("SDL_VIDEO_CENTERED", "1", 1);
 
-            // Force ResourceManager to initialize instance.
-            (void)ResourceManager::getInstance();
+            auto resourceManager = startup.wait("resources", resources);
+            VM::Profiler::setEnabled(_settings->scriptProfiler());
+            Trace::setEnabled(_settings->frameTrace());
+            Metrics::setEnabled(_settings->telemetry());
 
-            renderer()->init();
+            // Fonts and the main menu are parsed on the loader threads while shaders are compiled,
+            // only their textures are left to be created on the main thread
+            {
+                ResourceManager::RequestScope warmUp(ResourcePriority::SPECULATIVE);
+                for (auto font : {"font1.aaf", "font3.aaf", "font4.aaf"}) {
+                    resourceManager->requestAaf(font);
+                }
+                resourceManager->requestFrm("art/intrface/mainmenu.frm");
+            }
 
+            renderer()->init();
+            startup.step("renderer");
 
-            _mixer = std::make_shared<Audio::Mixer>(logger());
-            _mixer->setMusicVolume(_settings->musicVolume());
+            sdlMouse->setRenderer(_renderer);
+            _sdlMouse = sdlMouse;
             _mouse = std::make_shared<Input::Mouse>(_uiResourceManager, sdlMouse);
+            _mouse->setHardwareCursor(_settings->hardwareCursor());
             _mouse->setPosition({320, 240});
             _fpsCounter = std::make_unique<UI::FpsCounter>(Point(renderer()->size().width() - 42, 2));
             _fpsCounter->setWidth(42);
             _fpsCounter->setHorizontalAlign(UI::TextArea::HorizontalAlign::RIGHT);
+            if (_settings->renderStats()) {
+                renderer()->stats()->setTiming(true);
+                _renderStats = std::make_unique<UI::RenderStatsCounter>(Point(renderer()->size().width() - 200, 26), renderer()->stats());
+            }
+            if (_settings->memoryStats()) {
+                _memoryStats = std::make_unique<UI::MemoryStatsCounter>(Point(3, 2));
+            }
+            FrameStats::setHitchThreshold(_settings->hitchThreshold());
+            if (_settings->frameStats()) {
+                _frameStats = std::make_unique<UI::FrameStatsCounter>(Point(renderer()->size().width() - 210, 2));
+            }
 
             version += " " + std::to_string(renderer()->size().width()) + "x" + std::to_string(renderer()->size().height());
 
@@ -113,14 +264,23 @@ namespace Falltergeist
             _mousePosition->setWidth(55);
             _mousePosition->setHorizontalAlign(UI::TextArea::HorizontalAlign::RIGHT);
             _animatedPalette = std::make_unique<Graphics::AnimatedPalette>();
+            _saveFile = std::make_unique<SaveFile>();
+            _locationCache = std::make_unique<State::LocationCache>(_settings->keptLocations());
             _gameTime = std::make_shared<Time>();
             _currentTime = std::make_unique<UI::TextArea>("", renderer()->size() - Point(150, 10));
             _currentTime->setWidth(150);
             _currentTime->setHorizontalAlign(UI::TextArea::HorizontalAlign::RIGHT);
 
+            startup.step("interface");
+
+            _mixer = startup.wait("audio", audio);
+
             IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG);
 
-            srand(static_cast<unsigned>(time(0))); /// randomization
+            startup.write(logger().get());
+
+            Simulation::seed(static_cast<uint32_t>(time(0)));
+            Simulation::setAnimationSpeed(_settings->animationSpeed());
 
             atexit(SDL_Quit);
         }
@@ -132,17 +292,98 @@ namespace Falltergeist
 
         void Game::shutdown()
         {
+            if (_recording) {
+                if (_recording->write(_recordingFilename)) {
+                    logger()->info() << "[GAME] Replay of " << _recording->frames().size() << " frames written to " << _recordingFilename << std::endl;
+                } else {
+                    logger()->warning() << "[GAME] Cannot write replay to " << _recordingFilename << std::endl;
+                }
+                _recording.reset();
+            }
+            if (VM::Profiler::enabled()) {
+                _writeScriptProfile();
+            }
+            if (Trace::enabled()) {
+                _writeTrace("trace.json");
+            }
+            if (_memoryStats) {
+                _writeMemoryStats();
+                _memoryStats.reset();
+            }
+            if (Metrics::enabled()) {
+                _writeTelemetry();
+            }
             _mixer.reset();
+            // queued jobs are done before the files and states they may use go away
+            _jobs.reset();
+            // the templates pin their map files
+            Helpers::GameLocationHelper::clearTemplates();
             ResourceManager::getInstance()->shutdown();
             while (!_states.empty()) {
                 popState();
             }
+            if (_locationCache) {
+                _locationCache->clear();
+            }
             _settings.reset();
         }
 
+        void Game::_writeScriptProfile()
+        {
+            CrossPlatform::createDirectory(CrossPlatform::getConfigPath());
+            std::string filename = CrossPlatform::getConfigPath() + "/script_profile.csv";
+            if (VM::Profiler::write(filename)) {
+                logger()->info() << "[GAME] Script profile written to " << filename << std::endl;
+            } else {
+                logger()->warning() << "[GAME] Cannot write script profile to " << filename << std::endl;
+            }
+        }
+
+        void Game::_writeTrace(const std::string& name)
+        {
+            CrossPlatform::createDirectory(CrossPlatform::getConfigPath());
+            std::string filename = CrossPlatform::getConfigPath() + "/" + name;
+            if (Trace::write(filename)) {
+                logger()->info() << "[GAME] Frame trace written to " << filename << std::endl;
+            } else {
+                logger()->warning() << "[GAME] Cannot write frame trace to " << filename << std::endl;
+            }
+        }
+
+        void Game::_writeRenderStats()
+        {
+            CrossPlatform::createDirectory(CrossPlatform::getConfigPath());
+            std::string filename = CrossPlatform::getConfigPath() + "/render_stats.csv";
+            if (renderer()->stats()->write(filename)) {
+                logger()->info() << "[GAME] Render statistics written to " << filename << std::endl;
+            } else {
+                logger()->warning() << "[GAME] Cannot write render statistics to " << filename << std::endl;
+            }
+        }
+
+        void Game::_writeMemoryStats()
+        {
+            CrossPlatform::createDirectory(CrossPlatform::getConfigPath());
+            std::string filename = CrossPlatform::getConfigPath() + "/memory_stats.csv";
+            if (!MemoryStats::write(filename)) {
+                logger()->warning() << "[GAME] Cannot write memory statistics to " << filename << std::endl;
+            }
+        }
+
+        void Game::_writeTelemetry()
+        {
+            CrossPlatform::createDirectory(CrossPlatform::getConfigPath());
+            std::string filename = CrossPlatform::getConfigPath() + "/telemetry.csv";
+            if (!Metrics::write(filename)) {
+                logger()->warning() << "[GAME] Cannot write telemetry to " << filename << std::endl;
+            }
+        }
+
         void Game::pushState(State::State* state)
         {
+            FrameStats::state(stateName(state));
             _states.push_back(std::unique_ptr<State::State>(state));
+            _stateListsChanged = true;
             if (!state->initialized()) {
                 state->init();
             }
@@ -164,6 +405,7 @@ namespace Falltergeist
                 _states.back().release();
             }
             _states.pop_back();
+            _stateListsChanged = true;
             state->setActive(false);
             state->emitEvent(std::make_unique<Event::State>("deactivate"), state->deactivateHandler());
             state->emitEvent(std::make_unique<Event::State>("pop"), state->popHandler());
@@ -177,34 +419,158 @@ namespace Falltergeist
             pushState(state);
         }
 
+        void Game::leaveLocation(State::State* state)
+        {
+            // the location state may still be running the code which left it, so it's never deleted right away
+            auto location = locationState();
+            if (!location || _locationCache->capacity() == 0) {
+                setState(state);
+                return;
+            }
+            while (!_states.empty()) {
+                bool keep = _states.back().get() == location;
+                popState(!keep);
+                if (keep) {
+                    _locationCache->store(std::unique_ptr<State::Location>(location));
+                }
+            }
+            pushState(state);
+        }
+
         void Game::run()
         {
             logger()->info() << "[GAME] Starting main loop" << std::endl;
             _frame = 0;
 
-            uint32_t FPS = 60;
-            uint32_t frameDelay = 1000 / FPS;
+            using Clock = std::chrono::steady_clock;
+
+            // logic always advances in steps of the same length, so it behaves the same however fast frames are rendered
+            const auto step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / _settings->simulationRate()));
+            const float stepTime = std::chrono::duration<float, std::milli>(step).count();
+            // after a stall (loading, dragging the window) the game drops time instead of catching up in a burst
+            const auto maxElapsed = std::chrono::duration_cast<Clock::duration>(std::chrono::milliseconds(250));
+
+            // vsync paces the frames by itself
+            auto frameDelay = Clock::duration::zero();
+            if (!_settings->vsync() && _settings->frameLimit() > 0) {
+                frameDelay = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / _settings->frameLimit()));
+            }
+
+            // a spike is written once the frames before the next one are in the trace again
+            const auto spike = std::chrono::milliseconds(_settings->frameTraceSpike());
+            unsigned int framesSinceSpike = 0;
+
+            const auto memoryStatsInterval = std::chrono::seconds(_settings->memoryStatsInterval());
+            auto memoryStatsWritten = Clock::now();
+
+            const auto telemetryInterval = std::chrono::seconds(_settings->telemetryInterval());
+            auto telemetryWritten = Clock::now();
+            auto& frameTimes = Metrics::histogram("frame.ms");
 
-            uint32_t frameStart = 0;
-            uint32_t frameTime = 0;
+            auto accumulator = Clock::duration::zero();
+            auto previous = Clock::now();
             while (!_quit) {
-                frameStart = SDL_GetTicks();
+                auto frameTime = Trace::frame();
+                if (Trace::enabled() && spike.count() > 0 && ++framesSinceSpike > 300 && frameTime > spike) {
+                    _writeTrace("trace-spike.json");
+                    framesSinceSpike = 0;
+                }
+
+                auto frameStart = Clock::now();
+                // the histogram sees stalls as they are, only the simulation drops time
+                FrameStats::frame(frameStart - previous);
+                if (Metrics::enabled()) {
+                    frameTimes.record(std::chrono::duration<double, std::milli>(frameStart - previous).count());
+                    if (telemetryInterval.count() > 0 && frameStart - telemetryWritten >= telemetryInterval) {
+                        _writeTelemetry();
+                        telemetryWritten = frameStart;
+                    }
+                }
+                auto elapsed = std::min(frameStart - previous, maxElapsed);
+                previous = frameStart;
+                accumulator += elapsed;
 
                 handle();
-                think(frameTime);
+                // results of background jobs which need the GL context or SDL
+                _jobs->runMainThreadJobs();
+                unsigned int steps = 0;
+                if (_fastForward) {
+                    // as many steps as fit into the frame, the time they stand for isn't waited for
+                    auto frameEnd = frameStart + FAST_FORWARD_FRAME;
+                    do {
+                        think(stepTime);
+                        steps++;
+                        if (_fastForwardUntil != 0 && static_cast<int32_t>(Simulation::ticks() - _fastForwardUntil) >= 0) {
+                            stopFastForward();
+                        }
+                    } while (_fastForward && !_quit && Clock::now() < frameEnd);
+                    accumulator = Clock::duration::zero();
+                } else {
+                    while (accumulator >= step && !_quit) {
+                        think(stepTime);
+                        accumulator -= step;
+                        steps++;
+                    }
+                }
+                if (_recording) {
+                    _recording->endFrame(steps);
+                }
+                _interpolation = std::chrono::duration<float>(accumulator).count() / std::chrono::duration<float>(step).count();
+
+                // counts rendered frames, not logic steps
+                _fpsCounter->think(std::chrono::duration<float, std::milli>(elapsed).count());
+                if (_renderStats) {
+                    _renderStats->think(std::chrono::duration<float, std::milli>(elapsed).count());
+                }
+                if (_frameStats) {
+                    _frameStats->think(std::chrono::duration<float, std::milli>(elapsed).count());
+                }
+                if (_memoryStats) {
+                    _memoryStats->think(std::chrono::duration<float, std::milli>(elapsed).count());
+                    if (memoryStatsInterval.count() > 0 && frameStart - memoryStatsWritten >= memoryStatsInterval) {
+                        _writeMemoryStats();
+                        memoryStatsWritten = frameStart;
+                    }
+                }
                 render();
+                // vsync isn't pacing frames which aren't presented
+                if (_frameSkipped && frameDelay == Clock::duration::zero() && !_fastForward) {
+                    _waitUntil(frameStart + step);
+                }
+                if (_frame == 0) {
+                    logger()->info() << "[GAME] First frame after " << std::chrono::duration<double, std::milli>(uptime()).count() << " ms" << std::endl;
+                }
                 _statesForDelete.clear();
+                // Nothing holds unpinned resources between frames
+                ResourceManager::getInstance()->trim();
                 _frame++;
 
-                frameTime = SDL_GetTicks() - frameStart;
-                if (frameDelay > frameTime) {
-                    SDL_Delay(frameDelay - frameTime);
-                    frameTime += (frameDelay - frameTime);
+                if (frameDelay > Clock::duration::zero() && !_fastForward) {
+                    _waitUntil(frameStart + frameDelay);
                 }
             }
             logger()->info() << "[GAME] Stopping main loop" << std::endl;
         }
 
+        void Game::_waitUntil(std::chrono::steady_clock::time_point deadline)
+        {
+            using Clock = std::chrono::steady_clock;
+
+            // SDL_Delay has millisecond granularity and the scheduler may oversleep, spinning covers the rest precisely
+            auto spin = Clock::duration::zero();
+            if (_settings->frameSpinWait()) {
+                spin = std::chrono::milliseconds(1);
+            }
+
+            auto remaining = deadline - Clock::now();
+            if (remaining > spin) {
+                SDL_Delay(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(remaining - spin).count()));
+            }
+            while (spin > Clock::duration::zero() && Clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+        }
+
         void Game::quit()
         {
             _quit = true;
@@ -236,32 +602,44 @@ namespace Falltergeist
             return nullptr;
         }
 
-        void Game::setGVAR(unsigned int number, int value)
+        // the variables are loaded on the first access which misses, so a hit costs a compare and a load
+        void Game::setGVAR(unsigned int number, int value, VM::Script* script)
         {
-            _initGVARS();
             if (number >= _GVARS.size()) {
-                throw Exception("Game::setGVAR(num, value) - num out of range: " + std::to_string(number));
+                _initGVARS();
+                if (number >= _GVARS.size()) {
+                    throw Exception("Game::setGVAR(num, value) - num out of range: " + std::to_string(number));
+                }
             }
-            _GVARS.at(number) = value;
+            _GVARS.set(number, value, script);
         }
 
         int Game::GVAR(unsigned int number)
         {
-            _initGVARS();
             if (number >= _GVARS.size()) {
-                throw Exception("Game::GVAR(num) - num out of range: " + std::to_string(number));
+                _initGVARS();
+                if (number >= _GVARS.size()) {
+                    throw Exception("Game::GVAR(num) - num out of range: " + std::to_string(number));
+                }
             }
-            return _GVARS.at(number);
+            return _GVARS.get(number);
+        }
+
+        VariableStore* Game::GVARS()
+        {
+            _initGVARS();
+            return &_GVARS;
         }
 
         void Game::_initGVARS()
         {
-            if (!_GVARS.empty()) {
+            if (_GVARS.size()) {
                 return;
             }
             auto gam = ResourceManager::getInstance()->gamFileType("data/vault13.gam");
-            for (auto gvar : *gam->GVARS()) {
-                _GVARS.push_back(gvar.second);
+            _GVARS.assign(gam->GVARValues());
+            if (_settings && _settings->traceVariables()) {
+                _GVARS.setTrace("GVAR");
             }
         }
 
@@ -270,28 +648,33 @@ namespace Falltergeist
             return (_states.rbegin() + offset)->get();
         }
 
-        std::vector<State::State*> Game::_getVisibleStates()
+        void Game::invalidateStateLists()
         {
-            std::vector<State::State*> subset;
-            if (_states.empty()) {
-                return subset;
-            }
-            // we must render all states from last fullscreen state to the top of stack
-            auto it = _states.end();
-            do {
-                --it;
-            } while (it != _states.begin() && !(*it)->fullscreen());
-
-            for (; it != _states.end(); ++it) {
-                subset.push_back((*it).get());
-            }
-            return subset;
+            _stateListsChanged = true;
         }
 
-        std::vector<State::State*> Game::_getActiveStates()
+        void Game::_updateStateLists()
         {
+            if (!_stateListsChanged) {
+                return;
+            }
+            _stateListsChanged = false;
+
+            _visibleStates.clear();
+            if (!_states.empty()) {
+                // we must render all states from last fullscreen state to the top of stack
+                auto it = _states.end();
+                do {
+                    --it;
+                } while (it != _states.begin() && !(*it)->fullscreen());
+
+                for (; it != _states.end(); ++it) {
+                    _visibleStates.push_back((*it).get());
+                }
+            }
+
             // we must handle all states from top to bottom of stack
-            std::vector<State::State*> subset;
+            _activeStates.clear();
 
             auto it = _states.rbegin();
             // active states
@@ -301,7 +684,7 @@ namespace Falltergeist
                     state->emitEvent(std::make_unique<Event::State>("activate"), state->activateHandler());
                     state->setActive(true);
                 }
-                subset.push_back(state);
+                _activeStates.push_back(state);
                 if (state->modal() || state->fullscreen()) {
                     ++it;
                     break;
@@ -315,7 +698,6 @@ namespace Falltergeist
                     state->setActive(false);
                 }
             }
-            return subset;
         }
 
         std::shared_ptr<Graphics::Renderer> Game::renderer() const
@@ -338,7 +720,7 @@ namespace Falltergeist
                 case SDL_MOUSEBUTTONDOWN:
                 case SDL_MOUSEBUTTONUP:
                 {
-                    SDL_Keymod mods = SDL_GetModState();
+                    SDL_Keymod mods = _replaying ? _replayedModifiers : SDL_GetModState();
                     auto mouseEvent = std::make_unique<Mouse>((sdlEvent.type == SDL_MOUSEBUTTONDOWN) ? Mouse::Type::BUTTON_DOWN : Mouse::Type::BUTTON_UP);
                     mouseEvent->setPosition({sdlEvent.button.x, sdlEvent.button.y});
                     switch (sdlEvent.button.button)
@@ -368,6 +750,7 @@ namespace Falltergeist
                 {
                     auto mouseEvent = std::make_unique<Event::Mouse>(Mouse::Type::MOVE);
                     mouseEvent->setPosition({sdlEvent.motion.x, sdlEvent.motion.y});
+                    mouseEvent->setOffset({sdlEvent.motion.xrel, sdlEvent.motion.yrel});
 
                     // TODO move position update to window class polling
                     //((Graphics::SdlWindow*)_window.get())->_mousePosition = {sdlEvent.motion.x, sdlEvent.motion.y};
@@ -391,10 +774,27 @@ namespace Falltergeist
                     keyboardEvent->setControlPressed(sdlEvent.key.keysym.mod & KMOD_CTRL);;
 
                     // TODO: maybe we should make Game an EventTarget too?
-                    if (keyboardEvent->keyCode() == SDLK_F12)
+                    // shift toggles capturing every frame
+                    if (keyboardEvent->keyCode() == SDLK_F12 && keyboardEvent->shiftPressed())
+                    {
+                        renderer()->setCapturing(!renderer()->capturing());
+                    }
+                    else if (keyboardEvent->keyCode() == SDLK_F12)
                     {
                         renderer()->screenshot();
                     }
+                    if (keyboardEvent->keyCode() == SDLK_F11 && VM::Profiler::enabled())
+                    {
+                        _writeScriptProfile();
+                    }
+                    if (keyboardEvent->keyCode() == SDLK_F9 && Trace::enabled())
+                    {
+                        _writeTrace("trace.json");
+                    }
+                    if (keyboardEvent->keyCode() == SDLK_F8 && _renderStats)
+                    {
+                        _writeRenderStats();
+                    }
                     return std::move(keyboardEvent);
                 }
             }
@@ -403,6 +803,7 @@ namespace Falltergeist
 
         void Game::handle()
         {
+            Trace::Scope scope("Game::handle");
             if (_renderer->fading()) {
                 return;
             }
@@ -410,30 +811,122 @@ namespace Falltergeist
             // TODO implementc
             //_window->pollEvents();
 
+            // a fast mouse reports several moves per frame, the states only get the last position of consecutive ones
+            SDL_Event motion;
+            bool motionPending = false;
             while (SDL_PollEvent(&_event))
             {
-                if (_event.type == SDL_QUIT) {
-                    _quit = true;
-                } else {
-                    auto event = _createEventFromSDL(_event);
-                    if (event) {
-                        for (auto state : _getActiveStates()) {
-                            state->handle(event.get());
-                        }
+                _mapFromWindow(_event);
+                if (_event.type == SDL_WINDOWEVENT) {
+                    _redraw = true;
+                }
+                if (_event.type == SDL_MOUSEMOTION) {
+                    if (motionPending) {
+                        _event.motion.xrel += motion.motion.xrel;
+                        _event.motion.yrel += motion.motion.yrel;
                     }
+                    motion = _event;
+                    motionPending = true;
+                    continue;
                 }
-                // process events generate during handle()
-                _eventDispatcher->processScheduledEvents();
+                if (motionPending) {
+                    motionPending = false;
+                    _handleEvent(motion);
+                }
+                _handleEvent(_event);
+            }
+            if (motionPending) {
+                _handleEvent(motion);
             }
         }
 
-        void Game::think(const float &deltaTime)
+        void Game::_mapFromWindow(SDL_Event& sdlEvent) const
         {
-            _fpsCounter->think(deltaTime);
+            if (!_renderer->composing()) {
+                return;
+            }
+            switch (sdlEvent.type) {
+                case SDL_MOUSEMOTION: {
+                    auto position = _renderer->fromWindow({sdlEvent.motion.x, sdlEvent.motion.y});
+                    auto previous = _renderer->fromWindow({sdlEvent.motion.x - sdlEvent.motion.xrel, sdlEvent.motion.y - sdlEvent.motion.yrel});
+                    sdlEvent.motion.x = position.x();
+                    sdlEvent.motion.y = position.y();
+                    sdlEvent.motion.xrel = position.x() - previous.x();
+                    sdlEvent.motion.yrel = position.y() - previous.y();
+                    break;
+                }
+                case SDL_MOUSEBUTTONDOWN:
+                case SDL_MOUSEBUTTONUP: {
+                    auto position = _renderer->fromWindow({sdlEvent.button.x, sdlEvent.button.y});
+                    sdlEvent.button.x = position.x();
+                    sdlEvent.button.y = position.y();
+                    break;
+                }
+            }
+        }
+
+        void Game::record(const std::string& filename)
+        {
+            _recording = std::make_unique<Replay>();
+            _recording->start(Simulation::seedValue(), _settings->simulationRate());
+            _recordingFilename = filename;
+        }
+
+        void Game::startReplay(const Replay& replay)
+        {
+            Simulation::seed(replay.seed());
+            _sdlMouse->setSimulated(true);
+            _mouse->setHardwareCursor(false);
+            _replaying = true;
+        }
+
+        void Game::handleReplayed(const SDL_Event& sdlEvent)
+        {
+            switch (sdlEvent.type) {
+                case SDL_MOUSEMOTION:
+                    _mouse->setPosition({sdlEvent.motion.x, sdlEvent.motion.y});
+                    break;
+                case SDL_MOUSEBUTTONDOWN:
+                case SDL_MOUSEBUTTONUP:
+                    _mouse->setPosition({sdlEvent.button.x, sdlEvent.button.y});
+                    break;
+                case SDL_KEYDOWN:
+                case SDL_KEYUP:
+                    _replayedModifiers = static_cast<SDL_Keymod>(sdlEvent.key.keysym.mod);
+                    break;
+            }
+            _handleEvent(sdlEvent);
+        }
+
+        void Game::_handleEvent(const SDL_Event& sdlEvent)
+        {
+            if (_recording) {
+                _recording->event(sdlEvent);
+            }
+            if (sdlEvent.type == SDL_QUIT) {
+                _quit = true;
+            } else {
+                auto event = _createEventFromSDL(sdlEvent);
+                if (event) {
+                    _updateStateLists();
+                    // states pushed or popped meanwhile are picked up by the next event, popped ones live until the frame ends
+                    for (auto state : _activeStates) {
+                        state->handle(event.get());
+                    }
+                }
+            }
+            // process events generate during handle()
+            _eventDispatcher->processScheduledEvents();
+        }
 
+        void Game::think(const float &deltaTime)
+        {
+            Trace::Scope scope("Game::think");
+            Simulation::advance(deltaTime);
             _mouse->think(deltaTime);
 
             _animatedPalette->think(deltaTime);
+            _renderer->updatePalette(*_animatedPalette);
 
             *_mousePosition = "";
             *_mousePosition << mouse()->position().x() << " : " << mouse()->position().y();
@@ -449,7 +942,8 @@ namespace Falltergeist
                 return;
             }
 
-            for (auto state : _getActiveStates()) {
+            _updateStateLists();
+            for (auto state : _activeStates) {
                 state->think(deltaTime);
             }
             // process custom events
@@ -458,15 +952,30 @@ namespace Falltergeist
 
         void Game::render()
         {
-            renderer()->beginFrame();
+            Trace::Scope scope("Game::render");
+            _updateStateLists();
+            _frameSkipped = _frameUnchanged();
+            if (_frameSkipped) {
+                return;
+            }
 
-            for (auto state : _getVisibleStates()) {
+            renderer()->beginFrame();
+            for (auto state : _visibleStates) {
                 state->render();
             }
 
             if (settings()->displayFps()) {
                 _fpsCounter->render();
             }
+            if (_renderStats) {
+                _renderStats->render();
+            }
+            if (_memoryStats) {
+                _memoryStats->render();
+            }
+            if (_frameStats) {
+                _frameStats->render();
+            }
 
             _falltergeistVersion->render();
 
@@ -480,6 +989,61 @@ namespace Falltergeist
                 _mouse->render();
             }
             renderer()->endFrame();
+
+            if (_settings->skipIdleFrames()) {
+                _presentedStates = _visibleStates;
+                _presentedMousePosition = _mouse->position();
+                _presentedCursor = static_cast<unsigned int>(_mouse->state());
+                _presentedLayout = UI::Base::layoutGeneration();
+                _presentedOverlay = _overlayText();
+                _redraw = false;
+            }
+        }
+
+        bool Game::_frameUnchanged()
+        {
+            // statistics counters describe the frames themselves
+            if (!_settings->skipIdleFrames() || _redraw || _renderStats || _memoryStats || _frameStats) {
+                return false;
+            }
+            if (_renderer->fading() || _renderer->fadeColor().w > 0.0f) {
+                return false;
+            }
+            if (_visibleStates.empty() || _visibleStates != _presentedStates) {
+                return false;
+            }
+            // only cached layers are known to show the same as before, they are invalidated by input and by states above
+            for (auto state : _visibleStates) {
+                if (!state->cacheCurrent()) {
+                    return false;
+                }
+            }
+            // the other cursors are animated, the system one moves without a frame
+            if (!_mouse->systemCursor()) {
+                if (_mouse->state() != Input::Mouse::Cursor::BIG_ARROW && _mouse->state() != Input::Mouse::Cursor::NONE) {
+                    return false;
+                }
+                if (static_cast<unsigned int>(_mouse->state()) != _presentedCursor || _mouse->position() != _presentedMousePosition) {
+                    return false;
+                }
+            }
+            // something got moved or resized
+            if (UI::Base::layoutGeneration() != _presentedLayout) {
+                return false;
+            }
+            return _overlayText() == _presentedOverlay;
+        }
+
+        std::string Game::_overlayText() const
+        {
+            std::string text = _currentTime->text();
+            if (_settings->displayFps()) {
+                text += "\n" + _fpsCounter->text();
+            }
+            if (_settings->displayMousePosition()) {
+                text += "\n" + _mousePosition->text();
+            }
+            return text;
         }
 
         Graphics::AnimatedPalette* Game::animatedPalette()
@@ -487,6 +1051,24 @@ namespace Falltergeist
             return _animatedPalette.get();
         }
 
+        SaveFile* Game::saveFile()
+        {
+            return _saveFile.get();
+        }
+
+        State::LocationCache* Game::locationCache()
+        {
+            return _locationCache.get();
+        }
+
+        WorldmapTerrain* Game::worldmapTerrain()
+        {
+            if (!_worldmapTerrain) {
+                _worldmapTerrain = std::make_unique<WorldmapTerrain>(ResourceManager::getInstance()->worldmapTxt());
+            }
+            return _worldmapTerrain.get();
+        }
+
         std::shared_ptr<Time> Game::gameTime() const
         {
             return _gameTime;
@@ -502,6 +1084,11 @@ namespace Falltergeist
             return _eventDispatcher.get();
         }
 
+        Base::JobSystem* Game::jobs()
+        {
+            return _jobs.get();
+        }
+
         std::shared_ptr<ILogger> Game::logger() const
         {
             return _logger;
@@ -512,6 +1099,34 @@ namespace Falltergeist
             return _frame;
         }
 
+        float Game::interpolation() const
+        {
+            return _interpolation;
+        }
+
+        void Game::fastForward(unsigned int milliseconds)
+        {
+            _fastForward = true;
+            // 0 is taken by "until stopped", a wrapped around end is a millisecond later
+            _fastForwardUntil = milliseconds == 0 ? 0 : std::max<uint32_t>(1, Simulation::ticks() + milliseconds);
+        }
+
+        void Game::stopFastForward()
+        {
+            _fastForward = false;
+            _fastForwardUntil = 0;
+        }
+
+        bool Game::fastForwarding() const
+        {
+            return _fastForward;
+        }
+
+        std::chrono::steady_clock::duration Game::uptime() const
+        {
+            return std::chrono::steady_clock::now() - _initStarted;
+        }
+
         void Game::setUIResourceManager(std::shared_ptr<UI::IResourceManager> uiResourceManager)
         {
             _uiResourceManager = uiResourceManager;
@@ -535,7 +1150,14 @@ namespace Falltergeist
                 x,
                 y,
                 _settings->fullscreen(),
-                _settings->alwaysOnTop()
+                _settings->alwaysOnTop(),
+                _settings->vsync(),
+                _settings->gles(),
+                _settings->scale(),
+                _settings->scaleFilter(),
+                static_cast<float>(_settings->brightness()),
+                static_cast<size_t>(_settings->textureBudget()) * 1024 * 1024,
+                static_cast<size_t>(_settings->textureUploadBudget()) * 1024
             );
         }
     }
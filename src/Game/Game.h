@@ -1,10 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
 #include <SDL.h>
 #include "../Game/Time.h"
+#include "../Game/VariableStore.h"
+#include "../Graphics/Point.h"
 #include "../Graphics/IRendererConfig.h"
 #include "../Graphics/IWindow.h"
 #include "../ILogger.h"
@@ -17,6 +20,10 @@ namespace Falltergeist
     {
         class Mixer;
     }
+    namespace Base
+    {
+        class JobSystem;
+    }
     namespace Event
     {
         class Event;
@@ -36,14 +43,22 @@ namespace Falltergeist
     {
         class Script;
     }
+    namespace VM
+    {
+        class Script;
+    }
     namespace State
     {
         class Location;
+        class LocationCache;
         class State;
     }
     namespace UI
     {
         class FpsCounter;
+        class FrameStatsCounter;
+        class MemoryStatsCounter;
+        class RenderStatsCounter;
         class TextArea;
     }
 
@@ -54,6 +69,9 @@ namespace Falltergeist
     namespace Game
     {
         class DudeObject;
+        class Replay;
+        class SaveFile;
+        class WorldmapTerrain;
 
         class Game
         {
@@ -74,8 +92,14 @@ namespace Falltergeist
 
                 void setState(State::State* state);
 
+                // Like setState, but the location state is kept in the location cache rather than deleted
+                void leaveLocation(State::State* state);
+
                 void popState(bool doDelete = true);
 
+                // Called when a state of the stack becomes fullscreen or modal, or stops being it
+                void invalidateStateLists();
+
                 void run();
 
                 void quit();
@@ -86,6 +110,15 @@ namespace Falltergeist
                  * @brief Handle all incoming events from OS (mouse, keyboard, etc.).
                  */
                 void handle();
+
+                // Records the inputs of the session from now on, the replay is written to the file on shutdown
+                void record(const std::string& filename);
+
+                // Seeds the random numbers like the recorded session and moves the mouse by the replayed events only
+                void startReplay(const Replay& replay);
+
+                // Handles a recorded event in place of the ones of the OS
+                void handleReplayed(const SDL_Event& sdlEvent);
                 /**
                  * @brief Process real-time logic.
                  */
@@ -111,22 +144,53 @@ namespace Falltergeist
 
                 Event::Dispatcher* eventDispatcher();
 
+                // Worker threads for parallel work of the engine, nullptr before init() and after shutdown()
+                Base::JobSystem* jobs();
+
                 std::shared_ptr<ILogger> logger() const;
 
-                void setGVAR(unsigned int number, int value);
+                // The script is named when variables are traced
+                void setGVAR(unsigned int number, int value, VM::Script* script = nullptr);
 
                 int GVAR(unsigned int number);
 
+                // All global variables, for saving and loading the game
+                VariableStore* GVARS();
+
                 std::shared_ptr<Settings> settings() const;
 
                 Graphics::AnimatedPalette* animatedPalette();
 
+                // Changes of the visited maps and the state stored by the last save or load
+                SaveFile* saveFile();
+
+                // Maps the player left last, entered again through exit grids
+                State::LocationCache* locationCache();
+
+                // Walkability and terrain of the world map, decoded on first use
+                WorldmapTerrain* worldmapTerrain();
+
                 unsigned int frame() const;
 
+                // Part of the next logic step that has already elapsed when the frame is rendered, in [0, 1)
+                float interpolation() const;
+
+                // Runs the logic as fast as it goes for the milliseconds of game time, 0 until stopFastForward().
+                // Frames are presented a few times a second only and animations nobody follows frame by frame
+                // jump to their end, meant for waiting and turns of other critters
+                void fastForward(unsigned int milliseconds = 0);
+
+                void stopFastForward();
+
+                bool fastForwarding() const;
+
+                // Time since init() was called, startup milestones are logged against it
+                std::chrono::steady_clock::duration uptime() const;
+
                 void setUIResourceManager(std::shared_ptr<UI::IResourceManager> uiResourceManager);
 
             protected:
-                std::vector<int> _GVARS;
+                VariableStore _GVARS;
 
                 std::vector<std::unique_ptr<State::State>> _states;
 
@@ -136,20 +200,53 @@ namespace Falltergeist
 
                 unsigned int _frame = 0;
 
+                float _interpolation = 0.0f;
+
+                bool _fastForward = false;
+                // Simulation::ticks() the fast forward ends at, 0 for none
+                uint32_t _fastForwardUntil = 0;
+
                 std::shared_ptr<Graphics::Renderer> _renderer;
 
                 std::shared_ptr<Audio::Mixer> _mixer;
 
                 std::shared_ptr<Input::Mouse> _mouse;
 
+                std::shared_ptr<Input::SdlMouse> _sdlMouse;
+
+                // nullptr unless the session is recorded
+                std::unique_ptr<Replay> _recording;
+                std::string _recordingFilename;
+
+                // replayed events come without a keyboard, the modifiers of the last key event stand in for SDL_GetModState()
+                bool _replaying = false;
+                SDL_Keymod _replayedModifiers = KMOD_NONE;
+
                 std::shared_ptr<Settings> _settings;
 
                 std::unique_ptr<Graphics::AnimatedPalette> _animatedPalette;
 
+                std::unique_ptr<SaveFile> _saveFile;
+
+                std::unique_ptr<State::LocationCache> _locationCache;
+
+                std::unique_ptr<WorldmapTerrain> _worldmapTerrain;
+
                 std::unique_ptr<Event::Dispatcher> _eventDispatcher;
 
+                std::unique_ptr<Base::JobSystem> _jobs;
+
                 std::unique_ptr<UI::FpsCounter> _fpsCounter;
 
+                // nullptr unless render_stats is set
+                std::unique_ptr<UI::RenderStatsCounter> _renderStats;
+
+                // nullptr unless memory_stats is set
+                std::unique_ptr<UI::MemoryStatsCounter> _memoryStats;
+
+                // nullptr unless frame_stats is set
+                std::unique_ptr<UI::FrameStatsCounter> _frameStats;
+
                 std::unique_ptr<UI::TextArea> _mousePosition, _currentTime, _falltergeistVersion;
 
                 std::shared_ptr<DudeObject> _player;
@@ -158,11 +255,33 @@ namespace Falltergeist
 
                 bool _initialized = false;
 
+                std::chrono::steady_clock::time_point _initStarted;
+
                 SDL_Event _event;
 
-                std::vector<State::State*> _getVisibleStates();
+                // from the last fullscreen state to the top of the stack
+                std::vector<State::State*> _visibleStates;
+
+                // from the top of the stack down to the first modal or fullscreen state
+                std::vector<State::State*> _activeStates;
 
-                std::vector<State::State*> _getActiveStates();
+                bool _stateListsChanged = true;
+
+                // Rebuilds the lists after the stack changed and (de)activates states, never while iterating them
+                void _updateStateLists();
+
+                // What the last presented frame showed, so an idle frame can be skipped instead of composed again
+                std::vector<State::State*> _presentedStates;
+                Graphics::Point _presentedMousePosition;
+                unsigned int _presentedCursor = 0;
+                unsigned int _presentedLayout = 0;
+                std::string _presentedOverlay;
+                // set by window events, the presented frame may have been lost
+                bool _redraw = true;
+                bool _frameSkipped = false;
+
+                bool _frameUnchanged();
+                std::string _overlayText() const;
 
             private:
                 static Game* _instance;
@@ -173,8 +292,32 @@ namespace Falltergeist
 
                 void _initGVARS();
 
+                // Dumps the script profiler data next to the config
+                void _writeScriptProfile();
+
+                // Dumps the frame trace next to the config
+                void _writeTrace(const std::string& name);
+
+                // Dumps the render statistics of the last frames next to the config
+                void _writeRenderStats();
+
+                // Appends the memory usage to memory_stats.csv next to the config
+                void _writeMemoryStats();
+
+                // Appends the metrics to telemetry.csv next to the config
+                void _writeTelemetry();
+
+                // Sleeps until the end of the frame, spinning through the last millisecond if frame_spin_wait is set
+                void _waitUntil(std::chrono::steady_clock::time_point deadline);
+
                 std::unique_ptr<Event::Event> _createEventFromSDL(const SDL_Event& sdlEvent);
 
+                // Passes the event to the active states and processes the events they scheduled
+                void _handleEvent(const SDL_Event& sdlEvent);
+
+                // Mouse positions of the window are turned into positions of the game resolution while it's scaled
+                void _mapFromWindow(SDL_Event& sdlEvent) const;
+
                 std::unique_ptr<Graphics::IRendererConfig> createRendererConfigFromSettings();
 
                 Game();
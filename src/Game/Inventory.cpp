@@ -0,0 +1,78 @@
+#include "../Game/Inventory.h"
+#include "../Game/ItemObject.h"
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        Inventory::const_iterator Inventory::begin() const
+        {
+            return _items.begin();
+        }
+
+        Inventory::const_iterator Inventory::end() const
+        {
+            return _items.end();
+        }
+
+        size_t Inventory::size() const
+        {
+            return _items.size();
+        }
+
+        bool Inventory::empty() const
+        {
+            return _items.empty();
+        }
+
+        ItemObject* Inventory::at(size_t index) const
+        {
+            return _items.at(index);
+        }
+
+        void Inventory::push_back(ItemObject* item)
+        {
+            _items.push_back(item);
+            _weight += item->weight();
+            _price += item->price() * item->amount();
+            _amounts[item->PID()] += item->amount();
+        }
+
+        Inventory::const_iterator Inventory::erase(const_iterator position)
+        {
+            auto item = *position;
+            _weight -= item->weight();
+            _price -= item->price() * item->amount();
+            auto it = _amounts.find(item->PID());
+            it->second -= item->amount();
+            if (it->second == 0) {
+                _amounts.erase(it);
+            }
+            return _items.erase(position);
+        }
+
+        void Inventory::clear()
+        {
+            _items.clear();
+            _weight = 0;
+            _price = 0;
+            _amounts.clear();
+        }
+
+        unsigned int Inventory::weight() const
+        {
+            return _weight;
+        }
+
+        unsigned int Inventory::price() const
+        {
+            return _price;
+        }
+
+        unsigned int Inventory::amount(int PID) const
+        {
+            auto it = _amounts.find(PID);
+            return it != _amounts.end() ? it->second : 0;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        class ItemObject;
+
+        /**
+         * Items held by a critter, a container or a side of a barter, with their totals kept up to date as items
+         * are added and removed, so inventory screens and scripts don't walk the items for them.
+         * Amount, weight and price of an item are set before it's added.
+         */
+        class Inventory final
+        {
+            public:
+                using const_iterator = std::vector<ItemObject*>::const_iterator;
+
+                const_iterator begin() const;
+                const_iterator end() const;
+
+                size_t size() const;
+                bool empty() const;
+                ItemObject* at(size_t index) const;
+
+                void push_back(ItemObject* item);
+                const_iterator erase(const_iterator position);
+                void clear();
+
+                // sum of the item weights
+                unsigned int weight() const;
+                // sum of the item prices times their amounts
+                unsigned int price() const;
+                // amount of items with the PID
+                unsigned int amount(int PID) const;
+
+            private:
+                std::vector<ItemObject*> _items;
+
+                unsigned int _weight = 0;
+                unsigned int _price = 0;
+                std::unordered_map<int, unsigned int> _amounts;
+        };
+    }
+}
@@ -24,7 +24,9 @@ namespace Falltergeist
         void ItemObject::setAmount(unsigned int value)
         {
             _amount = value;
-            _inventoryAmountUi->setText("x" + std::to_string(value));
+            if (_inventoryAmountUi) {
+                _inventoryAmountUi->setText("x" + std::to_string(value));
+            }
         }
 
         unsigned int ItemObject::weight() const
@@ -59,11 +61,13 @@ namespace Falltergeist
 
         UI::Base* ItemObject::inventoryDragUi() const
         {
+            _generateInventoryUi();
             return _inventoryDragUi.get();
         }
 
         std::unique_ptr<UI::TextArea>& ItemObject::inventoryAmountUi()
         {
+            _generateInventoryUi();
             return _inventoryAmountUi;
         }
 
@@ -79,19 +83,30 @@ namespace Falltergeist
 
         UI::Base* ItemObject::inventoryUi() const
         {
+            _generateInventoryUi();
             return _inventoryUi.get();
         }
 
         UI::Base* ItemObject::inventorySlotUi() const
         {
+            _generateInventoryUi();
             return _inventorySlotUi.get();
         }
 
-        void ItemObject::_generateUi()
+        void ItemObject::_invalidateUi()
         {
-            Object::_generateUi();
+            Object::_invalidateUi();
+
+            // the inventory FID could have changed as well
+            _inventoryDragUi.reset();
+            _inventoryUi.reset();
+            _inventorySlotUi.reset();
+            _inventoryAmountUi.reset();
+        }
 
-            if (inventoryFID() == -1) {
+        void ItemObject::_generateInventoryUi() const
+        {
+            if (_inventoryUi || inventoryFID() == -1) {
                 return;
             }
 
@@ -101,7 +116,7 @@ namespace Falltergeist
             _inventoryDragUi = uiFactory.buildByFID(inventoryFID());
             _inventoryUi = uiFactory.buildByFID(inventoryFID());
             _inventorySlotUi = uiFactory.buildByFID(inventoryFID());
-            _inventoryAmountUi = std::make_unique<UI::TextArea>("x" + std::to_string(_amount), inventorySlotUi()->position());
+            _inventoryAmountUi = std::make_unique<UI::TextArea>("x" + std::to_string(_amount), _inventorySlotUi->position());
             _inventoryAmountUi->setColor({ 255, 255, 255, 0 });
         }
 
@@ -61,9 +61,11 @@ namespace Falltergeist
                 unsigned int _price = 0;
                 unsigned int _volume = 0;
                 int _inventoryFID = -1;
-                std::unique_ptr<UI::TextArea> _inventoryAmountUi;
-                std::unique_ptr<UI::Base> _inventoryUi, _inventorySlotUi, _inventoryDragUi;
-                void _generateUi() override;
+                // built on first use, most items are never shown in an inventory screen
+                mutable std::unique_ptr<UI::TextArea> _inventoryAmountUi;
+                mutable std::unique_ptr<UI::Base> _inventoryUi, _inventorySlotUi, _inventoryDragUi;
+                void _invalidateUi() override;
+                void _generateInventoryUi() const;
         };
     }
 }
@@ -7,7 +7,6 @@
 #include "../State/Location.h"
 #include "../PathFinding/Hexagon.h"
 #include "../PathFinding/HexagonGrid.h"
-#include "../Helpers/GameLocationHelper.h"
 #include "../UI/ResourceManager.h"
 #include "../Format/Txt/MapsFile.h"
 #include "../ResourceManager.h"
@@ -30,41 +29,24 @@ namespace Falltergeist
             }
 
             auto game = Game::getInstance();
-            auto logger = std::make_shared<Logger>();
 
             Logger::info("LADDER") << "mapId=" << this->exitMapNumber() << " position=" << this->exitHexagonNumber() << " elevation=" << this->exitElevationNumber()  << std::endl;
             Logger::info("LADDER") << "current map: " << game->locationState()->location()->name() << std::endl;
 
             game->player()->stopMovement();
+            game->locationState()->storeMapChanges();
 
             if (this->exitMapNumber() != -1) {
                 std::string mapName;
 
                 if (this->exitMapNumber() > 0) {
                     auto mapsFile = ResourceManager::getInstance()->mapsTxt();
-                    mapName = mapsFile->maps().at(this->exitMapNumber()).name;
+                    mapName = mapsFile->map(this->exitMapNumber()).name;
                 } else {
                     mapName = game->locationState()->location()->name();
                 }
 
-                auto locationState = new State::Location(
-                    game->player(),
-                    game->mouse(),
-                    game->settings(),
-                    game->renderer(),
-                    game->mixer(),
-                    game->gameTime(),
-                    std::make_shared<UI::ResourceManager>(),
-                    logger
-                );
-                locationState->setElevation(this->exitElevationNumber());
-
-                Helpers::GameLocationHelper gameLocationHelper(logger);
-                auto location = gameLocationHelper.getByName(mapName);
-                location->setDefaultPosition(this->exitHexagonNumber());
-                location->setDefaultElevationIndex(this->exitElevationNumber());
-                locationState->setLocation(location);
-                game->setState(locationState);
+                game->locationState()->travel(mapName, this->exitElevationNumber(), this->exitHexagonNumber());
 
             } else {
                 auto resourceManager = std::make_shared<UI::ResourceManager>();
@@ -1,11 +1,12 @@
-﻿#include <cmath>
-#include "../Game/Location.h"
-#include "../Format/Gam/File.h"
+﻿#include "../Game/Location.h"
 #include "../Format/Map/File.h"
+#include "../Game/Game.h"
 #include "../Game/LocationElevation.h"
+#include "../Game/LocationTemplate.h"
 #include "../Game/SpatialObject.h"
 #include "../Helpers/GameObjectHelper.h"
 #include "../ResourceManager.h"
+#include "../Settings.h"
 #include "../UI/Tile.h"
 #include "../UI/TileMap.h"
 #include "../VM/Script.h"
@@ -26,78 +27,69 @@ namespace Falltergeist
         {
         }
 
-        void Location::loadFromMapFile(Falltergeist::Format::Map::File* mapFile)
+        void Location::loadFromTemplate(const LocationTemplate& locationTemplate)
         {
-            setName(mapFile->name().substr(0, mapFile->name().find(".")));
-            setDefaultElevationIndex(mapFile->defaultElevation());
-            setDefaultPosition(mapFile->defaultPosition());
-            setDefaultOrientation(mapFile->defaultOrientation());
+            setName(locationTemplate.name());
+            setDefaultElevationIndex(locationTemplate.defaultElevationIndex());
+            setDefaultPosition(locationTemplate.defaultPosition());
+            setDefaultOrientation(locationTemplate.defaultOrientation());
 
             // Initialize MAP vars
-            if (!mapFile->MVARS().empty()) {
-                auto gam = ResourceManager::getInstance()->gamFileType("maps/" + name() + ".gam");
-                if (gam) {
-                    for (auto mvar : *gam->MVARS()) {
-                        _MVARS.push_back(mvar.second);
-                    }
-                }
+            if (!locationTemplate.MVARS().empty()) {
+                _MVARS.assign(locationTemplate.MVARS());
+            }
+            if (Game::getInstance()->settings()->traceVariables()) {
+                _MVARS.setTrace("MVAR");
             }
 
-            if (mapFile->scriptId() > 0) {
+            if (locationTemplate.scriptIndex() >= 0) {
                 _script = std::make_shared<VM::Script>(
-                    ResourceManager::getInstance()->intFileType((unsigned)mapFile->scriptId() - 1),
+                    ResourceManager::getInstance()->intFileType(static_cast<unsigned>(locationTemplate.scriptIndex())),
                     nullptr
                 );
             }
 
             GameObjectHelper gameObjectHelper(logger);
 
-            for (auto &mapElevation : mapFile->elevations()) {
+            auto& mapElevations = locationTemplate.mapFile()->elevations();
+            for (size_t i = 0; i != mapElevations.size(); ++i) {
                 auto elevation = std::make_shared<LocationElevation>(logger);
 
                 // load objects
-                for (auto &mapObject : mapElevation.objects()) {
+                int mapIndex = 0;
+                for (auto &mapObject : mapElevations[i].objects()) {
 
                     auto object = gameObjectHelper.createFromMapObject(mapObject);
                     if (!object) {
                         // TODO: add some logging
+                        mapIndex++;
                         continue;
                     }
 
+                    object->setMapIndex(mapIndex++);
                     elevation->objects()->push_back(object);
                 }
 
                 // load tiles
-                for (unsigned int i = 0; i != 100 * 100; ++i) {
-                    auto tileX = static_cast<unsigned>(ceil(((double) i) / 100));
-                    unsigned int tileY = i % 100;
-                    unsigned int x = (100 - tileY - 1) * 48 + 32 * (tileX - 1);
-                    unsigned int y = tileX * 24 + (tileY - 1) * 12 + 1;
-
-                    unsigned int tileNum = mapElevation.floorTiles().at(i);
-                    if (tileNum > 1) {
-                        elevation->floor()->tiles()[i] = std::make_unique<UI::Tile>(tileNum, Point(x, y));
-                    }
-
-                    tileNum = mapElevation.roofTiles().at(i);
-                    if (tileNum > 1) {
-                        elevation->roof()->tiles()[i] = std::make_unique<UI::Tile>(tileNum, Point(x, y - 96));
-                    }
+                auto& templateElevation = locationTemplate.elevations().at(i);
+                for (auto& tile : templateElevation.floorTiles) {
+                    elevation->floor()->tiles()[tile.index] = std::make_unique<UI::Tile>(tile.number, tile.position);
+                }
+                for (auto& tile : templateElevation.roofTiles) {
+                    elevation->roof()->tiles()[tile.index] = std::make_unique<UI::Tile>(tile.number, tile.position);
                 }
 
                 elevations()->push_back(elevation);
             }
 
             // load spatial objects(scripts)
-            for (auto &script: mapFile->scripts()) {
-                if (script.type() == Format::Map::Script::Type::SPATIAL) {
-                    auto object = gameObjectHelper.createFromMapSpatialScript(script);
-                    elevations()->at(object->elevation())->objects()->push_back(object);
-                }
+            for (auto script : locationTemplate.spatialScripts()) {
+                auto object = gameObjectHelper.createFromMapSpatialScript(*script);
+                elevations()->at(object->elevation())->objects()->push_back(object);
             }
         }
 
-        std::vector<int32_t>* Location::MVARS()
+        VariableStore* Location::MVARS()
         {
             return &_MVARS;
         }
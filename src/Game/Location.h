@@ -4,17 +4,11 @@
 #include <map>
 #include <string>
 #include <vector>
+#include "../Game/VariableStore.h"
 #include "../ILogger.h"
 
 namespace Falltergeist
 {
-    namespace Format
-    {
-        namespace Map
-        {
-            class File;
-        }
-    }
     namespace VM
     {
         class Script;
@@ -22,6 +16,7 @@ namespace Falltergeist
     namespace Game
     {
         class LocationElevation;
+        class LocationTemplate;
 
         /**
          * @brief Location class
@@ -36,9 +31,10 @@ namespace Falltergeist
                 Location(std::shared_ptr<ILogger> logger);
                 ~Location();
 
-                void loadFromMapFile(Falltergeist::Format::Map::File *file);
+                // Creates the objects and tiles of a new visit
+                void loadFromTemplate(const LocationTemplate& locationTemplate);
 
-                std::vector<int32_t>* MVARS();
+                VariableStore* MVARS();
 
                 std::string name() const;
                 void setName(const std::string& value);
@@ -150,7 +146,7 @@ namespace Falltergeist
                 /**
                  * @brief Location variables. Used in scripting
                  */
-                std::vector<int32_t> _MVARS;
+                VariableStore _MVARS;
 
                 /**
                  * @brief Map elevations
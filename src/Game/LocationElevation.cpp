@@ -34,6 +34,16 @@ namespace Falltergeist
             _canRestHere = value;
         }
 
+        bool LocationElevation::entered() const
+        {
+            return _entered;
+        }
+
+        void LocationElevation::setEntered(bool value)
+        {
+            _entered = value;
+        }
+
         std::shared_ptr<UI::TileMap> LocationElevation::floor()
         {
             return _floor;
@@ -29,6 +29,10 @@ namespace Falltergeist
                 bool canRestHere() const;
                 void setCanRestHere(bool value);
 
+                // The objects were taken over by a location state, which deletes them with itself
+                bool entered() const;
+                void setEntered(bool value);
+
                 std::shared_ptr<UI::TileMap> floor();
                 std::shared_ptr<UI::TileMap> roof();
 
@@ -43,6 +47,8 @@ namespace Falltergeist
                  */
                 bool _canRestHere = true;
 
+                bool _entered = false;
+
                 std::shared_ptr<UI::TileMap> _floor;
 
                 std::shared_ptr<UI::TileMap> _roof;
@@ -0,0 +1,106 @@
+#include <cmath>
+#include "../Format/Gam/File.h"
+#include "../Format/Map/Elevation.h"
+#include "../Format/Map/File.h"
+#include "../Format/Map/Script.h"
+#include "../Game/LocationTemplate.h"
+#include "../ResourceManager.h"
+
+namespace Falltergeist
+{
+    using Graphics::Point;
+
+    namespace Game
+    {
+        LocationTemplate::LocationTemplate(std::shared_ptr<Format::Map::File> mapFile) : _mapFile(std::move(mapFile))
+        {
+            _name = _mapFile->name().substr(0, _mapFile->name().find("."));
+            _defaultElevationIndex = _mapFile->defaultElevation();
+            _defaultPosition = _mapFile->defaultPosition();
+            _defaultOrientation = _mapFile->defaultOrientation();
+
+            if (!_mapFile->MVARS().empty()) {
+                auto gam = ResourceManager::getInstance()->gamFileType("maps/" + _name + ".gam");
+                if (gam) {
+                    _MVARS.assign(gam->MVARValues().begin(), gam->MVARValues().end());
+                }
+            }
+
+            if (_mapFile->scriptId() > 0) {
+                _scriptIndex = _mapFile->scriptId() - 1;
+            }
+
+            for (auto& mapElevation : _mapFile->elevations()) {
+                Elevation elevation;
+                for (unsigned int i = 0; i != 100 * 100; ++i) {
+                    auto tileX = static_cast<unsigned>(ceil(((double) i) / 100));
+                    unsigned int tileY = i % 100;
+                    unsigned int x = (100 - tileY - 1) * 48 + 32 * (tileX - 1);
+                    unsigned int y = tileX * 24 + (tileY - 1) * 12 + 1;
+
+                    unsigned int tileNum = mapElevation.floorTiles().at(i);
+                    if (tileNum > 1) {
+                        elevation.floorTiles.push_back({i, tileNum, Point(x, y)});
+                    }
+
+                    tileNum = mapElevation.roofTiles().at(i);
+                    if (tileNum > 1) {
+                        elevation.roofTiles.push_back({i, tileNum, Point(x, y - 96)});
+                    }
+                }
+                _elevations.push_back(std::move(elevation));
+            }
+
+            for (auto& script : _mapFile->scripts()) {
+                if (script.type() == Format::Map::Script::Type::SPATIAL) {
+                    _spatialScripts.push_back(&script);
+                }
+            }
+        }
+
+        Format::Map::File* LocationTemplate::mapFile() const
+        {
+            return _mapFile.get();
+        }
+
+        const std::string& LocationTemplate::name() const
+        {
+            return _name;
+        }
+
+        unsigned int LocationTemplate::defaultElevationIndex() const
+        {
+            return _defaultElevationIndex;
+        }
+
+        unsigned int LocationTemplate::defaultPosition() const
+        {
+            return _defaultPosition;
+        }
+
+        unsigned int LocationTemplate::defaultOrientation() const
+        {
+            return _defaultOrientation;
+        }
+
+        const std::vector<int32_t>& LocationTemplate::MVARS() const
+        {
+            return _MVARS;
+        }
+
+        int LocationTemplate::scriptIndex() const
+        {
+            return _scriptIndex;
+        }
+
+        const std::vector<LocationTemplate::Elevation>& LocationTemplate::elevations() const
+        {
+            return _elevations;
+        }
+
+        const std::vector<const Format::Map::Script*>& LocationTemplate::spatialScripts() const
+        {
+            return _spatialScripts;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../Graphics/Point.h"
+
+namespace Falltergeist
+{
+    namespace Format
+    {
+        namespace Map
+        {
+            class File;
+            class Script;
+        }
+    }
+    namespace Game
+    {
+        /**
+         * @brief What every visit of a map starts from
+         *
+         * Derived once from the .MAP and .GAM files and never changed afterwards.
+         * Game::Location copies the values and creates its tiles and objects from the records,
+         * so entering the map again doesn't go through the raw map data.
+         */
+        class LocationTemplate final
+        {
+            public:
+                struct Tile
+                {
+                    // index of the tile on the 100 x 100 elevation grid
+                    unsigned int index;
+                    unsigned int number;
+                    Graphics::Point position;
+                };
+
+                struct Elevation
+                {
+                    std::vector<Tile> floorTiles;
+                    std::vector<Tile> roofTiles;
+                };
+
+                LocationTemplate(std::shared_ptr<Format::Map::File> mapFile);
+
+                // The objects are created from the records of the file, it's pinned as long as the template exists
+                Format::Map::File* mapFile() const;
+
+                const std::string& name() const;
+
+                unsigned int defaultElevationIndex() const;
+                unsigned int defaultPosition() const;
+                unsigned int defaultOrientation() const;
+
+                // Initial values from the .GAM file, empty if the map has no variables
+                const std::vector<int32_t>& MVARS() const;
+
+                // Index of the map script in scripts.lst, -1 if there is none
+                int scriptIndex() const;
+
+                const std::vector<Elevation>& elevations() const;
+
+                // Spatial scripts of the map, in the order of the file
+                const std::vector<const Format::Map::Script*>& spatialScripts() const;
+
+            private:
+                std::shared_ptr<Format::Map::File> _mapFile;
+                std::string _name;
+                unsigned int _defaultElevationIndex = 0;
+                unsigned int _defaultPosition = 0;
+                unsigned int _defaultOrientation = 0;
+                std::vector<int32_t> _MVARS;
+                int _scriptIndex = -1;
+                std::vector<Elevation> _elevations;
+                std::vector<const Format::Map::Script*> _spatialScripts;
+        };
+    }
+}
@@ -1,6 +1,8 @@
 ﻿#include <cmath>
 #include <cstdio>
 #include <memory>
+#include "../Audio/Mixer.h"
+#include "../Base/Pool.h"
 #include "../Exception.h"
 #include "../Format/Frm/File.h"
 #include "../Format/Msg/File.h"
@@ -13,16 +15,20 @@
 #include "../Game/DudeObject.h"
 #include "../Game/Game.h"
 #include "../Game/Helper/EggHelper.h"
+#include "../Game/Location.h"
 #include "../Game/Object.h"
 #include "../Graphics/ObjectUIFactory.h"
 #include "../PathFinding/HexagonGrid.h"
 #include "../LocationCamera.h"
 #include "../Logger.h"
+#include "../MemoryStats.h"
 #include "../PathFinding/Hexagon.h"
 #include "../ResourceManager.h"
+#include "../Simulation.h"
 #include "../State/Location.h"
 #include "../UI/Animation.h"
 #include "../UI/AnimationQueue.h"
+#include "../UI/FloatMessagePool.h"
 #include "../UI/Image.h"
 #include "../UI/TextArea.h"
 #include "../VM/Script.h"
@@ -31,10 +37,67 @@ namespace Falltergeist
 {
     namespace Game
     {
+        namespace
+        {
+            // scenery, walls and misc objects
+            const size_t SMALL_OBJECT_SIZE = 256;
+            // items
+            const size_t ITEM_OBJECT_SIZE = 384;
+            // critters, anything larger uses the global heap
+            const size_t CRITTER_OBJECT_SIZE = 768;
+
+            // never destroyed, objects can outlive static objects at exit
+            template<size_t Size>
+            Base::Pool<Size, 128>* pool()
+            {
+                static auto pool = new Base::Pool<Size, 128>();
+                return pool;
+            }
+        }
+
+        void* Object::operator new(size_t size)
+        {
+            MemoryStats::add(MemoryStats::Category::OBJECTS, size);
+            if (size <= SMALL_OBJECT_SIZE) {
+                return pool<SMALL_OBJECT_SIZE>()->allocate();
+            }
+            if (size <= ITEM_OBJECT_SIZE) {
+                return pool<ITEM_OBJECT_SIZE>()->allocate();
+            }
+            if (size <= CRITTER_OBJECT_SIZE) {
+                return pool<CRITTER_OBJECT_SIZE>()->allocate();
+            }
+            return ::operator new(size);
+        }
+
+        void Object::operator delete(void* pointer, size_t size)
+        {
+            if (!pointer) {
+                return;
+            }
+            MemoryStats::remove(MemoryStats::Category::OBJECTS, size);
+            if (size <= SMALL_OBJECT_SIZE) {
+                pool<SMALL_OBJECT_SIZE>()->deallocate(pointer);
+            } else if (size <= ITEM_OBJECT_SIZE) {
+                pool<ITEM_OBJECT_SIZE>()->deallocate(pointer);
+            } else if (size <= CRITTER_OBJECT_SIZE) {
+                pool<CRITTER_OBJECT_SIZE>()->deallocate(pointer);
+            } else {
+                ::operator delete(pointer);
+            }
+        }
+
         Object::Object() : Event::EventTarget(Game::getInstance()->eventDispatcher())
         {
         }
 
+        Object::~Object()
+        {
+            if (_floatMessagePool) {
+                _floatMessagePool->remove(this);
+            }
+        }
+
         Object::Type Object::type() const
         {
             return _type;
@@ -48,6 +111,7 @@ namespace Falltergeist
         void Object::setPID(int value)
         {
             _PID = value;
+            ++_revision;
         }
 
         int Object::FID() const {
@@ -60,7 +124,8 @@ namespace Falltergeist
                 return;
             }
             _FID = value;
-            _generateUi();
+            ++_revision;
+            _invalidateUi();
         }
 
         int Object::SID() const
@@ -98,7 +163,7 @@ namespace Falltergeist
             }
 
             _orientation = value;
-            _generateUi();
+            _invalidateUi();
         }
 
         std::string Object::name() const
@@ -109,6 +174,7 @@ namespace Falltergeist
         void Object::setName(const std::string &value)
         {
             _name = value;
+            ++_revision;
         }
 
         std::string Object::scrName() const
@@ -129,6 +195,7 @@ namespace Falltergeist
         void Object::setDescription(const std::string &value)
         {
             _description = value;
+            ++_revision;
         }
 
         VM::Script *Object::script() const
@@ -139,16 +206,59 @@ namespace Falltergeist
         void Object::setScript(VM::Script *script)
         {
             _script.reset(script);
+            ++_revision;
         }
 
-        UI::Base *Object::ui() const
+        UI::Base *Object::ui()
         {
+            if (_uiPending) {
+                _uiPending = false;
+                _generateUi();
+                if (_ui) {
+                    if (_pendingTrans) {
+                        _ui->setTrans(_trans);
+                    }
+                    if (_pendingDefaultFrame) {
+                        setDefaultFrame(_defaultFrame);
+                    }
+                }
+                _pendingTrans = false;
+                _pendingDefaultFrame = false;
+                if (_ui) {
+                    _uiHandler.invoke(this);
+                }
+            }
             return _ui.get();
         }
 
         void Object::setUI(UI::Base *ui)
         {
             _ui.reset(ui);
+            _uiPending = false;
+        }
+
+        bool Object::hasUi() const
+        {
+            return _ui || _uiPending;
+        }
+
+        bool Object::uiPending() const
+        {
+            return _uiPending;
+        }
+
+        Graphics::Size Object::uiSize() const
+        {
+            if (_uiPending) {
+                Graphics::ObjectUIFactory uiFactory;
+                return uiFactory.sizeByFID(FID(), orientation());
+            }
+            return _ui ? _ui->size() : Graphics::Size();
+        }
+
+        Base::Delegate<Object*>& Object::uiHandler()
+        {
+            return _uiHandler;
         }
 
         void Object::_generateUi()
@@ -157,6 +267,14 @@ namespace Falltergeist
             _ui = uiFactory.buildByFID(FID(), orientation());
         }
 
+        void Object::_invalidateUi()
+        {
+            _ui.reset();
+            _uiPending = true;
+            _pendingTrans = false;
+            _pendingDefaultFrame = false;
+        }
+
         bool Object::canWalkThru() const
         {
             return _canWalkThru;
@@ -211,36 +329,37 @@ namespace Falltergeist
             setPosition(hexagon->number());
         }
 
-        UI::TextArea *Object::floatMessage() const
+        void Object::setFloatMessage(const std::string& text, SDL_Color color)
         {
-            return _floatMessage.get();
+            Game::getInstance()->locationState()->floatMessages()->show(this, text, color);
         }
 
-        void Object::setFloatMessage(std::unique_ptr<UI::TextArea> message)
+        bool Object::hasFloatMessage() const
         {
-            _floatMessage = std::move(message);
+            return _floatMessagePool != nullptr;
         }
 
-        void Object::renderText()
+        void Object::playSound(const std::string& filename)
         {
-            auto message = floatMessage();
-            if (!message) {
-                return;
-            }
-            if (SDL_GetTicks() - message->timestampCreated() >= 7000) {
-                setFloatMessage(nullptr);
+            auto mixer = Game::getInstance()->mixer();
+            if (hexagon()) {
+                mixer->playACMSound(filename, hexagon()->position());
             } else {
-                message->setPosition(_ui->position() + Point(
-                        _ui->size().width() / 2 - message->size().width() / 2,
-                        -4 - message->textSize().height()
-                ));
-                message->render();
+                mixer->playACMSound(filename);
+            }
+        }
+
+        void Object::renderText()
+        {
+            if (_floatMessagePool) {
+                _floatMessagePool->render(this);
             }
         }
 
         void Object::render()
         {
-            if (!_ui || !hexagon()) {
+            // the UI of an object is built once it comes close to the camera
+            if (!hexagon() || !ui()) {
                 return;
             }
 
@@ -272,6 +391,23 @@ namespace Falltergeist
             }
         }
 
+        void Object::skipThink(const float &deltaTime)
+        {
+            _skippedThinkTime += deltaTime;
+        }
+
+        void Object::catchUpThink(const float &deltaTime)
+        {
+            float elapsed = _skippedThinkTime + deltaTime;
+            _skippedThinkTime = 0.0f;
+            think(elapsed);
+        }
+
+        bool Object::parallelThink() const
+        {
+            return true;
+        }
+
         void Object::handle(Event::Event *event)
         {
             if (_ui) {
@@ -293,111 +429,156 @@ namespace Falltergeist
         {
             Logger::info("SCRIPT") << "description_p_proc() - 0x" << std::hex << PID() << " " << name() << " "
                                    << (script() ? script()->filename() : "") << std::endl;
-            bool useDefault = true;
-            if (script() && script()->hasFunction("description_p_proc")) {
-                script()
-                        ->setSourceObject(Game::getInstance()->player().get())
-                        ->call("description_p_proc");
-                if (script()->overrides()) {
-                    useDefault = false;
-                }
-            }
-            if (useDefault) {
+            _describe(PROCEDURE::DESCRIPTION, _descriptionMemo, [this]() {
                 auto descr = description();
                 if (descr.empty()) {
                     descr = _t(MSG_TYPE::MSG_PROTO, 493);
                 }
-                Game::getInstance()->locationState()->displayMessage(descr);
-            }
+                return descr;
+            });
         }
 
         void Object::use_p_proc(CritterObject *usedBy)
         {
-            if (script() && script()->hasFunction("use_p_proc")) {
+            if (script() && script()->hasFunction(PROCEDURE::USE)) {
                 script()
                         ->setSourceObject(usedBy)
-                        ->call("use_p_proc");
+                        ->call(PROCEDURE::USE);
             }
         }
 
         void Object::destroy_p_proc()
         {
-            if (script() && script()->hasFunction("destroy_p_proc")) {
+            if (script() && script()->hasFunction(PROCEDURE::DESTROY)) {
                 script()
                         ->setSourceObject(Game::getInstance()->player().get())
-                        ->call("destroy_p_proc");
+                        ->call(PROCEDURE::DESTROY);
             }
         }
 
         void Object::look_at_p_proc()
         {
+            _describe(PROCEDURE::LOOK_AT, _lookAtMemo, [this]() {
+                auto protoMsg = ResourceManager::getInstance()->msgFileType("text/english/game/proto.msg");
+                char buf[512];
+                sprintf(buf, protoMsg->message(490)->text().c_str(), name().c_str());
+                return std::string(buf);
+            });
+        }
+
+        bool Object::DescriptionStamp::operator==(const DescriptionStamp& other) const
+        {
+            return GVARS == other.GVARS && MVARS == other.MVARS && MVARSRevision == other.MVARSRevision
+                && LVARS == other.LVARS && object == other.object;
+        }
+
+        Object::DescriptionStamp Object::_descriptionStamp() const
+        {
+            DescriptionStamp stamp;
+            stamp.GVARS = Game::getInstance()->GVARS()->revision();
+            if (auto state = Game::getInstance()->locationState()) {
+                if (auto location = state->location()) {
+                    stamp.MVARS = location->MVARS();
+                    stamp.MVARSRevision = location->MVARS()->revision();
+                }
+            }
+            stamp.LVARS = script() ? script()->LVARSRevision() : 0;
+            stamp.object = _revision;
+            return stamp;
+        }
+
+        void Object::_describe(PROCEDURE procedure, std::unique_ptr<DescriptionMemo>& memo, const std::function<std::string()>& defaultMessage)
+        {
+            auto state = Game::getInstance()->locationState();
+            auto stamp = _descriptionStamp();
+            if (memo && memo->stamp == stamp) {
+                for (auto& message : memo->messages) {
+                    state->displayMessage(message);
+                }
+                return;
+            }
+
+            std::vector<std::string> messages;
             bool useDefault = true;
-            if (script() && script()->hasFunction("look_at_p_proc")) {
+            bool repeatable = true;
+            if (script() && script()->hasFunction(procedure)) {
+                state->captureMessages(&messages);
                 script()
                         ->setSourceObject(Game::getInstance()->player().get())
-                        ->call("look_at_p_proc");
+                        ->call(procedure);
+                state->captureMessages(nullptr);
                 if (script()->overrides()) {
                     useDefault = false;
                 }
+                repeatable = script()->repeatable();
             }
             if (useDefault) {
-                auto protoMsg = ResourceManager::getInstance()->msgFileType("text/english/game/proto.msg");
-                char buf[512];
-                sprintf(buf, protoMsg->message(490)->text().c_str(), name().c_str());
-                Game::getInstance()->locationState()->displayMessage(std::string(buf));
+                auto message = defaultMessage();
+                state->displayMessage(message);
+                messages.push_back(std::move(message));
+            }
+
+            if (!repeatable || !(_descriptionStamp() == stamp)) {
+                memo.reset();
+                return;
+            }
+            if (!memo) {
+                memo = std::make_unique<DescriptionMemo>();
             }
+            memo->stamp = stamp;
+            memo->messages = std::move(messages);
         }
 
         void Object::map_enter_p_proc()
         {
             if (script()) {
-                script()->call("map_enter_p_proc");
+                script()->call(PROCEDURE::MAP_ENTER);
             }
         }
 
         void Object::map_exit_p_proc()
         {
             if (script()) {
-                script()->call("map_exit_p_proc");
+                script()->call(PROCEDURE::MAP_EXIT);
             }
         }
 
         void Object::map_update_p_proc()
         {
             if (script()) {
-                script()->call("map_update_p_proc");
+                script()->call(PROCEDURE::MAP_UPDATE);
             }
         }
 
         void Object::pickup_p_proc(CritterObject *pickedUpBy)
         {
-            if (script() && script()->hasFunction("pickup_p_proc")) {
+            if (script() && script()->hasFunction(PROCEDURE::PICKUP)) {
                 script()
                         ->setSourceObject(pickedUpBy)
-                        ->call("pickup_p_proc");
+                        ->call(PROCEDURE::PICKUP);
             }
             // @TODO: standard handler
         }
 
         void Object::use_obj_on_p_proc(Object *objectUsed, CritterObject *usedBy)
         {
-            if (script() && script()->hasFunction("use_obj_on_p_proc")) {
+            if (script() && script()->hasFunction(PROCEDURE::USE_OBJ_ON)) {
                 script()
                         ->setSourceObject(usedBy)
                         ->setTargetObject(objectUsed)
-                        ->call("use_obj_on_p_proc");
+                        ->call(PROCEDURE::USE_OBJ_ON);
             }
             // @TODO: standard handlers for drugs, etc.
         }
 
         void Object::use_skill_on_p_proc(SKILL skill, Object *objectUsed, CritterObject *usedBy)
         {
-            if (script() && script()->hasFunction("use_skill_on_p_proc")) {
+            if (script() && script()->hasFunction(PROCEDURE::USE_SKILL_ON)) {
                 script()
                         ->setSourceObject(usedBy)
                         ->setTargetObject(objectUsed)
                         ->setUsedSkill(skill)
-                        ->call("use_skill_on_p_proc");
+                        ->call(PROCEDURE::USE_SKILL_ON);
             }
             // @TODO: standard handlers
         }
@@ -424,6 +605,7 @@ namespace Falltergeist
         void Object::setTrans(Graphics::TransFlags::Trans value)
         {
             _trans = value;
+            _pendingTrans = _uiPending;
             if (_ui) {
                 _ui->setTrans(value);
             }
@@ -512,6 +694,7 @@ namespace Falltergeist
         void Object::setDefaultFrame(unsigned int frame)
         {
             _defaultFrame = frame;
+            _pendingDefaultFrame = _uiPending;
             if (_ui) {
                 if (auto anim = dynamic_cast<UI::AnimationQueue *>(_ui.get())) {
                     anim->currentAnimation()->setCurrentFrame(_defaultFrame);
@@ -552,5 +735,15 @@ namespace Falltergeist
         {
             _position = position;
         }
+
+        int Object::mapIndex() const
+        {
+            return _mapIndex;
+        }
+
+        void Object::setMapIndex(int value)
+        {
+            _mapIndex = value;
+        }
     }
 }
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
+#include <SDL.h>
 #include "../Event/EventTarget.h"
 #include "../Format/Enums.h"
 #include "../Game/Orientation.h"
@@ -22,6 +26,7 @@ namespace Falltergeist
     {
         class AnimationQueue;
         class Base;
+        class FloatMessagePool;
         class Image;
         class TextArea;
     }
@@ -54,7 +59,12 @@ namespace Falltergeist
 
 
                 Object();
-                virtual ~Object() = default;
+                virtual ~Object();
+
+                // Objects are allocated from slab pools by size class, maps create thousands of them at once
+                static void* operator new(size_t size);
+
+                static void operator delete(void* pointer, size_t size);
 
                 // whether this object is transparent in terms of walking through it by a critter
                 virtual bool canWalkThru() const;
@@ -123,6 +133,16 @@ namespace Falltergeist
                  * This method is called after handle() but before render() in the main loop.
                  */
                 virtual void think(const float &deltaTime);
+                /**
+                 * @brief Objects away from the screen think less often, the time they skipped is added to their next think.
+                 */
+                void skipThink(const float &deltaTime);
+                void catchUpThink(const float &deltaTime);
+                /**
+                 * @brief Whether think() only changes this object and emits events, so it may run on a worker thread
+                 * alongside other objects. The events are queued in the object order afterwards.
+                 */
+                virtual bool parallelThink() const;
                 /**
                  * @brief Render this object, if it has visible UI elements.
                  * This method is called last in the main loop (after handle() and think()).
@@ -131,6 +151,7 @@ namespace Falltergeist
 
                 /**
                 * @brief Render object outline, if it has visible UI elements.
+                * Type 0 renders the sprite itself at the hexagon, as a mask for Graphics::OutlinePass.
                 */
                 virtual void renderOutline(int type);
 
@@ -139,17 +160,34 @@ namespace Falltergeist
                  */
                 virtual void renderText();
 
-                // ActiveUI used to display object on screen and capture mouse events
-                UI::Base* ui() const;
+                // ActiveUI used to display object on screen and capture mouse events.
+                // It's built the first time it's asked for after the FID or the orientation changed,
+                // so objects which are never seen don't create their sprites
+                UI::Base* ui();
                 void setUI(UI::Base* ui);
 
+                // whether ui() would return an UI, built or not
+                bool hasUi() const;
+                // whether the UI is to be built by the next ui() call
+                bool uiPending() const;
+
+                // Size of the UI, read from the FRM if the UI wasn't built yet
+                Graphics::Size uiSize() const;
+
+                // Invoked with the object whenever ui() builds a new UI
+                Base::Delegate<Object*>& uiHandler();
+
                 // Hexagon of object current position
                 Hexagon* hexagon() const;
                 void setHexagon(Hexagon* hexagon);
 
-                // TextArea, currently floating above the object
-                UI::TextArea* floatMessage() const;
-                void setFloatMessage(std::unique_ptr<UI::TextArea> floatMessage);
+                // Floats the text above the object for a while, replacing the previous message. Shown by the
+                // float message pool of the current location
+                void setFloatMessage(const std::string& text, SDL_Color color);
+                bool hasFloatMessage() const;
+
+                // Plays a sound effect heard from the object's position, or centered if it isn't on the map
+                void playSound(const std::string& filename);
 
                 // is object currently being rendered
                 bool inRender() const;
@@ -161,6 +199,7 @@ namespace Falltergeist
                 void setTrans(Graphics::TransFlags::Trans value);
 
                 // request description of the object to console, may call "description_p_proc" procedure of underlying script entity
+                // The messages are memoised, see _describe()
                 virtual void description_p_proc();
                 // call "destroy_p_proc" procedure of underlying script entity (use this just before killing critter or destroying the object)
                 virtual void destroy_p_proc();
@@ -206,6 +245,10 @@ namespace Falltergeist
                 int position() const;
                 void setPosition(int position);
 
+                // index of the object in its elevation of the .MAP file, -1 for objects created in the game
+                int mapIndex() const;
+                void setMapIndex(int value);
+
             protected:
                 bool _canWalkThru = true;
                 bool _canLightThru = false;
@@ -219,19 +262,67 @@ namespace Falltergeist
                 int _elevation = 0;
                 Orientation _orientation;
                 int _position = -1;
+                int _mapIndex = -1;
                 std::string _name;
                 std::string _scrName;
                 std::string _description;
                 std::unique_ptr<VM::Script> _script;
                 std::unique_ptr<UI::Base> _ui;
+                // ui() calls _generateUi() when set, cleared by anything which replaces _ui
+                bool _uiPending = false;
+                // set while the UI is pending, applied once it's built
+                bool _pendingTrans = false;
+                bool _pendingDefaultFrame = false;
+                Base::Delegate<Object*> _uiHandler;
                 virtual void _generateUi();
-                std::unique_ptr<UI::TextArea> _floatMessage;
+                // Drops the UI built for the previous FID or orientation, the new one is built by ui()
+                virtual void _invalidateUi();
                 bool _inRender = false;
+                float _skippedThinkTime = 0.0f;
                 Graphics::TransFlags::Trans _trans = Graphics::TransFlags::Trans::DEFAULT;
                 Orientation _lightOrientation;
                 unsigned int _lightIntensity = 0;
                 unsigned int _lightRadius = 0;
                 unsigned int _defaultFrame;
+                // counts changes of what descriptions are made of: PID, FID, name, description, script, hit points
+                uint64_t _revision = 0;
+
+            private:
+                // Revisions of everything a description procedure reads
+                struct DescriptionStamp
+                {
+                    uint64_t GVARS = 0;
+                    const void* MVARS = nullptr;
+                    uint64_t MVARSRevision = 0;
+                    uint64_t LVARS = 0;
+                    uint64_t object = 0;
+
+                    bool operator==(const DescriptionStamp& other) const;
+                };
+
+                struct DescriptionMemo
+                {
+                    DescriptionStamp stamp;
+                    std::vector<std::string> messages;
+                };
+
+                friend class UI::FloatMessagePool;
+
+                // slot of the message floating above the object, nullptr without one
+                UI::FloatMessagePool* _floatMessagePool = nullptr;
+                unsigned int _floatMessageSlot = 0;
+
+                // allocated by the first description or look at, most objects are never examined
+                std::unique_ptr<DescriptionMemo> _descriptionMemo;
+                std::unique_ptr<DescriptionMemo> _lookAtMemo;
+
+                DescriptionStamp _descriptionStamp() const;
+
+                // Shows the messages of the procedure, or the default one if the script doesn't override it. They are
+                // shown again from the memo while no variable or state of the object changed, the script runs only
+                // if a change could alter its result. Calls which change anything themselves, or draw random numbers,
+                // or float messages aren't memoised
+                void _describe(PROCEDURE procedure, std::unique_ptr<DescriptionMemo>& memo, const std::function<std::string()>& defaultMessage);
         };
     }
 }
@@ -105,24 +105,28 @@ namespace Falltergeist
                     ((ItemObject*)object)->setInventoryFID(proto->inventoryFID());
                     ((ItemObject*)object)->setPrice(proto->basePrice());
                     auto msg = ResourceManager::getInstance()->msgFileType("text/english/game/pro_item.msg");
-                    try
+                    if (auto name = msg->tryMessage(proto->messageId()))
                     {
-                        object->setName(msg->message(proto->messageId())->text());
-                        object->setDescription(msg->message(proto->messageId() + 1)->text());
+                        object->setName(name->text());
+                    }
+                    if (auto description = msg->tryMessage(proto->messageId() + 1))
+                    {
+                        object->setDescription(description->text());
                     }
-                    catch (const Exception&) {}
                     break;
                 }
                 case OBJECT_TYPE::CRITTER:
                 {
                     object = new CritterObject();
                     auto msg = ResourceManager::getInstance()->msgFileType("text/english/game/pro_crit.msg");
-                    try
+                    if (auto name = msg->tryMessage(proto->messageId()))
                     {
-                        object->setName(msg->message(proto->messageId())->text());
-                        object->setDescription(msg->message(proto->messageId() + 1)->text());
+                        object->setName(name->text());
+                    }
+                    if (auto description = msg->tryMessage(proto->messageId() + 1))
+                    {
+                        object->setDescription(description->text());
                     }
-                    catch (const Exception&) {}
 
                     for (unsigned i = (unsigned)STAT::STRENGTH; i <= (unsigned)STAT::LUCK; i++)
                     {
@@ -184,12 +188,14 @@ namespace Falltergeist
                         }
                     }
                     auto msg = ResourceManager::getInstance()->msgFileType("text/english/game/pro_scen.msg");
-                    try
+                    if (auto name = msg->tryMessage(proto->messageId()))
+                    {
+                        object->setName(name->text());
+                    }
+                    if (auto description = msg->tryMessage(proto->messageId() + 1))
                     {
-                        object->setName(msg->message(proto->messageId())->text());
-                        object->setDescription(msg->message(proto->messageId() + 1)->text());
+                        object->setDescription(description->text());
                     }
-                    catch (const Exception&) {}
 
                     ((SceneryObject*)object)->setSoundId((char)proto->soundId());
 
@@ -222,12 +228,14 @@ namespace Falltergeist
                 {
                     object = new WallObject();
                     auto msg = ResourceManager::getInstance()->msgFileType("text/english/game/pro_wall.msg");
-                    try
+                    if (auto name = msg->tryMessage(proto->messageId()))
+                    {
+                        object->setName(name->text());
+                    }
+                    if (auto description = msg->tryMessage(proto->messageId() + 1))
                     {
-                        object->setName(msg->message(proto->messageId())->text());
-                        object->setDescription(msg->message(proto->messageId() + 1)->text());
+                        object->setDescription(description->text());
                     }
-                    catch (const Exception&) {}
 
                     //first two bytes are orientation. second two - unknown
                     unsigned short orientation = proto->flagsExt() >> 16;
@@ -279,12 +287,14 @@ namespace Falltergeist
                     }
 
                     auto msg = ResourceManager::getInstance()->msgFileType("text/english/game/pro_misc.msg");
-                    try
+                    if (auto name = msg->tryMessage(proto->messageId()))
+                    {
+                        object->setName(name->text());
+                    }
+                    if (auto description = msg->tryMessage(proto->messageId() + 1))
                     {
-                        object->setName(msg->message(proto->messageId())->text());
-                        object->setDescription(msg->message(proto->messageId() + 1)->text());
+                        object->setDescription(description->text());
                     }
-                    catch (const Exception&) {}
                     break;
                 }
             }
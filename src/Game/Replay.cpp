@@ -0,0 +1,146 @@
+#include <cstring>
+#include <fstream>
+#include "../Game/Replay.h"
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        const uint32_t Replay::VERSION = 1;
+
+        namespace
+        {
+            const char MAGIC[4] = {'F', 'G', 'R', 'P'};
+
+            // a damaged file must not make the reader allocate gigabytes
+            const uint32_t MAX_COUNT = 1 << 24;
+
+            struct Header
+            {
+                char magic[4];
+                uint32_t version;
+                // SDL_Event differs between SDL versions and platforms
+                uint32_t eventSize;
+                uint32_t seed;
+                uint32_t simulationRate;
+                uint32_t frames;
+                uint32_t events;
+            };
+        }
+
+        void Replay::start(uint32_t seed, unsigned int simulationRate)
+        {
+            _seed = seed;
+            _simulationRate = simulationRate;
+            _frames.clear();
+            _events.clear();
+            _frameEvents = 0;
+        }
+
+        void Replay::event(const SDL_Event& event)
+        {
+            switch (event.type) {
+                case SDL_MOUSEBUTTONDOWN:
+                case SDL_MOUSEBUTTONUP:
+                case SDL_MOUSEMOTION:
+                case SDL_KEYDOWN:
+                case SDL_KEYUP:
+                case SDL_QUIT:
+                    _events.push_back(event);
+                    _frameEvents++;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void Replay::endFrame(unsigned int steps)
+        {
+            Frame frame;
+            frame.events = _frameEvents;
+            frame.steps = steps;
+            _frames.push_back(frame);
+            _frameEvents = 0;
+        }
+
+        uint32_t Replay::seed() const
+        {
+            return _seed;
+        }
+
+        unsigned int Replay::simulationRate() const
+        {
+            return _simulationRate;
+        }
+
+        const std::vector<Replay::Frame>& Replay::frames() const
+        {
+            return _frames;
+        }
+
+        const std::vector<SDL_Event>& Replay::events() const
+        {
+            return _events;
+        }
+
+        bool Replay::write(const std::string& filename) const
+        {
+            std::ofstream stream(filename, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+            if (!stream) {
+                return false;
+            }
+
+            Header header;
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.eventSize = sizeof(SDL_Event);
+            header.seed = _seed;
+            header.simulationRate = _simulationRate;
+            header.frames = static_cast<uint32_t>(_frames.size());
+            header.events = static_cast<uint32_t>(_events.size());
+
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.write(reinterpret_cast<const char*>(_frames.data()), _frames.size() * sizeof(Frame));
+            stream.write(reinterpret_cast<const char*>(_events.data()), _events.size() * sizeof(SDL_Event));
+            return static_cast<bool>(stream);
+        }
+
+        bool Replay::read(const std::string& filename)
+        {
+            std::ifstream stream(filename, std::ios_base::binary | std::ios_base::in);
+            if (!stream) {
+                return false;
+            }
+
+            Header header;
+            if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))
+                || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+                || header.eventSize != sizeof(SDL_Event) || header.simulationRate == 0
+                || header.frames > MAX_COUNT || header.events > MAX_COUNT) {
+                return false;
+            }
+
+            std::vector<Frame> frames(header.frames);
+            std::vector<SDL_Event> events(header.events);
+            if (!stream.read(reinterpret_cast<char*>(frames.data()), frames.size() * sizeof(Frame))
+                || !stream.read(reinterpret_cast<char*>(events.data()), events.size() * sizeof(SDL_Event))) {
+                return false;
+            }
+
+            uint64_t total = 0;
+            for (auto& frame : frames) {
+                total += frame.events;
+            }
+            if (total != events.size()) {
+                return false;
+            }
+
+            _seed = header.seed;
+            _simulationRate = header.simulationRate;
+            _frames.swap(frames);
+            _events.swap(events);
+            _frameEvents = 0;
+            return true;
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <SDL.h>
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        /**
+         * @brief Recorded inputs of a session
+         *
+         * Stores the seed of the random numbers, the simulation rate and, for every frame, the input events the game
+         * handled and the number of logic steps run after them. The logic takes its time from the steps
+         * (see Simulation), so replaying the frames in the headless mode repeats the session whatever the frame times.
+         * Events are SDL_Event copies in the byte order of the machine, a file is only played by the build which wrote it.
+         */
+        class Replay final
+        {
+            public:
+                static const uint32_t VERSION;
+
+                struct Frame
+                {
+                    uint32_t events = 0;
+                    uint32_t steps = 0;
+                };
+
+                void start(uint32_t seed, unsigned int simulationRate);
+
+                // Only events the game turns into input are kept
+                void event(const SDL_Event& event);
+                void endFrame(unsigned int steps);
+
+                uint32_t seed() const;
+                unsigned int simulationRate() const;
+
+                const std::vector<Frame>& frames() const;
+
+                // Events of all the frames in order, each frame takes the next Frame::events of them
+                const std::vector<SDL_Event>& events() const;
+
+                bool write(const std::string& filename) const;
+
+                // Leaves the replay untouched if the file is missing, of another version or damaged
+                bool read(const std::string& filename);
+
+            private:
+                uint32_t _seed = 0;
+                unsigned int _simulationRate = 60;
+                std::vector<Frame> _frames;
+                std::vector<SDL_Event> _events;
+                uint32_t _frameEvents = 0;
+        };
+    }
+}
@@ -0,0 +1,750 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <zlib.h>
+#include "../Base/ThreadPool.h"
+#include "../CrossPlatform.h"
+#include "../Exception.h"
+#include "../Game/ContainerItemObject.h"
+#include "../Game/CritterObject.h"
+#include "../Game/DudeObject.h"
+#include "../Game/Game.h"
+#include "../Game/ItemObject.h"
+#include "../Game/Location.h"
+#include "../Game/LocationElevation.h"
+#include "../Game/Object.h"
+#include "../Game/ObjectFactory.h"
+#include "../Game/SaveFile.h"
+#include "../Game/VariableStore.h"
+#include "../Logger.h"
+#include "../PathFinding/Hexagon.h"
+#include "../UI/TextArea.h"
+#include "../VM/Script.h"
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        const uint32_t SaveFile::VERSION = 1;
+
+        const unsigned int SaveFile::SLOTS = 100;
+
+        namespace
+        {
+            const char MAGIC[4] = {'F', 'G', 'S', 'V'};
+
+            const char SUMMARY_MAGIC[4] = {'F', 'G', 'S', 'I'};
+
+            const uint32_t COMPRESSED = 1;
+
+            // ObjectRecord::flags
+            const uint32_t REMOVED = 1;
+
+            // ids of the objects script snapshots refer to, object ids are only resolved on the same elevation
+            const uint32_t NO_OBJECT = 0;
+            const uint32_t PLAYER_OBJECT = 1;
+            const uint32_t FIRST_OBJECT = 2;
+
+            // a damaged file must not make the reader allocate gigabytes
+            const uint32_t MAX_COUNT = 1 << 24;
+
+            struct Header
+            {
+                char magic[4];
+                uint32_t version;
+                uint32_t flags;
+                uint64_t bodySize;
+                uint64_t storedSize;
+            };
+
+            template<typename T>
+            void put(std::vector<uint8_t>& bytes, const T& value)
+            {
+                auto data = reinterpret_cast<const uint8_t*>(&value);
+                bytes.insert(bytes.end(), data, data + sizeof(T));
+            }
+
+            template<typename T>
+            void putArray(std::vector<uint8_t>& bytes, const std::vector<T>& values)
+            {
+                put(bytes, static_cast<uint32_t>(values.size()));
+                auto data = reinterpret_cast<const uint8_t*>(values.data());
+                bytes.insert(bytes.end(), data, data + values.size() * sizeof(T));
+            }
+
+            void putString(std::vector<uint8_t>& bytes, const std::string& value)
+            {
+                put(bytes, static_cast<uint32_t>(value.size()));
+                bytes.insert(bytes.end(), value.begin(), value.end());
+            }
+
+            class Reader
+            {
+                public:
+                    Reader(const std::vector<uint8_t>& bytes) : _bytes(bytes)
+                    {
+                    }
+
+                    template<typename T>
+                    bool get(T& value)
+                    {
+                        return _read(&value, sizeof(T));
+                    }
+
+                    template<typename T>
+                    bool getArray(std::vector<T>& values)
+                    {
+                        uint32_t count = 0;
+                        if (!get(count) || count > MAX_COUNT) {
+                            return false;
+                        }
+                        values.resize(count);
+                        return _read(values.data(), count * sizeof(T));
+                    }
+
+                    bool getString(std::string& value)
+                    {
+                        uint32_t size = 0;
+                        if (!get(size) || size > MAX_COUNT) {
+                            return false;
+                        }
+                        value.resize(size);
+                        return _read(&value[0], size);
+                    }
+
+                    bool finished() const
+                    {
+                        return _position == _bytes.size();
+                    }
+
+                private:
+                    const std::vector<uint8_t>& _bytes;
+                    size_t _position = 0;
+
+                    bool _read(void* data, size_t size)
+                    {
+                        if (size > _bytes.size() - _position) {
+                            return false;
+                        }
+                        if (size) {
+                            std::memcpy(data, _bytes.data() + _position, size);
+                        }
+                        _position += size;
+                        return true;
+                    }
+            };
+
+            Inventory* inventoryOf(Object* object)
+            {
+                if (auto critter = dynamic_cast<CritterObject*>(object)) {
+                    return critter->inventory();
+                }
+                if (auto container = dynamic_cast<ContainerItemObject*>(object)) {
+                    return container->inventory();
+                }
+                return nullptr;
+            }
+
+            bool sameState(const SaveFile::ObjectRecord& record, const SaveFile::ItemRecord* items,
+                           const SaveFile::ObjectRecord& other, const SaveFile::ItemRecord* otherItems)
+            {
+                if (record.PID != other.PID || record.FID != other.FID || record.position != other.position
+                    || record.orientation != other.orientation || record.amount != other.amount
+                    || record.hitPoints != other.hitPoints || record.items != other.items) {
+                    return false;
+                }
+                for (uint32_t i = 0; i != record.items; ++i) {
+                    if (items[i].PID != otherItems[i].PID || items[i].amount != otherItems[i].amount) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            void fillInventory(Inventory* inventory, const SaveFile::ItemRecord* items, uint32_t count)
+            {
+                // like everywhere else items leave an inventory, the hand and armor slots may still refer to the old ones
+                inventory->clear();
+                ObjectFactory objectFactory(Game::getInstance()->logger());
+                for (uint32_t i = 0; i != count; ++i) {
+                    auto item = dynamic_cast<ItemObject*>(objectFactory.createObjectByPID(static_cast<unsigned>(items[i].PID)));
+                    if (!item) {
+                        continue;
+                    }
+                    item->setAmount(items[i].amount);
+                    inventory->push_back(item);
+                }
+            }
+        }
+
+        std::string SaveFile::slotFilename(unsigned int slot)
+        {
+            std::ostringstream filename;
+            filename << CrossPlatform::getConfigPath() << "/savegame/slot" << std::setw(2) << std::setfill('0') << slot + 1 << ".sav";
+            return filename.str();
+        }
+
+        std::string SaveFile::summaryFilename(const std::string& filename)
+        {
+            return std::filesystem::path(filename).replace_extension(".idx").string();
+        }
+
+        void SaveFile::restoreMap(Location& location)
+        {
+            auto elevations = location.elevations();
+
+            auto& pristine = _pristine[location.name()];
+            if (pristine.empty()) {
+                pristine.resize(elevations->size());
+                for (size_t i = 0; i != elevations->size(); ++i) {
+                    auto& state = pristine[i];
+                    for (auto object : *elevations->at(i)->objects()) {
+                        if (object->mapIndex() < 0) {
+                            continue;
+                        }
+                        auto index = static_cast<size_t>(object->mapIndex());
+                        if (index >= state.objects.size()) {
+                            state.objects.resize(index + 1);
+                        }
+                        _capture(object, state.objects[index], state.items);
+                    }
+                }
+            }
+
+            auto it = _maps.find(location.name());
+            if (it == _maps.end()) {
+                return;
+            }
+            auto& map = it->second;
+            if (map.MVARS.size() == location.MVARS()->size()) {
+                location.MVARS()->assign(map.MVARS);
+            }
+
+            ObjectFactory objectFactory(Game::getInstance()->logger());
+            for (size_t i = 0; i != std::min(map.elevations.size(), elevations->size()); ++i) {
+                auto& changes = map.elevations[i];
+                auto objects = elevations->at(i)->objects();
+
+                std::vector<Object*> mapObjects(pristine[i].objects.size(), nullptr);
+                for (auto object : *objects) {
+                    if (object->mapIndex() >= 0 && static_cast<size_t>(object->mapIndex()) < mapObjects.size()) {
+                        mapObjects[static_cast<size_t>(object->mapIndex())] = object;
+                    }
+                }
+
+                std::vector<std::pair<Object*, const ObjectRecord*>> scripted;
+                for (auto& record : changes.objects) {
+                    bool fromMap = record.mapIndex >= 0 && static_cast<size_t>(record.mapIndex) < mapObjects.size();
+                    Object* object = fromMap ? mapObjects[static_cast<size_t>(record.mapIndex)] : nullptr;
+                    if (record.flags & REMOVED) {
+                        if (object) {
+                            objects->erase(std::find(objects->begin(), objects->end(), object));
+                            mapObjects[static_cast<size_t>(record.mapIndex)] = nullptr;
+                            delete object;
+                        }
+                        continue;
+                    }
+                    if (!object) {
+                        // objects of the map which can't be created any more stay away
+                        if (fromMap) {
+                            continue;
+                        }
+                        object = objectFactory.createObjectByPID(static_cast<unsigned>(record.PID));
+                        if (!object) {
+                            continue;
+                        }
+                        object->setElevation(static_cast<int>(i));
+                        objects->push_back(object);
+                    }
+                    _apply(record, changes.items.data() + record.firstItem, object);
+                    if (record.scriptSize && object->script()) {
+                        scripted.emplace_back(object, &record);
+                    }
+                }
+
+                // snapshots refer to other objects, so they are restored once all of them exist
+                auto player = Game::getInstance()->player().get();
+                auto objectAt = [&mapObjects, player](uint32_t id) -> Object*
+                {
+                    if (id == PLAYER_OBJECT) {
+                        return player;
+                    }
+                    auto index = static_cast<size_t>(id - FIRST_OBJECT);
+                    return id >= FIRST_OBJECT && index < mapObjects.size() ? mapObjects[index] : nullptr;
+                };
+                for (auto& object : scripted) {
+                    auto first = changes.scripts.begin() + object.second->scriptOffset;
+                    std::vector<uint8_t> snapshot(first, first + object.second->scriptSize);
+                    try {
+                        object.first->script()->restore(snapshot, objectAt);
+                    } catch (const Exception& exception) {
+                        Logger::warning("SAVE") << location.name() << ": " << exception.what() << std::endl;
+                    }
+                }
+            }
+        }
+
+        void SaveFile::storeMap(Location& location, unsigned int elevation, const std::vector<Object*>& objects)
+        {
+            // only maps created through restoreMap() know their objects as loaded
+            auto pristineIt = _pristine.find(location.name());
+            if (pristineIt == _pristine.end() || elevation >= pristineIt->second.size()) {
+                return;
+            }
+            auto& pristine = pristineIt->second[elevation];
+
+            auto& map = _maps[location.name()];
+            _storeVariables(*location.MVARS(), map.MVARS);
+            if (map.elevations.size() < pristineIt->second.size()) {
+                map.elevations.resize(pristineIt->second.size());
+            }
+
+            // objects the game created have no id, scripts referring to them get no object back
+            auto objectId = [](Object* object) -> uint32_t
+            {
+                if (!object) {
+                    return NO_OBJECT;
+                }
+                if (object->type() == Object::Type::DUDE) {
+                    return PLAYER_OBJECT;
+                }
+                return object->mapIndex() >= 0 ? FIRST_OBJECT + static_cast<uint32_t>(object->mapIndex()) : NO_OBJECT;
+            };
+
+            ElevationState changes;
+            std::vector<bool> present(pristine.objects.size(), false);
+            std::vector<ItemRecord> items;
+            for (auto object : objects) {
+                if (object->type() == Object::Type::DUDE) {
+                    continue;
+                }
+                ObjectRecord record;
+                items.clear();
+                _capture(object, record, items);
+
+                // scripts without variables start over like on the first visit
+                std::vector<uint8_t> script;
+                if (object->script() && (!object->script()->LVARS()->empty() || object->script()->suspended())) {
+                    script = object->script()->snapshot(objectId);
+                }
+
+                auto index = static_cast<size_t>(record.mapIndex);
+                if (record.mapIndex >= 0 && index < pristine.objects.size() && pristine.objects[index].PID != -1) {
+                    present[index] = true;
+                    auto& loaded = pristine.objects[index];
+                    if (script.empty() && sameState(record, items.data(), loaded, pristine.items.data() + loaded.firstItem)) {
+                        continue;
+                    }
+                } else {
+                    record.mapIndex = -1;
+                }
+
+                record.firstItem = static_cast<uint32_t>(changes.items.size());
+                changes.items.insert(changes.items.end(), items.begin(), items.end());
+                record.scriptOffset = static_cast<uint32_t>(changes.scripts.size());
+                record.scriptSize = static_cast<uint32_t>(script.size());
+                changes.scripts.insert(changes.scripts.end(), script.begin(), script.end());
+                changes.objects.push_back(record);
+            }
+
+            for (size_t i = 0; i != pristine.objects.size(); ++i) {
+                if (!present[i] && pristine.objects[i].PID != -1) {
+                    ObjectRecord record;
+                    record.mapIndex = static_cast<int32_t>(i);
+                    record.flags = REMOVED;
+                    record.PID = pristine.objects[i].PID;
+                    changes.objects.push_back(record);
+                }
+            }
+
+            map.elevations[elevation] = std::move(changes);
+        }
+
+        void SaveFile::storeGlobals(VariableStore& GVARS, DudeObject& player, const std::string& map)
+        {
+            _storeVariables(GVARS, _GVARS);
+            _map = map;
+
+            _player = PlayerRecord();
+            _player.position = player.hexagon() ? static_cast<int32_t>(player.hexagon()->number()) : player.position();
+            _player.elevation = player.elevation();
+            _player.hitPoints = player.hitPoints();
+            _player.poisonLevel = player.poisonLevel();
+            _player.radiationLevel = player.radiationLevel();
+            _player.age = player.age();
+            _player.gender = static_cast<int32_t>(player.gender());
+            for (size_t i = 0; i != _player.stats.size(); ++i) {
+                _player.stats[i] = player.stat(static_cast<STAT>(i));
+                _player.statsBonus[i] = player.statBonus(static_cast<STAT>(i));
+            }
+            for (size_t i = 0; i != _player.skillsTagged.size(); ++i) {
+                _player.skillsTagged[i] = player.skillTagged(static_cast<SKILL>(i));
+                _player.skillsGainedValue[i] = player.skillGainedValue(static_cast<SKILL>(i));
+            }
+            for (size_t i = 0; i != _player.traitsTagged.size(); ++i) {
+                _player.traitsTagged[i] = player.traitTagged(static_cast<TRAIT>(i));
+            }
+
+            _playerItems.clear();
+            for (auto item : *player.inventory()) {
+                _playerItems.push_back({item->PID(), item->amount()});
+            }
+        }
+
+        void SaveFile::restoreGlobals(VariableStore& GVARS, DudeObject& player) const
+        {
+            if (_GVARS.size() == GVARS.size()) {
+                GVARS.assign(_GVARS);
+            }
+
+            player.setElevation(_player.elevation);
+            player.setPosition(_player.position);
+            player.setHitPoints(_player.hitPoints);
+            player.setPoisonLevel(_player.poisonLevel);
+            player.setRadiationLevel(_player.radiationLevel);
+            player.setAge(_player.age);
+            player.setGender(static_cast<GENDER>(_player.gender));
+            for (size_t i = 0; i != _player.stats.size(); ++i) {
+                player.setStat(static_cast<STAT>(i), _player.stats[i]);
+                player.setStatBonus(static_cast<STAT>(i), _player.statsBonus[i]);
+            }
+            for (size_t i = 0; i != _player.skillsTagged.size(); ++i) {
+                player.setSkillTagged(static_cast<SKILL>(i), _player.skillsTagged[i]);
+                player.setSkillGainedValue(static_cast<SKILL>(i), _player.skillsGainedValue[i]);
+            }
+            for (size_t i = 0; i != _player.traitsTagged.size(); ++i) {
+                player.setTraitTagged(static_cast<TRAIT>(i), _player.traitsTagged[i]);
+            }
+
+            fillInventory(player.inventory(), _playerItems.data(), static_cast<uint32_t>(_playerItems.size()));
+        }
+
+        const std::string& SaveFile::map() const
+        {
+            return _map;
+        }
+
+        void SaveFile::clear()
+        {
+            _GVARS.clear();
+            _player = PlayerRecord();
+            _playerItems.clear();
+            _map.clear();
+            _maps.clear();
+        }
+
+        // the journal holds what changed since the values were last stored or restored, which the copy already has
+        void SaveFile::_storeVariables(VariableStore& variables, std::vector<int32_t>& stored)
+        {
+            if (stored.size() == variables.size()) {
+                for (auto number : variables.changes()) {
+                    stored[number] = variables.get(number);
+                }
+            } else {
+                stored = variables.values();
+            }
+            variables.clearChanges();
+        }
+
+        SaveFile::SaveFile() = default;
+
+        // the pool runs the queued writes before joining, so quitting right after saving keeps the save
+        SaveFile::~SaveFile() = default;
+
+        bool SaveFile::write(const std::string& filename, bool compress, const Summary& summary)
+        {
+            // the file may still be written to by an earlier save
+            wait();
+            return _store(filename, _serialize(), compress) && _storeSummary(summaryFilename(filename), summary);
+        }
+
+        std::shared_future<bool> SaveFile::writeAsync(const std::string& filename, bool compress, Summary summary)
+        {
+            if (!_writer) {
+                _writer = std::make_unique<Base::ThreadPool>(1);
+            }
+            // the records are plain data, copying them is all the main thread does
+            auto body = std::make_shared<std::vector<uint8_t>>(_serialize());
+            auto stored = std::make_shared<Summary>(std::move(summary));
+            _pending = _writer->enqueue([filename, body, compress, stored]() {
+                return _store(filename, *body, compress) && _storeSummary(summaryFilename(filename), *stored);
+            }).share();
+            return _pending;
+        }
+
+        bool SaveFile::writing() const
+        {
+            return _pending.valid() && _pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+        }
+
+        void SaveFile::wait() const
+        {
+            // the single writer thread runs the writes in order, the last one finishing means all did
+            if (_pending.valid()) {
+                _pending.wait();
+            }
+        }
+
+        std::vector<uint8_t> SaveFile::_serialize() const
+        {
+            std::vector<uint8_t> body;
+            putArray(body, _GVARS);
+            put(body, _player);
+            putArray(body, _playerItems);
+            putString(body, _map);
+            put(body, static_cast<uint32_t>(_maps.size()));
+            for (auto& map : _maps) {
+                putString(body, map.first);
+                putArray(body, map.second.MVARS);
+                put(body, static_cast<uint32_t>(map.second.elevations.size()));
+                for (auto& elevation : map.second.elevations) {
+                    putArray(body, elevation.objects);
+                    putArray(body, elevation.items);
+                    putArray(body, elevation.scripts);
+                }
+            }
+            return body;
+        }
+
+        bool SaveFile::_store(const std::string& filename, const std::vector<uint8_t>& body, bool compress)
+        {
+            Header header;
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.flags = 0;
+            header.bodySize = body.size();
+
+            std::vector<uint8_t> compressed;
+            if (compress) {
+                // favours speed, the records compress well anyway
+                uLongf size = compressBound(static_cast<uLong>(body.size()));
+                compressed.resize(size);
+                if (compress2(compressed.data(), &size, body.data(), static_cast<uLong>(body.size()), Z_BEST_SPEED) == Z_OK
+                    && size < body.size()) {
+                    compressed.resize(size);
+                    header.flags |= COMPRESSED;
+                }
+            }
+            const auto& stored = (header.flags & COMPRESSED) ? compressed : body;
+            header.storedSize = stored.size();
+            return _replace(filename, &header, sizeof(header), stored);
+        }
+
+        bool SaveFile::_storeSummary(const std::string& filename, const Summary& summary)
+        {
+            // the map thumbnail is mostly black, it shrinks to a few kilobytes
+            std::vector<uint8_t> thumbnail;
+            if (!summary.thumbnail.empty()) {
+                uLongf size = compressBound(static_cast<uLong>(summary.thumbnail.size()));
+                thumbnail.resize(size);
+                if (compress2(thumbnail.data(), &size, summary.thumbnail.data(), static_cast<uLong>(summary.thumbnail.size()), Z_BEST_SPEED) != Z_OK) {
+                    return false;
+                }
+                thumbnail.resize(size);
+            }
+
+            std::vector<uint8_t> body;
+            putString(body, summary.name);
+            putString(body, summary.map);
+            put(body, summary.time);
+            put(body, summary.thumbnailWidth);
+            put(body, summary.thumbnailHeight);
+            put(body, static_cast<uint64_t>(summary.thumbnail.size()));
+            putArray(body, thumbnail);
+
+            Header header;
+            std::memcpy(header.magic, SUMMARY_MAGIC, sizeof(SUMMARY_MAGIC));
+            header.version = VERSION;
+            header.flags = 0;
+            header.bodySize = body.size();
+            header.storedSize = body.size();
+            return _replace(filename, &header, sizeof(header), body);
+        }
+
+        bool SaveFile::readSummary(const std::string& filename, Summary& summary)
+        {
+            std::ifstream stream(filename, std::ios_base::binary | std::ios_base::in);
+            if (!stream) {
+                return false;
+            }
+
+            Header header;
+            if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))
+                || std::memcmp(header.magic, SUMMARY_MAGIC, sizeof(SUMMARY_MAGIC)) != 0 || header.version != VERSION
+                || header.bodySize > MAX_COUNT || header.storedSize != header.bodySize) {
+                return false;
+            }
+            std::vector<uint8_t> body(header.bodySize);
+            if (!stream.read(reinterpret_cast<char*>(body.data()), body.size())) {
+                return false;
+            }
+
+            Reader reader(body);
+            Summary read;
+            uint64_t thumbnailSize = 0;
+            std::vector<uint8_t> thumbnail;
+            if (!reader.getString(read.name) || !reader.getString(read.map) || !reader.get(read.time)
+                || !reader.get(read.thumbnailWidth) || !reader.get(read.thumbnailHeight) || !reader.get(thumbnailSize)
+                || !reader.getArray(thumbnail) || !reader.finished()
+                || thumbnailSize != (uint64_t) read.thumbnailWidth * read.thumbnailHeight * 4 || thumbnailSize > MAX_COUNT) {
+                return false;
+            }
+            if (thumbnailSize) {
+                read.thumbnail.resize(thumbnailSize);
+                uLongf size = static_cast<uLongf>(thumbnailSize);
+                if (uncompress(read.thumbnail.data(), &size, thumbnail.data(), static_cast<uLong>(thumbnail.size())) != Z_OK
+                    || size != thumbnailSize) {
+                    return false;
+                }
+            }
+            summary = std::move(read);
+            return true;
+        }
+
+        bool SaveFile::_replace(const std::string& filename, const void* header, size_t headerSize, const std::vector<uint8_t>& body)
+        {
+            std::string temporaryPath = filename + ".tmp";
+            {
+                std::ofstream stream(temporaryPath, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+                if (!stream) {
+                    return false;
+                }
+                stream.write(static_cast<const char*>(header), headerSize);
+                stream.write(reinterpret_cast<const char*>(body.data()), body.size());
+                if (!stream) {
+                    return false;
+                }
+            }
+
+            std::error_code error;
+            std::filesystem::rename(temporaryPath, filename, error);
+            if (error) {
+                std::filesystem::remove(temporaryPath, error);
+                return false;
+            }
+            return true;
+        }
+
+        bool SaveFile::read(const std::string& filename)
+        {
+            wait();
+
+            std::ifstream stream(filename, std::ios_base::binary | std::ios_base::in);
+            if (!stream) {
+                return false;
+            }
+
+            Header header;
+            if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))
+                || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+                || header.bodySize > (uint64_t) MAX_COUNT * 16 || header.storedSize > header.bodySize) {
+                return false;
+            }
+
+            std::vector<uint8_t> body(header.storedSize);
+            if (!stream.read(reinterpret_cast<char*>(body.data()), body.size())) {
+                return false;
+            }
+            if (header.flags & COMPRESSED) {
+                std::vector<uint8_t> uncompressed(header.bodySize);
+                uLongf size = static_cast<uLongf>(uncompressed.size());
+                if (uncompress(uncompressed.data(), &size, body.data(), static_cast<uLong>(body.size())) != Z_OK
+                    || size != uncompressed.size()) {
+                    return false;
+                }
+                body.swap(uncompressed);
+            }
+
+            // read everything before replacing the state, a damaged file leaves it untouched
+            Reader reader(body);
+            std::vector<int32_t> GVARS;
+            PlayerRecord player;
+            std::vector<ItemRecord> playerItems;
+            std::string map;
+            uint32_t count = 0;
+            if (!reader.getArray(GVARS) || !reader.get(player) || !reader.getArray(playerItems)
+                || !reader.getString(map) || !reader.get(count) || count > MAX_COUNT) {
+                return false;
+            }
+            std::map<std::string, MapState> maps;
+            for (uint32_t i = 0; i != count; ++i) {
+                std::string name;
+                uint32_t elevations = 0;
+                MapState state;
+                if (!reader.getString(name) || !reader.getArray(state.MVARS) || !reader.get(elevations) || elevations > MAX_COUNT) {
+                    return false;
+                }
+                state.elevations.resize(elevations);
+                for (auto& elevation : state.elevations) {
+                    if (!reader.getArray(elevation.objects) || !reader.getArray(elevation.items) || !reader.getArray(elevation.scripts)) {
+                        return false;
+                    }
+                    for (auto& record : elevation.objects) {
+                        if (record.firstItem > elevation.items.size() || record.items > elevation.items.size() - record.firstItem
+                            || record.scriptOffset > elevation.scripts.size()
+                            || record.scriptSize > elevation.scripts.size() - record.scriptOffset) {
+                            return false;
+                        }
+                    }
+                }
+                maps[name] = std::move(state);
+            }
+            if (!reader.finished()) {
+                return false;
+            }
+
+            _GVARS = std::move(GVARS);
+            _player = player;
+            _playerItems = std::move(playerItems);
+            _map = std::move(map);
+            _maps = std::move(maps);
+            return true;
+        }
+
+        void SaveFile::_capture(Object* object, ObjectRecord& record, std::vector<ItemRecord>& items) const
+        {
+            record.mapIndex = object->mapIndex();
+            record.PID = object->PID();
+            record.FID = object->FID();
+            // objects on the map move between hexagons without updating the position they were loaded at
+            record.position = object->hexagon() ? static_cast<int32_t>(object->hexagon()->number()) : object->position();
+            record.orientation = static_cast<unsigned char>(object->orientation());
+            if (auto item = dynamic_cast<ItemObject*>(object)) {
+                record.amount = item->amount();
+            }
+            if (auto critter = dynamic_cast<CritterObject*>(object)) {
+                record.hitPoints = critter->hitPoints();
+            }
+
+            record.firstItem = static_cast<uint32_t>(items.size());
+            if (auto inventory = inventoryOf(object)) {
+                for (auto item : *inventory) {
+                    items.push_back({item->PID(), item->amount()});
+                }
+            }
+            record.items = static_cast<uint32_t>(items.size()) - record.firstItem;
+        }
+
+        void SaveFile::_apply(const ObjectRecord& record, const ItemRecord* items, Object* object) const
+        {
+            if (record.FID != object->FID()) {
+                object->setFID(record.FID);
+            }
+            object->setPosition(record.position);
+            object->setOrientation(static_cast<unsigned char>(record.orientation));
+            if (auto item = dynamic_cast<ItemObject*>(object)) {
+                item->setAmount(record.amount);
+            }
+            if (auto critter = dynamic_cast<CritterObject*>(object)) {
+                critter->setHitPoints(record.hitPoints);
+            }
+            if (auto inventory = inventoryOf(object)) {
+                fillInventory(inventory, items, record.items);
+            }
+        }
+    }
+}
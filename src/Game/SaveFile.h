@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        class ThreadPool;
+    }
+    namespace Game
+    {
+        class DudeObject;
+        class Location;
+        class Object;
+        class VariableStore;
+
+        /**
+         * @brief Binary save game
+         *
+         * Global variables and the player are stored in full. Of every visited map only the objects which differ from
+         * the .MAP file are stored, recorded whenever the player leaves the map, so the file grows with the changes
+         * rather than with the number of visited maps. Records are fixed size and copied in bulk, in the byte order
+         * of the machine. The body may be compressed with zlib.
+         *
+         * Writes may run on a writer thread of their own, the state is copied into a buffer before and may change
+         * meanwhile. Reading waits for the pending writes.
+         */
+        class SaveFile final
+        {
+            public:
+                static const uint32_t VERSION;
+
+                // Slots of the save and load screens, every one a file in the config directory
+                static const unsigned int SLOTS;
+
+                SaveFile();
+                ~SaveFile();
+
+                static std::string slotFilename(unsigned int slot);
+
+                // What the save and load screens show of a save. Written into a small file next to it,
+                // so listing the slots never reads a save itself
+                struct Summary
+                {
+                    std::string name;
+                    std::string map;
+                    // seconds since the epoch
+                    int64_t time = 0;
+                    uint32_t thumbnailWidth = 0;
+                    uint32_t thumbnailHeight = 0;
+                    // RGBA, zlib compressed in the file
+                    std::vector<uint8_t> thumbnail;
+                };
+
+                static std::string summaryFilename(const std::string& filename);
+
+                // False if the summary is missing, of another version or damaged
+                static bool readSummary(const std::string& filename, Summary& summary);
+
+                // State of an object compared with the one it had when its map was loaded
+                struct ObjectRecord
+                {
+                    // index of the object in its .MAP elevation, -1 for objects created in the game
+                    int32_t mapIndex = -1;
+                    uint32_t flags = 0;
+                    int32_t PID = -1;
+                    int32_t FID = -1;
+                    int32_t position = -1;
+                    int32_t orientation = 0;
+                    uint32_t amount = 0;
+                    int32_t hitPoints = 0;
+                    // items of the inventory and the script snapshot of the object, in the arrays of the elevation
+                    uint32_t firstItem = 0;
+                    uint32_t items = 0;
+                    uint32_t scriptOffset = 0;
+                    uint32_t scriptSize = 0;
+                };
+
+                struct ItemRecord
+                {
+                    int32_t PID = -1;
+                    uint32_t amount = 0;
+                };
+
+                struct PlayerRecord
+                {
+                    int32_t position = -1;
+                    int32_t orientation = 0;
+                    int32_t elevation = 0;
+                    int32_t hitPoints = 0;
+                    int32_t poisonLevel = 0;
+                    int32_t radiationLevel = 0;
+                    uint32_t age = 0;
+                    int32_t gender = 0;
+                    std::array<int32_t, 7> stats = {};
+                    std::array<int32_t, 7> statsBonus = {};
+                    std::array<int32_t, 18> skillsTagged = {};
+                    std::array<int32_t, 18> skillsGainedValue = {};
+                    std::array<int32_t, 16> traitsTagged = {};
+                };
+
+                // Remembers the objects of a location just created from its .MAP file, then applies the changes stored for it
+                void restoreMap(Location& location);
+
+                // Stores the changes of the objects on an elevation of the location, objects are the ones on it now
+                void storeMap(Location& location, unsigned int elevation, const std::vector<Object*>& objects);
+
+                // Only the variables changed since they were last stored or restored are copied
+                void storeGlobals(VariableStore& GVARS, DudeObject& player, const std::string& map);
+                void restoreGlobals(VariableStore& GVARS, DudeObject& player) const;
+
+                // Map the player was on when the globals were stored
+                const std::string& map() const;
+
+                // Forgets the stored maps, for a new game
+                void clear();
+
+                // The summary is written after the save, only if the save was
+                bool write(const std::string& filename, bool compress, const Summary& summary);
+
+                // Serializes the state at once, compresses and writes it on the writer thread
+                std::shared_future<bool> writeAsync(const std::string& filename, bool compress, Summary summary);
+
+                // Whether the last write is still running
+                bool writing() const;
+
+                void wait() const;
+
+                // Leaves the stored state untouched if the file is missing, of another version or damaged
+                bool read(const std::string& filename);
+
+            private:
+                struct ElevationState
+                {
+                    std::vector<ObjectRecord> objects;
+                    std::vector<ItemRecord> items;
+                    std::vector<uint8_t> scripts;
+                };
+
+                struct MapState
+                {
+                    std::vector<int32_t> MVARS;
+                    std::vector<ElevationState> elevations;
+                };
+
+                std::vector<int32_t> _GVARS;
+                PlayerRecord _player;
+                std::vector<ItemRecord> _playerItems;
+                std::string _map;
+                std::map<std::string, MapState> _maps;
+
+                // objects of the maps as loaded, by map index. Built from the .MAP files again, so never written
+                std::map<std::string, std::vector<ElevationState>> _pristine;
+
+                std::unique_ptr<Base::ThreadPool> _writer;
+                std::shared_future<bool> _pending;
+
+                std::vector<uint8_t> _serialize() const;
+                static bool _store(const std::string& filename, const std::vector<uint8_t>& body, bool compress);
+                static bool _storeSummary(const std::string& filename, const Summary& summary);
+                // Written next to the final file and renamed, so an interrupted write never breaks the previous one
+                static bool _replace(const std::string& filename, const void* header, size_t headerSize, const std::vector<uint8_t>& body);
+                static void _storeVariables(VariableStore& variables, std::vector<int32_t>& stored);
+
+                void _capture(Object* object, ObjectRecord& record, std::vector<ItemRecord>& items) const;
+                void _apply(const ObjectRecord& record, const ItemRecord* items, Object* object) const;
+        };
+    }
+}
@@ -11,6 +11,11 @@ namespace Falltergeist
             _type = Type::SCENERY;
         }
 
+        SceneryObject::Subtype SceneryObject::subtype() const
+        {
+            return _subtype;
+        }
+
         void SceneryObject::setSoundId(char soundId)
         {
             this->_soundId = soundId;
@@ -24,12 +24,14 @@ namespace Falltergeist
                 SceneryObject();
                 ~SceneryObject() = default;
 
+                Subtype subtype() const;
+
                 char soundId() const;
                 void setSoundId(char soundId);
 
             protected:
                 char _soundId = 0;
-                Subtype _subtype;
+                Subtype _subtype = Subtype::GENERIC;
         };
     }
 }
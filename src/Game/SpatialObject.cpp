@@ -13,10 +13,10 @@ namespace Falltergeist
 
         void SpatialObject::spatial_p_proc(Object *source)
         {
-            if (_script && _script->hasFunction("spatial_p_proc")) {
+            if (_script && _script->hasFunction(PROCEDURE::SPATIAL)) {
                 _script
                     ->setSourceObject(source)
-                    ->call("spatial_p_proc")
+                    ->call(PROCEDURE::SPATIAL)
                 ;
             }
         }
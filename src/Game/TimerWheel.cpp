@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <cmath>
+#include "../Game/TimerWheel.h"
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        TimerWheel::TimerWheel()
+        {
+            for (auto& level : _slots) {
+                level.fill(NONE);
+            }
+        }
+
+        TimerWheel::Id TimerWheel::add(float milliseconds, Callback callback, const void* owner, int param)
+        {
+            uint32_t index = _free;
+            if (index == NONE) {
+                index = static_cast<uint32_t>(_entries.size());
+                _entries.emplace_back();
+            } else {
+                _free = _entries[index].next;
+            }
+
+            // at least one millisecond, so timers added by a firing callback never fire in the same slot,
+            // and short of the time covered by all levels, which wraps around
+            double delay = std::ceil(std::max(static_cast<double>(milliseconds), 1.0));
+            delay = std::min(delay, static_cast<double>(MAX_DELAY));
+
+            auto& entry = _entries[index];
+            entry.expires = _now + static_cast<uint32_t>(delay);
+            entry.owner = owner;
+            entry.param = param;
+            entry.callback = std::move(callback);
+            if (owner) {
+                _link(_owners.emplace(owner, NONE).first->second, index, &Entry::ownerPrevious, &Entry::ownerNext);
+            }
+            _place(index);
+            _size++;
+            return (static_cast<Id>(entry.generation) << 32) | index;
+        }
+
+        bool TimerWheel::cancel(Id id)
+        {
+            auto index = static_cast<uint32_t>(id & NONE);
+            if (index >= _entries.size() || _entries[index].generation != static_cast<uint32_t>(id >> 32) || !_entries[index].slot) {
+                return false;
+            }
+            _release(index);
+            return true;
+        }
+
+        void TimerWheel::cancel(const void* owner)
+        {
+            auto it = _owners.find(owner);
+            while (it != _owners.end()) {
+                // releasing the last timer erases the owner
+                _release(it->second);
+                it = _owners.find(owner);
+            }
+        }
+
+        void TimerWheel::cancel(const void* owner, int param)
+        {
+            auto it = _owners.find(owner);
+            if (it == _owners.end()) {
+                return;
+            }
+            std::vector<uint32_t> matching;
+            uint32_t index = it->second;
+            do {
+                if (_entries[index].param == param) {
+                    matching.push_back(index);
+                }
+                index = _entries[index].ownerNext;
+            } while (index != it->second);
+
+            for (auto match : matching) {
+                _release(match);
+            }
+        }
+
+        void TimerWheel::clear()
+        {
+            for (uint32_t index = 0; index != _entries.size(); ++index) {
+                if (_entries[index].slot) {
+                    _release(index);
+                }
+            }
+        }
+
+        void TimerWheel::advance(float milliseconds)
+        {
+            _fraction += milliseconds;
+            auto steps = static_cast<uint32_t>(_fraction);
+            _fraction -= static_cast<float>(steps);
+
+            for (; steps > 0; --steps) {
+                _now++;
+                for (unsigned int level = 1; level != LEVELS; ++level) {
+                    // the slot reached is the first of the level above
+                    if ((_now >> ((level - 1) * SLOT_BITS)) & (SLOTS - 1)) {
+                        break;
+                    }
+                    _cascade(level);
+                }
+
+                auto& slot = _slots[0][_now & (SLOTS - 1)];
+                while (slot != NONE) {
+                    uint32_t index = slot;
+                    // the callback may add or cancel timers, so the entry is released before it is called
+                    auto callback = std::move(_entries[index].callback);
+                    _release(index);
+                    if (callback) {
+                        callback();
+                    }
+                }
+            }
+        }
+
+        size_t TimerWheel::size() const
+        {
+            return _size;
+        }
+
+        void TimerWheel::_place(uint32_t index)
+        {
+            auto& entry = _entries[index];
+            uint32_t delta = entry.expires - _now;
+            unsigned int level = 0;
+            while (level + 1 != LEVELS && delta >= (1u << ((level + 1) * SLOT_BITS))) {
+                level++;
+            }
+            auto& slot = _slots[level][(entry.expires >> (level * SLOT_BITS)) & (SLOTS - 1)];
+            entry.slot = &slot;
+            _link(slot, index, &Entry::previous, &Entry::next);
+        }
+
+        void TimerWheel::_release(uint32_t index)
+        {
+            auto& entry = _entries[index];
+            _unlink(*entry.slot, index, &Entry::previous, &Entry::next);
+            entry.slot = nullptr;
+            if (entry.owner) {
+                auto it = _owners.find(entry.owner);
+                _unlink(it->second, index, &Entry::ownerPrevious, &Entry::ownerNext);
+                if (it->second == NONE) {
+                    _owners.erase(it);
+                }
+            }
+            entry.owner = nullptr;
+            entry.callback = nullptr;
+            entry.generation++;
+            entry.next = _free;
+            _free = index;
+            _size--;
+        }
+
+        void TimerWheel::_cascade(unsigned int level)
+        {
+            auto& slot = _slots[level][(_now >> (level * SLOT_BITS)) & (SLOTS - 1)];
+            while (slot != NONE) {
+                uint32_t index = slot;
+                _unlink(slot, index, &Entry::previous, &Entry::next);
+                _place(index);
+            }
+        }
+
+        void TimerWheel::_link(uint32_t& head, uint32_t index, uint32_t Entry::*previous, uint32_t Entry::*next)
+        {
+            auto& entry = _entries[index];
+            if (head == NONE) {
+                head = index;
+                entry.*previous = index;
+                entry.*next = index;
+                return;
+            }
+            // appended, timers of a slot fire in the order they were added
+            uint32_t tail = _entries[head].*previous;
+            _entries[tail].*next = index;
+            entry.*previous = tail;
+            entry.*next = head;
+            _entries[head].*previous = index;
+        }
+
+        void TimerWheel::_unlink(uint32_t& head, uint32_t index, uint32_t Entry::*previous, uint32_t Entry::*next)
+        {
+            auto& entry = _entries[index];
+            if (entry.*next == index) {
+                head = NONE;
+            } else {
+                _entries[entry.*previous].*next = entry.*next;
+                _entries[entry.*next].*previous = entry.*previous;
+                if (head == index) {
+                    head = entry.*next;
+                }
+            }
+            entry.*previous = NONE;
+            entry.*next = NONE;
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        /**
+         * Hierarchical timer wheel with a resolution of one millisecond: four levels of 256 slots, every one covering
+         * 256 times the time of a slot of the level below. Timers expiring soon wait in the first level, later ones
+         * move down whenever a slot of their level is reached. Slots are intrusive lists, so adding and cancelling
+         * is O(1), and advancing only touches the passed slots and the timers due or moving down.
+         */
+        class TimerWheel final
+        {
+            public:
+                using Callback = std::function<void()>;
+
+                // 0 is never returned by add()
+                using Id = uint64_t;
+
+                TimerWheel();
+
+                TimerWheel(const TimerWheel&) = delete;
+
+                TimerWheel& operator=(const TimerWheel&) = delete;
+
+                // Calls the callback once, after the given time has passed. Owner and param only serve cancel()
+                Id add(float milliseconds, Callback callback, const void* owner = nullptr, int param = 0);
+
+                // Returns false if the timer already fired or was cancelled
+                bool cancel(Id id);
+
+                // Cancels every timer of the owner
+                void cancel(const void* owner);
+
+                // Cancels the timers of the owner added with the given param
+                void cancel(const void* owner, int param);
+
+                void clear();
+
+                // Fires the timers which are due, in the order they expire
+                void advance(float milliseconds);
+
+                size_t size() const;
+
+            private:
+                static constexpr unsigned int LEVELS = 4;
+                static constexpr unsigned int SLOT_BITS = 8;
+                static constexpr unsigned int SLOTS = 1 << SLOT_BITS;
+                static constexpr uint32_t NONE = 0xFFFFFFFF;
+                static constexpr uint32_t MAX_DELAY = 0xFF000000;
+
+                struct Entry
+                {
+                    uint32_t expires = 0;
+                    // bumped when the entry is released, so stale ids don't cancel its next timer
+                    uint32_t generation = 1;
+                    // circular lists of the slot and of the owner
+                    uint32_t previous = NONE;
+                    uint32_t next = NONE;
+                    uint32_t ownerPrevious = NONE;
+                    uint32_t ownerNext = NONE;
+                    uint32_t* slot = nullptr;
+                    const void* owner = nullptr;
+                    int param = 0;
+                    Callback callback;
+                };
+
+                std::vector<Entry> _entries;
+
+                // released entries, linked through next
+                uint32_t _free = NONE;
+
+                std::array<std::array<uint32_t, SLOTS>, LEVELS> _slots;
+
+                // first timer of every owner which has some
+                std::unordered_map<const void*, uint32_t> _owners;
+
+                uint32_t _now = 0;
+
+                float _fraction = 0.0f;
+
+                size_t _size = 0;
+
+                void _place(uint32_t index);
+
+                void _release(uint32_t index);
+
+                // Moves the timers of the slot of the level reached by the current time down
+                void _cascade(unsigned int level);
+
+                void _link(uint32_t& head, uint32_t index, uint32_t Entry::*previous, uint32_t Entry::*next);
+
+                void _unlink(uint32_t& head, uint32_t index, uint32_t Entry::*previous, uint32_t Entry::*next);
+        };
+    }
+}
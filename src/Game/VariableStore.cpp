@@ -0,0 +1,50 @@
+#include "../Game/VariableStore.h"
+#include "../Logger.h"
+#include "../VM/Script.h"
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        void VariableStore::assign(const std::vector<int32_t>& values)
+        {
+            _values = values;
+            _changed.assign(_values.size(), 0);
+            _changes.clear();
+            ++_revision;
+        }
+
+        const std::vector<int32_t>& VariableStore::values() const
+        {
+            return _values;
+        }
+
+        const std::vector<unsigned int>& VariableStore::changes() const
+        {
+            return _changes;
+        }
+
+        void VariableStore::clearChanges()
+        {
+            for (auto number : _changes) {
+                _changed[number] = 0;
+            }
+            _changes.clear();
+        }
+
+        void VariableStore::setTrace(const std::string& name)
+        {
+            _traceName = name;
+        }
+
+        void VariableStore::_trace(unsigned int number, int32_t from, int32_t to, VM::Script* source)
+        {
+            auto& log = Logger::info("SCRIPT");
+            log << _traceName << "[" << number << "] " << from << " -> " << to;
+            if (source) {
+                log << " by " << source->filename();
+            }
+            log << std::endl;
+        }
+    }
+}
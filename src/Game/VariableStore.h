@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Falltergeist
+{
+    namespace VM
+    {
+        class Script;
+    }
+    namespace Game
+    {
+        /**
+         * @brief Global or map variables of the scripts
+         *
+         * Values are kept in a plain array, reading one is a single load. Every variable changed since the journal
+         * was last cleared is listed once, in the order of its first change, so a save stores only those.
+         * With tracing on, each change is logged with the old and the new value and the script making it.
+         * The revision counts every change and is never reset, results computed from the values stay valid while it holds.
+         */
+        class VariableStore final
+        {
+            public:
+                // Replaces all the values and clears the journal
+                void assign(const std::vector<int32_t>& values);
+
+                unsigned int size() const
+                {
+                    return static_cast<unsigned int>(_values.size());
+                }
+
+                // Unchecked, number must be below size()
+                int32_t get(unsigned int number) const
+                {
+                    return _values[number];
+                }
+
+                // Unchecked like get(), storing the same value again is no change
+                void set(unsigned int number, int32_t value, VM::Script* source = nullptr)
+                {
+                    auto& stored = _values[number];
+                    if (stored == value) {
+                        return;
+                    }
+                    if (!_changed[number]) {
+                        _changed[number] = 1;
+                        _changes.push_back(number);
+                    }
+                    if (!_traceName.empty()) {
+                        _trace(number, stored, value, source);
+                    }
+                    stored = value;
+                    ++_revision;
+                }
+
+                uint64_t revision() const
+                {
+                    return _revision;
+                }
+
+                const std::vector<int32_t>& values() const;
+
+                // Numbers of the variables changed since the last clearChanges()
+                const std::vector<unsigned int>& changes() const;
+                void clearChanges();
+
+                // Logs the changes under the given name, GVAR or MVAR. Empty stops tracing
+                void setTrace(const std::string& name);
+
+            private:
+                std::vector<int32_t> _values;
+                std::vector<uint8_t> _changed;
+                std::vector<unsigned int> _changes;
+                std::string _traceName;
+                uint64_t _revision = 0;
+
+                void _trace(unsigned int number, int32_t from, int32_t to, VM::Script* source);
+        };
+    }
+}
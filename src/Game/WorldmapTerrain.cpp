@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <map>
+#include "../Format/Msk/File.h"
+#include "../Format/Txt/WorldmapFile.h"
+#include "../Game/WorldmapTerrain.h"
+#include "../ResourceManager.h"
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        using Format::Txt::WorldmapTile;
+
+        WorldmapTerrain::WorldmapTerrain(Format::Txt::WorldmapFile* worldmap) : _worldmap(worldmap)
+        {
+            auto& tiles = worldmap->tiles;
+            _columns = worldmap->numHorizontalTiles > 0 ? static_cast<unsigned int>(worldmap->numHorizontalTiles) : 1;
+            _rows = (static_cast<unsigned int>(tiles.size()) + _columns - 1) / _columns;
+
+            std::map<std::string, uint8_t> terrainIds;
+            for (auto& terrainType : worldmap->terrainTypes) {
+                if (_terrainNames.size() == NO_TERRAIN) {
+                    break;
+                }
+                terrainIds.emplace(terrainType.first, static_cast<uint8_t>(_terrainNames.size()));
+                _terrainNames.push_back(terrainType.first);
+                _travelDelays.push_back(terrainType.second.travelDelay);
+            }
+
+            _walkableStride = (width() + 63) / 64;
+            _walkable.assign(static_cast<size_t>(_walkableStride) * height(), 0);
+            _terrain.assign(static_cast<size_t>(_columns) * WorldmapTile::SUBTILES_X * _rows * WorldmapTile::SUBTILES_Y, NO_TERRAIN);
+
+            for (unsigned int i = 0; i != tiles.size(); ++i) {
+                auto& tile = tiles[i];
+                unsigned int left = (i % _columns) * TILE_WIDTH;
+                unsigned int top = (i / _columns) * TILE_HEIGHT;
+
+                auto name = tile.walkMaskName;
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                // a tile without a mask can be walked everywhere
+                auto mask = name.empty() ? nullptr : ResourceManager::getInstance()->mskFileType("data/" + name + ".msk");
+                for (unsigned int y = 0; y != TILE_HEIGHT; ++y) {
+                    auto row = &_walkable[static_cast<size_t>(top + y) * _walkableStride];
+                    for (unsigned int x = 0; x != TILE_WIDTH; ++x) {
+                        if (!mask || !mask->blocked(x, y)) {
+                            row[(left + x) / 64] |= uint64_t(1) << ((left + x) % 64);
+                        }
+                    }
+                }
+
+                for (int x = 0; x < WorldmapTile::SUBTILES_X; x++) {
+                    for (int y = 0; y < WorldmapTile::SUBTILES_Y; y++) {
+                        auto id = terrainIds.find(tile.subtiles[x][y].terrain);
+                        if (id == terrainIds.end()) {
+                            continue;
+                        }
+                        size_t column = (i % _columns) * WorldmapTile::SUBTILES_X + x;
+                        size_t line = (i / _columns) * WorldmapTile::SUBTILES_Y + y;
+                        _terrain[line * _columns * WorldmapTile::SUBTILES_X + column] = id->second;
+                    }
+                }
+            }
+        }
+
+        unsigned int WorldmapTerrain::width() const
+        {
+            return _columns * TILE_WIDTH;
+        }
+
+        unsigned int WorldmapTerrain::height() const
+        {
+            return _rows * TILE_HEIGHT;
+        }
+
+        bool WorldmapTerrain::walkable(int x, int y) const
+        {
+            if (!_inside(x, y)) {
+                return false;
+            }
+            return (_walkable[static_cast<size_t>(y) * _walkableStride + x / 64] >> (x % 64)) & 1;
+        }
+
+        uint8_t WorldmapTerrain::terrain(int x, int y) const
+        {
+            if (!_inside(x, y)) {
+                return NO_TERRAIN;
+            }
+            return _terrain[_subtileIndex(x, y)];
+        }
+
+        int WorldmapTerrain::travelDelay(int x, int y) const
+        {
+            auto id = terrain(x, y);
+            return id == NO_TERRAIN ? 0 : _travelDelays[id];
+        }
+
+        const Format::Txt::WorldmapSubtile* WorldmapTerrain::subtile(int x, int y) const
+        {
+            if (!_inside(x, y)) {
+                return nullptr;
+            }
+            auto tile = static_cast<size_t>(y / TILE_HEIGHT) * _columns + x / TILE_WIDTH;
+            if (tile >= _worldmap->tiles.size()) {
+                return nullptr;
+            }
+            return &_worldmap->tiles[tile].subtiles[(x % TILE_WIDTH) / SUBTILE_WIDTH][(y % TILE_HEIGHT) / SUBTILE_HEIGHT];
+        }
+
+        const std::vector<std::string>& WorldmapTerrain::terrainNames() const
+        {
+            return _terrainNames;
+        }
+
+        bool WorldmapTerrain::_inside(int x, int y) const
+        {
+            return x >= 0 && y >= 0 && static_cast<unsigned int>(x) < width() && static_cast<unsigned int>(y) < height();
+        }
+
+        size_t WorldmapTerrain::_subtileIndex(int x, int y) const
+        {
+            return static_cast<size_t>(y / SUBTILE_HEIGHT) * _columns * WorldmapTile::SUBTILES_X + x / SUBTILE_WIDTH;
+        }
+    }
+}
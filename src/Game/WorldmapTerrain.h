@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Falltergeist
+{
+    namespace Format
+    {
+        namespace Txt
+        {
+            class WorldmapFile;
+            struct WorldmapSubtile;
+        }
+    }
+    namespace Game
+    {
+        /**
+         * Walkability and terrain of the whole world map, decoded once from WORLDMAP.TXT and the walk masks of its tiles.
+         * Walkability is one bit per pixel, terrain one byte per subtile, so travel steps and path previews only read arrays.
+         * Coordinates are world map pixels, everything outside the map is blocked.
+         */
+        class WorldmapTerrain final
+        {
+            public:
+                static const uint8_t NO_TERRAIN = 0xFF;
+
+                WorldmapTerrain(Format::Txt::WorldmapFile* worldmap);
+
+                unsigned int width() const;
+                unsigned int height() const;
+
+                bool walkable(int x, int y) const;
+
+                // Index in terrainNames(), NO_TERRAIN outside the map or for unknown terrain
+                uint8_t terrain(int x, int y) const;
+
+                // Travel delay of the terrain at the point, 0 outside the map
+                int travelDelay(int x, int y) const;
+
+                // Subtile at the point, nullptr outside the map
+                const Format::Txt::WorldmapSubtile* subtile(int x, int y) const;
+
+                const std::vector<std::string>& terrainNames() const;
+
+            private:
+                // pixels of a tile and of one of its subtiles
+                static const unsigned int TILE_WIDTH = 350;
+                static const unsigned int TILE_HEIGHT = 300;
+                static const unsigned int SUBTILE_WIDTH = 50;
+                static const unsigned int SUBTILE_HEIGHT = 50;
+
+                Format::Txt::WorldmapFile* _worldmap;
+                unsigned int _columns = 0;
+                unsigned int _rows = 0;
+
+                // set bits are walkable, rows of the whole map padded to 64 pixels
+                std::vector<uint64_t> _walkable;
+                unsigned int _walkableStride = 0;
+
+                // by subtile, row by row over the whole map
+                std::vector<uint8_t> _terrain;
+                std::vector<int> _travelDelays;
+                std::vector<std::string> _terrainNames;
+
+                bool _inside(int x, int y) const;
+                size_t _subtileIndex(int x, int y) const;
+        };
+    }
+}
@@ -1,11 +1,30 @@
+#include <algorithm>
 #include "../Graphics/AnimatedPalette.h"
 
 namespace Falltergeist
 {
     namespace Graphics
     {
+        namespace
+        {
+            // colors the animated indexes cycle through, as RGBA
+            const uint32_t SLIME[4] = {0x006C00FF, 0x0B7307FF, 0x1B7B0FFF, 0x2B831BFF};
+            const uint32_t MONITORS[5] = {0x6B6B6FFF, 0x63677FFF, 0x576B8FFF, 0x0093A3FF, 0x6BBBFFFF};
+            const uint32_t FIRE_SLOW[5] = {0xFF0000FF, 0xD70000FF, 0x932B0BFF, 0xFF7700FF, 0xFF3B00FF};
+            const uint32_t FIRE_FAST[5] = {0x470000FF, 0x7B0000FF, 0xB30000FF, 0x7B0000FF, 0x470000FF};
+            const uint32_t SHORE[6] = {0x533F2BFF, 0x4B3B2BFF, 0x433727FF, 0x3F3327FF, 0x372F23FF, 0x332B23FF};
+
+            void cycle(uint32_t* colors, unsigned int first, const uint32_t* cycleColors, unsigned int count, unsigned int counter)
+            {
+                for (unsigned int i = 0; i != count; ++i) {
+                    colors[first + i] = cycleColors[(i + counter) % count];
+                }
+            }
+        }
+
         AnimatedPalette::AnimatedPalette()
         {
+            _updateCounters();
         }
 
         AnimatedPalette::~AnimatedPalette()
@@ -68,19 +87,45 @@ namespace Falltergeist
 
                 _blinkingRedCounter = _blinkingRed + _blinkingRedCounter;
             }
+
+            _updateCounters();
         }
 
-        std::vector<GLuint> AnimatedPalette::counters()
+        const std::vector<GLuint>& AnimatedPalette::counters() const
         {
-            std::vector<GLuint> cnt;
-            cnt.reserve(6);
-            cnt.push_back(_slimeCounter);
-            cnt.push_back(_monitorsCounter);
-            cnt.push_back(_fireSlowCounter);
-            cnt.push_back(_fireFastCounter);
-            cnt.push_back(_shoreCounter);
-            cnt.push_back(_blinkingRedCounter);
-            return cnt;
+            return _counters;
+        }
+
+        unsigned int AnimatedPalette::version() const
+        {
+            return _version;
+        }
+
+        void AnimatedPalette::animate(uint32_t* colors) const
+        {
+            cycle(colors, 229, SLIME, 4, _slimeCounter);
+            cycle(colors, 233, MONITORS, 5, _monitorsCounter);
+            cycle(colors, 238, FIRE_SLOW, 5, _fireSlowCounter);
+            cycle(colors, 243, FIRE_FAST, 5, _fireFastCounter);
+            cycle(colors, 248, SHORE, 6, _shoreCounter);
+            colors[254] = (static_cast<uint32_t>(_blinkingRedCounter * 4) << 24) | 0xFF;
+        }
+
+        void AnimatedPalette::_updateCounters()
+        {
+            const std::array<GLuint, 6> counters = {{
+                _slimeCounter,
+                _monitorsCounter,
+                _fireSlowCounter,
+                _fireFastCounter,
+                _shoreCounter,
+                _blinkingRedCounter
+            }};
+            if (_counters.size() == counters.size() && std::equal(counters.begin(), counters.end(), _counters.begin())) {
+                return;
+            }
+            _counters.assign(counters.begin(), counters.end());
+            _version++;
         }
     }
 }
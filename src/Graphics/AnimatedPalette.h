@@ -16,9 +16,16 @@ namespace Falltergeist
                 AnimatedPalette();
                 ~AnimatedPalette();
 
-                std::vector<GLuint> counters();
+                // Counters in the order of the shaders' cnt uniform, updated by think()
+                const std::vector<GLuint>& counters() const;
                 void think(const float &deltaTime);
 
+                // Changes whenever one of the counters does
+                unsigned int version() const;
+
+                // Writes the current colors of the animated indexes 229-254 into the 256 colors of a palette
+                void animate(uint32_t* colors) const;
+
             protected:
 
                 float _slimeMillisecondsTracked = 0;
@@ -34,6 +41,10 @@ namespace Falltergeist
                 float _blinkingRedMillisecondsTracked = 0;
                 unsigned char _blinkingRedCounter = 0;
                 short _blinkingRed = -1;
+                std::vector<GLuint> _counters;
+                unsigned int _version = 0;
+
+                void _updateCounters();
         };
     }
 }
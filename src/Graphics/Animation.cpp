@@ -1,10 +1,10 @@
-﻿#include <SDL_image.h>
+﻿#include <iterator>
+#include <unordered_map>
+#include <SDL_image.h>
 #include "../Format/Frm/File.h"
 #include "../Game/Game.h"
 #include "../Graphics/AnimatedPalette.h"
 #include "../Graphics/Animation.h"
-#include "../Graphics/IndexBuffer.h"
-#include "../Graphics/GLCheck.h"
 #include "../ResourceManager.h"
 #include "../State/Location.h"
 
@@ -14,13 +14,27 @@ namespace Falltergeist
     {
         using Game::Game;
 
-        Animation::Animation(const std::string &filename)
+        std::shared_ptr<const Animation::Geometry> Animation::_geometry(const std::string& filename)
         {
-            _texture = ResourceManager::getInstance()->texture(filename);
+            // animations are only created on the main thread, the geometry goes away with the last one using it
+            static std::unordered_map<std::string, std::weak_ptr<const Geometry>> cache;
+
+            auto it = cache.find(filename);
+            if (it != cache.end())
+            {
+                if (auto geometry = it->second.lock())
+                {
+                    return geometry;
+                }
+            }
+
+            auto geometry = std::make_shared<Geometry>();
+            geometry->texture = ResourceManager::getInstance()->pinTexture(filename);
 
             Format::Frm::File* frm = ResourceManager::getInstance()->frmFileType(filename);
 
-            _stride = frm->framesPerDirection();
+            geometry->stride = frm->framesPerDirection();
+            geometry->frames.reserve(frm->directions().size() * frm->framesPerDirection());
 
             int offsetX = 1;
             int offsetY = 1;
@@ -32,27 +46,13 @@ namespace Falltergeist
                 {
                     auto& srcFrame = direction.frames().at(f);
 
-                    _vertices.push_back(glm::vec2(0.0, 0.0));
-                    _vertices.push_back(glm::vec2(0.0, (float)srcFrame.height() + 2.0));
-                    _vertices.push_back(glm::vec2((float)srcFrame.width() + 2.0, 0.0));
-                    _vertices.push_back(glm::vec2((float)srcFrame.width() + 2.0, (float)srcFrame.height() + 2.0));
-
-                    _texCoords.push_back(glm::vec2(
-                        (float)(offsetX - 1.0) / (float)_texture->size().width(),
-                        (float)(offsetY - 1.0) / (float)_texture->size().height()
-                    ));
-                    _texCoords.push_back(glm::vec2(
-                        (float)(offsetX - 1.0) / (float)_texture->size().width(),
-                        (float)(offsetY + srcFrame.height() + 1.0) / (float)_texture->size().height()
-                    ));
-                    _texCoords.push_back(glm::vec2(
-                        (float)(offsetX + srcFrame.width() + 1.0) / (float)_texture->size().width(),
-                        (float)(offsetY - 1.0) / (float)_texture->size().height()
-                    ));
-                    _texCoords.push_back(glm::vec2(
-                        (float)(offsetX + srcFrame.width() + 1.0) / (float)_texture->size().width(),
-                        (float)(offsetY + srcFrame.height() + 1.0) / (float)_texture->size().height()
+                    Geometry::Frame frame;
+                    frame.size = glm::vec2((float)srcFrame.width() + 2.0, (float)srcFrame.height() + 2.0);
+                    frame.texCoords = geometry->texture->texCoords(Rectangle(
+                        Point(offsetX - 1, offsetY - 1),
+                        Size(srcFrame.width() + 2, srcFrame.height() + 2)
                     ));
+                    geometry->frames.push_back(frame);
 
                     offsetX += srcFrame.width()+2;
 
@@ -61,10 +61,24 @@ namespace Falltergeist
 
             }
 
+            // drop the entries of files nothing is animated with anymore
+            for (auto entry = cache.begin(); entry != cache.end();)
+            {
+                entry = entry->second.expired() ? cache.erase(entry) : std::next(entry);
+            }
+            cache[filename] = geometry;
+            return geometry;
+        }
+
+        Animation::Animation(const std::string &filename)
+        {
+            _frames = _geometry(filename);
+            _texture = _frames->texture.get();
+
             _shader = ResourceManager::getInstance()->shader("animation");
 
             _uniformTex = _shader->getUniform("tex");
-            if (Game::getInstance()->renderer()->renderPath() == Renderer::RenderPath::OGL21)
+            if (Game::getInstance()->renderer()->renderPath() != Renderer::RenderPath::OGL32)
             {
                 _uniformTexSize = _shader->getUniform("texSize");
             }
@@ -75,40 +89,18 @@ namespace Falltergeist
             _uniformTrans = _shader->getUniform("trans");
             _uniformOffset = _shader->getUniform("offset");
             _uniformOutline = _shader->getUniform("outline");
+            _uniformPalette = _shader->getUniform("palette");
+            _uniformIndexed = _shader->getUniform("indexed");
+            if (Game::getInstance()->renderer()->supportsFrameBuffers())
+            {
+                _uniformPick = _shader->getUniform("pick");
+            }
 
             _uniformTexStart = _shader->getUniform("texStart");
             _uniformTexHeight = _shader->getUniform("texHeight");
 
             _attribPos = _shader->getAttrib("Position");
             _attribTex = _shader->getAttrib("TexCoord");
-
-            _vertexArray = std::make_unique<VertexArray>();
-
-            _coordinatesVertexBuffer = std::make_unique<VertexBuffer>(
-                    &_vertices[0],
-                    _vertices.size() * sizeof(glm::vec2),
-                    VertexBuffer::UsagePattern::StaticDraw
-            );
-            VertexBufferLayout coordinatesVertexBufferLayout;
-            coordinatesVertexBufferLayout.addAttribute({
-                   (unsigned int) _attribPos,
-                   2,
-                   VertexBufferAttribute::Type::Float
-            });
-            _vertexArray->addBuffer(_coordinatesVertexBuffer, coordinatesVertexBufferLayout);
-
-            _textureCoordinatesVertexBuffer = std::make_unique<VertexBuffer>(
-                    &_texCoords[0],
-                    _texCoords.size() * sizeof(glm::vec2),
-                    VertexBuffer::UsagePattern::StaticDraw
-            );
-            VertexBufferLayout textureCoordinatesVertexBufferLayout;
-            textureCoordinatesVertexBufferLayout.addAttribute({
-                  (unsigned int) _attribTex,
-                  2,
-                  VertexBufferAttribute::Type::Float
-            });
-            _vertexArray->addBuffer(_textureCoordinatesVertexBuffer, textureCoordinatesVertexBufferLayout);
         }
 
         Animation::~Animation()
@@ -117,26 +109,17 @@ namespace Falltergeist
 
         void Animation::render(int x, int y, unsigned int direction, unsigned int frame, bool transparency, bool light, int outline, unsigned int lightValue)
         {
-            unsigned pos = direction * _stride + frame;
+            // skipped until its upload is done
+            if (!_texture->ready())
+            {
+                return;
+            }
+            auto& quad = _frames->frames.at(direction * _frames->stride + frame);
 
-            float texStart = _texCoords.at(pos*4).y;
-            float texEnd = _texCoords.at(pos*4+3).y;
+            float texStart = quad.texCoords.y;
+            float texEnd = quad.texCoords.w;
             float texHeight = texEnd-texStart;
 
-            _shader->use();
-
-            _texture->bind(0);
-
-            _shader->setUniform(_uniformTex, 0);
-
-            _shader->setUniform(_uniformOffset, glm::vec2((float)x, (float)y));
-
-            _shader->setUniform(_uniformMVP, Game::getInstance()->renderer()->getMVP());
-
-            _shader->setUniform(_uniformFade, Game::getInstance()->renderer()->fadeColor());
-
-            _shader->setUniform(_uniformCnt, Game::getInstance()->animatedPalette()->counters());
-
             int lightLevel = 100;
             if (light)
             {
@@ -148,29 +131,58 @@ namespace Falltergeist
                     lightLevel = lightValue / ((65536-655)/100);
                 }
             }
-            _shader->setUniform(_uniformLight, lightLevel);
-
-            _shader->setUniform(_uniformTrans, _trans);
-            _shader->setUniform(_uniformOutline, outline);
 
-            _shader->setUniform(_uniformTexStart, texStart);
-            _shader->setUniform(_uniformTexHeight, texHeight);
-            if (Game::getInstance()->renderer()->renderPath() == Renderer::RenderPath::OGL21)
+            auto renderer = Game::getInstance()->renderer();
+
+            SpriteBatch::State state;
+            state.shader = _shader;
+            state.texture = _texture;
+            state.palette = _texture->indexed() ? renderer->palette() : nullptr;
+            state.positionAttrib = _attribPos;
+            state.texCoordAttrib = _attribTex;
+            state.light = lightLevel;
+            state.trans = _trans;
+            state.outline = outline;
+            state.texStart = texStart;
+            state.texHeight = texHeight;
+            state.pick = renderer->pickId();
+
+            if (renderer->spriteBatch()->begin(state))
             {
-                _shader->setUniform(_uniformTexSize, glm::vec2((float)_texture->size().width(), (float)_texture->size().height()));
-            }
+                _shader->setUniform(_uniformTex, 0);
+                _shader->setUniform(_uniformPalette, 2);
+                _shader->setUniform(_uniformIndexed, _texture->indexed());
 
-            _vertexArray->bind();
+                // frame positions are batched in screen coordinates
+                _shader->setUniform(_uniformOffset, glm::vec2(0.0f, 0.0f));
 
-            unsigned int indexes[6] = {
-                (pos * 4), (pos * 4 + 1),
-                (pos * 4 + 2), (pos * 4 + 3),
-                (pos * 4 + 2), (pos * 4 + 1)
-            };
-            IndexBuffer indexBuffer(indexes, 6, IndexBuffer::UsagePattern::StaticDraw);
-            indexBuffer.bind();
+                _shader->setUniform(_uniformMVP, renderer->getMVP());
 
-            GL_CHECK(glDrawElements(GL_TRIANGLES, indexBuffer.count(), GL_UNSIGNED_INT, nullptr));
+                _shader->setUniform(_uniformFade, renderer->drawFadeColor());
+
+                _shader->setUniform(_uniformCnt, Game::getInstance()->animatedPalette()->counters());
+
+                _shader->setUniform(_uniformLight, lightLevel);
+
+                _shader->setUniform(_uniformTrans, _trans);
+                _shader->setUniform(_uniformOutline, outline);
+                if (_uniformPick != -1)
+                {
+                    _shader->setUniform(_uniformPick, static_cast<int>(state.pick));
+                }
+
+                _shader->setUniform(_uniformTexStart, texStart);
+                _shader->setUniform(_uniformTexHeight, texHeight);
+                if (renderer->renderPath() != Renderer::RenderPath::OGL32)
+                {
+                    _shader->setUniform(_uniformTexSize, glm::vec2((float)_texture->textureSize().width(), (float)_texture->textureSize().height()));
+                }
+            }
+
+            renderer->spriteBatch()->add(
+                glm::vec4((float)x, (float)y, (float)x + quad.size.x, (float)y + quad.size.y),
+                quad.texCoords
+            );
         }
 
         bool Animation::opaque(unsigned int x, unsigned int y)
@@ -1,8 +1,6 @@
 #pragma once
 
 #include <iosfwd>
-#include "../Graphics/VertexArray.h"
-#include "../Graphics/VertexBuffer.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Shader.h"
 #include "../Graphics/Texture.h"
@@ -23,16 +21,26 @@ namespace Falltergeist
                 void trans(Graphics::TransFlags::Trans _trans);
 
             private:
-                std::unique_ptr<VertexArray> _vertexArray;
-                std::unique_ptr<VertexBuffer> _coordinatesVertexBuffer;
-                std::unique_ptr<VertexBuffer> _textureCoordinatesVertexBuffer;
+                // Quads of every frame of an FRM, shared by all animations of the same file
+                struct Geometry
+                {
+                    struct Frame
+                    {
+                        glm::vec2 size;
+                        glm::vec4 texCoords;
+                    };
+
+                    std::shared_ptr<Texture> texture;
+                    unsigned int stride = 0;
+                    std::vector<Frame> frames;
+                };
+
+                static std::shared_ptr<const Geometry> _geometry(const std::string& filename);
+
+                std::shared_ptr<const Geometry> _frames;
                 Texture* _texture;
-                int _stride;
                 Graphics::TransFlags::Trans _trans = Graphics::TransFlags::Trans::NONE;
 
-                std::vector<glm::vec2> _vertices;
-                std::vector<glm::vec2> _texCoords;
-
                 GLint _uniformTex;
                 GLint _uniformTexSize;
                 GLint _uniformFade;
@@ -42,6 +50,9 @@ namespace Falltergeist
                 GLint _uniformTrans;
                 GLint _uniformOffset;
                 GLint _uniformOutline;
+                GLint _uniformPalette;
+                GLint _uniformIndexed;
+                GLint _uniformPick = -1;
                 GLint _uniformTexStart;
                 GLint _uniformTexHeight;
 
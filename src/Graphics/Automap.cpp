@@ -0,0 +1,144 @@
+#include "../Graphics/Automap.h"
+#include "../Graphics/Pixels.h"
+#include "../Graphics/Texture.h"
+#include "../PathFinding/Hexagon.h"
+#include "../PathFinding/HexagonGrid.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Falltergeist {
+    namespace Graphics {
+        namespace {
+            const uint8_t WALL_COLOR[4] = {0, 255, 0, 255};
+
+            const uint8_t SCENERY_COLOR[4] = {0, 128, 0, 255};
+
+            const uint8_t NO_COLOR[4] = {0, 0, 0, 0};
+
+            bool testBit(const std::vector<uint64_t>& bits, size_t index) {
+                return (bits[index / 64] >> (index % 64)) & 1;
+            }
+        }
+
+        Automap::Automap(HexagonGrid* grid, unsigned int scale) : _grid(grid), _scale(std::max(scale, 1u)) {
+            auto& region = _grid->region();
+            _size = Size(static_cast<int>(region.width * _scale), static_cast<int>(region.height * _scale + _scale / 2));
+
+            const size_t words = (_grid->size() + 63) / 64;
+            _revealed.assign(words, 0);
+            _plottedRevealed.assign(words, 0);
+            _plottedScenery.assign(words, 0);
+            _plottedWall.assign(words, 0);
+
+            _pixels.assign(static_cast<size_t>(_size.width()) * _size.height() * 4, 0);
+            _texture = std::make_shared<Texture>(Pixels(_pixels.data(), _size, Pixels::Format::RGBA));
+        }
+
+        Automap::~Automap() {
+        }
+
+        void Automap::reveal(Hexagon* hexagon, unsigned int radius) {
+            auto& region = _grid->region();
+            int left = std::max(static_cast<int>(hexagon->column()) - static_cast<int>(radius), static_cast<int>(region.left));
+            int right = std::min(hexagon->column() + radius, region.left + region.width - 1);
+            int top = std::max(static_cast<int>(hexagon->row()) - static_cast<int>(radius), static_cast<int>(region.top));
+            int bottom = std::min(hexagon->row() + radius, region.top + region.height - 1);
+            for (int row = top; row <= bottom; ++row) {
+                for (int column = left; column <= right; ++column) {
+                    auto other = _grid->at(static_cast<size_t>(row) * HexagonGrid::MAP_COLUMNS + column);
+                    if (other && _grid->distance(hexagon, other) <= radius) {
+                        _revealed[other->index() / 64] |= uint64_t(1) << (other->index() % 64);
+                    }
+                }
+            }
+        }
+
+        void Automap::update() {
+            auto& scenery = _grid->sceneryBits();
+            auto& wall = _grid->wallBits();
+            bool changed = false;
+            for (size_t word = 0; word != _revealed.size(); ++word) {
+                // bits of hexagons which weren't seen yet are only plotted once they are
+                uint64_t plotted = (_revealed[word] ^ _plottedRevealed[word])
+                    | (((scenery[word] ^ _plottedScenery[word]) | (wall[word] ^ _plottedWall[word])) & _revealed[word]);
+                _plottedRevealed[word] = _revealed[word];
+                _plottedScenery[word] = scenery[word];
+                _plottedWall[word] = wall[word];
+                changed = changed || plotted != 0;
+                while (plotted) {
+                    size_t index = word * 64 + static_cast<size_t>(__builtin_ctzll(plotted));
+                    plotted &= plotted - 1;
+                    _plot(index, testBit(_revealed, index), testBit(scenery, index), testBit(wall, index));
+                }
+            }
+            if (changed) {
+                _texture->update(Pixels(_pixels.data(), _size, Pixels::Format::RGBA));
+            }
+        }
+
+        Size Automap::size() const {
+            return _size;
+        }
+
+        std::vector<uint8_t> Automap::thumbnail(const Size& size) {
+            update();
+
+            std::vector<uint8_t> pixels(static_cast<size_t>(size.width()) * size.height() * 4, 0);
+            for (size_t i = 3; i < pixels.size(); i += 4) {
+                pixels[i] = 255;
+            }
+            // one scale for both axes, the map is centered and keeps its proportions
+            float scale = std::max((float) _size.width() / size.width(), (float) _size.height() / size.height());
+            int width = std::min(size.width(), (int) (_size.width() / scale));
+            int height = std::min(size.height(), (int) (_size.height() / scale));
+            if (width < 1 || height < 1) {
+                return pixels;
+            }
+            int left = (size.width() - width) / 2;
+            int top = (size.height() - height) / 2;
+            // every plotted pixel lands somewhere, walls win over scenery, so thin walls don't vanish when shrunk
+            for (int sourceY = 0; sourceY != _size.height(); ++sourceY) {
+                int y = std::min((int) (sourceY / scale), height - 1);
+                for (int sourceX = 0; sourceX != _size.width(); ++sourceX) {
+                    auto source = &_pixels[(static_cast<size_t>(sourceY) * _size.width() + sourceX) * 4];
+                    if (source[3] == 0) {
+                        continue;
+                    }
+                    int x = std::min((int) (sourceX / scale), width - 1);
+                    auto pixel = &pixels[(static_cast<size_t>(top + y) * size.width() + left + x) * 4];
+                    if (source[1] > pixel[1]) {
+                        std::memcpy(pixel, source, 4);
+                    }
+                }
+            }
+            return pixels;
+        }
+
+        std::shared_ptr<Texture> Automap::texture() const {
+            return _texture;
+        }
+
+        void Automap::_plot(size_t index, bool revealed, bool scenery, bool wall) {
+            auto hexagon = _grid->atIndex(index);
+            auto& region = _grid->region();
+            // columns run to the left on the screen
+            unsigned int column = region.left + region.width - 1 - hexagon->column();
+            unsigned int row = hexagon->row() - region.top;
+            unsigned int x = column * _scale;
+            unsigned int y = row * _scale + (hexagon->column() & 1 ? _scale / 2 : 0);
+
+            const uint8_t* color = NO_COLOR;
+            if (revealed && wall) {
+                color = WALL_COLOR;
+            } else if (revealed && scenery) {
+                color = SCENERY_COLOR;
+            }
+            for (unsigned int dy = 0; dy != _scale; ++dy) {
+                auto pixel = &_pixels[((static_cast<size_t>(y) + dy) * _size.width() + x) * 4];
+                for (unsigned int dx = 0; dx != _scale; ++dx) {
+                    std::memcpy(pixel + dx * 4, color, 4);
+                }
+            }
+        }
+    }
+}
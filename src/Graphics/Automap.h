@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../Graphics/Size.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Falltergeist {
+    class Hexagon;
+    class HexagonGrid;
+
+    namespace Graphics {
+        class Texture;
+
+        /**
+         * Walls and blocking scenery of the hexagons the player has seen, drawn into one texture from the bits of the
+         * hexagon grid. Hexagons are laid out by column and row like on the Fallout automap, every one a square
+         * of scale pixels, odd columns half a hexagon lower
+         * update() only plots the hexagons whose bits changed since the last call, so showing the map again
+         * after a door opened or a few steps of the player costs a handful of pixels and one upload
+         */
+        class Automap final {
+        public:
+            Automap(HexagonGrid* grid, unsigned int scale);
+
+            ~Automap();
+
+            // Marks the hexagons within radius of the hexagon as seen
+            void reveal(Hexagon* hexagon, unsigned int radius);
+
+            // Plots the changed hexagons and uploads the texture if any of them did
+            void update();
+
+            Size size() const;
+
+            // RGBA image of the given size with the whole map scaled into it, over black. For save game summaries
+            std::vector<uint8_t> thumbnail(const Size& size);
+
+            // Drawn by UI::Image, the texture is updated in place
+            std::shared_ptr<Texture> texture() const;
+
+        private:
+            HexagonGrid* _grid;
+
+            unsigned int _scale;
+
+            Size _size;
+
+            // one bit per hexagon by Hexagon::index(), what the pixels show now is kept to find the changes
+            std::vector<uint64_t> _revealed;
+
+            std::vector<uint64_t> _plottedRevealed;
+
+            std::vector<uint64_t> _plottedScenery;
+
+            std::vector<uint64_t> _plottedWall;
+
+            // RGBA
+            std::vector<uint8_t> _pixels;
+
+            std::shared_ptr<Texture> _texture;
+
+            void _plot(size_t index, bool revealed, bool scenery, bool wall);
+        };
+    }
+}
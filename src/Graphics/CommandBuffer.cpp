@@ -0,0 +1,128 @@
+#include "../Graphics/CommandBuffer.h"
+#include "../Graphics/GLCheck.h"
+#include <glm/gtc/type_ptr.hpp>
+
+namespace Falltergeist {
+    namespace Graphics {
+        CommandBuffer* CommandBuffer::_recording = nullptr;
+        const Shader* CommandBuffer::_recordingShader = nullptr;
+
+        CommandBuffer::~CommandBuffer() {
+            clear();
+        }
+
+        CommandBuffer* CommandBuffer::recording(const Shader* shader) {
+            return shader == _recordingShader ? _recording : nullptr;
+        }
+
+        void CommandBuffer::begin(const SpriteBatch::State& state) {
+            Batch batch;
+            batch.state = state;
+            batch.firstUniform = static_cast<uint32_t>(_uniforms.size());
+            batch.firstQuad = static_cast<uint32_t>(_vertices.size() / 4);
+            _batches.push_back(batch);
+
+            _recording = this;
+            _recordingShader = state.shader;
+        }
+
+        void CommandBuffer::uniform(GLint location, int i) {
+            _addUniform(location, UniformType::Int, static_cast<uint32_t>(_ints.size()), 1);
+            _ints.push_back(i);
+        }
+
+        void CommandBuffer::uniform(GLint location, const float* values, unsigned int count) {
+            _addUniform(location, UniformType::Float, static_cast<uint32_t>(_floats.size()), count);
+            _floats.insert(_floats.end(), values, values + count);
+        }
+
+        void CommandBuffer::uniform(GLint location, const glm::mat4& mat) {
+            _addUniform(location, UniformType::Matrix, static_cast<uint32_t>(_floats.size()), 16);
+            _floats.insert(_floats.end(), glm::value_ptr(mat), glm::value_ptr(mat) + 16);
+        }
+
+        void CommandBuffer::uniform(GLint location, const std::vector<GLuint>& vec) {
+            _addUniform(location, UniformType::IntArray, static_cast<uint32_t>(_ints.size()), static_cast<uint32_t>(vec.size()));
+            _ints.insert(_ints.end(), vec.begin(), vec.end());
+        }
+
+        void CommandBuffer::_addUniform(GLint location, UniformType type, uint32_t first, uint32_t count) {
+            _uniforms.push_back({location, type, first, count});
+            _batches.back().uniforms++;
+        }
+
+        void CommandBuffer::quad(const glm::vec4& position, const glm::vec4& texCoords) {
+            // same winding as the quad indexes: top left, bottom left, top right, bottom right
+            _vertices.push_back({glm::vec2(position.x, position.y), glm::vec2(texCoords.x, texCoords.y)});
+            _vertices.push_back({glm::vec2(position.x, position.w), glm::vec2(texCoords.x, texCoords.w)});
+            _vertices.push_back({glm::vec2(position.z, position.y), glm::vec2(texCoords.z, texCoords.y)});
+            _vertices.push_back({glm::vec2(position.z, position.w), glm::vec2(texCoords.z, texCoords.w)});
+            _batches.back().quads++;
+        }
+
+        bool CommandBuffer::empty() const {
+            return _vertices.empty();
+        }
+
+        uint32_t CommandBuffer::lastQuads() const {
+            return _batches.empty() ? 0 : _batches.back().quads;
+        }
+
+        const std::vector<CommandBuffer::Batch>& CommandBuffer::batches() const {
+            return _batches;
+        }
+
+        const std::vector<CommandBuffer::Vertex>& CommandBuffer::vertices() const {
+            return _vertices;
+        }
+
+        void CommandBuffer::applyUniforms(const Batch& batch) const {
+            for (uint32_t i = batch.firstUniform; i != batch.firstUniform + batch.uniforms; ++i) {
+                const auto& uniform = _uniforms[i];
+                switch (uniform.type) {
+                    case UniformType::Int:
+                        GL_CHECK(glUniform1i(uniform.location, _ints[uniform.first]));
+                        break;
+                    case UniformType::Float: {
+                        const float* values = &_floats[uniform.first];
+                        switch (uniform.count) {
+                            case 1:
+                                GL_CHECK(glUniform1fv(uniform.location, 1, values));
+                                break;
+                            case 2:
+                                GL_CHECK(glUniform2fv(uniform.location, 1, values));
+                                break;
+                            case 3:
+                                GL_CHECK(glUniform3fv(uniform.location, 1, values));
+                                break;
+                            default:
+                                GL_CHECK(glUniform4fv(uniform.location, 1, values));
+                                break;
+                        }
+                        break;
+                    }
+                    case UniformType::Matrix:
+                        GL_CHECK(glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &_floats[uniform.first]));
+                        break;
+                    case UniformType::IntArray:
+                        if (uniform.count) {
+                            GL_CHECK(glUniform1iv(uniform.location, static_cast<GLsizei>(uniform.count), &_ints[uniform.first]));
+                        }
+                        break;
+                }
+            }
+        }
+
+        void CommandBuffer::clear() {
+            _batches.clear();
+            _uniforms.clear();
+            _floats.clear();
+            _ints.clear();
+            _vertices.clear();
+            if (_recording == this) {
+                _recording = nullptr;
+                _recordingShader = nullptr;
+            }
+        }
+    }
+}
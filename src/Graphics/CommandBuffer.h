@@ -0,0 +1,90 @@
+#pragma once
+
+#include "../Graphics/SpriteBatch.h"
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+
+namespace Falltergeist {
+    namespace Graphics {
+        class Shader;
+
+        /**
+         * CommandBuffer holds the sprite batches of a frame as plain data: the state of every batch,
+         * the uniform values set for it and its quads. Recording doesn't touch GL, submitting is up to SpriteBatch
+         * While a batch is the last one begun, uniforms set on its shader are recorded into it instead of being uploaded
+         */
+        class CommandBuffer final {
+        public:
+            struct Vertex {
+                glm::vec2 position;
+                glm::vec2 texCoord;
+            };
+
+            struct Batch {
+                SpriteBatch::State state;
+                uint32_t firstUniform = 0;
+                uint32_t uniforms = 0;
+                uint32_t firstQuad = 0;
+                uint32_t quads = 0;
+            };
+
+            ~CommandBuffer();
+
+            // The buffer recording the uniforms of the shader, nullptr if they are to be uploaded at once
+            static CommandBuffer* recording(const Shader* shader);
+
+            // Starts a batch, uniforms of its shader are recorded into it until another batch is begun or clear()
+            void begin(const SpriteBatch::State& state);
+
+            void uniform(GLint location, int i);
+            void uniform(GLint location, const float* values, unsigned int count);
+            void uniform(GLint location, const glm::mat4& mat);
+            void uniform(GLint location, const std::vector<GLuint>& vec);
+
+            // Adds a quad to the last batch, both vectors are (left, top, right, bottom)
+            void quad(const glm::vec4& position, const glm::vec4& texCoords);
+
+            bool empty() const;
+
+            // Quads of the last batch, 0 if there is none
+            uint32_t lastQuads() const;
+
+            const std::vector<Batch>& batches() const;
+
+            const std::vector<Vertex>& vertices() const;
+
+            // Uploads the uniforms recorded for the batch, its shader has to be in use
+            void applyUniforms(const Batch& batch) const;
+
+            void clear();
+
+        private:
+            enum class UniformType {
+                Int,
+                Float,
+                Matrix,
+                IntArray
+            };
+
+            struct Uniform {
+                GLint location;
+                UniformType type;
+                uint32_t first;
+                uint32_t count;
+            };
+
+            static CommandBuffer* _recording;
+            static const Shader* _recordingShader;
+
+            std::vector<Batch> _batches;
+            std::vector<Uniform> _uniforms;
+            std::vector<float> _floats;
+            std::vector<GLint> _ints;
+            std::vector<Vertex> _vertices;
+
+            void _addUniform(GLint location, UniformType type, uint32_t first, uint32_t count);
+        };
+    }
+}
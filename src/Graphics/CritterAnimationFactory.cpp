@@ -1,23 +1,34 @@
 #include "../Graphics/CritterAnimationFactory.h"
+#include "../Exception.h"
 #include "../Helpers/CritterAnimationHelper.h"
 #include "../Game/Defines.h"
+#include "../ResourceManager.h"
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Falltergeist
 {
     namespace Graphics
     {
-        std::unique_ptr<UI::Animation> CritterAnimationFactory::buildActionAnimation(uint32_t armorFID, uint32_t weaponId, const std::string &action, Game::Orientation orientation)
+        namespace
         {
-            Helpers::CritterAnimationHelper critterAnimationHelper;
-            std::string animName = critterAnimationHelper.getPrefix(armorFID);
+            // Names of critter animations by armor, weapon and action, built once per combination
+            std::unordered_map<uint64_t, std::string> frmNames;
 
-            if (action == "aa") {
-                animName += critterAnimationHelper.getSuffix(ANIM_STAND, weaponId);
-            } else {
-                animName += action;
-            }
+            std::mutex frmNamesMutex;
+
+            // Armor and weapon combinations whose animation sets were requested, main thread only
+            std::unordered_set<uint64_t> prefetchedSets;
 
-            auto animation = std::make_unique<UI::Animation>("art/critters/" + animName + ".frm", orientation);
+            // Actions of an animation set besides standing
+            const uint32_t SET_ACTIONS[] = {ANIM_WALK, ANIM_RUNNING, ANIM_HIT_FROM_FRONT, ANIM_HIT_FROM_BACK, ANIM_FALL_BACK, ANIM_FALL_FRONT};
+        }
+
+        std::unique_ptr<UI::Animation> CritterAnimationFactory::buildActionAnimation(uint32_t armorFID, uint32_t weaponId, const std::string &action, Game::Orientation orientation)
+        {
+            prefetchAnimationSet(armorFID, weaponId);
+            auto animation = std::make_unique<UI::Animation>(_frmName(armorFID, weaponId, action), orientation);
             // TODO move it elsewhere
             //animation->animationEndedHandler().add([&animation](Event::Event* event) {
             //    animation->setCurrentFrame(0);
@@ -49,5 +60,49 @@ namespace Falltergeist
             std::string action = critterAnimationHelper.getSuffix(ANIM_RUNNING, weaponId);
             return buildActionAnimation(armorFID, weaponId, action, orientation);
         }
+    
+        void CritterAnimationFactory::prefetchAnimationSet(uint32_t armorFID, uint32_t weaponId)
+        {
+            uint64_t key = (static_cast<uint64_t>(armorFID) << 32) | weaponId;
+            if (!prefetchedSets.insert(key).second) {
+                return;
+            }
+
+            Helpers::CritterAnimationHelper critterAnimationHelper;
+            auto resourceManager = ResourceManager::getInstance();
+            resourceManager->requestFrm(_frmName(armorFID, weaponId, "aa"));
+            for (auto action : SET_ACTIONS) {
+                resourceManager->requestFrm(_frmName(armorFID, weaponId, critterAnimationHelper.getSuffix(action, weaponId)));
+            }
+        }
+
+        const std::string& CritterAnimationFactory::_frmName(uint32_t armorFID, uint32_t weaponId, const std::string &action)
+        {
+            // actions are two letter codes, up to four letters are packed into the key along with armor and weapon
+            if (action.size() > 4) {
+                throw Exception("CritterAnimationFactory - unsupported action: " + action);
+            }
+            uint64_t key = (static_cast<uint64_t>(armorFID & 0x00000FFF) << 48) | (static_cast<uint64_t>(weaponId & 0xFFFF) << 32);
+            for (size_t i = 0; i != action.size(); ++i) {
+                key |= static_cast<uint64_t>(static_cast<unsigned char>(action[i])) << (i * 8);
+            }
+
+            std::lock_guard<std::mutex> lock(frmNamesMutex);
+            auto it = frmNames.find(key);
+            if (it != frmNames.end()) {
+                return it->second;
+            }
+
+            Helpers::CritterAnimationHelper critterAnimationHelper;
+            std::string animName = critterAnimationHelper.getPrefix(armorFID);
+
+            if (action == "aa") {
+                animName += critterAnimationHelper.getSuffix(ANIM_STAND, weaponId);
+            } else {
+                animName += action;
+            }
+
+            return frmNames.emplace(key, "art/critters/" + animName + ".frm").first->second;
+        }
     }
 }
@@ -17,6 +17,15 @@ namespace Falltergeist
                 std::unique_ptr<UI::Animation> buildStandingAnimation(uint32_t armorFID, uint32_t weaponId, Game::Orientation orientation);
                 std::unique_ptr<UI::Animation> buildWalkingAnimation(uint32_t armorFID, uint32_t weaponId, Game::Orientation orientation);
                 std::unique_ptr<UI::Animation> buildRunningAnimation(uint32_t armorFID, uint32_t weaponId, Game::Orientation orientation);
+
+                // Starts loading the animations a critter with this armor and weapon commonly switches between
+                // (standing, walking, running, getting hit and falling) together in the background, once per combination,
+                // so building them later doesn't have to wait for disk. Building any animation of a set prefetches it.
+                void prefetchAnimationSet(uint32_t armorFID, uint32_t weaponId);
+
+            private:
+                // The returned name is kept for later calls with the same arguments
+                const std::string& _frmName(uint32_t armorFID, uint32_t weaponId, const std::string &action);
         };
     }
 }
@@ -8,7 +8,7 @@ namespace Falltergeist {
     namespace Graphics {
         AAF::AAF(const std::string &filename) : Font() {
             _filename = filename;
-            _aaf = ResourceManager::getInstance()->aafFileType(filename);
+            _aaf = ResourceManager::getInstance()->pin(ResourceManager::getInstance()->aafFileType(filename));
 
             unsigned int width = (_aaf->maximumWidth() + 2) * 16u;
             unsigned int height = (_aaf->maximumHeight() + 2) * 16u;
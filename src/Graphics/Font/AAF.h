@@ -21,7 +21,7 @@ namespace Falltergeist
                 unsigned short glyphWidth(uint8_t ch) override;
 
             private:
-                Format::Aaf::File* _aaf = nullptr;
+                std::shared_ptr<Format::Aaf::File> _aaf;
         };
     }
 }
@@ -8,7 +8,7 @@ namespace Falltergeist {
     namespace Graphics {
         FON::FON(const std::string &filename) : Font() {
             _filename = filename;
-            _fon = ResourceManager::getInstance()->fonFileType(filename);
+            _fon = ResourceManager::getInstance()->pin(ResourceManager::getInstance()->fonFileType(filename));
 
             unsigned int width = (_fon->maximumWidth() + 2) * 16u;
             unsigned int height = (_fon->maximumHeight() + 2) * 16u;
@@ -21,7 +21,7 @@ namespace Falltergeist
                 unsigned short glyphWidth(uint8_t ch) override;
 
             private:
-                Format::Fon::File* _fon = nullptr;
+                std::shared_ptr<Format::Fon::File> _fon;
         };
     }
 }
@@ -0,0 +1,60 @@
+#include "../Exception.h"
+#include "../Graphics/FrameBuffer.h"
+#include "../Graphics/GLCheck.h"
+#include "../Graphics/GLState.h"
+#include "../Graphics/Pixels.h"
+#include "../Graphics/Texture.h"
+#include <algorithm>
+
+namespace Falltergeist {
+    namespace Graphics {
+        FrameBuffer::FrameBuffer(const Size& size) : _size(size) {
+            _texture = std::make_unique<Texture>(Pixels(nullptr, size, Pixels::Format::RGBA));
+
+            auto state = GLState::current();
+            GLuint previous = state->framebuffer();
+            GL_CHECK(glGenFramebuffers(1, &_id));
+            state->bindFramebuffer(_id);
+            GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture->id(), 0));
+            GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+            state->bindFramebuffer(previous);
+            if (status != GL_FRAMEBUFFER_COMPLETE) {
+                GL_CHECK(glDeleteFramebuffers(1, &_id));
+                throw Exception("Framebuffer is incomplete");
+            }
+        }
+
+        FrameBuffer::~FrameBuffer() {
+            if (auto state = GLState::current()) {
+                if (state->framebuffer() == _id) {
+                    state->bindFramebuffer(0);
+                }
+            }
+            glDeleteFramebuffers(1, &_id);
+        }
+
+        void FrameBuffer::bind() {
+            auto state = GLState::current();
+            std::copy(state->viewport(), state->viewport() + 4, _viewport);
+            _previous = state->framebuffer();
+            state->bindFramebuffer(_id);
+            state->setViewport(0, 0, _size.width(), _size.height());
+            GL_CHECK(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+            GL_CHECK(glClear(GL_COLOR_BUFFER_BIT));
+        }
+
+        void FrameBuffer::unbind() {
+            auto state = GLState::current();
+            state->bindFramebuffer(_previous);
+            state->setViewport(_viewport[0], _viewport[1], _viewport[2], _viewport[3]);
+        }
+
+        const Texture* FrameBuffer::texture() const {
+            return _texture.get();
+        }
+
+        const Size& FrameBuffer::size() const {
+            return _size;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../Graphics/Size.h"
+#include <GL/glew.h>
+#include <memory>
+
+namespace Falltergeist {
+    namespace Graphics {
+        class Texture;
+
+        /**
+         * Offscreen render target with a color texture
+         * Rendering into it uses the screen projection, so the texture is upside down compared to the screen
+         */
+        class FrameBuffer final {
+        public:
+            FrameBuffer(const Size& size);
+
+            ~FrameBuffer();
+
+            FrameBuffer(const FrameBuffer&) = delete;
+
+            FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+            // Redirects rendering into the texture and clears it to transparent
+            void bind();
+
+            // Restores rendering to the target bound before, the screen or the frame being composed
+            void unbind();
+
+            const Texture* texture() const;
+
+            const Size& size() const;
+
+        private:
+            GLuint _id = 0;
+
+            Size _size;
+
+            std::unique_ptr<Texture> _texture;
+
+            GLint _viewport[4] = {0, 0, 0, 0};
+
+            GLuint _previous = 0;
+        };
+    }
+}
@@ -4,11 +4,20 @@
 #include <cstdio>
 #include <GL/glew.h>
 
+namespace Falltergeist {
+    namespace Graphics {
+        // glGetError() after every call stalls the pipeline of some mobile drivers, the GLES path turns it off
+        inline bool glCheckErrors = true;
+    }
+}
+
 #define GL_CHECK(x) do { \
             x; \
-            int _err = glGetError(); \
-            if (_err) { \
-                printf("GL Error %d at %d, %s in %s", _err, __LINE__, __func__, __FILE__); \
-                exit(-1); \
+            if (Falltergeist::Graphics::glCheckErrors) { \
+                int _err = glGetError(); \
+                if (_err) { \
+                    printf("GL Error %d at %d, %s in %s", _err, __LINE__, __func__, __FILE__); \
+                    exit(-1); \
+                } \
             } \
         } while (0)
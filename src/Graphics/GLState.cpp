@@ -0,0 +1,154 @@
+#include "../Graphics/GLState.h"
+#include "../Graphics/GLCheck.h"
+#include "../Graphics/RenderStats.h"
+
+namespace Falltergeist {
+    namespace Graphics {
+        GLState* GLState::_current = nullptr;
+
+        GLState::GLState() {
+            _current = this;
+        }
+
+        GLState::~GLState() {
+            if (_current == this) {
+                _current = nullptr;
+            }
+        }
+
+        GLState* GLState::current() {
+            return _current;
+        }
+
+        void GLState::bindTexture(unsigned int unit, GLuint texture) {
+            if (unit >= _textures.size()) {
+                _textures.resize(unit + 1, 0);
+            }
+            if (_textures[unit] == texture) {
+                return;
+            }
+            if (_activeUnit != unit) {
+                GL_CHECK(glActiveTexture(GL_TEXTURE0 + unit));
+                _activeUnit = unit;
+            }
+            GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+            _textures[unit] = texture;
+            RenderStats::textureBind();
+        }
+
+        void GLState::bindTextureArray(unsigned int unit, GLuint texture) {
+            if (unit >= _textureArrays.size()) {
+                _textureArrays.resize(unit + 1, 0);
+            }
+            if (_textureArrays[unit] == texture) {
+                return;
+            }
+            if (_activeUnit != unit) {
+                GL_CHECK(glActiveTexture(GL_TEXTURE0 + unit));
+                _activeUnit = unit;
+            }
+            GL_CHECK(glBindTexture(GL_TEXTURE_2D_ARRAY, texture));
+            _textureArrays[unit] = texture;
+            RenderStats::textureBind();
+        }
+
+        void GLState::useProgram(GLuint program) {
+            if (_program != program) {
+                GL_CHECK(glUseProgram(program));
+                _program = program;
+            }
+        }
+
+        void GLState::bindVertexArray(GLuint vertexArray) {
+            if (_vertexArray != vertexArray) {
+                GL_CHECK(glBindVertexArray(vertexArray));
+                _vertexArray = vertexArray;
+            }
+        }
+
+        void GLState::setBlend(bool enabled) {
+            if (_blend == enabled) {
+                return;
+            }
+            if (enabled) {
+                GL_CHECK(glEnable(GL_BLEND));
+            } else {
+                GL_CHECK(glDisable(GL_BLEND));
+            }
+            _blend = enabled;
+        }
+
+        void GLState::setBlendFunc(GLenum source, GLenum destination) {
+            if (_blendSource != source || _blendDestination != destination
+                || _blendSourceAlpha != source || _blendDestinationAlpha != destination) {
+                GL_CHECK(glBlendFunc(source, destination));
+                _blendSource = _blendSourceAlpha = source;
+                _blendDestination = _blendDestinationAlpha = destination;
+            }
+        }
+
+        void GLState::setBlendFuncSeparate(GLenum sourceRGB, GLenum destinationRGB, GLenum sourceAlpha, GLenum destinationAlpha) {
+            if (_blendSource != sourceRGB || _blendDestination != destinationRGB
+                || _blendSourceAlpha != sourceAlpha || _blendDestinationAlpha != destinationAlpha) {
+                GL_CHECK(glBlendFuncSeparate(sourceRGB, destinationRGB, sourceAlpha, destinationAlpha));
+                _blendSource = sourceRGB;
+                _blendDestination = destinationRGB;
+                _blendSourceAlpha = sourceAlpha;
+                _blendDestinationAlpha = destinationAlpha;
+            }
+        }
+
+        void GLState::bindFramebuffer(GLuint framebuffer) {
+            if (_framebuffer != framebuffer) {
+                GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+                _framebuffer = framebuffer;
+            }
+        }
+
+        GLuint GLState::framebuffer() const {
+            return _framebuffer;
+        }
+
+        void GLState::setViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+            if (_viewport[0] != x || _viewport[1] != y || _viewport[2] != width || _viewport[3] != height) {
+                GL_CHECK(glViewport(x, y, width, height));
+                _viewport[0] = x;
+                _viewport[1] = y;
+                _viewport[2] = width;
+                _viewport[3] = height;
+            }
+        }
+
+        const GLint* GLState::viewport() const {
+            return _viewport;
+        }
+
+        void GLState::forgetTexture(GLuint texture) {
+            // GL unbinds deleted textures from every unit
+            for (auto& bound : _textures) {
+                if (bound == texture) {
+                    bound = 0;
+                }
+            }
+            for (auto& bound : _textureArrays) {
+                if (bound == texture) {
+                    bound = 0;
+                }
+            }
+        }
+
+        void GLState::forgetProgram(GLuint program) {
+            // a deleted program stays in use until another one is installed, only the name is unreliable now
+            if (_program == program) {
+                GL_CHECK(glUseProgram(0));
+                _program = 0;
+            }
+        }
+
+        void GLState::forgetVertexArray(GLuint vertexArray) {
+            if (_vertexArray == vertexArray) {
+                _vertexArray = 0;
+            }
+        }
+    }
+}
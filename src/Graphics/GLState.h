@@ -0,0 +1,87 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+namespace Falltergeist {
+    namespace Graphics {
+        /**
+         * GLState mirrors the GL state which is changed while rendering and skips redundant changes
+         * without querying the driver. It is owned by the renderer and starts from the state of a fresh context,
+         * so everything changing the cached state has to go through it.
+         */
+        class GLState final {
+        public:
+            GLState();
+
+            ~GLState();
+
+            GLState(const GLState&) = delete;
+
+            GLState& operator=(const GLState&) = delete;
+
+            // Cache of the current context, nullptr if there is no renderer
+            static GLState* current();
+
+            void bindTexture(unsigned int unit, GLuint texture);
+
+            void bindTextureArray(unsigned int unit, GLuint texture);
+
+            void useProgram(GLuint program);
+
+            void bindVertexArray(GLuint vertexArray);
+
+            void setBlend(bool enabled);
+
+            void setBlendFunc(GLenum source, GLenum destination);
+
+            void setBlendFuncSeparate(GLenum sourceRGB, GLenum destinationRGB, GLenum sourceAlpha, GLenum destinationAlpha);
+
+            // Framebuffers and viewports are restored from the cache, so nesting render targets doesn't query GL
+            void bindFramebuffer(GLuint framebuffer);
+
+            GLuint framebuffer() const;
+
+            void setViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+            // (x, y, width, height), zero until set
+            const GLint* viewport() const;
+
+            // Deleted names may be reused by GL, so cached bindings of them have to be forgotten
+            void forgetTexture(GLuint texture);
+
+            void forgetProgram(GLuint program);
+
+            void forgetVertexArray(GLuint vertexArray);
+
+        private:
+            static GLState* _current;
+
+            // bound GL_TEXTURE_2D per texture unit
+            std::vector<GLuint> _textures;
+
+            // bound GL_TEXTURE_2D_ARRAY per texture unit
+            std::vector<GLuint> _textureArrays;
+
+            unsigned int _activeUnit = 0;
+
+            GLuint _program = 0;
+
+            GLuint _vertexArray = 0;
+
+            bool _blend = false;
+
+            GLenum _blendSource = GL_ONE;
+
+            GLenum _blendDestination = GL_ZERO;
+
+            GLenum _blendSourceAlpha = GL_ONE;
+
+            GLenum _blendDestinationAlpha = GL_ZERO;
+
+            GLuint _framebuffer = 0;
+
+            GLint _viewport[4] = {0, 0, 0, 0};
+        };
+    }
+}
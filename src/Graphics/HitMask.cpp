@@ -0,0 +1,46 @@
+#include "../Graphics/HitMask.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace Falltergeist {
+    namespace Graphics {
+        HitMask::HitMask(const Size& size) : _size(size) {
+            if (size.width() > UINT16_MAX || size.height() < 0) {
+                throw std::logic_error("HitMask size is out of range");
+            }
+            _wordsPerRow = (static_cast<unsigned int>(size.width()) + 63) / 64;
+            _bits.resize(static_cast<size_t>(_wordsPerRow) * size.height(), 0);
+            _spans.resize(size.height(), {UINT16_MAX, 0});
+        }
+
+        void HitMask::setOpaque(unsigned int x, unsigned int y) {
+            if (x >= (unsigned int)_size.width() || y >= (unsigned int)_size.height()) {
+                return;
+            }
+            _bits[y * _wordsPerRow + x / 64] |= uint64_t(1) << (x % 64);
+
+            auto& span = _spans[y];
+            if (span.first > span.last) {
+                span.first = span.last = static_cast<uint16_t>(x);
+            } else {
+                span.first = std::min(span.first, static_cast<uint16_t>(x));
+                span.last = std::max(span.last, static_cast<uint16_t>(x));
+            }
+        }
+
+        bool HitMask::opaque(unsigned int x, unsigned int y) const {
+            if (y >= (unsigned int)_size.height()) {
+                return false;
+            }
+            const auto& span = _spans[y];
+            if (x < span.first || x > span.last) {
+                return false;
+            }
+            return (_bits[y * _wordsPerRow + x / 64] >> (x % 64)) & 1;
+        }
+
+        const Size& HitMask::size() const {
+            return _size;
+        }
+    }
+}
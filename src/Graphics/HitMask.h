@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../Graphics/Size.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falltergeist {
+    namespace Graphics {
+        /**
+         * One bit per pixel telling whether the pixel reacts to the mouse
+         * Every row remembers the span of its opaque pixels, so most misses are rejected without reading bits
+         * Masks are built once from the image and shared by everything that hit-tests it
+         */
+        class HitMask final {
+        public:
+            HitMask(const Size& size);
+
+            void setOpaque(unsigned int x, unsigned int y);
+
+            bool opaque(unsigned int x, unsigned int y) const;
+
+            const Size& size() const;
+
+        private:
+            struct Span {
+                uint16_t first;
+                uint16_t last;
+            };
+
+            Size _size;
+
+            unsigned int _wordsPerRow;
+
+            std::vector<uint64_t> _bits;
+
+            // opaque pixels of a row lie in [first, last], first > last for empty rows
+            std::vector<Span> _spans;
+        };
+    }
+}
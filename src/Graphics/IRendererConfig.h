@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <string>
 
 namespace Falltergeist
 {
@@ -16,6 +18,17 @@ namespace Falltergeist
                 virtual int32_t y() = 0;
                 virtual bool isFullscreen() = 0;
                 virtual bool isAlwaysOnTop() = 0;
+                virtual bool isVsync() = 0;
+                // Requests an OpenGL ES context and renders through the GLES2 path
+                virtual bool isGles() = 0;
+                // Window pixels per game pixel, 0 and 1 render at the window resolution
+                virtual uint32_t scale() = 0;
+                virtual const std::string& scaleFilter() = 0;
+                virtual float gamma() = 0;
+                // Bytes of evictable textures kept on the GPU, 0 for no limit
+                virtual size_t textureBudget() = 0;
+                // Bytes of deferred textures uploaded per frame, 0 uploads them at once
+                virtual size_t textureUploadBudget() = 0;
         };
     }
 }
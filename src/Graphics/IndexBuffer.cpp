@@ -1,10 +1,11 @@
 #include "../Graphics/IndexBuffer.h"
 #include "../Graphics/GLCheck.h"
+#include "../Graphics/RenderStats.h"
 #include <stdexcept>
 
 namespace Falltergeist {
     namespace Graphics {
-        IndexBuffer::IndexBuffer(unsigned int* indexes, unsigned int count, UsagePattern usagePattern) {
+        IndexBuffer::IndexBuffer(const unsigned int* indexes, unsigned int count, UsagePattern usagePattern) {
             _indexes = indexes;
             _count = count;
 
@@ -20,9 +21,12 @@ namespace Falltergeist {
                     throw std::logic_error("Unsupported usage pattern");
             }
 
+            _usage = usage;
+
             GL_CHECK(glGenBuffers(1, &_resourceId));
             GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _resourceId));
             GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), indexes, usage));
+            RenderStats::bufferCreation(indexes ? count * sizeof(unsigned int) : 0);
         }
 
         IndexBuffer::~IndexBuffer() {
@@ -44,5 +48,12 @@ namespace Falltergeist {
         unsigned int IndexBuffer::count() const {
             return _count;
         }
+
+        void IndexBuffer::update(const unsigned int* indexes, unsigned int count) {
+            _indexes = indexes;
+            _count = count;
+            bind();
+            GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), indexes, _usage));
+        }
     }
 }
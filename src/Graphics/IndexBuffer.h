@@ -9,7 +9,7 @@ namespace Falltergeist {
                 DynamicDraw
             };
 
-            IndexBuffer(unsigned int* indexes, unsigned int count, UsagePattern usagePattern = UsagePattern::StaticDraw);
+            IndexBuffer(const unsigned int* indexes, unsigned int count, UsagePattern usagePattern = UsagePattern::StaticDraw);
             ~IndexBuffer();
 
             void bind() const;
@@ -17,10 +17,14 @@ namespace Falltergeist {
             const unsigned int* indexes() const;
             unsigned int count() const;
 
+            // Replaces the contents, reallocating the storage
+            void update(const unsigned int* indexes, unsigned int count);
+
         private:
             unsigned int _resourceId = 0;
             const unsigned int* _indexes;
             unsigned int _count;
+            unsigned int _usage;
         };
     }
 }
@@ -1,6 +1,8 @@
 #include "../Game/Game.h"
 #include "../Graphics/GLCheck.h"
+#include "../Graphics/GLState.h"
 #include "../Graphics/Lightmap.h"
+#include "../Graphics/RenderStats.h"
 #include "../ResourceManager.h"
 #include "../State/Location.h"
 #include <stdexcept>
@@ -31,26 +33,43 @@ namespace Falltergeist
             _uniformFade = _shader->getUniform("fade");
             _uniformMVP = _shader->getUniform("MVP");
             _uniformOffset = _shader->getUniform("offset");
+            _uniformAmbient = _shader->getUniform("ambient");
 
-            _attribPos = _shader->getAttrib("Position");
+            // the 3.2 shader derives positions of the hexagons from the vertex index, only lights are stored then
+            bool derivedPositions = Game::getInstance()->renderer()->renderPath() == Renderer::RenderPath::OGL32;
+            _attribPos = derivedPositions ? -1 : _shader->getAttrib("Position");
             _attribLights = _shader->getAttrib("lights");
 
             _vertexArray = std::make_unique<VertexArray>();
 
-            _coordinatesVertexBuffer = std::make_unique<VertexBuffer>(
-                    &coords[0],
-                    coords.size() * sizeof(glm::vec2),
-                    VertexBuffer::UsagePattern::StaticDraw
+            if (!derivedPositions) {
+                _coordinatesVertexBuffer = std::make_unique<VertexBuffer>(
+                        &coords[0],
+                        coords.size() * sizeof(glm::vec2),
+                        VertexBuffer::UsagePattern::StaticDraw
+                );
+                VertexBufferLayout coordinatesVertexBufferLayout;
+                coordinatesVertexBufferLayout.addAttribute({
+                       (unsigned int) _attribPos,
+                       2,
+                       VertexBufferAttribute::Type::Float
+               });
+                _vertexArray->addBuffer(_coordinatesVertexBuffer, coordinatesVertexBufferLayout);
+            }
+
+            // one light per vertex, rewritten in place when lights change
+            _lightsVertexBuffer = std::make_unique<VertexBuffer>(
+                    nullptr,
+                    coords.size() * sizeof(float),
+                    VertexBuffer::UsagePattern::DynamicDraw
             );
-            VertexBufferLayout coordinatesVertexBufferLayout;
-            coordinatesVertexBufferLayout.addAttribute({
-                   (unsigned int) _attribPos,
-                   2,
-                   VertexBufferAttribute::Type::Float
-           });
-            _vertexArray->addBuffer(_coordinatesVertexBuffer, coordinatesVertexBufferLayout);
-
-            _lightsVertexBuffer = std::make_unique<VertexBuffer>(nullptr, 0);
+            VertexBufferLayout lightsVertexBufferLayout;
+            lightsVertexBufferLayout.addAttribute({
+                  (unsigned int) _attribLights,
+                  1,
+                  VertexBufferAttribute::Type::Float
+            });
+            _vertexArray->addBuffer(_lightsVertexBuffer, lightsVertexBufferLayout);
         }
 
         Lightmap::~Lightmap()
@@ -59,7 +78,9 @@ namespace Falltergeist
 
         void Lightmap::render(const Point &pos)
         {
-            GL_CHECK(glBlendFunc(GL_DST_COLOR, GL_SRC_COLOR));
+            Game::getInstance()->renderer()->flush();
+
+            GLState::current()->setBlendFunc(GL_DST_COLOR, GL_SRC_COLOR);
 
             _shader->use();
 
@@ -68,31 +89,38 @@ namespace Falltergeist
             // set camera offset
             _shader->setUniform(_uniformOffset, glm::vec2((float)pos.x(), (float)pos.y()));
 
-            _shader->setUniform(_uniformFade, Game::getInstance()->renderer()->fadeColor());
+            _shader->setUniform(_uniformFade, Game::getInstance()->renderer()->drawFadeColor());
+
+            _shader->setUniform(_uniformAmbient, _ambient);
 
             _vertexArray->bind();
             _indexBuffer->bind();
 
             GL_CHECK(glDrawElements(GL_TRIANGLES, _indexBuffer->count(), GL_UNSIGNED_INT, nullptr));
-            GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+            RenderStats::drawCall(_indexBuffer->count() / 3);
+            GLState::current()->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         }
 
-        void Lightmap::update(std::vector<float> lights)
+        void Lightmap::setAmbient(float level)
         {
-            _vertexArray->bind();
+            _ambient = level;
+        }
 
-            _lightsVertexBuffer = std::make_unique<VertexBuffer>(
+        void Lightmap::update(const std::vector<float>& lights)
+        {
+            update(0, lights);
+        }
+
+        void Lightmap::update(unsigned int first, const std::vector<float>& lights)
+        {
+            if (lights.empty()) {
+                return;
+            }
+            _lightsVertexBuffer->write(
+                first * sizeof(float),
                 &lights[0],
-                lights.size() * sizeof(float),
-                VertexBuffer::UsagePattern::StaticDraw
+                lights.size() * sizeof(float)
             );
-            VertexBufferLayout lightsVertexBufferLayout;
-            lightsVertexBufferLayout.addAttribute({
-                  (unsigned int) _attribLights,
-                  1,
-                  VertexBufferAttribute::Type::Float
-            });
-            _vertexArray->addBuffer(_lightsVertexBuffer, lightsVertexBufferLayout);
         }
     }
 }
@@ -14,10 +14,15 @@ namespace Falltergeist
         class Lightmap
         {
             public:
+                // Coordinates of the vertices are kept only on the 2.1 path
                 Lightmap(std::vector<glm::vec2> coords, std::vector<GLuint> indexes);
                 ~Lightmap();
                 void render(const Point &pos);
-                void update(std::vector<float> lights);
+                void update(const std::vector<float>& lights);
+                // Replaces lights of the vertices starting at first
+                void update(unsigned int first, const std::vector<float>& lights);
+                // Lights of the vertices at or below the ambient level are drawn as unlit, changing it uploads nothing
+                void setAmbient(float level);
 
             private:
                 std::unique_ptr<VertexArray> _vertexArray;
@@ -28,6 +33,9 @@ namespace Falltergeist
                 GLint _uniformFade;
                 GLint _uniformMVP;
                 GLint _uniformOffset;
+                GLint _uniformAmbient;
+
+                float _ambient = 65536.0f;
 
                 GLint _attribPos;
                 GLint _attribLights;
@@ -19,13 +19,24 @@ namespace Falltergeist
 
         void Movie::loadFromSurface(SDL_Surface* surface)
         {
-            _texture = std::make_unique<Texture>(
-                Pixels(
-                surface->pixels,
-                Size(surface->w, surface->h),
-                Pixels::Format::RGBA
-                )
-            );
+            Size size(surface->w, surface->h);
+            unsigned int bytes = static_cast<unsigned int>(surface->pitch * surface->h);
+
+            // the first frame and a change of the video size create the texture, later frames only update it
+            if (!_texture || _texture->size() != size) {
+                _texture = std::make_unique<Texture>(Pixels(surface->pixels, size, Pixels::Format::RGBA));
+                for (auto& pixelBuffer : _pixelBuffers) {
+                    pixelBuffer = std::make_unique<PixelBuffer>(bytes);
+                }
+                return;
+            }
+
+            auto& pixelBuffer = _pixelBuffers[_nextPixelBuffer];
+            _nextPixelBuffer = (_nextPixelBuffer + 1) % _pixelBuffers.size();
+
+            pixelBuffer->write(surface->pixels, bytes);
+            _texture->update(Pixels(nullptr, size, Pixels::Format::RGBA));
+            pixelBuffer->unbind();
         }
 
         void Movie::render(const Point& point)
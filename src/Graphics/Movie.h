@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <string>
+#include "../Graphics/PixelBuffer.h"
 #include "../Graphics/Texture.h"
 
 namespace Falltergeist
@@ -14,10 +16,14 @@ namespace Falltergeist
                 ~Movie() = default;
                 void render(const Point& point);
                 const Size& size() const;
+                // Streams a RGBA8888 frame into the texture, the upload overlaps drawing the previous frame
                 void loadFromSurface(SDL_Surface* surface);
 
             private:
                 std::unique_ptr<Texture> _texture;
+                // Frames alternate between the buffers, so a write never waits for the upload before it
+                std::array<std::unique_ptr<PixelBuffer>, 2> _pixelBuffers;
+                size_t _nextPixelBuffer = 0;
                 const Size _size;
         };
     }
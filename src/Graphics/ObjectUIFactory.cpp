@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "../Graphics/ObjectUIFactory.h"
 #include "../ResourceManager.h"
 #include "../Format/Frm/File.h"
@@ -16,7 +17,7 @@ namespace Falltergeist
                 return nullptr;
             }
 
-            if (frm->framesPerDirection() > 1 || frm->directions().size() > 1) {
+            if (frm->framesPerDirection() > 1 || frm->directionsCount() > 1) {
                 auto queue = std::make_unique<UI::AnimationQueue>();
                 queue->animations().push_back(
                     std::make_unique<UI::Animation>(
@@ -29,11 +30,11 @@ namespace Falltergeist
 
             auto image = std::make_unique<UI::Image>(std::make_unique<Sprite>(frm));
             auto direction = static_cast<unsigned>(orientation);
-            if (direction >= frm->directions().size()) {
+            if (direction >= frm->directionsCount()) {
                 //throw Exception("Image::Image(frm, direction) - direction not found: " + std::to_string(direction));
                 direction = 0;
             }
-            auto& dir = frm->directions().at(direction);
+            auto& dir = frm->direction(direction);
             image->setOffset(Point(
                 frm->offsetX(direction) + dir.shiftX(),
                 frm->offsetY(direction) + dir.shiftY()
@@ -41,5 +42,26 @@ namespace Falltergeist
 
             return image;
         }
+
+        Size ObjectUIFactory::sizeByFID(uint32_t fid, Game::Orientation orientation)
+        {
+            auto frm = ResourceManager::getInstance()->frmFileType(fid);
+            if (!frm) {
+                return Size();
+            }
+
+            if (frm->framesPerDirection() > 1 || frm->directionsCount() > 1) {
+                // animations are as large as their current frame
+                int width = 0;
+                int height = 0;
+                for (auto& frame : frm->direction(static_cast<unsigned>(orientation)).frames()) {
+                    width = std::max(width, static_cast<int>(frame.width()));
+                    height = std::max(height, static_cast<int>(frame.height()));
+                }
+                return Size(width, height);
+            }
+
+            return Size(frm->width(), frm->height());
+        }
     }
 }
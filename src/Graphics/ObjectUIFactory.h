@@ -11,6 +11,8 @@ namespace Falltergeist
         {
             public:
                 std::unique_ptr<UI::Base> buildByFID(uint32_t fid, Game::Orientation orientation = Game::Orientation::NS);
+                // Largest size the UI built by buildByFID() may have, read from the FRM without creating textures
+                Size sizeByFID(uint32_t fid, Game::Orientation orientation = Game::Orientation::NS);
                 std::unique_ptr<UI::Base> buildActionAnimation(uint32_t armorFID, uint32_t weaponId, const std::string &action, Game::Orientation orientation);
         };
     }
@@ -0,0 +1,67 @@
+#include "../Graphics/OutlinePass.h"
+#include "../Game/Game.h"
+#include "../Graphics/FrameBuffer.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/Shader.h"
+#include "../ResourceManager.h"
+
+namespace Falltergeist {
+    namespace Graphics {
+        using Game::Game;
+
+        OutlinePass::OutlinePass() {
+            _shader = ResourceManager::getInstance()->shader("outline");
+            _uniformTex = _shader->getUniform("tex");
+            _uniformColor = _shader->getUniform("color");
+            _uniformFade = _shader->getUniform("fade");
+            _uniformMVP = _shader->getUniform("MVP");
+            _attribPos = _shader->getAttrib("Position");
+            _attribTex = _shader->getAttrib("TexCoord");
+        }
+
+        OutlinePass::~OutlinePass() {
+        }
+
+        void OutlinePass::begin() {
+            auto renderer = Game::getInstance()->renderer();
+            if (!_mask || _mask->size() != renderer->size()) {
+                _mask = std::make_unique<FrameBuffer>(renderer->size());
+            }
+            renderer->beginFrameBuffer(_mask.get());
+        }
+
+        void OutlinePass::end(int type) {
+            auto renderer = Game::getInstance()->renderer();
+            renderer->endFrameBuffer(_mask.get());
+
+            SpriteBatch::State state;
+            state.shader = _shader;
+            state.texture = _mask->texture();
+            state.positionAttrib = _attribPos;
+            state.texCoordAttrib = _attribTex;
+            switch (type) {
+                case 2:
+                    state.color = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
+                    break;
+                case 3:
+                    state.color = glm::vec4(0.0f, 1.0f, 0.0f, 1.0f);
+                    break;
+                default:
+                    state.color = glm::vec4(0.25f, 0.0f, 0.0f, 1.0f);
+                    break;
+            }
+
+            if (renderer->spriteBatch()->begin(state)) {
+                _shader->setUniform(_uniformTex, 0);
+                _shader->setUniform(_uniformColor, state.color);
+                _shader->setUniform(_uniformFade, renderer->drawFadeColor());
+                _shader->setUniform(_uniformMVP, renderer->getMVP());
+            }
+            // the mask is upside down like every framebuffer texture
+            renderer->spriteBatch()->add(
+                glm::vec4(0.0f, 0.0f, (float)_mask->size().width(), (float)_mask->size().height()),
+                glm::vec4(0.0f, 1.0f, 1.0f, 0.0f)
+            );
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../Graphics/SpriteBatch.h"
+#include <GL/glew.h>
+#include <memory>
+
+namespace Falltergeist {
+    namespace Graphics {
+        class FrameBuffer;
+        class Shader;
+
+        /**
+         * Outlines of several sprites for the cost of one: the sprites are rendered as they are into an offscreen mask,
+         * then a single full screen pass draws the pixels next to the covered ones
+         * Needs framebuffers, see Renderer::supportsFrameBuffers()
+         */
+        class OutlinePass final {
+        public:
+            OutlinePass();
+
+            ~OutlinePass();
+
+            // Everything rendered until end() goes into the mask
+            void begin();
+
+            // Draws the outline of the mask, types are the ones of sprite outlines: 1 red, 2 yellow, 3 green
+            void end(int type);
+
+        private:
+            std::unique_ptr<FrameBuffer> _mask;
+
+            Shader* _shader = nullptr;
+
+            GLint _uniformTex;
+            GLint _uniformColor;
+            GLint _uniformFade;
+            GLint _uniformMVP;
+
+            GLint _attribPos;
+            GLint _attribTex;
+        };
+    }
+}
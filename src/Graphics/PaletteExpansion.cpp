@@ -0,0 +1,56 @@
+#include "../Graphics/PaletteExpansion.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FALLTERGEIST_PALETTE_AVX2
+#include <immintrin.h>
+#endif
+
+namespace Falltergeist {
+    namespace Graphics {
+        namespace {
+            void expandScalar(const uint8_t* indexes, uint32_t* output, size_t count, const uint32_t* palette) {
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    output[i] = palette[indexes[i]];
+                    output[i + 1] = palette[indexes[i + 1]];
+                    output[i + 2] = palette[indexes[i + 2]];
+                    output[i + 3] = palette[indexes[i + 3]];
+                }
+                for (; i != count; ++i) {
+                    output[i] = palette[indexes[i]];
+                }
+            }
+
+#ifdef FALLTERGEIST_PALETTE_AVX2
+            __attribute__((target("avx2")))
+            void expandAvx2(const uint8_t* indexes, uint32_t* output, size_t count, const uint32_t* palette) {
+                const int* table = reinterpret_cast<const int*>(palette);
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indexes + i));
+                    __m256i low = _mm256_cvtepu8_epi32(bytes);
+                    __m256i high = _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_i32gather_epi32(table, low, 4));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i + 8), _mm256_i32gather_epi32(table, high, 4));
+                }
+                expandScalar(indexes + i, output + i, count - i, palette);
+            }
+
+            bool hasAvx2() {
+                static const bool supported = __builtin_cpu_supports("avx2");
+                return supported;
+            }
+#endif
+        }
+
+        void expandPalette(const uint8_t* indexes, uint32_t* output, size_t count, const uint32_t* palette) {
+#ifdef FALLTERGEIST_PALETTE_AVX2
+            if (hasAvx2()) {
+                expandAvx2(indexes, output, count, palette);
+                return;
+            }
+#endif
+            expandScalar(indexes, output, count, palette);
+        }
+    }
+}
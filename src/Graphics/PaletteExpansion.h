@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Falltergeist {
+    namespace Graphics {
+        /**
+         * Converts count palette indexes into 32-bit colors, palette has 256 entries in the output pixel format
+         * Uses AVX2 gathers when the CPU supports them and an unrolled table lookup otherwise
+         */
+        void expandPalette(const uint8_t* indexes, uint32_t* output, size_t count, const uint32_t* palette);
+    }
+}
@@ -0,0 +1,92 @@
+#include "../Graphics/PickingPass.h"
+#include "../Game/Game.h"
+#include "../Graphics/FrameBuffer.h"
+#include "../Graphics/GLCheck.h"
+#include "../Graphics/Renderer.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstring>
+
+namespace Falltergeist {
+    namespace Graphics {
+        using Game::Game;
+
+        PickingPass::PickingPass() {
+            _ids = std::make_unique<FrameBuffer>(Size(1, 1));
+            GL_CHECK(glGenBuffers(1, &_buffer));
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, _buffer));
+            GL_CHECK(glBufferData(GL_PIXEL_PACK_BUFFER, 4, nullptr, GL_STREAM_READ));
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        }
+
+        PickingPass::~PickingPass() {
+            if (_fence) {
+                glDeleteSync(_fence);
+            }
+            glDeleteBuffers(1, &_buffer);
+        }
+
+        void PickingPass::begin(const Point& point) {
+            auto renderer = Game::getInstance()->renderer();
+            renderer->beginFrameBuffer(_ids.get());
+
+            // the pixel at the point fills the buffer, everything else is clipped before being shaded
+            _point = point;
+            _MVP = renderer->getMVP();
+            renderer->setMVP(glm::ortho(
+                static_cast<double>(point.x()), static_cast<double>(point.x() + 1),
+                static_cast<double>(point.y() + 1), static_cast<double>(point.y()),
+                -1.0, 1.0
+            ));
+        }
+
+        void PickingPass::end() {
+            auto renderer = Game::getInstance()->renderer();
+            renderer->flush();
+
+            // the copy of the previous frame is replaced even if it wasn't read
+            if (_fence) {
+                glDeleteSync(_fence);
+            }
+            _ready = false;
+
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, _buffer));
+            GL_CHECK(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+            // with a pack buffer bound the pointer is an offset into it, the call returns once the copy is queued
+            GL_CHECK(glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+            _fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+            renderer->setMVP(_MVP);
+            renderer->endFrameBuffer(_ids.get());
+        }
+
+        bool PickingPass::result(const Point& point, uint32_t& id) {
+            if (point != _point) {
+                return false;
+            }
+            if (!_ready) {
+                if (!_fence || glClientWaitSync(_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED) {
+                    return false;
+                }
+                glDeleteSync(_fence);
+                _fence = nullptr;
+
+                uint8_t pixel[4] = {0, 0, 0, 0};
+                GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, _buffer));
+                auto mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 4, GL_MAP_READ_BIT);
+                if (mapped) {
+                    std::memcpy(pixel, mapped, sizeof(pixel));
+                    GL_CHECK(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+                }
+                GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+                if (!mapped) {
+                    return false;
+                }
+                _id = pixel[0] | (pixel[1] << 8) | (pixel[2] << 16);
+                _ready = true;
+            }
+            id = _id;
+            return true;
+        }
+    }
+}
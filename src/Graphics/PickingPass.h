@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../Graphics/Point.h"
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include <cstdint>
+#include <memory>
+
+namespace Falltergeist {
+    namespace Graphics {
+        class FrameBuffer;
+
+        /**
+         * Finds what is under a point of the screen on the GPU: sprites are rendered into a single pixel buffer
+         * covering the point, writing ids instead of colors (see Renderer::setPickId()), then the pixel is copied
+         * into a pixel pack buffer. result() reads it a frame later, once the copy is done, so nothing waits for the GPU
+         * Needs framebuffers, see Renderer::supportsFrameBuffers()
+         */
+        class PickingPass final {
+        public:
+            PickingPass();
+
+            ~PickingPass();
+
+            PickingPass(const PickingPass&) = delete;
+
+            PickingPass& operator=(const PickingPass&) = delete;
+
+            // Everything rendered until end() goes into the id buffer of the point, which starts at 0
+            void begin(const Point& point);
+
+            // Queues the copy of the id
+            void end();
+
+            // Id at the point of the last pass if its copy is done, false if it's not or the pass was at another point
+            bool result(const Point& point, uint32_t& id);
+
+        private:
+            std::unique_ptr<FrameBuffer> _ids;
+
+            GLuint _buffer = 0;
+
+            GLsync _fence = nullptr;
+
+            glm::mat4 _MVP;
+
+            Point _point;
+
+            uint32_t _id = 0;
+
+            bool _ready = false;
+        };
+    }
+}
@@ -0,0 +1,40 @@
+#include "../Graphics/PixelBuffer.h"
+#include "../Graphics/GLCheck.h"
+#include <stdexcept>
+
+namespace Falltergeist {
+    namespace Graphics {
+        PixelBuffer::PixelBuffer(unsigned int size) : _size(size) {
+            GL_CHECK(glGenBuffers(1, &_resourceId));
+            bind();
+            GL_CHECK(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW));
+            unbind();
+        }
+
+        PixelBuffer::~PixelBuffer() {
+            GL_CHECK(glDeleteBuffers(1, &_resourceId));
+        }
+
+        void PixelBuffer::bind() const {
+            GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _resourceId));
+        }
+
+        void PixelBuffer::unbind() const {
+            GL_CHECK(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        }
+
+        unsigned int PixelBuffer::size() const {
+            return _size;
+        }
+
+        void PixelBuffer::write(const void* data, unsigned int size) {
+            if (size > _size) {
+                throw std::out_of_range("Pixel buffer write is out of range");
+            }
+            bind();
+            // orphaning first, so the copy doesn't wait for the previous upload from this buffer
+            GL_CHECK(glBufferData(GL_PIXEL_UNPACK_BUFFER, _size, nullptr, GL_STREAM_DRAW));
+            GL_CHECK(glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, data));
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+namespace Falltergeist {
+    namespace Graphics {
+        // Pixel unpack buffer, texture uploads from it return before the GPU has read the pixels
+        class PixelBuffer final {
+        public:
+            explicit PixelBuffer(unsigned int size);
+            ~PixelBuffer();
+
+            PixelBuffer(const PixelBuffer&) = delete;
+            PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+            void bind() const;
+            void unbind() const;
+            unsigned int size() const;
+
+            // Binds the buffer and replaces its storage with the data, an upload still reading the old storage keeps it
+            void write(const void* data, unsigned int size);
+
+        private:
+            unsigned int _resourceId = 0;
+            unsigned int _size;
+        };
+    }
+}
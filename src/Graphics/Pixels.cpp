@@ -21,5 +21,13 @@ namespace Falltergeist {
         Pixels::Format Pixels::format() const {
             return _format;
         }
+
+        unsigned int Pixels::bytesPerPixel() const {
+            return bytesPerPixel(_format);
+        }
+
+        unsigned int Pixels::bytesPerPixel(Pixels::Format format) {
+            return format == Format::Indexed ? 1 : 4;
+        }
     }
 }
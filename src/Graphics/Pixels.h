@@ -8,7 +8,9 @@ namespace Falltergeist {
         public:
             enum class Format {
                 RGB,
-                RGBA
+                RGBA,
+                // one palette index per pixel, colors are looked up when rendering
+                Indexed
             };
 
             Pixels(const void* data, const Size& size, Format format);
@@ -17,6 +19,9 @@ namespace Falltergeist {
             const void* data() const;
             const Size& size() const;
             Format format() const;
+            unsigned int bytesPerPixel() const;
+
+            static unsigned int bytesPerPixel(Format format);
 
         private:
             const void* _data;
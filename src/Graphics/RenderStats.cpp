@@ -0,0 +1,179 @@
+#include "../Graphics/RenderStats.h"
+#include "../Graphics/GLCheck.h"
+#include <algorithm>
+#include <fstream>
+
+namespace Falltergeist {
+    namespace Graphics {
+        namespace {
+            const char* PASS_NAMES[RenderStats::PASSES] = {"floor", "lightmap", "objects", "roof", "ui"};
+        }
+
+        RenderStats* RenderStats::_current = nullptr;
+
+        RenderStats::RenderStats() {
+            _current = this;
+        }
+
+        RenderStats::~RenderStats() {
+            setTiming(false);
+            if (_current == this) {
+                _current = nullptr;
+            }
+        }
+
+        RenderStats* RenderStats::current() {
+            return _current;
+        }
+
+        void RenderStats::setTiming(bool enabled) {
+            enabled = enabled && GLEW_ARB_timer_query;
+            if (enabled == _timing) {
+                return;
+            }
+            _endPass();
+            if (!enabled) {
+                _deleteQueries();
+            }
+            _timing = enabled;
+        }
+
+        bool RenderStats::timing() const {
+            return _timing;
+        }
+
+        void RenderStats::beginFrame() {
+            _frame = Frame();
+            _frame.number = _lastFrame.number + 1;
+            _collect();
+        }
+
+        void RenderStats::endFrame() {
+            _endPass();
+            _lastFrame = _frame;
+            _history.push_back(_frame);
+            if (_history.size() > HISTORY) {
+                _history.pop_front();
+            }
+        }
+
+        void RenderStats::beginPass(Pass pass) {
+            if (!_timing) {
+                return;
+            }
+            _endPass();
+
+            auto& queryFrame = _queryFrames[_frame.number % QUERY_FRAMES];
+            if (queryFrame.used == queryFrame.queries.size()) {
+                GLuint query = 0;
+                GL_CHECK(glGenQueries(1, &query));
+                queryFrame.queries.push_back(query);
+                queryFrame.passes.push_back(pass);
+            }
+            queryFrame.passes[queryFrame.used] = pass;
+            GL_CHECK(glBeginQuery(GL_TIME_ELAPSED, queryFrame.queries[queryFrame.used]));
+            ++queryFrame.used;
+            _passActive = true;
+        }
+
+        const RenderStats::Frame& RenderStats::lastFrame() const {
+            return _lastFrame;
+        }
+
+        float RenderStats::passTime(Pass pass) const {
+            return _passTimes[static_cast<unsigned int>(pass)];
+        }
+
+        const char* RenderStats::passName(Pass pass) {
+            return PASS_NAMES[static_cast<unsigned int>(pass)];
+        }
+
+        bool RenderStats::write(const std::string& filename) const {
+            std::ofstream stream(filename);
+            if (!stream) {
+                return false;
+            }
+
+            stream << "frame,draw_calls,triangles,quads,texture_binds,buffer_creations,buffer_uploads,uploaded_bytes";
+            for (auto name : PASS_NAMES) {
+                stream << "," << name << "_ms";
+            }
+            stream << "\n";
+
+            for (auto& frame : _history) {
+                stream << frame.number << "," << frame.drawCalls << "," << frame.triangles << "," << frame.quads << ","
+                       << frame.textureBinds << "," << frame.bufferCreations << "," << frame.bufferUploads << ","
+                       << frame.uploadedBytes;
+                for (auto time : frame.passTimes) {
+                    stream << ",";
+                    if (time >= 0.0f) {
+                        stream << time;
+                    }
+                }
+                stream << "\n";
+            }
+            return static_cast<bool>(stream);
+        }
+
+        void RenderStats::_endPass() {
+            if (_passActive) {
+                GL_CHECK(glEndQuery(GL_TIME_ELAPSED));
+                _passActive = false;
+            }
+        }
+
+        void RenderStats::_collect() {
+            if (!_timing) {
+                return;
+            }
+
+            for (auto& queryFrame : _queryFrames) {
+                if (queryFrame.used == 0) {
+                    continue;
+                }
+
+                // queries finish in order, the last one being ready means all of them are
+                GLint available = 0;
+                GL_CHECK(glGetQueryObjectiv(queryFrame.queries[queryFrame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+                bool reused = &queryFrame == &_queryFrames[_frame.number % QUERY_FRAMES];
+                if (!available) {
+                    // a result nobody waited for is dropped rather than stalling the frame
+                    if (reused) {
+                        queryFrame.used = 0;
+                    }
+                    continue;
+                }
+
+                float times[PASSES] = {-1.0f, -1.0f, -1.0f, -1.0f, -1.0f};
+                for (size_t i = 0; i != queryFrame.used; ++i) {
+                    GLuint64 elapsed = 0;
+                    GL_CHECK(glGetQueryObjectui64v(queryFrame.queries[i], GL_QUERY_RESULT, &elapsed));
+                    auto& time = times[static_cast<unsigned int>(queryFrame.passes[i])];
+                    time = (time < 0.0f ? 0.0f : time) + static_cast<float>(elapsed) / 1000000.0f;
+                }
+                queryFrame.used = 0;
+
+                auto number = queryFrame.number;
+                if (!_history.empty() && number >= _history.front().number && number - _history.front().number < _history.size()) {
+                    auto& frame = _history[number - _history.front().number];
+                    std::copy(times, times + PASSES, frame.passTimes);
+                }
+                if (number > _passTimesFrame) {
+                    std::copy(times, times + PASSES, _passTimes);
+                    _passTimesFrame = number;
+                }
+            }
+
+            _queryFrames[_frame.number % QUERY_FRAMES].number = _frame.number;
+        }
+
+        void RenderStats::_deleteQueries() {
+            for (auto& queryFrame : _queryFrames) {
+                if (!queryFrame.queries.empty()) {
+                    GL_CHECK(glDeleteQueries(static_cast<GLsizei>(queryFrame.queries.size()), queryFrame.queries.data()));
+                }
+                queryFrame = QueryFrame();
+            }
+        }
+    }
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace Falltergeist {
+    namespace Graphics {
+        /**
+         * RenderStats counts what every frame sends to GL and measures the GPU time of the render passes with timer queries.
+         * It is owned by the renderer, the GL wrappers report to the current instance, so counting costs a few increments.
+         * Query results are read a few frames later without waiting for the GPU, until then pass times are negative.
+         */
+        class RenderStats final {
+        public:
+            enum class Pass : unsigned int {
+                FLOOR = 0,
+                LIGHTMAP,
+                OBJECTS,
+                ROOF,
+                UI
+            };
+
+            static const unsigned int PASSES = 5;
+
+            struct Frame {
+                unsigned long long number = 0;
+                unsigned int drawCalls = 0;
+                unsigned int triangles = 0;
+                // quads queued into the sprite batch, the draw calls show how well they were batched
+                unsigned int quads = 0;
+                // binds which reached GL, redundant ones are skipped by GLState
+                unsigned int textureBinds = 0;
+                unsigned int bufferCreations = 0;
+                unsigned int bufferUploads = 0;
+                size_t uploadedBytes = 0;
+                // milliseconds
+                float passTimes[PASSES] = {-1.0f, -1.0f, -1.0f, -1.0f, -1.0f};
+            };
+
+            RenderStats();
+
+            ~RenderStats();
+
+            RenderStats(const RenderStats&) = delete;
+
+            RenderStats& operator=(const RenderStats&) = delete;
+
+            // Stats of the current context, nullptr if there is no renderer
+            static RenderStats* current();
+
+            static void drawCall(unsigned int triangles) {
+                if (_current) {
+                    ++_current->_frame.drawCalls;
+                    _current->_frame.triangles += triangles;
+                }
+            }
+
+            static void quad() {
+                if (_current) {
+                    ++_current->_frame.quads;
+                }
+            }
+
+            static void textureBind() {
+                if (_current) {
+                    ++_current->_frame.textureBinds;
+                }
+            }
+
+            static void bufferCreation(size_t bytes) {
+                if (_current) {
+                    ++_current->_frame.bufferCreations;
+                    _current->_frame.uploadedBytes += bytes;
+                }
+            }
+
+            static void bufferUpload(size_t bytes) {
+                if (_current) {
+                    ++_current->_frame.bufferUploads;
+                    _current->_frame.uploadedBytes += bytes;
+                }
+            }
+
+            // Pass timing needs timer queries (GL 3.3 or ARB_timer_query), counters work everywhere
+            void setTiming(bool enabled);
+
+            bool timing() const;
+
+            void beginFrame();
+
+            void endFrame();
+
+            // Ends the running pass and starts measuring the given one, pending draws have to be flushed first
+            void beginPass(Pass pass);
+
+            // Counters of the last finished frame
+            const Frame& lastFrame() const;
+
+            // Latest known GPU time of the pass in milliseconds, negative if unknown
+            float passTime(Pass pass) const;
+
+            static const char* passName(Pass pass);
+
+            // Writes the kept frames as CSV, returns false if the file cannot be written
+            bool write(const std::string& filename) const;
+
+        private:
+            // queries of a pass are reused after this many frames, their results are available by then
+            static const unsigned int QUERY_FRAMES = 4;
+
+            // frames kept for write()
+            static const size_t HISTORY = 600;
+
+            static RenderStats* _current;
+
+            Frame _frame;
+
+            Frame _lastFrame;
+
+            std::deque<Frame> _history;
+
+            bool _timing = false;
+
+            // Queries issued in one frame, a pass may be measured several times (like the UI before and after a location)
+            struct QueryFrame {
+                unsigned long long number = 0;
+                std::vector<GLuint> queries;
+                std::vector<Pass> passes;
+                size_t used = 0;
+            };
+
+            QueryFrame _queryFrames[QUERY_FRAMES];
+
+            unsigned long long _passTimesFrame = 0;
+
+            float _passTimes[PASSES] = {-1.0f, -1.0f, -1.0f, -1.0f, -1.0f};
+
+            bool _passActive = false;
+
+            void _endPass();
+
+            void _collect();
+
+            void _deleteQueries();
+        };
+    }
+}
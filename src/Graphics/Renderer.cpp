@@ -1,28 +1,30 @@
-﻿#include <cmath>
+﻿#include <algorithm>
+#include <cmath>
 #include <memory>
 
 #define GLM_FORCE_RADIANS
 
-#include "../Base/Buffer.h"
-#include "../CrossPlatform.h"
 #include "../Event/State.h"
 #include "../Exception.h"
+#include "../Format/Pal/File.h"
 #include "../Game/Game.h"
+#include "../Graphics/AnimatedPalette.h"
+#include "../Graphics/FrameBuffer.h"
 #include "../Graphics/GLCheck.h"
+#include "../Graphics/GLState.h"
 #include "../Graphics/IRendererConfig.h"
-#include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Point.h"
 #include "../Graphics/Renderer.h"
+#include "../Graphics/ScreenCapture.h"
 #include "../Graphics/SdlWindow.h"
 #include "../Graphics/Shader.h"
 #include "../Graphics/Texture.h"
-#include "../Graphics/VertexArray.h"
-#include "../Graphics/VertexBuffer.h"
+#include "../Graphics/TextureResidency.h"
+#include "../Graphics/TextureUploadQueue.h"
 #include "../Input/Mouse.h"
 #include "../ResourceManager.h"
 #include "../Settings.h"
 #include "../State/State.h"
-#include <SDL_image.h>
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace Falltergeist {
@@ -30,7 +32,7 @@ namespace Falltergeist {
         using Game::Game;
 
         Renderer::Renderer(std::unique_ptr<IRendererConfig> rendererConfig, std::shared_ptr<ILogger> logger, std::shared_ptr<SdlWindow> sdlWindow)
-            : _rendererConfig(std::move(rendererConfig)), _logger(logger), _size(sdlWindow->boundaries().size()), _sdlWindow(sdlWindow) {
+            : _rendererConfig(std::move(rendererConfig)), _logger(logger), _size(sdlWindow->boundaries().size()), _windowSize(_size), _sdlWindow(sdlWindow) {
             if (SDL_WasInit(SDL_INIT_VIDEO) == 0) {
                 if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0) {
                     logger->critical() << "Could not init SDL video subsystem: " << SDL_GetError() << std::endl;
@@ -39,10 +41,18 @@ namespace Falltergeist {
         }
 
         Renderer::~Renderer() {
+            // GL objects have to be released while the context is alive
+            _spriteBatch.reset();
+            _scene.reset();
+            _palette.reset();
+            _stats.reset();
+            _capture.reset();
+            _textureResidency.reset();
+            _textureUploadQueue.reset();
             SDL_GL_DeleteContext(_glcontext);
         }
 
-        void Renderer::init() {
+        void Renderer::_createContext() {
             std::string message = "Init OpenGL - ";
             // specifically request 3.2, because fucking Mesa ignores core flag with version < 3
             SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
@@ -66,7 +76,6 @@ namespace Falltergeist {
             }
 
             _logger->info() << "[RENDERER] " << message + "[OK]" << std::endl;
-            SDL_GL_SetSwapInterval(0);
 
             char* version_string = (char*)glGetString(GL_VERSION);
             if (version_string[0] - '0' >= 3) { // we have at least gl 3.0
@@ -82,6 +91,50 @@ namespace Falltergeist {
                 _minor = version_string[2] - '0';
                 _renderpath = RenderPath::OGL21;
             }
+        }
+
+        void Renderer::_createGlesContext() {
+            std::string message = "Init OpenGL ES - ";
+            // the profile and the framebuffer format were requested with the window
+            SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
+            SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+            SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+            SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+
+            _glcontext = SDL_GL_CreateContext(_sdlWindow->sdlWindowPtr());
+
+            if (!_glcontext) {
+                SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
+                _glcontext = SDL_GL_CreateContext(_sdlWindow->sdlWindowPtr());
+
+                if (!_glcontext) {
+                    throw Exception(message + SDL_GetError() + "[FAIL]");
+                }
+            }
+
+            _logger->info() << "[RENDERER] " << message + "[OK]" << std::endl;
+
+            // "OpenGL ES 3.1 Mesa 23.0", the version is the first number
+            std::string version((const char*)glGetString(GL_VERSION));
+            auto start = version.find_first_of("0123456789");
+            _major = start == std::string::npos ? 2 : version[start] - '0';
+            _minor = start == std::string::npos || start + 2 >= version.size() ? 0 : version[start + 2] - '0';
+            _renderpath = RenderPath::GLES2;
+
+            // without glGetError() after every call, GL errors go unnoticed on this path
+            glCheckErrors = false;
+        }
+
+        void Renderer::init() {
+            if (_rendererConfig->isGles()) {
+                _createGlesContext();
+            } else {
+                _createContext();
+            }
+
+            if (SDL_GL_SetSwapInterval(_rendererConfig->isVsync() ? 1 : 0) != 0 && _rendererConfig->isVsync()) {
+                _logger->warning() << "[RENDERER] Vsync is not supported: " << SDL_GetError() << std::endl;
+            }
 
             _logger->info() << "[RENDERER] "
                             << "Using OpenGL " << _major << "." << _minor << std::endl;
@@ -100,13 +153,20 @@ namespace Falltergeist {
                     _logger->info() << "[RENDERER] "
                                     << "Render path: OpenGL 3.0+" << std::endl;
                     break;
+                case RenderPath::GLES2:
+                    _logger->info() << "[RENDERER] "
+                                    << "Render path: OpenGL ES 2.0+" << std::endl;
+                    break;
                 default:
                     break;
             }
 
             glGetIntegerv(GL_MAX_TEXTURE_SIZE, &_maxTexSize);
+            if (_renderpath == RenderPath::OGL32) {
+                glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &_maxTextureArrayLayers);
+            }
 
-            message = "Init GLEW - ";
+            std::string message = "Init GLEW - ";
             glewExperimental = GL_TRUE;
             GLenum glewError = glewInit();
             glGetError(); // glew sometimes throws bad enum, so clean it
@@ -124,6 +184,34 @@ namespace Falltergeist {
             }
 
             _logger->info() << "[RENDERER] " << message + "[OK]" << std::endl;
+
+            if (_renderpath == RenderPath::GLES2 && _major < 3) {
+                // vertex arrays and 32 bit indexes are core from GLES 3.0
+                std::string extensions((const char*)glGetString(GL_EXTENSIONS));
+                for (auto extension : {"GL_OES_vertex_array_object", "GL_OES_element_index_uint"}) {
+                    if (extensions.find(extension) == std::string::npos) {
+                        throw Exception(std::string("OpenGL ES 2.0 render path needs ") + extension);
+                    }
+                }
+                if (!glGenVertexArrays) {
+                    throw Exception("OpenGL ES 2.0 render path needs glGenVertexArrays from GL_OES_vertex_array_object");
+                }
+            }
+
+            // the context is fresh, so the cache starts from the default state
+            _glState = std::make_unique<GLState>();
+            _glState->setViewport(0, 0, _windowSize.width(), _windowSize.height());
+            _stats = std::make_unique<RenderStats>();
+            _capture = std::make_unique<ScreenCapture>(_windowSize, _logger);
+            if (_rendererConfig->textureBudget()) {
+                _textureResidency = std::make_unique<TextureResidency>(_rendererConfig->textureBudget());
+                _logger->info() << "[RENDERER] Texture budget: " << _rendererConfig->textureBudget() / 1024 / 1024 << " MB" << std::endl;
+            }
+            if (_rendererConfig->textureUploadBudget()) {
+                _textureUploadQueue = std::make_unique<TextureUploadQueue>(_rendererConfig->textureUploadBudget());
+                _logger->info() << "[RENDERER] Texture uploads per frame: " << _rendererConfig->textureUploadBudget() / 1024 << " KB" << std::endl;
+            }
+
             _logger->info() << "[RENDERER] "
                             << "Using GLEW " << glewGetString(GLEW_VERSION) << std::endl;
 
@@ -143,12 +231,20 @@ namespace Falltergeist {
 
             _logger->info() << "[RENDERER] "
                             << "Loading default shaders" << std::endl;
-            ResourceManager::getInstance()->shader("default");
-            ResourceManager::getInstance()->shader("sprite");
-            ResourceManager::getInstance()->shader("font");
-            ResourceManager::getInstance()->shader("animation");
-            ResourceManager::getInstance()->shader("tilemap");
-            ResourceManager::getInstance()->shader("lightmap");
+#ifdef GL_KHR_parallel_shader_compile
+            if (GLEW_KHR_parallel_shader_compile) {
+                // let the driver pick the number of compiler threads
+                glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+            }
+#endif
+            std::vector<std::string> shaders = {"default", "sprite", "font", "animation", "tilemap", "lightmap"};
+            if (supportsInstancing()) {
+                shaders.push_back("tilemap_instanced");
+                if (supportsTextureArrays()) {
+                    shaders.push_back("tilemap_array");
+                }
+            }
+            ResourceManager::getInstance()->preloadShaders(shaders);
             _logger->info() << "[RENDERER] "
                             << "[OK]" << std::endl;
 
@@ -156,10 +252,18 @@ namespace Falltergeist {
                             << "Generating buffers" << std::endl;
 
             // generate projection matrix
-            _MVP = glm::ortho(0.0, static_cast<double>(_rendererConfig->width()), static_cast<double>(_rendererConfig->height()), 0.0, -1.0, 1.0);
+            _windowMVP = glm::ortho(0.0, static_cast<double>(_windowSize.width()), static_cast<double>(_windowSize.height()), 0.0, -1.0, 1.0);
+            if (supportsFrameBuffers()) {
+                _initComposition();
+            } else if (_rendererConfig->scale() > 1) {
+                _logger->warning() << "[RENDERER] Scaling needs the OpenGL 3.2 render path, rendering at the window resolution" << std::endl;
+            }
+            _MVP = glm::ortho(0.0, static_cast<double>(_size.width()), static_cast<double>(_size.height()), 0.0, -1.0, 1.0);
+
+            _spriteBatch = std::make_unique<SpriteBatch>();
 
             // load egg
-            _egg = ResourceManager::getInstance()->texture("data/egg.png");
+            _egg = ResourceManager::getInstance()->pinTexture("data/egg.png");
         }
 
         void Renderer::think(const float deltaTime) {
@@ -213,14 +317,100 @@ namespace Falltergeist {
             _fadeTimer = 0;
         }
 
+        void Renderer::_initComposition() {
+            unsigned int scale = std::max(_rendererConfig->scale(), 1u);
+            _size = Size(std::max(_windowSize.width() / static_cast<int>(scale), 1), std::max(_windowSize.height() / static_cast<int>(scale), 1));
+
+            const auto& filter = _rendererConfig->scaleFilter();
+            _outputSize = _windowSize;
+            if (filter == "integer") {
+                // the largest whole multiple fitting into the window, centered
+                int factor = std::max(std::min(_windowSize.width() / _size.width(), _windowSize.height() / _size.height()), 1);
+                _outputSize = Size(_size.width() * factor, _size.height() * factor);
+            } else if (filter != "nearest" && filter != "xbr") {
+                _logger->warning() << "[RENDERER] Unknown scale filter " << filter << ", using nearest" << std::endl;
+            }
+            _xbr = filter == "xbr";
+            _outputPosition = Point((_windowSize.width() - _outputSize.width()) / 2, (_windowSize.height() - _outputSize.height()) / 2);
+            _scaleX = static_cast<float>(_outputSize.width()) / static_cast<float>(_size.width());
+            _scaleY = static_cast<float>(_outputSize.height()) / static_cast<float>(_size.height());
+
+            _scene = std::make_unique<FrameBuffer>(_size);
+            _composeShader = ResourceManager::getInstance()->shader("compose");
+            _composeUniformTexture = _composeShader->getUniform("tex");
+            _composeUniformTextureSize = _composeShader->getUniform("texSize");
+            _composeUniformXbr = _composeShader->getUniform("xbr");
+            _composeUniformFade = _composeShader->getUniform("fade");
+            _composeUniformGamma = _composeShader->getUniform("gamma");
+            _composeUniformMVP = _composeShader->getUniform("MVP");
+            _composeAttribPos = _composeShader->getAttrib("Position");
+            _composeAttribTex = _composeShader->getAttrib("TexCoord");
+
+            _logger->info() << "[RENDERER] Composing " << _size.width() << "x" << _size.height() << " into "
+                            << _outputSize.width() << "x" << _outputSize.height() << " with " << (_xbr ? "xbr" : "nearest") << std::endl;
+        }
+
         void Renderer::beginFrame() {
+            _stats->beginFrame();
+            if (_textureUploadQueue) {
+                _textureUploadQueue->upload();
+            }
+            _stats->beginPass(RenderStats::Pass::UI);
+            if (_scene) {
+                _scene->bind();
+            } else {
+                GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+            }
+            _glState->setBlend(true);
+            _glState->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+
+        void Renderer::_compose() {
+            _spriteBatch->flush();
+            _scene->unbind();
+            GL_CHECK(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
             GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
-            GL_CHECK(glEnable(GL_BLEND));
-            GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+            // the scene holds coverage in its alpha, the window gets its colors as they are
+            _glState->setBlend(false);
+
+            SpriteBatch::State state;
+            state.shader = _composeShader;
+            state.texture = _scene->texture();
+            state.positionAttrib = _composeAttribPos;
+            state.texCoordAttrib = _composeAttribTex;
+            if (_spriteBatch->begin(state)) {
+                _composeShader->setUniform(_composeUniformTexture, 0);
+                _composeShader->setUniform(_composeUniformTextureSize, glm::vec2((float)_size.width(), (float)_size.height()));
+                _composeShader->setUniform(_composeUniformXbr, _xbr ? 1 : 0);
+                _composeShader->setUniform(_composeUniformFade, fadeColor());
+                _composeShader->setUniform(_composeUniformGamma, std::max(_rendererConfig->gamma(), 0.1f));
+                _composeShader->setUniform(_composeUniformMVP, _windowMVP);
+            }
+            // framebuffer textures are upside down
+            _spriteBatch->add(
+                glm::vec4(
+                    (float)_outputPosition.x(),
+                    (float)_outputPosition.y(),
+                    (float)(_outputPosition.x() + _outputSize.width()),
+                    (float)(_outputPosition.y() + _outputSize.height())
+                ),
+                glm::vec4(0.0f, 1.0f, 1.0f, 0.0f)
+            );
+            _spriteBatch->end();
         }
 
         void Renderer::endFrame() {
-            GL_CHECK(glDisable(GL_BLEND));
+            _spriteBatch->end();
+            if (_scene) {
+                _compose();
+            }
+            _stats->endFrame();
+            if (_textureResidency) {
+                _textureResidency->endFrame();
+            }
+            _glState->setBlend(false);
+            // the read is queued behind the frame's draws, presenting doesn't wait for it
+            _capture->endFrame();
             SDL_GL_SwapWindow(_sdlWindow->sdlWindowPtr());
         }
 
@@ -228,59 +418,52 @@ namespace Falltergeist {
             return _size;
         }
 
-        void Renderer::screenshot() {
-            std::string filename;
-            Uint32 rmask = 0, gmask = 0, bmask = 0, amask = 0;
-            SDL_Surface* output = nullptr;
-
-            int iter = 0;
-            do {
-                std::string siter = std::to_string(iter);
-                if (siter.size() < 3) {
-                    siter.insert(0, 3 - siter.size(), '0');
-                }
-                filename = "screenshot" + siter + ".png";
-                iter++;
-            } while (CrossPlatform::fileExists(filename) && iter < 1000);
+        const Size& Renderer::windowSize() const {
+            return _windowSize;
+        }
 
-            if (CrossPlatform::fileExists(filename)) {
-                _logger->warning() << "[RENDERER] Too many screenshots" << std::endl;
-                return;
-            }
+        void Renderer::setPickId(uint32_t id) {
+            _pickId = id;
+        }
 
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-            rmask = 0xff000000;
-            gmask = 0x00ff0000;
-            bmask = 0x0000ff00;
-            amask = 0x000000ff;
-#else
-            rmask = 0x000000ff;
-            gmask = 0x0000ff00;
-            bmask = 0x00ff0000;
-            amask = 0xff000000;
-#endif
+        uint32_t Renderer::pickId() const {
+            return _pickId;
+        }
 
-            output = SDL_CreateRGBSurface(0, size().width(), size().height(), 32, rmask, gmask, bmask, amask);
-            uint8_t* destPixels = (uint8_t*)output->pixels;
-            Base::Buffer<uint8_t> srcPixels(size().width() * size().height() * 4);
-
-            glReadBuffer(GL_BACK);
-            glReadPixels(0, 0, size().width(), size().height(), GL_RGBA, GL_UNSIGNED_BYTE, srcPixels.data());
-
-            for (int y = 0; y < static_cast<int>(size().height()); ++y) {
-                for (int x = 0; x < static_cast<int>(size().width()); ++x) {
-                    uint8_t* pDestPix = &destPixels[((size().width() * y) + x) * 4];
-                    uint8_t* pSrcPix = &srcPixels[((size().width() * ((size().height() - 1) - y)) + x) * 4];
-                    pDestPix[0] = pSrcPix[0];
-                    pDestPix[1] = pSrcPix[1];
-                    pDestPix[2] = pSrcPix[2];
-                    pDestPix[3] = 255;
-                }
+        bool Renderer::composing() const {
+            return _scene != nullptr;
+        }
+
+        Point Renderer::fromWindow(const Point& point) const {
+            if (!_scene) {
+                return point;
             }
+            return Point(
+                (point.x() - _outputPosition.x()) * _size.width() / _outputSize.width(),
+                (point.y() - _outputPosition.y()) * _size.height() / _outputSize.height()
+            );
+        }
 
-            IMG_SavePNG(output, filename.c_str());
-            SDL_FreeSurface(output);
-            _logger->info() << "[RENDERER] Screenshot saved to " + filename << std::endl;
+        Point Renderer::toWindow(const Point& point) const {
+            if (!_scene) {
+                return point;
+            }
+            return Point(
+                point.x() * _outputSize.width() / _size.width() + _outputPosition.x(),
+                point.y() * _outputSize.height() / _size.height() + _outputPosition.y()
+            );
+        }
+
+        void Renderer::screenshot() {
+            _capture->screenshot();
+        }
+
+        void Renderer::setCapturing(bool capturing) {
+            _capture->setContinuous(capturing);
+        }
+
+        bool Renderer::capturing() const {
+            return _capture->continuous();
         }
 
         float Renderer::scaleX() {
@@ -295,33 +478,28 @@ namespace Falltergeist {
             return _MVP;
         }
 
-        void Renderer::drawRect(int x, int y, int w, int h, SDL_Color color) {
-            std::vector<glm::vec2> vertices;
-
-            glm::vec4 fcolor = glm::vec4((float)color.r / 255.0f, (float)color.g / 255.0f, (float)color.b / 255.0f, (float)color.a / 255.0f);
-
-            vertices.push_back(glm::vec2((float)x, (float)y));
-            vertices.push_back(glm::vec2((float)x, (float)y + (float)h));
-            vertices.push_back(glm::vec2((float)x + (float)w, (float)y));
-            vertices.push_back(glm::vec2((float)x + (float)w, (float)y + (float)h));
-
-            auto defaultShader = ResourceManager::getInstance()->shader("default");
-            defaultShader->use();
-            defaultShader->setUniform("color", fcolor);
-            defaultShader->setUniform("MVP", getMVP());
-
-            VertexArray vertexArray;
+        void Renderer::setMVP(const glm::mat4& MVP) {
+            _MVP = MVP;
+        }
 
-            std::unique_ptr<VertexBuffer> coordinatesVertexBuffer =
-                std::make_unique<VertexBuffer>(&vertices[0], vertices.size() * sizeof(glm::vec2), VertexBuffer::UsagePattern::DynamicDraw);
-            VertexBufferLayout coordinatesVertexBufferLayout;
-            coordinatesVertexBufferLayout.addAttribute({(unsigned int)defaultShader->getAttrib("Position"), 2, VertexBufferAttribute::Type::Float});
-            vertexArray.addBuffer(coordinatesVertexBuffer, coordinatesVertexBufferLayout);
+        void Renderer::drawRect(int x, int y, int w, int h, SDL_Color color) {
+            if (!_defaultShader) {
+                _defaultShader = ResourceManager::getInstance()->shader("default");
+                _defaultUniformColor = _defaultShader->getUniform("color");
+                _defaultUniformMVP = _defaultShader->getUniform("MVP");
+                _defaultAttribPos = _defaultShader->getAttrib("Position");
+            }
 
-            static unsigned int indexes[6] = {0, 1, 2, 3, 2, 1};
-            IndexBuffer indexBuffer(indexes, 6, IndexBuffer::UsagePattern::StaticDraw);
+            SpriteBatch::State state;
+            state.shader = _defaultShader;
+            state.positionAttrib = _defaultAttribPos;
+            state.color = glm::vec4((float)color.r / 255.0f, (float)color.g / 255.0f, (float)color.b / 255.0f, (float)color.a / 255.0f);
 
-            GL_CHECK(glDrawElements(GL_TRIANGLES, indexBuffer.count(), GL_UNSIGNED_INT, nullptr));
+            if (_spriteBatch->begin(state)) {
+                _defaultShader->setUniform(_defaultUniformColor, state.color);
+                _defaultShader->setUniform(_defaultUniformMVP, _MVP);
+            }
+            _spriteBatch->add(glm::vec4((float)x, (float)y, (float)(x + w), (float)(y + h)), glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
         }
 
         void Renderer::drawRect(const Point& pos, const Size& size, SDL_Color color) {
@@ -329,161 +507,158 @@ namespace Falltergeist {
         }
 
         void Renderer::drawRectangle(const Rectangle& rectangle, const Texture* const texture) {
-            float x1 = (float)rectangle.position().x();
-            float y1 = (float)rectangle.position().y();
-            float x2 = (float)(rectangle.position().x() + rectangle.size().width());
-            float y2 = (float)(rectangle.position().y() + rectangle.size().height());
-            std::vector<glm::vec2> vertices = {
-                // aPosition       // aTexturePosition
-                glm::vec2(x1, y1), glm::vec2(0.0, 0.0), glm::vec2(x1, y2), glm::vec2(0.0, 1.0),
-                glm::vec2(x2, y1), glm::vec2(1.0, 0.0), glm::vec2(x2, y2), glm::vec2(1.0, 1.0),
-            };
-
-            auto spriteShader = ResourceManager::getInstance()->shader("video");
-            spriteShader->use();
-
-            texture->bind(0);
-            spriteShader->setUniform("uTexture", 0);
-            spriteShader->setUniform("uProjectionMatrix", getMVP());
-
-            std::unique_ptr<VertexBuffer> vertexBuffer =
-                std::make_unique<VertexBuffer>(&vertices[0], vertices.size() * sizeof(glm::vec2), VertexBuffer::UsagePattern::StaticDraw);
-            VertexBufferLayout vertexBufferLayout({
-                {0, 2, VertexBufferAttribute::Type::Float}, // aPosition
-                {1, 2, VertexBufferAttribute::Type::Float}  // aTexturePosition
-            });
-            VertexArray vertexArray;
-            vertexArray.addBuffer(vertexBuffer, vertexBufferLayout);
-
-            static unsigned int indexes[6] = {0, 1, 2, 3, 2, 1};
-            IndexBuffer indexBuffer(indexes, 6, IndexBuffer::UsagePattern::StaticDraw);
-
-            GL_CHECK(glDrawElements(GL_TRIANGLES, indexBuffer.count(), GL_UNSIGNED_INT, nullptr));
+            _beginVideoBatch(texture);
+            _spriteBatch->add(
+                glm::vec4(
+                    (float)rectangle.position().x(),
+                    (float)rectangle.position().y(),
+                    (float)(rectangle.position().x() + rectangle.size().width()),
+                    (float)(rectangle.position().y() + rectangle.size().height())
+                ),
+                texture->texCoords()
+            );
         }
 
         void Renderer::drawPartialRectangle(const Point& point, const Rectangle& rectangle, const Texture* const texture) {
-            auto x1 = (float)point.x();
-            auto y1 = (float)point.y();
-            auto x2 = (float)(point.x() + rectangle.size().width());
-            auto y2 = (float)(point.y() + rectangle.size().height());
-
-            auto dx1 = (float)rectangle.position().x() / (float)texture->size().width();
-            auto dy1 = (float)rectangle.position().y() / (float)texture->size().height();
-            auto dx2 = (float)(rectangle.position().x() + rectangle.size().width()) / (float)texture->size().width();
-            auto dy2 = (float)(rectangle.position().y() + rectangle.size().height()) / (float)texture->size().height();
-
-            std::vector<glm::vec2> vertices = {
-                // aPosition       // aTexturePosition
-                glm::vec2(x1, y1), glm::vec2(dx1, dy1), glm::vec2(x1, y2), glm::vec2(dx1, dy2),
-                glm::vec2(x2, y1), glm::vec2(dx2, dy1), glm::vec2(x2, y2), glm::vec2(dx2, dy2),
-            };
-
-            auto spriteShader = ResourceManager::getInstance()->shader("video");
-            spriteShader->use();
-
-            texture->bind(0);
-            spriteShader->setUniform("uTexture", 0);
-            spriteShader->setUniform("uProjectionMatrix", getMVP());
-
-            std::unique_ptr<VertexBuffer> vertexBuffer =
-                std::make_unique<VertexBuffer>(&vertices[0], vertices.size() * sizeof(glm::vec2), VertexBuffer::UsagePattern::StaticDraw);
-            VertexBufferLayout vertexBufferLayout({
-                {0, 2, VertexBufferAttribute::Type::Float}, // aPosition
-                {1, 2, VertexBufferAttribute::Type::Float}  // aTexturePosition
-            });
-            VertexArray vertexArray;
-            vertexArray.addBuffer(vertexBuffer, vertexBufferLayout);
-
-            static unsigned int indexes[6] = {0, 1, 2, 3, 2, 1};
-            IndexBuffer indexBuffer(indexes, 6, IndexBuffer::UsagePattern::StaticDraw);
-
-            GL_CHECK(glDrawElements(GL_TRIANGLES, indexBuffer.count(), GL_UNSIGNED_INT, nullptr));
+            _beginVideoBatch(texture);
+
+            _spriteBatch->add(
+                glm::vec4(
+                    (float)point.x(),
+                    (float)point.y(),
+                    (float)(point.x() + rectangle.size().width()),
+                    (float)(point.y() + rectangle.size().height())
+                ),
+                texture->texCoords(rectangle)
+            );
         }
 
-        void Renderer::drawRectangle(const Rectangle& rectangle, const Texture* const texture, const Texture* const egg, const Shader* const shader) {
-            glm::vec2 vertices[4] = {glm::vec2((float)rectangle.position().x(), (float)rectangle.position().y()),
-                                     glm::vec2((float)rectangle.position().x(), (float)(rectangle.position().y() + rectangle.size().height())),
-                                     glm::vec2((float)(rectangle.position().x() + rectangle.size().width()), (float)rectangle.position().y()),
-                                     glm::vec2((float)(rectangle.position().x() + rectangle.size().width()),
-                                               (float)(rectangle.position().y() + rectangle.size().height()))};
-            glm::vec2 UV[4] = {glm::vec2(0.0, 0.0), glm::vec2(0.0, 1.0), glm::vec2(1.0, 0.0), glm::vec2(1.0, 1.0)};
+        void Renderer::_beginVideoBatch(const Texture* const texture) {
+            if (!_videoShader) {
+                _videoShader = ResourceManager::getInstance()->shader("video");
+                _videoUniformTexture = _videoShader->getUniform("uTexture");
+                _videoUniformMVP = _videoShader->getUniform("uProjectionMatrix");
+            }
 
-            shader->use();
+            SpriteBatch::State state;
+            state.shader = _videoShader;
+            state.texture = texture;
+            state.positionAttrib = 0; // aPosition
+            state.texCoordAttrib = 1; // aTexturePosition
 
-            texture->bind(0);
-            egg->bind(1);
+            if (_spriteBatch->begin(state)) {
+                _videoShader->setUniform(_videoUniformTexture, 0);
+                _videoShader->setUniform(_videoUniformMVP, _MVP);
+            }
+        }
 
-            VertexArray vertexArray;
+        SpriteBatch* Renderer::spriteBatch() {
+            return _spriteBatch.get();
+        }
 
-            std::unique_ptr<VertexBuffer> coordinatesVertexBuffer =
-                std::make_unique<VertexBuffer>(&vertices[0], sizeof(vertices), VertexBuffer::UsagePattern::DynamicDraw);
+        void Renderer::flush() {
+            _spriteBatch->flush();
+        }
 
-            VertexBufferLayout coordinatesVertexBufferLayout;
-            coordinatesVertexBufferLayout.addAttribute({(unsigned int)shader->getAttrib("Position"), 2, VertexBufferAttribute::Type::Float});
-            vertexArray.addBuffer(coordinatesVertexBuffer, coordinatesVertexBufferLayout);
+        RenderStats* Renderer::stats() {
+            return _stats.get();
+        }
 
-            std::unique_ptr<VertexBuffer> textureCoordinatesVertexBuffer =
-                std::make_unique<VertexBuffer>(&UV[0], sizeof(UV), VertexBuffer::UsagePattern::DynamicDraw);
-            VertexBufferLayout textureCoordinatesVertexBufferLayout;
-            textureCoordinatesVertexBufferLayout.addAttribute({(unsigned int)shader->getAttrib("TexCoord"), 2, VertexBufferAttribute::Type::Float});
-            vertexArray.addBuffer(textureCoordinatesVertexBuffer, textureCoordinatesVertexBufferLayout);
+        void Renderer::beginPass(RenderStats::Pass pass) {
+            if (_stats->timing()) {
+                _spriteBatch->flush();
+                _stats->beginPass(pass);
+            }
+        }
 
-            static unsigned int indexes[6] = {0, 1, 2, 3, 2, 1};
-            IndexBuffer indexBuffer(indexes, 6, IndexBuffer::UsagePattern::StaticDraw);
+        bool Renderer::supportsFrameBuffers() {
+            return _renderpath == RenderPath::OGL32;
+        }
 
-            GL_CHECK(glDrawElements(GL_TRIANGLES, indexBuffer.count(), GL_UNSIGNED_INT, nullptr));
+        bool Renderer::supportsInstancing() {
+            return _renderpath == RenderPath::OGL32 && (GLEW_VERSION_3_3 || GLEW_ARB_instanced_arrays);
         }
 
-        void Renderer::drawPartialRectangle(const Point& point, const Rectangle& rectangle, const Texture* const texture, const Texture* const egg,
-                                            const Shader* const shader) {
-            glm::vec2 vertices[4] = {glm::vec2((float)point.x(), (float)point.y()),
-                                     glm::vec2((float)point.x(), (float)(point.y() + rectangle.size().height())),
-                                     glm::vec2((float)(point.x() + rectangle.size().width()), (float)point.y()),
-                                     glm::vec2((float)(point.x() + rectangle.size().width()), (float)(point.y() + rectangle.size().height()))};
-            glm::vec2 UV[4] = {glm::vec2((float)rectangle.position().x() / (float)texture->size().width(),
-                                         (float)rectangle.position().y() / (float)texture->size().height()),
-                               glm::vec2((float)rectangle.position().x() / (float)texture->size().width(),
-                                         (float)(rectangle.position().y() + rectangle.size().height()) / (float)texture->size().height()),
-                               glm::vec2((float)(rectangle.position().x() + rectangle.size().width()) / (float)texture->size().width(),
-                                         (float)rectangle.position().y() / (float)texture->size().height()),
-                               glm::vec2((float)(rectangle.position().x() + rectangle.size().width()) / (float)texture->size().width(),
-                                         (float)(rectangle.position().y() + rectangle.size().height()) / (float)texture->size().height())};
+        bool Renderer::supportsPersistentMapping() {
+            return _renderpath == RenderPath::OGL32 && GLEW_ARB_buffer_storage;
+        }
 
-            shader->use();
-            texture->bind(0);
-            egg->bind(1);
+        bool Renderer::supportsTextureArrays() {
+            return _renderpath == RenderPath::OGL32 && _maxTextureArrayLayers > 0;
+        }
 
-            VertexArray vertexArray;
+        void Renderer::beginFrameBuffer(FrameBuffer* frameBuffer) {
+            _spriteBatch->flush();
+            frameBuffer->bind();
+            // the layer starts transparent, so its alpha has to accumulate coverage instead of being blended
+            _glState->setBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        }
 
-            std::unique_ptr<VertexBuffer> coordinatesVertexBuffer =
-                std::make_unique<VertexBuffer>(&vertices[0], sizeof(vertices), VertexBuffer::UsagePattern::DynamicDraw);
-            VertexBufferLayout coordinatesVertexBufferLayout;
-            coordinatesVertexBufferLayout.addAttribute({(unsigned int)shader->getAttrib("Position"), 2, VertexBufferAttribute::Type::Float});
-            vertexArray.addBuffer(coordinatesVertexBuffer, coordinatesVertexBufferLayout);
+        void Renderer::endFrameBuffer(FrameBuffer* frameBuffer) {
+            _spriteBatch->flush();
+            frameBuffer->unbind();
+            _glState->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
 
-            std::unique_ptr<VertexBuffer> textureCoordinatesVertexBuffer =
-                std::make_unique<VertexBuffer>(&UV[0], sizeof(UV), VertexBuffer::UsagePattern::DynamicDraw);
-            VertexBufferLayout textureCoordinatesVertexBufferLayout;
-            textureCoordinatesVertexBufferLayout.addAttribute({(unsigned int)shader->getAttrib("TexCoord"), 2, VertexBufferAttribute::Type::Float});
-            vertexArray.addBuffer(textureCoordinatesVertexBuffer, textureCoordinatesVertexBufferLayout);
+        void Renderer::drawFrameBuffer(const FrameBuffer* frameBuffer) {
+            _spriteBatch->flush();
+            // colors of the layer are already multiplied by its alpha
+            _glState->setBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-            static unsigned int indexes[6] = {0, 1, 2, 3, 2, 1};
-            IndexBuffer indexBuffer(indexes, 6, IndexBuffer::UsagePattern::StaticDraw);
+            _beginVideoBatch(frameBuffer->texture());
+            _spriteBatch->add(
+                glm::vec4(0.0f, 0.0f, (float)frameBuffer->size().width(), (float)frameBuffer->size().height()),
+                glm::vec4(0.0f, 1.0f, 1.0f, 0.0f)
+            );
+            _spriteBatch->flush();
 
-            GL_CHECK(glDrawElements(GL_TRIANGLES, indexBuffer.count(), GL_UNSIGNED_INT, nullptr));
+            _glState->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         }
 
         glm::vec4 Renderer::fadeColor() {
             return glm::vec4((float)_fadeColor.r / 255.0, (float)_fadeColor.g / 255.0, (float)_fadeColor.b / 255.0, (float)_fadeColor.a / 255.0);
         }
 
+        glm::vec4 Renderer::drawFadeColor() {
+            return _scene ? glm::vec4(0.0f, 0.0f, 0.0f, 0.0f) : fadeColor();
+        }
+
         int32_t Renderer::maxTextureSize() {
             return 1024;
             return _maxTexSize;
         }
 
+        int32_t Renderer::maxTextureArrayLayers() {
+            return _maxTextureArrayLayers;
+        }
+
         Texture* Renderer::egg() {
-            return _egg;
+            return _egg.get();
+        }
+
+        Texture* Renderer::palette() {
+            if (!_palette) {
+                auto pal = ResourceManager::getInstance()->palFileType("color.pal");
+                _paletteColors.assign(256, 0);
+                for (unsigned int i = 0; i != _paletteColors.size(); ++i) {
+                    _paletteColors[i] = *pal->color(i);
+                }
+                auto animatedPalette = Game::getInstance()->animatedPalette();
+                animatedPalette->animate(_paletteColors.data());
+                _paletteVersion = animatedPalette->version();
+                _palette = std::make_unique<Texture>(Pixels(_paletteColors.data(), Size(256, 1), Pixels::Format::RGBA));
+            }
+            return _palette.get();
+        }
+
+        void Renderer::updatePalette(const AnimatedPalette& animatedPalette) {
+            // nothing is rendered from indexed textures yet
+            if (!_palette || animatedPalette.version() == _paletteVersion) {
+                return;
+            }
+            animatedPalette.animate(_paletteColors.data());
+            _paletteVersion = animatedPalette.version();
+            _palette->update(Pixels(_paletteColors.data(), Size(256, 1), Pixels::Format::RGBA));
         }
 
         Renderer::RenderPath Renderer::renderPath() {
@@ -6,19 +6,27 @@
 #include <glm/glm.hpp>
 #include <GL/glew.h>
 #include <SDL.h>
+#include "../Graphics/GLState.h"
 #include "../Graphics/IRendererConfig.h"
 #include "../Graphics/Point.h"
 #include "../Graphics/Rectangle.h"
+#include "../Graphics/RenderStats.h"
 #include "../Graphics/Shader.h"
 #include "../Graphics/Size.h"
 #include "../Graphics/SdlWindow.h"
+#include "../Graphics/SpriteBatch.h"
 #include "../ILogger.h"
 
 namespace Falltergeist
 {
     namespace Graphics
     {
+        class AnimatedPalette;
+        class FrameBuffer;
+        class ScreenCapture;
         class Texture;
+        class TextureResidency;
+        class TextureUploadQueue;
 
         class Renderer
         {
@@ -59,6 +67,9 @@ namespace Falltergeist
 
                 glm::mat4 getMVP();
 
+                // Projection of the batches begun from now on, PickingPass narrows it down to a pixel
+                void setMVP(const glm::mat4& MVP);
+
                 void drawRect(int x, int y, int w, int h, SDL_Color color);
 
                 void drawRect(const Point &pos, const Size &size, SDL_Color color);
@@ -68,20 +79,77 @@ namespace Falltergeist
                 // Draw rectangle part of the texture in the given position. unscaled
                 void drawPartialRectangle(const Point& point, const Rectangle& rectangle, const Texture* const texture);
 
-                // Draw scaled texture in the rectangle
-                void drawRectangle(const Rectangle& rectangle, const Texture* const texture, const Texture* const egg, const Shader* const shader);
+                // Batches textured quads, Sprite and Animation render through it
+                SpriteBatch* spriteBatch();
 
-                // Draw rectangle part of the texture in the given position. unscaled
-                void drawPartialRectangle(const Point& position, const Rectangle& rectangle, const Texture* const texture, const Texture* const egg, const Shader* const shader);
+                // Draws batched quads, must be called before rendering with GL directly
+                void flush();
+
+                // Draw calls, binds and uploads of the frames, and GPU times of the passes if timing is on
+                RenderStats* stats();
+
+                // Starts timing the next pass of the frame, pending quads are drawn first so they count to the previous one
+                void beginPass(RenderStats::Pass pass);
+
+                // Offscreen layers need framebuffer objects and the video shader of the 3.2 path
+                bool supportsFrameBuffers();
+
+                // Instanced attributes for the tilemap, the 3.2 path with 3.3 or ARB_instanced_arrays
+                bool supportsInstancing();
+
+                // Streamed vertices are written into persistently mapped storage, the 3.2 path with ARB_buffer_storage
+                bool supportsPersistentMapping();
+
+                // GL_TEXTURE_2D_ARRAY for the tilemap atlases, core on the 3.2 path
+                bool supportsTextureArrays();
+
+                // Renders everything until endFrameBuffer() into the framebuffer, with alpha suitable for drawFrameBuffer()
+                void beginFrameBuffer(FrameBuffer* frameBuffer);
+
+                void endFrameBuffer(FrameBuffer* frameBuffer);
+
+                // Composites a layer rendered with beginFrameBuffer() over the screen
+                void drawFrameBuffer(const FrameBuffer* frameBuffer);
+
+                // Sprites and animations rendered while it isn't 0 write the id instead of their colors, see PickingPass
+                void setPickId(uint32_t id);
+                uint32_t pickId() const;
 
                 glm::vec4 fadeColor();
 
+                // Fade mixed in by the shaders of the draws, transparent while the composition pass applies the fade
+                glm::vec4 drawFadeColor();
+
+                // Whether the frame is rendered at the game resolution into a framebuffer, then scaled, faded
+                // and gamma corrected into the window by one last pass
+                bool composing() const;
+
+                const Size& windowSize() const;
+
+                // Positions in the window and in the game resolution, they differ while scaled
+                Point fromWindow(const Point& point) const;
+                Point toWindow(const Point& point) const;
+
+                // Saved from the next frame, the file is written on a worker thread a few frames later
                 void screenshot();
 
+                // Saves every frame to numbered files while on, for bug reports
+                void setCapturing(bool capturing);
+                bool capturing() const;
+
                 int32_t maxTextureSize();
 
+                // Layers of a texture array, 0 without support for them
+                int32_t maxTextureArrayLayers();
+
                 Texture* egg();
 
+                // color.pal as a 256x1 texture for shaders rendering indexed textures, animated indexes hold their current colors
+                Texture* palette();
+
+                // Writes the current animated colors into the palette texture, once per frame before rendering
+                void updatePalette(const AnimatedPalette& animatedPalette);
+
                 RenderPath renderPath();
 
             protected:
@@ -115,17 +183,82 @@ namespace Falltergeist
 
                 int32_t _maxTexSize;
 
-                Texture* _egg;
+                GLint _maxTextureArrayLayers = 0;
+
+                std::shared_ptr<Texture> _egg;
+
+                std::unique_ptr<Texture> _palette;
+
+                std::vector<uint32_t> _paletteColors;
+
+                // AnimatedPalette::version() of the colors in the palette texture
+                unsigned int _paletteVersion = 0;
+
+                std::unique_ptr<GLState> _glState;
+
+                std::unique_ptr<SpriteBatch> _spriteBatch;
+
+                std::unique_ptr<RenderStats> _stats;
+
+                std::unique_ptr<ScreenCapture> _capture;
+
+                // only with a texture budget
+                std::unique_ptr<TextureResidency> _textureResidency;
+
+                // only with a texture upload budget
+                std::unique_ptr<TextureUploadQueue> _textureUploadQueue;
+
+                uint32_t _pickId = 0;
 
             private:
                 std::unique_ptr<IRendererConfig> _rendererConfig;
 
                 std::shared_ptr<ILogger> _logger;
 
-                // TODO use _sdlWindow boundaries instead
+                // game resolution, the window size unless composing scaled
                 Size _size;
 
+                Size _windowSize;
+
                 std::shared_ptr<SdlWindow> _sdlWindow;
+
+                // shaders of drawRect() and the video quads, resolved on first use
+                Shader* _defaultShader = nullptr;
+                GLint _defaultUniformColor = -1;
+                GLint _defaultUniformMVP = -1;
+                GLint _defaultAttribPos = -1;
+
+                Shader* _videoShader = nullptr;
+                GLint _videoUniformTexture = -1;
+                GLint _videoUniformMVP = -1;
+
+                // composition pass, the scene is drawn into the output rectangle of the window
+                std::unique_ptr<FrameBuffer> _scene;
+                Point _outputPosition;
+                Size _outputSize;
+                glm::mat4 _windowMVP;
+                bool _xbr = false;
+                Shader* _composeShader = nullptr;
+                GLint _composeUniformTexture = -1;
+                GLint _composeUniformTextureSize = -1;
+                GLint _composeUniformXbr = -1;
+                GLint _composeUniformFade = -1;
+                GLint _composeUniformGamma = -1;
+                GLint _composeUniformMVP = -1;
+                GLint _composeAttribPos = -1;
+                GLint _composeAttribTex = -1;
+
+                // Starts a batch drawing the texture with the video shader
+                void _beginVideoBatch(const Texture* const texture);
+
+                void _initComposition();
+
+                // Sets the render path and the GL version of the created context
+                void _createContext();
+
+                void _createGlesContext();
+
+                void _compose();
         };
     }
 }
@@ -10,7 +10,14 @@ namespace Falltergeist
             int32_t x,
             int32_t y,
             bool isFullscreen,
-            bool isAlwaysOnTop
+            bool isAlwaysOnTop,
+            bool isVsync,
+            bool isGles,
+            uint32_t scale,
+            const std::string& scaleFilter,
+            float gamma,
+            size_t textureBudget,
+            size_t textureUploadBudget
         ) {
             _width = width;
             _height = height;
@@ -18,6 +25,13 @@ namespace Falltergeist
             _y = y;
             _isFullscreen = isFullscreen;
             _isAlwaysOnTop = isAlwaysOnTop;
+            _isVsync = isVsync;
+            _isGles = isGles;
+            _scale = scale;
+            _scaleFilter = scaleFilter;
+            _gamma = gamma;
+            _textureBudget = textureBudget;
+            _textureUploadBudget = textureUploadBudget;
         }
 
         uint32_t RendererConfig::width()
@@ -49,5 +63,40 @@ namespace Falltergeist
         {
             return _isAlwaysOnTop;
         }
+
+        bool RendererConfig::isVsync()
+        {
+            return _isVsync;
+        }
+
+        bool RendererConfig::isGles()
+        {
+            return _isGles;
+        }
+
+        uint32_t RendererConfig::scale()
+        {
+            return _scale;
+        }
+
+        const std::string& RendererConfig::scaleFilter()
+        {
+            return _scaleFilter;
+        }
+
+        float RendererConfig::gamma()
+        {
+            return _gamma;
+        }
+
+        size_t RendererConfig::textureBudget()
+        {
+            return _textureBudget;
+        }
+
+        size_t RendererConfig::textureUploadBudget()
+        {
+            return _textureUploadBudget;
+        }
     }
 }
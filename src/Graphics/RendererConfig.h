@@ -15,7 +15,14 @@ namespace Falltergeist
                     int32_t x,
                     int32_t y,
                     bool isFullscreen,
-                    bool isAlwaysOnTop
+                    bool isAlwaysOnTop,
+                    bool isVsync,
+                    bool isGles,
+                    uint32_t scale,
+                    const std::string& scaleFilter,
+                    float gamma,
+                    size_t textureBudget,
+                    size_t textureUploadBudget
                 );
 
                 uint32_t width() override;
@@ -24,6 +31,13 @@ namespace Falltergeist
                 int32_t y() override;
                 bool isFullscreen() override;
                 bool isAlwaysOnTop() override;
+                bool isVsync() override;
+                bool isGles() override;
+                uint32_t scale() override;
+                const std::string& scaleFilter() override;
+                float gamma() override;
+                size_t textureBudget() override;
+                size_t textureUploadBudget() override;
 
             private:
                 uint32_t _width;
@@ -32,6 +46,13 @@ namespace Falltergeist
                 int32_t _y;
                 bool _isFullscreen;
                 bool _isAlwaysOnTop;
+                bool _isVsync;
+                bool _isGles;
+                uint32_t _scale;
+                std::string _scaleFilter;
+                float _gamma;
+                size_t _textureBudget;
+                size_t _textureUploadBudget;
         };
     }
 }
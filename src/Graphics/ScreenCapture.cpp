@@ -0,0 +1,199 @@
+#include <cstring>
+#include <SDL.h>
+#include <SDL_image.h>
+#include "../Base/ThreadPool.h"
+#include "../CrossPlatform.h"
+#include "../Graphics/GLCheck.h"
+#include "../Graphics/ScreenCapture.h"
+
+namespace Falltergeist {
+    namespace Graphics {
+        namespace {
+            // Flips the rows read bottom up, makes the pixels opaque and writes the PNG
+            bool encode(const std::vector<uint8_t>& pixels, int width, int height, const std::string& filename) {
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+                const Uint32 rmask = 0xff000000, gmask = 0x00ff0000, bmask = 0x0000ff00, amask = 0x000000ff;
+#else
+                const Uint32 rmask = 0x000000ff, gmask = 0x0000ff00, bmask = 0x00ff0000, amask = 0xff000000;
+#endif
+                SDL_Surface* output = SDL_CreateRGBSurface(0, width, height, 32, rmask, gmask, bmask, amask);
+                if (!output) {
+                    return false;
+                }
+                const size_t row = static_cast<size_t>(width) * 4;
+                for (int y = 0; y < height; ++y) {
+                    auto destination = static_cast<uint8_t*>(output->pixels) + static_cast<size_t>(output->pitch) * y;
+                    std::memcpy(destination, pixels.data() + row * (height - 1 - y), row);
+                    auto colors = reinterpret_cast<uint32_t*>(destination);
+                    for (int x = 0; x < width; ++x) {
+                        colors[x] |= amask;
+                    }
+                }
+                bool saved = IMG_SavePNG(output, filename.c_str()) == 0;
+                SDL_FreeSurface(output);
+                return saved;
+            }
+        }
+
+        ScreenCapture::ScreenCapture(const Size& size, std::shared_ptr<ILogger> logger) : _size(size), _logger(std::move(logger)) {
+            const auto bytes = static_cast<GLsizeiptr>(_size.width()) * _size.height() * 4;
+            for (auto& slot : _slots) {
+                GL_CHECK(glGenBuffers(1, &slot.buffer));
+                GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer));
+                GL_CHECK(glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ));
+            }
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        }
+
+        ScreenCapture::~ScreenCapture() {
+            for (auto& slot : _slots) {
+                if (slot.pending) {
+                    _collect(slot);
+                }
+                GL_CHECK(glDeleteBuffers(1, &slot.buffer));
+            }
+            // joins after the queued files are written
+            _encoder.reset();
+            _logResults();
+        }
+
+        void ScreenCapture::screenshot() {
+            _screenshotRequested = true;
+        }
+
+        void ScreenCapture::setContinuous(bool continuous) {
+            if (continuous && !_continuous) {
+                _captureIndex = _freeIndex("capture", 5, 100000);
+                _dropped = 0;
+                _logger->info() << "[RENDERER] Capturing frames from capture" << _filename("", 5, _captureIndex) << ".png" << std::endl;
+            } else if (!continuous && _continuous) {
+                _logger->info() << "[RENDERER] Frame capture stopped, " << _dropped << " frames dropped" << std::endl;
+            }
+            _continuous = continuous;
+        }
+
+        bool ScreenCapture::continuous() const {
+            return _continuous;
+        }
+
+        void ScreenCapture::endFrame() {
+            _frame++;
+            _logResults();
+
+            // copies started LATENCY frames ago are done by now, mapping them doesn't wait
+            for (auto& slot : _slots) {
+                if (slot.pending && _frame - slot.frame >= LATENCY) {
+                    _collect(slot);
+                }
+            }
+
+            if (_screenshotRequested) {
+                _screenshotRequested = false;
+                if (!_screenshotsProbed) {
+                    _screenshotIndex = _freeIndex("screenshot", 3, 1000);
+                    _screenshotsProbed = true;
+                }
+                if (_screenshotIndex >= 1000) {
+                    _logger->warning() << "[RENDERER] Too many screenshots" << std::endl;
+                } else {
+                    _read(_slots[_next], _filename("screenshot", 3, _screenshotIndex++) + ".png");
+                }
+            }
+            if (_continuous) {
+                unsigned int pending = _encoding;
+                for (auto& slot : _slots) {
+                    pending += slot.pending ? 1 : 0;
+                }
+                if (pending >= MAX_PENDING || _captureIndex >= 100000) {
+                    _dropped++;
+                } else {
+                    _read(_slots[_next], _filename("capture", 5, _captureIndex++) + ".png");
+                }
+            }
+        }
+
+        void ScreenCapture::_read(Slot& slot, std::string filename) {
+            // all the slots are busy only with a screenshot and a capture in the same frame
+            if (slot.pending) {
+                _collect(slot);
+            }
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer));
+            GL_CHECK(glReadBuffer(GL_BACK));
+            GL_CHECK(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+            // with a pack buffer bound the pointer is an offset, the call returns once the copy is queued
+            GL_CHECK(glReadPixels(0, 0, _size.width(), _size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+            slot.pending = true;
+            slot.frame = _frame;
+            slot.filename = std::move(filename);
+            _next = (_next + 1) % _slots.size();
+        }
+
+        void ScreenCapture::_collect(Slot& slot) {
+            slot.pending = false;
+            const size_t bytes = static_cast<size_t>(_size.width()) * _size.height() * 4;
+            auto pixels = std::make_shared<std::vector<uint8_t>>(bytes);
+
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer));
+            auto mapped = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+            if (mapped) {
+                std::memcpy(pixels->data(), mapped, bytes);
+                GL_CHECK(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+            }
+            GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+            if (!mapped) {
+                _logger->warning() << "[RENDERER] Cannot map the pixels of " << slot.filename << std::endl;
+                return;
+            }
+
+            if (!_encoder) {
+                _encoder = std::make_unique<Base::ThreadPool>(1);
+            }
+            _encoding++;
+            const int width = _size.width();
+            const int height = _size.height();
+            auto filename = slot.filename;
+            _encoder->enqueue([this, pixels, width, height, filename]() {
+                bool saved = encode(*pixels, width, height, filename);
+                std::lock_guard<std::mutex> lock(_resultsMutex);
+                _results.emplace_back(filename, saved);
+            });
+        }
+
+        void ScreenCapture::_logResults() {
+            std::vector<std::pair<std::string, bool>> results;
+            {
+                std::lock_guard<std::mutex> lock(_resultsMutex);
+                results.swap(_results);
+            }
+            for (auto& result : results) {
+                _encoding--;
+                // continuous capture isn't logged frame by frame
+                if (result.first.compare(0, 7, "capture") == 0 && result.second) {
+                    continue;
+                }
+                if (result.second) {
+                    _logger->info() << "[RENDERER] Screenshot saved to " << result.first << std::endl;
+                } else {
+                    _logger->warning() << "[RENDERER] Cannot save " << result.first << std::endl;
+                }
+            }
+        }
+
+        unsigned int ScreenCapture::_freeIndex(const std::string& prefix, unsigned int digits, unsigned int limit) {
+            unsigned int index = 0;
+            while (index < limit && CrossPlatform::fileExists(_filename(prefix, digits, index) + ".png")) {
+                index++;
+            }
+            return index;
+        }
+
+        std::string ScreenCapture::_filename(const std::string& prefix, unsigned int digits, unsigned int index) {
+            std::string number = std::to_string(index);
+            if (number.size() < digits) {
+                number.insert(0, digits - number.size(), '0');
+            }
+            return prefix + number;
+        }
+    }
+}
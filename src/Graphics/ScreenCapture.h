@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../Graphics/Size.h"
+#include "../ILogger.h"
+
+namespace Falltergeist {
+    namespace Base {
+        class ThreadPool;
+    }
+
+    namespace Graphics {
+        /**
+         * Reads the back buffer into pixel pack buffers without waiting for the GPU. The buffers are mapped
+         * LATENCY frames later, when the copy is done, and a worker thread flips and encodes the PNG files.
+         * Besides single screenshots every frame can be captured while continuous capture is on,
+         * frames are dropped rather than stalling the game if the encoder falls behind.
+         */
+        class ScreenCapture final {
+        public:
+            static const unsigned int LATENCY = 2;
+            // frames read or encoded at once before continuous capture drops frames
+            static const unsigned int MAX_PENDING = 6;
+
+            ScreenCapture(const Size& size, std::shared_ptr<ILogger> logger);
+            // Releases the buffers, so the GL context has to be alive. Queued files are still written
+            ~ScreenCapture();
+
+            ScreenCapture(const ScreenCapture&) = delete;
+            ScreenCapture& operator=(const ScreenCapture&) = delete;
+
+            // The next frame is saved as screenshotNNN.png
+            void screenshot();
+
+            // Saves every frame as captureNNNNN.png while on
+            void setContinuous(bool continuous);
+            bool continuous() const;
+
+            // Called with the finished frame in the back buffer, before it is presented
+            void endFrame();
+
+        private:
+            struct Slot {
+                unsigned int buffer = 0;
+                bool pending = false;
+                unsigned int frame = 0;
+                std::string filename;
+            };
+
+            Size _size;
+            std::shared_ptr<ILogger> _logger;
+            std::array<Slot, LATENCY + 1> _slots;
+            size_t _next = 0;
+            unsigned int _frame = 0;
+
+            bool _screenshotRequested = false;
+            unsigned int _screenshotIndex = 0;
+            bool _screenshotsProbed = false;
+            bool _continuous = false;
+            unsigned int _captureIndex = 0;
+            unsigned int _dropped = 0;
+
+            std::unique_ptr<Base::ThreadPool> _encoder;
+            // written by the encoder, logged on the main thread
+            std::mutex _resultsMutex;
+            std::vector<std::pair<std::string, bool>> _results;
+            unsigned int _encoding = 0;
+
+            // First of the numbered names not taken yet, probed once and then counted up
+            static unsigned int _freeIndex(const std::string& prefix, unsigned int digits, unsigned int limit);
+            static std::string _filename(const std::string& prefix, unsigned int digits, unsigned int index);
+
+            void _read(Slot& slot, std::string filename);
+            void _collect(Slot& slot);
+            void _logResults();
+        };
+    }
+}
@@ -3,10 +3,11 @@
 
 namespace Falltergeist {
     namespace Graphics {
-        SdlWindow::SdlWindow(const std::string& title, const Rectangle& boundaries, bool isFullscreen, std::shared_ptr<ILogger> logger)
+        SdlWindow::SdlWindow(const std::string& title, const Rectangle& boundaries, bool isFullscreen, std::shared_ptr<ILogger> logger, bool isHidden, bool isGles)
             : _title(title), _boundaries(boundaries), _isFullscreen(isFullscreen), _logger(logger) {
 
-            Uint32 flags = SDL_WindowFlags::SDL_WINDOW_SHOWN | SDL_WindowFlags::SDL_WINDOW_OPENGL;
+            Uint32 flags = SDL_WindowFlags::SDL_WINDOW_OPENGL;
+            flags |= isHidden ? SDL_WindowFlags::SDL_WINDOW_HIDDEN : SDL_WindowFlags::SDL_WINDOW_SHOWN;
 
             if (_isFullscreen) {
                 flags |= SDL_WindowFlags::SDL_WINDOW_FULLSCREEN;
@@ -23,6 +24,17 @@ namespace Falltergeist {
                 }
             }
 
+            if (isGles) {
+                // every pixel written back by a tiled GPU is two bytes instead of four
+                SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
+                SDL_GL_SetAttribute(SDL_GL_RED_SIZE, 5);
+                SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 6);
+                SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 5);
+                SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 0);
+                SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 0);
+                SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 0);
+            }
+
             auto sdlDisplay = SdlDisplay::getAvailableDisplays().at(DEFAULT_DISPLAY_NUMBER);
             auto windowPosition = _boundaries.position() + sdlDisplay.boundaries().position();
 
@@ -12,7 +12,9 @@ namespace Falltergeist {
     namespace Graphics {
         class SdlWindow final : public IWindow {
         public:
-            SdlWindow(const std::string& title, const Rectangle& boundaries, bool isFullscreen, std::shared_ptr<ILogger> logger);
+            // A hidden window still has a GL context, which is all the benchmark needs
+            // A GLES window gets a 16 bit framebuffer without depth, its pixel format is chosen with the window
+            SdlWindow(const std::string& title, const Rectangle& boundaries, bool isFullscreen, std::shared_ptr<ILogger> logger, bool isHidden = false, bool isGles = false);
 
             ~SdlWindow() override;
 
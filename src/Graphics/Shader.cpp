@@ -2,10 +2,16 @@
 #include "../Exception.h"
 #include "../Game/Game.h"
 #include "../Graphics/Renderer.h"
+#include "../Graphics/CommandBuffer.h"
 #include "../Graphics/GLCheck.h"
+#include "../Graphics/GLState.h"
 #include "../Graphics/Shader.h"
 #include "../Graphics/ShaderFile.h"
 #include "../Logger.h"
+#include "../ResourceManager.h"
+#include "../VFS/DatArchiveIndex.h"
+#include <cstring>
+#include <fstream>
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/type_ptr.hpp>
 
@@ -15,12 +21,66 @@ namespace Falltergeist
     {
         using Game::Game;
 
-        Shader::Shader(const std::string& fname)
+        namespace
+        {
+            const char BINARY_MAGIC[4] = {'F', 'G', 'S', 'B'};
+            // bump when the layout of the cached program binaries changes
+            const uint32_t BINARY_VERSION = 1;
+
+            template <typename T>
+            bool readValue(std::ifstream& stream, T& value)
+            {
+                return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+            }
+
+            template <typename T>
+            void writeValue(std::ofstream& stream, const T& value)
+            {
+                stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            bool programBinarySupported()
+            {
+                if (!GLEW_ARB_get_program_binary)
+                {
+                    return false;
+                }
+                // some drivers expose the extension without any format to store programs in
+                GLint formats = 0;
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+                return formats > 0;
+            }
+
+            std::string glString(GLenum name)
+            {
+                auto value = reinterpret_cast<const char*>(glGetString(name));
+                return value ? value : "";
+            }
+        }
+
+        Shader::Shader(const std::string& fname, bool deferred) : _name(fname)
         {
             _load(fname);
+            if (!deferred)
+            {
+                try
+                {
+                    finish();
+                }
+                catch (...)
+                {
+                    _release();
+                    throw;
+                }
+            }
         }
 
         Shader::~Shader()
+        {
+            _release();
+        }
+
+        void Shader::_release()
         {
             for (auto it = _shaders.begin(); it != _shaders.end(); ++it)
             {
@@ -34,8 +94,14 @@ namespace Falltergeist
 
             if (_progId)
             {
+                if (auto state = GLState::current())
+                {
+                    state->forgetProgram(_progId);
+                }
                 glDeleteProgram(_progId);
+                _progId = 0;
             }
+            _shaders.clear();
         }
 
         GLuint Shader::_loadShader(const char *src, unsigned int type)
@@ -44,20 +110,6 @@ namespace Falltergeist
 
             glShaderSource(shader, 1, &src, NULL);
             glCompileShader(shader);
-
-            GLint status = 0;
-            glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
-            if (!status)
-            {
-                GLint len = 0;
-                glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &len);
-                GLchar *log = (GLchar *) malloc(len);
-                glGetShaderInfoLog(shader, len, NULL, log);
-                Logger::error("RENDERER") << "Failed to compile shader: '" << log << std::endl;
-                free(log);
-                shader = 0;
-                throw Exception("Failed to compile shader.");
-            }
             return shader;
         }
 
@@ -74,6 +126,9 @@ namespace Falltergeist
                 case Renderer::RenderPath::OGL32 :
                     rpath = "32/";
                     break;
+                case Renderer::RenderPath::GLES2 :
+                    rpath = "es/";
+                    break;
                 default:
                     break;
             }
@@ -82,6 +137,22 @@ namespace Falltergeist
             Logger::info("RENDERER") << "Loading shader " << pathToFile << std::endl;
             ShaderFile shaderFile(pathToFile);
 
+            // Linked programs are cached per driver, a driver update or changed sources just miss the cache
+            const std::string& cachePath = ResourceManager::getInstance()->cachePath();
+            if (!cachePath.empty() && programBinarySupported())
+            {
+                _binaryPath = cachePath + "/" + fname + "." + rpath.substr(0, 2) + ".program";
+                _binaryKey = VFS::DatArchiveIndex::hash(
+                    glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION) + "\n"
+                    + shaderFile.fragmentSection() + "\n" + shaderFile.vertexSection()
+                );
+                if (_loadBinary())
+                {
+                    _finished = true;
+                    return true;
+                }
+            }
+
             _shaders.push_back( _loadShader(shaderFile.fragmentSection().c_str(), GL_FRAGMENT_SHADER) );
             _shaders.push_back( _loadShader(shaderFile.vertexSection().c_str(), GL_VERTEX_SHADER) );
 
@@ -92,185 +163,301 @@ namespace Falltergeist
                 {
                     glAttachShader(_progId, *it);
                 }
+                if (!_binaryPath.empty())
+                {
+                    glProgramParameteri(_progId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+                }
                 glLinkProgram(_progId);
+            return true;
+        }
 
-                GLint status = 0;
-                glGetProgramiv(_progId, GL_LINK_STATUS, &status);
+        bool Shader::_loadBinary()
+        {
+            std::ifstream stream(_binaryPath, std::ios_base::binary | std::ios_base::in);
+            if (!stream.is_open())
+            {
+                return false;
+            }
+
+            char magic[4];
+            uint32_t version = 0;
+            uint64_t key = 0;
+            uint32_t format = 0;
+            uint32_t size = 0;
+            if (!stream.read(magic, sizeof(magic)) || memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0
+                || !readValue(stream, version) || version != BINARY_VERSION
+                || !readValue(stream, key) || key != _binaryKey
+                || !readValue(stream, format) || !readValue(stream, size) || size == 0)
+            {
+                return false;
+            }
+
+            std::vector<char> binary(size);
+            if (!stream.read(binary.data(), size))
+            {
+                return false;
+            }
+
+            _progId = glCreateProgram();
+            glProgramBinary(_progId, format, binary.data(), static_cast<GLsizei>(size));
 
+            // the driver may still reject a binary it has written itself
+            GLint status = 0;
+            glGetProgramiv(_progId, GL_LINK_STATUS, &status);
+            if (!status)
+            {
+                Logger::info("RENDERER") << "Cached program " << _binaryPath << " was rejected, compiling sources" << std::endl;
+                glDeleteProgram(_progId);
+                _progId = 0;
+                return false;
+            }
+            return true;
+        }
+
+        void Shader::_saveBinary()
+        {
+            GLint size = 0;
+            glGetProgramiv(_progId, GL_PROGRAM_BINARY_LENGTH, &size);
+            if (size <= 0)
+            {
+                return;
+            }
+
+            std::vector<char> binary(size);
+            GLenum format = 0;
+            glGetProgramBinary(_progId, size, &size, &format, binary.data());
+
+            // cache is optional, the program is just compiled again next time if this fails
+            std::ofstream stream(_binaryPath, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+            if (!stream.is_open())
+            {
+                return;
+            }
+            stream.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+            writeValue(stream, BINARY_VERSION);
+            writeValue(stream, _binaryKey);
+            writeValue(stream, static_cast<uint32_t>(format));
+            writeValue(stream, static_cast<uint32_t>(size));
+            stream.write(binary.data(), size);
+        }
+
+        void Shader::finish()
+        {
+            if (_finished)
+            {
+                return;
+            }
+            _finished = true;
+
+            // Querying the status waits for the driver, compile errors surface at link time as well
+            GLint status = 0;
+            glGetProgramiv(_progId, GL_LINK_STATUS, &status);
+            if (status)
+            {
+                if (!_binaryPath.empty())
+                {
+                    _saveBinary();
+                }
+                return;
+            }
+
+            for (auto it = _shaders.begin(); it != _shaders.end(); ++it)
+            {
+                glGetShaderiv(*it, GL_COMPILE_STATUS, &status);
                 if (!status)
                 {
                     GLint len = 0;
-                    glGetProgramiv(_progId, GL_INFO_LOG_LENGTH, &len);
+                    glGetShaderiv(*it, GL_INFO_LOG_LENGTH, &len);
                     GLchar *log = (GLchar *) malloc(len);
-                    glGetProgramInfoLog(_progId, len, NULL, log);
-                    Logger::error("RENDERER") << "Can't link program " << fname << ": " << log << std::endl;
+                    glGetShaderInfoLog(*it, len, NULL, log);
+                    Logger::error("RENDERER") << "Failed to compile shader " << _name << ": '" << log << std::endl;
                     free(log);
-                    for (auto it = _shaders.begin(); it != _shaders.end(); ++it)
-                    {
-                        glDetachShader(_progId, *it);
-                    }
-
-                    for (auto it = _shaders.begin(); it != _shaders.end(); ++it)
-                    {
-                        glDeleteShader(*it);
-                    }
-                    glDeleteProgram(_progId);
-                    _progId = 0;
-                    throw Exception("Failed to link shader");
-                    return false;
+                    throw Exception("Failed to compile shader.");
                 }
-            return true;
+            }
+
+            GLint len = 0;
+            glGetProgramiv(_progId, GL_INFO_LOG_LENGTH, &len);
+            GLchar *log = (GLchar *) malloc(len);
+            glGetProgramInfoLog(_progId, len, NULL, log);
+            Logger::error("RENDERER") << "Can't link program " << _name << ": " << log << std::endl;
+            free(log);
+            throw Exception("Failed to link shader");
         }
 
         void Shader::use() const
         {
-            GLint cur = 0;
-            GL_CHECK(glGetIntegerv(GL_CURRENT_PROGRAM, &cur));
-            if ((GLuint)cur!=_progId)
-            {
-                GL_CHECK(glUseProgram(_progId));
-            }
+            GLState::current()->useProgram(_progId);
         }
 
         void Shader::unuse()
         {
-            glUseProgram(0);
+            GLState::current()->useProgram(0);
         }
 
         GLint Shader::getUniform(const std::string &uniform) const
         {
-            if (!_uniforms.count(uniform))
+            auto it = _uniforms.find(uniform);
+            if (it != _uniforms.end())
             {
-                GLint loc = glGetUniformLocation(_progId, uniform.c_str());
-                if (loc == -1)
-                {
-                    Logger::warning("RENDERER") << "Attention: uniform '" << uniform << "' does not exist in " << _progId << std::endl;
-                }
-
-                _uniforms[uniform] = loc;
-                return loc;
+                return it->second;
             }
-            else
+
+            GLint loc = glGetUniformLocation(_progId, uniform.c_str());
+            if (loc == -1)
             {
-                return _uniforms.at(uniform);
+                Logger::warning("RENDERER") << "Attention: uniform '" << uniform << "' does not exist in " << _progId << std::endl;
             }
+
+            _uniforms.emplace(uniform, loc);
+            return loc;
         }
 
         GLint Shader::getAttrib(const std::string &attrib) const
         {
-            if (!_attribs.count(attrib))
+            auto it = _attribs.find(attrib);
+            if (it != _attribs.end())
             {
-                GLint loc = glGetAttribLocation(_progId, attrib.c_str());
-                if (loc == -1)
-                {
-                    Logger::warning("RENDERER") << "Attention: attrib '" << attrib << "' does not exist in " << _progId << std::endl;
-                }
-
-                _attribs[attrib] = loc;
-                return loc;
+                return it->second;
             }
-            else {
-                return _attribs.at(attrib);
+
+            GLint loc = glGetAttribLocation(_progId, attrib.c_str());
+            if (loc == -1)
+            {
+                Logger::warning("RENDERER") << "Attention: attrib '" << attrib << "' does not exist in " << _progId << std::endl;
             }
+
+            _attribs.emplace(attrib, loc);
+            return loc;
         }
 
         void Shader::setUniform(const std::string &uniform, int i)
         {
-            GL_CHECK(glUniform1i(getUniform(uniform), i));
+            setUniform(getUniform(uniform), i);
         }
 
         void Shader::setUniform(const std::string &uniform, float x)
         {
-            GL_CHECK(glUniform1f(getUniform(uniform), x));
+            setUniform(getUniform(uniform), x);
         }
 
         void Shader::setUniform(const std::string &uniform, float x, float y)
         {
-            GL_CHECK(glUniform2f(getUniform(uniform), x, y));
+            setUniform(getUniform(uniform), glm::vec2(x, y));
         }
 
         void Shader::setUniform(const std::string &uniform, float x, float y, float z)
         {
-            GL_CHECK(glUniform3f(getUniform(uniform), x, y, z));
+            setUniform(getUniform(uniform), glm::vec3(x, y, z));
         }
 
         void Shader::setUniform(const std::string &uniform, float x, float y, float z, float w)
         {
-            GL_CHECK(glUniform4f(getUniform(uniform), x, y, z, w));
+            setUniform(getUniform(uniform), glm::vec4(x, y, z, w));
         }
 
         void Shader::setUniform(const std::string &uniform, const glm::vec2 &vec)
         {
-            GL_CHECK(glUniform2fv(getUniform(uniform), 1, glm::value_ptr(vec)));
+            setUniform(getUniform(uniform), vec);
         }
 
         void Shader::setUniform(const std::string &uniform, const glm::vec3 &vec)
         {
-            GL_CHECK(glUniform3fv(getUniform(uniform), 1, glm::value_ptr(vec)));
+            setUniform(getUniform(uniform), vec);
         }
 
-        void Shader::setUniform(const std::string &uniform, std::vector<GLuint> vec)
+        void Shader::setUniform(const std::string &uniform, const std::vector<GLuint> &vec)
         {
-            GL_CHECK(glUniform1iv(getUniform(uniform), static_cast<GLsizei>(vec.size()), (const int*)&vec[0]));
+            setUniform(getUniform(uniform), vec);
         }
 
         void Shader::setUniform(const std::string &uniform, const glm::vec4 &vec)
         {
-            GL_CHECK(glUniform4fv(getUniform(uniform), 1, glm::value_ptr(vec)));
+            setUniform(getUniform(uniform), vec);
         }
 
         void Shader::setUniform(const std::string &uniform, const glm::mat4 &mat)
         {
-            GL_CHECK(glUniformMatrix4fv(getUniform(uniform), 1, GL_FALSE, glm::value_ptr(mat)));
+            setUniform(getUniform(uniform), mat);
         }
 
+        // While a batch of this shader is being recorded the values go into the command buffer and are uploaded when it is submitted
+
         void Shader::setUniform(const GLint &uniform, int i)
         {
+            if (auto commands = CommandBuffer::recording(this)) {
+                commands->uniform(uniform, i);
+                return;
+            }
             GL_CHECK(glUniform1i((uniform), i));
         }
 
         void Shader::setUniform(const GLint &uniform, float x)
         {
+            if (auto commands = CommandBuffer::recording(this)) {
+                commands->uniform(uniform, &x, 1);
+                return;
+            }
             GL_CHECK(glUniform1f((uniform), x));
         }
 
         void Shader::setUniform(const GLint &uniform, float x, float y)
         {
-            GL_CHECK(glUniform2f((uniform), x, y));
+            setUniform(uniform, glm::vec2(x, y));
         }
 
         void Shader::setUniform(const GLint &uniform, float x, float y, float z)
         {
-            GL_CHECK(glUniform3f((uniform), x, y, z));
+            setUniform(uniform, glm::vec3(x, y, z));
         }
 
         void Shader::setUniform(const GLint &uniform, float x, float y, float z, float w)
         {
-            GL_CHECK(glUniform4f((uniform), x, y, z, w));
+            setUniform(uniform, glm::vec4(x, y, z, w));
         }
 
         void Shader::setUniform(const GLint &uniform, const glm::vec2 &vec)
         {
+            if (auto commands = CommandBuffer::recording(this)) {
+                commands->uniform(uniform, glm::value_ptr(vec), 2);
+                return;
+            }
             GL_CHECK(glUniform2fv((uniform), 1, glm::value_ptr(vec)));
         }
 
         void Shader::setUniform(const GLint &uniform, const glm::vec3 &vec)
         {
+            if (auto commands = CommandBuffer::recording(this)) {
+                commands->uniform(uniform, glm::value_ptr(vec), 3);
+                return;
+            }
             GL_CHECK(glUniform3fv((uniform), 1, glm::value_ptr(vec)));
         }
 
-        void Shader::setUniform(const GLint &uniform, std::vector<GLuint> vec)
+        void Shader::setUniform(const GLint &uniform, const std::vector<GLuint> &vec)
         {
+            if (auto commands = CommandBuffer::recording(this)) {
+                commands->uniform(uniform, vec);
+                return;
+            }
             GL_CHECK(glUniform1iv((uniform), static_cast<GLsizei>(vec.size()), (const int*)&vec[0]));
         }
 
         void Shader::setUniform(const GLint &uniform, const glm::vec4 &vec)
         {
+            if (auto commands = CommandBuffer::recording(this)) {
+                commands->uniform(uniform, glm::value_ptr(vec), 4);
+                return;
+            }
             GL_CHECK(glUniform4fv((uniform), 1, glm::value_ptr(vec)));
         }
 
         void Shader::setUniform(const GLint &uniform, const glm::mat4 &mat)
         {
+            if (auto commands = CommandBuffer::recording(this)) {
+                commands->uniform(uniform, mat);
+                return;
+            }
             GL_CHECK(glUniformMatrix4fv((uniform), 1, GL_FALSE, glm::value_ptr(mat)));
         }
     }
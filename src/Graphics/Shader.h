@@ -15,10 +15,15 @@ namespace Falltergeist
         {
             public:
 
-                Shader(const std::string& fname);
+                // A deferred shader only submits its sources, finish() has to be called before it is used.
+                // Drivers compiling in the background can then work on several programs at once.
+                Shader(const std::string& fname, bool deferred = false);
 
                 ~Shader();
 
+                // Waits for compiling and linking, throws if either failed
+                void finish();
+
                 void use() const;
 
                 void unuse();
@@ -36,7 +41,7 @@ namespace Falltergeist
                 void setUniform(const std::string &uniform, const glm::vec2 &vec);
 
                 void setUniform(const std::string &uniform, const glm::vec3 &vec);
-                void setUniform(const std::string &uniform, std::vector<GLuint> vec);
+                void setUniform(const std::string &uniform, const std::vector<GLuint> &vec);
 
                 void setUniform(const std::string &uniform, const glm::vec4 &vec);
 
@@ -55,7 +60,7 @@ namespace Falltergeist
                 void setUniform(const GLint &uniform, const glm::vec2 &vec);
 
                 void setUniform(const GLint &uniform, const glm::vec3 &vec);
-                void setUniform(const GLint &uniform, std::vector<GLuint> vec);
+                void setUniform(const GLint &uniform, const std::vector<GLuint> &vec);
 
                 void setUniform(const GLint &uniform, const glm::vec4 &vec);
 
@@ -66,12 +71,21 @@ namespace Falltergeist
                 GLint getUniform(const std::string &uniform) const;
 
             private:
+                std::string _name;
                 GLuint _progId;
+                bool _finished = false;
                 GLuint _loadShader(const char *, unsigned int);
 
                 std::vector<GLuint> _shaders;
 
                 bool _load(const std::string& fname);
+                void _release();
+
+                // Cached program binary, empty if the driver can't provide them
+                std::string _binaryPath;
+                uint64_t _binaryKey = 0;
+                bool _loadBinary();
+                void _saveBinary();
                 mutable std::map<std::string, GLint> _uniforms;
                 mutable std::map<std::string, GLint> _attribs;
         };
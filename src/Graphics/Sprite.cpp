@@ -13,13 +13,17 @@ namespace Falltergeist
     {
         using Game::Game;
 
-        Sprite::Sprite(const std::string& fname)
+        Sprite::Sprite(const std::string& fname) : Sprite(ResourceManager::getInstance()->pinTexture(fname))
         {
-            _texture = ResourceManager::getInstance()->texture(fname);
+        }
+
+        Sprite::Sprite(std::shared_ptr<Texture> texture)
+        {
+            _texture = std::move(texture);
             _shader = ResourceManager::getInstance()->shader("sprite");
 
             _uniformTex = _shader->getUniform("tex");
-            if (Game::getInstance()->renderer()->renderPath() == Renderer::RenderPath::OGL21)
+            if (Game::getInstance()->renderer()->renderPath() != Renderer::RenderPath::OGL32)
             {
                 _uniformTexSize = _shader->getUniform("texSize");
             }
@@ -32,6 +36,12 @@ namespace Falltergeist
             _uniformDoEgg = _shader->getUniform("doegg");
             _uniformEggPos = _shader->getUniform("eggpos");
             _uniformOutline = _shader->getUniform("outline");
+            _uniformPalette = _shader->getUniform("palette");
+            _uniformIndexed = _shader->getUniform("indexed");
+            if (Game::getInstance()->renderer()->supportsFrameBuffers())
+            {
+                _uniformPick = _shader->getUniform("pick");
+            }
 
             _attribPos = _shader->getAttrib("Position");
             _attribTex = _shader->getAttrib("TexCoord");
@@ -46,10 +56,9 @@ namespace Falltergeist
             return _texture->size();
         }
 
-        // render, optionally scaled
-        void Sprite::renderScaled(const Point& point, const Size& size, bool transparency, bool light, int outline, unsigned int lightValue)
+        void Sprite::_beginBatch(const Point& point, bool transparency, bool light, int outline, unsigned int lightValue)
         {
-            glm::vec2 eggVec;
+            glm::vec2 eggVec(0.0f, 0.0f);
             if (transparency)
             {
                 auto dude = Game::getInstance()->player();
@@ -57,65 +66,90 @@ namespace Falltergeist
                     transparency = false;
                 }
                 else {
+                    // the shader tests the egg in screen pixels, so every sprite under it shares the batch state
                     auto camera = Game::getInstance()->locationState()->camera();
-                    Rectangle eggRectangle(
-                        dude->hexagon()->position() - camera->topLeft() + dude->eggOffset(),
-                        Size(129, 98)
-                    );
-
-                    Rectangle textureRectangle(point, _texture->size());
+                    Point eggPosition = dude->hexagon()->position() - camera->topLeft() + dude->eggOffset();
+                    eggVec = glm::vec2((float) eggPosition.x(), (float) eggPosition.y());
+                }
+            }
 
-                    if (!eggRectangle.hasIntersectionWith(textureRectangle)) {
-                        transparency = false;
-                    }
-                    else {
-                        eggVec = glm::vec2((float) (eggRectangle.position().x() - point.x()), (float) (eggRectangle.position().y() - point.y()));
+            int lightLevel = 100;
+            if (light)
+            {
+                if (auto state = Game::getInstance()->locationState())
+                {
+                    if (lightValue<=state->lightLevel()) {
+                        lightValue=state->lightLevel();
                     }
+                    lightLevel = lightValue / ((65536-655)/100);
                 }
             }
 
-            _shader->use();
+            auto renderer = Game::getInstance()->renderer();
+
+            SpriteBatch::State state;
+            state.shader = _shader;
+            state.texture = _texture.get();
+            state.egg = renderer->egg();
+            state.palette = _texture->indexed() ? renderer->palette() : nullptr;
+            state.positionAttrib = _attribPos;
+            state.texCoordAttrib = _attribTex;
+            state.eggPosition = eggVec;
+            state.doEgg = transparency;
+            state.light = lightLevel;
+            state.trans = _trans;
+            state.outline = outline;
+            state.pick = renderer->pickId();
+
+            if (!renderer->spriteBatch()->begin(state))
+            {
+                return;
+            }
 
             _shader->setUniform(_uniformTex, 0);
             _shader->setUniform(_uniformEggTex, 1);
+            _shader->setUniform(_uniformPalette, 2);
+            _shader->setUniform(_uniformIndexed, _texture->indexed());
 
-            _shader->setUniform(_uniformEggPos, eggVec);
+            _shader->setUniform(_uniformEggPos, state.eggPosition);
 
             _shader->setUniform(_uniformDoEgg, transparency);
 
             _shader->setUniform(_uniformOutline, outline);
 
+            if (_uniformPick != -1)
+            {
+                _shader->setUniform(_uniformPick, static_cast<int>(state.pick));
+            }
 
-            _shader->setUniform(_uniformFade, Game::getInstance()->renderer()->fadeColor());
+            _shader->setUniform(_uniformFade, renderer->drawFadeColor());
 
-            _shader->setUniform(_uniformMVP, Game::getInstance()->renderer()->getMVP());
+            _shader->setUniform(_uniformMVP, renderer->getMVP());
 
             _shader->setUniform(_uniformCnt, Game::getInstance()->animatedPalette()->counters());
 
-            int lightLevel = 100;
-            if (light)
-            {
-                if (auto state = Game::getInstance()->locationState())
-                {
-                    if (lightValue<=state->lightLevel()) {
-                        lightValue=state->lightLevel();
-                    }
-                    lightLevel = lightValue / ((65536-655)/100);
-                }
-            }
             _shader->setUniform(_uniformLight, lightLevel);
             _shader->setUniform(_uniformTrans, _trans);
 
-            if (Game::getInstance()->renderer()->renderPath() == Renderer::RenderPath::OGL21)
+            if (renderer->renderPath() != Renderer::RenderPath::OGL32)
+            {
+                _shader->setUniform(_uniformTexSize, glm::vec2((float)_texture->textureSize().width(), (float)_texture->textureSize().height()));
+            }
+        }
+
+        // render, optionally scaled
+        void Sprite::renderScaled(const Point& point, const Size& size, bool transparency, bool light, int outline, unsigned int lightValue)
+        {
+            // skipped until its upload is done
+            if (!_texture->ready())
             {
-                _shader->setUniform(_uniformTexSize, glm::vec2((float)_texture->size().width(), (float)_texture->size().height()));
+                return;
             }
+            _beginBatch(point, transparency, light, outline, lightValue);
 
-            Game::getInstance()->renderer()->drawRectangle(
-                Rectangle(point, size),
-                _texture,
-                Game::getInstance()->renderer()->egg(),
-                _shader
+            Game::getInstance()->renderer()->spriteBatch()->add(
+                glm::vec4((float)point.x(), (float)point.y(), (float)(point.x() + size.width()), (float)(point.y() + size.height())),
+                _texture->texCoords()
             );
         }
 
@@ -128,67 +162,21 @@ namespace Falltergeist
         void Sprite::renderCropped(const Point& point, const Rectangle& part, bool transparency,
                                    bool light, unsigned int lightValue)
         {
-            glm::vec2 eggVec;
-            if (transparency)
+            if (!_texture->ready())
             {
-                auto dude = Game::getInstance()->player();
-                if (!dude || !Game::getInstance()->locationState()) {
-                    transparency = false;
-                } else {
-                    auto camera = Game::getInstance()->locationState()->camera();
-                    Rectangle eggRectangle(
-                        dude->hexagon()->position() - camera->topLeft() + dude->eggOffset(),
-                        Size(129, 98)
-                    );
-
-                    Rectangle textureRectangle(point, _texture->size());
-
-                    if (!eggRectangle.hasIntersectionWith(textureRectangle)) {
-                        transparency = false;
-                    } else {
-                        eggVec = glm::vec2((float) (eggRectangle.position().x() - point.x()), (float) (eggRectangle.position().y() - point.y()));
-                    }
-                }
-
+                return;
             }
-
-            _shader->use();
-
-            _shader->setUniform(_uniformTex, 0);
-            _shader->setUniform(_uniformEggTex, 1);
-
-            _shader->setUniform(_uniformFade, Game::getInstance()->renderer()->fadeColor());
-
-            _shader->setUniform(_uniformMVP, Game::getInstance()->renderer()->getMVP());
-
-            _shader->setUniform(_uniformCnt, Game::getInstance()->animatedPalette()->counters());
-
-            int lightLevel = 100;
-            if (light)
-            {
-                if (auto state = Game::getInstance()->locationState())
-                {
-                    if (lightValue<=state->lightLevel()) {
-                        lightValue=state->lightLevel();
-                    }
-                    lightLevel = lightValue / ((65536-655)/100);
-                }
-            }
-            _shader->setUniform(_uniformLight, lightLevel);
-
-            _shader->setUniform(_uniformTrans, _trans);
-
-            _shader->setUniform(_uniformEggPos, eggVec);
-
-            _shader->setUniform(_uniformDoEgg, transparency);
-
-            _shader->setUniform(_uniformOutline, false);
-
-            if (Game::getInstance()->renderer()->renderPath() == Renderer::RenderPath::OGL21) {
-                _shader->setUniform(_uniformTexSize, glm::vec2((float)_texture->size().width(), (float)_texture->size().height()));
-            }
-
-            Game::getInstance()->renderer()->drawPartialRectangle(point, part, _texture, Game::getInstance()->renderer()->egg(), _shader);
+            _beginBatch(point, transparency, light, 0, lightValue);
+
+            Game::getInstance()->renderer()->spriteBatch()->add(
+                glm::vec4(
+                    (float)point.x(),
+                    (float)point.y(),
+                    (float)(point.x() + part.size().width()),
+                    (float)(point.y() + part.size().height())
+                ),
+                _texture->texCoords(part)
+            );
         }
 
         bool Sprite::opaque(const Point& point)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include "../Format/Frm/File.h"
 #include "../Graphics/Point.h"
@@ -16,6 +17,8 @@ namespace Falltergeist
         {
             public:
                 Sprite(const std::string& filename);
+                // Draws a texture which isn't kept by the resource manager
+                Sprite(std::shared_ptr<Texture> texture);
                 Sprite(Format::Frm::File* frm);
                 void renderScaled(const Point& point, const Size& size, bool transparency = false,
                                   bool light = false, int outline = 0, unsigned int lightValue=0);
@@ -38,12 +41,18 @@ namespace Falltergeist
                 GLint _uniformDoEgg;
                 GLint _uniformEggPos;
                 GLint _uniformOutline;
+                GLint _uniformPalette;
+                GLint _uniformIndexed;
+                GLint _uniformPick = -1;
 
                 GLint _attribPos;
                 GLint _attribTex;
-                Texture* _texture;
+                std::shared_ptr<Texture> _texture;
                 Graphics::TransFlags::Trans _trans = Graphics::TransFlags::Trans::NONE;
                 Graphics::Shader*_shader;
+
+                // Makes the sprite state current in the renderer sprite batch
+                void _beginBatch(const Point& point, bool transparency, bool light, int outline, unsigned int lightValue);
         };
     }
 }
@@ -0,0 +1,163 @@
+#include "../Graphics/SpriteBatch.h"
+#include "../Graphics/CommandBuffer.h"
+#include "../Graphics/GLCheck.h"
+#include "../Graphics/RenderStats.h"
+#include "../Graphics/Shader.h"
+#include "../Graphics/Texture.h"
+#include "../Graphics/VertexBufferLayout.h"
+#include <cstdint>
+
+namespace Falltergeist {
+    namespace Graphics {
+        namespace {
+            // textures placed into the same atlas page share the GL texture
+            GLuint textureId(const Texture* texture) {
+                return texture ? texture->id() : 0;
+            }
+        }
+
+        bool SpriteBatch::State::operator==(const State& other) const {
+            return shader == other.shader
+                && textureId(texture) == textureId(other.texture)
+                && textureId(egg) == textureId(other.egg)
+                && textureId(palette) == textureId(other.palette)
+                && positionAttrib == other.positionAttrib
+                && texCoordAttrib == other.texCoordAttrib
+                && color == other.color
+                && eggPosition == other.eggPosition
+                && doEgg == other.doEgg
+                && light == other.light
+                && trans == other.trans
+                && outline == other.outline
+                && outlineColor == other.outlineColor
+                && texStart == other.texStart
+                && texHeight == other.texHeight
+                && pick == other.pick;
+        }
+
+        bool SpriteBatch::State::operator!=(const State& other) const {
+            return !(*this == other);
+        }
+
+        const unsigned int SpriteBatch::QUAD_SIZE = 4 * sizeof(CommandBuffer::Vertex);
+
+        SpriteBatch::SpriteBatch() {
+            _commands = std::make_unique<CommandBuffer>();
+
+            const unsigned int quads = CAPACITY * StreamBuffer::SEGMENTS;
+            _stream = std::make_unique<StreamBuffer>(quads * QUAD_SIZE);
+
+            _indexes.reserve(quads * 6);
+            for (unsigned int i = 0; i != quads; ++i) {
+                unsigned int quad[6] = {i * 4, i * 4 + 1, i * 4 + 2, i * 4 + 3, i * 4 + 2, i * 4 + 1};
+                _indexes.insert(_indexes.end(), quad, quad + 6);
+            }
+            _indexBuffer = std::make_unique<IndexBuffer>(&_indexes[0], quads * 6, IndexBuffer::UsagePattern::StaticDraw);
+        }
+
+        SpriteBatch::~SpriteBatch() {
+        }
+
+        bool SpriteBatch::begin(const State& state) {
+            if (_hasState && _state == state) {
+                return false;
+            }
+
+            _state = state;
+            _hasState = true;
+            _commands->begin(state);
+            return true;
+        }
+
+        void SpriteBatch::add(const glm::vec4& position, const glm::vec4& texCoords) {
+            // after a flush quads of the same state go on in a batch of their own, the program keeps the uniforms
+            if (_commands->batches().empty() || _commands->lastQuads() == CAPACITY) {
+                _commands->begin(_state);
+            }
+            RenderStats::quad();
+            _commands->quad(position, texCoords);
+        }
+
+        void SpriteBatch::flush() {
+            const auto& batches = _commands->batches();
+            const auto& vertices = _commands->vertices();
+
+            size_t first = 0;
+            while (first != batches.size()) {
+                // vertices of as many following batches as the buffer holds are written at once, none is larger
+                size_t last = first;
+                unsigned int quads = 0;
+                while (last != batches.size() && quads + batches[last].quads <= CAPACITY) {
+                    quads += batches[last].quads;
+                    ++last;
+                }
+
+                unsigned int quad = 0;
+                if (quads) {
+                    quad = _stream->write(&vertices[batches[first].firstQuad * 4], quads * QUAD_SIZE, QUAD_SIZE) / QUAD_SIZE;
+                }
+
+                for (size_t i = first; i != last; ++i) {
+                    _draw(*_commands, i, quad + batches[i].firstQuad - batches[first].firstQuad);
+                }
+
+                first = last;
+            }
+
+            _commands->clear();
+        }
+
+        void SpriteBatch::end() {
+            flush();
+            _hasState = false;
+        }
+
+        void SpriteBatch::_draw(const CommandBuffer& commands, size_t index, unsigned int quad) {
+            const auto& batch = commands.batches()[index];
+            const auto& state = batch.state;
+
+            // uniforms of a batch without quads still apply to the batches continuing its state
+            state.shader->use();
+            commands.applyUniforms(batch);
+            if (!batch.quads) {
+                return;
+            }
+
+            if (state.texture) {
+                state.texture->bind(0);
+            }
+            if (state.egg) {
+                state.egg->bind(1);
+            }
+            if (state.palette) {
+                state.palette->bind(2);
+            }
+
+            _vertexArray(state.positionAttrib, state.texCoordAttrib)->bind();
+            _indexBuffer->bind();
+
+            const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(quad * 6 * sizeof(unsigned int)));
+            GL_CHECK(glDrawElements(GL_TRIANGLES, batch.quads * 6, GL_UNSIGNED_INT, offset));
+            RenderStats::drawCall(batch.quads * 2);
+        }
+
+        VertexArray* SpriteBatch::_vertexArray(GLint positionAttrib, GLint texCoordAttrib) {
+            auto key = std::make_pair(positionAttrib, texCoordAttrib);
+            auto it = _vertexArrays.find(key);
+            if (it != _vertexArrays.end()) {
+                return it->second.get();
+            }
+
+            VertexBufferLayout layout;
+            layout.addAttribute({(unsigned int)positionAttrib, 2, VertexBufferAttribute::Type::Float});
+            if (texCoordAttrib >= 0) {
+                layout.addAttribute({(unsigned int)texCoordAttrib, 2, VertexBufferAttribute::Type::Float});
+            }
+            layout.setStride(sizeof(CommandBuffer::Vertex));
+
+            auto vertexArray = std::make_unique<VertexArray>();
+            vertexArray->addBuffer(_stream->buffer(), layout);
+            return _vertexArrays.emplace(key, std::move(vertexArray)).first->second.get();
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "../Graphics/IndexBuffer.h"
+#include "../Graphics/StreamBuffer.h"
+#include "../Graphics/VertexArray.h"
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Falltergeist {
+    namespace Graphics {
+        class CommandBuffer;
+        class Shader;
+        class Texture;
+
+        /**
+         * SpriteBatch collects textured quads and draws consecutive quads sharing the same state with a single call
+         * Vertices are sub-allocated from a stream buffer, quads are drawn with a static index buffer
+         * covering the whole ring, so no GL objects are created while rendering
+         * Batches are recorded into a command buffer without touching GL and submitted by flush(), the vertices
+         * of consecutive batches are uploaded with one write, so state changes no longer cost a buffer update each
+         * Draw order is preserved. Anything rendering with GL directly must call flush() before drawing
+         */
+        class SpriteBatch final {
+        public:
+            /**
+             * Everything that affects how quads are drawn
+             * Uniform values are compared only to decide whether quads can share a draw call,
+             * setting them is up to the caller when begin() returns true
+             */
+            struct State {
+                const Shader* shader = nullptr;
+                const Texture* texture = nullptr;
+                const Texture* egg = nullptr;
+                // colors of indexed textures
+                const Texture* palette = nullptr;
+
+                GLint positionAttrib = -1;
+                GLint texCoordAttrib = -1;
+
+                glm::vec4 color = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+                glm::vec2 eggPosition = glm::vec2(0.0f, 0.0f);
+                bool doEgg = false;
+                int light = 100;
+                int trans = 0;
+                int outline = 0;
+                glm::vec4 outlineColor = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+                float texStart = 0.0f;
+                float texHeight = 0.0f;
+                // id written instead of the colors while rendering into a PickingPass, 0 renders normally
+                uint32_t pick = 0;
+
+                bool operator==(const State& other) const;
+
+                bool operator!=(const State& other) const;
+            };
+
+            SpriteBatch();
+
+            ~SpriteBatch();
+
+            // Makes the given state current, starting a new batch if it differs
+            // Returns true if a new batch was started, uniforms set on the shader then are recorded into the batch
+            bool begin(const State& state);
+
+            // Queues a quad with the current state, both vectors are (left, top, right, bottom)
+            void add(const glm::vec4& position, const glm::vec4& texCoords);
+
+            // Submits the recorded batches
+            void flush();
+
+            // Draws pending quads and forgets the state, so uniforms changing between frames are uploaded by the next begin()
+            void end();
+
+        private:
+            // Maximum number of quads drawn with one call, a segment of the stream buffer holds this many quads
+            static const unsigned int CAPACITY = 4096;
+
+            // bytes of the four vertices of a quad
+            static const unsigned int QUAD_SIZE;
+
+            State _state;
+
+            bool _hasState = false;
+
+            std::unique_ptr<CommandBuffer> _commands;
+
+            std::unique_ptr<StreamBuffer> _stream;
+
+            std::unique_ptr<IndexBuffer> _indexBuffer;
+
+            std::vector<unsigned int> _indexes;
+
+            // vertex arrays by (position, texture coordinates) attribute location
+            std::map<std::pair<GLint, GLint>, std::unique_ptr<VertexArray>> _vertexArrays;
+
+            VertexArray* _vertexArray(GLint positionAttrib, GLint texCoordAttrib);
+
+            void _draw(const CommandBuffer& commands, size_t index, unsigned int quad);
+        };
+    }
+}
@@ -0,0 +1,76 @@
+#include "../Graphics/StreamBuffer.h"
+#include "../Game/Game.h"
+#include "../Graphics/GLCheck.h"
+#include "../Graphics/Renderer.h"
+#include <stdexcept>
+
+namespace Falltergeist {
+    namespace Graphics {
+        StreamBuffer::StreamBuffer(unsigned int size) : _size(size), _segmentSize(size / SEGMENTS) {
+            _persistent = Game::Game::getInstance()->renderer()->supportsPersistentMapping();
+            _buffer = std::make_unique<VertexBuffer>(
+                nullptr,
+                size,
+                _persistent ? VertexBuffer::UsagePattern::PersistentStream : VertexBuffer::UsagePattern::StreamDraw
+            );
+            _fences.assign(SEGMENTS, nullptr);
+        }
+
+        StreamBuffer::~StreamBuffer() {
+            for (auto fence : _fences) {
+                if (fence) {
+                    glDeleteSync(fence);
+                }
+            }
+        }
+
+        unsigned int StreamBuffer::write(const void* data, unsigned int size, unsigned int alignment) {
+            if (size > _segmentSize) {
+                throw std::out_of_range("Stream buffer write is larger than a segment");
+            }
+
+            unsigned int offset = (_position + alignment - 1) / alignment * alignment;
+            bool wrap = offset + size > _size;
+            if (wrap) {
+                offset = 0;
+            }
+
+            if (_persistent) {
+                // a write spans two segments at most, the first one is current unless the ring wrapped
+                _enter((offset + size - 1) / _segmentSize);
+            } else if (wrap) {
+                _buffer->orphan();
+            }
+
+            _buffer->write(offset, data, size);
+            _position = offset + size;
+            return offset;
+        }
+
+        void StreamBuffer::_enter(unsigned int segment) {
+            while (_segment != segment) {
+                // draws reading the segment left behind have all been issued
+                _fences[_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                _segment = (_segment + 1) % SEGMENTS;
+
+                auto& fence = _fences[_segment];
+                if (fence) {
+                    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+                    while (glClientWaitSync(fence, flags, 1000000) == GL_TIMEOUT_EXPIRED) {
+                        flags = 0;
+                    }
+                    glDeleteSync(fence);
+                    fence = nullptr;
+                }
+            }
+        }
+
+        const std::unique_ptr<VertexBuffer>& StreamBuffer::buffer() const {
+            return _buffer;
+        }
+
+        bool StreamBuffer::persistent() const {
+            return _persistent;
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../Graphics/VertexBuffer.h"
+#include <GL/glew.h>
+#include <memory>
+#include <vector>
+
+namespace Falltergeist {
+    namespace Graphics {
+        /**
+         * StreamBuffer is a ring of vertex data written once and drawn once, sub-allocated by its users every frame
+         * Where buffer storage is available the ring is mapped persistently and split into segments, a segment
+         * gets a fence when writing leaves it and is waited for only when writing comes back to it
+         * Otherwise the storage is orphaned whenever the ring wraps
+         */
+        class StreamBuffer final {
+        public:
+            static const unsigned int SEGMENTS = 4;
+
+            // Writes are at most size / SEGMENTS bytes
+            StreamBuffer(unsigned int size);
+
+            ~StreamBuffer();
+
+            // Copies the data into the ring at an offset aligned to the given bytes, returns the offset
+            unsigned int write(const void* data, unsigned int size, unsigned int alignment = 1);
+
+            // For vertex arrays, vertices start at the offsets returned by write()
+            const std::unique_ptr<VertexBuffer>& buffer() const;
+
+            bool persistent() const;
+
+        private:
+            std::unique_ptr<VertexBuffer> _buffer;
+
+            unsigned int _size;
+
+            unsigned int _segmentSize;
+
+            bool _persistent;
+
+            // next free byte and the segment containing the last write
+            unsigned int _position = 0;
+
+            unsigned int _segment = 0;
+
+            std::vector<GLsync> _fences;
+
+            void _enter(unsigned int segment);
+        };
+    }
+}
@@ -15,15 +15,10 @@ namespace Falltergeist
 
         TextArea::TextArea()
         {
-            _vertexArray = std::make_unique<VertexArray>();
-            _coordinatesVertexBuffer = std::make_unique<VertexBuffer>(nullptr, 0);
-            _textureCoordinatesVertexBuffer = std::make_unique<VertexBuffer>(nullptr, 0);
-            _indexBuffer = std::make_unique<IndexBuffer>(nullptr, 0);
-
             _shader = ResourceManager::getInstance()->shader("font");
 
             _uniformTex = _shader->getUniform("tex");
-            if (Game::getInstance()->renderer()->renderPath() == Graphics::Renderer::RenderPath::OGL21)
+            if (Game::getInstance()->renderer()->renderPath() != Graphics::Renderer::RenderPath::OGL32)
             {
                 _uniformTexSize = _shader->getUniform("texSize");
             }
@@ -41,75 +36,74 @@ namespace Falltergeist
         {
         }
 
-        void TextArea::render(Point& pos, Graphics::Font* font, SDL_Color _color, SDL_Color _outlineColor)
+        void TextArea::render(const Point& pos, Graphics::Font* font, SDL_Color color, SDL_Color outlineColor)
         {
-            if (_indexBuffer->count() == 0) {
+            if (_positions.empty()) {
                 return;
             }
 
-            _shader->use();
-
-            font->texture()->bind(0);
+            auto renderer = Game::getInstance()->renderer();
 
-            _shader->setUniform(_uniformTex, 0);
+            SpriteBatch::State state;
+            state.shader = _shader;
+            state.texture = font->texture();
+            state.positionAttrib = _attribPos;
+            state.texCoordAttrib = _attribTex;
+            state.color = glm::vec4((float)color.r / 255.f, (float)color.g / 255.f, (float)color.b / 255.f, (float)color.a / 255.f);
+            state.outlineColor = glm::vec4((float)outlineColor.r / 255.f, (float)outlineColor.g / 255.f, (float)outlineColor.b / 255.f, (float)outlineColor.a / 255.f);
 
-            _shader->setUniform(_uniformMVP, Game::getInstance()->renderer()->getMVP());
-            _shader->setUniform(_uniformOffset, glm::vec2((float)pos.x(), (float(pos.y()))));
-            _shader->setUniform(_uniformColor, glm::vec4((float)_color.r / 255.f, (float)_color.g / 255.f, (float)_color.b / 255.f, (float)_color.a / 255.f));
-            _shader->setUniform(_uniformOutline, glm::vec4((float)_outlineColor.r / 255.f, (float)_outlineColor.g / 255.f, (float)_outlineColor.b / 255.f, (float)_outlineColor.a / 255.f));
-            _shader->setUniform(_uniformFade, Game::getInstance()->renderer()->fadeColor());
-            if (Game::getInstance()->renderer()->renderPath() == Graphics::Renderer::RenderPath::OGL21)
+            if (renderer->spriteBatch()->begin(state))
             {
-                _shader->setUniform(_uniformTexSize, glm::vec2((float)font->texture()->size().width(), (float)font->texture()->size().height()));
+                _shader->setUniform(_uniformTex, 0);
+                _shader->setUniform(_uniformMVP, renderer->getMVP());
+                // positions are baked into the quads, texts at different places can share the batch
+                _shader->setUniform(_uniformOffset, glm::vec2(0.0f, 0.0f));
+                _shader->setUniform(_uniformColor, state.color);
+                _shader->setUniform(_uniformOutline, state.outlineColor);
+                _shader->setUniform(_uniformFade, renderer->drawFadeColor());
+                if (renderer->renderPath() != Graphics::Renderer::RenderPath::OGL32)
+                {
+                    _shader->setUniform(_uniformTexSize, glm::vec2((float)font->texture()->size().width(), (float)font->texture()->size().height()));
+                }
             }
 
-            _vertexArray->bind();
-            _indexBuffer->bind();
-
-            GL_CHECK(glDrawElements(GL_TRIANGLES, _indexBuffer->count(), GL_UNSIGNED_INT, nullptr));
+            glm::vec4 offset((float)pos.x(), (float)pos.y(), (float)pos.x(), (float)pos.y());
+            for (size_t i = 0; i != _positions.size(); ++i)
+            {
+                renderer->spriteBatch()->add(_positions[i] + offset, _texCoords[i]);
+            }
         }
 
-        void TextArea::updateBuffers(std::vector<glm::vec2> vertices, std::vector<glm::vec2> UV,  std::vector<unsigned int> indexes)
+        void TextArea::updateBuffers(const std::vector<TextSymbol>& symbols, Graphics::Font* font)
         {
-            if (vertices.empty())
+            _positions.clear();
+            _texCoords.clear();
+            _positions.reserve(symbols.size());
+            _texCoords.reserve(symbols.size());
+
+            auto width = (float)font->width();
+            auto height = (float)font->height();
+            auto textureWidth = (float)font->texture()->size().width();
+            auto textureHeight = (float)font->texture()->size().height();
+            for (const auto& symbol : symbols)
             {
-                _indexBuffer = std::make_unique<IndexBuffer>(nullptr, 0);
-                return;
+                // glyphs are laid out in a 16x16 grid with a pixel of spacing around each for the outline
+                auto textureX = static_cast<float>((symbol.chr % 16) * font->width() + (symbol.chr % 16) * 2 + 1);
+                auto textureY = static_cast<float>((symbol.chr / 16) * font->height() + (symbol.chr / 16) * 2 + 1);
+
+                _positions.emplace_back(
+                    (float)symbol.position.x() - 1.0f,
+                    (float)symbol.position.y() - 1.0f,
+                    (float)symbol.position.x() + width + 1.0f,
+                    (float)symbol.position.y() + height + 1.0f
+                );
+                _texCoords.emplace_back(
+                    (textureX - 1.0f) / textureWidth,
+                    (textureY - 1.0f) / textureHeight,
+                    (textureX + width + 1.0f) / textureWidth,
+                    (textureY + height + 1.0f) / textureHeight
+                );
             }
-
-            _vertexArray = std::make_unique<VertexArray>();
-
-            _coordinatesVertexBuffer = std::make_unique<VertexBuffer>(
-                    &vertices[0],
-                    vertices.size() * sizeof(glm::vec2),
-                    VertexBuffer::UsagePattern::DynamicDraw
-            );
-            VertexBufferLayout coordinatesVertexBufferLayout;
-            coordinatesVertexBufferLayout.addAttribute({
-               (unsigned int) _attribPos,
-               2,
-               VertexBufferAttribute::Type::Float
-            });
-            _vertexArray->addBuffer(_coordinatesVertexBuffer, coordinatesVertexBufferLayout);
-
-            _textureCoordinatesVertexBuffer = std::make_unique<VertexBuffer>(
-                    &UV[0],
-                    UV.size() * sizeof(glm::vec2),
-                    VertexBuffer::UsagePattern::DynamicDraw
-            );
-            VertexBufferLayout textureCoordinatesVertexBufferLayout;
-            textureCoordinatesVertexBufferLayout.addAttribute({
-              (unsigned int) _attribTex,
-              2,
-              VertexBufferAttribute::Type::Float
-            });
-            _vertexArray->addBuffer(_textureCoordinatesVertexBuffer, textureCoordinatesVertexBufferLayout);
-
-            _indexBuffer = std::make_unique<IndexBuffer>(
-                    &indexes[0],
-                    indexes.size(),
-                    IndexBuffer::UsagePattern::DynamicDraw
-            );
         }
     }
 }
@@ -3,31 +3,33 @@
 #include <cstdint>
 #include <string>
 #include <vector>
+#include <glm/glm.hpp>
 #include "../Graphics/Font.h"
 #include "../Graphics/Renderer.h"
-#include "../Graphics/VertexBuffer.h"
-#include "../Graphics/VertexArray.h"
-#include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Shader.h"
 
 namespace Falltergeist
 {
     namespace Graphics
     {
+        /**
+         * Glyph quads of a laid out text, cut from the 16x16 glyph grid of the font texture.
+         * Quads are queued into the renderer sprite batch, so texts of the same font and colors
+         * rendered one after another (like floating messages over critters) share a single draw call.
+         */
         class TextArea
         {
             public:
                 TextArea();
                 ~TextArea();
 
-                void render(Point& pos, Graphics::Font* font, SDL_Color _color, SDL_Color _outlineColor);
-                void updateBuffers(std::vector<glm::vec2> vertices, std::vector<glm::vec2> UV,  std::vector<unsigned int> indexes);
+                void render(const Point& pos, Graphics::Font* font, SDL_Color color, SDL_Color outlineColor);
+                void updateBuffers(const std::vector<TextSymbol>& symbols, Graphics::Font* font);
 
             protected:
-                std::unique_ptr<VertexArray> _vertexArray;
-                std::unique_ptr<VertexBuffer> _coordinatesVertexBuffer;
-                std::unique_ptr<VertexBuffer> _textureCoordinatesVertexBuffer;
-                std::unique_ptr<IndexBuffer> _indexBuffer;
+                // (left, top, right, bottom) of each glyph relative to the text position and in the font texture
+                std::vector<glm::vec4> _positions;
+                std::vector<glm::vec4> _texCoords;
 
                 GLint _uniformTex;
                 GLint _uniformTexSize;
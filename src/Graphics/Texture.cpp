@@ -1,42 +1,311 @@
 ﻿#include "../Exception.h"
 #include "../Game/Game.h"
+#include "../Graphics/GLState.h"
+#include "../Graphics/HitMask.h"
+#include "../Graphics/Renderer.h"
 #include "../Graphics/Texture.h"
+#include "../Graphics/TextureAtlas.h"
+#include "../Graphics/TextureResidency.h"
+#include "../Graphics/TextureUploadQueue.h"
 #include "../Graphics/GLCheck.h"
+#include "../MemoryStats.h"
 #include <stdexcept>
 
 namespace Falltergeist {
     namespace Graphics {
-        Texture::Texture(const Pixels &pixels) : _size(pixels.size()) {
-            GL_CHECK(glGenTextures(1, &_textureID));
-            GL_CHECK(glBindTexture(GL_TEXTURE_2D, _textureID));
-
-            switch (pixels.format()) {
-                case Pixels::Format::RGB:
-                    GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _size.width(), _size.height(), 0, GL_BGRA,
-                                          GL_UNSIGNED_INT_8_8_8_8, pixels.data()));
-                    break;
-                case Pixels::Format::RGBA:
-                    GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _size.width(), _size.height(), 0, GL_RGBA,
-                                          GL_UNSIGNED_INT_8_8_8_8, pixels.data()));
-                    break;
-                default:
-                    throw std::logic_error("Unsupported pixels format");
+        namespace {
+            struct PixelTransfer {
+                GLint internalFormat;
+                GLenum format;
+                GLenum type;
+            };
+
+            bool gles() {
+                return Game::Game::getInstance()->renderer()->renderPath() == Renderer::RenderPath::GLES2;
+            }
+
+            PixelTransfer pixelTransfer(Pixels::Format format) {
+                if (gles()) {
+                    // no packed 32 bit types and the internal format has to match, see pixelData()
+                    if (format == Pixels::Format::Indexed) {
+                        return {GL_LUMINANCE, GL_LUMINANCE, GL_UNSIGNED_BYTE};
+                    }
+                    return {GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE};
+                }
+                switch (format) {
+                    case Pixels::Format::RGB:
+                        return {GL_RGBA, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8};
+                    case Pixels::Format::RGBA:
+                        return {GL_RGBA, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8};
+                    case Pixels::Format::Indexed:
+                        // single channel textures are red in core profiles and luminance before
+                        if (Game::Game::getInstance()->renderer()->renderPath() == Renderer::RenderPath::OGL32) {
+                            return {GL_R8, GL_RED, GL_UNSIGNED_BYTE};
+                        }
+                        return {GL_LUMINANCE8, GL_LUMINANCE, GL_UNSIGNED_BYTE};
+                    default:
+                        throw std::logic_error("Unsupported pixels format");
+                }
+            }
+
+            // Colors are packed into 32 bit integers, GLES reads them as bytes in R, G, B, A order from memory
+            const void* pixelData(const Pixels& pixels, std::vector<uint8_t>& converted) {
+                if (!gles() || pixels.format() == Pixels::Format::Indexed || !pixels.data()) {
+                    return pixels.data();
+                }
+                auto colors = static_cast<const uint32_t*>(pixels.data());
+                size_t count = static_cast<size_t>(pixels.size().width()) * pixels.size().height();
+                // RGB pixels are uploaded as BGRA on the desktop
+                bool bgr = pixels.format() == Pixels::Format::RGB;
+                converted.resize(count * 4);
+                for (size_t i = 0; i != count; ++i) {
+                    uint32_t color = colors[i];
+                    uint8_t high = static_cast<uint8_t>(color >> 24);
+                    uint8_t low = static_cast<uint8_t>(color >> 8);
+                    converted[i * 4] = bgr ? low : high;
+                    converted[i * 4 + 1] = static_cast<uint8_t>(color >> 16);
+                    converted[i * 4 + 2] = bgr ? high : low;
+                    converted[i * 4 + 3] = static_cast<uint8_t>(color);
+                }
+                return converted.data();
+            }
+
+            // rows of indexed pixels are not 4 byte aligned
+            void setUnpackAlignment(const Pixels& pixels, GLint alignment) {
+                if (pixels.bytesPerPixel() != 4) {
+                    GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, alignment));
+                }
+            }
+        }
+
+        Texture::Texture(const Pixels &pixels, bool deferred) : _size(pixels.size()), _format(pixels.format()) {
+            auto residency = TextureResidency::current();
+            auto queue = TextureUploadQueue::current();
+            if (!deferred || (!residency && !queue)) {
+                _upload(pixels);
+                return;
+            }
+
+            _keep(pixels);
+            if (residency) {
+                _evictable = true;
+                residency->add(_bytes());
             }
+            if (queue) {
+                queue->push(this);
+            }
+        }
+
+        void Texture::_keep(const Pixels& pixels) {
+            auto data = static_cast<const uint8_t*>(pixels.data());
+            _pixels.assign(data, data + _bytes());
+        }
+
+        void Texture::_upload(const Pixels& pixels) const {
+            GL_CHECK(glGenTextures(1, &_textureID));
+            GLState::current()->bindTexture(0, _textureID);
+
+            auto transfer = pixelTransfer(pixels.format());
+            std::vector<uint8_t> converted;
+            setUnpackAlignment(pixels, 1);
+            GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, transfer.internalFormat, _size.width(), _size.height(), 0, transfer.format,
+                                  transfer.type, pixelData(pixels, converted)));
+            setUnpackAlignment(pixels, 4);
             GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
             GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+            if (gles()) {
+                // textures of any size are complete on GLES 2 only if they don't repeat
+                GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+                GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+            }
+            MemoryStats::add(MemoryStats::Category::TEXTURES, _bytes());
+
+            if (_evictable) {
+                if (auto residency = TextureResidency::current()) {
+                    // not evicted before it is drawn
+                    _lastDrawn = residency->frame();
+                    residency->uploaded(const_cast<Texture*>(this), _bytes());
+                }
+            }
+        }
+
+        Texture::Texture(std::shared_ptr<TextureAtlasPage> page, const Point& position, const Pixels& pixels, bool deferred)
+            : _size(pixels.size()), _offset(position), _format(pixels.format()), _page(std::move(page)) {
+            if (_format != _page->texture()->format()) {
+                throw std::logic_error("Pixels format differs from the atlas page format");
+            }
+            auto queue = TextureUploadQueue::current();
+            if (deferred && queue) {
+                _keep(pixels);
+                queue->push(this);
+                return;
+            }
+            _uploadToPage(pixels);
+        }
+
+        void Texture::_uploadToPage(const Pixels& pixels) const {
+            GLState::current()->bindTexture(0, _page->texture()->id());
+
+            auto transfer = pixelTransfer(pixels.format());
+            std::vector<uint8_t> converted;
+            setUnpackAlignment(pixels, 1);
+            GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, _offset.x(), _offset.y(), _size.width(), _size.height(), transfer.format,
+                                     transfer.type, pixelData(pixels, converted)));
+            setUnpackAlignment(pixels, 4);
+        }
+
+        void Texture::upload() const {
+            if (auto queue = TextureUploadQueue::current()) {
+                queue->remove(this);
+            }
+            if (resident()) {
+                return;
+            }
+
+            Pixels pixels(_pixels.data(), _size, _format);
+            if (_page) {
+                _uploadToPage(pixels);
+            } else {
+                _upload(pixels);
+            }
+            // evictable textures are uploaded again after an eviction
+            if (!_evictable) {
+                std::vector<uint8_t>().swap(_pixels);
+            }
+        }
+
+        bool Texture::ready() const {
+            if (resident()) {
+                return true;
+            }
+            auto queue = TextureUploadQueue::current();
+            if (!queue) {
+                // uploaded when bound
+                return true;
+            }
+            queue->request(this);
+            return false;
+        }
+
+        void Texture::update(const Pixels& pixels) {
+            if (_page) {
+                throw std::logic_error("Images placed into an atlas can't be updated");
+            }
+            if (!_pixels.empty() || _evictable) {
+                throw std::logic_error("Deferred textures can't be updated");
+            }
+            if (pixels.format() != _format || pixels.size() != _size) {
+                throw std::logic_error("Pixels differ from the texture format or size");
+            }
+            GLState::current()->bindTexture(0, _textureID);
+
+            auto transfer = pixelTransfer(_format);
+            std::vector<uint8_t> converted;
+            setUnpackAlignment(pixels, 1);
+            GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _size.width(), _size.height(), transfer.format, transfer.type,
+                                     pixelData(pixels, converted)));
+            setUnpackAlignment(pixels, 4);
         }
 
         Texture::~Texture() {
+            if (!resident()) {
+                if (auto queue = TextureUploadQueue::current()) {
+                    queue->remove(this);
+                }
+            }
+            if (_page) {
+                _page->release();
+            }
+            _deleteTexture();
+            if (_evictable) {
+                if (auto residency = TextureResidency::current()) {
+                    residency->remove(_bytes());
+                }
+            }
+        }
+
+        void Texture::_deleteTexture() {
             if (_textureID > 0) {
+                if (_evictable) {
+                    if (auto residency = TextureResidency::current()) {
+                        residency->released(this, _bytes());
+                    }
+                }
+                if (auto state = GLState::current()) {
+                    state->forgetTexture(_textureID);
+                }
                 glDeleteTextures(1, &_textureID);
                 _textureID = 0;
+                MemoryStats::remove(MemoryStats::Category::TEXTURES, _bytes());
             }
         }
 
+        bool Texture::evictable() const {
+            return _evictable;
+        }
+
+        bool Texture::resident() const {
+            // pixels of images placed into an atlas are kept only until they are uploaded
+            return _page ? _pixels.empty() : _textureID > 0;
+        }
+
+        void Texture::evict() {
+            if (_evictable) {
+                _deleteTexture();
+            }
+        }
+
+        unsigned long long Texture::lastDrawn() const {
+            return _lastDrawn;
+        }
+
+        size_t Texture::_bytes() const {
+            // indexed textures have a single 8 bit channel, the others are uploaded as RGBA
+            return static_cast<size_t>(_size.width()) * _size.height() * (_format == Pixels::Format::Indexed ? 1 : 4);
+        }
+
         const Size &Texture::size() const {
             return _size;
         }
 
+        GLuint Texture::id() const {
+            if (!resident() && !_pixels.empty()) {
+                upload();
+            }
+            return _page ? _page->texture()->id() : _textureID;
+        }
+
+        Pixels::Format Texture::format() const {
+            return _format;
+        }
+
+        bool Texture::indexed() const {
+            return _format == Pixels::Format::Indexed;
+        }
+
+        const Point& Texture::offset() const {
+            return _offset;
+        }
+
+        const Size& Texture::textureSize() const {
+            return _page ? _page->size() : _size;
+        }
+
+        glm::vec4 Texture::texCoords(const Rectangle& part) const {
+            float width = (float)textureSize().width();
+            float height = (float)textureSize().height();
+            return glm::vec4(
+                (float)(_offset.x() + part.position().x()) / width,
+                (float)(_offset.y() + part.position().y()) / height,
+                (float)(_offset.x() + part.position().x() + part.size().width()) / width,
+                (float)(_offset.y() + part.position().y() + part.size().height()) / height
+            );
+        }
+
+        glm::vec4 Texture::texCoords() const {
+            return texCoords(Rectangle(Point(0, 0), _size));
+        }
+
         void Texture::bind(uint8_t unit) const {
             /*    if (unit > GL_MAX_TEXTURE_UNITS)
                 {
@@ -44,18 +313,13 @@ namespace Falltergeist {
                     return;
                 }
             */
-            GLint curunit = 0;
-            GLint curtexture = 0;
-
-            if (_textureID > 0) {
-                GL_CHECK(glGetIntegerv(GL_ACTIVE_TEXTURE, &curunit));
-                GL_CHECK(glGetIntegerv(GL_TEXTURE_BINDING_2D, &curtexture));
-
-                if (curunit != GL_TEXTURE0 + unit) {
-                    GL_CHECK(glActiveTexture(GL_TEXTURE0 + unit));
-                }
-                if (curunit != GL_TEXTURE0 + unit || (GLuint) curtexture != _textureID) {
-                    GL_CHECK(glBindTexture(GL_TEXTURE_2D, _textureID));
+            GLuint textureID = id();
+            if (textureID > 0) {
+                GLState::current()->bindTexture(unit, textureID);
+                if (_evictable) {
+                    if (auto residency = TextureResidency::current()) {
+                        _lastDrawn = residency->frame();
+                    }
                 }
             }
         }
@@ -67,21 +331,21 @@ namespace Falltergeist {
                     return;
                 }
             */
-            if (_textureID > 0) {
-                glActiveTexture(GL_TEXTURE0 + unit);
-                glBindTexture(GL_TEXTURE_2D, 0);
+            // evicted textures are not uploaded just to be unbound
+            if (resident()) {
+                GLState::current()->bindTexture(unit, 0);
             }
         }
 
-        bool Texture::opaque(unsigned int x, unsigned int y) {
-            if (x >= _size.width() || y >= _size.height() || y * _size.width() + x >= _mask.size()) {
+        bool Texture::opaque(unsigned int x, unsigned int y) const {
+            if (!_mask || x >= (unsigned int)_size.width() || y >= (unsigned int)_size.height()) {
                 return false;
             }
 
-            return _mask.at(y * _size.width() + x);
+            return _mask->opaque(x, y);
         }
 
-        void Texture::setMask(std::vector<bool> mask) {
+        void Texture::setMask(std::shared_ptr<const HitMask> mask) {
             _mask = std::move(mask);
         }
     }
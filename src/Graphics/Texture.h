@@ -3,9 +3,11 @@
 #include <memory>
 #include <vector>
 #include <GL/glew.h>
+#include <glm/glm.hpp>
 #include <SDL.h>
 #include <SDL_opengl.h>
 #include "../Graphics/Point.h"
+#include "../Graphics/Rectangle.h"
 #include "../Graphics/Size.h"
 #include "../Graphics/Pixels.h"
 
@@ -13,24 +15,90 @@ namespace Falltergeist
 {
     namespace Graphics
     {
+        class HitMask;
+        class TextureAtlasPage;
+
         class Texture final
         {
             public:
-                explicit Texture(const Pixels& pixels);
+                // Deferred textures keep a copy of the pixels and are uploaded by the TextureUploadQueue or on their
+                // first draw. While a texture budget is set they may be evicted again, see TextureResidency.
+                // Without either they are uploaded at once. They can't be updated
+                explicit Texture(const Pixels& pixels, bool deferred = false);
+                // Uploads the pixels into the atlas page at the given position
+                Texture(std::shared_ptr<TextureAtlasPage> page, const Point& position, const Pixels& pixels, bool deferred = false);
                 ~Texture();
 
+                // Replaces the whole image. pixels.data() is an offset into the buffer while a GL_PIXEL_UNPACK_BUFFER is bound
+                void update(const Pixels& pixels);
+
                 void bind(uint8_t unit=0) const;
                 void unbind(uint8_t unit=0);
 
-                bool opaque(unsigned int x, unsigned int y);
-                void setMask(std::vector<bool> mask);
+                bool opaque(unsigned int x, unsigned int y) const;
+                void setMask(std::shared_ptr<const HitMask> mask);
 
                 const Size& size() const;
 
+                // GL texture holding the image, shared by all textures of an atlas page. Uploads evicted textures
+                GLuint id() const;
+
+                bool evictable() const;
+
+                bool resident() const;
+
+                // Uploads the pixels of a deferred texture which isn't resident
+                void upload() const;
+
+                // Whether the texture can be drawn without waiting for its upload. A deferred texture which isn't
+                // resident is requested from the upload queue instead, callers skip drawing it this frame
+                bool ready() const;
+
+                // Deletes the GL texture of an evictable texture, the next draw uploads it again
+                void evict();
+
+                // TextureResidency::frame() of the last bind
+                unsigned long long lastDrawn() const;
+
+                Pixels::Format format() const;
+
+                // Indexed textures hold palette indexes, shaders have to look colors up in a palette texture
+                bool indexed() const;
+
+                // Position of the image in the GL texture
+                const Point& offset() const;
+
+                // Size of the GL texture, equal to size() unless the image is placed into an atlas
+                const Size& textureSize() const;
+
+                // Texture coordinates of the image part as (left, top, right, bottom)
+                glm::vec4 texCoords(const Rectangle& part) const;
+
+                glm::vec4 texCoords() const;
+
             private:
-                GLuint _textureID = 0;
+                // created on demand for evictable textures
+                mutable GLuint _textureID = 0;
+                mutable unsigned long long _lastDrawn = 0;
+                // deferred textures until uploaded, evictable ones for good
+                mutable std::vector<uint8_t> _pixels;
+                bool _evictable = false;
                 Size _size;
-                std::vector<bool> _mask;
+                Point _offset;
+                Pixels::Format _format;
+                std::shared_ptr<TextureAtlasPage> _page;
+                std::shared_ptr<const HitMask> _mask;
+
+                // GL memory of a texture which isn't placed into an atlas page
+                size_t _bytes() const;
+
+                void _keep(const Pixels& pixels);
+
+                void _upload(const Pixels& pixels) const;
+
+                void _uploadToPage(const Pixels& pixels) const;
+
+                void _deleteTexture();
         };
     }
 }
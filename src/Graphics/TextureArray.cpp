@@ -0,0 +1,102 @@
+#include "../Graphics/GLCheck.h"
+#include "../Graphics/GLState.h"
+#include "../Graphics/TextureArray.h"
+#include "../MemoryStats.h"
+#include <stdexcept>
+
+namespace Falltergeist {
+    namespace Graphics {
+        namespace {
+            struct PixelTransfer {
+                GLint internalFormat;
+                GLenum format;
+                GLenum type;
+            };
+
+            // same formats as textures of the 3.2 path
+            PixelTransfer pixelTransfer(Pixels::Format format) {
+                switch (format) {
+                    case Pixels::Format::RGB:
+                        return {GL_RGBA, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8};
+                    case Pixels::Format::RGBA:
+                        return {GL_RGBA, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8};
+                    case Pixels::Format::Indexed:
+                        return {GL_R8, GL_RED, GL_UNSIGNED_BYTE};
+                    default:
+                        throw std::logic_error("Unsupported pixels format");
+                }
+            }
+        }
+
+        TextureArray::TextureArray(const Size& size, unsigned int layers, Pixels::Format format)
+            : _size(size), _layers(layers), _format(format) {
+            if (layers == 0) {
+                throw std::logic_error("Texture array should have layers");
+            }
+
+            GL_CHECK(glGenTextures(1, &_textureID));
+            GLState::current()->bindTextureArray(0, _textureID);
+
+            auto transfer = pixelTransfer(_format);
+            GL_CHECK(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, transfer.internalFormat, _size.width(), _size.height(), _layers, 0,
+                                  transfer.format, transfer.type, nullptr));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+            GL_CHECK(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+            MemoryStats::add(MemoryStats::Category::TEXTURES, _bytes());
+        }
+
+        TextureArray::~TextureArray() {
+            if (auto state = GLState::current()) {
+                state->forgetTexture(_textureID);
+            }
+            glDeleteTextures(1, &_textureID);
+            MemoryStats::remove(MemoryStats::Category::TEXTURES, _bytes());
+        }
+
+        void TextureArray::setLayer(unsigned int layer, const Pixels& pixels) {
+            if (layer >= _layers) {
+                throw std::out_of_range("Texture array layer is out of range");
+            }
+            if (pixels.format() != _format) {
+                throw std::logic_error("Pixels format differs from the texture array format");
+            }
+            if (pixels.size().width() > _size.width() || pixels.size().height() > _size.height()) {
+                throw std::logic_error("Pixels are larger than the texture array layer");
+            }
+
+            GLState::current()->bindTextureArray(0, _textureID);
+            auto transfer = pixelTransfer(_format);
+            // rows of indexed pixels are not 4 byte aligned
+            if (pixels.bytesPerPixel() != 4) {
+                GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+            }
+            GL_CHECK(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, pixels.size().width(), pixels.size().height(), 1,
+                                     transfer.format, transfer.type, pixels.data()));
+            if (pixels.bytesPerPixel() != 4) {
+                GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+            }
+        }
+
+        void TextureArray::bind(uint8_t unit) const {
+            GLState::current()->bindTextureArray(unit, _textureID);
+        }
+
+        const Size& TextureArray::size() const {
+            return _size;
+        }
+
+        unsigned int TextureArray::layers() const {
+            return _layers;
+        }
+
+        Pixels::Format TextureArray::format() const {
+            return _format;
+        }
+
+        size_t TextureArray::_bytes() const {
+            return static_cast<size_t>(_size.width()) * _size.height() * _layers * (_format == Pixels::Format::Indexed ? 1 : 4);
+        }
+    }
+}
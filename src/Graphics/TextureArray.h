@@ -0,0 +1,48 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "../Graphics/Pixels.h"
+#include "../Graphics/Size.h"
+
+namespace Falltergeist {
+    namespace Graphics {
+        /**
+         * GL_TEXTURE_2D_ARRAY of equally sized layers, so images of several atlas pages are drawn with one bind
+         * Shaders sample it with a sampler2DArray and the layer as the third texture coordinate. 3.2 path only,
+         * see Renderer::supportsTextureArrays()
+         */
+        class TextureArray final {
+        public:
+            // Allocates all layers at once, their pixels are undefined until set
+            TextureArray(const Size& size, unsigned int layers, Pixels::Format format);
+
+            ~TextureArray();
+
+            TextureArray(const TextureArray&) = delete;
+
+            TextureArray& operator=(const TextureArray&) = delete;
+
+            // Writes the pixels into the top left corner of the layer, they may be smaller than the layer
+            void setLayer(unsigned int layer, const Pixels& pixels);
+
+            void bind(uint8_t unit = 0) const;
+
+            const Size& size() const;
+
+            unsigned int layers() const;
+
+            Pixels::Format format() const;
+
+        private:
+            GLuint _textureID = 0;
+
+            Size _size;
+
+            unsigned int _layers;
+
+            Pixels::Format _format;
+
+            size_t _bytes() const;
+        };
+    }
+}
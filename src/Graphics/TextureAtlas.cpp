@@ -0,0 +1,147 @@
+#include "../Graphics/TextureAtlas.h"
+#include "../Graphics/Texture.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace Falltergeist {
+    namespace Graphics {
+        namespace {
+            // Transparent pixels kept between images and along the top and left page edges
+            const int PADDING = 1;
+        }
+
+        TextureAtlasPage::TextureAtlasPage(const Size& size, Pixels::Format format) : _size(size) {
+            // pages start transparent (zero is also the transparent palette index), padding is never written afterwards
+            std::vector<uint8_t> pixels(static_cast<size_t>(size.width()) * size.height() * Pixels::bytesPerPixel(format), 0);
+            _texture = std::make_unique<Texture>(Pixels(pixels.data(), size, format));
+            _clear();
+        }
+
+        TextureAtlasPage::~TextureAtlasPage() {
+        }
+
+        bool TextureAtlasPage::allocate(const Size& size, Point& position) {
+            Size footprint(size.width() + PADDING, size.height() + PADDING);
+
+            size_t bestSegment = _skyline.size();
+            int bestY = _size.height();
+            int bestX = _size.width();
+            for (size_t i = 0; i != _skyline.size(); ++i) {
+                int y = _fit(i, footprint);
+                if (y >= 0 && (y < bestY || (y == bestY && _skyline[i].x < bestX))) {
+                    bestSegment = i;
+                    bestY = y;
+                    bestX = _skyline[i].x;
+                }
+            }
+            if (bestSegment == _skyline.size()) {
+                return false;
+            }
+
+            Segment segment = {bestX, bestY + footprint.height(), footprint.width()};
+            _skyline.insert(_skyline.begin() + bestSegment, segment);
+
+            // shrink or remove the segments now covered by the new one
+            int right = segment.x + segment.width;
+            for (size_t i = bestSegment + 1; i < _skyline.size();) {
+                if (_skyline[i].x >= right) {
+                    break;
+                }
+                int overlap = right - _skyline[i].x;
+                if (overlap >= _skyline[i].width) {
+                    _skyline.erase(_skyline.begin() + i);
+                    continue;
+                }
+                _skyline[i].x += overlap;
+                _skyline[i].width -= overlap;
+                break;
+            }
+
+            // merge neighbours on the same height
+            for (size_t i = 0; i + 1 < _skyline.size();) {
+                if (_skyline[i].y == _skyline[i + 1].y) {
+                    _skyline[i].width += _skyline[i + 1].width;
+                    _skyline.erase(_skyline.begin() + i + 1);
+                } else {
+                    ++i;
+                }
+            }
+
+            position = Point(bestX, bestY);
+            ++_allocations;
+            return true;
+        }
+
+        void TextureAtlasPage::release() {
+            if (_allocations > 0 && --_allocations == 0) {
+                _clear();
+            }
+        }
+
+        Texture* TextureAtlasPage::texture() const {
+            return _texture.get();
+        }
+
+        const Size& TextureAtlasPage::size() const {
+            return _size;
+        }
+
+        void TextureAtlasPage::_clear() {
+            _skyline.clear();
+            _skyline.push_back({PADDING, PADDING, _size.width() - PADDING});
+        }
+
+        int TextureAtlasPage::_fit(size_t segment, const Size& size) const {
+            int x = _skyline[segment].x;
+            if (x + size.width() > _size.width()) {
+                return -1;
+            }
+
+            int y = 0;
+            int remaining = size.width();
+            for (size_t i = segment; remaining > 0; ++i) {
+                y = std::max(y, _skyline[i].y);
+                if (y + size.height() > _size.height()) {
+                    return -1;
+                }
+                remaining -= _skyline[i].width;
+            }
+            return y;
+        }
+
+        TextureAtlas::TextureAtlas(unsigned int pageSize, Pixels::Format format) : _pageSize(pageSize, pageSize), _format(format) {
+        }
+
+        TextureAtlas::~TextureAtlas() {
+        }
+
+        std::unique_ptr<Texture> TextureAtlas::allocate(const Pixels& pixels, bool deferred) {
+            if (pixels.format() != _format) {
+                throw std::logic_error("Pixels format differs from the atlas format");
+            }
+
+            // large images would leave pages mostly empty, they keep their own textures
+            if (pixels.size().width() > _pageSize.width() / 2 || pixels.size().height() > _pageSize.height() / 2) {
+                return nullptr;
+            }
+
+            Point position;
+            for (auto& page : _pages) {
+                if (page->allocate(pixels.size(), position)) {
+                    return std::make_unique<Texture>(page, position, pixels, deferred);
+                }
+            }
+
+            auto page = std::make_shared<TextureAtlasPage>(_pageSize, _format);
+            _pages.push_back(page);
+            if (!page->allocate(pixels.size(), position)) {
+                return nullptr;
+            }
+            return std::make_unique<Texture>(page, position, pixels, deferred);
+        }
+
+        size_t TextureAtlas::pages() const {
+            return _pages.size();
+        }
+    }
+}
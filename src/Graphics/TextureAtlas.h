@@ -0,0 +1,81 @@
+#pragma once
+
+#include "../Graphics/Pixels.h"
+#include "../Graphics/Point.h"
+#include "../Graphics/Size.h"
+#include <memory>
+#include <vector>
+
+namespace Falltergeist {
+    namespace Graphics {
+        class Texture;
+
+        /**
+         * Single texture of a TextureAtlas, packed with the skyline bottom-left heuristic
+         * Images are separated by one transparent pixel, so sampling neighbours (outlines) never reads another image
+         * Space is not reused until every image of the page is released, then the page is cleared
+         */
+        class TextureAtlasPage final {
+        public:
+            TextureAtlasPage(const Size& size, Pixels::Format format);
+
+            ~TextureAtlasPage();
+
+            // Finds space for an image of the given size, returns false if the page is full
+            bool allocate(const Size& size, Point& position);
+
+            // Called by textures placed into the page when they are destroyed
+            void release();
+
+            Texture* texture() const;
+
+            const Size& size() const;
+
+        private:
+            struct Segment {
+                int x;
+                int y;
+                int width;
+            };
+
+            Size _size;
+
+            std::unique_ptr<Texture> _texture;
+
+            // top edge of the allocated area, sorted by x and covering the whole page width
+            std::vector<Segment> _skyline;
+
+            unsigned int _allocations = 0;
+
+            void _clear();
+
+            // Lowest y at which an image of the given width fits when placed at the segment, -1 if it doesn't fit
+            int _fit(size_t segment, const Size& size) const;
+        };
+
+        /**
+         * TextureAtlas places small images into shared pages, so sprites drawn one after another bind the same texture
+         * Textures returned by it know their position in the page and release the space when destroyed
+         */
+        class TextureAtlas final {
+        public:
+            // Every image placed into the atlas has to be in the given format
+            TextureAtlas(unsigned int pageSize, Pixels::Format format = Pixels::Format::RGBA);
+
+            ~TextureAtlas();
+
+            // Places the pixels into a page, returns nullptr if the image is too large to be shared
+            // Deferred images are uploaded into the page later, see Texture
+            std::unique_ptr<Texture> allocate(const Pixels& pixels, bool deferred = false);
+
+            size_t pages() const;
+
+        private:
+            Size _pageSize;
+
+            Pixels::Format _format;
+
+            std::vector<std::shared_ptr<TextureAtlasPage>> _pages;
+        };
+    }
+}
@@ -0,0 +1,184 @@
+#include "../Graphics/TexturePack.h"
+#include "../Exception.h"
+#include "../VFS/DatArchiveIndex.h"
+#include "../VFS/FileMapping.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+namespace Falltergeist {
+    namespace Graphics {
+        namespace {
+            // images start at multiples of it, rows of RGBA images stay aligned for the upload
+            const uint64_t IMAGE_ALIGNMENT = 16;
+
+            struct Header {
+                char magic[4];
+                uint32_t version;
+                uint64_t dataStamp;
+                uint64_t tableOffset;
+                uint32_t count;
+                uint32_t namesSize;
+            };
+        }
+
+        const char TexturePack::MAGIC[4] = {'F', 'G', 'T', 'P'};
+
+        std::unique_ptr<TexturePack> TexturePack::open(const std::string& path, uint64_t dataStamp) {
+            std::error_code error;
+            if (!std::filesystem::is_regular_file(path, error)) {
+                return nullptr;
+            }
+
+            std::unique_ptr<VFS::FileMapping> mapping;
+            try {
+                mapping = std::make_unique<VFS::FileMapping>(path);
+            } catch (const Exception&) {
+                return nullptr;
+            }
+
+            Header header;
+            if (mapping->size() < sizeof(header)) {
+                return nullptr;
+            }
+            std::memcpy(&header, mapping->data(), sizeof(header));
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.dataStamp != dataStamp
+                || header.tableOffset % alignof(Record) != 0
+                || header.tableOffset + static_cast<uint64_t>(header.count) * sizeof(Record) + header.namesSize > mapping->size()) {
+                return nullptr;
+            }
+
+            std::unique_ptr<TexturePack> pack(new TexturePack());
+            pack->_records = reinterpret_cast<const Record*>(mapping->data() + header.tableOffset);
+            pack->_count = header.count;
+            pack->_names = reinterpret_cast<const char*>(pack->_records + header.count);
+
+            // a truncated pack must not point past the mapping
+            for (size_t i = 0; i != pack->_count; ++i) {
+                auto& record = pack->_records[i];
+                uint64_t bytes = static_cast<uint64_t>(record.width) * record.height
+                    * Pixels::bytesPerPixel(static_cast<Pixels::Format>(record.format));
+                if (record.format > static_cast<uint32_t>(Pixels::Format::Indexed) || record.dataOffset + bytes > header.tableOffset || record.nameOffset + record.nameSize > header.namesSize) {
+                    return nullptr;
+                }
+            }
+            pack->_mapping = std::move(mapping);
+            return pack;
+        }
+
+        TexturePack::~TexturePack() = default;
+
+        bool TexturePack::find(const std::string& path, const void*& data, Size& size, Pixels::Format& format) const {
+            std::string normalizedPath = VFS::DatArchiveIndex::normalizePath(path);
+            uint64_t pathHash = VFS::DatArchiveIndex::hash(normalizedPath);
+
+            auto end = _records + _count;
+            auto it = std::lower_bound(_records, end, pathHash, [](const Record& record, uint64_t value) {
+                return record.hash < value;
+            });
+            for (; it != end && it->hash == pathHash; ++it) {
+                if (normalizedPath.compare(0, std::string::npos, _names + it->nameOffset, it->nameSize) == 0) {
+                    data = _mapping->data() + it->dataOffset;
+                    size = Size(it->width, it->height);
+                    format = static_cast<Pixels::Format>(it->format);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        size_t TexturePack::size() const {
+            return _count;
+        }
+
+        TexturePackWriter::TexturePackWriter(const std::string& path, uint64_t dataStamp) : _path(path), _temporaryPath(path + ".tmp") {
+            _stream.open(_temporaryPath, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+            if (!_stream) {
+                throw Exception("TexturePackWriter - can't write " + _temporaryPath);
+            }
+
+            // the table is not known yet, the header is written again by finish()
+            Header header = {};
+            std::memcpy(header.magic, TexturePack::MAGIC, sizeof(header.magic));
+            header.version = TexturePack::VERSION;
+            header.dataStamp = dataStamp;
+            _stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        TexturePackWriter::~TexturePackWriter() {
+            if (_stream.is_open()) {
+                _stream.close();
+                std::error_code error;
+                std::filesystem::remove(_temporaryPath, error);
+            }
+        }
+
+        void TexturePackWriter::add(const std::string& path, const Pixels& pixels) {
+            uint64_t offset = static_cast<uint64_t>(_stream.tellp());
+            uint64_t padding = (IMAGE_ALIGNMENT - offset % IMAGE_ALIGNMENT) % IMAGE_ALIGNMENT;
+            const char zeros[IMAGE_ALIGNMENT] = {};
+            _stream.write(zeros, padding);
+
+            std::string normalizedPath = VFS::DatArchiveIndex::normalizePath(path);
+            TexturePack::Record record = {};
+            record.hash = VFS::DatArchiveIndex::hash(normalizedPath);
+            record.nameOffset = static_cast<uint32_t>(_names.size());
+            record.nameSize = static_cast<uint32_t>(normalizedPath.size());
+            record.width = static_cast<uint32_t>(pixels.size().width());
+            record.height = static_cast<uint32_t>(pixels.size().height());
+            record.format = static_cast<uint32_t>(pixels.format());
+            record.dataOffset = offset + padding;
+            _records.push_back(record);
+            _names += normalizedPath;
+
+            _stream.write(
+                static_cast<const char*>(pixels.data()),
+                static_cast<std::streamsize>(record.width) * record.height * pixels.bytesPerPixel()
+            );
+        }
+
+        bool TexturePackWriter::finish() {
+            std::stable_sort(_records.begin(), _records.end(), [](const TexturePack::Record& a, const TexturePack::Record& b) {
+                return a.hash < b.hash;
+            });
+
+            uint64_t offset = static_cast<uint64_t>(_stream.tellp());
+            uint64_t padding = (alignof(TexturePack::Record) - offset % alignof(TexturePack::Record)) % alignof(TexturePack::Record);
+            const char zeros[alignof(TexturePack::Record)] = {};
+            _stream.write(zeros, padding);
+
+            Header header = {};
+            std::memcpy(header.magic, TexturePack::MAGIC, sizeof(header.magic));
+            header.version = TexturePack::VERSION;
+            header.tableOffset = offset + padding;
+            header.count = static_cast<uint32_t>(_records.size());
+            header.namesSize = static_cast<uint32_t>(_names.size());
+
+            _stream.write(reinterpret_cast<const char*>(_records.data()), _records.size() * sizeof(TexturePack::Record));
+            _stream.write(_names.data(), _names.size());
+
+            // the stamp was written by the constructor
+            _stream.seekp(offsetof(Header, tableOffset));
+            _stream.write(reinterpret_cast<const char*>(&header.tableOffset), sizeof(header) - offsetof(Header, tableOffset));
+            _stream.close();
+            if (!_stream) {
+                std::error_code error;
+                std::filesystem::remove(_temporaryPath, error);
+                return false;
+            }
+
+            std::error_code error;
+            std::filesystem::rename(_temporaryPath, _path, error);
+            if (error) {
+                std::filesystem::remove(_temporaryPath, error);
+                return false;
+            }
+            return true;
+        }
+
+        size_t TexturePackWriter::size() const {
+            return _records.size();
+        }
+    }
+}
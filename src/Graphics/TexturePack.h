@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../Graphics/Pixels.h"
+#include "../Graphics/Size.h"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Falltergeist {
+    namespace VFS {
+        class FileMapping;
+    }
+
+    namespace Graphics {
+        /**
+         * TexturePack holds images baked from the game files in the format they are uploaded in, so textures are
+         * created without parsing or decoding anything. The pack is memory mapped, images are looked up
+         * by the FNV-1a hash of their normalized path like entries of a DatArchiveIndex
+         * A pack is only used with the game files it was baked from
+         */
+        class TexturePack final {
+        public:
+            // Returns nullptr if there is no pack at the path, it is broken or baked from other game files
+            static std::unique_ptr<TexturePack> open(const std::string& path, uint64_t dataStamp);
+
+            TexturePack(const TexturePack& other) = delete;
+
+            TexturePack& operator=(const TexturePack& other) = delete;
+
+            ~TexturePack();
+
+            // Pixels of the image point into the mapping of the pack, false if the pack doesn't have it
+            bool find(const std::string& path, const void*& data, Size& size, Pixels::Format& format) const;
+
+            size_t size() const;
+
+        private:
+            friend class TexturePackWriter;
+
+            static const char MAGIC[4];
+
+            static const uint32_t VERSION = 1;
+
+            struct Record {
+                uint64_t hash;
+                uint32_t nameOffset;
+                uint32_t nameSize;
+                uint32_t width;
+                uint32_t height;
+                uint32_t format;
+                uint32_t reserved;
+                uint64_t dataOffset;
+            };
+
+            TexturePack() = default;
+
+            std::unique_ptr<VFS::FileMapping> _mapping;
+
+            const Record* _records = nullptr;
+
+            size_t _count = 0;
+
+            const char* _names = nullptr;
+        };
+
+        /**
+         * Writes images one at a time to a TexturePack file, the lookup table is added by finish()
+         */
+        class TexturePackWriter final {
+        public:
+            // The file is written next to the path and takes its place when finished
+            TexturePackWriter(const std::string& path, uint64_t dataStamp);
+
+            ~TexturePackWriter();
+
+            // Images are added once, the path is normalized
+            void add(const std::string& path, const Pixels& pixels);
+
+            // Returns false if the pack can't be written
+            bool finish();
+
+            size_t size() const;
+
+        private:
+            std::string _path;
+
+            std::string _temporaryPath;
+
+            std::ofstream _stream;
+
+            std::vector<TexturePack::Record> _records;
+
+            std::string _names;
+        };
+    }
+}
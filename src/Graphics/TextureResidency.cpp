@@ -0,0 +1,88 @@
+#include "../Graphics/TextureResidency.h"
+#include "../Graphics/Texture.h"
+#include <algorithm>
+
+namespace Falltergeist {
+    namespace Graphics {
+        TextureResidency* TextureResidency::_current = nullptr;
+
+        TextureResidency::TextureResidency(size_t budget) : _budget(budget) {
+            _current = this;
+        }
+
+        TextureResidency::~TextureResidency() {
+            if (_current == this) {
+                _current = nullptr;
+            }
+        }
+
+        TextureResidency* TextureResidency::current() {
+            return _current;
+        }
+
+        size_t TextureResidency::budget() const {
+            return _budget;
+        }
+
+        unsigned long long TextureResidency::frame() const {
+            return _frame;
+        }
+
+        void TextureResidency::add(size_t bytes) {
+            _bytes += bytes;
+            ++_textures;
+        }
+
+        void TextureResidency::remove(size_t bytes) {
+            _bytes -= bytes;
+            --_textures;
+        }
+
+        void TextureResidency::uploaded(Texture* texture, size_t bytes) {
+            _resident.push_back(texture);
+            _residentBytes += bytes;
+        }
+
+        void TextureResidency::released(Texture* texture, size_t bytes) {
+            auto it = std::find(_resident.begin(), _resident.end(), texture);
+            if (it != _resident.end()) {
+                *it = _resident.back();
+                _resident.pop_back();
+                _residentBytes -= bytes;
+            }
+        }
+
+        void TextureResidency::endFrame() {
+            if (_residentBytes > _budget) {
+                auto candidates = _resident;
+                std::sort(candidates.begin(), candidates.end(), [](const Texture* lhs, const Texture* rhs) {
+                    return lhs->lastDrawn() < rhs->lastDrawn();
+                });
+                for (auto texture : candidates) {
+                    // sorted by the last draw, everything left was drawn in this frame
+                    if (_residentBytes <= _budget || texture->lastDrawn() == _frame) {
+                        break;
+                    }
+                    texture->evict();
+                }
+            }
+            ++_frame;
+        }
+
+        size_t TextureResidency::residentBytes() const {
+            return _residentBytes;
+        }
+
+        size_t TextureResidency::residentTextures() const {
+            return _resident.size();
+        }
+
+        size_t TextureResidency::evictedBytes() const {
+            return _bytes - _residentBytes;
+        }
+
+        size_t TextureResidency::evictedTextures() const {
+            return _textures - _resident.size();
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Falltergeist {
+    namespace Graphics {
+        class Texture;
+
+        /**
+         * TextureResidency keeps the GPU memory of evictable textures within a budget. Such textures keep their
+         * pixels in memory and are uploaded when first drawn, so only what gets on screen takes GPU memory.
+         * After a frame the least recently drawn ones are evicted until the resident ones fit the budget,
+         * textures drawn in that frame stay resident even if they exceed it.
+         * It is owned by the renderer if a budget is set, evictable textures are plain textures otherwise.
+         */
+        class TextureResidency final {
+        public:
+            explicit TextureResidency(size_t budget);
+
+            ~TextureResidency();
+
+            TextureResidency(const TextureResidency&) = delete;
+
+            TextureResidency& operator=(const TextureResidency&) = delete;
+
+            // Residency of the current context, nullptr if there is no budget
+            static TextureResidency* current();
+
+            size_t budget() const;
+
+            // Counted frames, textures remember the one they were last drawn in
+            unsigned long long frame() const;
+
+            // Called by evictable textures when they are created and destroyed
+            void add(size_t bytes);
+            void remove(size_t bytes);
+
+            // Called by evictable textures when they were uploaded and before their GL texture is deleted
+            void uploaded(Texture* texture, size_t bytes);
+            void released(Texture* texture, size_t bytes);
+
+            // Evicts least recently drawn textures over the budget, once per frame after its draws
+            void endFrame();
+
+            size_t residentBytes() const;
+
+            size_t residentTextures() const;
+
+            // Evicted textures wait for their next draw with their pixels in memory
+            size_t evictedBytes() const;
+
+            size_t evictedTextures() const;
+
+        private:
+            static TextureResidency* _current;
+
+            size_t _budget;
+
+            unsigned long long _frame = 0;
+
+            std::vector<Texture*> _resident;
+
+            size_t _residentBytes = 0;
+
+            // all evictable textures, resident or not
+            size_t _bytes = 0;
+
+            size_t _textures = 0;
+        };
+    }
+}
@@ -0,0 +1,77 @@
+#include "../Graphics/TextureUploadQueue.h"
+#include "../Graphics/Texture.h"
+#include <algorithm>
+
+namespace Falltergeist {
+    namespace Graphics {
+        TextureUploadQueue* TextureUploadQueue::_current = nullptr;
+
+        TextureUploadQueue::TextureUploadQueue(size_t budget) : _budget(budget) {
+            _current = this;
+        }
+
+        TextureUploadQueue::~TextureUploadQueue() {
+            if (_current == this) {
+                _current = nullptr;
+            }
+        }
+
+        TextureUploadQueue* TextureUploadQueue::current() {
+            return _current;
+        }
+
+        size_t TextureUploadQueue::budget() const {
+            return _budget;
+        }
+
+        void TextureUploadQueue::push(const Texture* texture) {
+            if (_pending.emplace(texture, false).second) {
+                _queued.push_back(texture);
+            }
+        }
+
+        void TextureUploadQueue::request(const Texture* texture) {
+            auto it = _pending.find(texture);
+            if (it == _pending.end()) {
+                _pending.emplace(texture, true);
+            } else if (!it->second) {
+                it->second = true;
+                _erase(_queued, texture);
+            } else {
+                return;
+            }
+            _requested.push_back(texture);
+        }
+
+        void TextureUploadQueue::remove(const Texture* texture) {
+            auto it = _pending.find(texture);
+            if (it == _pending.end()) {
+                return;
+            }
+            _erase(it->second ? _requested : _queued, texture);
+            _pending.erase(it);
+        }
+
+        void TextureUploadQueue::_erase(std::deque<const Texture*>& queue, const Texture* texture) {
+            auto it = std::find(queue.begin(), queue.end(), texture);
+            if (it != queue.end()) {
+                queue.erase(it);
+            }
+        }
+
+        void TextureUploadQueue::upload() {
+            size_t uploaded = 0;
+            while (uploaded < _budget && !_pending.empty()) {
+                auto texture = _requested.empty() ? _queued.front() : _requested.front();
+                uploaded += static_cast<size_t>(texture->size().width()) * texture->size().height()
+                            * Pixels::bytesPerPixel(texture->format());
+                // removes the texture from the queue
+                texture->upload();
+            }
+        }
+
+        size_t TextureUploadQueue::pending() const {
+            return _pending.size();
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+
+namespace Falltergeist {
+    namespace Graphics {
+        class Texture;
+
+        /**
+         * TextureUploadQueue spreads the uploads of deferred textures over frames, so a state creating dozens of
+         * sprites at once doesn't stall a single frame. Every frame uploads up to a byte budget, at least one texture.
+         * Textures somebody tried to draw go first, the others follow in the order they were created.
+         * It is owned by the renderer if an upload budget is set, deferred textures are uploaded at once otherwise.
+         */
+        class TextureUploadQueue final {
+        public:
+            explicit TextureUploadQueue(size_t budget);
+
+            ~TextureUploadQueue();
+
+            TextureUploadQueue(const TextureUploadQueue&) = delete;
+
+            TextureUploadQueue& operator=(const TextureUploadQueue&) = delete;
+
+            // Queue of the current context, nullptr if there is no upload budget
+            static TextureUploadQueue* current();
+
+            size_t budget() const;
+
+            void push(const Texture* texture);
+
+            // Moves the texture ahead of the ones nobody has drawn yet, queueing it if it isn't
+            void request(const Texture* texture);
+
+            // Called by textures which were uploaded or destroyed
+            void remove(const Texture* texture);
+
+            // Uploads the next textures, once per frame before its draws
+            void upload();
+
+            size_t pending() const;
+
+        private:
+            static TextureUploadQueue* _current;
+
+            size_t _budget;
+
+            std::deque<const Texture*> _requested;
+
+            std::deque<const Texture*> _queued;
+
+            // whether a pending texture is in the requested queue
+            std::unordered_map<const Texture*, bool> _pending;
+
+            void _erase(std::deque<const Texture*>& queue, const Texture* texture);
+        };
+    }
+}
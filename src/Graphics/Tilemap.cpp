@@ -3,6 +3,7 @@
 #include "../Graphics/AnimatedPalette.h"
 #include "../Graphics/GLCheck.h"
 #include "../Graphics/IndexBuffer.h"
+#include "../Graphics/RenderStats.h"
 #include "../Graphics/Shader.h"
 #include "../Graphics/Sprite.h"
 #include "../Graphics/Tilemap.h"
@@ -13,26 +14,67 @@ namespace Falltergeist {
     namespace Graphics {
         using Game::Game;
 
-        Tilemap::Tilemap(std::vector<glm::vec2> coords, std::vector<glm::vec2> textureCoords) {
-            if (coords.empty()) {
-                throw std::logic_error("Coordinates should not be empty");
-            }
-            if (textureCoords.empty()) {
-                throw std::logic_error("Texture coordinates should not be empty");
-            }
+        bool Tilemap::layered(uint32_t atlases) {
+            auto renderer = Game::getInstance()->renderer();
+            return renderer->supportsInstancing() && renderer->supportsTextureArrays() && atlases > 1
+                && atlases <= static_cast<uint32_t>(renderer->maxTextureArrayLayers());
+        }
 
-            _coordinatesVertexBuffer = std::make_unique<VertexBuffer>(&coords[0], coords.size() * sizeof(glm::vec2));
-            _textureCoordinatesVertexBuffer = std::make_unique<VertexBuffer>(&textureCoords[0], textureCoords.size() * sizeof(glm::vec2));
-            _vertexArray = std::make_unique<VertexArray>();
+        Tilemap::Tilemap(std::vector<Tile> tiles, uint32_t atlases) : _atlases(atlases) {
+            if (tiles.empty()) {
+                throw std::logic_error("Tiles should not be empty");
+            }
 
-            _shader = ResourceManager::getInstance()->shader("tilemap");
+            _instanced = Game::getInstance()->renderer()->supportsInstancing();
+            _layered = layered(atlases);
+            _shader = ResourceManager::getInstance()->shader(_layered ? "tilemap_array" : (_instanced ? "tilemap_instanced" : "tilemap"));
 
             _uniformTex = _shader->getUniform("tex");
             _uniformFade = _shader->getUniform("fade");
             _uniformMVP = _shader->getUniform("MVP");
-            _uniformCnt = _shader->getUniform("cnt");
             _uniformLight = _shader->getUniform("global_light");
             _uniformOffset = _shader->getUniform("offset");
+            // GLES atlases are indexed, their animated colors come from the palette instead of the counters
+            if (Game::getInstance()->renderer()->renderPath() == Renderer::RenderPath::GLES2) {
+                _uniformPalette = _shader->getUniform("palette");
+                _uniformCnt = -1;
+            } else {
+                _uniformPalette = -1;
+                _uniformCnt = _shader->getUniform("cnt");
+            }
+
+            if (_instanced) {
+                _attribCorner = _shader->getAttrib("Corner");
+                _attribTilePos = _shader->getAttrib("TilePosition");
+                _attribTileTex = _shader->getAttrib("TileTexCoords");
+                _attribTileLayer = _layered ? _shader->getAttrib("TileLayer") : -1;
+
+                // drawn as a strip, same winding as the quads of the index lists
+                glm::vec2 corners[4] = {glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(0.0f, 1.0f), glm::vec2(1.0f, 1.0f)};
+                _cornersVertexBuffer = std::make_unique<VertexBuffer>(corners, sizeof(corners));
+                _tiles = std::move(tiles);
+                return;
+            }
+
+            std::vector<glm::vec2> coords;
+            std::vector<glm::vec2> textureCoords;
+            coords.reserve(tiles.size() * 4);
+            textureCoords.reserve(tiles.size() * 4);
+            for (auto& tile : tiles) {
+                coords.push_back(tile.position);
+                coords.push_back(tile.position + glm::vec2(80.0f, 0.0f));
+                coords.push_back(tile.position + glm::vec2(0.0f, 36.0f));
+                coords.push_back(tile.position + glm::vec2(80.0f, 36.0f));
+
+                textureCoords.push_back(glm::vec2(tile.texCoords.x, tile.texCoords.y));
+                textureCoords.push_back(glm::vec2(tile.texCoords.z, tile.texCoords.y));
+                textureCoords.push_back(glm::vec2(tile.texCoords.x, tile.texCoords.w));
+                textureCoords.push_back(glm::vec2(tile.texCoords.z, tile.texCoords.w));
+            }
+
+            _coordinatesVertexBuffer = std::make_unique<VertexBuffer>(&coords[0], coords.size() * sizeof(glm::vec2));
+            _textureCoordinatesVertexBuffer = std::make_unique<VertexBuffer>(&textureCoords[0], textureCoords.size() * sizeof(glm::vec2));
+            _vertexArray = std::make_unique<VertexArray>();
 
             _attribPos = _shader->getAttrib("Position");
             _attribTex = _shader->getAttrib("TexCoord");
@@ -59,23 +101,105 @@ namespace Falltergeist {
         Tilemap::~Tilemap() {
         }
 
-        void Tilemap::render(const Point &pos, std::vector<GLuint> indexes, uint32_t atlas) {
-            if (indexes.empty()) {
-                throw std::logic_error("Indexes should not be empty");
-            };
+        void Tilemap::setTiles(uint32_t atlas, const std::vector<uint32_t>& tiles) {
+            if (_instanced) {
+                if (atlas >= _instanceBuffers.size()) {
+                    _instanceBuffers.resize(atlas + 1);
+                    _instanceArrays.resize(atlas + 1);
+                    _instanceCounts.resize(atlas + 1, 0);
+                }
+
+                _instances.clear();
+                for (auto tile : tiles) {
+                    _instances.push_back(_tiles[tile]);
+                }
+                _instanceCounts.at(atlas) = static_cast<unsigned int>(_instances.size());
+                if (_instances.empty()) {
+                    return;
+                }
+
+                // buffers only grow, to the most tiles of the atlas visible at once
+                unsigned int size = static_cast<unsigned int>(_instances.size() * sizeof(Tile));
+                auto& buffer = _instanceBuffers.at(atlas);
+                if (!buffer || buffer->size() < size) {
+                    buffer = std::make_unique<VertexBuffer>(nullptr, size, VertexBuffer::UsagePattern::DynamicDraw);
+                    _instanceArrays.at(atlas) = _instanceArray(buffer);
+                }
+                buffer->write(0, &_instances[0], size);
+                return;
+            }
+
+            if (atlas >= _indexBuffers.size()) {
+                _indexBuffers.resize(atlas + 1);
+            }
+
+            std::vector<GLuint> indexes;
+            indexes.reserve(tiles.size() * 6);
+            for (auto tile : tiles) {
+                GLuint quad[6] = {tile * 4, tile * 4 + 1, tile * 4 + 2, tile * 4 + 3, tile * 4 + 2, tile * 4 + 1};
+                indexes.insert(indexes.end(), quad, quad + 6);
+            }
+
+            // element array binding belongs to the vertex array
+            _vertexArray->bind();
+            const GLuint* data = indexes.empty() ? nullptr : &indexes[0];
+            if (_indexBuffers.at(atlas)) {
+                _indexBuffers.at(atlas)->update(data, static_cast<unsigned int>(indexes.size()));
+            } else {
+                _indexBuffers.at(atlas) = std::make_unique<IndexBuffer>(data, static_cast<unsigned int>(indexes.size()), IndexBuffer::UsagePattern::DynamicDraw);
+            }
+        }
+
+        std::unique_ptr<VertexArray> Tilemap::_instanceArray(const std::unique_ptr<VertexBuffer>& instances) const {
+            auto vertexArray = std::make_unique<VertexArray>();
+
+            VertexBufferLayout cornersLayout;
+            cornersLayout.addAttribute({(unsigned int)_attribCorner, 2, VertexBufferAttribute::Type::Float});
+            vertexArray->addBuffer(_cornersVertexBuffer, cornersLayout);
+
+            VertexBufferLayout instancesLayout;
+            instancesLayout.addAttribute({(unsigned int)_attribTilePos, 2, VertexBufferAttribute::Type::Float, false, 1});
+            instancesLayout.addAttribute({(unsigned int)_attribTileTex, 4, VertexBufferAttribute::Type::Float, false, 1});
+            if (_layered) {
+                instancesLayout.addAttribute({(unsigned int)_attribTileLayer, 1, VertexBufferAttribute::Type::Float, false, 1});
+            }
+            instancesLayout.setStride(sizeof(Tile));
+            vertexArray->addBuffer(instances, instancesLayout);
+            return vertexArray;
+        }
+
+        void Tilemap::render(const Point &pos, uint32_t atlas) {
+            if (_instanced) {
+                if (atlas >= _instanceCounts.size() || _instanceCounts.at(atlas) == 0) {
+                    return;
+                }
+            } else if (atlas >= _indexBuffers.size() || !_indexBuffers.at(atlas) || _indexBuffers.at(atlas)->count() == 0) {
+                return;
+            }
+
+            Game::getInstance()->renderer()->flush();
 
             _shader->use();
 
-            _textures.at(atlas).get()->bind(0);
+            if (_layered) {
+                _textureArray->bind(0);
+            } else {
+                _textures.at(atlas).get()->bind(0);
+            }
 
             _shader->setUniform(_uniformTex, 0);
 
+            if (!_layered && _textures.at(atlas)->indexed()) {
+                Game::getInstance()->renderer()->palette()->bind(2);
+                _shader->setUniform(_uniformPalette, 2);
+            }
+
             _shader->setUniform(_uniformMVP, Game::getInstance()->renderer()->getMVP());
 
             // set camera offset
             _shader->setUniform(_uniformOffset, glm::vec2((float) pos.x() + 1.0, (float) pos.y() + 2.0));
 
-            _shader->setUniform(_uniformFade, Game::getInstance()->renderer()->fadeColor());
+            _shader->setUniform(_uniformFade, Game::getInstance()->renderer()->drawFadeColor());
 
             _shader->setUniform(_uniformCnt, Game::getInstance()->animatedPalette()->counters());
 
@@ -92,21 +216,33 @@ namespace Falltergeist {
             }
             _shader->setUniform(_uniformLight, lightLevel);
 
+            if (_instanced) {
+                _instanceArrays.at(atlas)->bind();
+                GL_CHECK(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, _instanceCounts.at(atlas)));
+                RenderStats::drawCall(_instanceCounts.at(atlas) * 2);
+                return;
+            }
+
             _vertexArray->bind();
+            _indexBuffers.at(atlas)->bind();
 
-            IndexBuffer indexBuffer(&indexes[0], indexes.size(), IndexBuffer::UsagePattern::StaticDraw);
+            GL_CHECK(glDrawElements(GL_TRIANGLES, _indexBuffers.at(atlas)->count(), GL_UNSIGNED_INT, nullptr));
+            RenderStats::drawCall(_indexBuffers.at(atlas)->count() / 3);
+        }
 
-            GL_CHECK(glDrawElements(GL_TRIANGLES, indexes.size(), GL_UNSIGNED_INT, nullptr));
+        void Tilemap::addTexture(const Pixels& pixels) {
+            if (!_layered) {
+                _textures.push_back(std::make_unique<Texture>(pixels));
+                return;
+            }
+            if (!_textureArray) {
+                _textureArray = std::make_unique<TextureArray>(pixels.size(), _atlases, pixels.format());
+            }
+            _textureArray->setLayer(_layers++, pixels);
         }
 
-        void Tilemap::addTexture(SDL_Surface *surface) {
-            _textures.push_back(std::make_unique<Texture>(
-                Pixels(
-                    surface->pixels,
-                    Size(surface->w, surface->h),
-                    Pixels::Format::RGBA
-                )
-            ));
+        bool Tilemap::layered() const {
+            return _layered;
         }
     }
 }
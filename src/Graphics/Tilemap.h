@@ -1,9 +1,11 @@
 #pragma once
 
+#include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Point.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Shader.h"
 #include "../Graphics/Texture.h"
+#include "../Graphics/TextureArray.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/VertexArray.h"
 
@@ -11,19 +13,59 @@ namespace Falltergeist
 {
     namespace Graphics
     {
+        /**
+         * Tiles of a map drawn from atlases, one draw call per atlas. With instancing every tile is an instance
+         * of one unit quad and only the visible tiles are uploaded, otherwise every tile has four vertices
+         * kept on the GPU and the visible ones are drawn by index lists. Layered tilemaps keep the atlases as layers
+         * of one texture array and every tile knows its layer, all tiles are drawn by a single draw call of atlas 0
+         */
         class Tilemap
         {
             public:
-                Tilemap(std::vector<glm::vec2> coords, std::vector<glm::vec2> textureCoords);
+                struct Tile
+                {
+                    // top left corner
+                    glm::vec2 position;
+                    // (left, top, right, bottom) in the atlas of the tile
+                    glm::vec4 texCoords;
+                    // atlas of the tile, the texture array layer of layered tilemaps
+                    float layer;
+                };
+
+                // Whether a tilemap with that many atlases is layered. Its atlases have to be of the same size then
+                static bool layered(uint32_t atlases);
+
+                Tilemap(std::vector<Tile> tiles, uint32_t atlases);
                 ~Tilemap();
-                void render(const Point &pos, std::vector<GLuint> indexes, uint32_t atlas);
-                void addTexture(SDL_Surface* surface);
+                // Replaces the tiles drawn from the atlas by indexes of the tiles given to the constructor,
+                // they are kept on the GPU until the next call
+                void setTiles(uint32_t atlas, const std::vector<uint32_t>& tiles);
+                void render(const Point &pos, uint32_t atlas);
+                // Atlases are added in order, the pixels of all atlases of a layered tilemap have the same size
+                void addTexture(const Pixels& pixels);
+                bool layered() const;
 
             private:
+                bool _instanced = false;
+                bool _layered = false;
+                uint32_t _atlases;
+                std::vector<std::unique_ptr<Texture>> _textures;
+                std::unique_ptr<TextureArray> _textureArray;
+                uint32_t _layers = 0;
+
+                // without instancing
                 std::unique_ptr<VertexBuffer> _coordinatesVertexBuffer;
                 std::unique_ptr<VertexBuffer> _textureCoordinatesVertexBuffer;
                 std::unique_ptr<VertexArray> _vertexArray;
-                std::vector<std::unique_ptr<Texture>> _textures;
+                std::vector<std::unique_ptr<IndexBuffer>> _indexBuffers;
+
+                // with instancing, the instances of an atlas have a buffer and a vertex array of their own
+                std::vector<Tile> _tiles;
+                std::unique_ptr<VertexBuffer> _cornersVertexBuffer;
+                std::vector<std::unique_ptr<VertexBuffer>> _instanceBuffers;
+                std::vector<std::unique_ptr<VertexArray>> _instanceArrays;
+                std::vector<unsigned int> _instanceCounts;
+                std::vector<Tile> _instances;
 
                 GLint _uniformTex;
                 GLint _uniformFade;
@@ -31,10 +73,17 @@ namespace Falltergeist
                 GLint _uniformCnt;
                 GLint _uniformLight;
                 GLint _uniformOffset;
+                GLint _uniformPalette;
 
                 GLint _attribPos;
                 GLint _attribTex;
+                GLint _attribCorner;
+                GLint _attribTilePos;
+                GLint _attribTileTex;
+                GLint _attribTileLayer;
                 Graphics::Shader*_shader;
+
+                std::unique_ptr<VertexArray> _instanceArray(const std::unique_ptr<VertexBuffer>& instances) const;
         };
     }
 }
@@ -1,34 +1,38 @@
 #include "../Graphics/VertexArray.h"
 #include "../Graphics/VertexBufferLayout.h"
 #include "../Graphics/GLCheck.h"
+#include "../Graphics/GLState.h"
 #include <stdexcept>
 
 namespace Falltergeist {
     namespace Graphics {
         VertexArray::VertexArray() {
             GL_CHECK(glGenVertexArrays(1, &_resourceId));
-            GL_CHECK(glBindVertexArray(_resourceId));
+            GLState::current()->bindVertexArray(_resourceId);
         }
 
         VertexArray::~VertexArray() {
+            if (auto state = GLState::current()) {
+                state->forgetVertexArray(_resourceId);
+            }
             GL_CHECK(glDeleteVertexArrays(1, &_resourceId));
         }
 
         void VertexArray::bind() const {
-            GL_CHECK(glBindVertexArray(_resourceId));
+            GLState::current()->bindVertexArray(_resourceId);
         }
 
         void VertexArray::unbind() const {
-            GL_CHECK(glBindVertexArray(0));
+            GLState::current()->bindVertexArray(0);
         }
 
         void VertexArray::addBuffer(const std::unique_ptr<VertexBuffer>& buffer, const VertexBufferLayout &bufferLayout) {
             bind();
             buffer->bind();
             void * offset = 0;
-            unsigned int stride = 0;
+            unsigned int stride = bufferLayout.stride();
 
-            if (bufferLayout.attributes().size() > 1) {
+            if (stride == 0 && bufferLayout.attributes().size() > 1) {
                 for (auto &attribute : bufferLayout.attributes()) {
                     stride += attribute.size();
                 }
@@ -54,6 +58,14 @@ namespace Falltergeist {
                     stride,
                     static_cast<const void *>(offset)
                 ));
+                if (attribute.divisor()) {
+                    // core since 3.3, the 3.2 path runs with ARB_instanced_arrays otherwise
+                    if (glVertexAttribDivisor) {
+                        GL_CHECK(glVertexAttribDivisor(attribute.index(), attribute.divisor()));
+                    } else {
+                        GL_CHECK(glVertexAttribDivisorARB(attribute.index(), attribute.divisor()));
+                    }
+                }
                 offset = static_cast<char*>(offset) + attribute.size();
             }
         }
@@ -1,5 +1,7 @@
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/GLCheck.h"
+#include "../Graphics/RenderStats.h"
+#include <cstring>
 #include <stdexcept>
 
 namespace Falltergeist {
@@ -16,16 +18,36 @@ namespace Falltergeist {
                 case UsagePattern::StaticDraw:
                     usage = GL_STATIC_DRAW;
                     break;
+                case UsagePattern::StreamDraw:
+                case UsagePattern::PersistentStream:
+                    usage = GL_STREAM_DRAW;
+                    break;
                 default:
                     throw std::logic_error("Unsupported usage pattern");
             }
 
+            _usage = usage;
+
             GL_CHECK(glGenBuffers(1, &_resourceId));
             GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, _resourceId));
-            GL_CHECK(glBufferData(GL_ARRAY_BUFFER, size, data, usage));
+            if (usagePattern == UsagePattern::PersistentStream) {
+                GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                GL_CHECK(glBufferStorage(GL_ARRAY_BUFFER, size, data, flags));
+                _mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+                if (!_mapped) {
+                    throw std::runtime_error("Can't map persistent vertex buffer");
+                }
+            } else {
+                GL_CHECK(glBufferData(GL_ARRAY_BUFFER, size, data, usage));
+            }
+            RenderStats::bufferCreation(data ? size : 0);
         }
 
         VertexBuffer::~VertexBuffer() {
+            if (_mapped) {
+                bind();
+                GL_CHECK(glUnmapBuffer(GL_ARRAY_BUFFER));
+            }
             GL_CHECK(glDeleteBuffers(1, &_resourceId));
         }
 
@@ -44,5 +66,31 @@ namespace Falltergeist {
         unsigned int VertexBuffer::size() const {
             return _size;
         }
+
+        void VertexBuffer::orphan() {
+            if (_mapped) {
+                throw std::logic_error("Persistent vertex buffer can't be orphaned");
+            }
+            _data = nullptr;
+            bind();
+            GL_CHECK(glBufferData(GL_ARRAY_BUFFER, _size, nullptr, _usage));
+        }
+
+        void* VertexBuffer::mapped() const {
+            return _mapped;
+        }
+
+        void VertexBuffer::write(unsigned int offset, const void* data, unsigned int size) {
+            if (offset + size > _size) {
+                throw std::out_of_range("Vertex buffer write is out of range");
+            }
+            if (_mapped) {
+                std::memcpy(static_cast<char*>(_mapped) + offset, data, size);
+            } else {
+                bind();
+                GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+            }
+            RenderStats::bufferUpload(size);
+        }
     }
 }
@@ -6,7 +6,10 @@ namespace Falltergeist {
         public:
             enum class UsagePattern {
                 StaticDraw,
-                DynamicDraw
+                DynamicDraw,
+                StreamDraw,
+                // immutable storage mapped for writing while the GPU reads it, needs ARB_buffer_storage
+                PersistentStream
             };
 
             VertexBuffer(const void* data, unsigned int size, UsagePattern usagePattern = UsagePattern::StaticDraw);
@@ -17,10 +20,22 @@ namespace Falltergeist {
             const void* data() const;
             unsigned int size() const;
 
+            // Replaces the storage with a new uninitialized one, so pending draws don't stall the next write
+            // Not possible for persistent storage
+            void orphan();
+
+            // Coherent writable mapping of a persistent buffer, nullptr otherwise
+            void* mapped() const;
+
+            // Writes data into the storage at the given offset in bytes, copies into the mapping of a persistent buffer
+            void write(unsigned int offset, const void* data, unsigned int size);
+
         private:
             unsigned int _resourceId = 0;
             const void* _data;
             unsigned int _size;
+            unsigned int _usage;
+            void* _mapped = nullptr;
         };
 
     }
@@ -7,8 +7,9 @@ namespace Falltergeist {
             unsigned int index,
             unsigned int componentsCount,
             Type type,
-            bool normalized
-        ) : _index(index), _componentsCount(componentsCount), _type(type), _normalized(normalized) {
+            bool normalized,
+            unsigned int divisor
+        ) : _index(index), _componentsCount(componentsCount), _type(type), _normalized(normalized), _divisor(divisor) {
         }
 
         unsigned int VertexBufferAttribute::index() const {
@@ -27,6 +28,10 @@ namespace Falltergeist {
             return _normalized;
         }
 
+        unsigned int VertexBufferAttribute::divisor() const {
+            return _divisor;
+        }
+
         unsigned int VertexBufferAttribute::size() const {
             switch (type()) {
                 case Type::Float:
@@ -12,7 +12,8 @@ namespace Falltergeist {
                 unsigned int index,
                 unsigned int componentsCount,
                 Type type,
-                bool normalized = false
+                bool normalized = false,
+                unsigned int divisor = 0
             );
 
             unsigned int index() const;
@@ -20,11 +21,14 @@ namespace Falltergeist {
             Type type() const;
             bool normalized() const;
             unsigned int size() const;
+            // Instances sharing a value of the attribute, 0 if it advances per vertex
+            unsigned int divisor() const;
         private:
             unsigned int _index;
             unsigned int _componentsCount;
             Type _type;
             bool _normalized;
+            unsigned int _divisor;
         };
     }
 }
@@ -13,5 +13,13 @@ namespace Falltergeist {
         void VertexBufferLayout::addAttribute(const VertexBufferAttribute &attribute) {
             _attributes.emplace_back(attribute);
         }
+
+        unsigned int VertexBufferLayout::stride() const {
+            return _stride;
+        }
+
+        void VertexBufferLayout::setStride(unsigned int stride) {
+            _stride = stride;
+        }
     }
 }
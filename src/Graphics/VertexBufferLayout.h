@@ -11,8 +11,12 @@ namespace Falltergeist {
             VertexBufferLayout(const std::vector<VertexBufferAttribute>&& attributes);
             const std::vector<VertexBufferAttribute>& attributes() const;
             void addAttribute(const VertexBufferAttribute& attribute);
+            // Distance between vertices in bytes, 0 means attributes are tightly packed
+            unsigned int stride() const;
+            void setStride(unsigned int stride);
         private:
             std::vector<VertexBufferAttribute> _attributes;
+            unsigned int _stride = 0;
         };
     }
 }
@@ -0,0 +1,76 @@
+#include "../Format/Frm/File.h"
+#include "../Game/Game.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/Sprite.h"
+#include "../Graphics/Texture.h"
+#include "../Graphics/TextureAtlas.h"
+#include "../Graphics/WorldMapTiles.h"
+#include "../ResourceManager.h"
+#include <algorithm>
+
+namespace Falltergeist {
+    namespace Graphics {
+        // all twenty tiles of the Fallout 2 map fit into a page of this size
+        static const int32_t PAGE_SIZE = 2048;
+
+        WorldMapTiles::WorldMapTiles(const std::vector<std::string>& filenames, unsigned int columns, const Size& tileSize)
+            : _columns(columns), _rows((static_cast<unsigned int>(filenames.size()) + columns - 1) / columns), _tileSize(tileSize) {
+            auto pageSize = std::min(PAGE_SIZE, Game::Game::getInstance()->renderer()->maxTextureSize());
+            _atlas = std::make_unique<TextureAtlas>(static_cast<unsigned int>(pageSize), Pixels::Format::Indexed);
+
+            for (auto& filename : filenames) {
+                auto frm = ResourceManager::getInstance()->frmFileType(filename);
+                if (!frm) {
+                    _tiles.emplace_back();
+                    continue;
+                }
+                // uploaded as stored, the sprite shader looks the colors up in the palette
+                auto indexes = frm->indexes();
+                Pixels pixels(indexes.data(), Size(frm->width(), frm->height()), Pixels::Format::Indexed);
+                std::shared_ptr<Texture> texture = _atlas->allocate(pixels);
+                if (!texture) {
+                    texture = std::make_shared<Texture>(pixels);
+                }
+                _tiles.emplace_back(std::make_unique<Sprite>(texture));
+            }
+        }
+
+        WorldMapTiles::~WorldMapTiles() {
+        }
+
+        Size WorldMapTiles::size() const {
+            return Size(static_cast<int>(_columns) * _tileSize.width(), static_cast<int>(_rows) * _tileSize.height());
+        }
+
+        void WorldMapTiles::render(const Rectangle& view, const Point& offset) {
+            auto mapSize = size();
+            int left = std::max(offset.x(), 0);
+            int top = std::max(offset.y(), 0);
+            int right = std::min(offset.x() + view.size().width(), mapSize.width());
+            int bottom = std::min(offset.y() + view.size().height(), mapSize.height());
+            if (left >= right || top >= bottom) {
+                return;
+            }
+
+            int firstColumn = left / _tileSize.width();
+            int lastColumn = (right - 1) / _tileSize.width();
+            int firstRow = top / _tileSize.height();
+            int lastRow = (bottom - 1) / _tileSize.height();
+            for (int row = firstRow; row <= lastRow; ++row) {
+                for (int column = firstColumn; column <= lastColumn; ++column) {
+                    auto& tile = _tiles.at(static_cast<size_t>(row) * _columns + column);
+                    if (!tile) {
+                        continue;
+                    }
+                    Point tilePosition(column * _tileSize.width(), row * _tileSize.height());
+                    Point topLeft(std::max(left, tilePosition.x()), std::max(top, tilePosition.y()));
+                    Point bottomRight(
+                        std::min(right, tilePosition.x() + _tileSize.width()),
+                        std::min(bottom, tilePosition.y() + _tileSize.height())
+                    );
+                    tile->renderCropped(view.position() + topLeft - offset, Rectangle(topLeft - tilePosition, bottomRight - tilePosition));
+                }
+            }
+        }
+    }
+}
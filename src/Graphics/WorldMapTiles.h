@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../Graphics/Point.h"
+#include "../Graphics/Rectangle.h"
+#include "../Graphics/Size.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Falltergeist {
+    namespace Graphics {
+        class Sprite;
+        class TextureAtlas;
+
+        /**
+         * Tiles of the world map, packed into atlas pages of their own rather than spread over the sprite atlas,
+         * so the visible part of the map usually is drawn with a single call
+         * The visible tiles are found from the view, tiles are cropped to it
+         */
+        class WorldMapTiles final {
+        public:
+            // Tiles row by row, all of the given size
+            WorldMapTiles(const std::vector<std::string>& filenames, unsigned int columns, const Size& tileSize);
+
+            ~WorldMapTiles();
+
+            // Size of the whole world map
+            Size size() const;
+
+            // Draws the part of the world map starting at offset into the view on the screen
+            void render(const Rectangle& view, const Point& offset);
+
+        private:
+            unsigned int _columns;
+
+            unsigned int _rows;
+
+            Size _tileSize;
+
+            std::unique_ptr<TextureAtlas> _atlas;
+
+            // nullptr for tiles which couldn't be loaded
+            std::vector<std::unique_ptr<Sprite>> _tiles;
+        };
+    }
+}
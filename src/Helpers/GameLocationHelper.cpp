@@ -1,15 +1,21 @@
+#include "../Format/Map/File.h"
 #include "../Game/Game.h"
 #include "../Game/Location.h"
+#include "../Game/LocationTemplate.h"
+#include "../Game/SaveFile.h"
 #include "../Helpers/GameLocationHelper.h"
 #include "../PathFinding/Hexagon.h"
 #include "../Logger.h"
 #include "../ResourceManager.h"
 #include "../Settings.h"
+#include "../State/LocationCache.h"
 
 namespace Falltergeist
 {
     namespace Helpers
     {
+        std::map<std::string, std::shared_ptr<const Game::LocationTemplate>> GameLocationHelper::_templates;
+
         GameLocationHelper::GameLocationHelper(std::shared_ptr<ILogger> logger)
         {
             this->logger = std::move(logger);
@@ -29,15 +35,36 @@ namespace Falltergeist
 
         std::shared_ptr<Game::Location> GameLocationHelper::getByName(const std::string& name) const
         {
+            // the map is on screen once, changes made to a new copy would be lost with the kept one
+            Game::Game::getInstance()->locationCache()->forget(name);
+
+            // files the map used last time are decoded while it is parsed
+            ResourceManager::getInstance()->preloadManifest(name);
+
             std::string mapFileName = "maps/" + name + ".map";
             auto mapFile = ResourceManager::getInstance()->mapFileType(mapFileName);
             if (mapFile == nullptr) {
                 return nullptr;
             }
+            // the objects are created from the map right away, their files are decoded in parallel meanwhile
+            ResourceManager::getInstance()->requestMapResources(mapFile);
+
+            // a map file changed on disk is loaded again, the template of the old one is stale
+            auto& locationTemplate = _templates[name];
+            if (!locationTemplate || locationTemplate->mapFile() != mapFile) {
+                locationTemplate = std::make_shared<Game::LocationTemplate>(ResourceManager::getInstance()->pin(mapFile));
+            }
 
             auto location = std::make_shared<Game::Location>(logger);
-            location->loadFromMapFile(mapFile);
+            location->loadFromTemplate(*locationTemplate);
+            // the map looks like the player left it
+            Game::Game::getInstance()->saveFile()->restoreMap(*location);
             return location;
         }
+
+        void GameLocationHelper::clearTemplates()
+        {
+            _templates.clear();
+        }
     }
 }
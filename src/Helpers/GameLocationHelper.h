@@ -1,5 +1,6 @@
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
 #include "../ILogger.h"
@@ -9,6 +10,7 @@ namespace Falltergeist
     namespace Game
     {
         class Location;
+        class LocationTemplate;
     }
     namespace Helpers
     {
@@ -19,8 +21,14 @@ namespace Falltergeist
                 std::shared_ptr<Game::Location> getByName(const std::string& name) const;
                 std::shared_ptr<Game::Location> getInitialLocation() const;
 
+                // Drops the kept templates, maps are derived from their files again
+                static void clearTemplates();
+
             private:
                 std::shared_ptr<ILogger> logger;
+
+                // Every map is derived once, a visit only creates what the player may change
+                static std::map<std::string, std::shared_ptr<const Game::LocationTemplate>> _templates;
         };
     }
 }
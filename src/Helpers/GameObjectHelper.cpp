@@ -134,10 +134,8 @@ namespace Falltergeist
 
             if (object->SID() > 0) {
                 auto msg = ResourceManager::getInstance()->msgFileType("text/english/game/scrname.msg");
-                try {
-                    object->setScrName(msg->message(object->SID() + 101)->text());
-                }
-                catch (const Exception &) {
+                if (auto scrName = msg->tryMessage(object->SID() + 101)) {
+                    object->setScrName(scrName->text());
                 }
             }
             return object;
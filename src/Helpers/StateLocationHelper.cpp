@@ -1,8 +1,10 @@
 #include "../Game/Game.h"
 #include "../Game/Location.h"
+#include "../Game/SaveFile.h"
 #include "../Helpers/GameLocationHelper.h"
 #include "../Helpers/StateLocationHelper.h"
 #include "../State/Location.h"
+#include "../State/LocationCache.h"
 #include "../UI/ResourceManager.h"
 #include "../PathFinding/Hexagon.h"
 
@@ -17,6 +19,10 @@ namespace Falltergeist
 
         State::Location* StateLocationHelper::getInitialLocationState() const
         {
+            // a new game starts from the pristine maps
+            Game::Game::getInstance()->saveFile()->clear();
+            Game::Game::getInstance()->locationCache()->clear();
+
             GameLocationHelper gameLocationHelper(logger);
             auto initialLocation = gameLocationHelper.getInitialLocation();
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Graphics/Point.h"
+#include <string>
 
 namespace Falltergeist {
     namespace Input {
@@ -23,6 +24,10 @@ namespace Falltergeist {
             virtual void setCursorState(CursorState state) = 0;
 
             virtual CursorState cursorState() const = 0;
+
+            // Makes the first frame of the FRM the system cursor, the hotspot is in the game resolution relative to
+            // its top left corner. False if the platform can't show it, the game has to render the cursor then
+            virtual bool setSystemCursor(const std::string& frm, const Graphics::Point& hotspot) = 0;
         };
     }
 }
@@ -70,101 +70,90 @@ namespace Falltergeist
                 return;
             }
             _ui.reset(nullptr);
+            _frm.clear();
             switch (state)
             {
                 case Cursor::BIG_ARROW:
-                    _ui = std::unique_ptr<UI::Image>(_resourceManager->getImage("art/intrface/stdarrow.frm"));
+                    _ui = _image("art/intrface/stdarrow.frm");
                     break;
                 case Cursor::SCROLL_W:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/scrwest.frm"));
+                    _ui = _image("art/intrface/scrwest.frm");
                     _ui->setOffset(Point(0, -_ui->size().height() / 2));
                     break;
                 case Cursor::SCROLL_W_X:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/scrwx.frm"));
+                    _ui = _image("art/intrface/scrwx.frm");
                     _ui->setOffset(Point(0, -_ui->size().height() / 2));
                     break;
                 case Cursor::SCROLL_N:
-                    _ui = std::unique_ptr<UI::Image>(_resourceManager->getImage("art/intrface/scrnorth.frm"));
+                    _ui = _image("art/intrface/scrnorth.frm");
                     _ui->setOffset(Point(-_ui->size().width() / 2, 0));
                     break;
                 case Cursor::SCROLL_N_X:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/scrnx.frm"));
+                    _ui = _image("art/intrface/scrnx.frm");
                     _ui->setOffset(Point(-_ui->size().width() / 2, 0));
                     break;
                 case Cursor::SCROLL_S:
-                    _ui = std::unique_ptr<UI::Image>(_resourceManager->getImage("art/intrface/scrsouth.frm"));
+                    _ui = _image("art/intrface/scrsouth.frm");
                     _ui->setOffset(Point(-_ui->size().width() / 2, -_ui->size().height()));
                     break;
                 case Cursor::SCROLL_S_X:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/scrsx.frm"));
+                    _ui = _image("art/intrface/scrsx.frm");
                     _ui->setOffset(Point(-_ui->size().width() / 2, -_ui->size().height()));
                     break;
                 case Cursor::SCROLL_E:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/screast.frm"));
+                    _ui = _image("art/intrface/screast.frm");
                     _ui->setOffset(Point(-_ui->size().width(), -_ui->size().height() / 2));
                     break;
                 case Cursor::SCROLL_E_X:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/screx.frm"));
+                    _ui = _image("art/intrface/screx.frm");
                     _ui->setOffset(Point(-_ui->size().width(), -_ui->size().height() / 2));
                     break;
                 case Cursor::SCROLL_NW:
-                    _ui = std::unique_ptr<UI::Image>(_resourceManager->getImage("art/intrface/scrnwest.frm"));
+                    _ui = _image("art/intrface/scrnwest.frm");
                     break;
                 case Cursor::SCROLL_NW_X:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/scrnwx.frm"));
+                    _ui = _image("art/intrface/scrnwx.frm");
                     break;
                 case Cursor::SCROLL_SW:
-                    _ui = std::unique_ptr<UI::Image>(_resourceManager->getImage("art/intrface/scrswest.frm"));
+                    _ui = _image("art/intrface/scrswest.frm");
                     _ui->setOffset(Point(0, -_ui->size().height()));
                     break;
                 case Cursor::SCROLL_SW_X:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/scrswx.frm"));
+                    _ui = _image("art/intrface/scrswx.frm");
                     _ui->setOffset(Point(0, -_ui->size().height()));
                     break;
                 case Cursor::SCROLL_NE:
-                    _ui = std::unique_ptr<UI::Image>(_resourceManager->getImage("art/intrface/scrneast.frm"));
+                    _ui = _image("art/intrface/scrneast.frm");
                     _ui->setOffset(Point(-_ui->size().width(), 0));
                     break;
                 case Cursor::SCROLL_NE_X:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/scrnex.frm"));
+                    _ui = _image("art/intrface/scrnex.frm");
                     _ui->setOffset(Point(-_ui->size().width(), 0));
                     break;
                 case Cursor::SCROLL_SE:
-                    _ui = std::unique_ptr<UI::Image>(_resourceManager->getImage("art/intrface/scrseast.frm"));
+                    _ui = _image("art/intrface/scrseast.frm");
                     _ui->setOffset(Point(-_ui->size().width(), -_ui->size().height()));
                     break;
                 case Cursor::SCROLL_SE_X:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/scrsex.frm"));
+                    _ui = _image("art/intrface/scrsex.frm");
                     _ui->setOffset(Point(-_ui->size().width(), -_ui->size().height()));
                     break;
                 case Cursor::HEXAGON_RED:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/msef000.frm"));
+                    _ui = _image("art/intrface/msef000.frm");
                     _ui->setOffset(Point(-_ui->size().width() / 2, - _ui->size().height() / 2));
                     break;
                 case Cursor::ACTION:
-                    _ui = std::unique_ptr<UI::Image>(_resourceManager->getImage("art/intrface/actarrow.frm"));
+                    _ui = _image("art/intrface/actarrow.frm");
                     break;
                 case Cursor::HAND:
-                    _ui = std::unique_ptr<UI::Image>(
-                        _resourceManager->getImage("art/intrface/hand.frm"));
+                    _ui = _image("art/intrface/hand.frm");
                     break;
                 case Cursor::SMALL_DOWN_ARROW:
-                    _ui = std::unique_ptr<UI::Image>(_resourceManager->getImage("art/intrface/sdnarrow.frm"));
+                    _ui = _image("art/intrface/sdnarrow.frm");
                     _ui->setOffset(Point(-5, -10));
                     break;
                 case Cursor::SMALL_UP_ARROW:
-                    _ui = std::unique_ptr<UI::Image>(_resourceManager->getImage("art/intrface/suparrow.frm"));
+                    _ui = _image("art/intrface/suparrow.frm");
                     _ui->setOffset(Point(-5, 0));
                     break;
                 case Cursor::WAIT:
@@ -179,7 +168,7 @@ namespace Falltergeist
                 }
                 case Cursor::USE:
                 {
-                    _ui = std::unique_ptr<UI::Image>(_resourceManager->getImage("art/intrface/crossuse.frm"));
+                    _ui = _image("art/intrface/crossuse.frm");
                     _ui->setOffset(Point(-10, -10));
                     break;
                 }
@@ -188,11 +177,40 @@ namespace Falltergeist
                 default:
                     break;
             }
+            _updateSystemCursor(state);
+        }
+
+        std::unique_ptr<UI::Image> Mouse::_image(const std::string& frm)
+        {
+            _frm = frm;
+            return std::unique_ptr<UI::Image>(_resourceManager->getImage(frm));
+        }
+
+        void Mouse::_updateSystemCursor(Cursor state)
+        {
+            // the hexagon is drawn between the floor and the objects, animations change frames on their own
+            bool system = _hardwareCursor && _ui && !_frm.empty() && state != Cursor::HEXAGON_RED;
+            if (system) {
+                system = _mouse->setSystemCursor(_frm, Point() - _ui->offset());
+            }
+            _systemCursor = system;
+            _mouse->setCursorState(system ? IMouse::CursorState::Shown : IMouse::CursorState::Hidden);
+        }
+
+        void Mouse::setHardwareCursor(bool value)
+        {
+            _hardwareCursor = value;
+            _updateSystemCursor(state());
+        }
+
+        bool Mouse::systemCursor() const
+        {
+            return _systemCursor;
         }
 
         void Mouse::render()
         {
-            if (state() == Cursor::NONE) {
+            if (state() == Cursor::NONE || _systemCursor) {
                 return;
             }
 
@@ -247,9 +265,9 @@ namespace Falltergeist
             return _states;
         }
 
-        void Mouse::renderOutline()
+        void Mouse::renderOutline(int type)
         {
-            if (state() == Cursor::NONE) {
+            if (state() == Cursor::NONE || _systemCursor) {
                 return;
             }
 
@@ -257,7 +275,7 @@ namespace Falltergeist
                 if (state() != Cursor::HEXAGON_RED) {
                     _ui->setPosition(position());
                 }
-                _ui->setOutline(1);
+                _ui->setOutline(type);
                 _ui->render();
                 _ui->setOutline(0);
             }
@@ -5,6 +5,7 @@
 #include "../UI/IResourceManager.h"
 #include "../UI/Image.h"
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace Falltergeist {
@@ -73,7 +74,14 @@ namespace Falltergeist {
 
             void render();
 
-            void renderOutline();
+            // Shows the standard pointers as the system cursor when the platform can, see Settings::hardwareCursor()
+            void setHardwareCursor(bool value);
+
+            // The current cursor is shown by the system and follows the mouse without the game rendering it
+            bool systemCursor() const;
+
+            // Type 0 renders the cursor itself, as a mask for Graphics::OutlinePass
+            void renderOutline(int type = 1);
 
             void think(const float& deltaTime);
 
@@ -89,7 +97,18 @@ namespace Falltergeist {
             // It will wrap mouse for now. Until cursor render and state management refactoring
             std::shared_ptr<IMouse> _mouse;
 
+            // FRM of the current cursor unless it's animated
+            std::string _frm;
+
+            bool _hardwareCursor = false;
+
+            bool _systemCursor = false;
+
             void _setType(Cursor type);
+
+            std::unique_ptr<UI::Image> _image(const std::string& frm);
+
+            void _updateSystemCursor(Cursor state);
         };
     }
 }
@@ -1,5 +1,16 @@
 #include "../Input/SdlMouse.h"
 #include "../Exception.h"
+#include "../Format/Frm/Direction.h"
+#include "../Format/Frm/File.h"
+#include "../Format/Frm/Frame.h"
+#include "../Format/Pal/Color.h"
+#include "../Format/Pal/File.h"
+#include "../Graphics/PaletteExpansion.h"
+#include "../Graphics/Renderer.h"
+#include "../ResourceManager.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 namespace Falltergeist {
     namespace Input {
@@ -7,12 +18,30 @@ namespace Falltergeist {
         }
 
         const Graphics::Point& SdlMouse::position() const {
-            SDL_GetMouseState(&_position.rx(), &_position.ry());
+            if (!_simulated) {
+                SDL_GetMouseState(&_position.rx(), &_position.ry());
+                if (_renderer) {
+                    _position = _renderer->fromWindow(_position);
+                }
+            }
             return _position;
         }
 
         void SdlMouse::setPosition(const Graphics::Point& position) {
-            SDL_WarpMouseInWindow(_sdlWindow->sdlWindowPtr(), position.x(), position.y());
+            if (_simulated) {
+                _position = position;
+                return;
+            }
+            auto windowPosition = _renderer ? _renderer->toWindow(position) : position;
+            SDL_WarpMouseInWindow(_sdlWindow->sdlWindowPtr(), windowPosition.x(), windowPosition.y());
+        }
+
+        void SdlMouse::setRenderer(std::shared_ptr<Graphics::Renderer> renderer) {
+            _renderer = renderer;
+        }
+
+        void SdlMouse::setSimulated(bool simulated) {
+            _simulated = simulated;
         }
 
         void SdlMouse::setCursorState(IMouse::CursorState state) {
@@ -38,5 +67,59 @@ namespace Falltergeist {
 
             return CursorState::Hidden;
         }
+
+        bool SdlMouse::setSystemCursor(const std::string& frm, const Graphics::Point& hotspot) {
+            // the system cursor would follow the real mouse
+            if (_simulated) {
+                return false;
+            }
+
+            auto it = _cursors.find(frm);
+            if (it == _cursors.end()) {
+                auto file = ResourceManager::getInstance()->frmFileType(frm);
+                if (!file || file->directions().empty() || file->directions().front().frames().empty()) {
+                    return false;
+                }
+                const auto& frame = file->directions().front().frames().front();
+
+                auto pal = ResourceManager::getInstance()->palFileType("color.pal");
+                uint32_t palette[256];
+                for (unsigned i = 0; i != 256; ++i) {
+                    palette[i] = *pal->color(i);
+                }
+
+                // nearest neighbour, like the scene is scaled up to the window
+                int scale = _renderer ? std::max(static_cast<int>(std::lround(_renderer->scaleX())), 1) : 1;
+                int width = frame.width() * scale;
+                int height = frame.height() * scale;
+                std::vector<uint32_t> row(frame.width());
+                std::vector<uint32_t> pixels(static_cast<size_t>(width) * height);
+                for (int y = 0; y != frame.height(); ++y) {
+                    Graphics::expandPalette(frame.indexes() + y * frame.width(), row.data(), row.size(), palette);
+                    for (int x = 0; x != width; ++x) {
+                        pixels[static_cast<size_t>(y * scale) * width + x] = row[x / scale];
+                    }
+                    for (int copy = 1; copy != scale; ++copy) {
+                        std::copy_n(&pixels[static_cast<size_t>(y * scale) * width], width, &pixels[static_cast<size_t>(y * scale + copy) * width]);
+                    }
+                }
+
+                // colors are packed as 0xRRGGBBAA
+                auto surface = SDL_CreateRGBSurfaceFrom(pixels.data(), width, height, 32, width * 4, 0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF);
+                if (!surface) {
+                    return false;
+                }
+                int hotX = std::min(std::max(hotspot.x() * scale, 0), width - 1);
+                int hotY = std::min(std::max(hotspot.y() * scale, 0), height - 1);
+                auto cursor = SDL_CreateColorCursor(surface, hotX, hotY);
+                SDL_FreeSurface(surface);
+                if (!cursor) {
+                    return false;
+                }
+                it = _cursors.emplace(frm, std::unique_ptr<SDL_Cursor, decltype(&SDL_FreeCursor)>(cursor, &SDL_FreeCursor)).first;
+            }
+            SDL_SetCursor(it->second.get());
+            return true;
+        }
     }
 }
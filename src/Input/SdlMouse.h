@@ -1,10 +1,15 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include "../Graphics/SdlWindow.h"
 #include "../Input/IMouse.h"
 
 namespace Falltergeist {
+    namespace Graphics {
+        class Renderer;
+    }
     namespace Input {
         class SdlMouse final : public IMouse {
         public:
@@ -20,10 +25,25 @@ namespace Falltergeist {
 
             CursorState cursorState() const override;
 
+            // Cursors are created scaled like the game resolution is and kept until the mouse is destroyed
+            bool setSystemCursor(const std::string& frm, const Graphics::Point& hotspot) override;
+
+            // The position is only what setPosition() was given, replays move the mouse without a real one
+            void setSimulated(bool simulated);
+
+            // Positions are in the game resolution of the renderer, the window may show it scaled
+            void setRenderer(std::shared_ptr<Graphics::Renderer> renderer);
+
         private:
             mutable Graphics::Point _position;
 
+            bool _simulated = false;
+
             std::shared_ptr<Graphics::SdlWindow> _sdlWindow;
+
+            std::shared_ptr<Graphics::Renderer> _renderer;
+
+            std::unordered_map<std::string, std::unique_ptr<SDL_Cursor, decltype(&SDL_FreeCursor)>> _cursors;
         };
     }
 }
@@ -1,8 +1,462 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+#include "Base/RingBuffer.h"
 #include "Logger.h"
 
 namespace Falltergeist
 {
+    namespace
+    {
+        // Bytes of records each thread may queue before it has to wait for the writer
+        const size_t THREAD_BUFFER_SIZE = 64 * 1024;
+
+        // Record size, sequence number and level in front of every queued record
+        const size_t RECORD_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t) + 1;
+
+        // The writer also wakes up by itself, producers only wake it for errors and filling buffers
+        const auto WAKE_INTERVAL = std::chrono::milliseconds(20);
+
+        const char* levelName(Logger::Level level, bool colors)
+        {
+            if (colors)
+            {
+                switch (level)
+                {
+                    case Logger::Level::LOG_DEBUG:
+                        return "[DEBUG]";
+                    case Logger::Level::LOG_INFO:
+                        return "\x1b[32m[INFO]\x1b[0m";
+                    case Logger::Level::LOG_WARNING:
+                        return "\x1b[33m[WARNING]\x1b[0m";
+                    case Logger::Level::LOG_ERROR:
+                        return "\x1b[31m[ERROR]\x1b[0m";
+                    case Logger::Level::LOG_CRITICAL:
+                        return "\x1b[31;1m[CRITICAL]\x1b[0m";
+                    default:
+                        break;
+                }
+            }
+            else
+            {
+                switch (level)
+                {
+                    case Logger::Level::LOG_DEBUG:
+                        return "[DEBUG]";
+                    case Logger::Level::LOG_INFO:
+                        return "[INFO]";
+                    case Logger::Level::LOG_WARNING:
+                        return "[WARNING]";
+                    case Logger::Level::LOG_ERROR:
+                        return "[ERROR]";
+                    case Logger::Level::LOG_CRITICAL:
+                        return "[CRITICAL]";
+                    default:
+                        break;
+                };
+            }
+
+            return "[UNKNOWN]";
+        }
+
+        /**
+         * Writer owns a ring buffer per logging thread and a background thread which moves queued records into the sinks:
+         * standard output and an optional rotated file. Producers never lock, they copy whole records into their own buffer.
+         */
+        class Writer
+        {
+            public:
+                Writer();
+                ~Writer();
+
+                // Queues a record starting with a RECORD_HEADER_SIZE placeholder, which is filled in here
+                void push(Logger::Level level, std::string& record);
+
+                void flush();
+
+                void setFile(const std::string& path, size_t maxSize, unsigned int maxFiles);
+
+                // Set once destroyed at exit, records are written directly then
+                static std::atomic<bool> destroyed;
+
+            private:
+                struct ThreadBuffer
+                {
+                    Base::RingBuffer<char> records{THREAD_BUFFER_SIZE};
+                    // buffers of finished threads are handed to new ones, so there is still a single producer
+                    std::atomic<bool> used{false};
+                };
+
+                std::mutex _buffersMutex;
+                std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+
+                std::mutex _wakeMutex;
+                std::condition_variable _wake;
+                std::atomic<bool> _pending{false};
+                std::atomic<bool> _stop{false};
+
+                // orders records of different threads, the only shared state producers touch
+                std::atomic<uint64_t> _sequence{0};
+
+                struct Record
+                {
+                    uint64_t sequence;
+                    Logger::Level level;
+                    std::string text;
+                };
+
+                // records read from the buffers which may still be preceded by records not yet published
+                std::vector<Record> _records;
+
+                // held while records are drained, so flush() knows a drained record was written as well
+                std::mutex _sinksMutex;
+                std::ofstream _file;
+                std::string _path;
+                size_t _fileSize = 0;
+                size_t _maxSize = 0;
+                unsigned int _maxFiles = 0;
+
+                std::thread _thread;
+
+                ThreadBuffer* _threadBuffer();
+                void _notify();
+                void _run();
+                void _drain();
+                void _rotate();
+
+                friend struct ThreadExit;
+        };
+
+        std::atomic<bool> Writer::destroyed{false};
+
+        Writer& writer()
+        {
+            static Writer instance;
+            return instance;
+        }
+
+        // Collects one record of the calling thread, std::endl (through sync()) hands it to the writer
+        class RecordBuffer : public std::streambuf
+        {
+            public:
+                void begin(Logger::Level level)
+                {
+                    sync();
+                    _level = level;
+                    _record.assign(RECORD_HEADER_SIZE, '\0');
+                }
+
+            protected:
+                int_type overflow(int_type ch) override
+                {
+                    if (!traits_type::eq_int_type(ch, traits_type::eof()))
+                    {
+                        _record.push_back(traits_type::to_char_type(ch));
+                    }
+                    return traits_type::not_eof(ch);
+                }
+
+                std::streamsize xsputn(const char* s, std::streamsize count) override
+                {
+                    _record.append(s, static_cast<size_t>(count));
+                    return count;
+                }
+
+                int sync() override
+                {
+                    if (_record.size() > RECORD_HEADER_SIZE)
+                    {
+                        if (!Writer::destroyed.load(std::memory_order_acquire))
+                        {
+                            writer().push(_level, _record);
+                        }
+                        else
+                        {
+                            std::cout << Logger::levelString(_level);
+                            std::cout.write(_record.data() + RECORD_HEADER_SIZE, _record.size() - RECORD_HEADER_SIZE);
+                            std::cout.flush();
+                        }
+                        // later output without a new log() call still forms a record of the same level
+                        _record.resize(RECORD_HEADER_SIZE);
+                    }
+                    return 0;
+                }
+
+            private:
+                Logger::Level _level = Logger::Level::LOG_INFO;
+                std::string _record;
+        };
+
+        struct ThreadStreams
+        {
+            RecordBuffer buffer;
+            std::ostream stream{&buffer};
+            // A /dev/null-like stream, insertions into a bad stream are not formatted at all
+            std::ostream nullstream{nullptr};
+        };
+
+        // Plain pointers stay valid for the whole life of the thread, unlike thread_local objects with destructors
+        thread_local ThreadStreams* threadStreams = nullptr;
+        thread_local void* threadBuffer = nullptr;
+        thread_local bool threadExiting = false;
+
+        struct ThreadExit
+        {
+            ~ThreadExit()
+            {
+                threadExiting = true;
+                if (threadStreams)
+                {
+                    threadStreams->stream.flush();
+                    delete threadStreams;
+                    threadStreams = nullptr;
+                }
+                if (threadBuffer && !Writer::destroyed.load(std::memory_order_acquire))
+                {
+                    static_cast<Writer::ThreadBuffer*>(threadBuffer)->used.store(false, std::memory_order_release);
+                }
+                threadBuffer = nullptr;
+            }
+        };
+
+        thread_local ThreadExit threadExit;
+
+        ThreadStreams& streams()
+        {
+            if (!threadStreams)
+            {
+                // streams created while the thread exits are left to the OS
+                threadStreams = new ThreadStreams();
+                if (!threadExiting)
+                {
+                    (void)&threadExit;
+                }
+            }
+            return *threadStreams;
+        }
+
+        Writer::Writer()
+        {
+            _thread = std::thread(&Writer::_run, this);
+        }
+
+        Writer::~Writer()
+        {
+            _stop.store(true);
+            _notify();
+            _thread.join();
+            destroyed.store(true, std::memory_order_release);
+        }
+
+        Writer::ThreadBuffer* Writer::_threadBuffer()
+        {
+            if (threadBuffer)
+            {
+                return static_cast<ThreadBuffer*>(threadBuffer);
+            }
+
+            std::lock_guard<std::mutex> lock(_buffersMutex);
+            for (auto& buffer : _buffers)
+            {
+                bool used = false;
+                if (buffer->used.compare_exchange_strong(used, true, std::memory_order_acquire))
+                {
+                    threadBuffer = buffer.get();
+                    return buffer.get();
+                }
+            }
+            _buffers.push_back(std::make_unique<ThreadBuffer>());
+            _buffers.back()->used.store(true, std::memory_order_relaxed);
+            threadBuffer = _buffers.back().get();
+            return _buffers.back().get();
+        }
+
+        void Writer::push(Logger::Level level, std::string& record)
+        {
+            auto buffer = _threadBuffer();
+
+            // a record never spans the buffer twice, overlong ones are cut
+            record.resize(std::min(record.size(), buffer->records.capacity()));
+            uint32_t size = static_cast<uint32_t>(record.size() - RECORD_HEADER_SIZE);
+            uint64_t sequence = _sequence.fetch_add(1);
+            std::memcpy(&record[0], &size, sizeof(size));
+            std::memcpy(&record[sizeof(size)], &sequence, sizeof(sequence));
+            record[sizeof(size) + sizeof(sequence)] = static_cast<char>(level);
+
+            while (buffer->records.space() < record.size())
+            {
+                _notify();
+                std::this_thread::yield();
+            }
+            // a single write publishes the whole record at once
+            buffer->records.write(record.data(), record.size());
+
+            if (level >= Logger::Level::LOG_ERROR || buffer->records.size() > buffer->records.capacity() / 2)
+            {
+                _notify();
+            }
+            if (level >= Logger::Level::LOG_CRITICAL)
+            {
+                // the process is likely about to end
+                flush();
+            }
+        }
+
+        void Writer::flush()
+        {
+            if (!threadBuffer)
+            {
+                return;
+            }
+            auto buffer = static_cast<ThreadBuffer*>(threadBuffer);
+            while (buffer->records.size() != 0)
+            {
+                _notify();
+                std::this_thread::yield();
+            }
+            std::lock_guard<std::mutex> lock(_sinksMutex);
+        }
+
+        void Writer::setFile(const std::string& path, size_t maxSize, unsigned int maxFiles)
+        {
+            std::lock_guard<std::mutex> lock(_sinksMutex);
+            _file.close();
+            _path = path;
+            _maxSize = maxSize;
+            _maxFiles = maxFiles;
+            _fileSize = 0;
+            if (_path.empty())
+            {
+                return;
+            }
+
+            std::error_code error;
+            auto size = std::filesystem::file_size(_path, error);
+            _fileSize = error ? 0 : static_cast<size_t>(size);
+            _file.open(_path, std::ios::out | std::ios::app | std::ios::binary);
+        }
+
+        void Writer::_notify()
+        {
+            _pending.store(true, std::memory_order_release);
+            _wake.notify_one();
+        }
+
+        void Writer::_run()
+        {
+            while (!_stop.load())
+            {
+                {
+                    std::unique_lock<std::mutex> lock(_wakeMutex);
+                    _wake.wait_for(lock, WAKE_INTERVAL, [this]() {
+                        return _pending.load(std::memory_order_acquire) || _stop.load();
+                    });
+                    _pending.store(false, std::memory_order_relaxed);
+                }
+                _drain();
+            }
+            _drain();
+        }
+
+        void Writer::_drain()
+        {
+            std::lock_guard<std::mutex> sinksLock(_sinksMutex);
+
+            // records numbered before this point were published by now if their logging finished before ours started,
+            // so writing only those keeps the order of records which depend on each other
+            uint64_t limit = _sequence.load();
+            {
+                std::lock_guard<std::mutex> buffersLock(_buffersMutex);
+                for (auto& buffer : _buffers)
+                {
+                    // records are published whole, a visible header means the text is there as well
+                    while (buffer->records.size() >= RECORD_HEADER_SIZE)
+                    {
+                        char header[RECORD_HEADER_SIZE];
+                        buffer->records.read(header, RECORD_HEADER_SIZE);
+                        uint32_t size;
+                        Record record;
+                        std::memcpy(&size, header, sizeof(size));
+                        std::memcpy(&record.sequence, header + sizeof(size), sizeof(record.sequence));
+                        record.level = static_cast<Logger::Level>(header[sizeof(size) + sizeof(record.sequence)]);
+                        record.text.resize(size);
+                        buffer->records.read(&record.text[0], size);
+                        if (record.text.back() != '\n')
+                        {
+                            record.text.push_back('\n');
+                        }
+                        _records.push_back(std::move(record));
+                    }
+                }
+            }
+            if (_stop.load())
+            {
+                limit = _sequence.load();
+            }
+
+            std::sort(_records.begin(), _records.end(), [](const Record& lhs, const Record& rhs) {
+                return lhs.sequence < rhs.sequence;
+            });
+            auto end = std::find_if(_records.begin(), _records.end(), [limit](const Record& record) {
+                return record.sequence >= limit;
+            });
+            if (end == _records.begin())
+            {
+                return;
+            }
+
+            for (auto it = _records.begin(); it != end; ++it)
+            {
+                std::cout << Logger::levelString(it->level) << it->text;
+
+                if (_file.is_open())
+                {
+                    const char* name = levelName(it->level, false);
+                    _file << name << it->text;
+                    _fileSize += std::strlen(name) + it->text.size();
+                    if (_maxSize && _fileSize >= _maxSize)
+                    {
+                        _rotate();
+                    }
+                }
+            }
+            _records.erase(_records.begin(), end);
+
+            std::cout.flush();
+            _file.flush();
+        }
+
+        void Writer::_rotate()
+        {
+            _file.close();
+
+            // file.<maxFiles> is dropped, every other file moves one number up
+            std::error_code error;
+            if (_maxFiles > 0)
+            {
+                std::filesystem::remove(_path + "." + std::to_string(_maxFiles), error);
+                for (unsigned int i = _maxFiles - 1; i > 0; --i)
+                {
+                    std::filesystem::rename(_path + "." + std::to_string(i), _path + "." + std::to_string(i + 1), error);
+                }
+                std::filesystem::rename(_path, _path + ".1", error);
+            }
+
+            _file.open(_path, std::ios::out | std::ios::trunc | std::ios::binary);
+            _fileSize = 0;
+        }
+    }
+
     Logger::Logger(const std::string& channel) : _channel(channel) {
     }
 
@@ -16,24 +470,38 @@ namespace Falltergeist
         _level = level;
     }
 
-    std::ostream &Logger::log(Logger::Level level, const std::string &subsystem)
+    std::ostream &Logger::log(Logger::Level level, std::string_view subsystem)
     {
-        // A /dev/null-like stream
-        static std::ostream nullstream(nullptr);
-        if (level < _level) {
-            return nullstream;
+        auto& current = streams();
+        if (!enabled(level)) {
+            return current.nullstream;
         }
-        std::string subsystemMsg = " ";
+
+        current.buffer.begin(level);
+        auto& stream = current.stream;
+        stream.clear();
         if (subsystem.size() > 0) {
-            subsystemMsg = " [" + subsystem + "] ";
+            stream << " [" << subsystem << "] ";
+        } else {
+            stream << " ";
         }
+        return stream << std::dec;
+    }
 
-        return std::cout << levelString(level) << subsystemMsg << std::dec;
+    void Logger::setFile(const std::string& path, size_t maxSize, unsigned int maxFiles)
+    {
+        writer().setFile(path, maxSize, maxFiles);
+    }
+
+    void Logger::flush()
+    {
+        streams().stream.flush();
+        writer().flush();
     }
 
     // Initial level; overridden with config option with default level LOG_INFO
-    Logger::Level Logger::_level = Logger::Level::LOG_DEBUG;
-    bool Logger::_useColors = true;
+    std::atomic<Logger::Level> Logger::_level{Logger::Level::LOG_DEBUG};
+    std::atomic<bool> Logger::_useColors{true};
 
 #if defined(__unix__) || defined(__APPLE__)
     const bool Logger::colorsSupported = true;
@@ -43,67 +511,30 @@ namespace Falltergeist
 
     const char *Logger::levelString(Logger::Level level)
     {
-        if (_useColors && colorsSupported)
-        {
-            switch (level)
-            {
-                case Logger::Level::LOG_DEBUG:
-                    return "[DEBUG]";
-                case Logger::Level::LOG_INFO:
-                    return "\x1b[32m[INFO]\x1b[0m";
-                case Logger::Level::LOG_WARNING:
-                    return "\x1b[33m[WARNING]\x1b[0m";
-                case Logger::Level::LOG_ERROR:
-                    return "\x1b[31m[ERROR]\x1b[0m";
-                case Logger::Level::LOG_CRITICAL:
-                    return "\x1b[31;1m[CRITICAL]\x1b[0m";
-                default:
-                    break;
-            }
-        }
-        else
-        {
-            switch (level)
-            {
-                case Logger::Level::LOG_DEBUG:
-                    return "[DEBUG]";
-                case Logger::Level::LOG_INFO:
-                    return "[INFO]";
-                case Logger::Level::LOG_WARNING:
-                    return "[WARNING]";
-                case Logger::Level::LOG_ERROR:
-                    return "[ERROR]";
-                case Logger::Level::LOG_CRITICAL:
-                    return "[CRITICAL]";
-                default:
-                    break;
-            };
-        }
-
-        return "[UNKNOWN]";
+        return levelName(level, _useColors && colorsSupported);
     }
 
-    std::ostream &Logger::debug(const std::string &subsystem)
+    std::ostream &Logger::debug(std::string_view subsystem)
     {
         return log(Logger::Level::LOG_DEBUG, subsystem);
     }
 
-    std::ostream &Logger::info(const std::string &subsystem)
+    std::ostream &Logger::info(std::string_view subsystem)
     {
         return log(Logger::Level::LOG_INFO, subsystem);
     }
 
-    std::ostream &Logger::warning(const std::string &subsystem)
+    std::ostream &Logger::warning(std::string_view subsystem)
     {
         return log(Logger::Level::LOG_WARNING, subsystem);
     }
 
-    std::ostream &Logger::error(const std::string &subsystem)
+    std::ostream &Logger::error(std::string_view subsystem)
     {
         return log(Logger::Level::LOG_ERROR, subsystem);
     }
 
-    std::ostream &Logger::critical(const std::string &subsystem)
+    std::ostream &Logger::critical(std::string_view subsystem)
     {
         return log(Logger::Level::LOG_CRITICAL, subsystem);
     }
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <iosfwd>
 #include <iostream>
+#include <string_view>
 #include "Graphics/Point.h"
 #include "Graphics/Size.h"
 #include "ILogger.h"
@@ -32,15 +35,30 @@ namespace Falltergeist
             static void setLevel(const std::string &level);
             static const char *levelString(Level level);
 
+            // Cheap check for call sites which have to compute what they log
+            static bool enabled(Level level)
+            {
+                return level >= _level.load(std::memory_order_relaxed);
+            }
+
             static const bool colorsSupported;
             static void useColors(bool useColors);
 
-            static std::ostream &log(Level level, const std::string &subsystem = "");
-            static std::ostream &debug(const std::string &subsystem = "");
-            static std::ostream &info(const std::string &subsystem = "");
-            static std::ostream &warning(const std::string &subsystem = "");
-            static std::ostream &error(const std::string &subsystem = "");
-            static std::ostream &critical(const std::string &subsystem = "");
+            // Also writes records into the given file, which is rotated into file.1 ... file.<maxFiles> when it grows over maxSize bytes
+            // An empty path closes the file
+            static void setFile(const std::string& path, size_t maxSize, unsigned int maxFiles);
+
+            // Blocks until everything logged by the calling thread is written
+            static void flush();
+
+            // Records are formatted on the calling thread and written by a background thread,
+            // std::endl (or std::flush) ends a record and queues it without waiting for the output
+            static std::ostream &log(Level level, std::string_view subsystem = {});
+            static std::ostream &debug(std::string_view subsystem = {});
+            static std::ostream &info(std::string_view subsystem = {});
+            static std::ostream &warning(std::string_view subsystem = {});
+            static std::ostream &error(std::string_view subsystem = {});
+            static std::ostream &critical(std::string_view subsystem = {});
 
             std::ostream& debug() override;
             std::ostream& info() override;
@@ -49,8 +67,8 @@ namespace Falltergeist
             std::ostream& critical() override;
 
         private:
-            static Level _level;
-            static bool _useColors;
+            static std::atomic<Level> _level;
+            static std::atomic<bool> _useColors;
             std::string _channel;
     };
 
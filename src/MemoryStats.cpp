@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include "MemoryStats.h"
+#include "Graphics/TextureResidency.h"
+#include "ResourceManager.h"
+
+namespace Falltergeist
+{
+    std::atomic<size_t> MemoryStats::_bytes[MemoryStats::CATEGORIES] = {};
+    std::atomic<size_t> MemoryStats::_counts[MemoryStats::CATEGORIES] = {};
+
+    namespace
+    {
+        const auto started = std::chrono::steady_clock::now();
+    }
+
+    const char* MemoryStats::categoryName(Category category)
+    {
+        switch (category)
+        {
+            case Category::TEXTURES:
+                return "textures";
+            case Category::OBJECTS:
+                return "objects";
+            case Category::SCRIPTS:
+                return "scripts";
+            case Category::SOUNDS:
+                return "sounds";
+        }
+        return "";
+    }
+
+    std::vector<MemoryStats::Usage> MemoryStats::usage()
+    {
+        std::vector<Usage> result;
+        for (unsigned int i = 0; i != CATEGORIES; ++i)
+        {
+            result.push_back({categoryName(static_cast<Category>(i)), _bytes[i].load(std::memory_order_relaxed), _counts[i].load(std::memory_order_relaxed)});
+        }
+
+        auto cache = ResourceManager::getInstance()->cacheUsage();
+        std::sort(cache.begin(), cache.end(), [](const Usage& lhs, const Usage& rhs) {
+            return lhs.bytes > rhs.bytes;
+        });
+        result.insert(result.end(), cache.begin(), cache.end());
+
+        // file textures kept in memory only, not a part of the textures category
+        if (auto residency = Graphics::TextureResidency::current())
+        {
+            result.push_back({"evicted textures", residency->evictedBytes(), residency->evictedTextures()});
+        }
+        return result;
+    }
+
+    bool MemoryStats::write(const std::string& filename)
+    {
+        bool created = !std::ifstream(filename).good();
+        std::ofstream stream(filename, std::ios::app);
+        if (!stream)
+        {
+            return false;
+        }
+        if (created)
+        {
+            stream << "seconds,name,bytes,count\n";
+        }
+
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - started).count();
+        for (auto& entry : usage())
+        {
+            stream << seconds << "," << entry.name << "," << entry.bytes << "," << entry.count << "\n";
+        }
+        return static_cast<bool>(stream);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Falltergeist
+{
+    /**
+     * MemoryStats attributes memory to the subsystems holding it. Subsystems which know the size of what they
+     * allocate count it into a category, a relaxed atomic add per allocation, and the resource cache reports its
+     * items by file type. Only the overlay and the dumps are opt-in, the counters have to see everything from the start.
+     */
+    class MemoryStats final
+    {
+        public:
+            enum class Category
+            {
+                // GL textures, atlas pages included, images placed into them not
+                TEXTURES = 0,
+                // Game::Object and subclasses
+                OBJECTS,
+                // VM::Script instances, their INT files are part of the resource cache
+                SCRIPTS,
+                // decoded sound effects of the mixer
+                SOUNDS
+            };
+
+            static const unsigned int CATEGORIES = 4;
+
+            struct Usage
+            {
+                std::string name;
+                size_t bytes;
+                size_t count;
+            };
+
+            static void add(Category category, size_t bytes)
+            {
+                auto index = static_cast<unsigned int>(category);
+                _bytes[index].fetch_add(bytes, std::memory_order_relaxed);
+                _counts[index].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            static void remove(Category category, size_t bytes)
+            {
+                auto index = static_cast<unsigned int>(category);
+                _bytes[index].fetch_sub(bytes, std::memory_order_relaxed);
+                _counts[index].fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            static const char* categoryName(Category category);
+
+            // The categories followed by the cached resources by file type, largest first. Main thread only
+            static std::vector<Usage> usage();
+
+            // Appends the current usage as rows of seconds since start, name, bytes and count,
+            // writing the header into new files. Returns false if the file cannot be written
+            static bool write(const std::string& filename);
+
+        private:
+            static std::atomic<size_t> _bytes[CATEGORIES];
+            static std::atomic<size_t> _counts[CATEGORIES];
+    };
+}
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "Metrics.h"
+
+namespace Falltergeist
+{
+    std::atomic<bool> Metrics::_enabled{false};
+
+    namespace
+    {
+        const auto started = std::chrono::steady_clock::now();
+
+        // upper bound of the first bucket, the last one takes everything above its lower bound
+        const double FIRST_BUCKET = 0.25;
+
+        struct Registry
+        {
+            std::mutex mutex;
+            // ordered by name, so the rows of a metric family are written next to each other
+            std::map<std::string, std::unique_ptr<Metrics::Counter>> counters;
+            std::map<std::string, std::unique_ptr<Metrics::Gauge>> gauges;
+            std::map<std::string, std::unique_ptr<Metrics::Histogram>> histograms;
+        };
+
+        // constructed on first use, metrics are registered from the static initializers of other files as well
+        Registry& registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        template<class T>
+        T& find(std::map<std::string, std::unique_ptr<T>>& metrics, const std::string& name)
+        {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            auto& metric = metrics[name];
+            if (!metric)
+            {
+                metric = std::make_unique<T>();
+            }
+            return *metric;
+        }
+    }
+
+    void Metrics::Histogram::record(double milliseconds)
+    {
+        unsigned int bucket = 0;
+        double bound = FIRST_BUCKET;
+        while (milliseconds > bound && bucket + 1 != BUCKETS)
+        {
+            bound *= 2;
+            bucket++;
+        }
+        _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(static_cast<uint64_t>(std::max(0.0, milliseconds) * 1000.0), std::memory_order_relaxed);
+    }
+
+    double Metrics::Histogram::percentile(double fraction) const
+    {
+        uint64_t total = count();
+        if (total == 0)
+        {
+            return 0.0;
+        }
+        auto rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(total)));
+        uint64_t seen = 0;
+        double bound = FIRST_BUCKET;
+        for (unsigned int i = 0; i != BUCKETS; ++i, bound *= 2)
+        {
+            seen += _buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+            {
+                return bound;
+            }
+        }
+        return bound / 2;
+    }
+
+    void Metrics::setEnabled(bool enabled)
+    {
+        _enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    Metrics::Counter& Metrics::counter(const std::string& name)
+    {
+        return find(registry().counters, name);
+    }
+
+    Metrics::Gauge& Metrics::gauge(const std::string& name)
+    {
+        return find(registry().gauges, name);
+    }
+
+    Metrics::Histogram& Metrics::histogram(const std::string& name)
+    {
+        return find(registry().histograms, name);
+    }
+
+    bool Metrics::write(const std::string& filename)
+    {
+        bool created = !std::ifstream(filename).good();
+        std::ofstream stream(filename, std::ios::app);
+        if (!stream)
+        {
+            return false;
+        }
+        if (created)
+        {
+            stream << "seconds,name,type,value,count,p50,p90,p99\n";
+        }
+
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - started).count();
+        auto& metrics = registry();
+        std::lock_guard<std::mutex> lock(metrics.mutex);
+        for (auto& entry : metrics.counters)
+        {
+            stream << seconds << "," << entry.first << ",counter," << entry.second->value() << ",,,,\n";
+        }
+        for (auto& entry : metrics.gauges)
+        {
+            stream << seconds << "," << entry.first << ",gauge," << entry.second->value() << ",,,,\n";
+        }
+        for (auto& entry : metrics.histograms)
+        {
+            auto& histogram = *entry.second;
+            stream << seconds << "," << entry.first << ",histogram," << histogram.sum() << "," << histogram.count() << ","
+                   << histogram.percentile(0.5) << "," << histogram.percentile(0.9) << "," << histogram.percentile(0.99) << "\n";
+        }
+        return static_cast<bool>(stream);
+    }
+}
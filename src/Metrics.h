@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Falltergeist
+{
+    /**
+     * Metrics is a registry of named counters, gauges and histograms aggregated over a whole session, appended to a
+     * CSV file every now and then so the cache budgets can be tuned from what real sessions do. Registered metrics
+     * live until exit, so the references can be kept in function-local statics. Updates are relaxed atomics, the
+     * code feeding them checks enabled() first and costs a single check when telemetry is off.
+     */
+    class Metrics final
+    {
+        public:
+            // Total since start, hit rates are hits / (hits + misses) of the pair
+            class Counter
+            {
+                public:
+                    void add(uint64_t value = 1)
+                    {
+                        _value.fetch_add(value, std::memory_order_relaxed);
+                    }
+
+                    uint64_t value() const
+                    {
+                        return _value.load(std::memory_order_relaxed);
+                    }
+
+                private:
+                    std::atomic<uint64_t> _value{0};
+            };
+
+            // Last value set
+            class Gauge
+            {
+                public:
+                    void set(double value)
+                    {
+                        _value.store(value, std::memory_order_relaxed);
+                    }
+
+                    double value() const
+                    {
+                        return _value.load(std::memory_order_relaxed);
+                    }
+
+                private:
+                    std::atomic<double> _value{0.0};
+            };
+
+            // Milliseconds counted into buckets doubling from 1/4 ms, percentiles are the upper bound of their bucket
+            class Histogram
+            {
+                public:
+                    static const unsigned int BUCKETS = 20;
+
+                    void record(double milliseconds);
+
+                    uint64_t count() const
+                    {
+                        return _count.load(std::memory_order_relaxed);
+                    }
+
+                    double sum() const
+                    {
+                        return static_cast<double>(_sum.load(std::memory_order_relaxed)) / 1000.0;
+                    }
+
+                    double percentile(double fraction) const;
+
+                private:
+                    std::atomic<uint64_t> _buckets[BUCKETS] = {};
+                    std::atomic<uint64_t> _count{0};
+                    // microseconds, atomic adds of doubles would need a CAS loop
+                    std::atomic<uint64_t> _sum{0};
+            };
+
+            static bool enabled()
+            {
+                return _enabled.load(std::memory_order_relaxed);
+            }
+
+            static void setEnabled(bool enabled);
+
+            // The metric of that name, registered on first use. Safe from any thread, the lookup takes a lock
+            static Counter& counter(const std::string& name);
+
+            static Gauge& gauge(const std::string& name);
+
+            static Histogram& histogram(const std::string& name);
+
+            // Appends every metric as rows of seconds since start, name, type, value, count and the p50, p90
+            // and p99 of histograms, writing the header into new files. Returns false if the file cannot be written
+            static bool write(const std::string& filename);
+
+        private:
+            static std::atomic<bool> _enabled;
+    };
+}
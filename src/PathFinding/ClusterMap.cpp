@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+#include "../PathFinding/ClusterMap.h"
+#include "../PathFinding/Hexagon.h"
+#include "../PathFinding/HexagonGrid.h"
+#include "../PathFinding/SearchContext.h"
+
+namespace Falltergeist
+{
+    namespace
+    {
+        // Clusters are CLUSTER_SIZE x CLUSTER_SIZE hexagons of the grid, the last ones of a row or column may be smaller
+        const unsigned int CLUSTER_SIZE = 10;
+        const unsigned int UNREACHABLE = std::numeric_limits<unsigned int>::max();
+    }
+
+    ClusterMap::ClusterMap(HexagonGrid* grid) : _grid(grid)
+    {
+        _width = grid->region().width;
+        _height = grid->region().height;
+        _clustersX = (_width + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+        _clustersY = (_height + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+        _clusters.resize(_clustersX * _clustersY);
+    }
+
+    void ClusterMap::invalidate(Hexagon* hexagon)
+    {
+        // portal pairs reach into the neighbour clusters
+        _clusters[_clusterOf(hexagon->index())].dirty = true;
+        for (auto neighbor : hexagon->neighbors())
+        {
+            if (neighbor) {
+                _clusters[_clusterOf(neighbor->index())].dirty = true;
+            }
+        }
+        _dirty = true;
+    }
+
+    bool ClusterMap::findPath(Hexagon* from, Hexagon* to, std::vector<Hexagon*>& path)
+    {
+        path.clear();
+        if (!_grid->canWalkThru(to)) {
+            return false;
+        }
+        _rebuild();
+
+        const unsigned int fromIndex = from->index();
+        const unsigned int toIndex = to->index();
+        const unsigned int fromCluster = _clusterOf(fromIndex);
+        const unsigned int toCluster = _clusterOf(toIndex);
+
+        // entering and leaving the abstract graph, the start itself is occupied by whoever walks
+        std::vector<unsigned int> fromCosts, toCosts, parents;
+        _flood(fromCluster, from, fromCosts, parents);
+        _flood(toCluster, to, toCosts, parents);
+
+        auto& context = SearchContext::current();
+        context.reset(_grid->size());
+        context.reach(fromIndex, fromIndex, 0);
+        context.push(_grid->distance(from, to), fromIndex);
+
+        bool found = false;
+        unsigned int fCost;
+        unsigned int index;
+        while (context.pop(fCost, index))
+        {
+            const unsigned int cost = context.cost(index);
+            // stale entry, the node was queued again with a lower cost
+            if (fCost != cost + _grid->distance(_grid->atIndex(index), to)) {
+                continue;
+            }
+            if (index == toIndex) {
+                found = true;
+                break;
+            }
+
+            auto relax = [&](unsigned int next, unsigned int edge)
+            {
+                const unsigned int newCost = cost + edge;
+                if (context.reached(next) && context.cost(next) <= newCost) {
+                    return;
+                }
+                context.reach(next, index, newCost);
+                context.push(newCost + _grid->distance(_grid->atIndex(next), to), next);
+            };
+
+            const unsigned int clusterIndex = _clusterOf(index);
+            const Cluster& cluster = _clusters[clusterIndex];
+            if (index == fromIndex) {
+                for (auto portal : cluster.portals)
+                {
+                    if (fromCosts[_local(portal)] != UNREACHABLE) {
+                        relax(portal, fromCosts[_local(portal)]);
+                    }
+                }
+                if (fromCluster == toCluster && fromCosts[_local(toIndex)] != UNREACHABLE) {
+                    relax(toIndex, fromCosts[_local(toIndex)]);
+                }
+            } else {
+                auto portal = std::lower_bound(cluster.portals.begin(), cluster.portals.end(), index);
+                if (portal != cluster.portals.end() && *portal == index) {
+                    const size_t portals = cluster.portals.size();
+                    const size_t row = static_cast<size_t>(portal - cluster.portals.begin()) * portals;
+                    for (size_t i = 0; i != portals; ++i)
+                    {
+                        if (cluster.costs[row + i] != UNREACHABLE && cluster.portals[i] != index) {
+                            relax(cluster.portals[i], cluster.costs[row + i]);
+                        }
+                    }
+                }
+                if (clusterIndex == toCluster && toCosts[_local(index)] != UNREACHABLE) {
+                    relax(toIndex, toCosts[_local(index)]);
+                }
+            }
+            for (auto& crossing : cluster.crossings)
+            {
+                if (crossing.first == index) {
+                    relax(crossing.second, 1);
+                }
+            }
+        }
+
+        if (!found) {
+            return false;
+        }
+
+        // refine the abstract route backwards, so the path comes out destination first
+        std::vector<unsigned int> costs;
+        for (index = toIndex; index != fromIndex; index = context.cameFrom(index))
+        {
+            const unsigned int previous = context.cameFrom(index);
+            const unsigned int cluster = _clusterOf(previous);
+            if (cluster != _clusterOf(index)) {
+                // portal pair, the hexagons are adjacent
+                path.push_back(_grid->atIndex(index));
+                continue;
+            }
+            _flood(cluster, _grid->atIndex(previous), costs, parents);
+            for (unsigned int step = index; step != previous; step = parents[_local(step)])
+            {
+                path.push_back(_grid->atIndex(step));
+            }
+        }
+        return true;
+    }
+
+    unsigned int ClusterMap::_clusterOf(unsigned int index) const
+    {
+        return (index / _width / CLUSTER_SIZE) * _clustersX + (index % _width) / CLUSTER_SIZE;
+    }
+
+    unsigned int ClusterMap::_local(unsigned int index) const
+    {
+        return (index / _width % CLUSTER_SIZE) * CLUSTER_SIZE + index % _width % CLUSTER_SIZE;
+    }
+
+    void ClusterMap::_flood(unsigned int cluster, Hexagon* start, std::vector<unsigned int>& costs, std::vector<unsigned int>& parents) const
+    {
+        costs.assign(CLUSTER_SIZE * CLUSTER_SIZE, UNREACHABLE);
+        parents.assign(CLUSTER_SIZE * CLUSTER_SIZE, start->index());
+
+        std::array<Hexagon*, CLUSTER_SIZE * CLUSTER_SIZE> queue;
+        size_t tail = 0;
+        costs[_local(start->index())] = 0;
+        queue[tail++] = start;
+        for (size_t head = 0; head != tail; ++head)
+        {
+            Hexagon* current = queue[head];
+            const unsigned int cost = costs[_local(current->index())] + 1;
+            for (auto neighbor : current->neighbors())
+            {
+                if (!neighbor || _clusterOf(neighbor->index()) != cluster || !_grid->canWalkThru(neighbor)) {
+                    continue;
+                }
+                const unsigned int local = _local(neighbor->index());
+                if (costs[local] != UNREACHABLE) {
+                    continue;
+                }
+                costs[local] = cost;
+                parents[local] = current->index();
+                queue[tail++] = neighbor;
+            }
+        }
+    }
+
+    void ClusterMap::_rebuild()
+    {
+        if (!_dirty) {
+            return;
+        }
+
+        std::vector<bool> touched(_clusters.size(), false);
+        for (unsigned int cluster = 0; cluster != _clusters.size(); ++cluster)
+        {
+            if (!_clusters[cluster].dirty) {
+                continue;
+            }
+            touched[cluster] = true;
+
+            const int x = cluster % _clustersX;
+            const int y = cluster / _clustersX;
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    if ((dx == 0 && dy == 0) || x + dx < 0 || y + dy < 0 || x + dx >= (int)_clustersX || y + dy >= (int)_clustersY) {
+                        continue;
+                    }
+                    const unsigned int neighbour = (y + dy) * _clustersX + (x + dx);
+                    // borders between two dirty clusters are linked once
+                    if (!_clusters[neighbour].dirty || cluster < neighbour) {
+                        _link(cluster, neighbour);
+                    }
+                    touched[neighbour] = true;
+                }
+            }
+        }
+
+        for (unsigned int cluster = 0; cluster != _clusters.size(); ++cluster)
+        {
+            if (touched[cluster]) {
+                _connect(cluster);
+            }
+            _clusters[cluster].dirty = false;
+        }
+        _dirty = false;
+    }
+
+    void ClusterMap::_link(unsigned int cluster, unsigned int neighbour)
+    {
+        auto& first = _clusters[cluster].crossings;
+        auto& second = _clusters[neighbour].crossings;
+        first.erase(std::remove_if(first.begin(), first.end(), [&](const std::pair<unsigned int, unsigned int>& crossing) {
+            return _clusterOf(crossing.second) == neighbour;
+        }), first.end());
+        second.erase(std::remove_if(second.begin(), second.end(), [&](const std::pair<unsigned int, unsigned int>& crossing) {
+            return _clusterOf(crossing.second) == cluster;
+        }), second.end());
+
+        // walkable pairs along the border are grouped into runs of adjacent hexagons, the middle of a run becomes the portal pair
+        std::vector<std::pair<unsigned int, unsigned int>> run;
+        auto close = [&]()
+        {
+            if (!run.empty()) {
+                auto middle = run[run.size() / 2];
+                first.push_back(middle);
+                second.push_back({middle.second, middle.first});
+                run.clear();
+            }
+        };
+
+        const unsigned int left = cluster % _clustersX * CLUSTER_SIZE;
+        const unsigned int top = cluster / _clustersX * CLUSTER_SIZE;
+        const unsigned int right = std::min(left + CLUSTER_SIZE, _width);
+        const unsigned int bottom = std::min(top + CLUSTER_SIZE, _height);
+        for (unsigned int y = top; y != bottom; ++y)
+        {
+            for (unsigned int x = left; x != right; ++x)
+            {
+                Hexagon* hexagon = _grid->atIndex(y * _width + x);
+                if (!_grid->canWalkThru(hexagon)) {
+                    continue;
+                }
+                for (auto neighbor : hexagon->neighbors())
+                {
+                    if (!neighbor || _clusterOf(neighbor->index()) != neighbour || !_grid->canWalkThru(neighbor)) {
+                        continue;
+                    }
+                    if (!run.empty() && run.back().first != hexagon->index()) {
+                        const auto adjacent = _grid->atIndex(run.back().first)->neighbors();
+                        if (std::find(adjacent.begin(), adjacent.end(), hexagon) == adjacent.end()) {
+                            close();
+                        }
+                    }
+                    run.push_back({hexagon->index(), neighbor->index()});
+                }
+            }
+        }
+        close();
+    }
+
+    void ClusterMap::_connect(unsigned int cluster)
+    {
+        auto& target = _clusters[cluster];
+        target.portals.clear();
+        for (auto& crossing : target.crossings)
+        {
+            target.portals.push_back(crossing.first);
+        }
+        std::sort(target.portals.begin(), target.portals.end());
+        target.portals.erase(std::unique(target.portals.begin(), target.portals.end()), target.portals.end());
+
+        const size_t portals = target.portals.size();
+        target.costs.assign(portals * portals, UNREACHABLE);
+        std::vector<unsigned int> costs, parents;
+        for (size_t i = 0; i != portals; ++i)
+        {
+            _flood(cluster, _grid->atIndex(target.portals[i]), costs, parents);
+            for (size_t j = 0; j != portals; ++j)
+            {
+                target.costs[i * portals + j] = costs[_local(target.portals[j])];
+            }
+        }
+    }
+}
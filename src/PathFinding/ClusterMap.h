@@ -0,0 +1,67 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+namespace Falltergeist
+{
+    class Hexagon;
+    class HexagonGrid;
+
+    /**
+     * Abstraction of the hexagonal grid for long routes (HPA*)
+     * The grid is split into square clusters, every run of walkable hexagons along a cluster border gets one portal pair
+     * and the costs between the portals of a cluster are precomputed, so a route is searched over the portals
+     * and then refined cluster by cluster. Clusters are rebuilt lazily after blocking on them changed.
+     */
+    class ClusterMap final
+    {
+        public:
+            explicit ClusterMap(HexagonGrid* grid);
+
+            // Walkability of the hexagon changed
+            void invalidate(Hexagon* hexagon);
+
+            // Writes the path into the given buffer, destination first and without the starting hexagon
+            bool findPath(Hexagon* from, Hexagon* to, std::vector<Hexagon*>& path);
+
+        private:
+            struct Cluster
+            {
+                // Hexagon::index() of the portals, sorted
+                std::vector<unsigned int> portals;
+                // portals x portals matrix of walking costs inside the cluster
+                std::vector<unsigned int> costs;
+                // portal of this cluster and the adjacent hexagon of the neighbour cluster
+                std::vector<std::pair<unsigned int, unsigned int>> crossings;
+                bool dirty = true;
+            };
+
+            HexagonGrid* _grid;
+
+            // columns and rows of the grid and of the clusters
+            unsigned int _width = 0;
+            unsigned int _height = 0;
+            unsigned int _clustersX = 0;
+            unsigned int _clustersY = 0;
+
+            std::vector<Cluster> _clusters;
+
+            bool _dirty = true;
+
+            unsigned int _clusterOf(unsigned int index) const;
+
+            // position of the hexagon inside its cluster
+            unsigned int _local(unsigned int index) const;
+
+            // Breadth-first search from start restricted to the cluster, costs and parents are indexed by _local()
+            void _flood(unsigned int cluster, Hexagon* start, std::vector<unsigned int>& costs, std::vector<unsigned int>& parents) const;
+
+            void _rebuild();
+
+            // Finds the portal pairs on the border of two clusters
+            void _link(unsigned int cluster, unsigned int neighbour);
+
+            void _connect(unsigned int cluster);
+    };
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include "../PathFinding/DistanceField.h"
+#include "../PathFinding/Hexagon.h"
+#include "../PathFinding/HexagonGrid.h"
+
+namespace Falltergeist
+{
+    DistanceField::DistanceField(HexagonGrid* grid, unsigned int maxCost) : _grid(grid), _maxCost(maxCost)
+    {
+        _costs.resize(grid->size());
+        _stamps.resize(grid->size(), 0);
+    }
+
+    void DistanceField::update(Hexagon* source)
+    {
+        if (source == _source && _walkVersion == _grid->walkVersion() && !_stale) {
+            return;
+        }
+        _source = source;
+        _walkVersion = _grid->walkVersion();
+        _stale = false;
+
+        if (++_generation == 0) {
+            // stamps wrapped around, old costs could look current
+            std::fill(_stamps.begin(), _stamps.end(), 0);
+            _generation = 1;
+        }
+        if (!source) {
+            return;
+        }
+
+        // breadth-first, every step costs the same; the source is usually occupied by whoever is chased
+        _queue.clear();
+        _queue.push_back(source);
+        _costs[source->index()] = 0;
+        _stamps[source->index()] = _generation;
+        for (size_t head = 0; head != _queue.size(); ++head)
+        {
+            Hexagon* current = _queue[head];
+            const unsigned int cost = _costs[current->index()] + 1;
+            if (cost > _maxCost) {
+                break;
+            }
+            for (auto neighbor : current->neighbors())
+            {
+                if (!neighbor || _stamps[neighbor->index()] == _generation || !_grid->canWalkThru(neighbor)) {
+                    continue;
+                }
+                _costs[neighbor->index()] = cost;
+                _stamps[neighbor->index()] = _generation;
+                _queue.push_back(neighbor);
+            }
+        }
+    }
+
+    Hexagon* DistanceField::source() const
+    {
+        return _source;
+    }
+
+    unsigned int DistanceField::maxCost() const
+    {
+        return _maxCost;
+    }
+
+    void DistanceField::setMaxCost(unsigned int maxCost)
+    {
+        if (maxCost != _maxCost) {
+            _maxCost = maxCost;
+            _stale = true;
+        }
+    }
+
+    unsigned int DistanceField::cost(Hexagon* hexagon) const
+    {
+        if (_stamps[hexagon->index()] != _generation) {
+            return UNREACHABLE;
+        }
+        return _costs[hexagon->index()];
+    }
+
+    Hexagon* DistanceField::nextStep(Hexagon* hexagon) const
+    {
+        Hexagon* best = nullptr;
+        unsigned int bestCost = UNREACHABLE;
+        for (auto neighbor : hexagon->neighbors())
+        {
+            if (!neighbor) {
+                continue;
+            }
+            if (neighbor == _source) {
+                return nullptr;
+            }
+            // the hexagon itself may be unreachable, it is occupied by the chaser
+            unsigned int neighborCost = cost(neighbor);
+            if (neighborCost < bestCost) {
+                best = neighbor;
+                bestCost = neighborCost;
+            }
+        }
+        return best;
+    }
+}
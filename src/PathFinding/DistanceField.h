@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Falltergeist
+{
+    class Hexagon;
+    class HexagonGrid;
+
+    /**
+     * Walking costs of the hexagons around a source (Dijkstra map), shared by everyone heading to the same hexagon
+     * Chasers read their next step from the field instead of searching a path each, the field is recomputed
+     * only when the source moved or the walkability of the grid changed since the last update
+     */
+    class DistanceField final
+    {
+        public:
+            static const unsigned int UNREACHABLE = UINT32_MAX;
+
+            DistanceField(HexagonGrid* grid, unsigned int maxCost);
+
+            void update(Hexagon* source);
+
+            Hexagon* source() const;
+
+            unsigned int maxCost() const;
+            // The next update() computes the field again
+            void setMaxCost(unsigned int maxCost);
+
+            // Walking cost from the hexagon to the source, UNREACHABLE if it is blocked or further than maxCost
+            unsigned int cost(Hexagon* hexagon) const;
+
+            // Neighbour one step closer to the source, nullptr if the hexagon is next to the source or there is no way
+            Hexagon* nextStep(Hexagon* hexagon) const;
+
+        private:
+            HexagonGrid* _grid;
+
+            unsigned int _maxCost;
+
+            Hexagon* _source = nullptr;
+
+            // walkability of the grid the field was computed for
+            unsigned int _walkVersion = 0;
+            bool _stale = true;
+
+            // costs are valid for hexagons stamped with the current generation
+            std::vector<uint32_t> _costs;
+            std::vector<uint32_t> _stamps;
+            uint32_t _generation = 0;
+
+            std::vector<Hexagon*> _queue;
+    };
+}
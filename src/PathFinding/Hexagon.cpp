@@ -1,37 +1,99 @@
 #include <cmath>
 #include "../Game/DoorSceneryObject.h"
 #include "../PathFinding/Hexagon.h"
+#include "../PathFinding/HexagonGrid.h"
 
 namespace Falltergeist
 {
-    Hexagon::Hexagon(unsigned int number)
+    Hexagon::Hexagon(unsigned int number, HexagonGrid* grid, unsigned int index) : _grid(grid), _number(number), _index(index)
     {
-        // Init hex's grid position
-        setNumber(number);
     }
 
-    std::array<Hexagon*, HEX_SIDES>& Hexagon::neighbors()
+    Point Hexagon::positionOf(unsigned int number)
     {
-        return _neighbors;
+        const unsigned int hx = number % HexagonGrid::MAP_COLUMNS; // columns
+        const unsigned int hy = number / HexagonGrid::MAP_COLUMNS; // rows
+        const unsigned int xMod = HEX_WIDTH / 2;  // x offset
+        const unsigned int yMod = HEX_HEIGHT / 2; // y offset
+
+        // Calculate hex's actual position
+        const bool oddCol = hx & 1;
+        const int  oddMod = hy + 1;
+        const int x = (48 * (HexagonGrid::MAP_COLUMNS / 2))
+                    + (HEX_WIDTH * oddMod)
+                    - ((HEX_HEIGHT * 2) * hx)
+                    - (xMod * oddCol);
+        const int y = (oddMod * HEX_HEIGHT)
+                    + (yMod * hx)
+                    + HEX_HEIGHT
+                    - (yMod * oddCol);
+        return Point(x, y);
     }
 
-    std::list<Game::Object*>* Hexagon::objects()
+    Point Hexagon::position() const
     {
-        return &_objects;
+        return positionOf(_number);
+    }
+
+    int Hexagon::cubeX() const
+    {
+        const unsigned int hx = column();
+        const unsigned int hy = row();
+        return (int)hy - (int)(hx + (hx & 1)) / 2;
     }
 
-    const Point& Hexagon::position() const
+    int Hexagon::cubeY() const
     {
-        return _position;
+        return -cubeX() - cubeZ();
     }
 
-    void Hexagon::setPosition(const Point& pos)
+    int Hexagon::cubeZ() const
     {
-        _position = pos;
+        return column();
+    }
+
+    std::array<Hexagon*, HEX_SIDES> Hexagon::neighbors() const
+    {
+       /* North: index - 200 *
+        * East:  index - 1   *
+        * South: index + 200 *
+        * West:  index + 1   */
+        const unsigned index = _number;
+        const bool oddCol = index & 1;
+        const unsigned columns = HexagonGrid::MAP_COLUMNS;
+        const unsigned hy = index / columns; // hexagonal y
+        const unsigned hx = index % columns; // hexagonal x
+        const unsigned leftMod  = hx + 1;
+        const unsigned rightMod = hx - 1;
+        const unsigned botMod = (hy + !oddCol) * columns;
+        const unsigned topMod = (hy -  oddCol) * columns;
+        const unsigned indexes[HEX_SIDES] = {
+            (hy + 1) * columns + hx, // Bottom
+            botMod + leftMod,        // Bottom left
+            topMod + leftMod,        // Top left
+            (hy - 1) * columns + hx, // Top
+            botMod + rightMod,       // Bottom right
+            topMod + rightMod        // Top right
+        };
+
+        std::array<Hexagon*, HEX_SIDES> neighbors = {};
+        // Don't get a neighbour if at the borders of the map or of the region the grid covers
+        for (int i = 0; i != HEX_SIDES; ++i) {
+            neighbors[i] = _grid->at(indexes[i]);
+        }
+        return neighbors;
+    }
+
+    Hexagon::Objects* Hexagon::objects()
+    {
+        return &_objects;
     }
 
     bool Hexagon::canWalkThru()
     {
+        if (_grid) {
+            return _grid->canWalkThru(this);
+        }
         // Search hex for any blocking objects...
         for (const auto object : _objects) {
             if (!object->canWalkThru()) {
@@ -43,7 +105,7 @@ namespace Falltergeist
 
     Game::Orientation Hexagon::orientationTo(Hexagon *hexagon)
     {
-        Point delta = hexagon->position() - _position;
+        Point delta = hexagon->position() - position();
         int dx = delta.x();
         int dy = delta.y();
 
@@ -71,30 +133,32 @@ namespace Falltergeist
 
     unsigned int Hexagon::addLight(unsigned int light)
     {
-        _light += light;
-        if (_light > 65536) {
-            _light = 65536;
+        auto& value = _grid->_lights[_index];
+        value += light;
+        if (value > 65536) {
+            value = 65536;
         }
-        return _light;
+        return value;
     }
 
     unsigned int Hexagon::subLight(unsigned int light)
     {
-        _light -= light;
-        if ((int)_light < 655) {
-            _light = 655;
+        auto& value = _grid->_lights[_index];
+        value -= light;
+        if ((int)value < 655) {
+            value = 655;
         }
-        return _light;
+        return value;
     }
 
     unsigned int Hexagon::light()
     {
-        return _light;
+        return _grid->_lights[_index];
     }
 
     unsigned int Hexagon::setLight(unsigned int light)
     {
-        _light = light;
-        return _light;
+        _grid->_lights[_index] = light;
+        return light;
     }
 }
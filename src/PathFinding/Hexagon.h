@@ -1,9 +1,10 @@
 #pragma once
 
 #include <array>
-#include <list>
+#include "../Base/SmallVector.h"
 #include "../Game/Object.h"
 #include "../Graphics/Point.h"
+#include "../PathFinding/HexagonGrid.h"
 
 #define HEX_SIDES 6
 #define HEX_WIDTH 16
@@ -18,91 +19,69 @@ namespace Falltergeist
 
     using Graphics::Point;
 
+    /**
+     * Handle of a hexagon in the HexagonGrid. Position, cube coordinates and neighbours follow from the number
+     * and light is stored densely by the grid at the index, so a hexagon only keeps its objects.
+     */
     class Hexagon
     {
         public:
-            Hexagon() = default;
-            explicit Hexagon(unsigned int number);
-
-            const Point& position() const;
-            void setPosition(const Point& pos);
+            // Most hexagons have up to three objects, they are kept inside the hexagon then
+            using Objects = Base::SmallVector<Game::Object*, 3>;
 
-            inline unsigned int number()
-            {
-                return _number;
-            }
+            Hexagon() = default;
+            explicit Hexagon(unsigned int number, HexagonGrid* grid = nullptr, unsigned int index = 0);
 
-            inline void setNumber(unsigned int value)
-            {
-                _number = value;
-            }
+            // Screen position of the hexagon with the given number
+            static Point positionOf(unsigned int number);
 
-            inline unsigned int heuristic()
-            {
-                return _heuristic;
-            }
+            Point position() const;
 
-            inline void setHeuristic(unsigned int value)
+            // Number of the hexagon in maps and scripts, row * HexagonGrid::MAP_COLUMNS + column
+            inline unsigned int number() const
             {
-                _heuristic = value;
-            }
-
-            inline int cubeX()
-            {
-                return _cubeX;
+                return _number;
             }
 
-            inline void setCubeX(unsigned int value)
+            // Position in the arrays of the grid, which only covers the region of the map in use
+            inline unsigned int index() const
             {
-                _cubeX = value;
+                return _index;
             }
 
-            inline int cubeY()
+            inline unsigned int column() const
             {
-                return _cubeY;
+                return _number % HexagonGrid::MAP_COLUMNS;
             }
 
-            inline void setCubeY(unsigned int value)
+            inline unsigned int row() const
             {
-                _cubeY = value;
+                return _number / HexagonGrid::MAP_COLUMNS;
             }
 
-            inline int cubeZ()
-            {
-                return _cubeZ;
-            }
-
-            inline void setCubeZ(unsigned int value)
-            {
-                _cubeZ = value;
-            }
+            int cubeX() const;
+            int cubeY() const;
+            int cubeZ() const;
 
+            // Light and neighbours are only available for hexagons of a grid
             unsigned int addLight(unsigned int light);
             unsigned int subLight(unsigned int light);
             unsigned int setLight(unsigned int light);
             unsigned int light();
 
+            // Read from the blocking bits of the grid, see HexagonGrid::updateBlocking()
             bool canWalkThru();
 
-            std::array<Hexagon*, HEX_SIDES>& neighbors();
+            std::array<Hexagon*, HEX_SIDES> neighbors() const;
 
-            std::list<Game::Object*>* objects();
+            Objects* objects();
 
             Game::Orientation orientationTo(Hexagon *hexagon);
 
         protected:
-            std::array<Hexagon*, HEX_SIDES> _neighbors = {};
-            std::list<Game::Object*> _objects;
+            Objects _objects;
+            HexagonGrid* _grid = nullptr;
             unsigned int _number = 0; // position in hexagonal grid
-
-            Point _position;
-
-            int _cubeX = 0;
-            int _cubeY = 0;
-            int _cubeZ = 0;
-
-            unsigned int _heuristic = 0;
-
-            unsigned int _light = 655;
+            unsigned int _index = 0;
     };
 }
@@ -1,165 +1,548 @@
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
-#include <queue>
+#include <functional>
 #include <memory>
+#include "../Base/JobSystem.h"
+#include "../Game/Game.h"
 #include "../Game/WallObject.h"
+#include "../Metrics.h"
+#include "../PathFinding/ClusterMap.h"
+#include "../PathFinding/DistanceField.h"
 #include "../PathFinding/Hexagon.h"
 #include "../PathFinding/HexagonGrid.h"
+#include "../PathFinding/SearchContext.h"
 
 namespace Falltergeist
 {
-    struct HeuristicComparison
+    namespace
     {
-        bool operator()(Hexagon* lh, Hexagon* rh) const
+        // routes up to this distance are tried on the grid before the cluster map
+        const unsigned int SHORT_ROUTE = 20;
+
+        // Light radius the cone occlusion rules are written for
+        const unsigned int MAX_LIGHT_RADIUS = 8;
+
+        // Longest line of sight or fire kept by _ray(), perception ranges and weapon ranges of the game are within it
+        const int RAY_CACHE_DISTANCE = 50;
+
+        // Largest ring taken from RING_OFFSETS, wake and preload radii are around it
+        const unsigned int RING_TABLE_RADIUS = 20;
+
+        // Cube coordinate steps of the hexInDirection() rotations, as x, y, z
+        constexpr int DIRECTIONS[HEX_SIDES][3] = {{0, 1, -1}, {1, 0, -1}, {1, -1, 0}, {0, -1, 1}, {-1, 0, 1}, {-1, 1, 0}};
+
+        // Index of the first hexagon of the ring in rings 1, 2, ... laid out one after another
+        constexpr unsigned int ringStart(unsigned int radius)
         {
-            return lh->heuristic() > rh->heuristic();
+            return 3 * radius * (radius - 1);
         }
-    };
 
-    // TODO: Refactor this ctor to make it more understandable.
-    HexagonGrid::HexagonGrid()
-    {
-        // Creating 200x200 hexagonal map
-        unsigned int index = 0;
-        const unsigned int xMod = HEX_WIDTH / 2;  // x offset
-        const unsigned int yMod = HEX_HEIGHT / 2; // y offset
+        struct RingOffset
+        {
+            int x;
+            int z;
+        };
 
-        for (unsigned int hy = 0; hy != GRID_HEIGHT; ++hy) // rows
+        struct RingOffsets
         {
-            for (unsigned int hx = 0; hx != GRID_WIDTH; ++hx, ++index) // columns
+            RingOffset offsets[ringStart(RING_TABLE_RADIUS + 1)] = {};
+        };
+
+        // Cube offsets of every ring up to RING_TABLE_RADIUS, in the order ring() returns them
+        constexpr RingOffsets makeRingOffsets()
+        {
+            RingOffsets result;
+            for (unsigned int radius = 1; radius <= RING_TABLE_RADIUS; ++radius)
             {
-                _hexagons.emplace_back(std::make_unique<Hexagon>(index));
-                auto& hexagon = _hexagons.back();
-                // Calculate hex's actual position
-                const bool oddCol = hx & 1;
-                const int  oddMod = hy + 1;
-                const int x = (48 * (GRID_WIDTH / 2))
-                            + (HEX_WIDTH * oddMod)
-                            - ((HEX_HEIGHT * 2) * hx)
-                            - (xMod * oddCol);
-                const int y = (oddMod * HEX_HEIGHT)
-                            + (yMod * hx)
-                            + HEX_HEIGHT
-                            - (yMod * oddCol);
-                hexagon->setCubeX(hy - (hx + oddCol) / 2);
-                hexagon->setCubeZ(hx);
-                hexagon->setCubeY(-hexagon->cubeX() - hexagon->cubeZ());
-
-                hexagon->setPosition({x, y});
+                int x = DIRECTIONS[0][0] * (int)radius;
+                int z = DIRECTIONS[0][2] * (int)radius;
+                unsigned int index = ringStart(radius);
+                for (unsigned int d = 0, dir = 2; d != HEX_SIDES; ++d, dir = (dir + 1) % HEX_SIDES)
+                {
+                    for (unsigned int i = 0; i != radius; ++i)
+                    {
+                        result.offsets[index++] = {x, z};
+                        x += DIRECTIONS[dir][0];
+                        z += DIRECTIONS[dir][2];
+                    }
+                }
             }
+            return result;
         }
 
-        // Creating links between hexagons
-        for (index = 0; index != GRID_WIDTH * GRID_HEIGHT; ++index)
+        constexpr RingOffsets RING_OFFSETS = makeRingOffsets();
+
+        static_assert(MAX_LIGHT_RADIUS <= RING_TABLE_RADIUS, "light cones are traced over the ring table");
+
+        bool testBit(const std::vector<uint64_t>& bits, unsigned int index)
         {
-           /* North: index - 200 *
-            * East:  index - 1   *
-            * South: index + 200 *
-            * West:  index + 1   */
-            auto hexagon = _hexagons.at(index).get();
-
-            const bool oddCol = index & 1;
-            const unsigned hy = index / GRID_HEIGHT; // hexagonal y
-            const unsigned hx = index % GRID_WIDTH;  // hexagonal x
-            const unsigned leftMod  = hx + 1;
-            const unsigned rightMod = hx - 1;
-            const unsigned botMod = (hy + !oddCol) * GRID_HEIGHT;
-            const unsigned topMod = (hy -  oddCol) * GRID_HEIGHT;
-            // Bottom
-            const unsigned indexBot  = (hy + 1) * GRID_HEIGHT + hx; // index 1
-            // Left
-            const unsigned indexBotLeft = botMod + leftMod; // index 2
-            const unsigned indexTopLeft = topMod + leftMod; // index 3
-            // Top
-            const unsigned indexTop = (hy - 1) * GRID_HEIGHT + hx; // index 4
-            // Right
-            const unsigned indexBotRight  = botMod + rightMod; // index 5
-            const unsigned indexTopRight  = topMod + rightMod; // index 6
-
-            const unsigned gridSize = GRID_HEIGHT * GRID_WIDTH;
-            std::array<Hexagon*, HEX_SIDES>& neighbor = hexagon->neighbors();
-            // Don't get a neighbour if at the map's borders
-            if (indexBot < gridSize) {
-                neighbor[0] = _hexagons.at(indexBot).get();
+            return (bits[index / 64] >> (index % 64)) & 1;
+        }
+
+        void setBit(std::vector<uint64_t>& bits, unsigned int index, bool value)
+        {
+            if (value) {
+                bits[index / 64] |= uint64_t(1) << (index % 64);
+            } else {
+                bits[index / 64] &= ~(uint64_t(1) << (index % 64));
             }
-            if (indexBotLeft < gridSize) {
-                neighbor[1] = _hexagons.at(indexBotLeft).get();
+        }
+
+        // Column and row of the hexagon whose picking area is around the screen point, they may be off the map.
+        // Inverting Hexagon::positionOf() gives hx = (4 * y - 3 * x) / 96 regardless of the column parity,
+        // with x and y taken relative to the hexagon 0 and the center of the picking area (2 pixels above the position).
+        void columnRowAt(const Point& pos, int& column, int& row)
+        {
+            const int x = pos.x() - (48 * (HexagonGrid::MAP_COLUMNS / 2) + HEX_WIDTH);
+            const int y = pos.y() + 2 - 2 * HEX_HEIGHT;
+            column = (int)std::floor((4.0 * y - 3.0 * x) / 96.0);
+            row = (int)std::floor((y - (HEX_HEIGHT / 2) * column) / (double)HEX_HEIGHT);
+        }
+    }
+
+    HexagonGrid::Region HexagonGrid::cover(const std::vector<unsigned int>& numbers, const std::vector<Point>& points, unsigned int margin)
+    {
+        int left = MAP_COLUMNS;
+        int top = MAP_ROWS;
+        int right = -1;
+        int bottom = -1;
+        auto add = [&](int column, int row)
+        {
+            left = std::min(left, column);
+            top = std::min(top, row);
+            right = std::max(right, column);
+            bottom = std::max(bottom, row);
+        };
+        for (auto number : numbers)
+        {
+            if (number < MAP_COLUMNS * MAP_ROWS) {
+                add(number % MAP_COLUMNS, number / MAP_COLUMNS);
             }
-            if (indexTopLeft < gridSize) {
-                neighbor[2] = _hexagons.at(indexTopLeft).get();
+        }
+        for (auto& point : points)
+        {
+            int column, row;
+            columnRowAt(point, column, row);
+            add(column, row);
+        }
+
+        Region region;
+        if (right < left || bottom < top) {
+            return region;
+        }
+        left = std::max(left - (int)margin, 0);
+        top = std::max(top - (int)margin, 0);
+        right = std::min(right + (int)margin, (int)MAP_COLUMNS - 1);
+        bottom = std::min(bottom + (int)margin, (int)MAP_ROWS - 1);
+        if (right < left || bottom < top) {
+            return region;
+        }
+        region.left = left;
+        region.top = top;
+        region.width = right - left + 1;
+        region.height = bottom - top + 1;
+        return region;
+    }
+
+    HexagonGrid::HexagonGrid() : HexagonGrid(Region())
+    {
+    }
+
+    HexagonGrid::HexagonGrid(const Region& region) : _region(region)
+    {
+        // hexagons of the region, stored contiguously since hexagons never move
+        const size_t size = (size_t)_region.width * _region.height;
+        _hexagons.reserve(size);
+        _positions.reserve(size);
+        for (unsigned int row = _region.top; row != _region.top + _region.height; ++row)
+        {
+            for (unsigned int column = _region.left; column != _region.left + _region.width; ++column)
+            {
+                const unsigned int number = row * MAP_COLUMNS + column;
+                _hexagons.emplace_back(number, this, (unsigned int)_hexagons.size());
+                _positions.push_back(Hexagon::positionOf(number));
             }
-            if (indexTop < gridSize) {
-                neighbor[3] = _hexagons.at(indexTop).get();
+        }
+        _lights.assign(size, 655);
+
+        const size_t words = (size + 63) / 64;
+        _walkBlocked.assign(words, 0);
+        _lightBlocked.assign(words, 0);
+        _shootBlocked.assign(words, 0);
+        _wallBits.assign(words, 0);
+        _sceneryBits.assign(words, 0);
+
+        _clusterMap = std::make_unique<ClusterMap>(this);
+    }
+
+    HexagonGrid::~HexagonGrid() {}
+
+    const HexagonGrid::Region& HexagonGrid::region() const
+    {
+        return _region;
+    }
+
+    size_t HexagonGrid::size() const
+    {
+        return _hexagons.size();
+    }
+
+    Hexagon* HexagonGrid::at(size_t number)
+    {
+        if (number >= MAP_COLUMNS * MAP_ROWS) {
+            return nullptr;
+        }
+        // unsigned, columns and rows left of or above the region wrap around
+        const size_t column = number % MAP_COLUMNS - _region.left;
+        const size_t row = number / MAP_COLUMNS - _region.top;
+        if (column >= _region.width || row >= _region.height) {
+            return nullptr;
+        }
+        return &_hexagons[row * _region.width + column];
+    }
+
+    Hexagon* HexagonGrid::atIndex(size_t index)
+    {
+        return &_hexagons.at(index);
+    }
+
+    void HexagonGrid::updateBlocking(Hexagon* hexagon)
+    {
+        bool walkBlocked = false;
+        bool lightBlocked = false;
+        bool shootBlocked = false;
+        bool wall = false;
+        bool scenery = false;
+        for (const auto object : *hexagon->objects())
+        {
+            walkBlocked = walkBlocked || !object->canWalkThru();
+            wall = wall || object->type() == Game::Object::Type::WALL;
+            scenery = scenery || (object->type() == Game::Object::Type::SCENERY && !object->canWalkThru());
+            shootBlocked = shootBlocked || !object->canShootThru();
+            // same exceptions as in initLight()
+            if (!object->flat() && object->type() != Game::Object::Type::DUDE) {
+                lightBlocked = lightBlocked || !object->canLightThru();
             }
-            if (indexBotRight < gridSize) {
-                neighbor[4] = _hexagons.at(indexBotRight).get();
+        }
+        if (walkBlocked != !canWalkThru(hexagon)) {
+            _clusterMap->invalidate(hexagon);
+            ++_walkVersion;
+        }
+        setBit(_walkBlocked, hexagon->index(), walkBlocked);
+        setBit(_lightBlocked, hexagon->index(), lightBlocked);
+        setBit(_shootBlocked, hexagon->index(), shootBlocked);
+        setBit(_wallBits, hexagon->index(), wall);
+        setBit(_sceneryBits, hexagon->index(), scenery);
+    }
+
+    bool HexagonGrid::canWalkThru(Hexagon* hexagon) const
+    {
+        return !testBit(_walkBlocked, hexagon->index());
+    }
+
+    bool HexagonGrid::canLightThru(Hexagon* hexagon) const
+    {
+        return !testBit(_lightBlocked, hexagon->index());
+    }
+
+    bool HexagonGrid::canShootThru(Hexagon* hexagon) const
+    {
+        return !testBit(_shootBlocked, hexagon->index());
+    }
+
+    bool HexagonGrid::canSee(Hexagon* from, Hexagon* to)
+    {
+        return _traceLine(_lightBlocked, from, to);
+    }
+
+    bool HexagonGrid::canShoot(Hexagon* from, Hexagon* to)
+    {
+        return _traceLine(_shootBlocked, from, to);
+    }
+
+    bool HexagonGrid::_traceLine(const std::vector<uint64_t>& blocked, Hexagon* from, Hexagon* to)
+    {
+        const int x = from->cubeX();
+        const int z = from->cubeZ();
+        for (const auto& step : _ray(to->cubeX() - x, to->cubeZ() - z))
+        {
+            Hexagon* hexagon = _atCube(x + step.x, z + step.z);
+            if (!hexagon || testBit(blocked, hexagon->index())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const std::vector<HexagonGrid::RayStep>& HexagonGrid::_ray(int dx, int dz)
+    {
+        const int dy = -dx - dz;
+        const int length = (std::abs(dx) + std::abs(dy) + std::abs(dz)) / 2;
+        const bool cached = length <= RAY_CACHE_DISTANCE;
+        const uint32_t key = (uint32_t)(dx + 1024) << 16 | (uint32_t)(dz + 1024);
+        if (cached) {
+            auto it = _rays.find(key);
+            if (it != _rays.end()) {
+                return it->second;
             }
-            if (indexTopRight < gridSize) {
-                neighbor[5] = _hexagons.at(indexTopRight).get();
+        }
+
+        // hexagons between the ends, found by rounding points of the cube line
+        // the nudge keeps the rounding of points exactly between two hexagons consistent
+        std::vector<RayStep> steps;
+        if (!cached) {
+            steps.swap(_longRay);
+            steps.clear();
+        }
+        for (int i = 1; i < length; ++i)
+        {
+            const double t = (double)i / length;
+            const double fx = dx * t + 1e-6;
+            const double fy = dy * t + 2e-6;
+            const double fz = dz * t - 3e-6;
+            double rx = std::round(fx);
+            double ry = std::round(fy);
+            double rz = std::round(fz);
+            const double ex = std::abs(rx - fx);
+            const double ey = std::abs(ry - fy);
+            const double ez = std::abs(rz - fz);
+            if (ex > ey && ex > ez) {
+                rx = -ry - rz;
+            } else if (ey <= ez) {
+                rz = -rx - ry;
             }
+            steps.push_back({(int)rx, (int)rz});
+        }
+        if (!cached) {
+            _longRay.swap(steps);
+            return _longRay;
         }
+        return _rays.emplace(key, std::move(steps)).first->second;
     }
 
-    HexagonGrid::~HexagonGrid() {}
+    unsigned int HexagonGrid::walkVersion() const
+    {
+        return _walkVersion;
+    }
 
-    Hexagon* HexagonGrid::at(size_t index)
+    const std::vector<uint64_t>& HexagonGrid::wallBits() const
     {
-        return _hexagons.at(index).get();
+        return _wallBits;
+    }
+
+    const std::vector<uint64_t>& HexagonGrid::sceneryBits() const
+    {
+        return _sceneryBits;
     }
 
     Hexagon* HexagonGrid::hexagonAt(const Point& pos)
     {
-        for (auto& hexagon : _hexagons)
+        // the mouse reports the same position many times between camera or cursor moves
+        if (_hoverValid && pos == _hoverPosition) {
+            return _hoverHexagon;
+        }
+
+        // Picking areas overlap, the hexagon with the lowest number wins, and all candidates lie within 2 columns and rows
+        int column, row;
+        columnRowAt(pos, column, row);
+
+        const int left = _region.left;
+        const int top = _region.top;
+        Hexagon* result = nullptr;
+        for (int hy = std::max(row - 2, top); hy <= std::min(row + 2, top + (int)_region.height - 1); ++hy)
         {
-            auto hexPos = hexagon->position();
-            if (pos.x() >= hexPos.x() - HEX_WIDTH &&
-                pos.x() <  hexPos.x() + HEX_WIDTH &&
-                pos.y() >= hexPos.y() - 8 &&
-                pos.y() <  hexPos.y() + 4)
+            for (int hx = std::max(column - 2, left); hx <= std::min(column + 2, left + (int)_region.width - 1); ++hx)
             {
-                return hexagon.get();
+                const unsigned int index = (hy - top) * _region.width + (hx - left);
+                if (result && index >= result->index()) {
+                    continue;
+                }
+                const Point& hexPos = _positions[index];
+                if (pos.x() >= hexPos.x() - HEX_WIDTH &&
+                    pos.x() <  hexPos.x() + HEX_WIDTH &&
+                    pos.y() >= hexPos.y() - 8 &&
+                    pos.y() <  hexPos.y() + 4)
+                {
+                    result = &_hexagons[index];
+                }
             }
         }
-        return nullptr;
+
+        _hoverPosition = pos;
+        _hoverHexagon = result;
+        _hoverValid = true;
+        return result;
     }
 
-    Base::vector_ptr_decorator<Hexagon> HexagonGrid::hexagons()
+    Base::vector_value_decorator<Hexagon> HexagonGrid::hexagons()
     {
-        return Base::vector_ptr_decorator<Hexagon>(_hexagons);
+        return Base::vector_value_decorator<Hexagon>(_hexagons);
     }
 
     std::vector<Hexagon*> HexagonGrid::findPath(Hexagon* from, Hexagon* to)
     {
-        Hexagon* current = nullptr;
         std::vector<Hexagon*> result;
-        std::priority_queue<Hexagon*, std::vector<Hexagon*>, HeuristicComparison> unvisited;
-        unsigned int cameFrom[GRID_HEIGHT * GRID_WIDTH]  = {};
-        unsigned int costSoFar[GRID_HEIGHT * GRID_WIDTH] = {};
+        findPath(from, to, result);
+        return result;
+    }
 
-        // if we can't go to the location
-        // @todo remove when path will have length restriction
-        if (!to->canWalkThru()) {
-            return result;
+    bool HexagonGrid::findPath(Hexagon* from, Hexagon* to, std::vector<Hexagon*>& path)
+    {
+        if (!Metrics::enabled()) {
+            return _findPath(from, to, path);
+        }
+        static auto& calls = Metrics::counter("pathfinding.calls");
+        static auto& expansions = Metrics::counter("pathfinding.expansions");
+        auto& context = SearchContext::current();
+        auto popped = context.popped();
+        bool found = _findPath(from, to, path);
+        calls.add();
+        expansions.add(context.popped() - popped);
+        return found;
+    }
+
+    bool HexagonGrid::_findPath(Hexagon* from, Hexagon* to, std::vector<Hexagon*>& path)
+    {
+        // nearby routes are searched directly, the bounded search fails on detours and long routes
+        if (distance(from, to) <= SHORT_ROUTE && _search(_walkBlocked, from, to, 100, path)) {
+            return true;
+        }
+        return _clusterMap->findPath(from, to, path);
+    }
+
+    DistanceField& HexagonGrid::distanceField(const void* target, Hexagon* hexagon)
+    {
+        auto& field = _distanceFields[target];
+        if (!field) {
+            field = std::make_unique<DistanceField>(this, 100);
         }
+        field->update(hexagon);
+        return *field;
+    }
 
-        unvisited.push(from);
+    const DistanceField& HexagonGrid::reachable(const void* walker, Hexagon* hexagon, unsigned int maxCost)
+    {
+        auto& field = _reachableAreas[walker];
+        if (!field) {
+            field = std::make_unique<DistanceField>(this, maxCost);
+        }
+        field->setMaxCost(maxCost);
+        field->update(hexagon);
+        return *field;
+    }
 
-        cameFrom[from->number()]  = 0;
-        costSoFar[from->number()] = 0;
+    void HexagonGrid::forgetDistanceField(const void* target)
+    {
+        _distanceFields.erase(target);
+        _reachableAreas.erase(target);
+    }
 
+    void HexagonGrid::queuePath(Hexagon* from, Hexagon* to, unsigned int maxCost, const void* owner, PathCallback callback)
+    {
+        _pathRequests.push_back({from, to, maxCost, owner, std::move(callback), {}});
+    }
 
-        while (!unvisited.empty())
+    void HexagonGrid::cancelPaths(const void* owner)
+    {
+        auto owned = [owner](const PathRequest& request) -> bool
         {
-            current = unvisited.top(); unvisited.pop();
+            return request.owner == owner;
+        };
+        _pathRequests.erase(std::remove_if(_pathRequests.begin(), _pathRequests.end(), owned), _pathRequests.end());
+        // callbacks of the batch being delivered can remove objects too
+        for (auto& request : _solvingPaths)
+        {
+            if (owned(request)) {
+                request.callback = nullptr;
+            }
+        }
+    }
+
+    void HexagonGrid::solvePaths()
+    {
+        if (_pathRequests.empty() || !_solvingPaths.empty()) {
+            return;
+        }
+        _solvingPaths.swap(_pathRequests);
+
+        // workers only read the snapshot and the hexagon links, which never change
+        const std::vector<uint64_t> walkBlocked(_walkBlocked);
+        auto solve = [this, &walkBlocked](size_t first, size_t last)
+        {
+            for (size_t i = first; i != last; ++i)
+            {
+                auto& request = _solvingPaths[i];
+                _search(walkBlocked, request.from, request.to, request.maxCost, request.path);
+            }
+        };
+
+        size_t requests = _solvingPaths.size();
+        auto jobs = Game::Game::getInstance()->jobs();
+        if (requests == 1 || !jobs || jobs->size() == 0) {
+            solve(0, requests);
+        } else {
+            // the main loop waits for the batch, so every worker and this thread take a part
+            size_t parts = jobs->size() + 1;
+            size_t chunk = (requests + parts - 1) / parts;
+            // every job has to finish before the snapshot goes away, even if one of them failed
+            Base::JobSystem::Group group(*jobs);
+            for (size_t first = 0; first < requests; first += chunk)
+            {
+                size_t last = std::min(first + chunk, requests);
+                jobs->run([&solve, first, last]() { solve(first, last); }, &group);
+            }
+            group.wait();
+        }
+
+        // callbacks may queue new searches, those wait for the next batch
+        for (size_t i = 0; i != _solvingPaths.size(); ++i)
+        {
+            if (_solvingPaths[i].callback) {
+                _solvingPaths[i].callback(_solvingPaths[i].path);
+            }
+        }
+        _solvingPaths.clear();
+    }
+
+    bool HexagonGrid::_search(const std::vector<uint64_t>& walkBlocked, Hexagon* from, Hexagon* to, unsigned int maxCost, std::vector<Hexagon*>& path)
+    {
+        path.clear();
+
+        // if we can't go to the location
+        // @todo remove when path will have length restriction
+        if (testBit(walkBlocked, to->index())) {
+            return false;
+        }
+
+        auto& context = SearchContext::current();
+        context.reset(_hexagons.size());
+        context.reach(from->index(), from->index(), 0);
+        context.push(distance(from, to), from->index());
+
+        bool found = false;
+        unsigned int fCost;
+        unsigned int index;
+        while (context.pop(fCost, index))
+        {
+            Hexagon* current = &_hexagons[index];
+            unsigned int cost = context.cost(index);
+            // stale entry, the hexagon was queued again with a lower cost
+            if (fCost != cost + distance(current, to)) {
+                continue;
+            }
             if (current == to) {
+                found = true;
                 break;
             }
             // search limit
-            if (costSoFar[current->number()] >= 100) {
+            if (cost >= maxCost) {
                 break;
             }
 
-            std::array<Hexagon*, HEX_SIDES>& neighbor = current->neighbors();
+            const std::array<Hexagon*, HEX_SIDES> neighbor = current->neighbors();
             // look to each adjacent hex...
             for (int i = 0; i < HEX_SIDES; i++)
             {
@@ -168,48 +551,74 @@ namespace Falltergeist
                     continue;
                 }
                 // Is that hex blocked?
-                if (!neighbor[i]->canWalkThru()) {
+                if (testBit(walkBlocked, neighbor[i]->index())) {
                     continue;
                 }
 
                 // This hex is a viable path. But is it the shortest?
-                auto &neighborCost   = costSoFar[neighbor[i]->number()];
-                unsigned int newCost = costSoFar[current->number()] + 1;
-
-                if (neighborCost == 0 || newCost < neighborCost)
-                {
-                    // add hexagon to unvisited queue only once and don't change heuristic
-                    if (neighborCost == 0)
-                    {
-                        neighbor[i]->setHeuristic(distance(neighbor[i], to) + newCost);
-                        unvisited.push(neighbor[i]);
-                    }
-                    neighborCost = newCost;
-                    cameFrom[neighbor[i]->number()] = current->number();
+                unsigned int neighborIndex = neighbor[i]->index();
+                unsigned int newCost = cost + 1;
+                if (context.reached(neighborIndex) && context.cost(neighborIndex) <= newCost) {
+                    continue;
                 }
+                context.reach(neighborIndex, index, newCost);
+                context.push(newCost + distance(neighbor[i], to), neighborIndex);
             }
         }
 
         // found nothing
-        if (current != to) {
-            return result;
+        if (!found) {
+            return false;
         }
 
-
-        while (current->number() != from->number())
+        for (index = to->index(); index != from->index(); index = context.cameFrom(index))
         {
-            result.push_back(current);
-            current = _hexagons.at(cameFrom[current->number()]).get();
+            path.push_back(&_hexagons[index]);
         }
-
-        return result;
+        return true;
     }
 
-    unsigned int HexagonGrid::distance(Hexagon* from, Hexagon* to)
+    unsigned int HexagonGrid::distance(Hexagon* from, Hexagon* to) const
     {
         return (std::abs(from->cubeX() - to->cubeX()) + std::abs(from->cubeY() - to->cubeY()) + std::abs(from->cubeZ() - to->cubeZ())) / 2;
     }
 
+    void HexagonGrid::CubeCoordinates::add(Hexagon* hexagon)
+    {
+        x.push_back(hexagon->cubeX());
+        z.push_back(hexagon->cubeZ());
+    }
+
+    void HexagonGrid::CubeCoordinates::clear()
+    {
+        x.clear();
+        z.clear();
+    }
+
+    size_t HexagonGrid::CubeCoordinates::size() const
+    {
+        return x.size();
+    }
+
+    void HexagonGrid::distances(Hexagon* from, const CubeCoordinates& to, std::vector<unsigned int>& result) const
+    {
+        const size_t count = to.size();
+        result.resize(count);
+        const int32_t fromX = from->cubeX();
+        const int32_t fromZ = from->cubeZ();
+        const int32_t* __restrict x = to.x.data();
+        const int32_t* __restrict z = to.z.data();
+        unsigned int* __restrict out = result.data();
+        // no branches and no dependencies between the lanes, compilers turn it into packed subtractions, abs and max
+        for (size_t i = 0; i != count; ++i)
+        {
+            const int32_t dx = x[i] - fromX;
+            const int32_t dz = z[i] - fromZ;
+            const int32_t dy = -dx - dz;
+            out[i] = static_cast<unsigned int>(std::max(std::max(std::abs(dx), std::abs(dz)), std::abs(dy)));
+        }
+    }
+
     Hexagon* HexagonGrid::hexInDirection(Hexagon* from, unsigned short rotation, unsigned int distance)
     {
         if (distance == 0 || rotation > 5)
@@ -251,8 +660,8 @@ namespace Falltergeist
         }
         int p = startZ;
         int q = startX + (p + (p&1))/2;
-        int index = 200*q + p;
-        if (index < 0 || index >= 200*200)
+        int index = (int)MAP_COLUMNS * q + p;
+        if (index < 0)
         {
             return nullptr;
         }
@@ -263,34 +672,69 @@ namespace Falltergeist
     std::vector<Hexagon*> HexagonGrid::ring(Hexagon* from, unsigned int radius)
     {
         std::vector<Hexagon*> result;
+        ring(from, radius, result);
+        return result;
+    }
 
+    void HexagonGrid::ring(Hexagon* from, unsigned int radius, std::vector<Hexagon*>& result)
+    {
+        result.clear();
         if (radius == 0)
         {
             result.push_back(from);
-            return result;
+            return;
         }
 
-        unsigned int dir = 0;
-        Hexagon* current = hexInDirection(from, dir, radius);
-        dir = 2;
-        for (unsigned int d = 0; d < 6; d++)
+        const int cubeX = from->cubeX();
+        const int cubeZ = from->cubeZ();
+        result.resize(radius * HEX_SIDES);
+        if (radius <= RING_TABLE_RADIUS)
         {
-            for (unsigned int i = 0; i < radius; i++)
+            const RingOffset* offsets = RING_OFFSETS.offsets + ringStart(radius);
+            for (unsigned int i = 0; i != radius * HEX_SIDES; ++i)
             {
-                result.push_back(current);
-                current = hexInDirection(current,dir,1);
+                result[i] = _atCube(cubeX + offsets[i].x, cubeZ + offsets[i].z);
             }
-            dir++;
-            if (dir > 5)
+            return;
+        }
+
+        // stepping in cube coordinates, hexagons off the grid are returned as nullptr
+        result.clear();
+        int x = cubeX + DIRECTIONS[0][0] * (int)radius;
+        int z = cubeZ + DIRECTIONS[0][2] * (int)radius;
+        for (unsigned int d = 0, dir = 2; d != HEX_SIDES; ++d, dir = (dir + 1) % HEX_SIDES)
+        {
+            for (unsigned int i = 0; i < radius; i++)
             {
-                dir = 0;
+                result.push_back(_atCube(x, z));
+                x += DIRECTIONS[dir][0];
+                z += DIRECTIONS[dir][2];
             }
         }
-        return result;
     }
 
-    void HexagonGrid::initLight(Hexagon *hex, bool add)
+    Hexagon* HexagonGrid::_atCube(int x, int z)
+    {
+        // inverse of Hexagon::cubeX() and cubeZ()
+        const int column = z - (int)_region.left;
+        if (column < 0 || column >= (int)_region.width) {
+            return nullptr;
+        }
+        const int row = x + (z + (z & 1)) / 2 - (int)_region.top;
+        if (row < 0 || row >= (int)_region.height) {
+            return nullptr;
+        }
+        return &_hexagons[row * _region.width + column];
+    }
+
+    void HexagonGrid::initLight(Hexagon *hex, bool add, const std::vector<bool>* region)
     {
+        // blocking is still traced through the whole cone, only the light of hexes outside the region is kept
+        auto inRegion = [region](Hexagon* target) -> bool
+        {
+            return !region || (*region)[target->index()];
+        };
+
         auto objectsAtHex = hex->objects();
         for (auto it = objectsAtHex->begin(); it != objectsAtHex->end(); ++it)
         {
@@ -310,51 +754,43 @@ namespace Falltergeist
                 auto isBlocked = [&blocked](int coneIdx, int radius, int dir) -> bool
                 {
                     dir = dir % 6;
-                    int base = 0;
-                    int r = radius;
-                    while (r>0)
-                    {
-                        base+=(r-1)*6;
-                        r--;
-                    }
-
-                    return blocked[base+coneIdx+radius*dir];
+                    return blocked[ringStart(radius)+coneIdx+radius*dir];
                 };
 
                 auto index = [](int coneIdx, int radius, int dir) -> int
                 {
                     dir = dir % 6;
-                    int base = 0;
-                    int r = radius;
-                    while (r>0)
-                    {
-                        base+=(r-1)*6;
-                        r--;
-                    }
-
-
-                    return base+coneIdx+radius*dir;
+                    return ringStart(radius)+coneIdx+radius*dir;
                 };
 
                 int light = object->lightIntensity();
-                if (add)
+                if (inRegion(hex))
                 {
-                    hex->addLight(light);
-                }
-                else
-                {
-                    hex->subLight(light);
+                    if (add)
+                    {
+                        hex->addLight(light);
+                    }
+                    else
+                    {
+                        hex->subLight(light);
+                    }
                 }
                 int perRadius = (light - 655) / (object->lightRadius()+1);
 
                 int blockerIndex = 0;
+                // until something blocks, no rule can block either
+                bool anyBlocked = false;
 
-                for (unsigned int radius = 1; radius<= object->lightRadius();radius++)
+                const int cubeX = hex->cubeX();
+                const int cubeZ = hex->cubeZ();
+                const unsigned int lightRadius = std::min(object->lightRadius(), MAX_LIGHT_RADIUS);
+                for (unsigned int radius = 1; radius<= lightRadius;radius++)
                 {
                     light-=perRadius;
                     int ringIndex=0;
-                    for (auto ringhex : ring(hex,radius))
+                    for (unsigned int offset = ringStart(radius); offset != ringStart(radius + 1); ++offset)
                     {
+                        Hexagon* ringhex = _atCube(cubeX + RING_OFFSETS.offsets[offset].x, cubeZ + RING_OFFSETS.offsets[offset].z);
                         if (!ringhex) //invalid hex
                         {
                             ringIndex++;
@@ -366,7 +802,7 @@ namespace Falltergeist
                         int coneIdx = ringIndex % radius;
 
                         bool block = false;
-                        switch (radius)
+                        switch (anyBlocked ? radius : 1)
                         {
                             case 1:
                                 block = false;
@@ -591,9 +1027,10 @@ namespace Falltergeist
 
                         if (!block)
                         {
-                            // find objs/walls
+                            // find objs/walls, only hexes marked in the light-block bitset have any
                             bool lightHex = true;
-                            for (auto it2 = ringhex->objects()->begin(); it2 != ringhex->objects()->end(); ++it2)
+                            bool hasBlockers = !canLightThru(ringhex);
+                            for (auto it2 = ringhex->objects()->begin(); hasBlockers && it2 != ringhex->objects()->end(); ++it2)
                             {
                                 auto curObject = *it2;
                                 // dead objects block nothing
@@ -651,7 +1088,7 @@ namespace Falltergeist
                                 }
 
                             }
-                            if (lightHex)
+                            if (lightHex && inRegion(ringhex))
                             {
                                 if (add) {
                                     ringhex->addLight(light);
@@ -663,6 +1100,7 @@ namespace Falltergeist
                         }
 
                         blocked[blockerIndex] = block;
+                        anyBlocked = anyBlocked || block;
                         ringIndex++;
                         blockerIndex++;
                     }
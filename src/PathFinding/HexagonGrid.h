@@ -1,35 +1,174 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include "../Base/Iterators.h"
 #include "../Graphics/Point.h"
 
-#define GRID_WIDTH 200
-#define GRID_HEIGHT 200
-
 namespace Falltergeist
 {
+    class ClusterMap;
+    class DistanceField;
     class Hexagon;
 
     class HexagonGrid
     {
-        using HexagonVector = std::vector<std::unique_ptr<Hexagon>>;
+        using HexagonVector = std::vector<Hexagon>;
 
         public:
+            // Hexagons of maps are numbered row by row, row * MAP_COLUMNS + column
+            static const unsigned int MAP_COLUMNS = 200;
+            static const unsigned int MAP_ROWS = 200;
+
+            // Columns and rows of the map a grid is made of
+            struct Region
+            {
+                unsigned int left = 0;
+                unsigned int top = 0;
+                unsigned int width = MAP_COLUMNS;
+                unsigned int height = MAP_ROWS;
+            };
+
+            // Smallest region with the hexagons of the numbers and the hexagons under the screen points,
+            // grown by margin hexagons on every side. The whole map if there are none
+            static Region cover(const std::vector<unsigned int>& numbers, const std::vector<Graphics::Point>& points, unsigned int margin);
+
+            // Grid of the whole map
             HexagonGrid();
+            explicit HexagonGrid(const Region& region);
             ~HexagonGrid();
-            Base::vector_ptr_decorator<Hexagon> hexagons();
+            Base::vector_value_decorator<Hexagon> hexagons();
+
+            const Region& region() const;
+            // Number of hexagons, Hexagon::index() is below it
+            size_t size() const;
 
-            unsigned int distance(Hexagon* from, Hexagon* to);
+            // Cube coordinates of many hexagons, one array per axis, so distances() runs over them lane by lane.
+            // y follows from x + y + z = 0
+            struct CubeCoordinates
+            {
+                std::vector<int32_t> x;
+                std::vector<int32_t> z;
+
+                void add(Hexagon* hexagon);
+                void clear();
+                size_t size() const;
+            };
+
+            // Called with the found path, empty if there is none
+            using PathCallback = std::function<void(std::vector<Hexagon*>& path)>;
+
+            unsigned int distance(Hexagon* from, Hexagon* to) const;
+            // Distances from the hexagon to each of the coordinates, written into result in their order
+            void distances(Hexagon* from, const CubeCoordinates& to, std::vector<unsigned int>& result) const;
             Hexagon* hexagonAt(const Graphics::Point& pos);
-            Hexagon* at(size_t index);
+            // Hexagon with the number, nullptr if it's outside of the region
+            Hexagon* at(size_t number);
+            // Hexagon with the Hexagon::index()
+            Hexagon* atIndex(size_t index);
             std::vector<Hexagon*> findPath(Hexagon* from, Hexagon* to);
+            // Writes the path into the given buffer, destination first and without the starting hexagon
+            // Long routes are found through the cluster map, so they are not always the shortest ones
+            bool findPath(Hexagon* from, Hexagon* to, std::vector<Hexagon*>& path);
+            // Queues a search for the next solvePaths() call, owner is only used to cancel it
+            void queuePath(Hexagon* from, Hexagon* to, unsigned int maxCost, const void* owner, PathCallback callback);
+            void cancelPaths(const void* owner);
+            // Solves the queued searches in parallel against a copy of the walk bitset, callbacks run on the calling thread
+            void solvePaths();
+            // Distance field towards the target standing at the hexagon, shared by everyone chasing the same target
+            DistanceField& distanceField(const void* target, Hexagon* hexagon);
+            // Hexagons the walker standing at the hexagon reaches within maxCost steps (its action points), with their costs.
+            // Kept for each walker and computed again only when it moved, maxCost changed or walkability changed,
+            // so cursor feedback and combat decisions are lookups
+            const DistanceField& reachable(const void* walker, Hexagon* hexagon, unsigned int maxCost);
+            // Drops the distance field and the reachable area of the object
+            void forgetDistanceField(const void* target);
             Hexagon* hexInDirection(Hexagon* from, unsigned short rotation, unsigned int distance);
             std::vector<Hexagon*> ring(Hexagon* from, unsigned int radius);
-            void initLight(Hexagon* hex, bool add = true);
+            // Writes the ring into the buffer instead, nullptr for hexagons off the grid. Rings with a radius up to 20
+            // come from a table of offsets, larger ones are stepped around
+            void ring(Hexagon* from, unsigned int radius, std::vector<Hexagon*>& result);
+            // Recomputes the blocking bits of the hexagon, has to be called whenever its objects or their flags change
+            void updateBlocking(Hexagon* hexagon);
+            bool canWalkThru(Hexagon* hexagon) const;
+            bool canLightThru(Hexagon* hexagon) const;
+            bool canShootThru(Hexagon* hexagon) const;
+            // Lines of sight and fire, only the hexagons between the ends are checked
+            bool canSee(Hexagon* from, Hexagon* to);
+            bool canShoot(Hexagon* from, Hexagon* to);
+            // Changes whenever a walk bit changes
+            unsigned int walkVersion() const;
+            // One bit per hexagon by Hexagon::index(), set if a wall or blocking scenery (closed doors too) stands on it.
+            // Kept by updateBlocking() for the automap, critters and items are left out
+            const std::vector<uint64_t>& wallBits() const;
+            const std::vector<uint64_t>& sceneryBits() const;
+            // Applies light of the objects at hex, only to hexes marked in region (indexed by Hexagon::index()) if it is given
+            void initLight(Hexagon* hex, bool add = true, const std::vector<bool>* region = nullptr);
 
         protected:
-            HexagonVector _hexagons; // The 200x200 grid
+            Region _region;
+            HexagonVector _hexagons; // the hexagons of the region, row by row
+            // per hexagon data kept densely, indexed by Hexagon::index()
+            std::vector<Graphics::Point> _positions;
+            std::vector<unsigned int> _lights;
+            // last hexagonAt() result, hexagons never move so it stays valid
+            Graphics::Point _hoverPosition;
+            Hexagon* _hoverHexagon = nullptr;
+            bool _hoverValid = false;
+            // one bit per hexagon, set if any object on it blocks walking, light or projectiles
+            std::vector<uint64_t> _walkBlocked;
+            std::vector<uint64_t> _lightBlocked;
+            std::vector<uint64_t> _shootBlocked;
+            std::vector<uint64_t> _wallBits;
+            std::vector<uint64_t> _sceneryBits;
+
+        private:
+            friend class Hexagon;
+
+            struct PathRequest
+            {
+                Hexagon* from;
+                Hexagon* to;
+                unsigned int maxCost;
+                const void* owner;
+                PathCallback callback;
+                std::vector<Hexagon*> path;
+            };
+
+            std::vector<PathRequest> _pathRequests;
+            // batch of solvePaths() which is being delivered
+            std::vector<PathRequest> _solvingPaths;
+            // abstraction for routes the bounded search can't find
+            std::unique_ptr<ClusterMap> _clusterMap;
+            std::unordered_map<const void*, std::unique_ptr<DistanceField>> _distanceFields;
+            std::unordered_map<const void*, std::unique_ptr<DistanceField>> _reachableAreas;
+            unsigned int _walkVersion = 0;
+
+            struct RayStep
+            {
+                int x;
+                int z;
+            };
+
+            // cube offsets of the hexagons between the ends of a line, by the offset of its end
+            // Only lines up to RAY_CACHE_DISTANCE are kept, a few thousand at most, longer ones are traced into _longRay
+            std::unordered_map<uint32_t, std::vector<RayStep>> _rays;
+            std::vector<RayStep> _longRay;
+
+            // Hexagon at the cube coordinates, nullptr if it's off the grid
+            Hexagon* _atCube(int x, int z);
+
+            bool _traceLine(const std::vector<uint64_t>& blocked, Hexagon* from, Hexagon* to);
+            const std::vector<RayStep>& _ray(int dx, int dz);
+
+            // findPath() without the metrics
+            bool _findPath(Hexagon* from, Hexagon* to, std::vector<Hexagon*>& path);
+
+            // Only reads the grid, batched searches run it on the workers
+            bool _search(const std::vector<uint64_t>& walkBlocked, Hexagon* from, Hexagon* to, unsigned int maxCost, std::vector<Hexagon*>& path);
     };
 }
@@ -0,0 +1,10 @@
+#include "../PathFinding/SearchContext.h"
+
+namespace Falltergeist
+{
+    SearchContext& SearchContext::current()
+    {
+        thread_local SearchContext context;
+        return context;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Falltergeist
+{
+    /**
+     * Scratch memory of the A* searches, allocated once per thread and reused by every search
+     * Hexagons are marked with the generation of the search which reached them, so nothing is cleared between searches
+     */
+    class SearchContext final
+    {
+        public:
+            // Context of the calling thread
+            static SearchContext& current();
+
+            void reset(size_t size)
+            {
+                if (_nodes.size() != size) {
+                    _nodes.assign(size, Node());
+                    _generation = 0;
+                }
+                if (++_generation == 0) {
+                    // stamps wrapped around, old marks could look current
+                    std::fill(_nodes.begin(), _nodes.end(), Node());
+                    _generation = 1;
+                }
+                _open.clear();
+            }
+
+            bool reached(unsigned int index) const
+            {
+                return _nodes[index].generation == _generation;
+            }
+
+            void reach(unsigned int index, unsigned int cameFrom, unsigned int cost)
+            {
+                _nodes[index] = {_generation, cameFrom, cost};
+            }
+
+            unsigned int cost(unsigned int index) const
+            {
+                return _nodes[index].cost;
+            }
+
+            unsigned int cameFrom(unsigned int index) const
+            {
+                return _nodes[index].cameFrom;
+            }
+
+            // open set ordered by f-cost, then by hexagon number
+            void push(unsigned int fCost, unsigned int index)
+            {
+                _open.push_back((static_cast<uint64_t>(fCost) << 32) | index);
+                std::push_heap(_open.begin(), _open.end(), std::greater<uint64_t>());
+            }
+
+            bool pop(unsigned int& fCost, unsigned int& index)
+            {
+                if (_open.empty()) {
+                    return false;
+                }
+                std::pop_heap(_open.begin(), _open.end(), std::greater<uint64_t>());
+                fCost = static_cast<unsigned int>(_open.back() >> 32);
+                index = static_cast<unsigned int>(_open.back());
+                _open.pop_back();
+                _popped++;
+                return true;
+            }
+
+            // Entries taken from the open set by all searches of the thread so far
+            uint64_t popped() const
+            {
+                return _popped;
+            }
+
+        private:
+            struct Node
+            {
+                uint32_t generation;
+                uint32_t cameFrom;
+                uint32_t cost;
+            };
+
+            std::vector<Node> _nodes;
+            std::vector<uint64_t> _open;
+            uint32_t _generation = 0;
+            uint64_t _popped = 0;
+    };
+}
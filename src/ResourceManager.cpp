@@ -1,8 +1,12 @@
-﻿#include <fstream>
+﻿#include <algorithm>
+#include <filesystem>
+#include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <locale>
 #include <memory>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <SDL_image.h>
 #include "CrossPlatform.h"
@@ -10,7 +14,6 @@
 #include "Format/Acm/File.h"
 #include "Format/Bio/File.h"
 #include "Format/Dat/Stream.h"
-#include "Format/Dat/File.h"
 #include "Format/Dat/Item.h"
 #include "Format/Fon/File.h"
 #include "Format/Frm/File.h"
@@ -21,6 +24,7 @@
 #include "Format/Lst/File.h"
 #include "Format/Map/File.h"
 #include "Format/Msg/File.h"
+#include "Format/Msk/File.h"
 #include "Format/Mve/File.h"
 #include "Format/Pal/File.h"
 #include "Format/Pro/File.h"
@@ -30,17 +34,30 @@
 #include "Format/Txt/CSVBasedFile.h"
 #include "Format/Txt/MapsFile.h"
 #include "Format/Txt/WorldmapFile.h"
+#include "FrameStats.h"
+#include "Game/Game.h"
 #include "Game/Location.h"
 #include "Graphics/Font.h"
 #include "Graphics/Font/AAF.h"
 #include "Graphics/Font/FON.h"
+#include "Graphics/HitMask.h"
+#include "Graphics/Renderer.h"
 #include "Graphics/Texture.h"
+#include "Graphics/TextureAtlas.h"
+#include "Graphics/TexturePack.h"
 #include "Graphics/Shader.h"
 #include "Logger.h"
+#include "Metrics.h"
 #include "ResourceManager.h"
+#include "Trace.h"
 #include "Ini/File.h"
+#include "VFS/AsyncReader.h"
 #include "VFS/DatArchiveDriver.h"
+#include "VFS/DatArchiveIndex.h"
+#include "VFS/MappedDatArchiveDriver.h"
 #include "VFS/NativeDriver.h"
+#include "VFS/PackedArchiveDriver.h"
+#include "VFS/OverlayDriver.h"
 #include "VFS/MemoryDriver.h"
 
 namespace Falltergeist {
@@ -50,21 +67,173 @@ namespace Falltergeist {
         Pro::File *fetchProFileType(unsigned int PID) {
             return ResourceManager::getInstance()->proFileType(PID);
         }
+
+        // Set by ResourceManager::RequestScope
+        thread_local ResourcePriority currentPriority = ResourcePriority::VISIBLE;
+
+        thread_local unsigned int currentOwner = 0;
+
+        // Items which consume their stream progressively are loaded from DAT files in streamed mode
+        template<class T>
+        struct IsStreamedItem : std::false_type {};
+
+        template<>
+        struct IsStreamedItem<Acm::File> : std::true_type {};
+
+        template<>
+        struct IsStreamedItem<Mve::File> : std::true_type {};
+
+        template<class T>
+        T *castDatFileItem(const std::string &filename, Dat::Item *item) {
+            if (item == nullptr) {
+                return nullptr;
+            }
+            auto itemPtr = dynamic_cast<T *>(item);
+            if (itemPtr == nullptr) {
+                Logger::error("RESOURCE MANAGER") << "Requested file type does not match type in the cache: "
+                                                  << filename << std::endl;
+            }
+            return itemPtr;
+        }
+
+        // Integer keys of _idSlots, the kind of the ID is kept in the upper half
+        enum class IdKind : uint64_t
+        {
+            FRM = 1,
+            PRO,
+            INT
+        };
+
+        uint64_t idKey(IdKind kind, uint32_t id) {
+            return (static_cast<uint64_t>(kind) << 32) | id;
+        }
+
+        // Counts a lookup of the cache as resources.<extension>.<outcome>, the caller checks Metrics::enabled()
+        void countLookup(const std::string &filename, const char *outcome) {
+            auto dot = filename.rfind('.');
+            std::string type = dot == std::string::npos ? "other" : filename.substr(dot + 1);
+            Metrics::counter("resources." + type + "." + outcome).add();
+        }
+
+        const std::string EMPTY_NAME;
+
+        // sprites are at most a few hundred pixels, larger atlas pages only take memory
+        const int32_t ATLAS_PAGE_SIZE = 2048;
+
+        // Prototype directories and lists by OBJECT_TYPE
+        const struct {
+            const char *directory;
+            const char *listFile;
+        } PROTO_TYPES[] =
+            {
+                {"proto/items/",    "items.lst"},
+                {"proto/critters/", "critters.lst"},
+                {"proto/scenery/",  "scenery.lst"},
+                {"proto/walls/",    "walls.lst"},
+                {"proto/tiles/",    "tiles.lst"},
+                {"proto/misc/",     "misc.lst"},
+            };
     }
 
     ResourceManager::ResourceManager() {
         auto vfsLogger = std::make_shared<Logger>("VFS");
         _vfs = std::make_unique<VFS::VFS>(vfsLogger);
 
+        // Directory indexes of DAT files are cached between runs
+        _cachePath = CrossPlatform::getConfigPath() + "/cache";
+        try {
+            CrossPlatform::createDirectory(_cachePath);
+        } catch (const std::runtime_error& e) {
+            Logger::warning("RESOURCE MANAGER") << "Can't create index cache directory " << _cachePath << ": " << e.what() << std::endl;
+            _cachePath.clear();
+        }
+
+        // Loose files take precedence over DAT files: Fallout data directory first, then Falltergeist data directory.
+        // Fallout data directory holds mods and patches, changed files are picked up while the game is running.
+        auto overlay = std::make_unique<VFS::OverlayDriver>(CrossPlatform::findFalloutDataPath(), vfsLogger);
+        overlay->setChangeHandler([this](const std::string& path) {
+            _vfs->invalidate(path);
+            std::lock_guard<std::mutex> lock(_datItemsMutex);
+            _changedItems.insert(path);
+        });
+        auto native = std::make_unique<VFS::NativeDriver>(CrossPlatform::findFalltergeistDataPath(), vfsLogger, true);
+        _looseDrivers = {overlay.get(), native.get()};
+        _vfs->addMount("", std::move(overlay));
+        _vfs->addMount("", std::move(native));
+
+        // Archives are indexed and mapped concurrently, but mounted in the original order which decides precedence
+        struct DatArchive {
+            std::unique_ptr<VFS::IDriver> driver;
+            std::string stamp;
+        };
+        std::vector<std::future<DatArchive>> archives;
         for (auto filename : CrossPlatform::findFalloutDataFiles()) {
             std::string path = CrossPlatform::findFalloutDataPath() + "/" + filename;
-            _datFiles.push_back(std::make_unique<Dat::File>(path));
-            _vfs->addMount("", std::make_unique<VFS::DatArchiveDriver>(path));
+            std::string indexCachePath = _cachePath.empty() ? "" : _cachePath + "/" + filename + ".idx";
+            std::string packPath = packedArchivePath(filename);
+            archives.push_back(std::async(std::launch::async, [filename, path, indexCachePath, packPath]() {
+                DatArchive archive;
+                std::error_code error;
+                archive.stamp = filename + ":" + std::to_string(std::filesystem::file_size(path, error))
+                    + ":" + std::to_string(std::filesystem::last_write_time(path, error).time_since_epoch().count()) + ";";
+
+                // archives repacked by falltergeist --repack-data are read instead while the DAT file stays the same
+                if (!packPath.empty()) {
+                    archive.driver = VFS::PackedArchiveDriver::open(packPath, path);
+                    if (archive.driver) {
+                        return archive;
+                    }
+                }
+
+                auto index = VFS::DatArchiveIndex::load(path, indexCachePath);
+                try {
+                    archive.driver = std::make_unique<VFS::MappedDatArchiveDriver>(path, index);
+                } catch (const Exception& e) {
+                    Logger::warning("RESOURCE MANAGER") << e.what() << ", falling back to stream based DAT reader" << std::endl;
+                    archive.driver = std::make_unique<VFS::DatArchiveDriver>(path, index);
+                }
+                return archive;
+            }));
+        }
+
+        std::string dataFiles;
+        for (auto& pending : archives) {
+            auto archive = pending.get();
+            dataFiles += archive.stamp;
+            _vfs->addMount("", std::move(archive.driver));
         }
 
-        std::string falltergeistDataPath = CrossPlatform::findFalltergeistDataPath() + "/data";
-        _vfs->addMount("data", std::make_unique<VFS::NativeDriver>(falltergeistDataPath, vfsLogger));
-        _vfs->addMount("cache", std::make_unique<VFS::MemoryDriver>());
+        _dataStamp = VFS::DatArchiveIndex::hash(dataFiles);
+
+        if (!_cachePath.empty()) {
+            _texturePack = Graphics::TexturePack::open(texturePackPath(), _dataStamp);
+            if (_texturePack) {
+                Logger::info("RESOURCE MANAGER") << "Using " << _texturePack->size() << " baked textures from " << texturePackPath() << std::endl;
+            }
+        }
+
+        auto memoryDriver = std::make_unique<VFS::MemoryDriver>();
+        _evictedItems = memoryDriver.get();
+        _evictedItems->setCompressedBudget(_cacheBudget / 4);
+        _vfs->addMount("cache", std::move(memoryDriver));
+
+        // Leave one core to the main loop, loading is mostly bound by I/O and inflating anyway
+        unsigned int loaderThreads = std::thread::hardware_concurrency();
+        loaderThreads = loaderThreads > 1 ? std::min(loaderThreads - 1, 4u) : 1;
+        _scheduler = std::make_unique<ResourceScheduler>(loaderThreads);
+
+        _asyncReader = VFS::AsyncReader::create(64);
+        Logger::info("RESOURCE MANAGER") << "Reading loose files with " << _asyncReader->name() << std::endl;
+    }
+
+    ResourceManager::RequestScope::RequestScope(ResourcePriority priority, unsigned int owner) : _priority(currentPriority), _owner(currentOwner) {
+        currentPriority = priority;
+        currentOwner = owner;
+    }
+
+    ResourceManager::RequestScope::~RequestScope() {
+        currentPriority = _priority;
+        currentOwner = _owner;
     }
 
 // static
@@ -72,68 +241,288 @@ namespace Falltergeist {
         return Base::Singleton<ResourceManager>::get();
     }
 
-    void ResourceManager::_loadStreamForFile(std::string filename, std::function<void(Dat::Stream &&)> callback) {
-        // Searching file in Fallout data directory
-        {
-            std::string path = CrossPlatform::findFalloutDataPath() + "/" + filename;
+    void ResourceManager::_loadStreamForFile(std::string filename, std::function<void(Dat::Stream &&)> callback, bool streamed, std::shared_ptr<VFS::IFile> file) {
+        if (!file) {
+            file = _evictedItems->openCompressed(filename);
+        }
+        if (!file) {
+            file = _vfs->open(filename, VFS::IFile::OpenMode::Read);
+        }
+        if (!file || !file->isOpened()) {
+            Logger::error("RESOURCE MANAGER") << "Loading file: " << filename << " [ NOT FOUND]" << std::endl;
+            return;
+        }
 
-            std::ifstream stream;
-            stream.open(path, std::ios_base::binary);
-            if (stream.is_open()) {
-                Logger::debug("RESOURCE MANAGER") << "Loading file: " << filename << " [FROM FALLOUT DATA DIR]" << std::endl;
-            } else {
-                path = CrossPlatform::findFalltergeistDataPath() + "/" + filename;
-                stream.open(path, std::ios_base::binary);
-                if (stream.is_open()) {
-                    Logger::debug("RESOURCE MANAGER") << "Loading file: " << filename << " [FROM FALLTERGEIST DATA DIR]"
-                                                      << std::endl;
-                }
+        Logger::debug("RESOURCE MANAGER") << "Loading file: " << filename << std::endl;
+        callback(Dat::Stream(file, streamed ? Dat::Stream::Mode::Streamed : Dat::Stream::Mode::Buffered));
+    }
+
+    template<class T>
+    T *ResourceManager::_datFileItem(std::string filename) {
+        std::transform(filename.begin(), filename.end(), filename.begin(), ::tolower);
+
+        Base::StringId name(filename);
+
+        std::unique_lock<std::mutex> lock(_datItemsMutex);
+        _recordManifest(filename);
+
+        // Return item from cache
+        auto itemIt = _datItems.find(name);
+        if (itemIt != _datItems.end()) {
+            itemIt->second.lastUse = ++_useCounter;
+            if (Metrics::enabled()) {
+                countLookup(filename, "hits");
             }
+            return castDatFileItem<T>(filename, itemIt->second.resource.get());
+        }
 
-            if (stream.is_open()) {
-                callback(Dat::Stream(stream));
-                stream.close();
-                return;
+        // Wait for the item which is already being loaded in the background, a cancelled load is replaced by loading it here
+        auto pendingIt = _pendingItems.find(name);
+        if (pendingIt != _pendingItems.end() && _scheduler && _scheduler->retain(pendingIt->second.ticket, ResourcePriority::NOW, 0)) {
+            auto pending = pendingIt->second;
+            lock.unlock();
+            // requested before it was needed, whether it finished in time or not
+            if (Metrics::enabled()) {
+                countLookup(filename, "prefetched");
             }
+            // a queued load doesn't wait for the ones before it, on a loader thread this also keeps all of them from waiting on each other
+            _scheduler->runNow(pending.ticket);
+            return castDatFileItem<T>(filename, pending.future.get().get());
         }
 
-        // Search in DAT files
-        for (auto &datfile : _datFiles) {
-            auto entry = datfile->entry(filename);
-            if (entry != nullptr) {
-                Logger::debug("RESOURCE MANAGER") << "Loading file: " << filename << " [FROM " << datfile->filename()
-                                                  << "]" << std::endl;
-                callback(Dat::Stream(*entry));
-                return;
+        lock.unlock();
+        if (Metrics::enabled()) {
+            countLookup(filename, "misses");
+        }
+        size_t size = 0;
+        auto item = _createDatFileItem<T>(filename, size);
+        lock.lock();
+        return castDatFileItem<T>(filename, _cacheDatFileItem(filename, std::move(item), size));
+    }
+
+    template<class T>
+    T *ResourceManager::_idFileItem(uint64_t key, const std::string &filename) {
+        {
+            std::lock_guard<std::mutex> lock(_datItemsMutex);
+            auto slotIt = _idSlots.find(key);
+            if (slotIt != _idSlots.end() && slotIt->second.generation == _cacheGeneration) {
+                if (_manifestThread.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+                    std::string lowerFilename = filename;
+                    std::transform(lowerFilename.begin(), lowerFilename.end(), lowerFilename.begin(), ::tolower);
+                    _recordManifest(lowerFilename);
+                }
+                slotIt->second.entry->lastUse = ++_useCounter;
+                if (Metrics::enabled()) {
+                    countLookup(filename, "hits");
+                }
+                return castDatFileItem<T>(filename, slotIt->second.entry->resource.get());
             }
         }
-        Logger::error("RESOURCE MANAGER") << "Loading file: " << filename << " [ NOT FOUND]" << std::endl;
+
+        auto item = _datFileItem<T>(filename);
+        if (item == nullptr) {
+            return nullptr;
+        }
+
+        std::string lowerFilename = filename;
+        std::transform(lowerFilename.begin(), lowerFilename.end(), lowerFilename.begin(), ::tolower);
+
+        // Items which failed to load are not cached, they are looked up by name again next time
+        std::lock_guard<std::mutex> lock(_datItemsMutex);
+        auto itemIt = _datItems.find(Base::StringId(lowerFilename));
+        if (itemIt != _datItems.end()) {
+            _idSlots[key] = {_cacheGeneration, &itemIt->second};
+        }
+        return item;
+    }
+
+    const std::vector<std::string> &ResourceManager::_names(NameTable &table, const std::string &directory, const std::string &listFile) {
+        std::call_once(table.built, [&]() {
+            auto lst = lstFileType(directory + listFile);
+            if (lst == nullptr) {
+                return;
+            }
+            table.names.reserve(lst->strings()->size());
+            for (auto &name : *lst->strings()) {
+                table.names.push_back(directory + name);
+            }
+        });
+        return table.names;
     }
 
     template<class T>
-    T *ResourceManager::_datFileItem(std::string filename) {
+    ResourceRequest<T> ResourceManager::_requestDatFileItem(std::string filename) {
+        // Loader threads are gone after shutdown
+        if (!_scheduler) {
+            std::promise<std::shared_ptr<Dat::Item>> loaded;
+            loaded.set_value(_pinDatFileItem(_datFileItem<T>(filename)));
+            return ResourceRequest<T>(loaded.get_future().share());
+        }
+
         std::transform(filename.begin(), filename.end(), filename.begin(), ::tolower);
+        Base::StringId name(filename);
 
-        // Return item from cache
-        auto itemIt = _datItems.find(filename);
+        std::lock_guard<std::mutex> lock(_datItemsMutex);
+
+        auto itemIt = _datItems.find(name);
         if (itemIt != _datItems.end()) {
-            auto itemPtr = dynamic_cast<T *>(itemIt->second.get());
-            if (itemPtr == nullptr) {
-                Logger::error("RESOURCE MANAGER") << "Requested file type does not match type in the cache: "
-                                                  << filename << std::endl;
+            itemIt->second.lastUse = ++_useCounter;
+            std::promise<std::shared_ptr<Dat::Item>> cached;
+            cached.set_value(itemIt->second.resource);
+            return ResourceRequest<T>(cached.get_future().share());
+        }
+
+        auto pendingIt = _pendingItems.find(name);
+        if (pendingIt != _pendingItems.end()) {
+            if (_scheduler->retain(pendingIt->second.ticket, currentPriority, currentOwner)) {
+                return ResourceRequest<T>(pendingIt->second.future, pendingIt->second.ticket);
             }
-            return itemPtr;
+            // the load was cancelled for its owner, this request queues it again
+            _pendingItems.erase(pendingIt);
         }
 
-        T *itemPtr = nullptr;
-        _loadStreamForFile(filename, [this, &filename, &itemPtr](Dat::Stream &&stream) {
-            auto item = std::make_unique<T>(std::move(stream));
-            itemPtr = item.get();
-            item->setFilename(filename);
-            _datItems.emplace(filename, std::move(item));
+        // The job can't finish before it is registered as pending, it needs _datItemsMutex to do so
+        auto load = std::make_shared<PendingLoad>();
+        auto future = load->promise.get_future().share();
+        load->ticket = _submit(filename, [this, filename, load]() {
+            // loose files are read in the background, decoding doesn't wait behind other loads once they are in memory
+            bool reading = !IsStreamedItem<T>::value && _readAsync(filename, [this, filename, load](std::shared_ptr<VFS::IFile> file) {
+                RequestScope scope(ResourcePriority::NOW);
+                _submit(std::string(), [this, filename, load, file]() {
+                    _finishLoad<T>(filename, load, file);
+                }, nullptr);
+            });
+            if (!reading) {
+                _finishLoad<T>(filename, load, nullptr);
+            }
+        }, [this, name, load]() {
+            std::lock_guard<std::mutex> lock(_datItemsMutex);
+            _erasePending(name, load->ticket);
+            load->promise.set_value(nullptr);
         });
 
-        return itemPtr;
+        _pendingItems[name] = PendingItem{future, load->ticket};
+        return ResourceRequest<T>(future, load->ticket);
+    }
+
+    ResourceScheduler::Ticket ResourceManager::_submit(const std::string &filename, std::function<void()> job, std::function<void()> cancelled) {
+        ResourceScheduler::Place place;
+        const VFS::IDriver *driver = nullptr;
+        if (!filename.empty() && _vfs->locate(filename, driver, place.offset)) {
+            place.storage = driver;
+        }
+        auto priority = currentPriority;
+        auto owner = currentOwner;
+        return _scheduler->submit(priority, owner, place, [job = std::move(job), priority, owner]() {
+            // files requested by the job are needed as urgently as the job itself
+            RequestScope scope(priority, owner);
+            job();
+        }, std::move(cancelled));
+    }
+
+    void ResourceManager::_erasePending(const Base::StringId &name, ResourceScheduler::Ticket ticket) {
+        auto pendingIt = _pendingItems.find(name);
+        if (pendingIt != _pendingItems.end() && pendingIt->second.ticket == ticket) {
+            _pendingItems.erase(pendingIt);
+        }
+    }
+
+    void ResourceManager::_expedite(ResourceScheduler::Ticket ticket) {
+        if (_scheduler && _scheduler->retain(ticket, ResourcePriority::NOW, 0)) {
+            _scheduler->runNow(ticket);
+        }
+    }
+
+    template<class T>
+    std::unique_ptr<T> ResourceManager::_createDatFileItem(const std::string &filename, size_t &size, std::shared_ptr<VFS::IFile> file) {
+        Trace::Scope scope("ResourceManager::load", filename);
+        FrameStats::resource(filename);
+        static auto &loadTimes = Metrics::histogram("resources.load_ms");
+        const bool measured = Metrics::enabled();
+        auto started = measured ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        std::unique_ptr<T> item;
+        _loadStreamForFile(filename, [&filename, &item, &size](Dat::Stream &&stream) {
+            size = stream.size();
+            item = std::make_unique<T>(std::move(stream));
+            item->setFilename(filename);
+        }, IsStreamedItem<T>::value, std::move(file));
+        if (measured) {
+            loadTimes.record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count());
+        }
+        return item;
+    }
+
+    template<class T>
+    void ResourceManager::_finishLoad(const std::string &filename, std::shared_ptr<PendingLoad> load, std::shared_ptr<VFS::IFile> file) {
+        Base::StringId name(filename);
+        std::unique_ptr<T> item;
+        size_t size = 0;
+        try {
+            item = _createDatFileItem<T>(filename, size, std::move(file));
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(_datItemsMutex);
+            _erasePending(name, load->ticket);
+            load->promise.set_exception(std::current_exception());
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_datItemsMutex);
+        _erasePending(name, load->ticket);
+        if (!_cacheDatFileItem(filename, std::move(item), size)) {
+            load->promise.set_value(nullptr);
+            return;
+        }
+        load->promise.set_value(_datItems.at(name).resource);
+    }
+
+    bool ResourceManager::_readAsync(const std::string &filename, std::function<void(std::shared_ptr<VFS::IFile>)> callback) {
+        // copies of evicted files are in memory already
+        if (_evictedItems->exists(filename)) {
+            return false;
+        }
+        auto path = _vfs->nativePath(filename);
+        if (path.empty()) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(_asyncReaderMutex);
+        if (!_asyncReader) {
+            return false;
+        }
+        std::vector<VFS::AsyncReader::Request> requests;
+        requests.push_back({path, std::move(callback)});
+        _asyncReader->submit(std::move(requests));
+        return true;
+    }
+
+    Dat::Item *ResourceManager::_cacheDatFileItem(const std::string &filename, std::unique_ptr<Dat::Item> item, size_t size) {
+        if (!item) {
+            return nullptr;
+        }
+        // Somebody could have loaded the same file in the meantime, the first cached item wins
+        auto result = _datItems.emplace(Base::StringId(filename), CacheEntry<Dat::Item>());
+        auto &entry = result.first->second;
+        if (result.second) {
+            entry.resource = std::move(item);
+            entry.size = size;
+            _datItemsSize += size;
+            _cacheGrown = true;
+        }
+        entry.lastUse = ++_useCounter;
+        return entry.resource.get();
+    }
+
+    std::shared_ptr<Dat::Item> ResourceManager::_pinDatFileItem(Dat::Item *item) {
+        if (item == nullptr) {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(_datItemsMutex);
+        auto itemIt = _datItems.find(Base::StringId(item->filename()));
+        if (itemIt != _datItems.end() && itemIt->second.resource.get() == item) {
+            return itemIt->second.resource;
+        }
+        // Not owned by the cache, nothing to keep alive
+        return std::shared_ptr<Dat::Item>(item, [](Dat::Item *) {});
     }
 
     Frm::File *ResourceManager::frmFileType(const std::string &filename) {
@@ -161,6 +550,13 @@ namespace Falltergeist {
         return _datFileItem<Acm::File>(filename);
     }
 
+    std::unique_ptr<Acm::File> ResourceManager::acmFileStream(const std::string &filename) {
+        std::string name = filename;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        size_t size = 0;
+        return _createDatFileItem<Acm::File>(name, size);
+    }
+
     Fon::File *ResourceManager::fonFileType(const std::string &filename) {
         return _datFileItem<Fon::File>(filename);
     }
@@ -181,6 +577,10 @@ namespace Falltergeist {
         return _datFileItem<Msg::File>(filename);
     }
 
+    Msk::File *ResourceManager::mskFileType(const std::string &filename) {
+        return _datFileItem<Msk::File>(filename);
+    }
+
     Mve::File *ResourceManager::mveFileType(const std::string &filename) {
         return _datFileItem<Mve::File>(filename);
     }
@@ -209,6 +609,125 @@ namespace Falltergeist {
         return _datFileItem<Sve::File>(filename);
     }
 
+    ResourceRequest<Acm::File> ResourceManager::requestAcm(const std::string &filename) {
+        return _requestDatFileItem<Acm::File>(filename);
+    }
+
+    ResourceRequest<Aaf::File> ResourceManager::requestAaf(const std::string &filename) {
+        return _requestDatFileItem<Aaf::File>(filename);
+    }
+
+    ResourceRequest<Frm::File> ResourceManager::requestFrm(const std::string &filename) {
+        return _requestDatFileItem<Frm::File>(filename);
+    }
+
+    ResourceRequest<Int::File> ResourceManager::requestInt(const std::string &filename) {
+        return _requestDatFileItem<Int::File>(filename);
+    }
+
+    ResourceRequest<Lip::File> ResourceManager::requestLip(const std::string &filename) {
+        return _requestDatFileItem<Lip::File>(filename);
+    }
+
+    ResourceRequest<Lst::File> ResourceManager::requestLst(const std::string &filename) {
+        return _requestDatFileItem<Lst::File>(filename);
+    }
+
+    ResourceRequest<Msg::File> ResourceManager::requestMsg(const std::string &filename) {
+        return _requestDatFileItem<Msg::File>(filename);
+    }
+
+    ResourceRequest<Pal::File> ResourceManager::requestPal(const std::string &filename) {
+        return _requestDatFileItem<Pal::File>(filename);
+    }
+
+    ResourceRequest<Pro::File> ResourceManager::requestPro(const std::string &filename) {
+        return _requestDatFileItem<Pro::File>(filename);
+    }
+
+    ResourceRequest<Map::File> ResourceManager::preloadMap(const std::string &filename) {
+        // Loader threads are gone after shutdown
+        if (!_scheduler) {
+            std::promise<std::shared_ptr<Dat::Item>> loaded;
+            loaded.set_value(_pinDatFileItem(mapFileType(filename)));
+            return ResourceRequest<Map::File>(loaded.get_future().share());
+        }
+
+        _preloadJobs++;
+        auto load = std::make_shared<PendingLoad>();
+        auto future = load->promise.get_future().share();
+        auto ticket = _submit(filename, [this, filename, load]() {
+            struct Finished {
+                std::atomic<unsigned int>& jobs;
+                ~Finished() { jobs--; }
+            } finished{_preloadJobs};
+
+            try {
+                // Map::File::init() loads the prototypes, a concurrent mapFileType() waits for it
+                auto map = _pinDatFileItem(mapFileType(filename));
+                if (map) {
+                    requestMapResources(static_cast<Map::File*>(map.get()));
+                }
+                load->promise.set_value(map);
+            } catch (...) {
+                load->promise.set_exception(std::current_exception());
+            }
+        }, [this, load]() {
+            _preloadJobs--;
+            load->promise.set_value(nullptr);
+        });
+        return ResourceRequest<Map::File>(future, ticket);
+    }
+
+    void ResourceManager::requestMapResources(Map::File *map) {
+        // Map::File::init() needs the prototypes of items and scenery to read their records, so those are loaded
+        // while parsing. Walls, critters and misc objects only need theirs when the objects are created.
+        std::unordered_set<unsigned int> PIDs;
+        std::unordered_set<std::string> names;
+        auto addObject = [this, &PIDs, &names](Map::Object *object) {
+            PIDs.insert(object->PID());
+            // critter animations are picked by the critter helpers, from its armor and weapon
+            auto type = static_cast<FRM_TYPE>(object->FID() >> 24);
+            if (type != FRM_TYPE::CRITTER && type <= FRM_TYPE::INVENTORY) {
+                names.insert(FIDtoFrmName(object->FID()));
+            }
+        };
+        for (auto &elevation : map->elevations()) {
+            for (auto &object : elevation.objects()) {
+                addObject(object.get());
+                for (auto &child : object->children()) {
+                    addObject(child.get());
+                }
+            }
+        }
+
+        for (auto PID : PIDs) {
+            auto protoName = _proFileName(PID);
+            if (!protoName.empty()) {
+                requestPro(protoName);
+            }
+        }
+
+        auto tilesLst = lstFileType("art/tiles/tiles.lst");
+        if (tilesLst) {
+            for (auto &elevation : map->elevations()) {
+                for (auto tiles : {&elevation.floorTiles(), &elevation.roofTiles()}) {
+                    for (auto number : *tiles) {
+                        if (number < tilesLst->strings()->size()) {
+                            names.insert("art/tiles/" + tilesLst->strings()->at(number));
+                        }
+                    }
+                }
+            }
+        }
+
+        names.erase(std::string());
+        for (auto &name : names) {
+            // decoded by the other loader threads, the cache keeps the results
+            requestFrm(name);
+        }
+    }
+
     Txt::CityFile *ResourceManager::cityTxt() {
         return _datFileItem<Txt::CityFile>("data/city.txt");
     }
@@ -246,13 +765,20 @@ namespace Falltergeist {
     }
 
     Graphics::Texture *ResourceManager::texture(const std::string &filename) {
-        if (_textures.count(filename)) {
-            return _textures.at(filename).get();
+        Base::StringId name(filename);
+        auto textureIt = _textures.find(name);
+        if (textureIt != _textures.end()) {
+            textureIt->second.lastUse = ++_useCounter;
+            return textureIt->second.resource.get();
         }
 
+        Trace::Scope scope("ResourceManager::texture", filename);
+        FrameStats::resource(filename);
         std::string ext = filename.substr(filename.length() - 4);
 
         Graphics::Texture *texture = nullptr;
+        const void *data = nullptr;
+        Size size;
 
         if (ext == ".png") {
             auto file = vfs()->open(filename, VFS::IFile::OpenMode::Read);
@@ -278,12 +804,15 @@ namespace Falltergeist {
                     tempSurface2->pixels,
                     Size(tempSurface2->w, tempSurface2->h),
                     Graphics::Pixels::Format::RGBA
-                )
+                ),
+                true
             );
 
             SDL_FreeFormat(pixelFormat);
             SDL_FreeSurface(tempSurface);
             SDL_FreeSurface(tempSurface2);
+        } else if (ext == ".rix" && _bakedTexture(filename, Graphics::Pixels::Format::RGBA, data, size)) {
+            texture = new Graphics::Texture(Graphics::Pixels(data, size, Graphics::Pixels::Format::RGBA), true);
         } else if (ext == ".rix") {
             auto rix = rixFileType(filename);
             if (!rix) {
@@ -294,29 +823,59 @@ namespace Falltergeist {
                     rix->rgba(),
                     Size(rix->width(), rix->height()),
                     Graphics::Pixels::Format::RGBA
-                )
+                ),
+                true
             );
         } else if (ext == ".frm") {
-            auto frm = frmFileType(filename);
-            if (!frm) {
-                return nullptr;
+            // colors are looked up in the palette by shaders, so frames are uploaded as they are stored
+            std::vector<uint8_t> indexes;
+            std::shared_ptr<const Graphics::HitMask> mask;
+            if (_bakedTexture(filename, Graphics::Pixels::Format::Indexed, data, size)) {
+                mask = _hitMask(static_cast<const uint8_t*>(data), size);
+            } else {
+                auto frm = frmFileType(filename);
+                if (!frm) {
+                    return nullptr;
+                }
+                indexes = frm->indexes();
+                data = indexes.data();
+                size = Size(frm->width(), frm->height());
+                mask = frm->mask(palFileType("color.pal"));
             }
-            texture = new Graphics::Texture(
-                Graphics::Pixels(
-                    frm->rgba(palFileType("color.pal")),
-                    Size(frm->width(), frm->height()),
-                    Graphics::Pixels::Format::RGBA
-                )
-            );
-            texture->setMask(frm->mask(palFileType("color.pal")));
+            Graphics::Pixels pixels(data, size, Graphics::Pixels::Format::Indexed);
+
+            // sprites share atlas pages, so consecutive draws don't have to switch textures
+            if (!_textureAtlas) {
+                _textureAtlas = std::make_unique<Graphics::TextureAtlas>(
+                    static_cast<unsigned int>(std::min(ATLAS_PAGE_SIZE, Game::Game::getInstance()->renderer()->maxTextureSize())),
+                    Graphics::Pixels::Format::Indexed
+                );
+            }
+            texture = _textureAtlas->allocate(pixels, true).release();
+            if (!texture) {
+                texture = new Graphics::Texture(pixels, true);
+            }
+            texture->setMask(mask);
         } else {
             throw Exception("ResourceManager::surface() - unknown image type:" + filename);
         }
 
-        _textures.insert(make_pair(filename, std::unique_ptr<Graphics::Texture>(texture)));
+        auto &entry = _textures[name];
+        entry.resource.reset(texture);
+        entry.size = static_cast<size_t>(texture->size().width()) * texture->size().height() * Graphics::Pixels::bytesPerPixel(texture->format());
+        entry.lastUse = ++_useCounter;
+        _texturesSize += entry.size;
+        _cacheGrown = true;
         return texture;
     }
 
+    std::shared_ptr<Graphics::Texture> ResourceManager::pinTexture(const std::string &filename) {
+        if (!texture(filename)) {
+            return nullptr;
+        }
+        return _textures.at(Base::StringId(filename)).resource;
+    }
+
     Graphics::Font *ResourceManager::font(const std::string &filename) {
 
         if (_fonts.count(filename)) {
@@ -336,9 +895,34 @@ namespace Falltergeist {
     }
 
 
+    void ResourceManager::preloadShaders(const std::vector<std::string> &filenames) {
+        std::vector<std::pair<std::string, Graphics::Shader*>> submitted;
+        for (auto& filename : filenames) {
+            if (_shaders.count(filename)) {
+                continue;
+            }
+            auto shader = std::make_unique<Graphics::Shader>(filename, true);
+            submitted.emplace_back(filename, shader.get());
+            _shaders.emplace(filename, std::move(shader));
+        }
+
+        // Failed shaders must not stay in the cache unfinished
+        for (auto& it : submitted) {
+            try {
+                it.second->finish();
+            } catch (...) {
+                for (auto& failed : submitted) {
+                    _shaders.erase(failed.first);
+                }
+                throw;
+            }
+        }
+    }
+
     Graphics::Shader *ResourceManager::shader(const std::string &filename) {
-        if (_shaders.count(filename)) {
-            return _shaders.at(filename).get();
+        auto it = _shaders.find(filename);
+        if (it != _shaders.end()) {
+            return it->second.get();
         }
 
         Graphics::Shader *shader = new Graphics::Shader(filename);
@@ -349,62 +933,265 @@ namespace Falltergeist {
 
 
     Pro::File *ResourceManager::proFileType(unsigned int PID) {
+        if (!_prototypesRequested.exchange(true)) {
+            _requestPrototypes();
+        }
+
         unsigned int typeId = PID >> 24;
-        std::string listFile;
-        switch ((OBJECT_TYPE) typeId) {
-            case OBJECT_TYPE::ITEM:
-                listFile += "proto/items/items.lst";
-                break;
-            case OBJECT_TYPE::CRITTER:
-                listFile += "proto/critters/critters.lst";
-                break;
-            case OBJECT_TYPE::SCENERY:
-                listFile += "proto/scenery/scenery.lst";
-                break;
-            case OBJECT_TYPE::WALL:
-                listFile += "proto/walls/walls.lst";
-                break;
-            case OBJECT_TYPE::TILE:
-                listFile += "proto/tiles/tiles.lst";
-                break;
-            case OBJECT_TYPE::MISC:
-                listFile += "proto/misc/misc.lst";
-                break;
-            default:
-                Logger::error("") << "ResourceManager::proFileType(unsigned int) - wrong PID: " << PID << std::endl;
-                return nullptr;
+        unsigned int index = 0x00000FFF & PID;
+        if (typeId < _prototypes.size() && _prototypes[typeId].loaded.load(std::memory_order_acquire)) {
+            auto &prototypes = _prototypes[typeId].prototypes;
+            if (index > 0 && index <= prototypes.size() && prototypes[index - 1]) {
+                return castDatFileItem<Pro::File>(_proFileName(PID), prototypes[index - 1].get());
+            }
         }
 
-        auto lst = lstFileType(listFile);
+        const auto &protoName = _proFileName(PID);
+        if (protoName.empty()) {
+            return nullptr;
+        }
+        return _idFileItem<Pro::File>(idKey(IdKind::PRO, PID & 0x0F000FFF), protoName);
+    }
+
+    const std::string &ResourceManager::_proFileName(unsigned int PID) {
+        unsigned int typeId = PID >> 24;
+        if (typeId > static_cast<unsigned int>(OBJECT_TYPE::MISC)) {
+            Logger::error("") << "ResourceManager::proFileType(unsigned int) - wrong PID: " << PID << std::endl;
+            return EMPTY_NAME;
+        }
+
+        const auto &description = PROTO_TYPES[typeId];
+        const auto &names = _names(_proNames[typeId], description.directory, description.listFile);
 
         unsigned int index = 0x00000FFF & PID;
 
-        if (index > lst->strings()->size()) {
+        if (index == 0 || index > names.size()) {
             Logger::error("") << "ResourceManager::proFileType(unsigned int) - LST size < PID: " << PID << std::endl;
-            return nullptr;
+            return EMPTY_NAME;
         }
 
-        std::string protoName = lst->strings()->at(index - 1);
+        return names[index - 1];
+    }
 
-        switch ((OBJECT_TYPE) typeId) {
-            case OBJECT_TYPE::ITEM:
-                return proFileType("proto/items/" + protoName);
-            case OBJECT_TYPE::CRITTER:
-                return proFileType("proto/critters/" + protoName);
-            case OBJECT_TYPE::SCENERY:
-                return proFileType("proto/scenery/" + protoName);
-            case OBJECT_TYPE::WALL:
-                return proFileType("proto/walls/" + protoName);
-            case OBJECT_TYPE::TILE:
-                return proFileType("proto/tiles/" + protoName);
-            case OBJECT_TYPE::MISC:
-                return proFileType("proto/misc/" + protoName);
+    void ResourceManager::_requestPrototypes() {
+        // Loader threads are gone after shutdown, prototypes are parsed one by one on demand then
+        if (!_scheduler) {
+            return;
+        }
+
+        // every map needs them, whoever asked first can't cancel them
+        RequestScope scope(ResourcePriority::VISIBLE);
+
+        for (unsigned int typeId = 0; typeId != _prototypes.size(); ++typeId) {
+            // tile prototypes are not used by maps
+            if (typeId == static_cast<unsigned int>(OBJECT_TYPE::TILE)) {
+                continue;
+            }
+            auto done = std::make_shared<std::promise<void>>();
+            _prototypeJobs.push_back(done->get_future());
+            _submit("", [this, typeId, done]() {
+                try {
+                    const auto &names = _names(_proNames[typeId], PROTO_TYPES[typeId].directory, PROTO_TYPES[typeId].listFile);
+                    std::vector<std::shared_ptr<Dat::Item>> prototypes(names.size());
+                    for (size_t i = 0; i != names.size(); ++i) {
+                        prototypes[i] = _pinDatFileItem(_datFileItem<Pro::File>(names[i]));
+                    }
+                    _prototypes[typeId].prototypes = std::move(prototypes);
+                    _prototypes[typeId].loaded.store(true, std::memory_order_release);
+                    done->set_value();
+                } catch (...) {
+                    done->set_exception(std::current_exception());
+                }
+            }, [done]() {
+                done->set_value();
+            });
         }
-        return nullptr;
     }
 
     void ResourceManager::unloadResources() {
+        // Pending loads would hand out pointers to items which are about to be destroyed
+        std::vector<std::shared_future<std::shared_ptr<Dat::Item>>> pending;
+        {
+            std::lock_guard<std::mutex> lock(_datItemsMutex);
+            for (auto &it : _pendingItems) {
+                pending.push_back(it.second.future);
+            }
+        }
+        for (auto &future : pending) {
+            future.wait();
+        }
+
+        for (auto &job : _prototypeJobs) {
+            job.wait();
+        }
+        _prototypeJobs.clear();
+        for (auto &table : _prototypes) {
+            table.loaded = false;
+            table.prototypes.clear();
+        }
+        _prototypesRequested = false;
+
+        std::lock_guard<std::mutex> lock(_datItemsMutex);
         _datItems.clear();
+        _datItemsSize = 0;
+        ++_cacheGeneration;
+    }
+
+    void ResourceManager::trim() {
+        if (_preloadJobs > 0) {
+            return;
+        }
+        _dropChangedItems();
+
+        if (!_cacheGrown.exchange(false) || cacheSize() <= _cacheBudget) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_datItemsMutex);
+
+        // Resources nobody but the cache holds a pointer to, least recently used first
+        struct Candidate {
+            uint64_t lastUse;
+            Base::StringId name;
+            bool texture;
+        };
+        std::vector<Candidate> candidates;
+        for (auto &it : _datItems) {
+            if (it.second.resource.use_count() == 1) {
+                candidates.push_back({it.second.lastUse, it.first, false});
+            }
+        }
+        for (auto &it : _textures) {
+            if (it.second.resource.use_count() == 1) {
+                candidates.push_back({it.second.lastUse, it.first, true});
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate &lhs, const Candidate &rhs) {
+            return lhs.lastUse < rhs.lastUse;
+        });
+
+        size_t evicted = 0;
+        std::vector<std::string> evictedItems;
+        for (auto &candidate : candidates) {
+            if (_datItemsSize + _texturesSize <= _cacheBudget) {
+                break;
+            }
+            if (candidate.texture) {
+                auto textureIt = _textures.find(candidate.name);
+                _texturesSize -= textureIt->second.size;
+                _textures.erase(textureIt);
+            } else {
+                auto itemIt = _datItems.find(candidate.name);
+                // large files would push everything else out of the compressed copies
+                if (itemIt->second.size <= _cacheBudget / 32) {
+                    evictedItems.push_back(itemIt->second.resource->filename());
+                }
+                _datItemsSize -= itemIt->second.size;
+                _datItems.erase(itemIt);
+                ++_cacheGeneration;
+            }
+            evicted++;
+        }
+        _storeEvicted(evictedItems);
+
+        Logger::debug("RESOURCE MANAGER") << "Evicted " << evicted << " resources, "
+                                          << cacheSize() / 1024 << " KiB in cache" << std::endl;
+    }
+
+    void ResourceManager::_dropChangedItems() {
+        std::lock_guard<std::mutex> lock(_datItemsMutex);
+        for (auto it = _changedItems.begin(); it != _changedItems.end();) {
+            Base::StringId name(*it);
+            auto itemIt = _datItems.find(name);
+            auto textureIt = _textures.find(name);
+            bool itemPinned = itemIt != _datItems.end() && itemIt->second.resource.use_count() > 1;
+            bool texturePinned = textureIt != _textures.end() && textureIt->second.resource.use_count() > 1;
+
+            // Resources which are in use are dropped once they are released
+            _evictedItems->removeCompressed(*it);
+            if (!itemPinned && itemIt != _datItems.end()) {
+                Logger::info("RESOURCE MANAGER") << "File changed on disk, dropping cached item: " << *it << std::endl;
+                _datItemsSize -= itemIt->second.size;
+                _datItems.erase(itemIt);
+                ++_cacheGeneration;
+            }
+            if (!texturePinned && textureIt != _textures.end()) {
+                _texturesSize -= textureIt->second.size;
+                _textures.erase(textureIt);
+            }
+
+            if (itemPinned || texturePinned) {
+                ++it;
+            } else {
+                it = _changedItems.erase(it);
+            }
+        }
+    }
+
+    void ResourceManager::_storeEvicted(const std::vector<std::string> &filenames) {
+        if (!_scheduler) {
+            return;
+        }
+        // read while nothing else is queued, the copies only pay off if the files are needed again
+        RequestScope scope(ResourcePriority::SPECULATIVE);
+        for (auto &filename : filenames) {
+            _submit(filename, [this, filename]() {
+                if (_evictedItems->exists(filename)) {
+                    return;
+                }
+                auto file = _vfs->open(filename, VFS::IFile::OpenMode::Read);
+                if (!file || !file->isOpened() || file->size() == 0) {
+                    return;
+                }
+                auto contents = file->contents();
+                if (contents) {
+                    _evictedItems->storeCompressed(filename, contents.get(), file->size());
+                    return;
+                }
+                std::vector<unsigned char> data(file->size());
+                if (file->read(data.data(), file->size()) == data.size()) {
+                    _evictedItems->storeCompressed(filename, data.data(), data.size());
+                }
+            }, nullptr);
+        }
+    }
+
+    void ResourceManager::setCacheBudget(size_t bytes) {
+        _cacheBudget = bytes;
+        _cacheGrown = true;
+        _evictedItems->setCompressedBudget(bytes / 4);
+    }
+
+    size_t ResourceManager::cacheBudget() const {
+        return _cacheBudget;
+    }
+
+    size_t ResourceManager::cacheSize() const {
+        return _datItemsSize + _texturesSize;
+    }
+
+    std::vector<MemoryStats::Usage> ResourceManager::cacheUsage() {
+        std::map<std::string, MemoryStats::Usage> types;
+        {
+            std::lock_guard<std::mutex> lock(_datItemsMutex);
+            for (auto &it : _datItems) {
+                auto &filename = it.first.str();
+                auto dot = filename.rfind('.');
+                auto type = dot == std::string::npos ? std::string() : filename.substr(dot + 1);
+                auto &usage = types.emplace(type, MemoryStats::Usage{"cache " + type, 0, 0}).first->second;
+                usage.bytes += it.second.size;
+                usage.count++;
+            }
+        }
+
+        std::vector<MemoryStats::Usage> result;
+        for (auto &it : types) {
+            result.push_back(it.second);
+        }
+        // a part of the textures category
+        result.push_back({"cache textures", _texturesSize, _textures.size()});
+        result.push_back({"evicted files", _evictedItems->compressedSize(), _evictedItems->compressedCount()});
+        return result;
     }
 
     Frm::File *ResourceManager::frmFileType(unsigned int FID) {
@@ -413,19 +1200,19 @@ namespace Falltergeist {
         if (frmName.empty()) {
             return nullptr;
         }
-        return frmFileType(frmName);
+        return _idFileItem<Frm::File>(idKey(IdKind::FRM, FID & 0x0F000FFF), frmName);
     }
 
     Int::File *ResourceManager::intFileType(unsigned int SID) {
-        auto lst = lstFileType("scripts/scripts.lst");
-        if (SID >= lst->strings()->size()) {
+        const auto &names = _names(_scriptNames, "scripts/", "scripts.lst");
+        if (SID >= names.size()) {
             throw Exception("ResourceManager::intFileType() - wrong SID: " + std::to_string(SID));
         }
 
-        return intFileType("scripts/" + lst->strings()->at(SID));
+        return _idFileItem<Int::File>(idKey(IdKind::INT, SID), names[SID]);
     }
 
-    std::string ResourceManager::FIDtoFrmName(unsigned int FID) {
+    const std::string &ResourceManager::FIDtoFrmName(unsigned int FID) {
         const auto baseId = FID & 0x00000FFF;
         const auto type = static_cast<FRM_TYPE>(FID >> 24);
 
@@ -441,17 +1228,17 @@ namespace Falltergeist {
 
         static struct TypeArtListDecription {
             const std::string prefixPath;
-            const std::string lstFilePath;
+            const std::string lstFile;
         } const frmTypeDescription[] =
             {
-                {"art/items/",    "art/items/items.lst"},
-                {"art/critters/", "art/critters/critters.lst"},
-                {"art/scenery/",  "art/scenery/scenery.lst"},
-                {"art/walls/",    "art/walls/walls.lst"},
-                {"art/tiles/",    "art/tiles/tiles.lst"},
-                {"art/misc/",     "art/misc/misc.lst"},
-                {"art/intrface/", "art/intrface/intrface.lst"},
-                {"art/inven/",    "art/inven/inven.lst"},
+                {"art/items/",    "items.lst"},
+                {"art/critters/", "critters.lst"},
+                {"art/scenery/",  "scenery.lst"},
+                {"art/walls/",    "walls.lst"},
+                {"art/tiles/",    "tiles.lst"},
+                {"art/misc/",     "misc.lst"},
+                {"art/intrface/", "intrface.lst"},
+                {"art/inven/",    "inven.lst"},
             };
 
         if (type > FRM_TYPE::INVENTORY) {
@@ -459,22 +1246,199 @@ namespace Falltergeist {
         }
 
         const auto &typeArtDescription = frmTypeDescription[static_cast<size_t>(type)];
-        auto lst = lstFileType(typeArtDescription.lstFilePath);
-        if (baseId >= lst->strings()->size()) {
-            Logger::error("") << "ResourceManager::FIDtoFrmName(unsigned int) - LST size " << lst->strings()->size()
+        const auto &names = _names(_frmNames[static_cast<size_t>(type)], typeArtDescription.prefixPath, typeArtDescription.lstFile);
+        if (baseId >= names.size()) {
+            Logger::error("") << "ResourceManager::FIDtoFrmName(unsigned int) - LST size " << names.size()
                               << " <= frmID: " << baseId << " frmType: " << (unsigned) type << std::endl;
-            return std::string();
+            return EMPTY_NAME;
         }
 
-        std::string frmName = lst->strings()->at(baseId);
-        return typeArtDescription.prefixPath + frmName;
+        return names[baseId];
+    }
+
+    void ResourceManager::_recordManifest(const std::string &filename) {
+        if (_manifestThread.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+            _manifest.insert(filename);
+        }
+    }
+
+    void ResourceManager::_writeManifest() {
+        std::string name = std::move(_manifestName);
+        _manifestName.clear();
+        std::vector<std::string> files;
+        {
+            std::lock_guard<std::mutex> lock(_datItemsMutex);
+            _manifestThread = std::thread::id();
+            files.assign(_manifest.begin(), _manifest.end());
+            _manifest.clear();
+        }
+        if (_cachePath.empty()) {
+            return;
+        }
+        std::sort(files.begin(), files.end());
+
+        // manifest is optional, the map just preloads nothing next time if this fails
+        std::ofstream stream(_cachePath + "/" + name + ".manifest", std::ios_base::out | std::ios_base::trunc);
+        if (!stream.is_open()) {
+            return;
+        }
+        stream << _dataStamp << "\n";
+        for (auto &file : files) {
+            stream << file << "\n";
+        }
+        Logger::info("RESOURCE MANAGER") << "Recorded " << files.size() << " files for map " << name << std::endl;
+    }
+
+    unsigned int ResourceManager::beginManifest(const std::string &mapName) {
+        if (!_manifestName.empty()) {
+            _writeManifest();
+        }
+        _manifestName = mapName;
+        std::transform(_manifestName.begin(), _manifestName.end(), _manifestName.begin(), ::tolower);
+
+        std::lock_guard<std::mutex> lock(_datItemsMutex);
+        _manifest.clear();
+        _manifestThread = std::this_thread::get_id();
+        return ++_manifestRecording;
+    }
+
+    void ResourceManager::endManifest(unsigned int recording) {
+        if (!_manifestName.empty() && recording == _manifestRecording) {
+            _writeManifest();
+        }
+    }
+
+    void ResourceManager::preloadManifest(const std::string &mapName) {
+        std::string name = mapName;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (_cachePath.empty() || !_scheduler) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_datItemsMutex);
+            auto preloaded = _preloadedManifests.find(name);
+            if (preloaded != _preloadedManifests.end() && preloaded->second == _cacheGeneration) {
+                return;
+            }
+            _preloadedManifests[name] = _cacheGeneration;
+        }
+
+        std::ifstream stream(_cachePath + "/" + name + ".manifest");
+        std::string line;
+        if (!stream.is_open() || !std::getline(stream, line) || line != std::to_string(_dataStamp)) {
+            return;
+        }
+
+        unsigned int files = 0;
+        while (std::getline(stream, line)) {
+            if (line.size() < 4) {
+                continue;
+            }
+            std::string ext = line.substr(line.size() - 4);
+            // critter animations for a single direction are .fr0 to .fr5
+            if (ext == ".frm" || (ext.compare(0, 3, ".fr") == 0 && ext[3] >= '0' && ext[3] <= '5')) {
+                _requestDatFileItem<Frm::File>(line);
+            } else if (ext == ".pro") {
+                _requestDatFileItem<Pro::File>(line);
+            } else if (ext == ".acm") {
+                _requestDatFileItem<Acm::File>(line);
+            } else if (ext == ".int") {
+                _requestDatFileItem<Int::File>(line);
+            } else if (ext == ".msg") {
+                _requestDatFileItem<Msg::File>(line);
+            } else if (ext == ".lst") {
+                _requestDatFileItem<Lst::File>(line);
+            } else if (ext == ".pal") {
+                _requestDatFileItem<Pal::File>(line);
+            } else if (ext == ".aaf") {
+                _requestDatFileItem<Aaf::File>(line);
+            } else {
+                // maps and text files depend on the state they are parsed in, they are loaded when needed
+                continue;
+            }
+            files++;
+        }
+        Logger::info("RESOURCE MANAGER") << "Preloading " << files << " files for map " << name << std::endl;
+    }
+
+    unsigned int ResourceManager::requestOwner() {
+        return ++_lastRequestOwner;
+    }
+
+    void ResourceManager::cancelRequests(unsigned int owner) {
+        if (_scheduler) {
+            _scheduler->cancel(owner);
+        }
+        // the files of a cancelled manifest are queued again the next time it's preloaded
+        std::lock_guard<std::mutex> lock(_datItemsMutex);
+        _preloadedManifests.clear();
     }
 
     void ResourceManager::shutdown() {
+        if (!_manifestName.empty()) {
+            _writeManifest();
+        }
+        // Reads in flight hand their files to the loader threads, so the reader goes first.
+        // Loads which are started afterwards read loose files on their own.
+        {
+            std::lock_guard<std::mutex> lock(_asyncReaderMutex);
+            _asyncReader.reset();
+        }
+        // Finishes queued loads and joins loader threads
+        _scheduler.reset();
         unloadResources();
     }
 
     std::unique_ptr<VFS::VFS>& ResourceManager::vfs() {
         return _vfs;
     }
+
+    const std::string& ResourceManager::cachePath() const {
+        return _cachePath;
+    }
+
+    uint64_t ResourceManager::dataStamp() const {
+        return _dataStamp;
+    }
+
+    std::string ResourceManager::packedArchivePath(const std::string &filename) const {
+        return _cachePath.empty() ? "" : _cachePath + "/" + filename + ".lz4";
+    }
+
+    std::string ResourceManager::texturePackPath() const {
+        return _cachePath.empty() ? "" : _cachePath + "/textures.pack";
+    }
+
+    bool ResourceManager::_bakedTexture(const std::string &filename, Graphics::Pixels::Format format, const void *&data, Size &size) const {
+        if (!_texturePack) {
+            return false;
+        }
+        // loose files override the archives the pack was baked from
+        for (auto driver : _looseDrivers) {
+            if (driver->exists(filename)) {
+                return false;
+            }
+        }
+        Graphics::Pixels::Format bakedFormat;
+        return _texturePack->find(filename, data, size, bakedFormat) && bakedFormat == format;
+    }
+
+    std::shared_ptr<const Graphics::HitMask> ResourceManager::_hitMask(const uint8_t *indexes, const Size &size) {
+        // the same pixels react to the mouse as in Frm::File::mask(), the gaps between frames are transparent
+        auto palette = palFileType("color.pal");
+        bool opaqueIndexes[256];
+        for (unsigned i = 0; i != 256; ++i) {
+            opaqueIndexes[i] = palette->color(i)->alpha() > 0;
+        }
+
+        auto mask = std::make_shared<Graphics::HitMask>(size);
+        for (int y = 0; y != size.height(); ++y) {
+            for (int x = 0; x != size.width(); ++x) {
+                if (opaqueIndexes[indexes[y * size.width() + x]]) {
+                    mask->setOpaque(x, y);
+                }
+            }
+        }
+        return mask;
+    }
 }
@@ -1,13 +1,25 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <string>
+#include <thread>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "Base/Singleton.h"
+#include "Base/StringId.h"
+#include "Graphics/Pixels.h"
+#include "MemoryStats.h"
+#include "ResourceScheduler.h"
 #include "VFS/VFS.h"
 
 namespace Falltergeist
@@ -20,7 +32,6 @@ namespace Falltergeist
         namespace Bio { class File; }
         namespace Dat
         {
-            class File;
             class Item;
             class Stream;
         }
@@ -34,6 +45,7 @@ namespace Falltergeist
         namespace Lst { class File; }
         namespace Map { class File; }
         namespace Msg { class File; }
+        namespace Msk { class File; }
         namespace Mve { class File; }
         namespace Pro { class File; }
         namespace Pro { class File; }
@@ -68,20 +80,83 @@ namespace Falltergeist
     {
         class Location;
     }
+    namespace VFS
+    {
+        class AsyncReader;
+        class MemoryDriver;
+    }
     namespace Graphics
     {
         class Texture;
+        class TextureAtlas;
+        class TexturePack;
+        class HitMask;
         class Font;
         class Shader;
     }
 
+    // Handle to an item which is being loaded in the background by ResourceManager.
+    // get() blocks until the item is loaded and returns nullptr if the file was not found or the request was cancelled.
+    // The loaded item is pinned for as long as the handle exists.
+    template <class T>
+    class ResourceRequest
+    {
+        public:
+            ResourceRequest() = default;
+
+            ResourceRequest(std::shared_future<std::shared_ptr<Format::Dat::Item>> future, ResourceScheduler::Ticket ticket = 0)
+                : _future(std::move(future)), _ticket(ticket)
+            {
+            }
+
+            bool valid() const
+            {
+                return _future.valid();
+            }
+
+            bool ready() const
+            {
+                return _future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            }
+
+            // A load which is still queued is run on the calling thread right away
+            T* get() const;
+
+        private:
+            std::shared_future<std::shared_ptr<Format::Dat::Item>> _future;
+
+            // Job of the load, 0 if the item was cached already
+            ResourceScheduler::Ticket _ticket = 0;
+    };
+
     class ResourceManager final
     {
         public:
+            // Requests made by the calling thread while the scope exists are queued with the priority and belong
+            // to the owner, loads started by their jobs inherit both. Without a scope requests are VISIBLE and have no owner.
+            class RequestScope
+            {
+                public:
+                    RequestScope(ResourcePriority priority, unsigned int owner = 0);
+
+                    RequestScope(const RequestScope&) = delete;
+
+                    RequestScope& operator=(const RequestScope&) = delete;
+
+                    ~RequestScope();
+
+                private:
+                    ResourcePriority _priority;
+
+                    unsigned int _owner;
+            };
+
             static ResourceManager* getInstance();
 
             Format::Aaf::File* aafFileType(const std::string& filename);
             Format::Acm::File* acmFileType(const std::string& filename);
+            // Opens the file for a single playback bypassing the item cache, the data is read in chunks while decoding
+            std::unique_ptr<Format::Acm::File> acmFileStream(const std::string& filename);
             Format::Bio::File* bioFileType(const std::string& filename);
             Format::Dat::Item* datFileItem(const std::string& filename);
             Format::Frm::File* frmFileType(const std::string& filename);
@@ -96,12 +171,53 @@ namespace Falltergeist
             Format::Lst::File* lstFileType(const std::string& filename);
             Format::Map::File* mapFileType(const std::string& filename);
             Format::Msg::File* msgFileType(const std::string& filename);
+            Format::Msk::File* mskFileType(const std::string& filename);
             Format::Mve::File* mveFileType(const std::string& filename);
             Format::Pro::File* proFileType(const std::string& filename);
             Format::Pro::File* proFileType(unsigned int PID);
             Format::Rix::File* rixFileType(const std::string& filename);
             Format::Sve::File* sveFileType(const std::string& filename);
 
+            // Asynchronous counterparts of the getters above. Files are read and decoded on loader threads
+            // and end up in the same cache, so a later synchronous call for the same file only waits for
+            // the pending load instead of starting a new one. Textures still have to be created on the main thread.
+            ResourceRequest<Format::Aaf::File> requestAaf(const std::string& filename);
+            ResourceRequest<Format::Acm::File> requestAcm(const std::string& filename);
+            ResourceRequest<Format::Frm::File> requestFrm(const std::string& filename);
+            ResourceRequest<Format::Int::File> requestInt(const std::string& filename);
+            ResourceRequest<Format::Lip::File> requestLip(const std::string& filename);
+            ResourceRequest<Format::Lst::File> requestLst(const std::string& filename);
+            ResourceRequest<Format::Msg::File> requestMsg(const std::string& filename);
+            ResourceRequest<Format::Pal::File> requestPal(const std::string& filename);
+            ResourceRequest<Format::Pro::File> requestPro(const std::string& filename);
+
+            // Loads and initializes the map with the prototypes of its objects on a loader thread, then queues
+            // the FRMs of its objects and tiles. Entering the map afterwards only has to create the textures.
+            ResourceRequest<Format::Map::File> preloadMap(const std::string& filename);
+
+            // Queues the prototypes of all objects of an initialized map and the FRMs of its objects (except critters)
+            // and tiles on the loader threads, so creating the location waits for the slowest file instead of all of them
+            void requestMapResources(Format::Map::File* map);
+
+            // Records every file the calling thread gets from the cache until endManifest() or the next beginManifest(),
+            // then writes them to <cache>/<map>.manifest. Files loaded by the loader threads on their own are not recorded.
+            // Returns the recording for endManifest().
+            unsigned int beginManifest(const std::string& mapName);
+
+            // Writes the manifest if the recording wasn't ended by a later beginManifest() yet
+            void endManifest(unsigned int recording);
+
+            // Queues the files of the recorded manifest of the map on the loader threads, if there is one
+            // which was recorded with the current DAT files. Does nothing if nothing was evicted since the last call.
+            void preloadManifest(const std::string& mapName);
+
+            // New owner for requests which are cancelled together, never 0
+            unsigned int requestOwner();
+
+            // Drops queued PREDICTED and SPECULATIVE requests of the owner and moves its other ones behind everything
+            // else, once the location which made them is left. Requests which were made by somebody else too are kept.
+            void cancelRequests(unsigned int owner);
+
             Format::Txt::CityFile* cityTxt();
             Format::Txt::MapsFile* mapsTxt();
             Format::Txt::WorldmapFile* worldmapTxt();
@@ -115,22 +231,157 @@ namespace Falltergeist
             Graphics::Texture* texture(const std::string& filename);
             Graphics::Font* font(const std::string& filename = "font1.aaf");
             Graphics::Shader* shader(const std::string& filename);
+
+            // Submits all shaders before waiting for any of them, so drivers which compile in the background
+            // work on them in parallel. Must be called on the thread of the GL context like shader().
+            void preloadShaders(const std::vector<std::string>& filenames);
+
+            // Cached items and textures may be evicted by trim() once they have not been used for a while.
+            // Anything which keeps a pointer across frames has to hold a pin, which keeps the resource alive
+            // and excludes it from eviction. Fonts and shaders are never evicted.
+            template <class T>
+            std::shared_ptr<T> pin(T* item)
+            {
+                return std::static_pointer_cast<T>(_pinDatFileItem(item));
+            }
+
+            std::shared_ptr<Graphics::Texture> pinTexture(const std::string& filename);
+
+            // Evicts least recently used resources which are not pinned until the cache fits into the budget,
+            // and drops resources of files which were changed on disk so they are reloaded on next use.
+            // Must only be called when no unpinned resource pointers are held, i.e. between frames.
+            void trim();
+
+            // Memory budget for cached items and textures, in bytes. A quarter of it on top is kept for evicted files.
+            void setCacheBudget(size_t bytes);
+            size_t cacheBudget() const;
+
+            // Estimated memory used by cached items and textures, in bytes
+            size_t cacheSize() const;
+
+            // Estimated memory of the cached items by file type and of the cached textures. Main thread only
+            std::vector<MemoryStats::Usage> cacheUsage();
+
             void unloadResources();
-            std::string FIDtoFrmName(unsigned int FID);
+            // Names are built once per .lst file, the returned reference stays valid until shutdown
+            const std::string& FIDtoFrmName(unsigned int FID);
             Game::Location* gameLocation(unsigned int number);
 
             void shutdown();
 
             std::unique_ptr<VFS::VFS>& vfs();
 
+            // Directory for data derived from the game files which is kept between runs, empty if it can't be created
+            const std::string& cachePath() const;
+
+            // Changes whenever a DAT file is replaced, stored along with cached data derived from their contents
+            uint64_t dataStamp() const;
+
+            // LZ4 repack of the DAT file written by falltergeist --repack-data, mounted instead of the DAT file while it is unchanged
+            std::string packedArchivePath(const std::string& filename) const;
+
+            // Images baked by falltergeist --bake, used while the game files are the ones they were baked from
+            std::string texturePackPath() const;
+
         private:
             friend class Base::Singleton<ResourceManager>;
 
-            std::vector<std::unique_ptr<Format::Dat::File>> _datFiles;
+            template <class T>
+            friend class ResourceRequest;
+
+            template <class T>
+            struct CacheEntry
+            {
+                std::shared_ptr<T> resource;
+
+                // Estimated memory usage, in bytes
+                size_t size = 0;
+
+                // Value of _useCounter at the time of the last access
+                uint64_t lastUse = 0;
+            };
+
+            // Keyed by interned lower case file names
+            std::unordered_map<Base::StringId, CacheEntry<Format::Dat::Item>> _datItems;
+
+            // Load queued on _scheduler, its ticket is set under _datItemsMutex before the job can finish
+            struct PendingLoad
+            {
+                std::promise<std::shared_ptr<Format::Dat::Item>> promise;
+                ResourceScheduler::Ticket ticket = 0;
+            };
+
+            struct PendingItem
+            {
+                std::shared_future<std::shared_ptr<Format::Dat::Item>> future;
+                ResourceScheduler::Ticket ticket;
+            };
+
+            // Items which are being loaded by _scheduler
+            std::unordered_map<Base::StringId, PendingItem> _pendingItems;
+
+            // Guards _datItems and _pendingItems
+            std::mutex _datItemsMutex;
+
+            std::unique_ptr<ResourceScheduler> _scheduler;
+
+            // Contents of evicted items compressed with LZ4, loading them again skips the disk and inflating.
+            // Owned by the "cache" mount of _vfs.
+            VFS::MemoryDriver* _evictedItems = nullptr;
+
+            // Reads loose files for the loader threads so none of them waits on a read, gone after shutdown
+            std::unique_ptr<VFS::AsyncReader> _asyncReader;
+
+            std::mutex _asyncReaderMutex;
+
+            std::atomic<unsigned int> _lastRequestOwner{0};
 
-            std::unordered_map<std::string, std::unique_ptr<Format::Dat::Item>> _datItems;
+            std::unordered_map<Base::StringId, CacheEntry<Graphics::Texture>> _textures;
 
-            std::unordered_map<std::string, std::unique_ptr<Graphics::Texture>> _textures;
+            // Shared pages for FRM textures, created with the first texture since it needs the renderer
+            std::unique_ptr<Graphics::TextureAtlas> _textureAtlas;
+
+            // Baked FRM and RIX images, nullptr if there is no up to date pack
+            std::unique_ptr<Graphics::TexturePack> _texturePack;
+
+            // Mounted drivers of the data directories, files in them are never taken from the pack
+            std::vector<VFS::IDriver*> _looseDrivers;
+
+            std::atomic<uint64_t> _useCounter{0};
+
+            // Kept up to date under _datItemsMutex, textures are only touched on the main thread
+            std::atomic<size_t> _datItemsSize{0};
+
+            size_t _texturesSize = 0;
+
+            size_t _cacheBudget = 256 * 1024 * 1024;
+
+            // Set when something was cached since the last trim()
+            std::atomic<bool> _cacheGrown{false};
+
+            // Map preloads hold unpinned pointers into the cache while they run, trim() waits until they are done
+            std::atomic<unsigned int> _preloadJobs{0};
+
+            // Thread whose lookups are recorded to _manifest, no thread while nothing is recorded
+            std::atomic<std::thread::id> _manifestThread{};
+
+            std::string _manifestName;
+
+            unsigned int _manifestRecording = 0;
+
+            // Guarded by _datItemsMutex
+            std::unordered_set<std::string> _manifest;
+
+            // Value of _cacheGeneration when the manifest of a map was queued, nothing of it was evicted since if it is unchanged
+            std::unordered_map<std::string, uint64_t> _preloadedManifests;
+
+            // Adds the file to the manifest if the calling thread is recorded, _datItemsMutex has to be held
+            void _recordManifest(const std::string& filename);
+
+            void _writeManifest();
+
+            // Files which were changed on disk, their cached items are dropped by trim(). Guarded by _datItemsMutex.
+            std::unordered_set<std::string> _changedItems;
 
             std::unordered_map<std::string, std::unique_ptr<Graphics::Font>> _fonts;
 
@@ -138,6 +389,54 @@ namespace Falltergeist
 
             std::unique_ptr<VFS::VFS> _vfs;
 
+            // Full names of the files listed in a .lst file, built on first use and kept until shutdown
+            struct NameTable
+            {
+                std::once_flag built;
+                std::vector<std::string> names;
+            };
+
+            // One table per FRM_TYPE up to FRM_TYPE::INVENTORY
+            std::array<NameTable, 8> _frmNames;
+
+            // One table per OBJECT_TYPE up to OBJECT_TYPE::MISC
+            std::array<NameTable, 6> _proNames;
+
+            NameTable _scriptNames;
+
+            // Every prototype of an object type, indexed like its .lst file. Filled by a loader job started with the first
+            // proFileType(PID) call, the prototypes are pinned so PIDs shared by many objects are never parsed twice.
+            struct PrototypeTable
+            {
+                std::vector<std::shared_ptr<Format::Dat::Item>> prototypes;
+                std::atomic<bool> loaded{false};
+            };
+
+            // One table per OBJECT_TYPE up to OBJECT_TYPE::MISC
+            std::array<PrototypeTable, 6> _prototypes;
+
+            std::atomic<bool> _prototypesRequested{false};
+
+            // Jobs filling _prototypes, waited for before the tables are dropped
+            std::vector<std::future<void>> _prototypeJobs;
+
+            // Cached item found by FID, PID or SID without hashing its name, see _idFileItem()
+            struct IdSlot
+            {
+                uint64_t generation = 0;
+                CacheEntry<Format::Dat::Item>* entry = nullptr;
+            };
+
+            // Guarded by _datItemsMutex
+            std::unordered_map<uint64_t, IdSlot> _idSlots;
+
+            // Bumped whenever cached items are removed, which invalidates all slots. Guarded by _datItemsMutex.
+            uint64_t _cacheGeneration = 1;
+
+            std::string _cachePath;
+
+            uint64_t _dataStamp = 0;
+
             ResourceManager();
 
             ResourceManager(const ResourceManager&) = delete;
@@ -145,11 +444,81 @@ namespace Falltergeist
             ResourceManager& operator=(const ResourceManager&) = delete;
 
             // Retrieves given file item from "virtual file system".
-            // All items are cached after being requested for the first time.
+            // All items are cached after being requested for the first time. Safe to call from loader threads.
             template <class T>
             T* _datFileItem(std::string filename);
 
+            // Same as _datFileItem(), but once the item is cached it is found by the integer key alone
+            template <class T>
+            T* _idFileItem(uint64_t key, const std::string& filename);
+
+            // Entries of the .lst file in the directory, prefixed with the directory
+            const std::vector<std::string>& _names(NameTable& table, const std::string& directory, const std::string& listFile);
+
+            // Queues loading of the given file item on _scheduler unless it is already cached or pending.
+            template <class T>
+            ResourceRequest<T> _requestDatFileItem(std::string filename);
+
+            // Queues the job with the priority and owner of the calling thread, placed where the data of the file is
+            ResourceScheduler::Ticket _submit(const std::string& filename, std::function<void()> job, std::function<void()> cancelled);
+
+            // Removes the pending item unless it was queued again by another job, _datItemsMutex has to be held
+            void _erasePending(const Base::StringId& name, ResourceScheduler::Ticket ticket);
+
+            // Runs the queued job on the calling thread, for somebody who is blocked on it
+            void _expedite(ResourceScheduler::Ticket ticket);
+
+            // Reads and decodes given file item without touching the cache. The size of the file is stored to size.
+            // The file is opened through the VFS unless it is given.
+            template <class T>
+            std::unique_ptr<T> _createDatFileItem(const std::string& filename, size_t& size, std::shared_ptr<VFS::IFile> file = nullptr);
+
+            // Decodes the pending load and moves it to the cache
+            template <class T>
+            void _finishLoad(const std::string& filename, std::shared_ptr<PendingLoad> load, std::shared_ptr<VFS::IFile> file);
+
+            // Reads a loose file with _asyncReader and calls back with its contents, false if it is archived
+            // or there is no reader anymore. A file which can't be read is reported as nullptr.
+            bool _readAsync(const std::string& filename, std::function<void(std::shared_ptr<VFS::IFile>)> callback);
+
+            // Moves created item to the cache and returns the cached one. _datItemsMutex must be held by the caller.
+            Format::Dat::Item* _cacheDatFileItem(const std::string& filename, std::unique_ptr<Format::Dat::Item> item, size_t size);
+
+            // Returns shared ownership of the cached item, or a non-owning pointer if the item is not cached.
+            std::shared_ptr<Format::Dat::Item> _pinDatFileItem(Format::Dat::Item* item);
+
+            // Drops cached items and textures of files which were changed on disk, unless they are pinned
+            void _dropChangedItems();
+
+            // Queues speculative jobs reading the files of evicted items into _evictedItems
+            void _storeEvicted(const std::vector<std::string>& filenames);
+
+            // Finds the baked image of an archive file in the format it would be created in
+            bool _bakedTexture(const std::string& filename, Graphics::Pixels::Format format, const void*& data, Graphics::Size& size) const;
+
+            // Hit mask of the palette indexes of a baked FRM
+            std::shared_ptr<const Graphics::HitMask> _hitMask(const uint8_t* indexes, const Graphics::Size& size);
+
+            // Name of the prototype file of the PID, empty if the PID is invalid
+            const std::string& _proFileName(unsigned int PID);
+
+            // Starts parsing all prototypes in the background, one loader job per object type
+            void _requestPrototypes();
+
             // Searches for a given file within virtual "file system" and calls the given callback with Dat::Stream created from that file.
-            void _loadStreamForFile(std::string filename, std::function<void(Format::Dat::Stream&&)> callback);
+            // Every call opens its own read handle in the virtual file system, so it is safe to call this from worker threads.
+            // The file is read (and unpacked) on demand in chunks if streamed is true.
+            void _loadStreamForFile(std::string filename, std::function<void(Format::Dat::Stream&&)> callback, bool streamed = false,
+                                    std::shared_ptr<VFS::IFile> file = nullptr);
     };
+
+    template <class T>
+    T* ResourceRequest<T>::get() const
+    {
+        if (_ticket != 0 && !ready())
+        {
+            ResourceManager::getInstance()->_expedite(_ticket);
+        }
+        return dynamic_cast<T*>(_future.get().get());
+    }
 }
@@ -0,0 +1,156 @@
+#include "ResourceScheduler.h"
+#include <tuple>
+
+namespace Falltergeist
+{
+    bool ResourceScheduler::Key::operator<(const Key &other) const {
+        return std::tie(storage, offset, ticket) < std::tie(other.storage, other.offset, other.ticket);
+    }
+
+    ResourceScheduler::ResourceScheduler(unsigned int threads) {
+        if (threads == 0) {
+            threads = 1;
+        }
+        for (unsigned int i = 0; i != threads; ++i) {
+            _workers.emplace_back([this]() { _work(); });
+        }
+    }
+
+    ResourceScheduler::~ResourceScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _condition.notify_all();
+        for (auto &worker : _workers) {
+            worker.join();
+        }
+    }
+
+    ResourceScheduler::Ticket ResourceScheduler::submit(ResourcePriority priority, unsigned int owner, Place place, std::function<void()> job, std::function<void()> cancelled) {
+        Ticket ticket;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            ticket = ++_lastTicket;
+            Key key{reinterpret_cast<uintptr_t>(place.storage), place.offset, ticket};
+            _jobs.emplace(ticket, Job{priority, owner, key, std::move(job), std::move(cancelled)});
+            _queues[static_cast<size_t>(priority)].insert(key);
+        }
+        _condition.notify_one();
+        return ticket;
+    }
+
+    bool ResourceScheduler::retain(Ticket ticket, ResourcePriority priority, unsigned int owner) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_cancelled.count(ticket) != 0) {
+            return false;
+        }
+        auto jobIt = _jobs.find(ticket);
+        if (jobIt == _jobs.end()) {
+            return true;
+        }
+        auto &job = jobIt->second;
+        if (job.owner != owner) {
+            job.owner = 0;
+        }
+        if (priority < job.priority) {
+            _requeue(job, priority);
+        }
+        return true;
+    }
+
+    bool ResourceScheduler::runNow(Ticket ticket) {
+        std::function<void()> run;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto jobIt = _jobs.find(ticket);
+            if (jobIt == _jobs.end()) {
+                return false;
+            }
+            run = std::move(jobIt->second.run);
+            _queues[static_cast<size_t>(jobIt->second.priority)].erase(jobIt->second.key);
+            _jobs.erase(jobIt);
+        }
+        run();
+        return true;
+    }
+
+    void ResourceScheduler::cancel(unsigned int owner) {
+        if (owner == 0) {
+            return;
+        }
+
+        std::vector<std::pair<Ticket, std::function<void()>>> cancelled;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto jobIt = _jobs.begin(); jobIt != _jobs.end();) {
+                auto &job = jobIt->second;
+                if (job.owner != owner) {
+                    ++jobIt;
+                    continue;
+                }
+                // what was needed right away is likely needed by the next location as well, it's cheap to finish
+                if (job.priority < ResourcePriority::PREDICTED) {
+                    job.owner = 0;
+                    _requeue(job, ResourcePriority::SPECULATIVE);
+                    ++jobIt;
+                    continue;
+                }
+                _queues[static_cast<size_t>(job.priority)].erase(job.key);
+                _cancelled.insert(jobIt->first);
+                cancelled.emplace_back(jobIt->first, std::move(job.cancelled));
+                jobIt = _jobs.erase(jobIt);
+            }
+        }
+
+        for (auto &job : cancelled) {
+            if (job.second) {
+                job.second();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto &job : cancelled) {
+            _cancelled.erase(job.first);
+        }
+    }
+
+    unsigned int ResourceScheduler::size() const {
+        return static_cast<unsigned int>(_workers.size());
+    }
+
+    void ResourceScheduler::_requeue(Job &job, ResourcePriority priority) {
+        _queues[static_cast<size_t>(job.priority)].erase(job.key);
+        job.priority = priority;
+        _queues[static_cast<size_t>(job.priority)].insert(job.key);
+    }
+
+    void ResourceScheduler::_work() {
+        while (true) {
+            std::function<void()> run;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _condition.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+                if (_jobs.empty()) {
+                    return;
+                }
+
+                auto queue = _queues.begin();
+                while (queue->empty()) {
+                    ++queue;
+                }
+                // the sweep goes on from the last started job and starts over from the lowest offset at the end
+                auto keyIt = queue->upper_bound(_head);
+                if (keyIt == queue->end()) {
+                    keyIt = queue->begin();
+                }
+                _head = *keyIt;
+                auto jobIt = _jobs.find(keyIt->ticket);
+                run = std::move(jobIt->second.run);
+                _jobs.erase(jobIt);
+                queue->erase(keyIt);
+            }
+            run();
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Falltergeist
+{
+    // Order in which queued resource loads are started, lower first
+    enum class ResourcePriority : unsigned int
+    {
+        // somebody is blocked until the file is loaded
+        NOW = 0,
+        // shown as soon as it is loaded
+        VISIBLE,
+        // likely needed soon: maps behind nearby exits, elevations behind ladders, recorded manifests
+        PREDICTED,
+        // warming up the cache while there is nothing else to do
+        SPECULATIVE
+    };
+
+    // Loader threads of ResourceManager. Queued jobs are started by priority, jobs of the same priority in the order
+    // of their data, sweeping from the lowest offset of an archive to the highest and starting over again, so reads
+    // of one DAT file seek as little as possible. Jobs which are still queued when the scheduler is destroyed
+    // are executed before the workers are joined. Jobs must not throw.
+    class ResourceScheduler final
+    {
+        public:
+            typedef uint64_t Ticket;
+
+            // Where the data of a job is read from, see VFS::VFS::locate(). Jobs without a known place have no storage.
+            struct Place
+            {
+                const void* storage = nullptr;
+                uint64_t offset = 0;
+            };
+
+            ResourceScheduler(unsigned int threads);
+
+            ResourceScheduler(const ResourceScheduler&) = delete;
+
+            ResourceScheduler& operator=(const ResourceScheduler&) = delete;
+
+            ~ResourceScheduler();
+
+            // Queues the job for the owner, 0 for none. cancelled is called instead of the job if cancel() drops it.
+            // Both are called without any lock of the scheduler held.
+            Ticket submit(ResourcePriority priority, unsigned int owner, Place place, std::function<void()> job, std::function<void()> cancelled);
+
+            // Raises the priority of the queued job if it is lower, a job requested by two owners belongs to none of them.
+            // Returns false if the job was cancelled, it never runs then.
+            bool retain(Ticket ticket, ResourcePriority priority, unsigned int owner);
+
+            // Runs the job on the calling thread if it is still queued, so waiting for it doesn't mean waiting for the queue.
+            // Returns false if it was started, finished or cancelled already.
+            bool runNow(Ticket ticket);
+
+            // Drops the queued PREDICTED and SPECULATIVE jobs of the owner and moves its other queued jobs behind everything else
+            void cancel(unsigned int owner);
+
+            unsigned int size() const;
+
+        private:
+            struct Key
+            {
+                uintptr_t storage;
+                uint64_t offset;
+                Ticket ticket;
+
+                bool operator<(const Key& other) const;
+            };
+
+            struct Job
+            {
+                ResourcePriority priority;
+                unsigned int owner;
+                Key key;
+                std::function<void()> run;
+                std::function<void()> cancelled;
+            };
+
+            std::vector<std::thread> _workers;
+
+            // Queued jobs by ticket
+            std::unordered_map<Ticket, Job> _jobs;
+
+            // Keys of the queued jobs, one queue per priority
+            std::array<std::set<Key>, 4> _queues;
+
+            // Jobs dropped by cancel() whose cancelled callback didn't return yet
+            std::unordered_set<Ticket> _cancelled;
+
+            // Key of the last started job, the sweep goes on from there
+            Key _head{0, 0, 0};
+
+            Ticket _lastTicket = 0;
+
+            std::mutex _mutex;
+
+            std::condition_variable _condition;
+
+            bool _stopping = false;
+
+            // Moves the queued job to another priority, _mutex has to be held
+            void _requeue(Job& job, ResourcePriority priority);
+
+            void _work();
+    };
+}
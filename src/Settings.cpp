@@ -1,3 +1,7 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
 #include <string>
 #include "CrossPlatform.h"
 #include "Logger.h"
@@ -7,216 +11,434 @@
 
 namespace Falltergeist
 {
-    Settings::Settings()
-    {
-        if (!load()) {
-            save();
-        }
-    }
-
-    Settings::~Settings()
-    {
-    }
-
-    bool Settings::save()
+    namespace
     {
-        CrossPlatform::createDirectory(CrossPlatform::getConfigPath());
-        std::string configFile = CrossPlatform::getConfigPath() + "/config.ini";
-        std::ofstream stream(configFile);
+        const char SHADOW_MAGIC[4] = {'F', 'G', 'S', 'T'};
 
-        Logger::info("") << "Saving config to " << configFile << std::endl;
+        const uint32_t SHADOW_VERSION = 1;
 
-        if (!stream)
+        std::string configFile()
         {
-            Logger::warning("") << "Cannot open config file at `" << configFile << "`;" << std::endl;
-            return false;
+            return CrossPlatform::getConfigPath() + "/config.ini";
         }
 
-        Ini::File file;
-
-        auto video = file.section("video");
-        video->setPropertyInt("width", _screenWidth);
-        video->setPropertyInt("height", _screenHeight);
-        video->setPropertyInt("x", _screenX);
-        video->setPropertyInt("y", _screenY);
-        video->setPropertyInt("scale", _scale);
-        video->setPropertyBool("fullscreen", _fullscreen);
-        video->setPropertyBool("always_on_top", _alwaysOnTop);
-
-        auto audio = file.section("audio");
-        audio->setPropertyBool("enabled", _audioEnabled);
-        audio->setPropertyDouble("master_volume", _masterVolume);
-        audio->setPropertyDouble("music_volume", _musicVolume);
-        audio->setPropertyDouble("voice_volume", _voiceVolume);
-        audio->setPropertyDouble("sfx_volume", _sfxVolume);
-        audio->setPropertyString("music_path", _musicPath);
-        audio->setPropertyInt("buffer_size", _audioBufferSize);
-
-        auto logger = file.section("logger");
-        logger->setPropertyString("level", _loggerLevel);
-        logger->setPropertyBool("colors", _loggerColors);
-
-        auto game = file.section("game");
-        game->setPropertyString("init_location", _initLocation);
-        game->setPropertyBool("force_location", _forceLocation);
-        game->setPropertyBool("display_fps", _displayFps);
-        game->setPropertyBool("worldmap_fullscreen", _worldMapFullscreen);
-        game->setPropertyBool("display_mouse_position", _displayMousePosition);
-
-        auto preferences = file.section("preferences");
-        preferences->setPropertyDouble("brightness", _brightness);
-        preferences->setPropertyInt("game_difficulty", _gameDifficulty);
-        preferences->setPropertyInt("combat_difficulty", _combatDifficulty);
-        preferences->setPropertyBool("combat_looks", _combatLooks);
-        preferences->setPropertyBool("combat_messages", _combatMessages);
-        preferences->setPropertyBool("combat_taunts", _combatTaunts);
-        preferences->setPropertyInt("combat_speed", _combatSpeed);
-        preferences->setPropertyBool("item_highlight", _itemHighlight);
-        preferences->setPropertyBool("language_filter", _languageFilter);
-        preferences->setPropertyDouble("mouse_sensitivity", _mouseSensitivity);
-        preferences->setPropertyBool("player_speedup", _playerSpeedup);
-        preferences->setPropertyBool("running", _running);
-        preferences->setPropertyBool("subtitles", _subtitles);
-        preferences->setPropertyBool("target_highlight", _targetHighlight);
-        preferences->setPropertyDouble("text_delay", _textDelay);
-        preferences->setPropertyInt("violence_level", _violenceLevel);
-
-        Ini::Writer writer(file);
-        writer.write(stream);
+        // Values of the options as they were read from config.ini, read at startup instead of parsing it
+        std::string shadowFile()
+        {
+            return CrossPlatform::getConfigPath() + "/cache/config.bin";
+        }
 
-        return true;
-    }
+        // Size and modification time of config.ini, the shadow copy is only used while they stay the same
+        bool configStamp(uint64_t& size, int64_t& time)
+        {
+            std::error_code error;
+            size = std::filesystem::file_size(configFile(), error);
+            if (error) {
+                return false;
+            }
+            auto writeTime = std::filesystem::last_write_time(configFile(), error);
+            time = static_cast<int64_t>(writeTime.time_since_epoch().count());
+            return !error;
+        }
 
-    unsigned int Settings::screenWidth() const
-    {
-        return _screenWidth;
+        // The keys, so a shadow copy of another set of options is never read
+        struct KeysHash
+        {
+            uint64_t hash = 14695981039346656037ULL;
+
+            template <typename T>
+            void operator()(const char* section, const char* key, T&)
+            {
+                for (auto name : {section, ".", key, ";"}) {
+                    for (; *name; ++name) {
+                        hash ^= static_cast<unsigned char>(*name);
+                        hash *= 1099511628211ULL;
+                    }
+                }
+            }
+        };
+
+        struct IniWriter
+        {
+            Ini::File& file;
+
+            void operator()(const char* section, const char* key, unsigned int& value)
+            {
+                file.section(section)->setPropertyInt(key, static_cast<int>(value));
+            }
+
+            void operator()(const char* section, const char* key, int& value)
+            {
+                file.section(section)->setPropertyInt(key, value);
+            }
+
+            void operator()(const char* section, const char* key, bool& value)
+            {
+                file.section(section)->setPropertyBool(key, value);
+            }
+
+            void operator()(const char* section, const char* key, double& value)
+            {
+                file.section(section)->setPropertyDouble(key, value);
+            }
+
+            void operator()(const char* section, const char* key, std::string& value)
+            {
+                file.section(section)->setPropertyString(key, value);
+            }
+        };
+
+        // Options missing from the file keep their values
+        struct IniReader
+        {
+            Ini::File& file;
+
+            void operator()(const char* section, const char* key, unsigned int& value)
+            {
+                if (file.hasSection(section)) {
+                    value = static_cast<unsigned int>(file.section(section)->propertyInt(key, static_cast<int>(value)));
+                }
+            }
+
+            void operator()(const char* section, const char* key, int& value)
+            {
+                if (file.hasSection(section)) {
+                    value = file.section(section)->propertyInt(key, value);
+                }
+            }
+
+            void operator()(const char* section, const char* key, bool& value)
+            {
+                if (file.hasSection(section)) {
+                    value = file.section(section)->propertyBool(key, value);
+                }
+            }
+
+            void operator()(const char* section, const char* key, double& value)
+            {
+                if (file.hasSection(section)) {
+                    value = file.section(section)->propertyDouble(key, value);
+                }
+            }
+
+            void operator()(const char* section, const char* key, std::string& value)
+            {
+                if (file.hasSection(section)) {
+                    value = file.section(section)->propertyString(key, value);
+                }
+            }
+        };
+
+        struct ShadowWriter
+        {
+            std::string& data;
+
+            template <typename T>
+            void operator()(const char*, const char*, T& value)
+            {
+                data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+
+            void operator()(const char*, const char*, std::string& value)
+            {
+                uint32_t size = static_cast<uint32_t>(value.size());
+                data.append(reinterpret_cast<const char*>(&size), sizeof(size));
+                data.append(value);
+            }
+        };
+
+        // Only checks the values unless apply is set, so broken copies never change an option
+        struct ShadowReader
+        {
+            const std::string& data;
+            size_t position;
+            bool apply;
+            bool valid = true;
+
+            template <typename T>
+            void operator()(const char*, const char*, T& value)
+            {
+                if (!valid || data.size() - position < sizeof(value)) {
+                    valid = false;
+                    return;
+                }
+                if (apply) {
+                    std::memcpy(&value, data.data() + position, sizeof(value));
+                }
+                position += sizeof(value);
+            }
+
+            void operator()(const char*, const char*, std::string& value)
+            {
+                uint32_t size = 0;
+                bool applied = apply;
+                apply = true;
+                (*this)(nullptr, nullptr, size);
+                apply = applied;
+                if (!valid || data.size() - position < size) {
+                    valid = false;
+                    return;
+                }
+                if (apply) {
+                    value.assign(data, position, size);
+                }
+                position += size;
+            }
+        };
+
+        const size_t SHADOW_HEADER_SIZE = sizeof(SHADOW_MAGIC) + sizeof(SHADOW_VERSION) + sizeof(uint64_t) + sizeof(int64_t);
+
+        // Values start with the hash of the keys and are written with the stamp of the config.ini they were saved to
+        void writeShadow(const std::string& values)
+        {
+            uint64_t size;
+            int64_t time;
+            if (!configStamp(size, time)) {
+                return;
+            }
+            try {
+                CrossPlatform::createDirectory(CrossPlatform::getConfigPath() + "/cache");
+            } catch (const std::runtime_error&) {
+                return;
+            }
+
+            // written next to the final file and renamed, so an interrupted write never leaves a broken copy
+            std::string temporaryPath = shadowFile() + ".tmp";
+            {
+                std::ofstream stream(temporaryPath, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+                stream.write(SHADOW_MAGIC, sizeof(SHADOW_MAGIC));
+                stream.write(reinterpret_cast<const char*>(&SHADOW_VERSION), sizeof(SHADOW_VERSION));
+                stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+                stream.write(reinterpret_cast<const char*>(&time), sizeof(time));
+                stream.write(values.data(), values.size());
+                if (!stream) {
+                    return;
+                }
+            }
+            std::error_code error;
+            std::filesystem::rename(temporaryPath, shadowFile(), error);
+            if (error) {
+                std::filesystem::remove(temporaryPath, error);
+            }
+        }
     }
 
-    unsigned int Settings::screenHeight() const
+    Settings::Settings()
     {
-        return _screenHeight;
+        if (!load()) {
+            save();
+        }
     }
 
-    int Settings::screenX() const
+    Settings::~Settings()
     {
-        return _screenX;
+        // the last save is written before the settings are gone
+        if (_writer.valid()) {
+            _writer.wait();
+        }
     }
 
-    int Settings::screenY() const
-    {
-        return _screenY;
+    template <typename Visitor>
+    void Settings::_fields(Visitor&& visitor)
+    {
+        visitor("video", "width", _screenWidth);
+        visitor("video", "height", _screenHeight);
+        visitor("video", "x", _screenX);
+        visitor("video", "y", _screenY);
+        visitor("video", "scale", _scale);
+        visitor("video", "scale_filter", _scaleFilter);
+        visitor("video", "texture_budget", _textureBudget);
+        visitor("video", "texture_upload_budget", _textureUploadBudget);
+        visitor("video", "fullscreen", _fullscreen);
+        visitor("video", "always_on_top", _alwaysOnTop);
+        visitor("video", "vsync", _vsync);
+        visitor("video", "gles", _gles);
+        visitor("video", "frame_limit", _frameLimit);
+        visitor("video", "frame_spin_wait", _frameSpinWait);
+
+        visitor("audio", "enabled", _audioEnabled);
+        visitor("audio", "master_volume", _masterVolume);
+        visitor("audio", "music_volume", _musicVolume);
+        visitor("audio", "voice_volume", _voiceVolume);
+        visitor("audio", "sfx_volume", _sfxVolume);
+        visitor("audio", "music_path", _musicPath);
+        visitor("audio", "buffer_size", _audioBufferSize);
+        visitor("audio", "sfx_cache_size", _sfxCacheSize);
+
+        visitor("logger", "level", _loggerLevel);
+        visitor("logger", "colors", _loggerColors);
+        visitor("logger", "file", _loggerFile);
+        visitor("logger", "file_size", _loggerFileSize);
+        visitor("logger", "file_count", _loggerFileCount);
+
+        visitor("game", "init_location", _initLocation);
+        visitor("game", "force_location", _forceLocation);
+        visitor("game", "display_fps", _displayFps);
+        visitor("game", "worldmap_fullscreen", _worldMapFullscreen);
+        visitor("game", "display_mouse_position", _displayMousePosition);
+        visitor("game", "resource_cache_size", _resourceCacheSize);
+        visitor("game", "location_cache", _locationCache);
+        visitor("game", "script_budget", _scriptBudget);
+        visitor("game", "script_profiler", _scriptProfiler);
+        visitor("game", "frame_trace", _frameTrace);
+        visitor("game", "frame_trace_spike", _frameTraceSpike);
+        visitor("game", "render_stats", _renderStats);
+        visitor("game", "memory_stats", _memoryStats);
+        visitor("game", "memory_stats_interval", _memoryStatsInterval);
+        visitor("game", "telemetry", _telemetry);
+        visitor("game", "telemetry_interval", _telemetryInterval);
+        visitor("game", "record_manifests", _recordManifests);
+        visitor("game", "frame_stats", _frameStats);
+        visitor("game", "hitch_threshold", _hitchThreshold);
+        visitor("game", "critter_wake_radius", _critterWakeRadius);
+        visitor("game", "think_threads", _thinkThreads);
+        visitor("game", "kept_locations", _keptLocations);
+        visitor("game", "trace_variables", _traceVariables);
+        visitor("game", "save_compression", _saveCompression);
+        visitor("game", "skip_idle_frames", _skipIdleFrames);
+        visitor("game", "hardware_cursor", _hardwareCursor);
+        visitor("game", "simulation_rate", _simulationRate);
+
+        visitor("preferences", "brightness", _brightness);
+        visitor("preferences", "game_difficulty", _gameDifficulty);
+        visitor("preferences", "combat_difficulty", _combatDifficulty);
+        visitor("preferences", "combat_looks", _combatLooks);
+        visitor("preferences", "combat_messages", _combatMessages);
+        visitor("preferences", "combat_taunts", _combatTaunts);
+        visitor("preferences", "combat_speed", _combatSpeed);
+        visitor("preferences", "item_highlight", _itemHighlight);
+        visitor("preferences", "language_filter", _languageFilter);
+        visitor("preferences", "mouse_sensitivity", _mouseSensitivity);
+        visitor("preferences", "player_speedup", _playerSpeedup);
+        visitor("preferences", "running", _running);
+        visitor("preferences", "subtitles", _subtitles);
+        visitor("preferences", "target_highlight", _targetHighlight);
+        visitor("preferences", "text_delay", _textDelay);
+        visitor("preferences", "violence_level", _violenceLevel);
     }
 
-    bool Settings::audioEnabled() const
+    bool Settings::save()
     {
-        return _audioEnabled;
+        Ini::File file;
+        _fields(IniWriter{file});
+        std::ostringstream ini;
+        Ini::Writer writer(file);
+        writer.write(ini);
+
+        std::string values = _shadowValues();
+
+        // Saving twice before the first write is done writes only the second snapshot
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        _pendingIni = ini.str();
+        _pendingValues = std::move(values);
+        _hasPendingWrite = true;
+        if (!_writing) {
+            _writing = true;
+            _writer = std::async(std::launch::async, [this]() { _writePending(); });
+        }
+        return true;
     }
 
-    const std::string& Settings::initialLocation() const
-    {
-        return _initLocation;
+    void Settings::_writePending()
+    {
+        std::unique_lock<std::mutex> lock(_writeMutex);
+        while (_hasPendingWrite) {
+            std::string ini = std::move(_pendingIni);
+            std::string values = std::move(_pendingValues);
+            _hasPendingWrite = false;
+            lock.unlock();
+
+            Logger::info("") << "Saving config to " << configFile() << std::endl;
+            try {
+                CrossPlatform::createDirectory(CrossPlatform::getConfigPath());
+            } catch (const std::runtime_error& e) {
+                Logger::warning("") << "Cannot create config directory: " << e.what() << std::endl;
+            }
+            std::ofstream stream(configFile(), std::ios_base::out | std::ios_base::trunc);
+            if (!stream || !stream.write(ini.data(), ini.size())) {
+                Logger::warning("") << "Cannot open config file at `" << configFile() << "`;" << std::endl;
+            } else {
+                stream.close();
+                writeShadow(values);
+            }
+
+            lock.lock();
+        }
+        _writing = false;
     }
 
-    bool Settings::forceLocation() const
+    std::string Settings::_shadowValues()
     {
-        return _forceLocation;
+        KeysHash keys;
+        _fields(keys);
+        std::string values(reinterpret_cast<const char*>(&keys.hash), sizeof(keys.hash));
+        _fields(ShadowWriter{values});
+        return values;
     }
 
-    bool Settings::load()
+    bool Settings::_readShadow()
     {
-        std::string configFile = CrossPlatform::getConfigPath() + "/config.ini";
-        std::ifstream stream(configFile);
-
-        Logger::info("") << "Loading config from " << configFile << std::endl;
-
-        if (!stream)
-        {
-            Logger::warning("") << "Cannot open config file at `" << configFile << "`;" << std::endl;
+        uint64_t size;
+        int64_t time;
+        if (!configStamp(size, time)) {
             return false;
         }
-
-        Ini::Parser parser(stream);
-        auto file = parser.parse();
-
-        auto video = file->section("video");
-        if (video)
-        {
-            _screenWidth = video->propertyInt("width", _screenWidth);
-            _screenHeight = video->propertyInt("height", _screenHeight);
-            _screenX = video->propertyInt("x", _screenX);
-            _screenY = video->propertyInt("y", _screenY);
-            _scale = video->propertyInt("scale", _scale);
-            _fullscreen = video->propertyBool("fullscreen", _fullscreen);
-            _alwaysOnTop = video->propertyBool("always_on_top", _alwaysOnTop);
-        }
-
-        auto audio = file->section("audio");
-        if (audio)
-        {
-            _audioEnabled = audio->propertyBool("enabled", _audioEnabled);
-            _masterVolume = audio->propertyDouble("master_volume", _masterVolume);
-            _musicVolume = audio->propertyDouble("music_volume", _musicVolume);
-            _voiceVolume = audio->propertyDouble("voice_volume", _voiceVolume);
-            _sfxVolume = audio->propertyDouble("sfx_volume", _sfxVolume);
-            _musicPath = audio->propertyString("music_path", _musicPath);
-            _audioBufferSize = audio->propertyInt("buffer_size", _audioBufferSize);
+        std::ifstream stream(shadowFile(), std::ios_base::binary | std::ios_base::in);
+        if (!stream) {
+            return false;
         }
+        std::string data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
 
-        auto logger = file->section("logger");
-        if (logger)
-        {
-            _loggerLevel = logger->propertyString("level", _loggerLevel);
-            Logger::setLevel(_loggerLevel);
-            _loggerColors = logger->propertyBool("colors", _loggerColors);
+        std::string values = _shadowValues();
+        if (data.size() < SHADOW_HEADER_SIZE + sizeof(uint64_t) || std::memcmp(data.data(), SHADOW_MAGIC, sizeof(SHADOW_MAGIC)) != 0) {
+            return false;
         }
-
-        auto game = file->section("game");
-        if (game)
-        {
-            _initLocation = game->propertyString("init_location", _initLocation);
-            _forceLocation = game->propertyBool("force_location", _forceLocation);
-            _displayFps = game->propertyBool("display_fps", _displayFps);
-            _worldMapFullscreen = game->propertyBool("worldmap_fullscreen", _worldMapFullscreen);
-            _displayMousePosition = game->propertyBool("display_mouse_position", _displayMousePosition);
+        uint32_t version;
+        uint64_t shadowSize;
+        int64_t shadowTime;
+        std::memcpy(&version, data.data() + 4, sizeof(version));
+        std::memcpy(&shadowSize, data.data() + 8, sizeof(shadowSize));
+        std::memcpy(&shadowTime, data.data() + 16, sizeof(shadowTime));
+        if (version != SHADOW_VERSION || shadowSize != size || shadowTime != time
+            || data.compare(SHADOW_HEADER_SIZE, sizeof(uint64_t), values, 0, sizeof(uint64_t)) != 0) {
+            return false;
         }
 
-        auto preferences = file->section("preferences");
-        if (preferences)
-        {
-            _brightness = preferences->propertyDouble("brightness", _brightness);
-            _gameDifficulty = preferences->propertyInt("game_difficulty", _gameDifficulty);
-            _combatDifficulty = preferences->propertyInt("combat_difficulty", _combatDifficulty);
-            _combatLooks = preferences->propertyBool("combat_looks", _combatLooks);
-            _combatMessages = preferences->propertyBool("combat_messages", _combatMessages);
-            _combatTaunts = preferences->propertyBool("combat_taunts", _combatTaunts);
-            _combatSpeed = preferences->propertyInt("combat_speed", _combatSpeed);
-            _itemHighlight = preferences->propertyBool("item_highlight", _itemHighlight);
-            _languageFilter = preferences->propertyBool("language_filter", _languageFilter);
-            _mouseSensitivity = preferences->propertyDouble("mouse_sensitivity", _mouseSensitivity);
-            _playerSpeedup = preferences->propertyBool("player_speedup", _playerSpeedup);
-            _running = preferences->propertyBool("running", _running);
-            _subtitles = preferences->propertyBool("subtitles", _subtitles);
-            _targetHighlight = preferences->propertyBool("target_highlight", _targetHighlight);
-            _textDelay = preferences->propertyDouble("text_delay", _textDelay);
-            _violenceLevel = preferences->propertyInt("violence_level", _violenceLevel);
+        ShadowReader check{data, SHADOW_HEADER_SIZE + sizeof(uint64_t), false};
+        _fields(check);
+        if (!check.valid || check.position != data.size()) {
+            return false;
         }
-
+        _fields(ShadowReader{data, SHADOW_HEADER_SIZE + sizeof(uint64_t), true});
         return true;
     }
 
-    bool Settings::displayFps() const
+    bool Settings::load()
     {
-        return _displayFps;
-    }
+        Logger::info("") << "Loading config from " << configFile() << std::endl;
 
-    bool Settings::worldMapFullscreen() const
-    {
-        return _worldMapFullscreen;
-    }
+        if (!_readShadow()) {
+            std::ifstream stream(configFile());
+            if (!stream)
+            {
+                Logger::warning("") << "Cannot open config file at `" << configFile() << "`;" << std::endl;
+                return false;
+            }
 
-    bool Settings::displayMousePosition() const
-    {
-        return _displayMousePosition;
+            Ini::Parser parser(stream);
+            auto file = parser.parse();
+            _fields(IniReader{*file});
+            writeShadow(_shadowValues());
+        }
+
+        Logger::setLevel(_loggerLevel);
+        Logger::useColors(_loggerColors);
+        if (!_loggerFile.empty())
+        {
+            auto path = std::filesystem::path(_loggerFile).is_absolute() ? _loggerFile : CrossPlatform::getConfigPath() + "/" + _loggerFile;
+            Logger::setFile(path, _loggerFileSize * 1024, _loggerFileCount);
+        }
+        return true;
     }
 
     void Settings::setVoiceVolume(double _voiceVolume)
@@ -224,229 +446,130 @@ namespace Falltergeist
         this->_voiceVolume = _voiceVolume;
     }
 
-    double Settings::voiceVolume() const
-    {
-        return _voiceVolume;
-    }
-
     void Settings::setSfxVolume(double _sfxVolume)
     {
         this->_sfxVolume = _sfxVolume;
     }
 
-    double Settings::sfxVolume() const
-    {
-        return _sfxVolume;
-    }
-
     void Settings::setMusicVolume(double _musicVolume)
     {
         this->_musicVolume = _musicVolume;
     }
 
-    double Settings::musicVolume() const
-    {
-        return _musicVolume;
-    }
-
     void Settings::setMasterVolume(double _masterVolume)
     {
         this->_masterVolume = _masterVolume;
     }
 
-    double Settings::masterVolume() const
-    {
-        return _masterVolume;
-    }
-
-    std::string Settings::musicPath() const
-    {
-        return _musicPath;
-    }
-
     void Settings::setViolenceLevel(unsigned int _violenceLevel)
     {
         this->_violenceLevel = _violenceLevel;
     }
 
-    unsigned int Settings::violenceLevel() const
-    {
-        return _violenceLevel;
-    }
-
     void Settings::setTextDelay(double _textDelay)
     {
         this->_textDelay = _textDelay;
     }
 
-    double Settings::textDelay() const
-    {
-        return _textDelay;
-    }
-
     void Settings::setTargetHighlight(bool _targetHighlight)
     {
         this->_targetHighlight = _targetHighlight;
     }
 
-    bool Settings::targetHighlight() const
-    {
-        return _targetHighlight;
-    }
-
     void Settings::setSubtitles(bool _subtitles)
     {
         this->_subtitles = _subtitles;
     }
 
-    bool Settings::subtitles() const
-    {
-        return _subtitles;
-    }
-
     void Settings::setRunning(bool _running)
     {
         this->_running = _running;
     }
 
-    bool Settings::running() const
-    {
-        return _running;
-    }
-
     void Settings::setPlayerSpeedup(bool _playerSpeedup)
     {
         this->_playerSpeedup = _playerSpeedup;
     }
 
-    bool Settings::playerSpeedup() const
-    {
-        return _playerSpeedup;
-    }
-
     void Settings::setMouseSensitivity(double _mouseSensitivity)
     {
         this->_mouseSensitivity = _mouseSensitivity;
     }
 
-    double Settings::mouseSensitivity() const
-    {
-        return _mouseSensitivity;
-    }
-
     void Settings::setLanguageFilter(bool _languageFilter)
     {
         this->_languageFilter = _languageFilter;
     }
 
-    bool Settings::languageFilter() const
-    {
-        return _languageFilter;
-    }
-
     void Settings::setItemHighlight(bool _itemHighlight)
     {
         this->_itemHighlight = _itemHighlight;
     }
 
-    bool Settings::itemHighlight() const
-    {
-        return _itemHighlight;
-    }
-
     void Settings::setCombatSpeed(unsigned int _combatSpeed)
     {
         this->_combatSpeed = _combatSpeed;
     }
 
-    unsigned int Settings::combatSpeed() const
-    {
-        return _combatSpeed;
-    }
-
     void Settings::setCombatTaunts(bool _combatTaunts)
     {
         this->_combatTaunts = _combatTaunts;
     }
 
-    bool Settings::combatTaunts() const
-    {
-        return _combatTaunts;
-    }
-
     void Settings::setCombatMessages(bool _combatMessages)
     {
         this->_combatMessages = _combatMessages;
     }
 
-    bool Settings::combatMessages() const
-    {
-        return _combatMessages;
-    }
-
     void Settings::setCombatLooks(bool _combatLooks)
     {
         this->_combatLooks = _combatLooks;
     }
 
-    bool Settings::combatLooks() const
-    {
-        return _combatLooks;
-    }
-
     void Settings::setCombatDifficulty(unsigned int _combatDifficulty)
     {
         this->_combatDifficulty = _combatDifficulty;
     }
 
-    unsigned int Settings::combatDifficulty() const
-    {
-        return _combatDifficulty;
-    }
-
     void Settings::setGameDifficulty(unsigned int _gameDifficulty)
     {
         this->_gameDifficulty = _gameDifficulty;
     }
 
-    unsigned int Settings::gameDifficulty() const
-    {
-        return _gameDifficulty;
-    }
-
     void Settings::setBrightness(double _brightness)
     {
         this->_brightness = _brightness;
     }
 
-    double Settings::brightness() const
+    void Settings::setScale(unsigned int _scale)
     {
-        return _brightness;
+        this->_scale = _scale;
     }
 
-    void Settings::setScale(unsigned int _scale)
+    void Settings::setFullscreen(bool _fullscreen)
     {
-        this->_scale = _scale;
+        this->_fullscreen = _fullscreen;
     }
 
-    unsigned int Settings::scale() const
+    void Settings::setVsync(bool _vsync)
     {
-        return _scale;
+        this->_vsync = _vsync;
     }
 
-    void Settings::setFullscreen(bool _fullscreen)
+    void Settings::setHeadless(bool _headless)
     {
-        this->_fullscreen = _fullscreen;
+        this->_headless = _headless;
     }
 
-    bool Settings::fullscreen() const
+    unsigned int Settings::simulationRate() const
     {
-        return _fullscreen;
+        // zero would never advance the game
+        return _simulationRate > 0 ? _simulationRate : 60;
     }
 
-    bool Settings::alwaysOnTop() const
+    void Settings::setSimulationRate(unsigned int _simulationRate)
     {
-        return _alwaysOnTop;
+        this->_simulationRate = _simulationRate;
     }
 
     void Settings::setAudioBufferSize(int _audioBufferSize)
@@ -454,8 +577,4 @@ namespace Falltergeist
         this->_audioBufferSize = _audioBufferSize;
     }
 
-    int Settings::audioBufferSize() const
-    {
-        return _audioBufferSize;
-    }
 }
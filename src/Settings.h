@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <future>
+#include <mutex>
 #include <string>
 
 namespace Falltergeist
@@ -20,91 +23,470 @@ namespace Falltergeist
             Settings();
             ~Settings();
 
+            // Writes config.ini on a background thread, saves made while it is written are merged into one write
             bool save();
+
+            // Reads the binary copy of the values kept next to the cache as long as config.ini is unchanged since
             bool load();
 
-            unsigned int screenWidth() const;
+            unsigned int screenWidth() const
+            {
+                return _screenWidth;
+            }
+
+            unsigned int screenHeight() const
+            {
+                return _screenHeight;
+            }
+
+            int screenX() const
+            {
+                return _screenX;
+            }
+
+            int screenY() const
+            {
+                return _screenY;
+            }
+
+            const std::string& initialLocation() const
+            {
+                return _initLocation;
+            }
+
+            bool forceLocation() const
+            {
+                return _forceLocation;
+            }
+
+            bool displayFps() const
+            {
+                return _displayFps;
+            }
+
+            bool worldMapFullscreen() const
+            {
+                return _worldMapFullscreen;
+            }
+
+            bool displayMousePosition() const
+            {
+                return _displayMousePosition;
+            }
+
+            // Memory budget of the resource cache, in megabytes
+            unsigned int resourceCacheSize() const
+            {
+                return _resourceCacheSize;
+            }
+
+            // Keeps the tile atlases built for locations in the cache directory, so entering them again skips decoding the tile art
+            bool locationCache() const
+            {
+                return _locationCache;
+            }
+
+            // Time scheduled script procedures may run per frame, in microseconds
+            unsigned int scriptBudget() const
+            {
+                return _scriptBudget;
+            }
+
+            // Hexagons around the player in which critter_p_proc runs for critters which are not awake
+            unsigned int critterWakeRadius() const
+            {
+                return _critterWakeRadius;
+            }
+
+            // Compresses save games with zlib, they are written faster without it but take more space
+            bool saveCompression() const
+            {
+                return _saveCompression;
+            }
+
+            // Threads running the think of map objects which only animate themselves, 0 for one per core, 1 thinks on the main thread
+            unsigned int thinkThreads() const
+            {
+                return _thinkThreads;
+            }
+
+            // Maps left last which are kept loaded, so walking back to them doesn't load them again. 0 disables
+            unsigned int keptLocations() const
+            {
+                return _keptLocations;
+            }
 
-            unsigned int screenHeight() const;
+            // Logs every change of a global or map variable with the script making it
+            bool traceVariables() const
+            {
+                return _traceVariables;
+            }
 
-            int screenX() const;
+            // Collects script opcode and procedure timings, written to script_profile.csv in the config directory
+            bool scriptProfiler() const
+            {
+                return _scriptProfiler;
+            }
 
-            int screenY() const;
+            // Keeps timings of the last frames, written to trace.json in the config directory (F9) in the Chrome trace format
+            bool frameTrace() const
+            {
+                return _frameTrace;
+            }
 
-            const std::string& initialLocation() const;
+            // Frames taking longer than this many milliseconds write trace-spike.json by themselves, 0 disables it
+            unsigned int frameTraceSpike() const
+            {
+                return _frameTraceSpike;
+            }
 
-            bool forceLocation() const;
+            // Shows draw calls, binds, uploads and GPU pass times below the FPS counter, F8 writes render_stats.csv
+            bool renderStats() const
+            {
+                return _renderStats;
+            }
 
-            bool displayFps() const;
+            // Shows memory by subsystem and appends it to memory_stats.csv every memoryStatsInterval() seconds and at exit
+            bool memoryStats() const
+            {
+                return _memoryStats;
+            }
 
-            bool worldMapFullscreen() const;
+            // 0 only writes at exit
+            unsigned int memoryStatsInterval() const
+            {
+                return _memoryStatsInterval;
+            }
 
-            bool displayMousePosition() const;
+            // Appends cache hit rates, load times, script, pathfinding and frame metrics to telemetry.csv
+            // every telemetryInterval() seconds and at exit
+            bool telemetry() const
+            {
+                return _telemetry;
+            }
+
+            // 0 only writes at exit
+            unsigned int telemetryInterval() const
+            {
+                return _telemetryInterval;
+            }
+
+            // Records the files each map uses to a manifest in the cache directory, which is preloaded on later visits
+            bool recordManifests() const
+            {
+                return _recordManifests;
+            }
+
+            // Shows the p50, p95 and p99 frame times and the number of hitches next to the FPS counter
+            bool frameStats() const
+            {
+                return _frameStats;
+            }
+
+            // Frames taking longer than this many milliseconds log the resources, scripts and states of the frame, 0 disables it
+            unsigned int hitchThreshold() const
+            {
+                return _hitchThreshold;
+            }
+
+            // Presents nothing new while every visible state shows a cached layer and nothing on top of it changed
+            bool skipIdleFrames() const
+            {
+                return _skipIdleFrames;
+            }
+
+            // Standard pointers are shown by the system cursor, which follows the mouse without waiting for a frame.
+            // The hexagon and animated cursors are still rendered, screen captures don't show the system one
+            bool hardwareCursor() const
+            {
+                return _hardwareCursor;
+            }
+
+            bool audioEnabled() const
+            {
+                return _audioEnabled;
+            }
 
-            bool audioEnabled() const;
             void setVoiceVolume(double _voiceVolume);
-            double voiceVolume() const;
+            double voiceVolume() const
+            {
+                return _voiceVolume;
+            }
+
             void setSfxVolume(double _sfxVolume);
-            double sfxVolume() const;
+            double sfxVolume() const
+            {
+                return _sfxVolume;
+            }
+
             void setMusicVolume(double _musicVolume);
-            double musicVolume() const;
+            double musicVolume() const
+            {
+                return _musicVolume;
+            }
+
             void setMasterVolume(double _masterVolume);
-            double masterVolume() const;
-            std::string musicPath() const;
+            double masterVolume() const
+            {
+                return _masterVolume;
+            }
+
+            std::string musicPath() const
+            {
+                return _musicPath;
+            }
+
             void setViolenceLevel(unsigned int _violenceLevel);
-            unsigned int violenceLevel() const;
+            unsigned int violenceLevel() const
+            {
+                return _violenceLevel;
+            }
+
             void setTextDelay(double _textDelay);
-            double textDelay() const;
+            double textDelay() const
+            {
+                return _textDelay;
+            }
+
             void setTargetHighlight(bool _targetHighlight);
-            bool targetHighlight() const;
+            bool targetHighlight() const
+            {
+                return _targetHighlight;
+            }
+
             void setSubtitles(bool _subtitles);
-            bool subtitles() const;
+            bool subtitles() const
+            {
+                return _subtitles;
+            }
+
             void setRunning(bool _running);
-            bool running() const;
+            bool running() const
+            {
+                return _running;
+            }
+
             void setPlayerSpeedup(bool _playerSpeedup);
-            bool playerSpeedup() const;
+            bool playerSpeedup() const
+            {
+                return _playerSpeedup;
+            }
+
             void setMouseSensitivity(double _mouseSensitivity);
-            double mouseSensitivity() const;
+            double mouseSensitivity() const
+            {
+                return _mouseSensitivity;
+            }
+
             void setLanguageFilter(bool _languageFilter);
-            bool languageFilter() const;
+            bool languageFilter() const
+            {
+                return _languageFilter;
+            }
+
             void setItemHighlight(bool _itemHighlight);
-            bool itemHighlight() const;
+            bool itemHighlight() const
+            {
+                return _itemHighlight;
+            }
+
             void setCombatSpeed(unsigned int _combatSpeed);
-            unsigned int combatSpeed() const;
+            unsigned int combatSpeed() const
+            {
+                return _combatSpeed;
+            }
+
+            // Scale of the animation clock for combatSpeed(), from 1 at 0 to 2 at the slider maximum of 50
+            float animationSpeed() const
+            {
+                return 1.0f + std::min(_combatSpeed, 50u) / 50.0f;
+            }
+
             void setCombatTaunts(bool _combatTaunts);
-            bool combatTaunts() const;
+            bool combatTaunts() const
+            {
+                return _combatTaunts;
+            }
+
             void setCombatMessages(bool _combatMessages);
-            bool combatMessages() const;
+            bool combatMessages() const
+            {
+                return _combatMessages;
+            }
+
             void setCombatLooks(bool _combatLooks);
-            bool combatLooks() const;
+            bool combatLooks() const
+            {
+                return _combatLooks;
+            }
+
             void setCombatDifficulty(unsigned int _combatDifficulty);
-            unsigned int combatDifficulty() const;
+            unsigned int combatDifficulty() const
+            {
+                return _combatDifficulty;
+            }
+
             void setGameDifficulty(unsigned int _gameDifficulty);
-            unsigned int gameDifficulty() const;
+            unsigned int gameDifficulty() const
+            {
+                return _gameDifficulty;
+            }
+
             void setBrightness(double _brightness);
-            double brightness() const;
+            double brightness() const
+            {
+                return _brightness;
+            }
+
             void setScale(unsigned int _scale);
-            unsigned int scale() const;
+            unsigned int scale() const
+            {
+                return _scale;
+            }
+
+            // How the game resolution is scaled up to the window: nearest, integer or xbr
+            const std::string& scaleFilter() const
+            {
+                return _scaleFilter;
+            }
+
+            // Megabytes of file textures kept on the GPU, 0 keeps them all
+            unsigned int textureBudget() const
+            {
+                return _textureBudget;
+            }
+
+            // Kilobytes of new textures uploaded per frame, 0 uploads them as soon as they are created
+            unsigned int textureUploadBudget() const
+            {
+                return _textureUploadBudget;
+            }
+
             void setFullscreen(bool _fullscreen);
-            bool fullscreen() const;
-            bool alwaysOnTop() const;
+            bool fullscreen() const
+            {
+                return _fullscreen;
+            }
+
+            bool alwaysOnTop() const
+            {
+                return _alwaysOnTop;
+            }
+
+            void setVsync(bool _vsync);
+            bool vsync() const
+            {
+                return _vsync;
+            }
+
+            // OpenGL ES context with a 16 bit framebuffer and indexed tiles, for ARM handhelds
+            bool gles() const
+            {
+                return _gles;
+            }
+
+            // Hidden window and no audio device, for the benchmark. Not saved to the config
+            void setHeadless(bool _headless);
+            bool headless() const
+            {
+                return _headless;
+            }
+
+            // Rendered frames per second when vsync is off, 0 renders as fast as possible
+            unsigned int frameLimit() const
+            {
+                return _frameLimit;
+            }
+
+            // Busy-wait the last millisecond of a frame instead of sleeping, for steadier pacing at the cost of CPU time
+            bool frameSpinWait() const
+            {
+                return _frameSpinWait;
+            }
+
+            // Fixed logic updates per second, independent of the rendering rate
+            unsigned int simulationRate() const;
+            // Replays run at the rate they were recorded with
+            void setSimulationRate(unsigned int _simulationRate);
             void setAudioBufferSize(int _audioBufferSize);
-            int audioBufferSize() const;
+            int audioBufferSize() const
+            {
+                return _audioBufferSize;
+            }
+
+            // Memory budget of the decoded sound effects, in megabytes
+            unsigned int sfxCacheSize() const
+            {
+                return _sfxCacheSize;
+            }
 
         private:
+            // Calls visitor(section, key, field) for every option saved to config.ini
+            template <typename Visitor>
+            void _fields(Visitor&& visitor);
+
+            // Hash of the keys followed by the values of all options
+            std::string _shadowValues();
+
+            bool _readShadow();
+
+            void _writePending();
+
+            std::future<void> _writer;
+            std::mutex _writeMutex;
+            std::string _pendingIni;
+            std::string _pendingValues;
+            bool _hasPendingWrite = false;
+            bool _writing = false;
+
             unsigned int _screenWidth = 640;
             unsigned int _screenHeight = 480;
             int _screenX = -1;
             int _screenY = -1;
             bool _alwaysOnTop = false;
+            bool _vsync = false;
+            bool _gles = false;
+            bool _headless = false;
+            unsigned int _frameLimit = 60;
+            bool _frameSpinWait = false;
+            unsigned int _simulationRate = 60;
             std::string _initLocation = "klamall";
             bool _forceLocation = false;
             bool _displayFps = true;
             bool _worldMapFullscreen = false;
             bool _displayMousePosition = true;
+            unsigned int _resourceCacheSize = 256;
+            bool _locationCache = true;
+            unsigned int _scriptBudget = 4000;
+            bool _scriptProfiler = false;
+            bool _frameTrace = false;
+            unsigned int _frameTraceSpike = 100;
+            bool _renderStats = false;
+            bool _memoryStats = false;
+            unsigned int _memoryStatsInterval = 60;
+            bool _telemetry = false;
+            unsigned int _telemetryInterval = 300;
+            bool _recordManifests = false;
+            bool _frameStats = false;
+            unsigned int _hitchThreshold = 100;
+            unsigned int _critterWakeRadius = 20;
+            unsigned int _thinkThreads = 0;
+            unsigned int _keptLocations = 2;
+            bool _traceVariables = false;
+            bool _saveCompression = true;
+            bool _skipIdleFrames = true;
+            bool _hardwareCursor = false;
             std::string _loggerLevel = "info";
             bool _loggerColors = true;
+            // log file, relative paths are inside the config directory; empty logs to standard output only
+            std::string _loggerFile = "";
+            // kilobytes a log file may grow to before it is rotated
+            unsigned int _loggerFileSize = 1024;
+            unsigned int _loggerFileCount = 3;
             unsigned int _scale = 0;
+            std::string _scaleFilter = "nearest";
+            unsigned int _textureBudget = 0;
+            unsigned int _textureUploadBudget = 0;
             bool _fullscreen = false;
 
             double _brightness = 1.0;
@@ -131,5 +513,6 @@ namespace Falltergeist
             double _sfxVolume = 1.0;
             double _voiceVolume = 1.0;
             int _audioBufferSize = 512;
+            unsigned int _sfxCacheSize = 16;
     };
 }
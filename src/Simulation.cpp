@@ -0,0 +1,69 @@
+#include <random>
+#include "Simulation.h"
+
+namespace Falltergeist
+{
+    namespace
+    {
+        struct State
+        {
+            // steps aren't whole milliseconds, the rest is carried over
+            double fraction = 0.0;
+            double animationFraction = 0.0;
+            float animationSpeed = 1.0f;
+            uint32_t seed = 0;
+            std::minstd_rand generator;
+        };
+
+        State& state()
+        {
+            static State instance;
+            return instance;
+        }
+    }
+
+    std::atomic<uint32_t> Simulation::_ticks(0);
+    std::atomic<uint32_t> Simulation::_animationTicks(0);
+
+    void Simulation::advance(float milliseconds)
+    {
+        auto& simulation = state();
+        simulation.fraction += milliseconds;
+        auto whole = static_cast<uint32_t>(simulation.fraction);
+        simulation.fraction -= whole;
+        _ticks.fetch_add(whole, std::memory_order_relaxed);
+
+        simulation.animationFraction += milliseconds * simulation.animationSpeed;
+        auto animationWhole = static_cast<uint32_t>(simulation.animationFraction);
+        simulation.animationFraction -= animationWhole;
+        _animationTicks.fetch_add(animationWhole, std::memory_order_relaxed);
+    }
+
+    void Simulation::setAnimationSpeed(float speed)
+    {
+        state().animationSpeed = speed > 0.0f ? speed : 1.0f;
+    }
+
+    float Simulation::animationSpeed()
+    {
+        return state().animationSpeed;
+    }
+
+    void Simulation::seed(uint32_t value)
+    {
+        auto& simulation = state();
+        simulation.seed = value;
+        simulation.generator.seed(value);
+    }
+
+    uint32_t Simulation::seedValue()
+    {
+        return state().seed;
+    }
+
+    int Simulation::random()
+    {
+        // minstd_rand yields 1 to 2^31 - 2
+        return static_cast<int>(state().generator() - 1);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Falltergeist
+{
+    /**
+     * Time and random numbers of the game logic. The clock advances with the logic steps rather than with the wall
+     * clock and the random numbers come from a generator of its own, so the same inputs and the same seed play
+     * a session again exactly (see Game::Replay).
+     */
+    class Simulation final
+    {
+        public:
+            // Milliseconds of logic run so far, in place of SDL_GetTicks(). Any thread
+            static uint32_t ticks()
+            {
+                return _ticks.load(std::memory_order_relaxed);
+            }
+
+            // Milliseconds of animation played so far, the clock of every UI::Animation. Any thread.
+            // Advances with ticks(), but faster or slower by animationSpeed()
+            static uint32_t animationTicks()
+            {
+                return _animationTicks.load(std::memory_order_relaxed);
+            }
+
+            // Main thread only, like the following ones. Called by every logic step
+            static void advance(float milliseconds);
+
+            // Scale of the animation clock, 1 by default. Meant for the combat speed of the preferences,
+            // so all animations speed up together and the logic clock stays the same
+            static void setAnimationSpeed(float speed);
+
+            static float animationSpeed();
+
+            static void seed(uint32_t value);
+
+            static uint32_t seedValue();
+
+            // Non-negative, in place of rand()
+            static int random();
+
+        private:
+            static std::atomic<uint32_t> _ticks;
+            static std::atomic<uint32_t> _animationTicks;
+    };
+}
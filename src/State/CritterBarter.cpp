@@ -159,10 +159,7 @@ namespace Falltergeist
             sellList->itemDragStopHandler().add([mineList, sellList](Event::Mouse* event){ mineList->onItemDragStop(event, sellList); });
             sellList->itemsListModifiedHandler().add([this, sellPriceText](Event::Event*)
                 {
-                    _sellPriceTotal = 0;
-                    for (const auto &v : _itemsToSell) {
-                        _sellPriceTotal += v->price() * v->amount();
-                    }
+                    _sellPriceTotal = _itemsToSell.price();
                     sellPriceText->setText("$" + std::to_string(_sellPriceTotal));
                 });
 
@@ -170,11 +167,8 @@ namespace Falltergeist
             buyList->itemDragStopHandler().add([theirsList, buyList](Event::Mouse* event){ theirsList->onItemDragStop(event, buyList); });
             buyList->itemsListModifiedHandler().add([this, buyPriceText](Event::Event*)
                 {
-                    _buyPriceTotal = 0;
-                    for (const auto &v : _itemsToBuy) {
-                        // TODO: apply barter skill + Master Trader perk + Reaction (mood?) modifier
-                        _buyPriceTotal += v->price() * v->amount();
-                    }
+                    // TODO: apply barter skill + Master Trader perk + Reaction (mood?) modifier
+                    _buyPriceTotal = _itemsToBuy.price();
                     buyPriceText->setText("$" + std::to_string(_buyPriceTotal));
                 });
         }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include "../Game/Inventory.h"
 #include "../State/State.h"
 #include "../UI/IResourceManager.h"
 
@@ -45,8 +46,8 @@ namespace Falltergeist
                 int _buyPriceTotal = 0;
 
                 Game::CritterObject* _trader = nullptr;
-                std::vector<Game::ItemObject*> _itemsToSell;
-                std::vector<Game::ItemObject*> _itemsToBuy;
+                Game::Inventory _itemsToSell;
+                Game::Inventory _itemsToBuy;
 
             private:
                 std::shared_ptr<UI::IResourceManager> resourceManager;
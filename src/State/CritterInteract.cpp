@@ -3,6 +3,8 @@
 #include "../State/CritterInteract.h"
 #include "../Format/Lst/File.h"
 #include "../Format/Lip/File.h"
+#include "../Format/Msg/File.h"
+#include "../Format/Msg/Message.h"
 #include "../Game/CritterObject.h"
 #include "../Game/Game.h"
 #include "../Graphics/Renderer.h"
@@ -10,6 +12,7 @@
 #include "../LocationCamera.h"
 #include "../PathFinding/Hexagon.h"
 #include "../ResourceManager.h"
+#include "../Simulation.h"
 #include "../State/CritterDialog.h"
 #include "../State/CritterDialogReview.h"
 #include "../State/CritterBarter.h"
@@ -20,6 +23,7 @@
 #include "../UI/AnimationFrame.h"
 #include "../UI/AnimationQueue.h"
 #include "../UI/Factory/ImageButtonFactory.h"
+#include "../VM/Script.h"
 #include "../Audio/Mixer.h"
 
 namespace Falltergeist
@@ -106,8 +110,11 @@ namespace Falltergeist
 
                 _headName = headImage;
 
+                _prefetchHead();
+                _prefetchSpeech();
+
                 _fidgetTimer.tickHandler().add([this](Event::Event* evt){
-                    uint8_t fidget = rand() % 3 + 1;
+                    uint8_t fidget = Simulation::random() % 3 + 1;
                     auto headImage = _headName;
                     switch (_mood)
                     {
@@ -127,7 +134,7 @@ namespace Falltergeist
                     head->animations().push_back(std::make_unique<UI::Animation>("art/heads/" + headImage));
 
                     head->start();
-                    _fidgetTimer.start(std::rand() % 5000 + 5000);
+                    _fidgetTimer.start(Simulation::random() % 5000 + 5000);
 
                 });
                 headImage+="gf1.frm";
@@ -159,6 +166,46 @@ namespace Falltergeist
             _barter->setTrader(critter());
         }
 
+        void CritterInteract::_prefetchHead()
+        {
+            // every mood with its fidgets and speaking animation, and the transitions between neighbouring moods
+            auto resources = ResourceManager::getInstance();
+            for (std::string mood : {"g", "n", "b"})
+            {
+                _headRequests.push_back(resources->requestFrm("art/heads/" + _headName + mood + "p.frm"));
+                for (int fidget = 1; fidget <= 3; fidget++)
+                {
+                    _headRequests.push_back(resources->requestFrm("art/heads/" + _headName + mood + "f" + std::to_string(fidget) + ".frm"));
+                }
+            }
+            for (std::string transition : {"gn", "ng", "nb", "bn"})
+            {
+                _headRequests.push_back(resources->requestFrm("art/heads/" + _headName + transition + ".frm"));
+            }
+        }
+
+        void CritterInteract::_prefetchSpeech()
+        {
+            // replies are looked up by the script once an answer is chosen, any voiced line of the dialog may come next.
+            // Speech itself is streamed by the mixer, only its lip file has to be loaded before it starts.
+            if (!script() || msgFileID() <= 0)
+            {
+                return;
+            }
+            auto msg = script()->msgFile(msgFileID());
+            if (!msg)
+            {
+                return;
+            }
+            for (auto& message : *msg->messages())
+            {
+                if (!message.sound().empty())
+                {
+                    _lipRequests.push_back(ResourceManager::getInstance()->requestLip("sound/speech/" + _headName + "/" + message.sound() + ".lip"));
+                }
+            }
+        }
+
         int CritterInteract::backgroundID()
         {
             return _backgroundID;
@@ -224,11 +271,11 @@ namespace Falltergeist
             _fidgetTimer.stop();
             Game::Game::getInstance()->mixer()->playACMSpeech(_headName+"/"+speech+".acm");
             // start timer
-            _startTime = SDL_GetTicks();
+            _startTime = Simulation::ticks();
             _nextIndex = 0;
             _phase = Phase::TALK;
 
-            _lips = ResourceManager::getInstance()->lipFileType("sound/speech/"+_headName+"/"+speech+".lip");
+            _lips = ResourceManager::getInstance()->pin(ResourceManager::getInstance()->lipFileType("sound/speech/"+_headName+"/"+speech+".lip"));
             auto head = dynamic_cast<UI::AnimationQueue*>(getUI("head"));
             head->stop();
             head->clear();
@@ -273,14 +320,17 @@ namespace Falltergeist
                     // if playing speech - set phoneme frame
 
 
-                    if (_nextIndex < _lips->phonemes().size() && SDL_GetTicks()-_startTime>=_lips->timestamps().at(_nextIndex))
+                    // markers passed during a long frame are skipped, the head shows the latest phoneme
                     {
-                        //set frame
-                        auto head = dynamic_cast<UI::AnimationQueue*>(getUI("head"));
-                        head->currentAnimation()->setCurrentFrame(_phonemeToFrame(_lips->phonemes().at(_nextIndex)));
-                        _nextIndex++;
+                        int phoneme = _lips->advance(Simulation::ticks() - _startTime, _nextIndex);
+                        if (phoneme >= 0)
+                        {
+                            //set frame
+                            auto head = dynamic_cast<UI::AnimationQueue*>(getUI("head"));
+                            head->currentAnimation()->setCurrentFrame(_phonemeToFrame(static_cast<unsigned int>(phoneme)));
+                        }
                     }
-                    if (SDL_GetTicks()-_startTime>= (_lips->acmSize()*1000 / 22050 /2))
+                    if (Simulation::ticks()-_startTime>= (_lips->acmSize()*1000 / 22050 /2))
                     {
                         _phase = Phase::FIDGET;
                         _fidgetTimer.start(0);
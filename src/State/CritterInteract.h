@@ -2,6 +2,7 @@
 
 #include "../State/State.h"
 #include "../Game/Timer.h"
+#include "../ResourceManager.h"
 #include "../UI/IResourceManager.h"
 
 namespace Falltergeist
@@ -116,7 +117,7 @@ namespace Falltergeist
                 uint32_t _startTime;
                 uint32_t _nextIndex;
                 Phase _phase = Phase::FIDGET;
-                Format::Lip::File* _lips = nullptr;
+                std::shared_ptr<Format::Lip::File> _lips;
                 int32_t _goodFidgets;
                 int32_t _neutralFidgets;
                 int32_t _badFidgets;
@@ -127,8 +128,15 @@ namespace Falltergeist
                 CritterDialogReview* _review;
 
                 SubState _state = SubState::NONE;
+
+                // head animations and lip files of the conversation, pinned until it ends
+                std::vector<ResourceRequest<Format::Frm::File>> _headRequests;
+                std::vector<ResourceRequest<Format::Lip::File>> _lipRequests;
             private:
                 std::shared_ptr<UI::IResourceManager> resourceManager;
+
+                void _prefetchHead();
+                void _prefetchSpeech();
         };
     }
 }
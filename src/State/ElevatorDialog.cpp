@@ -16,16 +16,11 @@
 #include "../Format/Enums.h"
 #include "../Game/Elevator.h"
 #include "../Helpers/StateElevatorHelper.h"
-#include "../Helpers/GameLocationHelper.h"
-#include "../Helpers/StateLocationHelper.h"
 #include "../Format/Txt/MapsFile.h"
-#include "../PathFinding/Hexagon.h"
 
 namespace Falltergeist
 {
     using ImageButtonType = UI::Factory::ImageButtonFactory::Type;
-    using Helpers::StateLocationHelper;
-    using Helpers::GameLocationHelper;
 
     namespace State
     {
@@ -54,6 +49,15 @@ namespace Falltergeist
             auto elevatorHelper = Helpers::StateElevatorHelper(logger);
             this->_elevator = elevatorHelper.getByType(this->_elevatorType);
 
+            // the player is going to pick one of the floors, start loading the other maps right away
+            auto locationState = Game::Game::getInstance()->locationState();
+            auto mapsFile = ResourceManager::getInstance()->mapsTxt();
+            for (auto floor : _elevator->floors()) {
+                if (floor->mapId != locationState->currentMapIndex() && floor->mapId < mapsFile->count()) {
+                    locationState->preloadMap(mapsFile->map(floor->mapId).name);
+                }
+            }
+
             auto panelFrmLstId = 143;
             auto labelsFrmLstId = -1;
             uint8_t elevatorPosition = 0;
@@ -131,7 +135,7 @@ namespace Falltergeist
                 auto floors  = _elevator->floors();
                 auto destination = floors.at(pressedButtonIndex);
                 auto mapsFile = ResourceManager::getInstance()->mapsTxt();
-                std::string mapName = mapsFile->maps().at(destination->mapId).name;
+                std::string mapName = mapsFile->map(destination->mapId).name;
 
                 logger->info() << "[ELEVATOR] destination map = " << destination->mapId << " elevation=" << destination->elevation << " position=" << destination->position << std::endl;
                 logger->info() << "[ELEVATOR] destination map file = " << mapName << std::endl;
@@ -139,18 +143,10 @@ namespace Falltergeist
                 //Game::Game::getInstance()->mixer()->playACMSound("sound/sfx/elevator.acm");
                 Game::Game::getInstance()->popState();
 
-                if (Game::Game::getInstance()->locationState()->currentMapIndex() == destination->mapId) {
-                    logger->info() << "[ELEVATOR] same location";
-                    Game::Game::getInstance()->locationState()->setElevation(destination->elevation);
-                    Game::Game::getInstance()->locationState()->setPosition(Hexagon(destination->position).position());
-                } else {
-                    logger->info() << "[ELEVATOR] loading map...";
-                    Helpers::GameLocationHelper gameLocationHelper(logger);
-                    Helpers::StateLocationHelper stateLocationHelper(logger);
-
-                    auto game = Game::Game::getInstance();
-                    game->setState(stateLocationHelper.getCustomLocationState(mapName, destination->elevation, destination->position));
-                }
+                // other floors of the same map are states of their own too, kept once they were visited
+                auto locationState = Game::Game::getInstance()->locationState();
+                locationState->storeMapChanges();
+                locationState->travel(mapName, destination->elevation, destination->position);
             }
         }
 
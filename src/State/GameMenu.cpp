@@ -38,6 +38,7 @@ namespace Falltergeist
 
             setModal(true);
             setFullscreen(false);
+            setCachedRender(true);
 
             auto background = resourceManager->getImage("art/intrface/opbase.frm");
             auto panelHeight = Game::Game::getInstance()->locationState()->playerPanel()->size().height();
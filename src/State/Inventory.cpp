@@ -73,19 +73,19 @@ namespace Falltergeist
             addUI("background", resourceManager->getImage("art/intrface/invbox.frm"));
             getUI("background")->mouseClickHandler().add(std::bind(&Inventory::backgroundRightClick, this, std::placeholders::_1));
 
-            addUI("button_up",   imageButtonFactory->getByType(ImageButtonType::INVENTORY_UP_ARROW,   {128, 40}));
-            addUI("button_down", imageButtonFactory->getByType(ImageButtonType::INVENTORY_DOWN_ARROW, {128, 65}));
+            _scrollUpButton   = addUI("button_up",   imageButtonFactory->getByType(ImageButtonType::INVENTORY_UP_ARROW,   {128, 40}));
+            _scrollDownButton = addUI("button_down", imageButtonFactory->getByType(ImageButtonType::INVENTORY_DOWN_ARROW, {128, 65}));
             auto buttonDownDisabled = resourceManager->getImage("art/intrface/invdnds.frm");
             auto buttonUpDisabled = resourceManager->getImage("art/intrface/invupds.frm");
             buttonUpDisabled->setPosition(Point(128, 40));
             buttonDownDisabled->setPosition(Point(128, 65));
-            addUI("button_up_disabled", buttonUpDisabled);
-            addUI("button_down_disabled", buttonDownDisabled);
+            _scrollUpButtonDisabled = addUI("button_up_disabled", buttonUpDisabled);
+            _scrollDownButtonDisabled = addUI("button_down_disabled", buttonDownDisabled);
             addUI("button_done", imageButtonFactory->getByType(ImageButtonType::SMALL_RED_CIRCLE, {438, 328}));
 
             getUI("button_done")->mouseClickHandler().add(std::bind(&Inventory::onDoneButtonClick, this, std::placeholders::_1));
-            getUI("button_up")->mouseClickHandler().add(  std::bind(&Inventory::onScrollUpButtonClick, this, std::placeholders::_1));
-            getUI("button_down")->mouseClickHandler().add(std::bind(&Inventory::onScrollDownButtonClick, this, std::placeholders::_1));
+            _scrollUpButton->mouseClickHandler().add(  std::bind(&Inventory::onScrollUpButtonClick, this, std::placeholders::_1));
+            _scrollDownButton->mouseClickHandler().add(std::bind(&Inventory::onScrollDownButtonClick, this, std::placeholders::_1));
 
             // screen
             auto screenX = 300;
@@ -242,7 +242,7 @@ namespace Falltergeist
 
             auto inventoryList = new UI::ItemsList(Point(40, 40));
             inventoryList->setItems(game->player()->inventory());
-            addUI("inventory_list", inventoryList);
+            _inventoryList = addUI("inventory_list", inventoryList);
 
             // TODO: this is a rotating animation in the vanilla engine
             auto dude = Game::Game::getInstance()->player();
@@ -307,7 +307,7 @@ namespace Falltergeist
 
         void Inventory::onScrollUpButtonClick(Event::Mouse* event)
         {
-            auto inventory = dynamic_cast<UI::ItemsList*>(getUI("inventory_list"));
+            auto inventory = _inventoryList;
             if(inventory->canScrollUp())
             {
                 inventory->scrollUp();
@@ -325,7 +325,7 @@ namespace Falltergeist
 
         void Inventory::onScrollDownButtonClick(Event::Mouse* event)
         {
-            auto inventory = dynamic_cast<UI::ItemsList*>(getUI("inventory_list"));
+            auto inventory = _inventoryList;
             if(inventory->canScrollDown())
             {
                 inventory->scrollDown();
@@ -343,7 +343,7 @@ namespace Falltergeist
 
         void Inventory::onInventoryModified()
         {
-            auto inventory = dynamic_cast<UI::ItemsList*>(getUI("inventory_list"));
+            auto inventory = _inventoryList;
             /*
             this would scroll up when an item is removed and you are at the bottom
             of the list to fix the gap, but a bug is causing slotOffset to be crazy number
@@ -358,18 +358,14 @@ namespace Falltergeist
 
         void Inventory::enableScrollUpButton(bool enable)
         {
-            auto scrollUpButton = dynamic_cast<UI::ImageButton*>(getUI("button_up"));
-            auto scrollUpButtonDisabled = dynamic_cast<UI::Image*>(getUI("button_up_disabled"));
-            scrollUpButtonDisabled->setVisible(!enable);
-            scrollUpButton->setEnabled(enable);
+            _scrollUpButtonDisabled->setVisible(!enable);
+            _scrollUpButton->setEnabled(enable);
         }
 
         void Inventory::enableScrollDownButton(bool enable)
         {
-            auto scrollDownButton = dynamic_cast<UI::ImageButton*>(getUI("button_down"));
-            auto scrollDownButtonDisabled = dynamic_cast<UI::Image*>(getUI("button_down_disabled"));
-            scrollDownButtonDisabled->setVisible(!enable);
-            scrollDownButton->setEnabled(enable);
+            _scrollDownButtonDisabled->setVisible(!enable);
+            _scrollDownButton->setEnabled(enable);
         }
 
         std::string Inventory::_handItemSummary (Game::ItemObject* hand)
@@ -16,6 +16,9 @@ namespace Falltergeist
         {
             class ImageButtonFactory;
         }
+        class Image;
+        class ImageButton;
+        class ItemsList;
     }
     namespace State
     {
@@ -43,6 +46,11 @@ namespace Falltergeist
                 std::string _handItemSummary (Game::ItemObject* hand);
                 std::shared_ptr<UI::IResourceManager> resourceManager;
                 std::unique_ptr<UI::Factory::ImageButtonFactory> imageButtonFactory;
+                UI::ItemsList* _inventoryList = nullptr;
+                UI::ImageButton* _scrollUpButton = nullptr;
+                UI::ImageButton* _scrollDownButton = nullptr;
+                UI::Image* _scrollUpButtonDisabled = nullptr;
+                UI::Image* _scrollDownButtonDisabled = nullptr;
                 void _screenShow (unsigned int PID);
         };
     }
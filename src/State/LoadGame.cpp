@@ -4,11 +4,17 @@
 #include "../Event/Mouse.h"
 #include "../Event/State.h"
 #include "../functions.h"
+#include "../Game/DudeObject.h"
 #include "../Game/Game.h"
+#include "../Game/SaveFile.h"
 #include "../Graphics/Point.h"
 #include "../Graphics/Renderer.h"
+#include "../Helpers/StateLocationHelper.h"
 #include "../Input/Mouse.h"
+#include "../Logger.h"
 #include "../ResourceManager.h"
+#include "../State/Location.h"
+#include "../State/LocationCache.h"
 #include "../State/State.h"
 #include "../UI/Factory/ImageButtonFactory.h"
 #include "../UI/Image.h"
@@ -52,9 +58,13 @@ namespace Falltergeist
             // BUTTONS
 
             // button: up arrow
-            addUI("button_up", imageButtonFactory->getByType(ImageButtonType::SMALL_UP_ARROW, {bgX + 35, bgY + 58}));
+            auto upButton = addUI("button_up", imageButtonFactory->getByType(ImageButtonType::SMALL_UP_ARROW, {bgX + 35, bgY + 58}));
+            upButton->mouseClickHandler().add([this](Event::Event* event){ _slots->scroll(-1); });
             // button: down arrow
-            addUI("button_down", imageButtonFactory->getByType(ImageButtonType::SMALL_DOWN_ARROW, {bgX + 35, bgY + 72}));
+            auto downButton = addUI("button_down", imageButtonFactory->getByType(ImageButtonType::SMALL_DOWN_ARROW, {bgX + 35, bgY + 72}));
+            downButton->mouseClickHandler().add([this](Event::Event* event){ _slots->scroll(1); });
+
+            _slots = std::make_unique<SaveSlots>(this, bgPos);
 
             // button: Done
             auto doneButton = imageButtonFactory->getByType(ImageButtonType::SMALL_RED_CIRCLE, {bgX + 391, bgY + 349});
@@ -87,9 +97,45 @@ namespace Falltergeist
             addUI(cancelButtonLabel);
         }
 
+        void LoadGame::think(const float &deltaTime)
+        {
+            State::think(deltaTime);
+            _slots->think();
+        }
+
         void LoadGame::onDoneButtonClick(Event::Mouse* event)
         {
-            Game::Game::getInstance()->popState();
+            // nothing to load from a slot which is empty or not listed yet
+            if (!_slots->saved()) {
+                return;
+            }
+
+            auto game = Game::Game::getInstance();
+            auto saveFile = game->saveFile();
+            auto filename = Game::SaveFile::slotFilename(_slots->selected());
+            if (!saveFile->read(filename)) {
+                Logger::warning("SAVE") << "Can't load " << filename << std::endl;
+                game->popState();
+                return;
+            }
+
+            // from the main menu there is no player yet, the saved one replaces the premade stats
+            if (!game->player()) {
+                auto player = std::make_unique<Game::DudeObject>();
+                player->loadFromGCDFile(ResourceManager::getInstance()->gcdFileType("premade/combat.gcd"));
+                game->setPlayer(std::move(player));
+            }
+            auto player = game->player();
+            saveFile->restoreGlobals(*game->GVARS(), *player);
+            // the kept locations belong to the game played before
+            game->locationCache()->clear();
+
+            Helpers::StateLocationHelper stateLocationHelper(game->logger());
+            game->setState(stateLocationHelper.getCustomLocationState(
+                saveFile->map(),
+                static_cast<uint32_t>(player->elevation()),
+                static_cast<uint32_t>(player->position())
+            ));
         }
 
         void LoadGame::doCancel()
@@ -132,6 +178,12 @@ namespace Falltergeist
                 case SDLK_ESCAPE:
                     doCancel();
                     break;
+                case SDLK_UP:
+                    _slots->select(_slots->selected() > 0 ? _slots->selected() - 1 : 0);
+                    break;
+                case SDLK_DOWN:
+                    _slots->select(_slots->selected() + 1);
+                    break;
             }
         }
     }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../State/SaveSlots.h"
 #include "../State/State.h"
 #include "../UI/IResourceManager.h"
 
@@ -29,6 +30,8 @@ namespace Falltergeist
 
                 void init() override;
 
+                void think(const float &deltaTime) override;
+
                 void onDoneButtonClick(Event::Mouse* event);
                 void doCancel();
                 void onCancelFadeDone(Event::State* event);
@@ -40,6 +43,7 @@ namespace Falltergeist
             private:
                 std::shared_ptr<UI::IResourceManager> resourceManager;
                 std::unique_ptr<UI::Factory::ImageButtonFactory> imageButtonFactory;
+                std::unique_ptr<SaveSlots> _slots;
         };
     }
 }
@@ -1,17 +1,24 @@
 ﻿#include <algorithm>
 #include <cstdlib>
+#include <future>
 #include <list>
 #include <memory>
+#include <thread>
 #include "../State/Location.h"
 #include "../Audio/Mixer.h"
+#include "../Base/JobSystem.h"
 #include "../Exception.h"
 #include "../Format/Msg/File.h"
 #include "../Format/Txt/MapsFile.h"
 #include "../Format/Gam/File.h"
 #include "../functions.h"
+#include "../Game/CombatAI.h"
 #include "../Game/ContainerItemObject.h"
+#include "../Game/CritterObject.h"
 #include "../Game/Defines.h"
 #include "../Game/DoorSceneryObject.h"
+#include "../Game/Elevator.h"
+#include "../Game/ElevatorSceneryObject.h"
 #include "../Game/ExitMiscObject.h"
 #include "../Game/Game.h"
 #include "../Game/LadderSceneryObject.h"
@@ -19,26 +26,41 @@
 #include "../Game/Location.h"
 #include "../Game/LocationElevation.h"
 #include "../Game/ObjectFactory.h"
+#include "../Game/SaveFile.h"
 #include "../Game/SpatialObject.h"
 #include "../Game/WeaponItemObject.h"
+#include "../Graphics/Automap.h"
+#include "../Graphics/CritterAnimationFactory.h"
+#include "../Graphics/OutlinePass.h"
+#include "../Graphics/PickingPass.h"
+#include "../Graphics/Renderer.h"
+#include "../Helpers/CritterHelper.h"
 #include "../Helpers/GameLocationHelper.h"
 #include "../Helpers/GameObjectHelper.h"
+#include "../Helpers/StateElevatorHelper.h"
 #include "../LocationCamera.h"
 #include "../Logger.h"
+#include "../PathFinding/DistanceField.h"
 #include "../PathFinding/Hexagon.h"
 #include "../PathFinding/HexagonGrid.h"
 #include "../ResourceManager.h"
 #include "../Settings.h"
+#include "../Simulation.h"
 #include "../State/CursorDropdown.h"
+#include "../State/LocationCache.h"
 #include "../State/WorldMap.h"
+#include "../Trace.h"
 #include "../UI/Animation.h"
 #include "../UI/AnimationFrame.h"
 #include "../UI/AnimationQueue.h"
+#include "../UI/FloatMessagePool.h"
 #include "../UI/PlayerPanel.h"
 #include "../UI/SmallCounter.h"
 #include "../UI/TextArea.h"
 #include "../UI/Tile.h"
 #include "../UI/TileMap.h"
+#include "../VM/Scheduler.h"
+#include "../VM/Script.h"
 
 namespace Falltergeist
 {
@@ -50,7 +72,15 @@ namespace Falltergeist
         using namespace Base;
 
         const int Location::DROPDOWN_DELAY = 350;
+        const int Location::CRITTER_SCRIPT_INTERVAL = 1000;
         const int Location::KEYBOARD_SCROLL_STEP = 35;
+        const unsigned int Location::NEAR_THINK_INTERVAL = 4;
+        const unsigned int Location::EXIT_PRELOAD_DISTANCE = 10;
+        const size_t Location::PARALLEL_THINK_OBJECTS = 256;
+        const unsigned int Location::OBJECT_BUCKET_SIZE = 8;
+        const unsigned int Location::GRID_MARGIN = 10;
+        const int Location::UI_PREFETCH_MARGIN = 128;
+        const unsigned int Location::AUTOMAP_REVEAL_RADIUS = 16;
 
         Location::Location(
             std::shared_ptr<Game::DudeObject> player,
@@ -67,12 +97,31 @@ namespace Falltergeist
             settings(std::move(settings)),
             renderer(std::move(renderer)),
             audioMixer(std::move(audioMixer)),
-            gameTime(std::move(gameTime))
+            gameTime(std::move(gameTime)),
+            _floatMessages(std::make_unique<UI::FloatMessagePool>())
         {
+            _requestOwner = ResourceManager::getInstance()->requestOwner();
             this->resourceManager = std::move(resourceManager);
             this->logger = std::move(logger);
         }
 
+        Location::~Location()
+        {
+            for (auto& objects : _objectsByType) {
+                for (auto object : objects) {
+                    object->uiHandler() = nullptr;
+                }
+            }
+            for (auto spatial : _spatials) {
+                spatial->uiHandler() = nullptr;
+            }
+            ResourceManager::getInstance()->cancelRequests(_requestOwner);
+            // the world map and other screens after the location are not part of its manifest
+            if (_manifestRecording) {
+                ResourceManager::getInstance()->endManifest(_manifestRecording);
+            }
+        }
+
         void Location::init()
         {
             if (initialized()) {
@@ -80,6 +129,26 @@ namespace Falltergeist
             }
             State::init();
 
+            if (settings->recordManifests()) {
+                _manifestRecording = ResourceManager::getInstance()->beginManifest(_location->name());
+            }
+
+            auto elevation = _location->elevations()->at(_elevation);
+            elevation->setEntered(true);
+
+            // Tile and critter images are loaded in the background while the rest of the location is set up
+            elevation->floor()->prefetch();
+            elevation->roof()->prefetch();
+            {
+                Graphics::CritterAnimationFactory animationFactory;
+                Helpers::CritterHelper critterHelper;
+                for (auto &object : *elevation->objects()) {
+                    if (auto critter = dynamic_cast<Game::CritterObject*>(object)) {
+                        animationFactory.prefetchAnimationSet(critterHelper.armorFID(critter), critterHelper.weaponId(critter));
+                    }
+                }
+            }
+
             mouse->setState(Input::Mouse::Cursor::ACTION);
 
             _camera = std::make_unique<LocationCamera>(renderer->size(), Point(0, 0));
@@ -93,78 +162,119 @@ namespace Falltergeist
 
             _objects.clear();
             _flatObjects.clear();
+            for (auto& objects : _objectsByType) {
+                objects.clear();
+            }
+            _critters.clear();
+            _doors.clear();
+            _objectsByPID.clear();
+
+            // the grid covers the tiles and objects of the elevation, with room around them for scripts moving things
+            {
+                std::vector<unsigned int> numbers = {_location->defaultPosition()};
+                for (auto &object : *elevation->objects()) {
+                    if (object->position() >= 0) {
+                        numbers.push_back(static_cast<unsigned int>(object->position()));
+                    }
+                }
+                std::vector<Point> points;
+                for (auto tileMap : {elevation->floor(), elevation->roof()}) {
+                    for (auto &tile : tileMap->tiles()) {
+                        // corners of the 80x36 tile image
+                        auto &position = tile.second->position();
+                        points.push_back(position);
+                        points.push_back(position + Point(80, 0));
+                        points.push_back(position + Point(0, 36));
+                        points.push_back(position + Point(80, 36));
+                    }
+                }
+                _hexagonGrid = std::make_unique<HexagonGrid>(HexagonGrid::cover(numbers, points, GRID_MARGIN));
+            }
+            _automap = std::make_unique<Graphics::Automap>(_hexagonGrid.get(), 2);
+            const auto &region = _hexagonGrid->region();
+            _objectBuckets.assign(
+                ((region.width + OBJECT_BUCKET_SIZE - 1) / OBJECT_BUCKET_SIZE) * ((region.height + OBJECT_BUCKET_SIZE - 1) / OBJECT_BUCKET_SIZE),
+                {}
+            );
+            _renderList.clear();
+            _flatRenderList.clear();
+            _pickedObjects.clear();
             _spatials.clear();
+            _spatialIndex.assign(_hexagonGrid->size(), {});
+            _exitGrids.clear();
+            _exitHexagons.assign(_hexagonGrid->size(), false);
+            _elevationExits.clear();
+            _preloadedElevations.clear();
 
-            _hexagonGrid = std::make_unique<HexagonGrid>();
+            _combatAI.reset();
+            _scheduler = std::make_unique<VM::Scheduler>(settings->scriptBudget());
 
             initializeLightmap();
 
-            auto elevation = _location->elevations()->at(_elevation);
             // Set camera position on default
             camera()->setCenter(hexagonGrid()->at(_location->defaultPosition())->position());
 
+            auto mapsFile = ResourceManager::getInstance()->mapsTxt();
+            std::unique_ptr<Helpers::StateElevatorHelper> elevators;
+
             // @todo remove old objects from hexagonal grid
             for (auto &object : *elevation->objects()) {
 
                 auto hexagon = hexagonGrid()->at(object->position());
                 moveObjectToHexagon(object, hexagon, false);
 
-                if (object->ui()) {
-                    object->ui()->mouseDownHandler().add(
-                        std::bind(
-                            &Location::onObjectMouseEvent,
-                            this,
-                            std::placeholders::_1,
-                            object
-                        )
-                    );
-                    object->ui()->mouseClickHandler().add(
-                        std::bind(
-                            &Location::onObjectMouseEvent,
-                            this,
-                            std::placeholders::_1,
-                            object
-                        )
-                    );
-                    object->ui()->mouseInHandler().add(
-                        std::bind(
-                            &Location::onObjectHover,
-                            this,
-                            std::placeholders::_1,
-                            object
-                        )
-                    );
-                    // TODO: get rid of mousemove handler?
-                    object->ui()->mouseMoveHandler().add(
-                        std::bind(
-                            &Location::onObjectHover,
-                            this,
-                            std::placeholders::_1,
-                            object
-                        )
-                    );
-                    object->ui()->mouseOutHandler().add(
-                        std::bind(
-                            &Location::onObjectHover,
-                            this,
-                            std::placeholders::_1,
-                            object
-                        )
-                    );
+                if (auto exitGrid = dynamic_cast<Game::ExitMiscObject*>(object)) {
+                    _exitGrids.push_back(exitGrid);
+                    _updateExitHexagon(hexagon);
+                }
+                if (auto ladder = dynamic_cast<Game::LadderSceneryObject*>(object)) {
+                    auto mapNumber = ladder->exitMapNumber();
+                    if (mapNumber >= 0 && static_cast<size_t>(mapNumber) < mapsFile->count() && ladder->exitElevationNumber() >= 0) {
+                        // ladders and stairs lead to another elevation of this map when the map number is 0
+                        auto mapName = mapNumber > 0
+                            ? mapsFile->map(mapNumber).name
+                            : _location->name();
+                        _elevationExits.push_back({ladder, mapName, static_cast<unsigned int>(ladder->exitElevationNumber())});
+                    }
+                }
+                if (auto elevator = dynamic_cast<Game::ElevatorSceneryObject*>(object)) {
+                    if (!elevators) {
+                        elevators = std::make_unique<Helpers::StateElevatorHelper>(logger);
+                    }
+                    if (auto type = elevators->getByType(elevator->elevatorType())) {
+                        for (auto floor : type->floors()) {
+                            if (floor->mapId >= mapsFile->count()) {
+                                continue;
+                            }
+                            _elevationExits.push_back({elevator, mapsFile->map(floor->mapId).name, floor->elevation});
+                        }
+                    }
+                }
+
+                // objects which weren't seen yet get the handlers once they build their UI
+                if (object->uiPending()) {
+                    object->uiHandler() = std::bind(&Location::_bindObjectUi, this, std::placeholders::_1);
+                } else {
+                    _bindObjectUi(object);
                 }
 
                 if (auto spatial = dynamic_cast<Game::SpatialObject*>(object)) {
                     _spatials.push_back(spatial);
+                    indexSpatial(spatial);
                     continue;
                 }
 
                 // flat objects are like tiles. they don't think (but has handlers) and rendered first.
                 if (object->flat()) {
                     _flatObjects.emplace_back(object);
+                    _flatRenderList.add(object);
+                    _register(object);
                     continue;
                 }
 
                 _objects.emplace_back(object);
+                _renderList.add(object);
+                _register(object);
             }
 
             initializePlayerTestAppareance(player);
@@ -175,11 +285,25 @@ namespace Falltergeist
 
             auto hexagon = hexagonGrid()->at(_location->defaultPosition());
             _objects.emplace_back(player);
+            _renderList.add(player.get());
+            _register(player.get());
             moveObjectToHexagon(player.get(), hexagon);
 
             elevation->floor()->init();
             elevation->roof()->init();
 
+            // decoded now rather than on first use in the middle of the game
+            for (auto name : {"ib1p1xx1", "iaccuxx1", "ipickup1", "iputdown"}) {
+                audioMixer->preloadACMSound(std::string("sound/sfx/") + name + ".acm");
+            }
+            for (auto door : _doors) {
+                if (door->soundId()) {
+                    for (auto prefix : {"sodoors", "scdoors", "sldoors"}) {
+                        audioMixer->preloadACMSound(std::string("sound/sfx/") + prefix + door->soundId() + ".acm");
+                    }
+                }
+            }
+
             //loadAmbient(name);
 
             initLight();
@@ -219,12 +343,31 @@ namespace Falltergeist
             _locationScriptTimer.start(10000.0f, true);
             _locationScriptTimer.tickHandler().add([this](Event::Event*) {
                 if (_location->script()) {
-                    _location->script()->call("map_update_p_proc");
+                    _scheduler->queue(_location->script().get(), PROCEDURE::MAP_UPDATE);
                 }
                 for (auto &object : _objects) {
-                    object->map_update_p_proc();
+                    if (object->script()) {
+                        _scheduler->queue(object->script(), PROCEDURE::MAP_UPDATE);
+                    }
+                }
+                if (player->script()) {
+                    _scheduler->queue(player->script(), PROCEDURE::MAP_UPDATE);
+                }
+            });
+
+            _critterScriptTimer.start((float)CRITTER_SCRIPT_INTERVAL, true);
+            _critterScriptTimer.tickHandler().add([this](Event::Event*) {
+                // critters far away sleep until something wakes them up
+                auto radius = settings->critterWakeRadius();
+                for (auto critter : _critters) {
+                    if (!critter->script() || !critter->script()->hasFunction(PROCEDURE::CRITTER)) {
+                        continue;
+                    }
+                    bool near = critter->hexagon() && player->hexagon() && _hexagonGrid->distance(critter->hexagon(), player->hexagon()) <= radius;
+                    if (near || critter->awake()) {
+                        _scheduler->queue(critter->script(), PROCEDURE::CRITTER);
+                    }
                 }
-                player->map_update_p_proc();
             });
         }
 
@@ -250,25 +393,24 @@ namespace Falltergeist
 
         void Location::loadAmbient(const std::string &name)
         {
-            auto maps = ResourceManager::getInstance()->mapsTxt()->maps();
+            auto mapsFile = ResourceManager::getInstance()->mapsTxt();
             auto mapShortName = path_basename(name, true);
-            auto it = find_if(maps.begin(), maps.end(), [&](const Format::Txt::Map &map) {
-                return map.name == mapShortName;
-            });
+            size_t index = 0;
 
-            if (it != maps.end()) {
-                _currentMap = static_cast<unsigned>(it - maps.begin());
+            if (mapsFile->find(mapShortName, index)) {
+                auto& map = mapsFile->map(index);
+                _currentMap = static_cast<unsigned>(index);
 
-                if (!it->music.empty() && settings->musicVolume() > 0.0001) {
-                    Logger::info("Location") << "Playing music " << it->music << std::endl;
-                    audioMixer->playACMMusic(it->music + ".acm");
+                if (!map.music.empty() && settings->musicVolume() > 0.0001) {
+                    Logger::info("Location") << "Playing music " << map.music << std::endl;
+                    audioMixer->playACMMusic(map.music + ".acm");
                 } else {
                     Logger::info("Location") << "Map " << mapShortName << " has no music." << std::endl;
                 }
-                _ambientSfx = it->ambientSfx;
+                _ambientSfx = map.ambientSfx;
                 if (!_ambientSfx.empty()) {
                     _ambientSfxTimer.tickHandler().add([this, mapShortName](Event::Event *evt) {
-                        unsigned char rnd = rand() % 100, sum = 0;
+                        unsigned char rnd = Simulation::random() % 100, sum = 0;
                         auto it = _ambientSfx.cbegin();
                         while (it != _ambientSfx.cend() && (sum + it->second) < rnd) {
                             sum += it->second;
@@ -281,7 +423,7 @@ namespace Falltergeist
                             Logger::error("Location") << "Could not match ambient sfx for map " << mapShortName
                                                       << " with " << rnd << std::endl;
                         }
-                        _ambientSfxTimer.start(rand() % 10000 + 20000);
+                        _ambientSfxTimer.start(Simulation::random() % 10000 + 20000);
                     });
                     _ambientSfxTimer.start(10000);
                 } else {
@@ -296,46 +438,53 @@ namespace Falltergeist
             for (auto hex : _hexagonGrid->hexagons()) {
                 _vertices.push_back(glm::vec2(hex->position().x(), hex->position().y()));
             }
+            // triangles between the hexagons of the grid, vertices are indexed like the hexagons
+            const auto &region = _hexagonGrid->region();
+            const unsigned int width = region.width;
             std::vector<GLuint> indexes;
             for (auto hexagon : _hexagonGrid->hexagons()) {
+                const unsigned int column = hexagon->column() - region.left;
+                const unsigned int row = hexagon->row() - region.top;
+                const unsigned int index = hexagon->index();
                 bool doup = true;
                 bool dodown = true;
-                if (hexagon->number() % 200 == 0) {
+                if (column == 0) {
                     doup = false;
                 }
-                if ((hexagon->number() + 1) % 200 == 0) {
+                if (column + 1 == width) {
                     dodown = false;
                 }
-                if (hexagon->number() < 200) {
+                if (row == 0) {
                     doup = false;
                 }
-                if (hexagon->number() >= 39800) {
+                if (row + 1 == region.height) {
                     dodown = false;
                 }
                 if (dodown) {
-                    indexes.push_back(hexagon->number());
+                    indexes.push_back(index);
                     if (hexagon->number() % 2) // odd
                     {
-                        indexes.push_back(hexagon->number() + 200);
-                        indexes.push_back(hexagon->number() + 1);
+                        indexes.push_back(index + width);
+                        indexes.push_back(index + 1);
                     } else {
-                        indexes.push_back(hexagon->number() + 200);
-                        indexes.push_back(hexagon->number() + 201);
+                        indexes.push_back(index + width);
+                        indexes.push_back(index + width + 1);
                     }
                 }
                 if (doup) {
-                    indexes.push_back(hexagon->number());
+                    indexes.push_back(index);
                     if (hexagon->number() % 2) // odd
                     {
-                        indexes.push_back(hexagon->number() - 200);
-                        indexes.push_back(hexagon->number() - 201);
+                        indexes.push_back(index - width);
+                        indexes.push_back(index - width - 1);
                     } else {
-                        indexes.push_back(hexagon->number() - 200);
-                        indexes.push_back(hexagon->number() - 1);
+                        indexes.push_back(index - width);
+                        indexes.push_back(index - 1);
                     }
                 }
             }
             _lightmap = new Graphics::Lightmap(_vertices, indexes);
+            _lightmap->setAmbient(static_cast<float>(_lightLevel));
         }
 
         void Location::initializePlayerTestAppareance(std::shared_ptr<Game::DudeObject> player) const
@@ -370,7 +519,7 @@ namespace Falltergeist
         std::vector<Input::Mouse::Icon> Location::getCursorIconsForObject(Game::Object *object)
         {
             std::vector<Input::Mouse::Icon> icons;
-            if (object->script() && object->script()->hasFunction("use_p_proc")) {
+            if (object->script() && object->script()->hasFunction(PROCEDURE::USE)) {
                 icons.push_back(Input::Mouse::Icon::USE);
             } else if (dynamic_cast<Game::DoorSceneryObject *>(object)) {
                 icons.push_back(Input::Mouse::Icon::USE);
@@ -443,29 +592,96 @@ namespace Falltergeist
         void Location::render()
         {
             auto elevation = _location->elevations()->at(_elevation);
+            auto renderer = Game::Game::getInstance()->renderer();
+            renderer->beginPass(Graphics::RenderStats::Pass::FLOOR);
             elevation->floor()->render();
+            renderer->beginPass(Graphics::RenderStats::Pass::LIGHTMAP);
             _lightmap->render(_camera->topLeft());
+            renderer->beginPass(Graphics::RenderStats::Pass::OBJECTS);
             renderCursor();
             renderObjects();
+            renderPicking();
+            renderer->beginPass(Graphics::RenderStats::Pass::ROOF);
             elevation->roof()->render();
+            renderer->beginPass(Graphics::RenderStats::Pass::UI);
             renderObjectsText();
-            renderCursorOutline();
-            renderTestingOutline();
+            renderOutlines();
             if (active()) {
                 _hexagonInfo->render();
             }
             State::render();
         }
 
+        void Location::renderOutlines()
+        {
+            bool cursor = mouse->state() == Input::Mouse::Cursor::HEXAGON_RED;
+            bool targets = settings->targetHighlight();
+            if (!cursor && !targets) {
+                return;
+            }
+
+            auto renderer = Game::Game::getInstance()->renderer();
+            if (!renderer->supportsFrameBuffers()) {
+                renderCursorOutline();
+                renderTestingOutline();
+                return;
+            }
+
+            // every sprite goes into the mask as it is, the edges are found once for all of them
+            if (!_outlinePass) {
+                _outlinePass = std::make_unique<Graphics::OutlinePass>();
+            }
+            _outlinePass->begin();
+            if (cursor) {
+                mouse->renderOutline(0);
+            }
+            if (targets) {
+                for (auto object : _renderList.visible()) {
+                    if (highlighted(object)) {
+                        object->renderOutline(0);
+                    }
+                }
+            }
+            _outlinePass->end(1);
+        }
+
+        void Location::renderPicking()
+        {
+            auto renderer = Game::Game::getInstance()->renderer();
+            if (!renderer->supportsFrameBuffers()) {
+                return;
+            }
+            if (!_pickingPass) {
+                _pickingPass = std::make_unique<Graphics::PickingPass>();
+            }
+
+            // drawn in the order of renderObjects(), the one on top writes its id last
+            _pickedObjects.clear();
+            _pickingPass->begin(mouse->position());
+            for (auto object : _renderList.visible()) {
+                if (!object->inRender() || !object->ui()) {
+                    continue;
+                }
+                _pickedObjects.push_back(object);
+                renderer->setPickId(static_cast<uint32_t>(_pickedObjects.size()));
+                object->ui()->render(false);
+            }
+            renderer->setPickId(0);
+            _pickingPass->end();
+        }
+
+        bool Location::highlighted(Game::Object* object) const
+        {
+            return object->type() == Game::Object::Type::CRITTER;
+        }
+
         void Location::renderTestingOutline() const
         {
             // just for testing
             if (settings->targetHighlight()) {
-                for (auto &object: _objects) {
-                    if (dynamic_cast<Game::CritterObject *>(object.get())) {
-                        if (!dynamic_cast<Game::DudeObject *>(object.get())) {
-                            object->renderOutline(1);
-                        }
+                for (auto object : _renderList.visible()) {
+                    if (highlighted(object)) {
+                        object->renderOutline(1);
                     }
                 }
             }
@@ -480,20 +696,39 @@ namespace Falltergeist
         }
 
         //render only flat objects first
-        void Location::renderObjects() const
+        void Location::renderObjects()
         {
-            for (auto &object: _flatObjects) {
+            Trace::Scope scope("Location::renderObjects");
+            // objects far from the camera are not visited at all
+            for (auto object : _flatRenderList.cull(_camera->topLeft(), _camera->size())) {
                 object->render();
             }
 
-            for (auto &object: _objects) {
+            for (auto object : _renderList.cull(_camera->topLeft(), _camera->size())) {
                 object->render();
             }
+
+            // objects about to scroll into view build their UI ahead, visible ones did it in render()
+            if (!_uiPrefetched || _uiPrefetchTopLeft != _camera->topLeft()) {
+                _uiPrefetched = true;
+                _uiPrefetchTopLeft = _camera->topLeft();
+                const Point margin(UI_PREFETCH_MARGIN, UI_PREFETCH_MARGIN);
+                const Size size(_camera->size().width() + UI_PREFETCH_MARGIN * 2, _camera->size().height() + UI_PREFETCH_MARGIN * 2);
+                for (auto list : {&_flatRenderList, &_renderList}) {
+                    list->find(_camera->topLeft() - margin, size, _uiPrefetch);
+                    for (auto object : _uiPrefetch) {
+                        if (object->uiPending()) {
+                            object->ui();
+                        }
+                    }
+                }
+            }
         }
 
         void Location::renderObjectsText() const
         {
-            for (auto &object: _objects) {
+            // positions of other objects were not updated by renderObjects()
+            for (auto object : _renderList.visible()) {
                 object->renderText();
             }
         }
@@ -509,14 +744,19 @@ namespace Falltergeist
         void Location::think(const float &deltaTime)
         {
             gameTime->think(deltaTime);
+            // paths queued by scripts during the previous frame are delivered before the critters move
+            _hexagonGrid->solvePaths();
+            _scheduler->think();
             thinkObjects(deltaTime);
             player->think(deltaTime);
             performScrolling(deltaTime);
+            audioMixer->setListener(_camera->center(), _camera->size());
             if (_locationEnter) {
                 _locationEnter = false;
                 firstLocationEnter(deltaTime);
             }
             processTimers(deltaTime);
+            _floatMessages->think(Simulation::ticks());
             State::think(deltaTime);
         }
 
@@ -524,17 +764,11 @@ namespace Falltergeist
         void Location::processTimers(const float &deltaTime)
         {
             _locationScriptTimer.think(deltaTime);
+            _critterScriptTimer.think(deltaTime);
             _actionCursorTimer.think(deltaTime);
             _ambientSfxTimer.think(deltaTime);
 
-            for (auto it = _timerEvents.begin(); it != _timerEvents.end();) {
-                it->timer.think(deltaTime);
-                if (!it->timer.enabled()) {
-                    it = _timerEvents.erase(it);
-                } else {
-                    ++it;
-                }
-            }
+            _timerEvents.advance(deltaTime);
         }
 
         void Location::firstLocationEnter(const float &deltaTime) const
@@ -558,14 +792,16 @@ namespace Falltergeist
             }
 
             if (_location->script()) {
-                _location->script()->call("map_enter_p_proc");
+                _location->script()->call(PROCEDURE::MAP_ENTER);
             }
 
             // By some reason we need to use reverse iterator to prevent scripts problems
             // If we use normal iterators, some exported variables are not initialized on the moment
             // when script is called
             player->map_enter_p_proc();
-            for (auto it = _objects.rbegin(); it != _objects.rend(); ++it) {
+            std::vector<Game::Object*> objects;
+            _renderList.copyTo(objects);
+            for (auto it = objects.rbegin(); it != objects.rend(); ++it) {
                 (*it)->map_enter_p_proc();
             }
         }
@@ -621,13 +857,113 @@ namespace Falltergeist
             }
         }
 
-        void Location::thinkObjects(const float &deltaTime) const
+        void Location::thinkObjects(const float &deltaTime)
         {
+            Trace::Scope scope("Location::thinkObjects");
+            _thinkStep++;
+
+            // objects within a screen around the camera may come into view soon
+            const auto& screen = _camera->size();
+            const Point nearTopLeft = _camera->topLeft() - Point(screen.width(), screen.height());
+            const Graphics::Size nearSize(screen.width() * 3, screen.height() * 3);
+
+            _thinking.clear();
+            size_t parallel = 0;
             for (auto &object : _objects) {
-                object->think(deltaTime);
+                auto interval = thinkInterval(object.get(), nearTopLeft, nearSize);
+                // spread reduced rate objects over the steps, adjacent objects rarely think on the same one
+                if (interval == 0 || (_thinkStep + (reinterpret_cast<uintptr_t>(object.get()) >> 4)) % interval != 0) {
+                    object->skipThink(deltaTime);
+                    continue;
+                }
+                _thinking.push_back(object.get());
+                if (object->parallelThink()) {
+                    parallel++;
+                }
+            }
+
+            // the objects are split into a part for every worker and this thread
+            auto jobs = Game::Game::getInstance()->jobs();
+            unsigned int threads = settings->thinkThreads();
+            if (threads == 0) {
+                threads = jobs ? jobs->size() + 1 : 1;
+            }
+            if (!jobs || threads < 2 || parallel < PARALLEL_THINK_OBJECTS) {
+                for (auto object : _thinking) {
+                    object->catchUpThink(deltaTime);
+                    _renderList.fit(object);
+                }
+                return;
+            }
+
+            size_t objects = _thinking.size();
+            size_t chunk = (objects + threads - 1) / threads;
+            _thinkBuffers.resize((objects + chunk - 1) / chunk);
+            _thinkingEvents.assign(objects, 0);
+
+            // the events are recorded instead of queued, as the queue belongs to the main thread
+            auto think = [this, &deltaTime](size_t first, size_t last, Event::Dispatcher::Buffer* buffer)
+            {
+                buffer->clear();
+                Event::Dispatcher::record(buffer);
+                try {
+                    for (size_t i = first; i != last; ++i) {
+                        if (_thinking[i]->parallelThink()) {
+                            _thinking[i]->catchUpThink(deltaTime);
+                        }
+                        _thinkingEvents[i] = buffer->size();
+                    }
+                } catch (...) {
+                    Event::Dispatcher::record(nullptr);
+                    throw;
+                }
+                Event::Dispatcher::record(nullptr);
+            };
+            {
+                Base::JobSystem::Group group(*jobs);
+                for (size_t first = 0; first < objects; first += chunk) {
+                    size_t last = std::min(first + chunk, objects);
+                    auto buffer = &_thinkBuffers[first / chunk];
+                    jobs->run([&think, first, last, buffer]() { think(first, last, buffer); }, &group);
+                }
+                group.wait();
+            }
+
+            // the rest think here, and every object's events are queued in the same order as if all of them thought here
+            auto dispatcher = Game::Game::getInstance()->eventDispatcher();
+            for (size_t i = 0; i != objects; ++i) {
+                auto object = _thinking[i];
+                if (object->parallelThink()) {
+                    size_t first = i % chunk == 0 ? 0 : _thinkingEvents[i - 1];
+                    dispatcher->replay(_thinkBuffers[i / chunk], first, _thinkingEvents[i]);
+                } else {
+                    object->catchUpThink(deltaTime);
+                }
+                _renderList.fit(object);
             }
         }
 
+        unsigned int Location::thinkInterval(Game::Object *object, const Graphics::Point &nearTopLeft, const Graphics::Size &nearSize) const
+        {
+            // rendered on the last frame
+            if (object->inRender() || object == player.get()) {
+                return 1;
+            }
+            // movement is driven by animation frames, it has to see every one of them
+            auto critter = dynamic_cast<Game::CritterObject *>(object);
+            if (critter && !critter->movementQueue()->empty()) {
+                return 1;
+            }
+            if (!object->hexagon()) {
+                return 0;
+            }
+            if (Graphics::Rect::inRect(object->hexagon()->position(), nearTopLeft, nearSize)) {
+                return NEAR_THINK_INTERVAL;
+            }
+            // far objects only react to events (scripts, timers), animations catch up when they come near
+            return 0;
+        }
+
         void Location::toggleCursorMode()
         {
             // Just for testing. This case should never happen in real life
@@ -693,8 +1029,11 @@ namespace Falltergeist
 
         void Location::handleByGameObjects(Event::Mouse *event)
         {
-            for (auto it = _objects.rbegin(); it != _objects.rend(); ++it) {
-                auto object = (*it).get();
+            // handlers may move objects, which reorders the render lists
+            std::vector<Game::Object*> objects;
+            _renderList.copyTo(objects);
+            for (auto it = objects.rbegin(); it != objects.rend(); ++it) {
+                auto object = *it;
                 if (event->isHandled()) {
                     return;
                 }
@@ -705,8 +1044,9 @@ namespace Falltergeist
             }
 
             // sadly, flat objects do handle events.
-            for (auto it = _flatObjects.rbegin(); it != _flatObjects.rend(); ++it) {
-                auto object = (*it).get();
+            _flatRenderList.copyTo(objects);
+            for (auto it = objects.rbegin(); it != objects.rend(); ++it) {
+                auto object = *it;
                 if (event->isHandled()) {
                     return;
                 }
@@ -749,14 +1089,11 @@ namespace Falltergeist
                     // Here goes the movement
                     auto hexagon = hexagonGrid()->hexagonAt(mouse->position() + _camera->topLeft());
                     if (hexagon) {
-                        auto path = hexagonGrid()->findPath(player->hexagon(), hexagon);
-                        if (path.size()) {
+                        if (hexagonGrid()->findPath(player->hexagon(), hexagon, _path) && _path.size()) {
                             player->stopMovement();
                             player->setRunning((_lastClickedTile != 0 && hexagon->number() == _lastClickedTile) ||
                                                (event->shiftPressed() != settings->running()));
-                            for (auto pathHexagon : path) {
-                                player->movementQueue()->push_back(pathHexagon);
-                            }
+                            player->movementQueue()->assign(_path.begin(), _path.end());
                         }
                         event->stopPropagation();
                         _lastClickedTile = hexagon->number();
@@ -802,8 +1139,8 @@ namespace Falltergeist
 
             if (hexagon) {
                 std::string text = "Hex number: " + std::to_string(hexagon->number()) + "\n";
-                text += "Hex position: " + std::to_string(hexagon->number() % 200) + "," +
-                        std::to_string((unsigned int) (hexagon->number() / 200)) + "\n";
+                text += "Hex position: " + std::to_string(hexagon->column()) + "," +
+                        std::to_string(hexagon->row()) + "\n";
                 text += "Hex coords: " + std::to_string(hexagon->position().x()) + "," +
                         std::to_string(hexagon->position().y()) + "\n";
                 auto hex = player->hexagon();
@@ -811,6 +1148,9 @@ namespace Falltergeist
                         std::to_string(hex->cubeY() - hexagon->cubeY()) + "\n dz=" +
                         std::to_string(hex->cubeZ() - hexagon->cubeZ()) + "\n";
                 text += "Hex light: " + std::to_string(hexagon->light()) + "\n";
+                // a lookup until the player moves or spends action points
+                auto walk = hexagonGrid()->reachable(player.get(), hex, std::max(player->actionPoints(), 0)).cost(hexagon);
+                text += walk == DistanceField::UNREACHABLE ? "Out of AP reach\n" : "Walk AP: " + std::to_string(walk) + "\n";
                 _hexagonInfo->setText(text);
             } else {
                 _hexagonInfo->setText("No hex");
@@ -871,24 +1211,20 @@ namespace Falltergeist
             auto hexagon = object->hexagon();
 
             for (auto adjacentHex : hexagon->neighbors()) {
-                if (!adjacentHex->canWalkThru()) {
+                if (!adjacentHex || !hexagonGrid()->canWalkThru(adjacentHex)) {
                     continue;
                 }
 
-                auto path = hexagonGrid()->findPath(player->hexagon(), adjacentHex);
-
-                if (path.size()) {
+                if (hexagonGrid()->findPath(player->hexagon(), adjacentHex, _path) && _path.size()) {
                     /* Remove the last hexagon from the path so the player stops on
                     an adjacent tile (rather than on the tile the object occupies) */
-                    path.pop_back();
+                    _path.pop_back();
 
                     player->stopMovement();
                     player->setRunning(true);
 
                     // Move!
-                    for (auto pathHexagon : path) {
-                        player->movementQueue()->push_back(pathHexagon);
-                    }
+                    player->movementQueue()->assign(_path.begin(), _path.end());
                     // The player was able to move to an adjacent tile
                     return true;
                 }
@@ -902,20 +1238,22 @@ namespace Falltergeist
             return _camera.get();
         }
 
-        void Location::setMVAR(unsigned int number, int value)
+        void Location::setMVAR(unsigned int number, int value, VM::Script* script)
         {
-            if (number >= _location->MVARS()->size()) {
+            auto MVARS = _location->MVARS();
+            if (number >= MVARS->size()) {
                 throw Exception("Location::setMVAR(num, value) - num out of range: " + std::to_string((int) number));
             }
-            _location->MVARS()->at(number) = value;
+            MVARS->set(number, value, script);
         }
 
         int Location::MVAR(unsigned int number)
         {
-            if (number >= _location->MVARS()->size()) {
+            auto MVARS = _location->MVARS();
+            if (number >= MVARS->size()) {
                 throw Exception("Location::MVAR(num) - num out of range: " + std::to_string((int) number));
             }
-            return _location->MVARS()->at(number);
+            return MVARS->get(number);
         }
 
         std::map<std::string, VM::StackValue> *Location::EVARS()
@@ -929,10 +1267,6 @@ namespace Falltergeist
 
             auto oldHexagon = object->hexagon();
             if (oldHexagon) {
-                if (update) {
-                    //_hexagonGrid->initLight(oldHexagon, false);
-                }
-
                 for (auto it = oldHexagon->objects()->begin(); it != oldHexagon->objects()->end(); ++it) {
                     if (*it == object) {
                         oldHexagon->objects()->erase(it);
@@ -940,93 +1274,74 @@ namespace Falltergeist
                     }
                 }
 
-                /* JUST FOR EXIT GRIDS TESTING*/
-                if (object->type() == Game::Object::Type::DUDE) {
-                    for (auto obj : *hexagon->objects()) {
-                        if (auto exitGrid = dynamic_cast<Game::ExitMiscObject *>(obj)) {
-                            auto &debug = Logger::critical("LOCATION");
-                            debug << " PID: 0x" << std::hex << exitGrid->PID() << std::dec << std::endl;
-                            debug << " name: " << exitGrid->name() << std::endl;
-                            debug << " exitMapNumber: " << exitGrid->exitMapNumber() << std::endl;
-                            debug << " exitElevationNumber: " << exitGrid->exitElevationNumber() << std::endl;
-                            debug << " exitHexagonNumber: " << exitGrid->exitHexagonNumber() << std::endl;
-                            debug << " exitDirection: " << exitGrid->exitDirection() << std::endl << std::endl;
-
-                            if (exitGrid->exitMapNumber() < 0) {
-                                auto worldMapState = new WorldMap(resourceManager);
-                                // TODO delegate state manipulation to some kind of state manager
-                                Game::Game::getInstance()->setState(worldMapState);
-                                return;
-                            }
-
-                            auto mapsFile = ResourceManager::getInstance()->mapsTxt();
-                            std::string mapName = mapsFile->maps().at(exitGrid->exitMapNumber()).name;
-
-                            GameLocationHelper gameLocationHelper(logger);
-                            auto location = gameLocationHelper.getByName(mapName);
-                            location->setDefaultPosition(exitGrid->exitHexagonNumber());
-                            location->setDefaultOrientation(exitGrid->exitDirection());
-                            location->setDefaultElevationIndex(exitGrid->exitElevationNumber());
+                if (object->type() == Game::Object::Type::DUDE && hexagon && _exitHexagons[hexagon->index()]) {
+                    if (auto exitGrid = _exitGridAt(hexagon)) {
+                        storeMapChanges();
 
-                            // TODO move this instantiation to StateLocationHelper or some kind of state manager
-                            auto state = new Location(player, mouse, settings, renderer, audioMixer, gameTime, resourceManager, logger);
-                            state->setLocation(location);
+                        if (exitGrid->exitMapNumber() < 0) {
+                            auto worldMapState = new WorldMap(resourceManager);
                             // TODO delegate state manipulation to some kind of state manager
-                            Game::Game::getInstance()->setState(state);
-
+                            Game::Game::getInstance()->setState(worldMapState);
                             return;
                         }
+
+                        auto mapsFile = ResourceManager::getInstance()->mapsTxt();
+                        travel(
+                            mapsFile->map(exitGrid->exitMapNumber()).name,
+                            static_cast<unsigned int>(exitGrid->exitElevationNumber()),
+                            exitGrid->exitHexagonNumber(),
+                            exitGrid->exitDirection()
+                        );
+                        return;
                     }
                 }
             }
 
             object->setHexagon(hexagon);
+            _moveInBuckets(object, oldHexagon, hexagon);
             if (hexagon) {
                 hexagon->objects()->push_back(object);
+                _hexagonGrid->updateBlocking(hexagon);
+            }
+            if (oldHexagon && oldHexagon != hexagon) {
+                _hexagonGrid->updateBlocking(oldHexagon);
+            }
+            // scripts may move exit grids around
+            if (object->type() == Game::Object::Type::MISC && !_exitGrids.empty()) {
+                _updateExitHexagon(oldHexagon);
+                _updateExitHexagon(hexagon);
             }
 
-            if (object->type() == Game::Object::Type::CRITTER || object->type() == Game::Object::Type::DUDE) {
-                for (auto &spatial: _spatials) {
-                    if (_hexagonGrid->distance(spatial->hexagon(), hexagon) <= spatial->radius()) {
-                        spatial->spatial_p_proc(object);
+            if (hexagon && (object->type() == Game::Object::Type::CRITTER || object->type() == Game::Object::Type::DUDE)) {
+                for (auto &spatial: _spatialIndex[hexagon->index()]) {
+                    if (auto critter = dynamic_cast<Game::CritterObject*>(object)) {
+                        critter->wakeUp();
                     }
+                    spatial->spatial_p_proc(object);
                 }
             }
 
-            // TODO: recreate _objects array for rendering/handling
+            _renderList.move(object);
+            _flatRenderList.move(object);
+
+            if (hexagon && oldHexagon != hexagon && object->type() == Game::Object::Type::DUDE) {
+                _preloadNearExits(hexagon);
+                _automap->reveal(hexagon, AUTOMAP_REVEAL_RADIUS);
+            }
+
             if (update) {
-                _objects.sort(
-                        [](std::shared_ptr<Game::Object> &obj1, std::shared_ptr<Game::Object> &obj2) -> bool {
-                            return obj1->hexagon()->number() < obj2->hexagon()->number();
-                        }
-                );
-                _flatObjects.sort(
-                        [](std::shared_ptr<Game::Object> &obj1, std::shared_ptr<Game::Object> &obj2) -> bool {
-                            return obj1->hexagon()->number() < obj2->hexagon()->number();
-                        }
-                );
                 if (hexagon) {
-                    initLight();
-                    /*_hexagonGrid->initLight(hexagon, true);
-                    std::vector<float> lights;
-                    for (auto hex: _hexagonGrid->hexagons())
-                    {
-                        int lightLevel = 100;
-                        unsigned int light = hex->light();
-                        if (light<=_lightLevel) light=655;
-                        lightLevel = light / ((65536-655)/100);
-
-                        float l = lightLevel/100.0;
-                        lights.push_back(l);
+                    std::vector<Hexagon*> changed = {hexagon};
+                    if (oldHexagon && oldHexagon != hexagon) {
+                        changed.push_back(oldHexagon);
                     }
-                    _lightmap->update(lights);*/
-
+                    updateLight(changed, object->lightIntensity() > 0 ? object->lightRadius() : 0);
                 }
             }
 
             if (auto dude = dynamic_cast<Game::DudeObject *>(object)) {
-                int x = dude->hexagon()->number() % 200;
-                int y = dude->hexagon()->number() / 200;
+                int x = dude->hexagon()->column();
+                int y = dude->hexagon()->row();
                 x /= 2;
                 y /= 2;
                 int tilenum = y * 100 + x;
@@ -1043,6 +1358,114 @@ namespace Falltergeist
             }
         }
 
+        void Location::indexSpatial(Game::SpatialObject* spatial)
+        {
+            if (!spatial->hexagon()) {
+                return;
+            }
+            for (unsigned int radius = 0; radius <= spatial->radius(); radius++) {
+                for (auto hexagon : _hexagonGrid->ring(spatial->hexagon(), radius)) {
+                    if (hexagon) {
+                        _spatialIndex[hexagon->index()].push_back(spatial);
+                    }
+                }
+            }
+        }
+
+        void Location::storeMapChanges()
+        {
+            std::vector<Game::Object*> objects;
+            for (auto &object : _objects) {
+                objects.push_back(object.get());
+            }
+            for (auto &object : _flatObjects) {
+                objects.push_back(object.get());
+            }
+            objects.insert(objects.end(), _spatials.begin(), _spatials.end());
+            Game::Game::getInstance()->saveFile()->storeMap(*_location, _elevation, objects);
+        }
+
+        void Location::reenter()
+        {
+            // the player left through an exit grid and stands on no hexagon of this map, but is still one of its objects
+            player->setHexagon(nullptr);
+            player->setOrientation(_location->defaultOrientation());
+            auto hexagon = hexagonGrid()->at(_location->defaultPosition());
+            if (!hexagon) {
+                // the grid was made around what the map had when it was first entered
+                throw Exception("Entrance " + std::to_string(_location->defaultPosition()) + " is outside of the map " + _location->name());
+            }
+            moveObjectToHexagon(player.get(), hexagon);
+            centerCameraAtHexagon(hexagon);
+            mouse->setState(Input::Mouse::Cursor::ACTION);
+
+            // the scripts are initialized already, map_enter_p_proc runs on every visit
+            _locationEnter = true;
+        }
+
+        void Location::travel(const std::string& mapName, unsigned int elevation, unsigned int position, int orientation)
+        {
+            auto game = Game::Game::getInstance();
+
+            // this location may be entered again from the location cache, the player is gone from it
+            if (auto hexagon = player->hexagon()) {
+                auto objects = hexagon->objects();
+                objects->erase(std::remove(objects->begin(), objects->end(), player.get()), objects->end());
+                _hexagonGrid->updateBlocking(hexagon);
+                _moveInBuckets(player.get(), hexagon, nullptr);
+                player->setHexagon(nullptr);
+            }
+
+            if (auto cached = game->locationCache()->take(mapName, elevation)) {
+                cached->location()->setDefaultPosition(position);
+                if (orientation >= 0) {
+                    cached->location()->setDefaultOrientation(orientation);
+                }
+                auto state = cached.release();
+                state->reenter();
+                _cancelPreloads();
+                game->leaveLocation(state);
+                return;
+            }
+
+            // another elevation of this map is built from the same Game::Location, so map variables and the map script
+            // stay shared. Once the state of the elevation was dropped from the cache its objects are gone with it,
+            // then the map is loaded again from the file and the stored changes
+            std::shared_ptr<Game::Location> location;
+            bool reload = false;
+            if (_isThisMap(mapName)) {
+                reload = elevation < _location->elevations()->size() && _location->elevations()->at(elevation)->entered();
+                if (!reload) {
+                    location = _location;
+                }
+            }
+            if (!location) {
+                GameLocationHelper gameLocationHelper(logger);
+                location = gameLocationHelper.getByName(mapName);
+            }
+            location->setDefaultPosition(position);
+            if (orientation >= 0) {
+                location->setDefaultOrientation(orientation);
+            }
+            location->setDefaultElevationIndex(elevation);
+
+            // TODO move this instantiation to StateLocationHelper or some kind of state manager
+            auto state = new Location(player, mouse, settings, renderer, audioMixer, gameTime, resourceManager, logger);
+            if (elevation < location->elevations()->size()) {
+                state->setElevation(elevation);
+            }
+            state->setLocation(location);
+            // the destination requested its files again above if it was preloaded, what's left of the preloads isn't needed
+            _cancelPreloads();
+            // TODO delegate state manipulation to some kind of state manager
+            if (reload) {
+                // this state has the replaced copy of the map, it can't be kept
+                game->setState(state);
+                return;
+            }
+            game->leaveLocation(state);
+        }
+
         void Location::removeObjectFromMap(Game::Object *object)
         {
             auto objectsAtHex = object->hexagon()->objects();
@@ -1053,9 +1476,29 @@ namespace Falltergeist
                     break;
                 }
             }
+            _hexagonGrid->updateBlocking(object->hexagon());
+            _hexagonGrid->cancelPaths(object);
+            _hexagonGrid->forgetDistanceField(object);
+            if (_combatAI) {
+                if (auto critter = dynamic_cast<Game::CritterObject*>(object)) {
+                    _combatAI->forget(critter);
+                }
+            }
             if (_objectUnderCursor == object) {
                 _objectUnderCursor = nullptr;
             }
+            _renderList.remove(object);
+            _flatRenderList.remove(object);
+            std::replace(_pickedObjects.begin(), _pickedObjects.end(), object, static_cast<Game::Object*>(nullptr));
+            _exitGrids.erase(std::remove(_exitGrids.begin(), _exitGrids.end(), object), _exitGrids.end());
+            _updateExitHexagon(object->hexagon());
+            _elevationExits.erase(
+                std::remove_if(_elevationExits.begin(), _elevationExits.end(), [object](const ElevationExit& exit) {
+                    return exit.object == object;
+                }),
+                _elevationExits.end()
+            );
+            _unregister(object);
             for (auto it = _objects.begin(); it != _objects.end(); ++it) {
                 if ((*it).get() == object) {
                     _objects.erase(it);
@@ -1064,6 +1507,256 @@ namespace Falltergeist
             }
         }
 
+        const std::vector<Game::Object*>& Location::objects(Game::Object::Type type) const
+        {
+            return _objectsByType[static_cast<size_t>(type)];
+        }
+
+        const std::vector<Game::CritterObject*>& Location::critters() const
+        {
+            return _critters;
+        }
+
+        const std::vector<Game::DoorSceneryObject*>& Location::doors() const
+        {
+            return _doors;
+        }
+
+        const std::vector<Game::Object*>& Location::objects(int PID) const
+        {
+            static const std::vector<Game::Object*> none;
+            auto it = _objectsByPID.find(PID);
+            return it != _objectsByPID.end() ? it->second : none;
+        }
+
+        void Location::objectsInRadius(Hexagon *center, unsigned int radius, std::vector<Game::Object*>& objects) const
+        {
+            if (!center) {
+                return;
+            }
+            // a step changes the column and the row by one at most, so the square around the center holds the radius
+            const auto &region = _hexagonGrid->region();
+            const int width = static_cast<int>(region.width);
+            const int height = static_cast<int>(region.height);
+            const int columns = (width + OBJECT_BUCKET_SIZE - 1) / OBJECT_BUCKET_SIZE;
+            const int size = static_cast<int>(OBJECT_BUCKET_SIZE);
+            const int x = static_cast<int>(center->column()) - static_cast<int>(region.left);
+            const int y = static_cast<int>(center->row()) - static_cast<int>(region.top);
+            const int reach = static_cast<int>(std::min(radius, static_cast<unsigned int>(HexagonGrid::MAP_COLUMNS)));
+            const int fromX = std::max(x - reach, 0) / size;
+            const int toX = std::min(x + reach, width - 1) / size;
+            const int fromY = std::max(y - reach, 0) / size;
+            const int toY = std::min(y + reach, height - 1) / size;
+            for (int bucketY = fromY; bucketY <= toY; bucketY++) {
+                for (int bucketX = fromX; bucketX <= toX; bucketX++) {
+                    for (auto object : _objectBuckets[bucketY * columns + bucketX]) {
+                        if (_hexagonGrid->distance(center, object->hexagon()) <= radius) {
+                            objects.push_back(object);
+                        }
+                    }
+                }
+            }
+        }
+
+        void Location::_moveInBuckets(Game::Object *object, Hexagon *from, Hexagon *to)
+        {
+            const auto &region = _hexagonGrid->region();
+            const unsigned int columns = (region.width + OBJECT_BUCKET_SIZE - 1) / OBJECT_BUCKET_SIZE;
+            auto bucket = [&region, columns](Hexagon* hexagon) {
+                return ((hexagon->row() - region.top) / OBJECT_BUCKET_SIZE) * columns + (hexagon->column() - region.left) / OBJECT_BUCKET_SIZE;
+            };
+            if (from && to && bucket(from) == bucket(to)) {
+                return;
+            }
+            if (from) {
+                auto& objects = _objectBuckets[bucket(from)];
+                objects.erase(std::remove(objects.begin(), objects.end(), object), objects.end());
+            }
+            if (to) {
+                _objectBuckets[bucket(to)].push_back(object);
+            }
+        }
+
+        void Location::_register(Game::Object *object)
+        {
+            _objectsByType[static_cast<size_t>(object->type())].push_back(object);
+            _objectsByPID[object->PID()].push_back(object);
+            switch (object->type()) {
+                case Game::Object::Type::CRITTER:
+                case Game::Object::Type::DUDE:
+                    _critters.push_back(static_cast<Game::CritterObject*>(object));
+                    break;
+                case Game::Object::Type::SCENERY:
+                    if (static_cast<Game::SceneryObject*>(object)->subtype() == Game::SceneryObject::Subtype::DOOR) {
+                        _doors.push_back(static_cast<Game::DoorSceneryObject*>(object));
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void Location::_bindObjectUi(Game::Object* object)
+        {
+            auto ui = object->ui();
+            if (!ui) {
+                return;
+            }
+            ui->mouseDownHandler().add(
+                std::bind(
+                    &Location::onObjectMouseEvent,
+                    this,
+                    std::placeholders::_1,
+                    object
+                )
+            );
+            ui->mouseClickHandler().add(
+                std::bind(
+                    &Location::onObjectMouseEvent,
+                    this,
+                    std::placeholders::_1,
+                    object
+                )
+            );
+            ui->mouseInHandler().add(
+                std::bind(
+                    &Location::onObjectHover,
+                    this,
+                    std::placeholders::_1,
+                    object
+                )
+            );
+            // TODO: get rid of mousemove handler?
+            ui->mouseMoveHandler().add(
+                std::bind(
+                    &Location::onObjectHover,
+                    this,
+                    std::placeholders::_1,
+                    object
+                )
+            );
+            ui->mouseOutHandler().add(
+                std::bind(
+                    &Location::onObjectHover,
+                    this,
+                    std::placeholders::_1,
+                    object
+                )
+            );
+        }
+
+        void Location::_unregister(Game::Object *object)
+        {
+            // the order is kept, scripts of critters are queued in it
+            auto& objects = _objectsByType[static_cast<size_t>(object->type())];
+            objects.erase(std::remove(objects.begin(), objects.end(), object), objects.end());
+            auto it = _objectsByPID.find(object->PID());
+            if (it != _objectsByPID.end()) {
+                it->second.erase(std::remove(it->second.begin(), it->second.end(), object), it->second.end());
+                if (it->second.empty()) {
+                    _objectsByPID.erase(it);
+                }
+            }
+            _moveInBuckets(object, object->hexagon(), nullptr);
+            _critters.erase(std::remove(_critters.begin(), _critters.end(), object), _critters.end());
+            _doors.erase(std::remove(_doors.begin(), _doors.end(), object), _doors.end());
+            object->uiHandler() = nullptr;
+        }
+
+        void Location::preloadMap(const std::string &mapName)
+        {
+            if (_preloadedMaps.count(mapName)) {
+                return;
+            }
+            Logger::info("Location") << "Preloading map " << mapName << std::endl;
+            ResourceManager::RequestScope scope(ResourcePriority::PREDICTED, _requestOwner);
+            _preloadedMaps.emplace(mapName, ResourceManager::getInstance()->preloadMap("maps/" + mapName + ".map"));
+            ResourceManager::getInstance()->preloadManifest(mapName);
+        }
+
+        void Location::_cancelPreloads()
+        {
+            ResourceManager::getInstance()->cancelRequests(_requestOwner);
+            // the location may be entered again from the cache, it preloads its exits anew then
+            _preloadedMaps.clear();
+            _preloadedElevations.clear();
+        }
+
+        void Location::_updateExitHexagon(Hexagon *hexagon)
+        {
+            if (!hexagon) {
+                return;
+            }
+            _exitHexagons[hexagon->index()] = _exitGridAt(hexagon) != nullptr;
+        }
+
+        Game::ExitMiscObject* Location::_exitGridAt(Hexagon *hexagon) const
+        {
+            for (auto exitGrid : _exitGrids) {
+                if (exitGrid->hexagon() == hexagon) {
+                    return exitGrid;
+                }
+            }
+            return nullptr;
+        }
+
+        void Location::_preloadNearExits(Hexagon *hexagon)
+        {
+            for (auto exitGrid : _exitGrids) {
+                if (exitGrid->exitMapNumber() < 0 || !exitGrid->hexagon()) {
+                    continue;
+                }
+                if (_hexagonGrid->distance(hexagon, exitGrid->hexagon()) > EXIT_PRELOAD_DISTANCE) {
+                    continue;
+                }
+                auto mapsFile = ResourceManager::getInstance()->mapsTxt();
+                if (static_cast<size_t>(exitGrid->exitMapNumber()) < mapsFile->count()) {
+                    preloadMap(mapsFile->map(exitGrid->exitMapNumber()).name);
+                }
+            }
+            for (auto& exit : _elevationExits) {
+                if (!exit.object->hexagon() || _hexagonGrid->distance(hexagon, exit.object->hexagon()) > EXIT_PRELOAD_DISTANCE) {
+                    continue;
+                }
+                _preloadElevation(exit.mapName, exit.elevation);
+            }
+        }
+
+        void Location::_preloadElevation(const std::string& mapName, unsigned int elevation)
+        {
+            if (!_isThisMap(mapName)) {
+                preloadMap(mapName);
+                return;
+            }
+            if (elevation == _elevation || elevation >= _location->elevations()->size() || !_preloadedElevations.insert(elevation).second) {
+                return;
+            }
+            // a kept state of the elevation has everything loaded
+            if (_location->elevations()->at(elevation)->entered()) {
+                return;
+            }
+            Logger::info("Location") << "Preloading elevation " << elevation << std::endl;
+            ResourceManager::RequestScope scope(ResourcePriority::PREDICTED, _requestOwner);
+            auto target = _location->elevations()->at(elevation);
+            target->floor()->prefetch();
+            target->roof()->prefetch();
+            Graphics::CritterAnimationFactory animationFactory;
+            Helpers::CritterHelper critterHelper;
+            for (auto &object : *target->objects()) {
+                if (auto critter = dynamic_cast<Game::CritterObject*>(object)) {
+                    animationFactory.prefetchAnimationSet(critterHelper.armorFID(critter), critterHelper.weaponId(critter));
+                }
+            }
+        }
+
+        bool Location::_isThisMap(const std::string& mapName) const
+        {
+            auto name = _location->name();
+            return name.size() == mapName.size() && std::equal(name.begin(), name.end(), mapName.begin(), [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            });
+        }
+
         void Location::destroyObject(Game::Object *object)
         {
             object->destroy_p_proc();
@@ -1077,11 +1770,11 @@ namespace Falltergeist
 
         void Location::centerCameraAtHexagon(int tileNum)
         {
-            try {
-                centerCameraAtHexagon(_hexagonGrid->at((unsigned int) tileNum));
-            } catch (const std::out_of_range &) {
+            auto hexagon = _hexagonGrid->at((unsigned int) tileNum);
+            if (!hexagon) {
                 throw Exception(std::string("Tile number out of range: ") + std::to_string(tileNum));
             }
+            centerCameraAtHexagon(hexagon);
         }
 
         void Location::handleAction(Game::Object *object, Input::Mouse::Icon action)
@@ -1145,6 +1838,19 @@ namespace Falltergeist
         {
             _playerPanel->displayMessage(message);
             Logger::info("MESSAGE") << message << std::endl;
+            if (_capturedMessages) {
+                _capturedMessages->push_back(message);
+            }
+        }
+
+        void Location::captureMessages(std::vector<std::string>* messages)
+        {
+            _capturedMessages = messages;
+        }
+
+        UI::FloatMessagePool* Location::floatMessages()
+        {
+            return _floatMessages.get();
         }
 
         HexagonGrid *Location::hexagonGrid()
@@ -1152,6 +1858,19 @@ namespace Falltergeist
             return _hexagonGrid.get();
         }
 
+        Graphics::Automap* Location::automap()
+        {
+            return _automap.get();
+        }
+
+        Game::CombatAI* Location::combatAI()
+        {
+            if (!_combatAI) {
+                _combatAI = std::make_unique<Game::CombatAI>(_hexagonGrid.get());
+            }
+            return _combatAI.get();
+        }
+
         UI::PlayerPanel *Location::playerPanel()
         {
             return _playerPanel;
@@ -1159,31 +1878,27 @@ namespace Falltergeist
 
         void Location::addTimerEvent(Game::Object *obj, int ticks, int fixedParam)
         {
-            Game::Timer timer(static_cast<float>(ticks) * 100.0f);
-            timer.start();
-            timer.tickHandler().add([obj, fixedParam](Event::Event *) {
+            _timerEvents.add(static_cast<float>(ticks) * 100.0f, [obj, fixedParam]() {
                 if (obj) {
+                    if (auto critter = dynamic_cast<Game::CritterObject*>(obj)) {
+                        critter->wakeUp();
+                    }
                     if (auto vm = obj->script()) {
                         vm->setFixedParam(fixedParam);
-                        vm->call("timed_event_p_proc");
+                        vm->call(PROCEDURE::TIMED_EVENT);
                     }
                 }
-            });
-            _timerEvents.emplace_back(TimerEvent {obj, std::move(timer), fixedParam});
+            }, obj, fixedParam);
         }
 
         void Location::removeTimerEvent(Game::Object *obj)
         {
-            _timerEvents.remove_if([=](Location::TimerEvent &item) { return item.object == obj; });
+            _timerEvents.cancel(obj);
         }
 
         void Location::removeTimerEvent(Game::Object *obj, int fixedParam)
         {
-            _timerEvents.remove_if(
-                [=](Location::TimerEvent &item) {
-                    return item.object == obj && item.fixedParam == fixedParam;
-                }
-            );
+            _timerEvents.cancel(obj, fixedParam);
         }
 
         unsigned int Location::lightLevel()
@@ -1201,7 +1916,8 @@ namespace Falltergeist
                 level = 0x4000;
             }
             _lightLevel = level;
-            initLight();
+            // light of hexagons doesn't depend on the level, the lightmap shader compares them with it
+            _lightmap->setAmbient(static_cast<float>(_lightLevel));
         }
 
         void Location::initLight()
@@ -1214,20 +1930,114 @@ namespace Falltergeist
                 _hexagonGrid->initLight(hex);
             }
 
-            std::vector<float> lights;
-            for (auto hex: _hexagonGrid->hexagons()) {
-                int lightLevel = 0;
+            uploadLight();
+        }
+
+        void Location::updateLight(const std::vector<Hexagon*>& hexagons, unsigned int radius)
+        {
+            if (hexagons.empty()) {
+                return;
+            }
 
-                unsigned int light = hex->light();
+            // hexagons with light sources and the largest light radius on them,
+            // initLight() of a hexagon applies every object on it
+            std::vector<std::pair<Hexagon*, unsigned int>> sources;
+            for (auto objects : {&_objects, &_flatObjects}) {
+                for (auto& object : *objects) {
+                    if (object->hexagon() && object->lightIntensity() > 0 && object->lightRadius() > 0) {
+                        sources.emplace_back(object->hexagon(), object->lightRadius());
+                    }
+                }
+            }
+            std::sort(sources.begin(), sources.end());
+            for (size_t i = 1; i < sources.size();) {
+                if (sources[i].first == sources[i - 1].first) {
+                    sources[i - 1].second = std::max(sources[i - 1].second, sources[i].second);
+                    sources.erase(sources.begin() + i);
+                } else {
+                    i++;
+                }
+            }
+
+            _lightRegion.assign(_hexagonGrid->size(), false);
+            std::vector<Hexagon*> region;
+            std::vector<Hexagon*> ring;
+            auto mark = [this, &region, &ring](Hexagon* center, unsigned int markRadius) {
+                for (unsigned int r = 0; r <= markRadius; r++) {
+                    _hexagonGrid->ring(center, r, ring);
+                    for (auto hex : ring) {
+                        if (hex && !_lightRegion[hex->index()]) {
+                            _lightRegion[hex->index()] = true;
+                            region.push_back(hex);
+                        }
+                    }
+                }
+            };
+
+            // light of the changed object itself, and shadows it casts or stopped casting from lights reaching it
+            // distances are taken in batches, from one hexagon to all sources and from one source to all hexagons
+            HexagonGrid::CubeCoordinates sourceCoordinates;
+            for (auto& source : sources) {
+                sourceCoordinates.add(source.first);
+            }
+            std::vector<unsigned int> distances;
+            std::vector<unsigned int> reach;
+            for (auto hexagon : hexagons) {
+                unsigned int hexagonReach = radius;
+                mark(hexagon, radius);
+                _hexagonGrid->distances(hexagon, sourceCoordinates, distances);
+                for (size_t i = 0; i != sources.size(); i++) {
+                    if (distances[i] <= sources[i].second) {
+                        mark(sources[i].first, sources[i].second);
+                        hexagonReach = std::max(hexagonReach, distances[i] + sources[i].second);
+                    }
+                }
+                reach.push_back(hexagonReach);
+            }
+
+            unsigned int first = region.front()->index();
+            unsigned int last = first;
+            for (auto hex : region) {
+                hex->setLight(655);
+                first = std::min(first, hex->index());
+                last = std::max(last, hex->index());
+            }
 
-                if (light <= _lightLevel) {
-                    light = 655;
+            // light is additive and clamped, so sources touching the region may be applied again in any order
+            HexagonGrid::CubeCoordinates hexagonCoordinates;
+            for (auto hexagon : hexagons) {
+                hexagonCoordinates.add(hexagon);
+            }
+            for (auto& source : sources) {
+                _hexagonGrid->distances(source.first, hexagonCoordinates, distances);
+                for (size_t i = 0; i != hexagons.size(); i++) {
+                    if (distances[i] <= source.second + reach[i]) {
+                        _hexagonGrid->initLight(source.first, true, &_lightRegion);
+                        break;
+                    }
                 }
+            }
 
-                lightLevel = light / ((65536 - 655) / 100);
+            std::vector<float> lights;
+            lights.reserve(last - first + 1);
+            for (unsigned int i = first; i <= last; i++) {
+                lights.push_back(lightValue(_hexagonGrid->atIndex(i)));
+            }
+            _lightmap->update(first, lights);
+        }
+
+        float Location::lightValue(Hexagon* hexagon) const
+        {
+            // integers up to 0x10000 are exact as floats, the ambient level is applied by the lightmap shader
+            return static_cast<float>(hexagon->light());
+        }
 
-                auto l = static_cast<float>(lightLevel / 100.0);
-                lights.push_back(l);
+        void Location::uploadLight()
+        {
+            std::vector<float> lights;
+            lights.reserve(_hexagonGrid->size());
+            for (auto hex: _hexagonGrid->hexagons()) {
+                lights.push_back(lightValue(hex));
             }
             _lightmap->update(lights);
         }
@@ -1238,6 +2048,8 @@ namespace Falltergeist
 
             auto object = objectFactory.createObjectByPID(PID);
             _objects.emplace_back(object);
+            _renderList.add(object);
+            _register(object);
             moveObjectToHexagon(object, hexagonGrid()->at(position));
             object->setElevation(elevation);
             return object;
@@ -1265,15 +2077,29 @@ namespace Falltergeist
 
         Game::Object* Location::getGameObjectUnderCursor()
         {
-            for (auto it = _objects.rbegin(); it != _objects.rend(); ++it) {
-                auto object = (*it).get();
-                if (!object->inRender()) {
-                    continue;
+            // the id buffer of the last frame, if it was read at the current cursor position
+            uint32_t id = 0;
+            if (_pickingPass && _pickingPass->result(mouse->position(), id)) {
+                if (id == 0) {
+                    return nullptr;
                 }
+                if (id <= _pickedObjects.size() && _pickedObjects[id - 1]) {
+                    return _pickedObjects[id - 1];
+                }
+            }
 
-                Point position = mouse->position() - object->ui()->position() + object->ui()->offset();
-                if (object->ui()->opaque(position)) {
-                    return object;
+            auto& rows = _renderList.rows();
+            for (auto row = rows.rbegin(); row != rows.rend(); ++row) {
+                for (auto it = row->rbegin(); it != row->rend(); ++it) {
+                    auto object = *it;
+                    if (!object->inRender()) {
+                        continue;
+                    }
+
+                    Point position = mouse->position() - object->ui()->position() + object->ui()->offset();
+                    if (object->ui()->opaque(position)) {
+                        return object;
+                    }
                 }
             }
 
@@ -1,13 +1,20 @@
 #pragma once
 
+#include <array>
 #include <list>
 #include <memory>
+#include <set>
+#include <unordered_map>
+#include "../Event/Dispatcher.h"
 #include "../Format/Map/File.h"
 #include "../Game/DudeObject.h"
 #include "../Game/Object.h"
 #include "../Game/Timer.h"
+#include "../Game/TimerWheel.h"
 #include "../Graphics/Lightmap.h"
 #include "../Input/Mouse.h"
+#include "../ResourceManager.h"
+#include "../State/RenderList.h"
 #include "../State/State.h"
 #include "../UI/ImageButton.h"
 #include "../UI/IResourceManager.h"
@@ -27,15 +34,26 @@ namespace Falltergeist
     }
     namespace Game
     {
+        class CombatAI;
+        class CritterObject;
+        class DoorSceneryObject;
         class DudeObject;
+        class ExitMiscObject;
         class Location;
         class Object;
         class SpatialObject;
         class Time;
     }
+    namespace Graphics
+    {
+        class Automap;
+        class OutlinePass;
+        class PickingPass;
+    }
     namespace UI
     {
         class Animation;
+        class FloatMessagePool;
         class Image;
         class PlayerPanel;
         class Tile;
@@ -43,6 +61,7 @@ namespace Falltergeist
     }
     namespace VM
     {
+        class Scheduler;
         class Script;
         class StackValue;
     }
@@ -73,7 +92,7 @@ namespace Falltergeist
                     std::shared_ptr<UI::IResourceManager> resourceManager,
                     std::shared_ptr<ILogger> logger
                 );
-                ~Location() override = default;
+                ~Location() override;
 
                 void init() override;
                 void think(const float &deltaTime) override;
@@ -83,7 +102,11 @@ namespace Falltergeist
                 void handleByGameObjects(Event::Mouse* event);
 
                 HexagonGrid* hexagonGrid();
+                // Walls and scenery of the elevation the player has seen, for the Pip-Boy
+                Graphics::Automap* automap();
                 LocationCamera* camera();
+                // Created on first use, its caches live as long as the map
+                Game::CombatAI* combatAI();
 
                 std::shared_ptr<Game::Location> location();
                 void setLocation(std::shared_ptr<Game::Location> location);
@@ -91,13 +114,25 @@ namespace Falltergeist
                 unsigned int elevation() const;
                 void setElevation(unsigned int elevation);
 
-                void setMVAR(unsigned int number, int value);
+                // The script is named when variables are traced
+                void setMVAR(unsigned int number, int value, VM::Script* script = nullptr);
                 int MVAR(unsigned int number);
 
                 std::map<std::string, VM::StackValue>* EVARS();
 
                 void moveObjectToHexagon(Game::Object *object, Hexagon *hexagon, bool update = true);
                 void removeObjectFromMap(Game::Object *object);
+
+                // Stores the changes of the objects on the elevation into the save file, before leaving the map or saving
+                void storeMapChanges();
+                // Puts the player on the default position of a location kept in the location cache, before it's pushed again
+                void reenter();
+                // Leaves for the elevation of the map, the player arrives at the position. The elevations of this map
+                // share its Game::Location, each one gets a state of its own, built on the first visit and then kept
+                // in the location cache like other maps. Map changes have to be stored before.
+                void travel(const std::string& mapName, unsigned int elevation, unsigned int position, int orientation = -1);
+                // Starts loading the map in the background, so entering it later doesn't stall
+                void preloadMap(const std::string& mapName);
                 void destroyObject(Game::Object* object);
                 void centerCameraAtHexagon(Hexagon* hexagon);
                 void centerCameraAtHexagon(int tileNum);
@@ -106,6 +141,11 @@ namespace Falltergeist
 
                 void displayMessage(const std::string& message);
 
+                // While set, displayed messages are appended to the vector as well, nullptr stops
+                void captureMessages(std::vector<std::string>* messages);
+
+                UI::FloatMessagePool* floatMessages();
+
                 void addTimerEvent(Game::Object* obj, int ticks, int fixedParam = 0);
                 void removeTimerEvent(Game::Object* obj);
                 void removeTimerEvent(Game::Object* obj, int fixedParam);
@@ -130,8 +170,22 @@ namespace Falltergeist
 
                 void initLight();
 
+                // Recomputes light around hexagons where a light source or a light blocker appeared or disappeared,
+                // radius is the light radius of the changed object
+                void updateLight(const std::vector<Hexagon*>& hexagons, unsigned int radius);
+
                 Game::Object* addObject(unsigned int PID, unsigned int position, unsigned int elevation);
 
+                // Objects of the elevation with the type, flat ones included, in the order they were added
+                const std::vector<Game::Object*>& objects(Game::Object::Type type) const;
+                // Critters of the elevation, the dude included
+                const std::vector<Game::CritterObject*>& critters() const;
+                const std::vector<Game::DoorSceneryObject*>& doors() const;
+                // Objects of the elevation with the PID, empty if there are none
+                const std::vector<Game::Object*>& objects(int PID) const;
+                // Appends the objects standing at most radius hexagons away from center to objects
+                void objectsInRadius(Hexagon* center, unsigned int radius, std::vector<Game::Object*>& objects) const;
+
                 SKILL skillInUse() const;
                 void setSkillInUse(SKILL skill);
 
@@ -146,26 +200,51 @@ namespace Falltergeist
                 std::shared_ptr<ILogger> logger;
 
             protected:
-                struct TimerEvent
-                {
-                    Game::Object* object;
-                    Game::Timer timer;
-                    int fixedParam;
-                };
-
                 static const int KEYBOARD_SCROLL_STEP;
                 static const int DROPDOWN_DELAY;
+                static const int CRITTER_SCRIPT_INTERVAL;
+                // Steps between thinks of objects near the screen, but not on it
+                static const unsigned int NEAR_THINK_INTERVAL;
+                // Distance from the player to an exit grid at which its destination map is preloaded
+                static const unsigned int EXIT_PRELOAD_DISTANCE;
+                // Fewer objects thinking on a step than that aren't worth waking the think threads
+                static const size_t PARALLEL_THINK_OBJECTS;
+                // Width and height in hexagons of the squares objectsInRadius() looks up objects by
+                static const unsigned int OBJECT_BUCKET_SIZE;
+                // Hexagons of the grid around the tiles and objects of the map
+                static const unsigned int GRID_MARGIN;
+                // Pixels around the camera in which objects build their UI before they are seen
+                static const int UI_PREFETCH_MARGIN;
+                // Hexagons around the player shown on the automap
+                static const unsigned int AUTOMAP_REVEAL_RADIUS;
+
+                // counts thinkObjects() calls
+                unsigned int _thinkStep = 0;
+                // objects thinking on this step, and for each of them the end of its events in the buffer of its part
+                std::vector<Game::Object*> _thinking;
+                std::vector<size_t> _thinkingEvents;
+                std::vector<Event::Dispatcher::Buffer> _thinkBuffers;
 
                 // Timers
                 Game::Timer _locationScriptTimer;
+                // queues critter_p_proc of the awake critters and of those near the player
+                Game::Timer _critterScriptTimer;
                 Game::Timer _actionCursorTimer;
                 Game::Timer _ambientSfxTimer;
-                // for VM opcode add_timer_event
-                std::list<TimerEvent> _timerEvents;
+                // for VM opcode add_timer_event, owned by the object and keyed by the fixed param
+                Game::TimerWheel _timerEvents;
                 // TODO: move to Game::Location class?
                 std::map<std::string, unsigned char> _ambientSfx;
 
                 std::unique_ptr<HexagonGrid> _hexagonGrid;
+                std::unique_ptr<Game::CombatAI> _combatAI;
+                std::unique_ptr<Graphics::OutlinePass> _outlinePass;
+                std::unique_ptr<Graphics::PickingPass> _pickingPass;
+                std::unique_ptr<Graphics::Automap> _automap;
+                // objects rendered by the last picking pass, an id is the index + 1, removed objects are nullptr
+                std::vector<Game::Object*> _pickedObjects;
+                // runs map_update_p_proc of every script over the following frames
+                std::unique_ptr<VM::Scheduler> _scheduler;
                 std::unique_ptr<LocationCamera> _camera;
                 std::map<std::string, VM::StackValue> _EVARS;
 
@@ -180,6 +259,11 @@ namespace Falltergeist
                 bool _actionCursorButtonPressed = false;
                 UI::PlayerPanel* _playerPanel;
 
+                // see captureMessages()
+                std::vector<std::string>* _capturedMessages = nullptr;
+
+                std::unique_ptr<UI::FloatMessagePool> _floatMessages;
+
                 SKILL _skillInUse = SKILL::NONE;
 
                 bool _scrollLeft = false;
@@ -189,6 +273,53 @@ namespace Falltergeist
 
                 std::list<std::shared_ptr<Game::Object>> _objects;
                 std::list<std::shared_ptr<Game::Object>> _flatObjects;
+                // draw and mouse picking order of _objects and _flatObjects
+                RenderList _renderList;
+                RenderList _flatRenderList;
+                // camera position the UIs around it were last built for, by renderObjects()
+                bool _uiPrefetched = false;
+                Graphics::Point _uiPrefetchTopLeft;
+                std::vector<Game::Object*> _uiPrefetch;
+                // _objects and _flatObjects by type and by the subtypes looked for, kept by _register() and _unregister()
+                std::array<std::vector<Game::Object*>, static_cast<size_t>(Game::Object::Type::DUDE) + 1> _objectsByType;
+                std::vector<Game::CritterObject*> _critters;
+                std::vector<Game::DoorSceneryObject*> _doors;
+                std::unordered_map<int, std::vector<Game::Object*>> _objectsByPID;
+                // objects on a hexagon by square of OBJECT_BUCKET_SIZE hexagons, kept by moveObjectToHexagon()
+                std::vector<std::vector<Game::Object*>> _objectBuckets;
+                void _register(Game::Object* object);
+                void _unregister(Game::Object* object);
+                void _moveInBuckets(Game::Object* object, Hexagon* from, Hexagon* to);
+                // Mouse handlers of the object, added to its UI once it's built
+                void _bindObjectUi(Game::Object* object);
+
+                std::vector<Game::ExitMiscObject*> _exitGrids;
+                // hexagons holding an exit grid, indexed by hexagon number
+                std::vector<bool> _exitHexagons;
+                void _updateExitHexagon(Hexagon* hexagon);
+                Game::ExitMiscObject* _exitGridAt(Hexagon* hexagon) const;
+                // ladders, stairs and elevators with the maps and elevations they lead to
+                struct ElevationExit
+                {
+                    Game::Object* object;
+                    std::string mapName;
+                    unsigned int elevation;
+                };
+                std::vector<ElevationExit> _elevationExits;
+                // elevations of this map whose images were requested for a ladder or elevator nearby
+                std::set<unsigned int> _preloadedElevations;
+                // pinned until the state is destroyed, by map name
+                std::map<std::string, ResourceRequest<Format::Map::File>> _preloadedMaps;
+                // owner of the requests for the preloads, they are cancelled once the location is left
+                unsigned int _requestOwner = 0;
+
+                void _preloadNearExits(Hexagon* hexagon);
+                void _preloadElevation(const std::string& mapName, unsigned int elevation);
+                void _cancelPreloads();
+                bool _isThisMap(const std::string& mapName) const;
+
+                // manifest recording started by init(), 0 unless record_manifests is set
+                unsigned int _manifestRecording = 0;
 
                 std::unique_ptr<UI::TextArea> _hexagonInfo;
 
@@ -198,25 +329,50 @@ namespace Falltergeist
 
                 unsigned int _lightLevel = 0x10000;
                 Falltergeist::Graphics::Lightmap* _lightmap;
+                // hexagons relit by updateLight(), indexed by hexagon number
+                std::vector<bool> _lightRegion;
 
                 std::vector<Game::SpatialObject*> _spatials;
+                // spatials covering each hexagon, indexed by hexagon number
+                std::vector<std::vector<Game::SpatialObject*>> _spatialIndex;
+
+                // reused by player movement searches
+                std::vector<Hexagon*> _path;
 
                 void initializePlayerTestAppareance(std::shared_ptr<Game::DudeObject> player) const;
 
                 void initializeLightmap();
 
+                // Adds the spatial to every hexagon within its radius
+                void indexSpatial(Game::SpatialObject* spatial);
+
+                float lightValue(Hexagon* hexagon) const;
+
+                void uploadLight();
+
                 void loadAmbient(const std::string &name);
 
                 void renderCursor() const;
 
-                void renderObjects() const;
+                void renderObjects();
                 void renderObjectsText() const;
 
+                // Outlines of the hexagon cursor and of the highlighted critters, in one pass where framebuffers are supported
+                void renderOutlines();
+                // Ids of the objects at the cursor for getGameObjectUnderCursor(), where framebuffers are supported
+                void renderPicking();
+
                 void renderCursorOutline() const;
 
                 void renderTestingOutline() const;
 
-                void thinkObjects(const float &deltaTime) const;
+                // Critters outlined while target highlighting is enabled
+                bool highlighted(Game::Object* object) const;
+
+                void thinkObjects(const float &deltaTime);
+
+                // Steps between thinks of the object, 0 if it only has to react to events
+                unsigned int thinkInterval(Game::Object *object, const Graphics::Point &nearTopLeft, const Graphics::Size &nearSize) const;
 
                 void performScrolling(const float &deltaTime);
 
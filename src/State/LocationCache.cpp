@@ -0,0 +1,75 @@
+#include <algorithm>
+#include "../Game/Location.h"
+#include "../State/Location.h"
+#include "../State/LocationCache.h"
+
+namespace Falltergeist
+{
+    namespace State
+    {
+        LocationCache::LocationCache(unsigned int capacity) : _capacity(capacity)
+        {
+        }
+
+        LocationCache::~LocationCache()
+        {
+        }
+
+        unsigned int LocationCache::capacity() const
+        {
+            return _capacity;
+        }
+
+        void LocationCache::store(std::unique_ptr<Location> location)
+        {
+            if (_capacity == 0) {
+                return;
+            }
+            // a map is kept once, the state left last replaces an older one
+            auto name = location->location()->name();
+            auto elevation = location->elevation();
+            _locations.remove_if([&](const std::unique_ptr<Location>& kept) {
+                return kept->location()->name() == name && kept->elevation() == elevation;
+            });
+
+            _locations.push_front(std::move(location));
+            while (_locations.size() > _capacity) {
+                _locations.pop_back();
+            }
+        }
+
+        std::unique_ptr<Location> LocationCache::take(const std::string& name, unsigned int elevation)
+        {
+            auto lowerName = _lowerName(name);
+            for (auto it = _locations.begin(); it != _locations.end(); ++it) {
+                if ((*it)->location()->name() == lowerName && (*it)->elevation() == elevation) {
+                    auto location = std::move(*it);
+                    _locations.erase(it);
+                    return location;
+                }
+            }
+            return nullptr;
+        }
+
+        void LocationCache::forget(const std::string& name)
+        {
+            auto lowerName = _lowerName(name);
+            _locations.remove_if([&](const std::unique_ptr<Location>& kept) {
+                return kept->location()->name() == lowerName;
+            });
+        }
+
+        std::string LocationCache::_lowerName(const std::string& name)
+        {
+            // locations are named by their .MAP header, in lower case, MAPS.TXT names may be in any case
+            auto lowerName = name;
+            std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+            return lowerName;
+        }
+
+        void LocationCache::clear()
+        {
+            _locations.clear();
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+
+namespace Falltergeist
+{
+    namespace State
+    {
+        class Location;
+
+        /**
+         * Location states the player left last, kept with their hexagon grid, tiles, light and objects as they were,
+         * so walking back to one skips building it again from the .MAP file. The one left longest ago is dropped
+         * once there are more than the capacity.
+         */
+        class LocationCache final
+        {
+            public:
+                LocationCache(unsigned int capacity);
+                ~LocationCache();
+
+                unsigned int capacity() const;
+
+                // Takes over the state
+                void store(std::unique_ptr<Location> location);
+
+                // Gives back the state of the map left on the elevation, nullptr if it wasn't kept
+                std::unique_ptr<Location> take(const std::string& name, unsigned int elevation);
+
+                // Drops the states of the map on any elevation
+                void forget(const std::string& name);
+
+                // The kept maps don't match a loaded or new game
+                void clear();
+
+            private:
+                unsigned int _capacity;
+                // left last first
+                std::list<std::unique_ptr<Location>> _locations;
+
+                static std::string _lowerName(const std::string& name);
+        };
+    }
+}
@@ -25,6 +25,12 @@ namespace Falltergeist
 
     namespace State
     {
+        namespace
+        {
+            // the time to the main menu is only meaningful once per run
+            bool startupLogged = false;
+        }
+
         MainMenu::MainMenu(std::shared_ptr<UI::IResourceManager> resourceManager, std::shared_ptr<ILogger> logger) : State()
         {
             this->resourceManager = std::move(resourceManager);
@@ -46,6 +52,7 @@ namespace Falltergeist
 
             setModal(true);
             setFullscreen(true);
+            setCachedRender(true);
 
             auto renderer = Game::Game::getInstance()->renderer();
             setPosition((renderer->size() - Point(640, 480)) / 2);
@@ -122,6 +129,11 @@ namespace Falltergeist
             addUI(optionsButtonLabel);
             addUI(creditsButtonLabel);
             addUI(exitButtonLabel);
+
+            if (!startupLogged) {
+                startupLogged = true;
+                logger->info() << "[GAME] Main menu after " << std::chrono::duration<double, std::milli>(Game::Game::getInstance()->uptime()).count() << " ms" << std::endl;
+            }
         }
 
         void MainMenu::doExit()
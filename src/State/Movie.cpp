@@ -11,6 +11,7 @@
 #include "../Ini/Parser.h"
 #include "../Input/Mouse.h"
 #include "../ResourceManager.h"
+#include "../Settings.h"
 #include "../State/State.h"
 #include "../State/MainMenu.h"
 #include "../UI/MvePlayer.h"
@@ -37,6 +38,12 @@ namespace Falltergeist
             }
             State::init();
 
+            // a new game usually follows the intro, its first map is loaded in the background meanwhile
+            {
+                ResourceManager::RequestScope scope(ResourcePriority::PREDICTED);
+                ResourceManager::getInstance()->preloadManifest(Game::Game::getInstance()->settings()->initialLocation());
+            }
+
             setFullscreen(true);
             setModal(true);
 
@@ -93,7 +100,7 @@ namespace Falltergeist
 
             if (sublst->strings()->at(_id)!="reserved.sve")
             {
-                _subs = ResourceManager::getInstance()->sveFileType(subfile);
+                _subs = ResourceManager::getInstance()->pin(ResourceManager::getInstance()->sveFileType(subfile));
                 if (_subs) {
                     _hasSubs = true;
                 }
@@ -108,11 +115,7 @@ namespace Falltergeist
             subLabel->setHorizontalAlign(UI::TextArea::HorizontalAlign::CENTER);
             addUI("subs",subLabel);
 
-            if (_hasSubs) {
-                _nextSubLine = _subs->getSubLine(0);
-            } else {
-                _nextSubLine = std::pair<int, std::string>(999999, "");
-            }
+            _nextSubLine = 0;
         }
 
         void Movie::think(const float &deltaTime)
@@ -124,10 +127,10 @@ namespace Falltergeist
             }
 
             unsigned int frame = dynamic_cast<UI::MvePlayer*>(getUI("movie"))->frame();
-            if (frame >= _nextSubLine.first) {
-                dynamic_cast<UI::TextArea*>(getUI("subs"))->setText(_nextSubLine.second);
-                if (_hasSubs) {
-                    _nextSubLine = _subs->getSubLine(dynamic_cast<UI::MvePlayer*>(getUI("movie"))->frame());
+            if (_hasSubs) {
+                // lines of skipped frames are passed over, the latest one stays on screen
+                if (auto line = _subs->advance(frame, _nextSubLine)) {
+                    dynamic_cast<UI::TextArea*>(getUI("subs"))->setText(line->text);
                 }
             }
             if (_effect_index<_effects.size() && frame>=_effects[_effect_index].frame) {
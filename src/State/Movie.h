@@ -40,8 +40,9 @@ namespace Falltergeist
             private:
                 int _id;
                 bool _started = false;
-                std::pair<unsigned int,std::string> _nextSubLine;
-                Format::Sve::File* _subs = nullptr;
+                // first subtitle line not shown yet
+                size_t _nextSubLine = 0;
+                std::shared_ptr<Format::Sve::File> _subs;
                 bool _hasSubs = false;
                 std::vector<effect_t> _effects;
                 unsigned int _effect_index=0;
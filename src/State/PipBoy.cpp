@@ -3,9 +3,12 @@
 #include "../Event/Keyboard.h"
 #include "../Game/Game.h"
 #include "../Game/Time.h"
+#include "../Graphics/Automap.h"
 #include "../Graphics/Renderer.h"
+#include "../Graphics/Sprite.h"
 #include "../Input/Mouse.h"
 #include "../ResourceManager.h"
+#include "../State/Location.h"
 #include "../UI/Base.h"
 #include "../UI/Factory/ImageButtonFactory.h"
 #include "../UI/Image.h"
@@ -40,6 +43,7 @@ namespace Falltergeist
 
             setModal(true);
             setFullscreen(true);
+            setCachedRender(true);
 
             Game::Game::getInstance()->mouse()->pushState(Input::Mouse::Cursor::BIG_ARROW);
 
@@ -61,6 +65,7 @@ namespace Falltergeist
             auto archivesButton = imageButtonFactory->getByType(ImageButtonType::SMALL_RED_CIRCLE, {backgroundX + 53, backgroundY + 423});
             auto closeButton = imageButtonFactory->getByType(ImageButtonType::SMALL_RED_CIRCLE, {backgroundX + 53, backgroundY + 448});
             closeButton->mouseClickHandler().add(std::bind(&PipBoy::onCloseButtonClick, this, std::placeholders::_1));
+            automapsButton->mouseClickHandler().add(std::bind(&PipBoy::onAutomapsButtonClick, this, std::placeholders::_1));
             // Date and time
 
             // Date
@@ -105,6 +110,17 @@ namespace Falltergeist
 
             addUI(closeButton);
 
+            // the texture is kept by the location, showing it only plots what changed since the last time
+            if (auto location = Game::Game::getInstance()->locationState()) {
+                if (auto automap = location->automap()) {
+                    auto screenSize = Graphics::Size(350, 290);
+                    _automap = new UI::Image(std::make_unique<Graphics::Sprite>(automap->texture()));
+                    _automap->setPosition(backgroundPos + Point(254, 46) + Point((screenSize - automap->size()) / 2));
+                    _automap->setVisible(false);
+                    addUI(_automap);
+                }
+            }
+
             // Special date greeting
             std::string greeting = getSpecialGreeting(gameTime->month(), gameTime->day());
             if (!greeting.empty()) {
@@ -117,6 +133,16 @@ namespace Falltergeist
             Game::Game::getInstance()->popState();
         }
 
+        void PipBoy::onAutomapsButtonClick(Event::Mouse* event)
+        {
+            if (!_automap) {
+                return;
+            }
+            Game::Game::getInstance()->locationState()->automap()->update();
+            _automap->setVisible(!_automap->visible());
+            invalidate();
+        }
+
         void PipBoy::onKeyDown(Event::Keyboard* event)
         {
             if (event->keyCode() == SDLK_ESCAPE)
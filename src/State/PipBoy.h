@@ -11,6 +11,7 @@ namespace Falltergeist
         {
             class ImageButtonFactory;
         }
+        class Image;
     }
 
     namespace State
@@ -24,11 +25,14 @@ namespace Falltergeist
                 void init() override;
 
                 void onCloseButtonClick(Event::Mouse* event);
+                void onAutomapsButtonClick(Event::Mouse* event);
                 void onKeyDown(Event::Keyboard* event) override;
 
             private:
                 std::shared_ptr<UI::IResourceManager> resourceManager;
                 std::unique_ptr<UI::Factory::ImageButtonFactory> imageButtonFactory;
+                // automap of the location the Pip-Boy was opened in, nullptr if there is none
+                UI::Image* _automap = nullptr;
 
                 std::string getSpecialGreeting(int month, int day);
         };
@@ -41,6 +41,7 @@ namespace Falltergeist
 
             setFullscreen(true);
             setModal(true);
+            setCachedRender(true);
 
             // background
             auto background = _resourceManager->getImage("art/intrface/edtrcrte.frm");
@@ -215,6 +216,8 @@ namespace Falltergeist
                 addUI(mask.second);
             }
 
+            _indexLabels();
+
             _selectedImage = _images.at("stats_1");
             _selectedLabel = _labels.at("stats_1");
             _selectedImage->setPosition(backgroundPos + Point(480, 310));
@@ -272,143 +275,194 @@ namespace Falltergeist
             _images.insert(std::pair<std::string, UI::Image*>(name, image));
         }
 
+        void PlayerCreate::_indexLabels()
+        {
+            _labelInfos.clear();
+            for (auto& it : _labels) {
+                const std::string& name = it.first;
+                LabelInfo info = {it.second, nullptr, LabelGroup::OTHER, 0, nullptr, nullptr, nullptr};
+
+                if (name.find("stats_") == 0) {
+                    info.group = LabelGroup::STATS;
+                } else if (name.find("params_") == 0) {
+                    info.group = LabelGroup::PARAMS;
+                } else if (name.find("traits_") == 0) {
+                    info.group = LabelGroup::TRAITS;
+                } else if (name.find("skills_") == 0) {
+                    info.group = LabelGroup::SKILLS;
+                } else if (name.find("health_") == 0) {
+                    info.group = LabelGroup::HEALTH;
+                }
+                // all of these prefixes are 7 characters long, "skills_1_value" is skill 0 as well
+                if (info.group == LabelGroup::TRAITS || info.group == LabelGroup::SKILLS || info.group == LabelGroup::HEALTH) {
+                    info.number = atoi(name.substr(7).c_str()) - 1;
+                }
+
+                auto value = _labels.find(name + "_value");
+                if (value != _labels.end()) {
+                    info.value = value->second;
+                }
+                auto title = _titles.find(name);
+                if (title != _titles.end()) {
+                    info.title = &title->second;
+                }
+                auto description = _descriptions.find(name);
+                if (description != _descriptions.end()) {
+                    info.description = &description->second;
+                }
+                auto image = _images.find(name);
+                if (image != _images.end()) {
+                    info.image = image->second;
+                }
+                _labelInfos.push_back(info);
+            }
+
+            _nameLabel = _labels.at("name");
+            _ageLabel = _labels.at("age");
+            _genderLabel = _labels.at("gender");
+            _healthLabel = _labels.at("health_1");
+            _statsPointsCounter = _counters.at("statsPoints");
+            _skillsPointsCounter = _counters.at("skillsPoints");
+
+            _statLabels.clear();
+            _statCounters.clear();
+            for (unsigned i = (unsigned)STAT::STRENGTH; i <= (unsigned)STAT::LUCK; i++) {
+                _statLabels.push_back(_labels.at("stats_" + std::to_string(i + 1)));
+                _statCounters.push_back(_counters.at("stats_" + std::to_string(i + 1)));
+            }
+            _paramValues.clear();
+            for (unsigned i = 0; i != 10; ++i) {
+                _paramValues.push_back(_labels.at("params_" + std::to_string(i + 1) + "_value"));
+            }
+            _skillValues.clear();
+            for (unsigned i = (unsigned)SKILL::SMALL_GUNS; i <= (unsigned)SKILL::OUTDOORSMAN; i++) {
+                _skillValues.push_back(_labels.at("skills_" + std::to_string(i + 1) + "_value"));
+            }
+        }
+
         void PlayerCreate::think(const float &deltaTime)
         {
             // TODO: this shit shouldn't be updated each fucking frame, duh
             State::think(deltaTime);
             auto player = Game::Game::getInstance()->player();
 
-            *_labels.at("name") = player->name();
-            *_labels.at("age") = _t(MSG_EDITOR, 104) +  " " + std::to_string(player->age());
-
-            *_labels.at("gender") = _t(MSG_EDITOR, player->gender() == GENDER::MALE ? 107 : 108);
-
-            _counters.at("statsPoints")->setNumber(player->statsPoints());
-            _counters.at("skillsPoints")->setNumber(player->skillsPoints());
-
-            *_labels.at("health_1") = _t(MSG_EDITOR, 300) + "  " + std::to_string(player->hitPointsMax()) + "/" + std::to_string(player->hitPointsMax());
-            *_labels.at("params_1_value") = player->armorClass();
-            *_labels.at("params_2_value") = player->actionPoints();
-            *_labels.at("params_3_value") = player->carryWeightMax();
-            *_labels.at("params_4_value") = player->meleeDamage();
-
-            *_labels.at("params_5_value") = player->damageResistance();
-            *_labels.at("params_5_value")+= "%";
-
-            *_labels.at("params_6_value") = player->poisonResistance();
-            *_labels.at("params_6_value")+= "%";
-
-            *_labels.at("params_7_value") = player->radiationResistance();
-            *_labels.at("params_7_value")+= "%";
-
-            *_labels.at("params_8_value") = player->sequence();
-            *_labels.at("params_9_value") = player->healingRate();
-            *_labels.at("params_10_value") = player->criticalChance();
-
-            *_labels.at("params_10_value") += "%";
+            *_nameLabel = player->name();
+            *_ageLabel = _t(MSG_EDITOR, 104) + " " + std::to_string(player->age());
+            *_genderLabel = _t(MSG_EDITOR, player->gender() == GENDER::MALE ? 107 : 108);
+
+            _statsPointsCounter->setNumber(player->statsPoints());
+            _skillsPointsCounter->setNumber(player->skillsPoints());
+
+            *_healthLabel = _t(MSG_EDITOR, 300) + "  " + std::to_string(player->hitPointsMax()) + "/" + std::to_string(player->hitPointsMax());
+            *_paramValues[0] = player->armorClass();
+            *_paramValues[1] = player->actionPoints();
+            *_paramValues[2] = player->carryWeightMax();
+            *_paramValues[3] = player->meleeDamage();
+            *_paramValues[4] = player->damageResistance();
+            *_paramValues[4] += "%";
+            *_paramValues[5] = player->poisonResistance();
+            *_paramValues[5] += "%";
+            *_paramValues[6] = player->radiationResistance();
+            *_paramValues[6] += "%";
+            *_paramValues[7] = player->sequence();
+            *_paramValues[8] = player->healingRate();
+            *_paramValues[9] = player->criticalChance();
+            *_paramValues[9] += "%";
 
             // Stats counters and labels
             for (unsigned i = (unsigned)STAT::STRENGTH; i <= (unsigned)STAT::LUCK; i++)
             {
-                std::stringstream ss;
-                ss << "stats_" << (i+1);
                 unsigned int val = player->statTotal((STAT)i);
-                _counters.at(ss.str())->setNumber(val);
-                _counters.at(ss.str())->setColor(UI::BigCounter::Color::WHITE);
+                _statCounters[i]->setNumber(val);
+                _statCounters[i]->setColor(UI::BigCounter::Color::WHITE);
                 if (val > 10)
                 {
                     val = 10;
-                    _counters.at(ss.str())->setColor(UI::BigCounter::Color::RED);
+                    _statCounters[i]->setColor(UI::BigCounter::Color::RED);
                 }
-                _labels.at(ss.str())->setText(_t(MSG_EDITOR, 199 + (val < 1 ? 1 : val)));
+                _statLabels[i]->setText(_t(MSG_EDITOR, 199 + (val < 1 ? 1 : val)));
             }
 
             // Skills values
             for (unsigned i = (unsigned)SKILL::SMALL_GUNS; i <= (unsigned)SKILL::OUTDOORSMAN; i++)
             {
-                std::stringstream ss;
-                ss << "skills_" << (i + 1) << "_value";
-                *_labels.at(ss.str()) = player->skillValue((SKILL)i);
-                *_labels.at(ss.str())+= "%";
+                *_skillValues[i] = player->skillValue((SKILL)i);
+                *_skillValues[i] += "%";
             }
 
             // Default labels colors
-            for(auto it = _labels.begin(); it != _labels.end(); ++it)
-            {
-                std::string name = it->first;
-
-                SDL_Color font1_3ff800ff = {0x3f, 0xf8, 0x00, 0xff};
-                SDL_Color font1_a0a0a0ff = {0xa0, 0xa0, 0xa0, 0xff};
-                SDL_Color font1_183018ff = {0x18, 0x30, 0x18, 0xff};
-
-                if (name.find("stats_") == 0 || name.find("params_") == 0)
-                {
-                    it->second->setColor(font1_3ff800ff);
-                }
-
-                if (name.find("traits_") == 0)
-                {
-                    unsigned number = atoi(name.substr(7).c_str()) - 1;
-                    it->second->setColor(player->traitTagged((TRAIT)number) ? font1_a0a0a0ff : font1_3ff800ff);
-                }
+            SDL_Color font1_3ff800ff = {0x3f, 0xf8, 0x00, 0xff};
+            SDL_Color font1_a0a0a0ff = {0xa0, 0xa0, 0xa0, 0xff};
+            SDL_Color font1_183018ff = {0x18, 0x30, 0x18, 0xff};
 
-                if (name.find("skills_") == 0)
-                {
-                    unsigned number = atoi(name.substr(7).c_str()) - 1;
-                    it->second->setColor(player->skillTagged((SKILL)number) ? font1_a0a0a0ff : font1_3ff800ff);
-                }
-
-                if (name.find("health_") == 0)
+            for (auto& info : _labelInfos)
+            {
+                switch (info.group)
                 {
-                    it->second->setColor(name.compare("health_1") == 0 ? font1_3ff800ff : font1_183018ff);
+                    case LabelGroup::STATS:
+                    case LabelGroup::PARAMS:
+                        info.label->setColor(font1_3ff800ff);
+                        break;
+                    case LabelGroup::TRAITS:
+                        info.label->setColor(player->traitTagged((TRAIT)info.number) ? font1_a0a0a0ff : font1_3ff800ff);
+                        break;
+                    case LabelGroup::SKILLS:
+                        info.label->setColor(player->skillTagged((SKILL)info.number) ? font1_a0a0a0ff : font1_3ff800ff);
+                        break;
+                    case LabelGroup::HEALTH:
+                        info.label->setColor(info.number == 0 ? font1_3ff800ff : font1_183018ff);
+                        break;
+                    default:
+                        break;
                 }
             }
 
             // Selected labels colors
-            for(auto it = _labels.begin(); it != _labels.end(); ++it)
+            SDL_Color font1_ffff7fff = {0xff, 0xff, 0x7f, 0xff};
+            SDL_Color font1_ffffffff = {0xff, 0xff, 0xff, 0xff};
+            SDL_Color font1_707820ff = {0x70, 0x78, 0x20, 0xff};
+
+            for (auto& info : _labelInfos)
             {
-                if (_selectedLabel != it->second) {
+                if (_selectedLabel != info.label) {
                     continue;
                 }
 
-                std::string name = it->first;
-
-                _title->setText(_titles.at(name));
-                _description->setText(_descriptions.at(name));
-
-                _selectedImage = _images.at(name);
-
-                SDL_Color font1_ffff7fff = {0xff, 0xff, 0x7f, 0xff};
-                SDL_Color font1_ffffffff = {0xff, 0xff, 0xff, 0xff};
-                SDL_Color font1_707820ff = {0x70, 0x78, 0x20, 0xff};
-
-                if (name.find("stats_") == 0)
-                {
-                    it->second->setColor(font1_ffff7fff);
-                }
-
-                if (name.find("params_") == 0)
-                {
-                    it->second->setColor(font1_ffff7fff);
-                    _labels.at(name+"_value")->setColor(font1_ffff7fff);
+                if (info.title) {
+                    _title->setText(*info.title);
                 }
-
-                if (name.find("traits_") == 0)
-                {
-                    unsigned number = atoi(name.substr(7).c_str()) - 1;
-                    it->second->setColor(player->traitTagged((TRAIT)number) ? font1_ffffffff : font1_ffff7fff);
+                if (info.description) {
+                    _description->setText(*info.description);
                 }
-
-                if (name.find("skills_") == 0)
-                {
-                    unsigned number = atoi(name.substr(7).c_str()) - 1;
-                    it->second->setColor(player->skillTagged((SKILL)number) ? font1_ffffffff : font1_ffff7fff);
-                    _labels.at(name+"_value")->setColor(player->skillTagged((SKILL)number) ? font1_ffffffff : font1_ffff7fff);
+                if (info.image) {
+                    _selectedImage = info.image;
                 }
 
-                if (name.find("health_") == 0)
+                switch (info.group)
                 {
-                    it->second->setColor(name.compare("health_1") == 0 ? font1_ffff7fff : font1_707820ff);
+                    case LabelGroup::STATS:
+                        info.label->setColor(font1_ffff7fff);
+                        break;
+                    case LabelGroup::PARAMS:
+                        info.label->setColor(font1_ffff7fff);
+                        if (info.value) {
+                            info.value->setColor(font1_ffff7fff);
+                        }
+                        break;
+                    case LabelGroup::TRAITS:
+                        info.label->setColor(player->traitTagged((TRAIT)info.number) ? font1_ffffffff : font1_ffff7fff);
+                        break;
+                    case LabelGroup::SKILLS:
+                        info.label->setColor(player->skillTagged((SKILL)info.number) ? font1_ffffffff : font1_ffff7fff);
+                        if (info.value) {
+                            info.value->setColor(player->skillTagged((SKILL)info.number) ? font1_ffffffff : font1_ffff7fff);
+                        }
+                        break;
+                    case LabelGroup::HEALTH:
+                        info.label->setColor(info.number == 0 ? font1_ffff7fff : font1_707820ff);
+                        break;
+                    default:
+                        break;
                 }
             }
 
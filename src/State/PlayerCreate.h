@@ -52,6 +52,40 @@ namespace Falltergeist
                 std::map<std::string, std::string> _descriptions;
                 std::map<std::string, UI::Image*> _images;
 
+                enum class LabelGroup
+                {
+                    OTHER,
+                    STATS,
+                    PARAMS,
+                    TRAITS,
+                    SKILLS,
+                    HEALTH
+                };
+
+                // What think() needs to know about a label, resolved from its name once by _indexLabels()
+                struct LabelInfo
+                {
+                    UI::TextArea* label;
+                    UI::TextArea* value;
+                    LabelGroup group;
+                    unsigned number;
+                    const std::string* title;
+                    const std::string* description;
+                    UI::Image* image;
+                };
+
+                std::vector<LabelInfo> _labelInfos;
+                UI::TextArea* _nameLabel = nullptr;
+                UI::TextArea* _ageLabel = nullptr;
+                UI::TextArea* _genderLabel = nullptr;
+                UI::TextArea* _healthLabel = nullptr;
+                std::vector<UI::TextArea*> _statLabels;
+                std::vector<UI::BigCounter*> _statCounters;
+                std::vector<UI::TextArea*> _paramValues;
+                std::vector<UI::TextArea*> _skillValues;
+                UI::BigCounter* _statsPointsCounter = nullptr;
+                UI::BigCounter* _skillsPointsCounter = nullptr;
+
                 UI::TextArea* _addLabel(const std::string& name, UI::TextArea* label);
                 UI::ImageButton* _addButton(const std::string& name, UI::ImageButton* button);
                 UI::BigCounter* _addCounter(const std::string& name, UI::BigCounter* counter);
@@ -59,6 +93,7 @@ namespace Falltergeist
                 void _addTitle(const std::string& name, std::string title);
                 void _addDescription(const std::string& name, std::string description);
                 void _addImage(const std::string& name, UI::Image* image);
+                void _indexLabels();
 
                 bool _statIncrease(unsigned int num);
                 bool _statDecrease(unsigned int num);
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include "../Game/Object.h"
+#include "../PathFinding/Hexagon.h"
+#include "../PathFinding/HexagonGrid.h"
+#include "../State/RenderList.h"
+#include "../UI/Base.h"
+
+namespace Falltergeist
+{
+    namespace State
+    {
+        RenderList::RenderList() : _rows(HexagonGrid::MAP_ROWS), _bounds(HexagonGrid::MAP_ROWS)
+        {
+        }
+
+        void RenderList::clear()
+        {
+            for (auto& row : _rows) {
+                row.clear();
+            }
+            _bounds.assign(HexagonGrid::MAP_ROWS, Bounds());
+            _objectRows.clear();
+            _visible.clear();
+        }
+
+        void RenderList::add(Game::Object* object)
+        {
+            if (_objectRows.count(object)) {
+                move(object);
+                return;
+            }
+            int row = _row(object);
+            _objectRows.emplace(object, row);
+            _insert(object, row);
+        }
+
+        void RenderList::move(Game::Object* object)
+        {
+            auto it = _objectRows.find(object);
+            if (it == _objectRows.end()) {
+                return;
+            }
+            // the order inside the row depends on the column, so the object is re-inserted even if the row is the same
+            _erase(object, it->second);
+            it->second = _row(object);
+            _insert(object, it->second);
+        }
+
+        void RenderList::remove(Game::Object* object)
+        {
+            auto it = _objectRows.find(object);
+            if (it == _objectRows.end()) {
+                return;
+            }
+            _erase(object, it->second);
+            _objectRows.erase(it);
+            auto visible = std::find(_visible.begin(), _visible.end(), object);
+            if (visible != _visible.end()) {
+                _visible.erase(visible);
+            }
+        }
+
+        const std::vector<std::vector<Game::Object*>>& RenderList::rows() const
+        {
+            return _rows;
+        }
+
+        void RenderList::copyTo(std::vector<Game::Object*>& objects) const
+        {
+            objects.clear();
+            for (auto& row : _rows) {
+                objects.insert(objects.end(), row.begin(), row.end());
+            }
+        }
+
+        void RenderList::fit(Game::Object* object)
+        {
+            int row = _row(object);
+            if (row == NO_ROW || !object->hasUi()) {
+                return;
+            }
+            // same placement as Object::render(), objects which weren't seen yet don't build their UI for it
+            const auto size = object->uiSize();
+            auto& bounds = _bounds[row];
+            bounds.left = std::max(bounds.left, size.width() / 2);
+            bounds.right = std::max(bounds.right, size.width() - size.width() / 2);
+            bounds.up = std::max(bounds.up, size.height());
+        }
+
+        const std::vector<Game::Object*>& RenderList::cull(const Graphics::Point& topLeft, const Graphics::Size& size)
+        {
+            for (auto object : _visible) {
+                object->setInRender(false);
+            }
+            find(topLeft, size, _visible);
+            return _visible;
+        }
+
+        void RenderList::find(const Graphics::Point& topLeft, const Graphics::Size& size, std::vector<Game::Object*>& objects) const
+        {
+            objects.clear();
+
+            const int left = topLeft.x();
+            const int right = topLeft.x() + size.width();
+            const int top = topLeft.y();
+            const int bottom = topLeft.y() + size.height();
+
+            for (size_t row = 0; row != _rows.size(); ++row) {
+                auto& rowObjects = _rows[row];
+                if (rowObjects.empty()) {
+                    continue;
+                }
+                const auto& bounds = _bounds[row];
+                // x decreases and y never decreases along the row, so every condition holds for a prefix or a suffix
+                auto first = std::partition_point(rowObjects.begin(), rowObjects.end(), [&](Game::Object* object) {
+                    return object->hexagon()->position().x() - bounds.left > right;
+                });
+                first = std::partition_point(first, rowObjects.end(), [&](Game::Object* object) {
+                    return object->hexagon()->position().y() < top;
+                });
+                auto last = std::partition_point(first, rowObjects.end(), [&](Game::Object* object) {
+                    return object->hexagon()->position().x() + bounds.right >= left;
+                });
+                last = std::partition_point(first, last, [&](Game::Object* object) {
+                    return object->hexagon()->position().y() - bounds.up <= bottom;
+                });
+                objects.insert(objects.end(), first, last);
+            }
+        }
+
+        const std::vector<Game::Object*>& RenderList::visible() const
+        {
+            return _visible;
+        }
+
+        int RenderList::_row(Game::Object* object) const
+        {
+            if (!object->hexagon()) {
+                return NO_ROW;
+            }
+            return static_cast<int>(object->hexagon()->row());
+        }
+
+        void RenderList::_insert(Game::Object* object, int row)
+        {
+            if (row == NO_ROW) {
+                return;
+            }
+            fit(object);
+            auto& objects = _rows[row];
+            auto number = object->hexagon()->number();
+            // after the objects already on the same hexagon
+            auto position = std::upper_bound(objects.begin(), objects.end(), number, [](unsigned int number, Game::Object* other) {
+                return number < other->hexagon()->number();
+            });
+            objects.insert(position, object);
+        }
+
+        void RenderList::_erase(Game::Object* object, int row)
+        {
+            if (row == NO_ROW) {
+                return;
+            }
+            auto& objects = _rows[row];
+            auto it = std::find(objects.begin(), objects.end(), object);
+            if (it != objects.end()) {
+                objects.erase(it);
+            }
+        }
+    }
+}
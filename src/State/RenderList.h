@@ -0,0 +1,88 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include "../Graphics/Point.h"
+#include "../Graphics/Size.h"
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        class Object;
+    }
+
+    namespace State
+    {
+        /**
+         * Draw order of the location objects: by hexagon number, objects on the same hexagon in the order they were added.
+         * Objects are bucketed by hexagon row, so moving one only touches the rows it leaves and enters
+         * instead of sorting every object. Objects without hexagon are tracked, but not listed.
+         *
+         * Along a row hexagons move left and down on the screen, so the objects which may be seen through the camera
+         * form one span of the row, found by binary search against the largest sprite placed in the row.
+         */
+        class RenderList final
+        {
+            public:
+                RenderList();
+
+                void clear();
+
+                // Starts tracking the object at its current hexagon
+                void add(Game::Object* object);
+
+                // Re-buckets a tracked object after its hexagon changed, untracked objects are ignored
+                void move(Game::Object* object);
+
+                void remove(Game::Object* object);
+
+                // Rows from the top of the map, every one sorted by hexagon number
+                const std::vector<std::vector<Game::Object*>>& rows() const;
+
+                // Copies the listed objects in draw order, for loops which may move or remove objects
+                void copyTo(std::vector<Game::Object*>& objects) const;
+
+                // Widens the row bounds if the sprite of the object grew, called whenever its animation may have changed
+                void fit(Game::Object* object);
+
+                /**
+                 * Objects whose sprites may intersect the camera rectangle, in draw order.
+                 * Objects returned by the previous call are marked as not rendered first,
+                 * so the ones left out don't handle mouse events at stale positions.
+                 */
+                const std::vector<Game::Object*>& cull(const Graphics::Point& topLeft, const Graphics::Size& size);
+
+                // Fills objects like cull() does, leaving the visible objects as they are
+                void find(const Graphics::Point& topLeft, const Graphics::Size& size, std::vector<Game::Object*>& objects) const;
+
+                // Objects returned by the last cull()
+                const std::vector<Game::Object*>& visible() const;
+
+            private:
+                static const int NO_ROW = -1;
+
+                // largest sprite around the hexagon position of the objects placed in a row, never shrinks until clear()
+                struct Bounds {
+                    int left = 0;
+                    int right = 0;
+                    int up = 0;
+                };
+
+                std::vector<std::vector<Game::Object*>> _rows;
+
+                std::vector<Bounds> _bounds;
+
+                std::vector<Game::Object*> _visible;
+
+                // row each tracked object is listed in
+                std::unordered_map<Game::Object*, int> _objectRows;
+
+                int _row(Game::Object* object) const;
+
+                void _insert(Game::Object* object, int row);
+
+                void _erase(Game::Object* object, int row);
+        };
+    }
+}
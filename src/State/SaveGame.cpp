@@ -1,10 +1,20 @@
+#include <chrono>
+#include <ctime>
 #include <sstream>
 #include "../State/SaveGame.h"
 #include "../functions.h"
+#include "../CrossPlatform.h"
+#include "../Game/DudeObject.h"
 #include "../Game/Game.h"
+#include "../Game/Location.h"
+#include "../Game/SaveFile.h"
+#include "../Graphics/Automap.h"
 #include "../Graphics/Renderer.h"
 #include "../Input/Mouse.h"
+#include "../Logger.h"
 #include "../ResourceManager.h"
+#include "../Settings.h"
+#include "../State/Location.h"
 #include "../State/State.h"
 #include "../UI/Factory/ImageButtonFactory.h"
 #include "../UI/Image.h"
@@ -48,9 +58,13 @@ namespace Falltergeist
             // BUTTONS
 
             // button: up arrow
-            addUI("button_up", imageButtonFactory->getByType(ImageButtonType::SMALL_UP_ARROW, {bgX + 35, bgY + 58}));
+            auto upButton = addUI("button_up", imageButtonFactory->getByType(ImageButtonType::SMALL_UP_ARROW, {bgX + 35, bgY + 58}));
+            upButton->mouseClickHandler().add([this](Event::Event* event){ _slots->scroll(-1); });
             // button: down arrow
-            addUI("button_down", imageButtonFactory->getByType(ImageButtonType::SMALL_DOWN_ARROW, {bgX + 35, bgY + 72}));
+            auto downButton = addUI("button_down", imageButtonFactory->getByType(ImageButtonType::SMALL_DOWN_ARROW, {bgX + 35, bgY + 72}));
+            downButton->mouseClickHandler().add([this](Event::Event* event){ _slots->scroll(1); });
+
+            _slots = std::make_unique<SaveSlots>(this, bgPos);
 
             // button: Done
             auto doneButton = imageButtonFactory->getByType(ImageButtonType::SMALL_RED_CIRCLE, {bgX + 391, bgY + 349});
@@ -80,13 +94,64 @@ namespace Falltergeist
             auto cancelButtonLabel = new UI::TextArea(_t(MSG_OPTIONS, 121), bgX+515, bgY+348);
             cancelButtonLabel->setFont(font3_907824ff, color);
             addUI(cancelButtonLabel);
+
+            _status = new UI::TextArea("", bgX+48, bgY+349);
+            _status->setFont(font3_907824ff, color);
+            addUI(_status);
         }
 
-        void SaveGame::onDoneButtonClick(Event::Mouse* event)
+        void SaveGame::think(const float &deltaTime)
         {
+            State::think(deltaTime);
+            _slots->think();
+
+            if (!_saving.valid() || _saving.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return;
+            }
+            bool saved = _saving.get();
+            _saving = std::shared_future<bool>();
+            if (!saved) {
+                Logger::error("SAVE") << "Can't write " << Game::SaveFile::slotFilename(_slots->selected()) << std::endl;
+                // "Error saving game!"
+                _status->setText(_t(MSG_LOAD_SAVE, 132));
+                return;
+            }
             Game::Game::getInstance()->popState();
         }
 
+        void SaveGame::onDoneButtonClick(Event::Mouse* event)
+        {
+            if (_saving.valid()) {
+                return;
+            }
+
+            auto game = Game::Game::getInstance();
+            auto location = game->locationState();
+            if (!location) {
+                game->popState();
+                return;
+            }
+
+            location->storeMapChanges();
+            auto saveFile = game->saveFile();
+            saveFile->storeGlobals(*game->GVARS(), *game->player(), location->location()->name());
+
+            Game::SaveFile::Summary summary;
+            summary.name = game->player()->name();
+            summary.map = location->location()->name();
+            summary.time = static_cast<int64_t>(std::time(nullptr));
+            // the explored part of the map stands in for a screenshot, the screen shows this state by now
+            if (auto automap = location->automap()) {
+                summary.thumbnailWidth = static_cast<uint32_t>(SaveSlots::THUMBNAIL_SIZE.width());
+                summary.thumbnailHeight = static_cast<uint32_t>(SaveSlots::THUMBNAIL_SIZE.height());
+                summary.thumbnail = automap->thumbnail(SaveSlots::THUMBNAIL_SIZE);
+            }
+
+            CrossPlatform::createDirectory(CrossPlatform::getConfigPath() + "/savegame");
+            _saving = saveFile->writeAsync(Game::SaveFile::slotFilename(_slots->selected()), game->settings()->saveCompression(), std::move(summary));
+            _status->setText(_t(MSG_LOAD_SAVE, 109) + "...");
+        }
+
         void SaveGame::onCancelButtonClick(Event::Mouse* event)
         {
             Game::Game::getInstance()->popState();
@@ -109,6 +174,12 @@ namespace Falltergeist
                 case SDLK_ESCAPE:
                     Game::Game::getInstance()->popState();
                     break;
+                case SDLK_UP:
+                    _slots->select(_slots->selected() > 0 ? _slots->selected() - 1 : 0);
+                    break;
+                case SDLK_DOWN:
+                    _slots->select(_slots->selected() + 1);
+                    break;
             }
         }
     }
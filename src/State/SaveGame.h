@@ -1,5 +1,7 @@
 #pragma once
 
+#include <future>
+#include "../State/SaveSlots.h"
 #include "../State/State.h"
 #include "../UI/IResourceManager.h"
 
@@ -11,6 +13,7 @@ namespace Falltergeist
         {
             class ImageButtonFactory;
         }
+        class TextArea;
     }
     namespace State
     {
@@ -22,6 +25,8 @@ namespace Falltergeist
 
                 void init() override;
 
+                void think(const float &deltaTime) override;
+
                 void onDoneButtonClick(Event::Mouse* event);
                 void onCancelButtonClick(Event::Mouse* event);
 
@@ -32,6 +37,11 @@ namespace Falltergeist
             private:
                 std::shared_ptr<UI::IResourceManager> resourceManager;
                 std::unique_ptr<UI::Factory::ImageButtonFactory> imageButtonFactory;
+                std::unique_ptr<SaveSlots> _slots;
+
+                // the file is written in the background, the state closes once it's done
+                std::shared_future<bool> _saving;
+                UI::TextArea* _status = nullptr;
         };
     }
 }
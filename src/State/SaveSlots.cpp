@@ -0,0 +1,231 @@
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include "../Base/ThreadPool.h"
+#include "../Graphics/Pixels.h"
+#include "../Graphics/Sprite.h"
+#include "../Graphics/Texture.h"
+#include "../State/SaveSlots.h"
+#include "../State/State.h"
+#include "../UI/Image.h"
+#include "../UI/TextArea.h"
+
+namespace Falltergeist
+{
+    namespace State
+    {
+        const unsigned int SaveSlots::ROWS = 10;
+
+        // the size of the screenshots of the original saves, the box of lsgame.frm fits it
+        const Graphics::Size SaveSlots::THUMBNAIL_SIZE = Graphics::Size(224, 133);
+
+        namespace
+        {
+            const SDL_Color ROW_COLOR = {0x90, 0x78, 0x24, 0xff};
+
+            const SDL_Color SELECTED_COLOR = {0xfc, 0xfc, 0x7c, 0xff};
+
+            const int ROW_HEIGHT = 27;
+        }
+
+        SaveSlots::SaveSlots(State* state, const Graphics::Point& background) : _slots(Game::SaveFile::SLOTS)
+        {
+            _reader = std::make_unique<Base::ThreadPool>(1);
+
+            for (unsigned int i = 0; i != ROWS; ++i)
+            {
+                auto row = new UI::TextArea("", background + Point(55, 87 + static_cast<int>(i) * ROW_HEIGHT));
+                row->setFont("font3.aaf", ROW_COLOR);
+                row->setSize({270, ROW_HEIGHT});
+                row->mouseClickHandler().add([this, i](Event::Mouse* event) {
+                    select(_first + i);
+                });
+                state->addUI(row);
+                _rows.push_back(row);
+            }
+
+            std::vector<uint8_t> blank(static_cast<size_t>(THUMBNAIL_SIZE.width()) * THUMBNAIL_SIZE.height() * 4, 0);
+            _thumbnail = std::make_shared<Graphics::Texture>(Graphics::Pixels(blank.data(), THUMBNAIL_SIZE, Graphics::Pixels::Format::RGBA));
+            _thumbnailImage = new UI::Image(std::make_unique<Graphics::Sprite>(_thumbnail));
+            _thumbnailImage->setPosition(background + Point(366, 58));
+            _thumbnailImage->setVisible(false);
+            state->addUI(_thumbnailImage);
+
+            _details = new UI::TextArea("", background + Point(366, 200));
+            _details->setFont("font3.aaf", ROW_COLOR);
+            _details->setSize({THUMBNAIL_SIZE.width(), 100});
+            _details->setWordWrap(true);
+            state->addUI(_details);
+
+            _request();
+            _update();
+        }
+
+        // the reads only touch their own summary, the pool finishes them before joining
+        SaveSlots::~SaveSlots() = default;
+
+        void SaveSlots::think()
+        {
+            bool changed = false;
+            for (auto& slot : _slots)
+            {
+                if (!slot.pending.valid() || slot.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                {
+                    continue;
+                }
+                slot.summary = slot.pending.get();
+                slot.pending = {};
+                slot.read = true;
+                changed = true;
+            }
+            if (changed)
+            {
+                _update();
+            }
+        }
+
+        void SaveSlots::scroll(int rows)
+        {
+            int last = static_cast<int>(_slots.size()) - static_cast<int>(ROWS);
+            int first = std::max(0, std::min(static_cast<int>(_first) + rows, last));
+            if (static_cast<unsigned int>(first) == _first)
+            {
+                return;
+            }
+            _first = static_cast<unsigned int>(first);
+            _request();
+            _update();
+        }
+
+        void SaveSlots::select(unsigned int slot)
+        {
+            if (slot >= _slots.size())
+            {
+                return;
+            }
+            _selected = slot;
+            // the selection stays in view
+            if (_selected < _first)
+            {
+                scroll(static_cast<int>(_selected) - static_cast<int>(_first));
+            }
+            else if (_selected >= _first + ROWS)
+            {
+                scroll(static_cast<int>(_selected - _first - ROWS + 1));
+            }
+            _update();
+        }
+
+        unsigned int SaveSlots::selected() const
+        {
+            return _selected;
+        }
+
+        bool SaveSlots::saved() const
+        {
+            auto& slot = _slots.at(_selected);
+            return slot.read && slot.summary;
+        }
+
+        void SaveSlots::reload(unsigned int slot)
+        {
+            _slots.at(slot) = Slot();
+            _request();
+            _update();
+        }
+
+        void SaveSlots::_request()
+        {
+            for (unsigned int i = _first; i != std::min(_first + ROWS, static_cast<unsigned int>(_slots.size())); ++i)
+            {
+                auto& slot = _slots[i];
+                if (slot.requested)
+                {
+                    continue;
+                }
+                slot.requested = true;
+                auto filename = Game::SaveFile::slotFilename(i);
+                slot.pending = _reader->enqueue([filename]() -> std::shared_ptr<const Game::SaveFile::Summary> {
+                    auto summary = std::make_shared<Game::SaveFile::Summary>();
+                    if (Game::SaveFile::readSummary(Game::SaveFile::summaryFilename(filename), *summary))
+                    {
+                        return summary;
+                    }
+                    // saves written before the summaries were, they are listed without details
+                    std::error_code error;
+                    if (std::filesystem::exists(filename, error))
+                    {
+                        return std::make_shared<Game::SaveFile::Summary>();
+                    }
+                    return nullptr;
+                }).share();
+            }
+        }
+
+        void SaveSlots::_update()
+        {
+            for (unsigned int i = 0; i != ROWS; ++i)
+            {
+                unsigned int index = _first + i;
+                auto row = _rows[i];
+                if (index >= _slots.size())
+                {
+                    row->setText("");
+                    continue;
+                }
+                auto& slot = _slots[index];
+                std::ostringstream text;
+                text << std::setw(2) << std::setfill('0') << index + 1 << ". ";
+                if (!slot.read)
+                {
+                    text << "...";
+                }
+                else if (!slot.summary)
+                {
+                    text << "EMPTY SLOT";
+                }
+                else
+                {
+                    text << (slot.summary->name.empty() ? "SAVED GAME" : slot.summary->name);
+                }
+                row->setText(text.str());
+                row->setColor(index == _selected ? SELECTED_COLOR : ROW_COLOR);
+            }
+
+            auto& selected = _slots[_selected];
+            auto summary = selected.read ? selected.summary : nullptr;
+            _showThumbnail(summary);
+            if (!summary)
+            {
+                _details->setText("");
+                return;
+            }
+            std::ostringstream details;
+            details << summary->map;
+            if (summary->time)
+            {
+                auto time = static_cast<std::time_t>(summary->time);
+                details << "\n" << std::put_time(std::localtime(&time), "%d %b %Y %H:%M");
+            }
+            _details->setText(details.str());
+        }
+
+        void SaveSlots::_showThumbnail(const std::shared_ptr<const Game::SaveFile::Summary>& summary)
+        {
+            if (summary == _shown)
+            {
+                return;
+            }
+            _shown = summary;
+            if (!summary || summary->thumbnailWidth != static_cast<uint32_t>(THUMBNAIL_SIZE.width())
+                || summary->thumbnailHeight != static_cast<uint32_t>(THUMBNAIL_SIZE.height()))
+            {
+                _thumbnailImage->setVisible(false);
+                return;
+            }
+            _thumbnail->update(Graphics::Pixels(summary->thumbnail.data(), THUMBNAIL_SIZE, Graphics::Pixels::Format::RGBA));
+            _thumbnailImage->setVisible(true);
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <vector>
+#include "../Game/SaveFile.h"
+#include "../Graphics/Point.h"
+#include "../Graphics/Size.h"
+
+namespace Falltergeist
+{
+    namespace Base
+    {
+        class ThreadPool;
+    }
+    namespace Graphics
+    {
+        class Texture;
+    }
+    namespace UI
+    {
+        class Image;
+        class TextArea;
+    }
+    namespace State
+    {
+        class State;
+
+        /**
+         * Slot list of the save and load screens, drawn over lsgame.frm. Only the summaries of the slots scrolled
+         * into view are read, on a thread of their own, so the screens open at once however many saves there are.
+         * Rows show their slot until the summary is read, the selected slot shows its thumbnail and map as well
+         */
+        class SaveSlots final
+        {
+            public:
+                static const unsigned int ROWS;
+
+                static const Graphics::Size THUMBNAIL_SIZE;
+
+                // Adds the rows, the thumbnail and the details to the state, positions are relative to the background
+                SaveSlots(State* state, const Graphics::Point& background);
+
+                // Waits for the reads in flight
+                ~SaveSlots();
+
+                // Shows the summaries read meanwhile
+                void think();
+
+                void scroll(int rows);
+
+                void select(unsigned int slot);
+
+                unsigned int selected() const;
+
+                // Whether the summary of the selected slot is read and there is a save in it
+                bool saved() const;
+
+                // Reads the summary of the slot again, after the slot was saved to
+                void reload(unsigned int slot);
+
+            private:
+                struct Slot
+                {
+                    bool requested = false;
+                    // nullptr if the slot is empty
+                    std::shared_future<std::shared_ptr<const Game::SaveFile::Summary>> pending;
+                    std::shared_ptr<const Game::SaveFile::Summary> summary;
+                    bool read = false;
+                };
+
+                std::vector<Slot> _slots;
+
+                unsigned int _first = 0;
+
+                unsigned int _selected = 0;
+
+                std::vector<UI::TextArea*> _rows;
+
+                UI::TextArea* _details = nullptr;
+
+                std::shared_ptr<Graphics::Texture> _thumbnail;
+
+                UI::Image* _thumbnailImage = nullptr;
+
+                // uploaded into the thumbnail texture, it only changes with the selection or the summary
+                std::shared_ptr<const Game::SaveFile::Summary> _shown;
+
+                std::unique_ptr<Base::ThreadPool> _reader;
+
+                // Requests the summaries of the rows in view
+                void _request();
+
+                void _update();
+
+                void _showThumbnail(const std::shared_ptr<const Game::SaveFile::Summary>& summary);
+        };
+    }
+}
@@ -6,6 +6,7 @@
 #include "../Input/Mouse.h"
 #include "../ResourceManager.h"
 #include "../Settings.h"
+#include "../Simulation.h"
 #include "../UI/Factory/ImageButtonFactory.h"
 #include "../UI/Image.h"
 #include "../UI/ImageButton.h"
@@ -34,6 +35,7 @@ namespace Falltergeist
 
             setModal(true);
             setFullscreen(true);
+            setCachedRender(true);
 
             // background
             auto background = resourceManager->getImage("art/intrface/prefscrn.frm");
@@ -469,6 +471,7 @@ namespace Falltergeist
 
             settings->setTextDelay(((UI::Slider*)getUI("text_delay"))->value());
             settings->setCombatSpeed(static_cast<unsigned>(((UI::Slider*)getUI("combat_speed"))->value()));
+            Simulation::setAnimationSpeed(settings->animationSpeed());
             settings->setBrightness(((UI::Slider*)getUI("brightness"))->value());
             settings->setMouseSensitivity(((UI::Slider*)getUI("mouse_sensitivity"))->value());
 
@@ -37,6 +37,7 @@ namespace Falltergeist
 
             setModal(true);
             setFullscreen(false);
+            setCachedRender(true);
 
             // original coordinates = 455x6
             // background size = 185x368
@@ -9,6 +9,7 @@
 #include "../Input/Mouse.h"
 #include "../ResourceManager.h"
 #include "../Settings.h"
+#include "../Simulation.h"
 #include "../State/CritterDialog.h"
 #include "../State/Location.h"
 #include "../State/MainMenu.h"
@@ -44,7 +45,7 @@ namespace Falltergeist
 
             setPosition((renderer->size() - Point(640, 480)) / 2);
 
-            addUI("splash", resourceManager->getImage("art/splash/" + splashes.at(rand() % splashes.size())));
+            addUI("splash", resourceManager->getImage("art/splash/" + splashes.at(Simulation::random() % splashes.size())));
 
             auto game = Game::Game::getInstance();
             _delayTimer = std::make_unique<Game::Timer>(3000);
@@ -3,6 +3,7 @@
 #include "../State/State.h"
 #include "../Event/State.h"
 #include "../Game/Game.h"
+#include "../Graphics/FrameBuffer.h"
 #include "../Graphics/Renderer.h"
 #include "../UI/ImageList.h"
 #include "../UI/SmallCounter.h"
@@ -15,6 +16,8 @@ namespace Falltergeist
         State::State() : Event::EventTarget(Game::Game::getInstance()->eventDispatcher())
         {
             activateHandler().add([this](Event::State* event) {
+                // states above could have changed what this one shows
+                _cacheValid = false;
                 this->onStateActivate(event);
             });
             deactivateHandler().add([this](Event::State* event) {
@@ -25,6 +28,10 @@ namespace Falltergeist
             });
         }
 
+        State::~State()
+        {
+        }
+
         void State::init()
         {
             _initialized = true;
@@ -79,6 +86,9 @@ namespace Falltergeist
 
         void State::setFullscreen(bool value)
         {
+            if (_fullscreen != value) {
+                Game::Game::getInstance()->invalidateStateLists();
+            }
             _fullscreen = value;
         }
 
@@ -89,6 +99,9 @@ namespace Falltergeist
 
         void State::setModal(bool value)
         {
+            if (_modal != value) {
+                Game::Game::getInstance()->invalidateStateLists();
+            }
             _modal = value;
         }
 
@@ -99,6 +112,8 @@ namespace Falltergeist
             ui->setPosition(ui->position() - ui->offset() + position());
 
             _ui.push_back(std::unique_ptr<UI::Base>(ui));
+            _cacheValid = false;
+            _hitGridValid = false;
             return ui;
         }
 
@@ -144,6 +159,8 @@ namespace Falltergeist
             if (event->isHandled()) {
                 return;
             }
+            // hover, clicks and typing are what changes UI of cached states
+            _cacheValid = false;
             // TODO: maybe make handle() a template function to get rid of dynamic_casts?
             if (auto keyboardEvent = dynamic_cast<Event::Keyboard*>(event)) {
                 if (keyboardEvent->originalType() == Event::Keyboard::Type::KEY_UP) {
@@ -154,6 +171,11 @@ namespace Falltergeist
                 }
             }
 
+            if (auto mouseEvent = dynamic_cast<Event::Mouse*>(event)) {
+                _handleMouse(mouseEvent);
+                return;
+            }
+
             for (auto it = _ui.rbegin(); it != _ui.rend(); ++it) {
                 if (event->isHandled()) {
                     return;
@@ -162,14 +184,102 @@ namespace Falltergeist
             }
         }
 
+        void State::_handleMouse(Event::Mouse* event)
+        {
+            if (!_hitGridValid) {
+                // adding or popping UI shifts the indexes
+                _engagedUI.clear();
+                for (size_t i = 0; i != _ui.size(); ++i) {
+                    if (_ui[i]->mouseEngaged()) {
+                        _engagedUI.push_back(i);
+                    }
+                }
+            }
+            if (!_hitGridValid || _hitGridGeneration != UI::Base::layoutGeneration()) {
+                _hitGrid.build(_ui);
+                _hitGridValid = true;
+                _hitGridGeneration = UI::Base::layoutGeneration();
+            }
+
+            _hitGrid.candidates(event->position(), _hitCandidates);
+            auto underCursor = _hitCandidates.size();
+            _hitCandidates.insert(_hitCandidates.end(), _engagedUI.begin(), _engagedUI.end());
+            std::inplace_merge(_hitCandidates.begin(), _hitCandidates.begin() + underCursor, _hitCandidates.end());
+            _hitCandidates.erase(std::unique(_hitCandidates.begin(), _hitCandidates.end()), _hitCandidates.end());
+
+            // same front to back order as for the other events, elements left out would ignore the event anyway
+            for (auto it = _hitCandidates.rbegin(); it != _hitCandidates.rend(); ++it) {
+                if (event->isHandled()) {
+                    break;
+                }
+                if (*it < _ui.size()) {
+                    _ui[*it]->handle(event);
+                }
+            }
+
+            // only the candidates could have started or stopped an interaction
+            if (_hitGridValid) {
+                _engagedUI.clear();
+                for (auto i : _hitCandidates) {
+                    if (i < _ui.size() && _ui[i]->mouseEngaged()) {
+                        _engagedUI.push_back(i);
+                    }
+                }
+            }
+        }
+
         void State::render()
+        {
+            auto renderer = Game::Game::getInstance()->renderer();
+            // without the composition pass fading is mixed into every sprite, a cached layer would keep the colors of one fade step
+            bool fadeInLayer = !renderer->composing() && (renderer->fading() || renderer->fadeColor().w > 0.0f);
+            if (!_cachedRender || !renderer->supportsFrameBuffers() || fadeInLayer) {
+                _cacheValid = false;
+                renderUI();
+                _uiToDelete.clear();
+                return;
+            }
+
+            if (!_cache || _cache->size() != renderer->size()) {
+                _cache = std::make_unique<Graphics::FrameBuffer>(renderer->size());
+                _cacheValid = false;
+            }
+            if (!_cacheValid) {
+                renderer->beginFrameBuffer(_cache.get());
+                renderUI();
+                renderer->endFrameBuffer(_cache.get());
+                _cacheValid = true;
+            }
+            renderer->drawFrameBuffer(_cache.get());
+            _uiToDelete.clear();
+        }
+
+        void State::renderUI()
         {
             for (auto& ui : _ui) {
                 if (ui->visible()) {
                     ui->render(false);
                 }
             }
-            _uiToDelete.clear();
+        }
+
+        void State::setCachedRender(bool value)
+        {
+            _cachedRender = value;
+            _cacheValid = false;
+            if (!value) {
+                _cache.reset();
+            }
+        }
+
+        void State::invalidate()
+        {
+            _cacheValid = false;
+        }
+
+        bool State::cacheCurrent() const
+        {
+            return _cachedRender && _cacheValid && _cache && _uiToDelete.empty();
         }
 
         void State::popUI()
@@ -179,6 +289,8 @@ namespace Falltergeist
             }
             _uiToDelete.emplace_back(std::move(_ui.back()));
             _ui.pop_back();
+            _cacheValid = false;
+            _hitGridValid = false;
         }
 
         void State::onStateActivate(Event::State* event)
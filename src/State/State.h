@@ -7,6 +7,7 @@
 #include "../Event/Keyboard.h"
 #include "../Event/Mouse.h"
 #include "../Graphics/Point.h"
+#include "../UI/HitGrid.h"
 #include "../VM/Script.h"
 
 namespace Falltergeist
@@ -20,6 +21,10 @@ namespace Falltergeist
     {
         class Game;
     }
+    namespace Graphics
+    {
+        class FrameBuffer;
+    }
     namespace UI
     {
         class ImageList;
@@ -37,18 +42,29 @@ namespace Falltergeist
                 State();
                 State(const State&) = delete;
                 State& operator=(const State&) = delete;
-                virtual ~State() = default;
+                virtual ~State();
 
                 template <class TUi, class ...TCtorArgs>
                 TUi* makeUI(TCtorArgs&&... args)
                 {
                     TUi* ptr = new TUi(std::forward<TCtorArgs>(args)...);
                     _ui.emplace_back(ptr);
+                    _cacheValid = false;
+                    _hitGridValid = false;
                     return ptr;
                 }
 
                 UI::Base* addUI(UI::Base* ui);
                 UI::Base* addUI(const std::string& name, UI::Base* ui);
+
+                // Keeps the type of the named element, so it can be stored and used without getUI() and a cast
+                template <class TUi>
+                TUi* addUI(const std::string& name, TUi* ui)
+                {
+                    addUI(name, static_cast<UI::Base*>(ui));
+                    return ui;
+                }
+
                 void addUI(const std::vector<UI::Base*>& uis);
                 void popUI();
 
@@ -126,6 +142,19 @@ namespace Falltergeist
 
                 void scriptFade(VM::Script* script, bool in);
 
+                /**
+                 * @brief Renders the UI of this state into an offscreen layer which is re-rendered only after invalidate().
+                 * Input events, adding and popping UI invalidate the layer, so this suits states
+                 * whose elements only change in response to the player (no animations, clocks or palette cycling).
+                 */
+                void setCachedRender(bool value);
+
+                // Forces the cached layer to be rendered again, for UI changed outside of input handling
+                void invalidate();
+
+                // The cached layer is up to date, so rendering would draw the same as in the last frame
+                bool cacheCurrent() const;
+
 
             protected:
                 std::vector<std::unique_ptr<UI::Base>> _ui;
@@ -140,6 +169,20 @@ namespace Falltergeist
                 bool _fullscreen = true; // prevents render all states before this one
                 bool _initialized = false;
 
+                bool _cachedRender = false;
+                bool _cacheValid = false;
+                std::unique_ptr<Graphics::FrameBuffer> _cache;
+
+                // mouse events are offered only to the elements under the cursor and to those hovered or pressed before
+                UI::HitGrid _hitGrid;
+                bool _hitGridValid = false;
+                unsigned int _hitGridGeneration = 0;
+                std::vector<size_t> _engagedUI;
+                std::vector<size_t> _hitCandidates;
+
+                void renderUI();
+                void _handleMouse(Event::Mouse* event);
+
                 Event::StateHandler _activateHandler, _deactivateHandler, _fadeDoneHandler, _pushHandler, _popHandler;
                 Event::KeyboardHandler _keyDownHandler, _keyUpHandler;
         };
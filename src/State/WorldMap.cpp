@@ -1,6 +1,7 @@
 #include "../State/WorldMap.h"
 #include "../Game/Game.h"
 #include "../Graphics/Renderer.h"
+#include "../Graphics/WorldMapTiles.h"
 #include "../Input/Mouse.h"
 #include "../ResourceManager.h"
 #include "../Settings.h"
@@ -9,7 +10,6 @@
 #include "../UI/Factory/ImageButtonFactory.h"
 #include "../UI/Image.h"
 #include "../UI/ImageButton.h"
-#include "../UI/ImageList.h"
 #include "../UI/TextArea.h"
 
 namespace Falltergeist
@@ -24,6 +24,10 @@ namespace Falltergeist
             imageButtonFactory = std::make_unique<UI::Factory::ImageButtonFactory>(resourceManager);
         }
 
+        WorldMap::~WorldMap()
+        {
+        }
+
         void WorldMap::init()
         {
             if (_initialized) {
@@ -38,28 +42,11 @@ namespace Falltergeist
             unsigned int renderHeight = Game::Game::getInstance()->renderer()->size().height();
 
             // loading map tiles
-            _tiles = new UI::ImageList({0, 0}, {
-                resourceManager->getImage("art/intrface/wrldmp00.frm"),
-                resourceManager->getImage("art/intrface/wrldmp01.frm"),
-                resourceManager->getImage("art/intrface/wrldmp02.frm"),
-                resourceManager->getImage("art/intrface/wrldmp03.frm"),
-                resourceManager->getImage("art/intrface/wrldmp04.frm"),
-                resourceManager->getImage("art/intrface/wrldmp05.frm"),
-                resourceManager->getImage("art/intrface/wrldmp06.frm"),
-                resourceManager->getImage("art/intrface/wrldmp07.frm"),
-                resourceManager->getImage("art/intrface/wrldmp08.frm"),
-                resourceManager->getImage("art/intrface/wrldmp09.frm"),
-                resourceManager->getImage("art/intrface/wrldmp10.frm"),
-                resourceManager->getImage("art/intrface/wrldmp11.frm"),
-                resourceManager->getImage("art/intrface/wrldmp12.frm"),
-                resourceManager->getImage("art/intrface/wrldmp13.frm"),
-                resourceManager->getImage("art/intrface/wrldmp14.frm"),
-                resourceManager->getImage("art/intrface/wrldmp15.frm"),
-                resourceManager->getImage("art/intrface/wrldmp16.frm"),
-                resourceManager->getImage("art/intrface/wrldmp17.frm"),
-                resourceManager->getImage("art/intrface/wrldmp18.frm"),
-                resourceManager->getImage("art/intrface/wrldmp19.frm")
-            });
+            std::vector<std::string> tileFilenames;
+            for (unsigned int i = 0; i != tilesNumberX * tilesNumberY; ++i) {
+                tileFilenames.push_back("art/intrface/wrldmp" + std::string(i < 10 ? "0" : "") + std::to_string(i) + ".frm");
+            }
+            _tiles = std::make_unique<Graphics::WorldMapTiles>(tileFilenames, tilesNumberX, Graphics::Size(tileWidth, tileHeight));
 
             //auto cross = new Image("art/intrface/wmaploc.frm");
             _hotspot = imageButtonFactory->getByType(ImageButtonType::MAP_HOTSPOT, {0, 0});
@@ -116,32 +103,11 @@ namespace Falltergeist
                 deltaY = worldMapSizeY - mapHeight;
             }
 
-            signed int worldTileMinX = 0; // start X coordinate of current tile on world map
-            signed int worldTileMinY = 0; // start Y coordinate of current tile on world map
-            // NB: can be unsigned, but it compared with signed deltaX and deltaY, so...
-
-            // copy tiles to screen if needed
-            for (unsigned int y=0; y<tilesNumberY; y++)
-            {
-                for (unsigned int x=0; x<tilesNumberX; x++)
-                {
-                    _tiles->setCurrentImage(y*tilesNumberX+x);
-                    worldTileMinX = x*tileWidth;
-                    worldTileMinY = y*tileHeight;
-                    // checking if tile is visible on screenMap
-                    // checking current tile borders
-                    // either xmin or xmax SHOULD belongs to map area AND
-                    // either ymin or ymax SHOULD belongs to map area
-                    if((((deltaX<=worldTileMinX) && (worldTileMinX<=deltaX+(signed int)mapWidth)) ||
-                        ((deltaX<=worldTileMinX+(signed int)tileWidth) && (worldTileMinX+(signed int)tileWidth<=deltaX+(signed int)mapWidth))) &&
-                        (((deltaY<=worldTileMinY) && (worldTileMinY<=deltaY+(signed int)mapHeight)) ||
-                        ((deltaY<=worldTileMinY+(signed int)tileHeight) && (worldTileMinY+(signed int)tileHeight<=deltaY+(signed int)mapHeight))) )
-                    {
-                        _tiles->images().at(y*tilesNumberX+x)->setPosition(Point(x*tileWidth-deltaX, y*tileHeight-deltaY));
-                        _tiles->images().at(y*tilesNumberX+x)->render();
-                    }
-                }
-            }
+            // only the tiles seen through the map screen are drawn, cropped to it
+            _tiles->render(
+                Graphics::Rectangle(Point(mapMinX, mapMinY), Graphics::Size(mapWidth, mapHeight)),
+                Point(deltaX, deltaY)
+            );
 
             // hostpot show
             _hotspot->setPosition(Point(mapMinX + worldMapX - deltaX, mapMinY + worldMapY - deltaY));
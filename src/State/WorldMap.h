@@ -1,10 +1,15 @@
 #pragma once
 
+#include <memory>
 #include "../State/State.h"
 #include "../UI/IResourceManager.h"
 
 namespace Falltergeist
 {
+    namespace Graphics
+    {
+        class WorldMapTiles;
+    }
     namespace UI
     {
         namespace Factory
@@ -13,7 +18,6 @@ namespace Falltergeist
         }
         class Image;
         class ImageButton;
-        class ImageList;
     }
     namespace State
     {
@@ -22,7 +26,7 @@ namespace Falltergeist
             public:
 
                 WorldMap(std::shared_ptr<UI::IResourceManager> resourceManager);
-                virtual ~WorldMap() = default;
+                ~WorldMap() override;
 
                 void init() override;
                 void render() override;
@@ -36,7 +40,7 @@ namespace Falltergeist
                 std::unique_ptr<UI::Factory::ImageButtonFactory> imageButtonFactory;
 
                 UI::Image* _panel = nullptr;
-                UI::ImageList* _tiles = nullptr;
+                std::unique_ptr<Graphics::WorldMapTiles> _tiles;
                 UI::ImageButton* _hotspot = nullptr;
 
                 // temporary!
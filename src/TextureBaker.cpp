@@ -0,0 +1,136 @@
+#include <chrono>
+#include <deque>
+#include <future>
+#include <iomanip>
+#include <unordered_set>
+#include <vector>
+#include "Base/ThreadPool.h"
+#include "CrossPlatform.h"
+#include "Exception.h"
+#include "Format/Dat/Stream.h"
+#include "Format/Frm/File.h"
+#include "Format/Rix/File.h"
+#include "Graphics/TexturePack.h"
+#include "ResourceManager.h"
+#include "TextureBaker.h"
+#include "VFS/DatArchiveDriver.h"
+#include "VFS/DatArchiveIndex.h"
+#include "VFS/MappedDatArchiveDriver.h"
+
+namespace Falltergeist
+{
+    using namespace Format;
+
+    namespace
+    {
+        struct Image
+        {
+            std::string path;
+            std::vector<uint8_t> pixels;
+            Graphics::Size size;
+            Graphics::Pixels::Format format = Graphics::Pixels::Format::Indexed;
+            std::string error;
+        };
+
+        bool baked(const std::string& path)
+        {
+            auto extension = path.size() > 4 ? path.substr(path.size() - 4) : "";
+            return extension == ".frm" || extension == ".rix";
+        }
+
+        // Same pixels as ResourceManager::texture() creates from the file
+        Image bake(VFS::IDriver& driver, const std::string& path)
+        {
+            Image image;
+            image.path = path;
+            try {
+                auto file = driver.open(path, VFS::IFile::OpenMode::Read);
+                if (!file || !file->isOpened()) {
+                    throw Exception("can't be opened");
+                }
+                Dat::Stream stream(file);
+                if (path.compare(path.size() - 4, 4, ".frm") == 0) {
+                    Frm::File frm(std::move(stream));
+                    image.pixels = frm.indexes();
+                    image.size = Graphics::Size(frm.width(), frm.height());
+                } else {
+                    Rix::File rix(std::move(stream));
+                    auto rgba = reinterpret_cast<const uint8_t*>(rix.rgba());
+                    image.pixels.assign(rgba, rgba + static_cast<size_t>(rix.width()) * rix.height() * 4);
+                    image.size = Graphics::Size(rix.width(), rix.height());
+                    image.format = Graphics::Pixels::Format::RGBA;
+                }
+            } catch (const std::exception& e) {
+                image.error = e.what();
+            }
+            return image;
+        }
+    }
+
+    TextureBaker::TextureBaker(std::shared_ptr<ILogger> logger) : _logger(std::move(logger))
+    {
+    }
+
+    bool TextureBaker::run(const std::string& path, unsigned int threads, std::ostream& report)
+    {
+        auto resourceManager = ResourceManager::getInstance();
+        std::string cachePath = resourceManager->cachePath();
+
+        // archives are mounted in this order, the first one having a file provides it
+        std::vector<std::unique_ptr<VFS::IDriver>> drivers;
+        std::vector<std::pair<VFS::IDriver*, std::string>> entries;
+        std::unordered_set<std::string> seen;
+        for (auto& filename : CrossPlatform::findFalloutDataFiles()) {
+            std::string archivePath = CrossPlatform::findFalloutDataPath() + "/" + filename;
+            auto index = VFS::DatArchiveIndex::load(archivePath, cachePath.empty() ? "" : cachePath + "/" + filename + ".idx");
+            try {
+                drivers.push_back(std::make_unique<VFS::MappedDatArchiveDriver>(archivePath, index));
+            } catch (const Exception& e) {
+                _logger->warning() << "[BAKE] " << e.what() << ", falling back to stream based DAT reader" << std::endl;
+                drivers.push_back(std::make_unique<VFS::DatArchiveDriver>(archivePath, index));
+            }
+            for (auto& entry : index->paths()) {
+                if (baked(entry) && seen.insert(entry).second) {
+                    entries.emplace_back(drivers.back().get(), entry);
+                }
+            }
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        Graphics::TexturePackWriter writer(path, resourceManager->dataStamp());
+        size_t failures = 0;
+        unsigned long long bytes = 0;
+        {
+            // images are written in order while the next ones are decoded, a few per thread are kept in flight
+            Base::ThreadPool pool(threads);
+            size_t window = pool.size() * 4;
+            std::deque<std::future<Image>> pending;
+            for (size_t next = 0; next != entries.size() || !pending.empty();) {
+                while (next != entries.size() && pending.size() < window) {
+                    auto& entry = entries[next++];
+                    pending.push_back(pool.enqueue([&entry]() { return bake(*entry.first, entry.second); }));
+                }
+
+                auto image = pending.front().get();
+                pending.pop_front();
+                if (!image.error.empty()) {
+                    _logger->error() << "[BAKE] " << image.path << ": " << image.error << std::endl;
+                    failures++;
+                    continue;
+                }
+                writer.add(image.path, Graphics::Pixels(image.pixels.data(), image.size, image.format));
+                bytes += image.pixels.size();
+            }
+        }
+        bool written = writer.finish();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        report << std::fixed << std::setprecision(3);
+        report << "{\"images\": " << writer.size()
+            << ", \"failures\": " << failures
+            << ", \"bytes\": " << bytes
+            << ", \"seconds\": " << seconds
+            << ", \"written\": " << (written ? "true" : "false") << "}" << std::endl;
+        return written;
+    }
+}
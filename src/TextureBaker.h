@@ -0,0 +1,26 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include "ILogger.h"
+
+namespace Falltergeist
+{
+    /**
+     * Bakes the FRM and RIX images of the Fallout DAT files into a Graphics::TexturePack, in the formats textures
+     * are created in. The resource manager creates textures of archive files from the pack while the DAT files
+     * stay the same, FRM frames don't have to be parsed and put together then.
+     */
+    class TextureBaker
+    {
+        public:
+            TextureBaker(std::shared_ptr<ILogger> logger);
+
+            // Writes the JSON report, returns false if the pack can't be written
+            bool run(const std::string& path, unsigned int threads, std::ostream& report);
+
+        private:
+            std::shared_ptr<ILogger> _logger;
+    };
+}
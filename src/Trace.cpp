@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Trace.h"
+
+namespace Falltergeist
+{
+    namespace
+    {
+        struct Event
+        {
+            const char* name;
+            std::string detail;
+            Trace::Clock::time_point started;
+            Trace::Clock::duration duration;
+            unsigned long long frame;
+        };
+
+        // Events of one thread; the mutex is only contended while the trace is written or trimmed
+        struct ThreadEvents
+        {
+            std::mutex mutex;
+            std::deque<Event> events;
+            unsigned int id;
+        };
+
+        struct State
+        {
+            std::mutex threadsMutex;
+            std::vector<std::unique_ptr<ThreadEvents>> threads;
+            std::atomic<unsigned long long> frame{0};
+            unsigned int frames = 300;
+            Trace::Clock::time_point epoch = Trace::Clock::now();
+            Trace::Clock::time_point frameStarted = Trace::Clock::now();
+            // starts of the kept frames, shown as frame markers
+            std::deque<Trace::Clock::time_point> frameStarts;
+        };
+
+        State& state()
+        {
+            static State state;
+            return state;
+        }
+
+        ThreadEvents& threadEvents()
+        {
+            // the state owns the events, so they are still written after the thread ended
+            thread_local ThreadEvents* events = nullptr;
+            if (!events)
+            {
+                auto& current = state();
+                std::lock_guard<std::mutex> lock(current.threadsMutex);
+                current.threads.push_back(std::make_unique<ThreadEvents>());
+                events = current.threads.back().get();
+                events->id = static_cast<unsigned int>(current.threads.size());
+            }
+            return *events;
+        }
+
+        long long microseconds(Trace::Clock::duration time)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+        }
+
+        void writeString(std::ostream& stream, const char* value)
+        {
+            stream << '"';
+            for (; *value; ++value)
+            {
+                unsigned char ch = static_cast<unsigned char>(*value);
+                if (ch == '"' || ch == '\\')
+                {
+                    stream << '\\' << *value;
+                }
+                else if (ch >= 0x20)
+                {
+                    stream << *value;
+                }
+            }
+            stream << '"';
+        }
+    }
+
+    std::atomic<bool> Trace::_enabled{false};
+
+    Trace::Scope::Scope(const char* name)
+    {
+        if (Trace::enabled())
+        {
+            _name = name;
+            _started = Clock::now();
+        }
+    }
+
+    Trace::Scope::Scope(const char* name, const std::string& detail)
+    {
+        if (Trace::enabled())
+        {
+            _name = name;
+            _detail = detail;
+            _started = Clock::now();
+        }
+    }
+
+    Trace::Scope::~Scope()
+    {
+        if (!_name)
+        {
+            return;
+        }
+        auto duration = Clock::now() - _started;
+        auto& events = threadEvents();
+        std::lock_guard<std::mutex> lock(events.mutex);
+        events.events.push_back({_name, std::move(_detail), _started, duration, state().frame.load(std::memory_order_relaxed)});
+    }
+
+    void Trace::setEnabled(bool enabled, unsigned int frames)
+    {
+        state().frames = std::max(frames, 1u);
+        _enabled.store(enabled);
+    }
+
+    Trace::Clock::duration Trace::frame()
+    {
+        auto& current = state();
+        auto now = Clock::now();
+        auto duration = now - current.frameStarted;
+        current.frameStarted = now;
+        if (!enabled())
+        {
+            return duration;
+        }
+
+        auto frame = current.frame.fetch_add(1) + 1;
+        current.frameStarts.push_back(now);
+        while (current.frameStarts.size() > current.frames)
+        {
+            current.frameStarts.pop_front();
+        }
+
+        // events of frames which fell out of the window are dropped
+        if (frame >= current.frames)
+        {
+            auto oldest = frame - current.frames;
+            std::lock_guard<std::mutex> lock(current.threadsMutex);
+            for (auto& thread : current.threads)
+            {
+                std::lock_guard<std::mutex> threadLock(thread->mutex);
+                while (!thread->events.empty() && thread->events.front().frame < oldest)
+                {
+                    thread->events.pop_front();
+                }
+            }
+        }
+        return duration;
+    }
+
+    bool Trace::write(const std::string& filename)
+    {
+        std::ofstream stream(filename);
+        if (!stream)
+        {
+            return false;
+        }
+
+        auto& current = state();
+        const char* separator = "\n";
+        stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (auto& started : current.frameStarts)
+        {
+            stream << separator << "{\"name\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":" << microseconds(started - current.epoch) << "}";
+            separator = ",\n";
+        }
+
+        std::lock_guard<std::mutex> lock(current.threadsMutex);
+        for (auto& thread : current.threads)
+        {
+            std::lock_guard<std::mutex> threadLock(thread->mutex);
+            for (auto& event : thread->events)
+            {
+                stream << separator << "{\"name\":";
+                writeString(stream, event.name);
+                stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+                       << ",\"ts\":" << microseconds(event.started - current.epoch)
+                       << ",\"dur\":" << microseconds(event.duration);
+                if (!event.detail.empty())
+                {
+                    stream << ",\"args\":{\"detail\":";
+                    writeString(stream, event.detail.c_str());
+                    stream << "}";
+                }
+                stream << "}";
+                separator = ",\n";
+            }
+        }
+        stream << "\n]}\n";
+        return static_cast<bool>(stream);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace Falltergeist
+{
+    /**
+     * Trace records timed scopes of the last frames of every thread and writes them in the Chrome trace_event format,
+     * which chrome://tracing and Perfetto open. It's disabled by default and a scope costs a single check then.
+     * Scopes nest by their times, so a scope opened inside another one is shown below it.
+     */
+    class Trace final
+    {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            // Times a scope while it's alive, the name must outlive the trace (string literals)
+            class Scope final
+            {
+                public:
+                    Scope(const char* name);
+                    // detail is shown as an argument of the event, like the file being loaded
+                    Scope(const char* name, const std::string& detail);
+                    ~Scope();
+
+                    Scope(const Scope&) = delete;
+                    Scope& operator=(const Scope&) = delete;
+
+                private:
+                    const char* _name = nullptr;
+                    std::string _detail;
+                    Clock::time_point _started;
+            };
+
+            static bool enabled()
+            {
+                return _enabled.load(std::memory_order_relaxed);
+            }
+
+            // frames is how many of the last frames are kept
+            static void setEnabled(bool enabled, unsigned int frames = 300);
+
+            // Starts the next frame on the main thread, returns how long the previous one took
+            static Clock::duration frame();
+
+            // Writes the kept frames, returns false if the file cannot be written
+            static bool write(const std::string& filename);
+
+        private:
+            static std::atomic<bool> _enabled;
+    };
+}
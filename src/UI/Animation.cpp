@@ -1,5 +1,7 @@
 ﻿#include <cmath>
+#include <iterator>
 #include <memory>
+#include <unordered_map>
 #include "../Format/Frm/File.h"
 #include "../Format/Frm/Direction.h"
 #include "../Format/Frm/Frame.h"
@@ -12,6 +14,7 @@
 #include "../PathFinding/Hexagon.h"
 #include "../LocationCamera.h"
 #include "../ResourceManager.h"
+#include "../Simulation.h"
 #include "../State/Location.h"
 #include "../UI/Animation.h"
 #include "../UI/AnimationFrame.h"
@@ -22,69 +25,105 @@ namespace Falltergeist
     {
         using Graphics::Rect;
 
-        Animation::Animation() : Base(Point(0, 0))
+        namespace
         {
-        }
-
-        Animation::Animation(const std::string& frmName, unsigned int direction) : Base(Point(0, 0))
-        {
-            _direction = direction;
-            auto frm = ResourceManager::getInstance()->frmFileType(frmName);
-            if (frm == nullptr) {
-                return;
-            }
-
-            _animation = std::make_unique<Graphics::Animation>(frmName);
-            _actionFrame = frm->actionFrame();
-            auto& dir = frm->directions().at(direction);
-            _shift = Point(dir.shiftX(), dir.shiftY());
+            // Longest pause in milliseconds after which missed frames are still played
+            const unsigned int MAX_CATCH_UP = 1000;
 
-            // Frame offset in texture's animation
-            int x = 0;
-            int y = 0;
+            using FrameTable = std::vector<AnimationFrame>;
 
-            for (unsigned int d = 0; d != direction; ++d)
+            std::shared_ptr<const FrameTable> noFrames()
             {
-                y += frm->directions().at(d).height(); //? может i - 1
+                static auto frames = std::make_shared<const FrameTable>();
+                return frames;
             }
 
-            int xOffset = 1;
-            int yOffset = 1;
-            for (unsigned int f = 0; f != frm->framesPerDirection(); ++f)
+            // Animations are only created on the main thread, a table goes away with the last animation using it
+            std::shared_ptr<const FrameTable> frameTable(const std::string& frmName, unsigned int direction, Format::Frm::File* frm)
             {
-                xOffset += frm->offsetX(direction, f);
-                yOffset += frm->offsetY(direction, f);
+                static std::unordered_map<std::string, std::weak_ptr<const FrameTable>> cache;
+
+                std::string key = frmName + "#" + std::to_string(direction);
+                auto it = cache.find(key);
+                if (it != cache.end()) {
+                    if (auto frames = it->second.lock()) {
+                        return frames;
+                    }
+                }
+
+                auto frames = std::make_shared<FrameTable>();
+                frames->reserve(frm->framesPerDirection());
 
-                auto frame = std::make_unique<AnimationFrame>();
-                auto& srcFrame = frm->directions().at(direction).frames().at(f);
-                frame->setSize({ srcFrame.width(), srcFrame.height() });
-                frame->setOffset({ xOffset, yOffset });
-                frame->setPosition({ x, y });
+                // Frame offset in texture's animation
+                int x = 0;
+                int y = 0;
 
-                auto fps = frm->framesPerSecond();
-                if (fps == 0)
+                for (unsigned int d = 0; d != direction; ++d)
                 {
-                    frame->setDuration(100);
+                    y += frm->directions().at(d).height(); //? может i - 1
                 }
-                else
+
+                int xOffset = 1;
+                int yOffset = 1;
+                for (unsigned int f = 0; f != frm->framesPerDirection(); ++f)
                 {
-                    frame->setDuration((unsigned)std::round(1000.0 / static_cast<double>(frm->framesPerSecond())));
+                    xOffset += frm->offsetX(direction, f);
+                    yOffset += frm->offsetY(direction, f);
+
+                    AnimationFrame frame;
+                    auto& srcFrame = frm->directions().at(direction).frames().at(f);
+                    frame.setSize({ srcFrame.width(), srcFrame.height() });
+                    frame.setOffset({ xOffset, yOffset });
+                    frame.setPosition({ x, y });
+
+                    auto fps = frm->framesPerSecond();
+                    if (fps == 0)
+                    {
+                        frame.setDuration(100);
+                    }
+                    else
+                    {
+                        frame.setDuration((unsigned)std::round(1000.0 / static_cast<double>(frm->framesPerSecond())));
+                    }
+
+                    x += frame.size().width()+2;
+                    frames->push_back(frame);
                 }
 
-                x += frame->size().width()+2;
-                _animationFrames.push_back(std::move(frame));
+                for (auto entry = cache.begin(); entry != cache.end();) {
+                    entry = entry->second.expired() ? cache.erase(entry) : std::next(entry);
+                }
+                cache[key] = frames;
+                return frames;
             }
+        }
+
+        Animation::Animation() : Base(Point(0, 0)), _animationFrames(noFrames())
+        {
+        }
 
+        Animation::Animation(const std::string& frmName, unsigned int direction) : Base(Point(0, 0)), _animationFrames(noFrames())
+        {
+            _direction = direction;
+            auto frm = ResourceManager::getInstance()->frmFileType(frmName);
+            if (frm == nullptr) {
+                return;
+            }
 
+            _animation = std::make_unique<Graphics::Animation>(frmName);
+            _actionFrame = frm->actionFrame();
+            auto& dir = frm->directions().at(direction);
+            _shift = Point(dir.shiftX(), dir.shiftY());
+            _animationFrames = frameTable(frmName, direction, frm);
         }
 
         Animation::~Animation()
         {
         }
 
-        std::vector<std::unique_ptr<AnimationFrame>>& Animation::frames()
+        const std::vector<AnimationFrame>& Animation::frames() const
         {
-            return _animationFrames;
+            return *_animationFrames;
         }
 
         void Animation::think(const float &deltaTime)
@@ -96,20 +135,53 @@ namespace Falltergeist
                 return;
             }
 
-            // TODO: handle cases when main loop FPS is lower than animation FPS
-            if (SDL_GetTicks() - _frameTicks >= _animationFrames.at(_currentFrame)->duration()) {
-                _frameTicks = SDL_GetTicks();
+            // Frames missed since the last think (objects off the screen think less often) are caught up one after another,
+            // every one emitting its events. After a long pause the animation continues from where it was
+            // All animations read the same clock, advanced once per logic step, so they stay in step with each other.
+            unsigned int ticks = Simulation::animationTicks();
+            auto& frames = *_animationFrames;
+
+            // Fast forward shows a few frames a second, an animation which doesn't move anybody ends right away,
+            // with the action frame on the way. Critter movement reads every frame, it plays on at the logic rate
+            if (!frameHandler() && Game::Game::getInstance()->fastForwarding()) {
+                unsigned int actionProgress = _reverse ? static_cast<unsigned>(frames.size()) - _actionFrame - 1 : _actionFrame;
+                bool actionAhead = actionProgress > _progress && actionProgress < frames.size();
+                _progress = static_cast<unsigned>(frames.size());
+                _currentFrame = _reverse ? 0 : static_cast<unsigned>(frames.size()) - 1;
+                _frameTicks = ticks;
+                if (actionAhead) {
+                    emitEvent(std::make_unique<Event::Event>("actionFrame"), actionFrameHandler());
+                }
+                _ended = true;
+                _playing = false;
+                emitEvent(std::make_unique<Event::Event>("animationEnded"), animationEndedHandler());
+                return;
+            }
+
+            if (ticks - _frameTicks > MAX_CATCH_UP) {
+                _frameTicks = ticks - frames[_currentFrame].duration();
+            }
+            while (_playing) {
+                auto duration = frames[_currentFrame].duration();
+                if (ticks - _frameTicks < duration) {
+                    break;
+                }
+                _frameTicks = duration > 0 ? _frameTicks + duration : ticks;
 
                 _progress += 1;
 
-                if (_progress < _animationFrames.size())
+                if (_progress < frames.size())
                 {
-                    _currentFrame = _reverse ? static_cast<unsigned>(_animationFrames.size()) - _progress - 1 : _progress;
+                    _currentFrame = _reverse ? static_cast<unsigned>(frames.size()) - _progress - 1 : _progress;
                     emitEvent(std::make_unique<Event::Event>("frame"), frameHandler());
                     if (_actionFrame == _currentFrame)
                     {
                         emitEvent(std::make_unique<Event::Event>("actionFrame"), actionFrameHandler());
                     }
+                    // frame handlers (critter movement) read the current frame when events are processed
+                    if (frameHandler()) {
+                        break;
+                    }
                 }
                 else
                 {
@@ -125,8 +197,8 @@ namespace Falltergeist
             if (!_animation) {
                 return;
             }
-            auto& frame = _animationFrames.at(_currentFrame);
-            Point offsetPosition = position() + offset() + shift() + frame->offset();
+            auto& frame = _animationFrames->at(_currentFrame);
+            Point offsetPosition = position() + offset() + shift() + frame.offset();
             _animation->trans(_trans);
             _animation->render(offsetPosition.x(), offsetPosition.y(), _direction, _currentFrame, eggTransparency, light(),
                                _outline, _lightLevel);
@@ -137,7 +209,7 @@ namespace Falltergeist
             if (!_animation) {
                 return _zeroSize;
             }
-            return _animationFrames.at(_currentFrame)->size();
+            return _animationFrames->at(_currentFrame).size();
         }
 
         const Point& Animation::shift() const
@@ -155,7 +227,7 @@ namespace Falltergeist
             if (!_playing) {
                 _playing = true;
                 _ended = false;
-                _frameTicks = SDL_GetTicks();
+                _frameTicks = Simulation::animationTicks();
             }
         }
 
@@ -170,7 +242,7 @@ namespace Falltergeist
         void Animation::setReverse(bool value)
         {
             _reverse = value;
-            setCurrentFrame(value ? static_cast<unsigned>(_animationFrames.size()) - 1 : 0);
+            setCurrentFrame(value ? static_cast<unsigned>(_animationFrames->size()) - 1 : 0);
         }
 
         bool Animation::ended() const
@@ -191,12 +263,12 @@ namespace Falltergeist
         void Animation::setCurrentFrame(unsigned int value)
         {
             _currentFrame = value;
-            _progress = _reverse ? static_cast<unsigned>(_animationFrames.size()) - _currentFrame - 1 : _currentFrame;
+            _progress = _reverse ? static_cast<unsigned>(_animationFrames->size()) - _currentFrame - 1 : _currentFrame;
         }
 
-        AnimationFrame* Animation::currentFramePtr() const
+        const AnimationFrame* Animation::currentFramePtr() const
         {
-            return _animationFrames.at(_currentFrame).get();
+            return &_animationFrames->at(_currentFrame);
         }
 
         Point Animation::frameOffset() const
@@ -214,9 +286,9 @@ namespace Falltergeist
             _actionFrame = value;
         }
 
-        AnimationFrame* Animation::actionFramePtr() const
+        const AnimationFrame* Animation::actionFramePtr() const
         {
-            return _animationFrames.at(_actionFrame).get();
+            return &_animationFrames->at(_actionFrame);
         }
 
         Event::Handler& Animation::frameHandler()
@@ -238,13 +310,13 @@ namespace Falltergeist
             if (!_animation) {
                 return true;
             }
-            const auto& frame = _animationFrames.at(_currentFrame);
+            const auto& frame = _animationFrames->at(_currentFrame);
 
             Point offsetPos = pos - offset();
-            if (!Rect::inRect(offsetPos, frame->size())) {
+            if (!Rect::inRect(offsetPos, frame.size())) {
                 return false;
             }
-            offsetPos +=frame->position();
+            offsetPos +=frame.position();
             return _animation->opaque(offsetPos.x(),offsetPos.y());
         }
     }
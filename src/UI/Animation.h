@@ -20,7 +20,7 @@ namespace Falltergeist
 
                 ~Animation() override;
 
-                std::vector<std::unique_ptr<AnimationFrame>>& frames();
+                const std::vector<AnimationFrame>& frames() const;
 
                 void think(const float &deltaTime) override;
 
@@ -47,7 +47,7 @@ namespace Falltergeist
 
                 void setCurrentFrame(unsigned int value);
 
-                AnimationFrame* currentFramePtr() const;
+                const AnimationFrame* currentFramePtr() const;
 
                 /**
                  * Offset of the current frame.
@@ -58,7 +58,7 @@ namespace Falltergeist
 
                 void setActionFrame(unsigned int value);
 
-                AnimationFrame* actionFramePtr() const;
+                const AnimationFrame* actionFramePtr() const;
 
                 bool ended() const;
 
@@ -86,7 +86,8 @@ namespace Falltergeist
 
                 bool _reverse = false;
 
-                std::vector<std::unique_ptr<AnimationFrame>> _animationFrames;
+                // Frames of the direction, shared by all animations of the same FRM and direction
+                std::shared_ptr<const std::vector<AnimationFrame>> _animationFrames;
 
                 Point _shift;
 
@@ -14,6 +14,8 @@ namespace Falltergeist {
     namespace UI {
         using namespace Base;
 
+        unsigned int Base::_layoutGeneration = 0;
+
         Base::Base(const Point& pos) : Event::EventTarget(Game::Game::getInstance()->eventDispatcher()), _position(pos), _size(Size(0, 0)) {
         }
 
@@ -47,7 +49,10 @@ namespace Falltergeist {
         }
 
         void Base::setPosition(const Point& pos) {
-            _position = pos;
+            if (_position != pos) {
+                _position = pos;
+                _layoutChanged();
+            }
         }
 
         const Point& Base::offset() const {
@@ -66,6 +71,22 @@ namespace Falltergeist {
             return false;
         }
 
+        bool Base::hitSize(Size& size) const {
+            return false;
+        }
+
+        bool Base::mouseEngaged() const {
+            return _hovered || _leftButtonPressed || _rightButtonPressed || _drag;
+        }
+
+        unsigned int Base::layoutGeneration() {
+            return _layoutGeneration;
+        }
+
+        void Base::_layoutChanged() {
+            ++_layoutGeneration;
+        }
+
         void Base::handle(Event::Event* event) {
             if (event->isHandled()) {
                 return;
@@ -42,6 +42,18 @@ namespace Falltergeist
 
                 virtual bool opaque(const Point &pos);
 
+                /**
+                 * Size of the area starting at position() outside of which opaque() is always false, so states can
+                 * skip the element for mouse events elsewhere. Returns false if the element can't tell.
+                 */
+                virtual bool hitSize(Size& size) const;
+
+                // Hovered, pressed or dragged elements need mouse events wherever the cursor is
+                bool mouseEngaged() const;
+
+                // Changes whenever any element is moved or its hit area changes
+                static unsigned int layoutGeneration();
+
                 virtual bool visible() const;
 
                 virtual void setVisible(bool value);
@@ -111,6 +123,8 @@ namespace Falltergeist
                 void setOutline(int outline);
 
             protected:
+                static void _layoutChanged();
+
                 Point _position;
 
                 Point _offset;
@@ -156,6 +170,8 @@ namespace Falltergeist
                 unsigned int _lightLevel;
 
             private:
+                static unsigned int _layoutGeneration;
+
                 Size _size;
         };
     }
@@ -62,5 +62,11 @@ namespace Falltergeist
         {
             return false;
         }
+
+        bool BigCounter::hitSize(Size& size) const
+        {
+            size = Size(0, 0);
+            return true;
+        }
     }
 }
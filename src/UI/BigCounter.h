@@ -38,6 +38,7 @@ namespace Falltergeist
                 void render(bool eggTransparency) override;
 
                 bool opaque(const Point &pos) override;
+                bool hitSize(Size& size) const override;
 
             private:
                 Color _color = Color::WHITE;
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include "../Game/Object.h"
+#include "../Simulation.h"
+#include "../UI/FloatMessagePool.h"
+#include "../UI/TextArea.h"
+
+namespace Falltergeist
+{
+    namespace UI
+    {
+        const unsigned int FloatMessagePool::DURATION = 7000;
+
+        FloatMessagePool::FloatMessagePool()
+        {
+        }
+
+        FloatMessagePool::~FloatMessagePool()
+        {
+            for (auto slot : _shown)
+            {
+                _slots[slot].owner->_floatMessagePool = nullptr;
+            }
+        }
+
+        void FloatMessagePool::show(Game::Object* owner, const std::string& text, SDL_Color color)
+        {
+            if (owner->_floatMessagePool && owner->_floatMessagePool != this)
+            {
+                owner->_floatMessagePool->remove(owner);
+            }
+
+            unsigned int slot;
+            if (owner->_floatMessagePool == this)
+            {
+                // the replaced message starts over and expires last
+                slot = owner->_floatMessageSlot;
+                _shown.erase(std::find(_shown.begin(), _shown.end(), slot));
+            }
+            else if (!_free.empty())
+            {
+                slot = _free.back();
+                _free.pop_back();
+            }
+            else
+            {
+                slot = static_cast<unsigned int>(_slots.size());
+                auto textArea = std::make_unique<TextArea>(Graphics::Point());
+                textArea->setWidth(200);
+                textArea->setWordWrap(true);
+                textArea->setHorizontalAlign(TextArea::HorizontalAlign::CENTER);
+                textArea->setOutlineColor({0x00, 0x00, 0x00, 0xFF});
+                textArea->setFont("font1.aaf", color);
+                _slots.push_back({std::move(textArea), nullptr, 0});
+            }
+
+            auto& entry = _slots[slot];
+            entry.owner = owner;
+            entry.expires = Simulation::ticks() + DURATION;
+            entry.text->setColor(color);
+            entry.text->setText(text);
+            _shown.push_back(slot);
+            owner->_floatMessagePool = this;
+            owner->_floatMessageSlot = slot;
+        }
+
+        void FloatMessagePool::remove(Game::Object* owner)
+        {
+            if (owner->_floatMessagePool != this)
+            {
+                return;
+            }
+            _shown.erase(std::find(_shown.begin(), _shown.end(), owner->_floatMessageSlot));
+            _release(owner->_floatMessageSlot);
+        }
+
+        void FloatMessagePool::think(unsigned int ticks)
+        {
+            auto expired = _shown.begin();
+            while (expired != _shown.end() && _slots[*expired].expires <= ticks)
+            {
+                _release(*expired);
+                ++expired;
+            }
+            _shown.erase(_shown.begin(), expired);
+        }
+
+        void FloatMessagePool::render(Game::Object* owner)
+        {
+            if (owner->_floatMessagePool != this || !owner->ui())
+            {
+                return;
+            }
+            auto ui = owner->ui();
+            auto& text = _slots[owner->_floatMessageSlot].text;
+            text->setPosition(ui->position() + Graphics::Point(
+                    ui->size().width() / 2 - text->size().width() / 2,
+                    -4 - text->textSize().height()
+            ));
+            text->render();
+        }
+
+        size_t FloatMessagePool::size() const
+        {
+            return _slots.size();
+        }
+
+        void FloatMessagePool::_release(unsigned int slot)
+        {
+            auto& entry = _slots[slot];
+            entry.owner->_floatMessagePool = nullptr;
+            entry.owner = nullptr;
+            _free.push_back(slot);
+        }
+    }
+}
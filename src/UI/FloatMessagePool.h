@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <SDL.h>
+
+namespace Falltergeist
+{
+    namespace Game
+    {
+        class Object;
+    }
+    namespace UI
+    {
+        class TextArea;
+
+        /**
+         * Float messages of the objects of a location: barks, damage and float_msg texts. Text areas live in slots
+         * reused from a free list, so a fight full of floaters lays out new text but allocates nothing, and their
+         * glyphs go through the sprite batch like any other text. Timers of all messages are checked by think()
+         * once a frame, objects only know their slot
+         */
+        class FloatMessagePool final
+        {
+            public:
+                // milliseconds a message is shown
+                static const unsigned int DURATION;
+
+                FloatMessagePool();
+
+                // Objects still showing a message forget their slot, they may outlive the location state
+                ~FloatMessagePool();
+
+                FloatMessagePool(const FloatMessagePool&) = delete;
+
+                FloatMessagePool& operator=(const FloatMessagePool&) = delete;
+
+                // Replaces the message of the object, it is shown for DURATION from now
+                void show(Game::Object* owner, const std::string& text, SDL_Color color);
+
+                // Frees the slot of the object, called when it is destroyed
+                void remove(Game::Object* owner);
+
+                // Frees the slots of the messages shown long enough
+                void think(unsigned int ticks);
+
+                // Draws the message of the object above its UI
+                void render(Game::Object* owner);
+
+                // Slots allocated so far, the most messages shown at once
+                size_t size() const;
+
+            private:
+                struct Slot
+                {
+                    std::unique_ptr<TextArea> text;
+                    Game::Object* owner = nullptr;
+                    unsigned int expires = 0;
+                };
+
+                std::vector<Slot> _slots;
+
+                std::vector<unsigned int> _free;
+
+                // slots in the order their messages were shown, every message lasts as long, so they expire in order
+                std::vector<unsigned int> _shown;
+
+                void _release(unsigned int slot);
+        };
+    }
+}
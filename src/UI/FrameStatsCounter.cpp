@@ -0,0 +1,29 @@
+#include <cstdio>
+#include "../FrameStats.h"
+#include "../UI/FrameStatsCounter.h"
+
+namespace Falltergeist
+{
+    namespace UI
+    {
+        FrameStatsCounter::FrameStatsCounter(const Point& pos) : TextArea(pos)
+        {
+            setWidth(150);
+            setHorizontalAlign(TextArea::HorizontalAlign::RIGHT);
+        }
+
+        void FrameStatsCounter::think(const float &deltaTime)
+        {
+            _millisecondsTracked += deltaTime;
+            if (_millisecondsTracked < 1000.0f) {
+                return;
+            }
+            _millisecondsTracked = 0;
+
+            char buffer[96];
+            std::snprintf(buffer, sizeof(buffer), "%.1f / %.1f / %.1f ms\n%u hitches",
+                FrameStats::percentile(0.5f), FrameStats::percentile(0.95f), FrameStats::percentile(0.99f), FrameStats::hitches());
+            setText(buffer);
+        }
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../UI/TextArea.h"
+
+namespace Falltergeist
+{
+    namespace UI
+    {
+        /**
+         * Shows the p50, p95 and p99 frame times of the rolling window and the number of hitches, refreshed once a second.
+         */
+        class FrameStatsCounter final : public TextArea
+        {
+            public:
+                FrameStatsCounter(const Point& pos);
+
+                virtual ~FrameStatsCounter() = default;
+
+                void think(const float &deltaTime) override;
+
+            private:
+                float _millisecondsTracked = 1000.0f;
+        };
+    }
+}
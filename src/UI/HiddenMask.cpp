@@ -25,5 +25,11 @@ namespace Falltergeist
         {
             return Graphics::Rect::inRect(pos, this->size());
         }
+
+        bool HiddenMask::hitSize(Size& size) const
+        {
+            size = this->size();
+            return true;
+        }
     }
 }
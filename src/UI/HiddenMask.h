@@ -20,6 +20,7 @@ namespace Falltergeist
                 void render(bool eggTransparency = false) override;
 
                 virtual bool opaque(const Point &pos) override;
+                bool hitSize(Size& size) const override;
 
                 void think(const float &deltaTime) override;
         };
@@ -0,0 +1,93 @@
+#include "../UI/HitGrid.h"
+#include "../UI/Base.h"
+#include <algorithm>
+
+namespace Falltergeist {
+    namespace UI {
+        void HitGrid::build(const std::vector<std::unique_ptr<Base>>& elements) {
+            _bounds.assign(elements.size(), Bounds());
+            _cells.clear();
+            _everywhere.clear();
+            _columns = 0;
+            _rows = 0;
+
+            std::vector<size_t> bounded;
+            Point min, max;
+            for (size_t i = 0; i != elements.size(); ++i) {
+                Size size;
+                if (!elements[i]->hitSize(size)) {
+                    _everywhere.push_back(i);
+                    continue;
+                }
+                // such elements are never hit, nor hovered or pressed
+                if (size.width() <= 0 || size.height() <= 0) {
+                    continue;
+                }
+
+                // opaque() is given positions relative to position(), the offset is the element's own business
+                auto& bounds = _bounds[i];
+                bounds.topLeft = elements[i]->position();
+                bounds.bottomRight = bounds.topLeft + size;
+                if (bounded.empty()) {
+                    min = bounds.topLeft;
+                    max = bounds.bottomRight;
+                } else {
+                    min = Point(std::min(min.x(), bounds.topLeft.x()), std::min(min.y(), bounds.topLeft.y()));
+                    max = Point(std::max(max.x(), bounds.bottomRight.x()), std::max(max.y(), bounds.bottomRight.y()));
+                }
+                bounded.push_back(i);
+            }
+
+            if (bounded.empty()) {
+                return;
+            }
+
+            _origin = min;
+            _cellSize = CELL_SIZE;
+            while (true) {
+                _columns = (max.x() - min.x() - 1) / _cellSize + 1;
+                _rows = (max.y() - min.y() - 1) / _cellSize + 1;
+                if (_columns * _rows <= MAX_CELLS) {
+                    break;
+                }
+                _cellSize *= 2;
+            }
+
+            _cells.resize(static_cast<size_t>(_columns * _rows));
+            for (auto i : bounded) {
+                const auto& bounds = _bounds[i];
+                int left = (bounds.topLeft.x() - _origin.x()) / _cellSize;
+                int top = (bounds.topLeft.y() - _origin.y()) / _cellSize;
+                int right = (bounds.bottomRight.x() - 1 - _origin.x()) / _cellSize;
+                int bottom = (bounds.bottomRight.y() - 1 - _origin.y()) / _cellSize;
+                for (int y = top; y <= bottom; ++y) {
+                    for (int x = left; x <= right; ++x) {
+                        _cells[static_cast<size_t>(y * _columns + x)].push_back(i);
+                    }
+                }
+            }
+        }
+
+        void HitGrid::candidates(const Point& point, std::vector<size_t>& indexes) const {
+            indexes.clear();
+
+            if (_columns && point.x() >= _origin.x() && point.y() >= _origin.y()) {
+                int x = (point.x() - _origin.x()) / _cellSize;
+                int y = (point.y() - _origin.y()) / _cellSize;
+                if (x < _columns && y < _rows) {
+                    for (auto i : _cells[static_cast<size_t>(y * _columns + x)]) {
+                        const auto& bounds = _bounds[i];
+                        if (point.x() < bounds.bottomRight.x() && point.y() < bounds.bottomRight.y()
+                            && point.x() >= bounds.topLeft.x() && point.y() >= bounds.topLeft.y()) {
+                            indexes.push_back(i);
+                        }
+                    }
+                }
+            }
+
+            auto bounded = indexes.size();
+            indexes.insert(indexes.end(), _everywhere.begin(), _everywhere.end());
+            std::inplace_merge(indexes.begin(), indexes.begin() + bounded, indexes.end());
+        }
+    }
+}
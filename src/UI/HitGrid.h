@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "../Graphics/Point.h"
+
+namespace Falltergeist
+{
+    namespace UI
+    {
+        class Base;
+
+        /**
+         * Uniform grid over the hit areas of the elements of a state, so a mouse event is offered
+         * only to the elements under the cursor. Elements which can't tell their hit area are candidates everywhere.
+         */
+        class HitGrid final
+        {
+            public:
+                // cells start at this edge and grow while the grid would be larger than MAX_CELLS
+                static const int CELL_SIZE = 64;
+                static const int MAX_CELLS = 1024;
+
+                void build(const std::vector<std::unique_ptr<Base>>& elements);
+
+                // Replaces indexes with the indexes of the candidates at the point, ascending like the elements
+                void candidates(const Graphics::Point& point, std::vector<size_t>& indexes) const;
+
+            private:
+                struct Bounds
+                {
+                    Graphics::Point topLeft;
+                    Graphics::Point bottomRight;
+                };
+
+                Graphics::Point _origin;
+                int _cellSize = CELL_SIZE;
+                int _columns = 0;
+                int _rows = 0;
+                std::vector<Bounds> _bounds;
+                std::vector<std::vector<size_t>> _cells;
+                std::vector<size_t> _everywhere;
+        };
+    }
+}
@@ -27,6 +27,12 @@ namespace Falltergeist
             return _sprite->opaque(position);
         }
 
+        bool Image::hitSize(Size& size) const
+        {
+            size = _sprite->size();
+            return true;
+        }
+
         void Image::render(const Size& size, bool eggTransparency)
         {
             _sprite->renderScaled(position() + offset(), size, eggTransparency, light(), _outline);
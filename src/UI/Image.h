@@ -24,6 +24,7 @@ namespace Falltergeist
                 virtual void render(const Size &size, bool eggTransparency = false) override;
 
                 virtual bool opaque(const Point &position) override;
+                bool hitSize(Size& size) const override;
 
                 const Size& size() const override;
 
@@ -5,6 +5,7 @@
 #include "../Exception.h"
 #include "../Game/Game.h"
 #include "../ResourceManager.h"
+#include <algorithm>
 
 namespace Falltergeist {
     namespace UI {
@@ -83,5 +84,12 @@ namespace Falltergeist {
 
             return _buttonUpSprite->opaque(pos);
         }
+
+        bool ImageButton::hitSize(Size& size) const {
+            // the pressed sprite may be larger than the released one
+            size = Size(std::max(_buttonUpSprite->size().width(), _buttonDownSprite->size().width()),
+                        std::max(_buttonUpSprite->size().height(), _buttonDownSprite->size().height()));
+            return true;
+        }
     }
 }
@@ -30,6 +30,7 @@ namespace Falltergeist {
             virtual void render(bool eggTransparency = false) override;
 
             virtual bool opaque(const Point& pos) override;
+            bool hitSize(Size& size) const override;
 
         protected:
             bool _checkboxMode = false; // remember new state after click
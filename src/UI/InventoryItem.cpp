@@ -1,3 +1,4 @@
+#include <functional>
 #include <memory>
 #include "../Audio/Mixer.h"
 #include "../Event/Event.h"
@@ -39,7 +40,10 @@ namespace Falltergeist
 
         void InventoryItem::setType(Type value)
         {
-            _type = value;
+            if (_type != value) {
+                _type = value;
+                _layoutChanged();
+            }
         }
 
         void InventoryItem::render(bool eggTransparency)
@@ -216,5 +220,11 @@ namespace Falltergeist
             }
             return Rect::inRect(pos, this->size());
         }
+
+        bool InventoryItem::hitSize(Size& size) const
+        {
+            size = this->size();
+            return true;
+        }
     }
 }
@@ -44,6 +44,7 @@ namespace Falltergeist
                 const Size& size() const override;
 
                 virtual bool opaque(const Point &pos) override;
+                bool hitSize(Size& size) const override;
 
                 void onMouseLeftDown(Event::Mouse* event);
 
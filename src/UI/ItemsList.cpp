@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include "../Audio/Mixer.h"
 #include "../Event/Event.h"
@@ -26,23 +28,39 @@ namespace Falltergeist
             mouseDragStopHandler().add( std::bind(&ItemsList::onMouseDragStop, this, std::placeholders::_1));
         }
 
-        void ItemsList::setItems(std::vector<Game::ItemObject*>* items)
+        void ItemsList::setItems(Game::Inventory* items)
         {
             _items = items;
             update();
         }
 
-        std::vector<Game::ItemObject*>* ItemsList::items()
+        Game::Inventory* ItemsList::items()
         {
             return _items;
         }
 
         void ItemsList::update()
         {
-            _inventoryItems.clear();
+            // only the visible slots have UI, and those are reused as the list scrolls or changes
+            size_t visible = 0;
+            if (_slotOffset < items()->size()) {
+                visible = std::min<size_t>(items()->size() - _slotOffset, _slotsNumber);
+            }
+            if (_inventoryItems.size() > visible) {
+                if (std::any_of(_inventoryItems.begin() + visible, _inventoryItems.end(),
+                        [this](const std::unique_ptr<InventoryItem>& item) { return item.get() == _draggedItem; })) {
+                    _draggedItem = nullptr;
+                }
+                _inventoryItems.resize(visible);
+            }
 
-            for (unsigned int i = _slotOffset; i < items()->size() && i != _slotOffset + _slotsNumber; i++) {
-                _inventoryItems.push_back(std::unique_ptr<InventoryItem>(new InventoryItem(items()->at(i))));
+            for (size_t i = 0; i != visible; ++i) {
+                auto item = items()->at(_slotOffset + i);
+                if (i < _inventoryItems.size()) {
+                    _inventoryItems[i]->setItem(item);
+                } else {
+                    _inventoryItems.push_back(std::unique_ptr<InventoryItem>(new InventoryItem(item)));
+                }
             }
         }
 
@@ -51,7 +69,8 @@ namespace Falltergeist
             unsigned int i = 0;
             for (auto& item : _inventoryItems) {
                 Point pos = position() + Point(0, _slotHeight*i);
-                if (item.get() == _draggedItem) {
+                // rows are reused, so the dragged one is only left out of the list while it's still being dragged
+                if (item.get() == _draggedItem && item->type() == InventoryItem::Type::DRAG) {
                     item->render();
                     continue;
                 }
@@ -12,6 +12,7 @@ namespace Falltergeist
     }
     namespace Game
     {
+        class Inventory;
         class ItemObject;
     }
     namespace UI
@@ -21,9 +22,9 @@ namespace Falltergeist
             public:
                 ItemsList(const Point& pos);
 
-                void setItems(std::vector<Game::ItemObject*>* items);
+                void setItems(Game::Inventory* items);
 
-                std::vector<Game::ItemObject*>* items();
+                Game::Inventory* items();
 
                 std::vector<std::unique_ptr<InventoryItem>>& inventoryItems();
 
@@ -73,7 +74,7 @@ namespace Falltergeist
                 virtual bool opaque(const Point &pos) override;
 
             private:
-                std::vector<Game::ItemObject*>* _items = nullptr;
+                Game::Inventory* _items = nullptr;
 
                 InventoryItem* _draggedItem = nullptr;
 
@@ -0,0 +1,40 @@
+#include <algorithm>
+#include <cstdio>
+#include "../MemoryStats.h"
+#include "../UI/MemoryStatsCounter.h"
+
+namespace Falltergeist
+{
+    namespace UI
+    {
+        namespace
+        {
+            // cache types below the categories, the rest is in the dumps
+            const size_t CACHE_TYPES_SHOWN = 5;
+        }
+
+        MemoryStatsCounter::MemoryStatsCounter(const Point& pos) : TextArea(pos)
+        {
+            setWidth(200);
+        }
+
+        void MemoryStatsCounter::think(const float &deltaTime)
+        {
+            _millisecondsTracked += deltaTime;
+            if (_millisecondsTracked < 1000.0f) {
+                return;
+            }
+            _millisecondsTracked = 0;
+
+            auto usage = MemoryStats::usage();
+            size_t shown = std::min(usage.size(), static_cast<size_t>(MemoryStats::CATEGORIES) + CACHE_TYPES_SHOWN);
+            std::string text;
+            for (size_t i = 0; i != shown; ++i) {
+                char buffer[64];
+                std::snprintf(buffer, sizeof(buffer), "%s %.1fM %zu", usage[i].name.c_str(), usage[i].bytes / (1024.0 * 1024.0), usage[i].count);
+                text += (i ? "\n" : "") + std::string(buffer);
+            }
+            setText(text);
+        }
+    }
+}
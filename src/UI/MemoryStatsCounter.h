@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../UI/TextArea.h"
+
+namespace Falltergeist
+{
+    namespace UI
+    {
+        /**
+         * Shows the memory of the tracked categories and the largest resource cache types, refreshed once a second.
+         */
+        class MemoryStatsCounter final : public TextArea
+        {
+            public:
+                MemoryStatsCounter(const Point& pos);
+
+                virtual ~MemoryStatsCounter() = default;
+
+                void think(const float &deltaTime) override;
+
+            private:
+                float _millisecondsTracked = 1000.0f;
+        };
+    }
+}
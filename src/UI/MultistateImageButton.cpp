@@ -164,6 +164,13 @@ namespace Falltergeist
             return _sprite->opaque(_rects.at(_currentState).position() + pos);
         }
 
+        bool MultistateImageButton::hitSize(Size& size) const
+        {
+            // opaque() accepts the right and bottom edges as well
+            size = Size(_size.width() + 1, _size.height() + 1);
+            return true;
+        }
+
         const Size& MultistateImageButton::size() const
         {
             return _size;
@@ -57,6 +57,7 @@ namespace Falltergeist
                 void handle(Event::Mouse* mouseEvent) override;
 
                 bool opaque(const Point &pos) override;
+                bool hitSize(Size& size) const override;
 
                 void render(bool eggTransparency) override;
 
@@ -1,8 +1,14 @@
-﻿#include <bitset>
+﻿#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cstring>
 #include "../Exception.h"
 #include "../Format/Mve/Chunk.h"
 #include "../Format/Mve/File.h"
 #include "../Game/Game.h"
+#include "../Graphics/PaletteExpansion.h"
+#include "../Logger.h"
+#include "../ResourceManager.h"
 #include "../UI/MvePlayer.h"
 
 namespace Falltergeist
@@ -38,6 +44,71 @@ namespace Falltergeist
             }
         }
 
+        // Block patterns are expanded a whole 8 pixel row at a time: byte i of a row word is pixel i,
+        // so everything below is independent of the byte order as long as rows are moved with memcpy
+
+        // Byte i is 0xFF when bit i of the mask is set
+        static const std::array<uint64_t, 256>& rowMasks()
+        {
+            static const std::array<uint64_t, 256> masks = []() {
+                std::array<uint64_t, 256> result;
+                for (uint32_t mask = 0; mask < 256; mask++) {
+                    uint8_t bytes[8];
+                    for (uint32_t i = 0; i < 8; i++) {
+                        bytes[i] = (mask >> i) & 1 ? 0xFF : 0x00;
+                    }
+                    std::memcpy(&result[mask], bytes, sizeof(bytes));
+                }
+                return result;
+            }();
+            return masks;
+        }
+
+        static inline uint64_t splat(uint8_t color)
+        {
+            return color * 0x0101010101010101ULL;
+        }
+
+        // c2 where the mask bit of the pixel is set, c1 elsewhere
+        static inline uint64_t select(uint8_t c1, uint8_t c2, uint8_t mask)
+        {
+            uint64_t bytes = rowMasks()[mask];
+            return (splat(c1) & ~bytes) | (splat(c2) & bytes);
+        }
+
+        // 2 bits per pixel, the low bit picks within a pair and the high bit between c1/c2 and c3/c4
+        static inline uint64_t select(uint8_t c1, uint8_t c2, uint8_t c3, uint8_t c4, uint8_t low, uint8_t high)
+        {
+            uint64_t lowBytes = rowMasks()[low];
+            uint64_t highBytes = rowMasks()[high];
+            uint64_t first = (splat(c1) & ~lowBytes) | (splat(c2) & lowBytes);
+            uint64_t second = (splat(c3) & ~lowBytes) | (splat(c4) & lowBytes);
+            return (first & ~highBytes) | (second & highBytes);
+        }
+
+        // Bits 0, 2, 4 and 6 packed into the low nibble
+        static inline uint8_t evenBits(uint8_t mask)
+        {
+            return (mask & 1) | ((mask >> 1) & 2) | ((mask >> 2) & 4) | ((mask >> 3) & 8);
+        }
+
+        static inline uint8_t oddBits(uint8_t mask)
+        {
+            return evenBits(mask >> 1);
+        }
+
+        // Every bit of the low nibble repeated, for patterns of 2 pixel wide cells
+        static inline uint8_t doubledBits(uint8_t mask)
+        {
+            uint8_t result = 0;
+            for (uint32_t i = 0; i < 4; i++) {
+                if ((mask >> i) & 1) {
+                    result |= 3 << (i * 2);
+                }
+            }
+            return result;
+        }
+
         int16_t get_short(uint8_t *data)
         {
             return data[0] | (data[1] << 8);
@@ -48,20 +119,49 @@ namespace Falltergeist
             return data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
         }
 
-        MvePlayer::MvePlayer(Format::Mve::File* mve) : Base(Point(0, 0)) {
+        // Audio decoded ahead of the video, on top of two mixer buffers
+        static constexpr uint32_t AUDIO_LEAD_MS = 500;
+
+        // Bound for movies without audio, their chunks are read ahead as well
+        static constexpr size_t MAX_READ_AHEAD = 32;
+
+        // Ticks decoded ahead of the presented one, about a quarter of a second
+        static constexpr size_t FRAME_QUEUE = 4;
+
+        static constexpr uint32_t AUDIO_CHANNELS = 2;
+
+        MvePlayer::MvePlayer(Format::Mve::File* mve, bool present) : Base(Point(0, 0)), _presenting(present), _audio(22050 * AUDIO_CHANNELS * 2) {
             _movie = new Graphics::Movie();
-            _mve = mve;
+            _mve = ResourceManager::getInstance()->pin(mve);
             _mve->setPosition(26);
-            _chunk = _mve->getNextChunk();
-            while(!_finished && !_timerStarted ) {
-                _processChunk();
+            // the first frame is shown right away, the rest is decoded ahead by the decoder thread
+            while(!_decoded && !_timerStarted ) {
+                if (_processChunk()) {
+                    _frame = _pending.number;
+                    if (!_pending.rgba.empty()) {
+                        _present(_pending);
+                    }
+                } else {
+                    _decoded = true;
+                }
+            }
+            if (!_decoded && _presenting) {
+                _decoder = std::thread(&MvePlayer::_decoderLoop, this);
             }
         }
 
         MvePlayer::~MvePlayer()
         {
+            {
+                std::lock_guard<std::mutex> lock(_framesMutex);
+                _decoderStopping = true;
+            }
+            _framesChanged.notify_all();
+            if (_decoder.joinable()) {
+                _decoder.join();
+            }
+
             delete [] _decodingMap;
-            delete [] _audioBuf;
             delete _movie;
 
             SDL_FreeSurface(_currentBuf);
@@ -108,124 +208,91 @@ namespace Falltergeist
         }
 
 
-        void MvePlayer::_drawRow(uint32_t x, uint32_t y, uint8_t c1, uint8_t c2, uint8_t mask)
+        void MvePlayer::_storeRow(uint32_t x, uint32_t y, uint64_t row, uint32_t width)
         {
-            std::bitset<8> bitmask(mask);
-            SDL_Rect dstrect;
-            for (uint32_t dx = 0; dx < 8; dx++) {
-                dstrect.w = 1;
-                dstrect.h = 1;
-                dstrect.x = x + dx;
-                dstrect.y = y;
-                SDL_FillRect(_currentBuf, &dstrect, (bitmask.test(dx) ? c2 : c1));
+            std::memcpy((uint8_t*)_currentBuf->pixels + y * _currentBuf->pitch + x, &row, width);
+        }
+
+        void MvePlayer::_copyBlock(SDL_Surface* from, SDL_Rect* srcrect, SDL_Rect* dstrect)
+        {
+            // clipped motion vectors are rare, SDL adjusts both rectangles for them
+            if (srcrect->x < 0 || srcrect->y < 0 || srcrect->x + 8 > from->w || srcrect->y + 8 > from->h) {
+                SDL_BlitSurface(from, srcrect, _currentBuf, dstrect);
+                return;
+            }
+
+            uint8_t* src = (uint8_t*)from->pixels + srcrect->y * from->pitch + srcrect->x;
+            uint8_t* dst = (uint8_t*)_currentBuf->pixels + dstrect->y * _currentBuf->pitch + dstrect->x;
+            int pitch = _currentBuf->pitch;
+            // copies within the current frame may overlap, rows go in the same order as in SDL_BlitSurface
+            if (dst > src) {
+                for (int row = 7; row >= 0; row--) {
+                    std::memmove(dst + row * pitch, src + row * from->pitch, 8);
+                }
+            } else {
+                for (int row = 0; row < 8; row++) {
+                    std::memmove(dst + row * pitch, src + row * from->pitch, 8);
+                }
             }
         }
 
+        void MvePlayer::_drawRow(uint32_t x, uint32_t y, uint8_t c1, uint8_t c2, uint8_t mask)
+        {
+            _storeRow(x, y, select(c1, c2, mask));
+        }
+
         void MvePlayer::_drawRow2x2(uint32_t x, uint32_t y, uint8_t c1, uint8_t c2, uint8_t mask)
         {
-            std::bitset<8> bitmask(mask);
-            SDL_Rect dstrect;
-            for (uint32_t di = 0; di < 8; di++) {
-                dstrect.w = 2;
-                dstrect.h = 2;
-                dstrect.x = x + (di % 4) * 2;
-                dstrect.y = y + (di / 4) * 2;
-                SDL_FillRect(_currentBuf, &dstrect, (bitmask.test(di) ? c2 : c1));
-            }
+            uint64_t top = select(c1, c2, doubledBits(mask & 0x0F));
+            uint64_t bottom = select(c1, c2, doubledBits(mask >> 4));
+            _storeRow(x, y, top);
+            _storeRow(x, y + 1, top);
+            _storeRow(x, y + 2, bottom);
+            _storeRow(x, y + 3, bottom);
         }
 
         void MvePlayer::_drawRow4colors(uint32_t x, uint32_t y, uint8_t c1, uint8_t c2, uint8_t c3, uint8_t c4, uint8_t mask1,uint8_t mask2)
         {
-            std::bitset<8> bitmasks[2] = {mask1, mask2};
-            SDL_Rect dstrect;
-            for (uint32_t dx = 0;dx < 8; dx++) {
-                dstrect.w = 1;
-                dstrect.h = 1;
-                dstrect.x = x + dx;
-                dstrect.y = y;
-                SDL_FillRect(_currentBuf,&dstrect, (bitmasks[dx/4].test((dx%4)*2+1) ? (bitmasks[dx/4].test((dx%4)*2) ? c4 : c3) : (bitmasks[dx/4].test((dx%4)*2) ? c2 : c1) ));
-            }
+            uint8_t low = evenBits(mask1) | (evenBits(mask2) << 4);
+            uint8_t high = oddBits(mask1) | (oddBits(mask2) << 4);
+            _storeRow(x, y, select(c1, c2, c3, c4, low, high));
         }
 
         void MvePlayer::_drawRow4colors2x2(uint32_t x, uint32_t y, uint8_t c1, uint8_t c2, uint8_t c3, uint8_t c4, uint8_t mask)
         {
-            std::bitset<8> bitmask(mask);
-            SDL_Rect dstrect;
-            for (uint32_t dx = 0; dx < 4; dx++) {
-                dstrect.w = 2;
-                dstrect.h = 2;
-                dstrect.x = x + dx*2;
-                dstrect.y = y;
-                SDL_FillRect(_currentBuf,&dstrect, (bitmask.test(dx*2+1) ? (bitmask.test(dx*2) ? c4 : c3) : (bitmask.test(dx*2) ? c2 : c1) ));
-            }
+            uint64_t row = select(c1, c2, c3, c4, doubledBits(evenBits(mask)), doubledBits(oddBits(mask)));
+            _storeRow(x, y, row);
+            _storeRow(x, y + 1, row);
         }
 
         void MvePlayer::_drawRow4colors2x1(uint32_t x, uint32_t y, uint8_t c1, uint8_t c2, uint8_t c3, uint8_t c4, uint8_t mask)
         {
-            std::bitset<8> bitmask(mask);
-            SDL_Rect dstrect;
-            for (uint32_t dx = 0; dx < 4; dx++) {
-                dstrect.w = 2;
-                dstrect.h = 1;
-                dstrect.x = x + dx*2;
-                dstrect.y = y;
-                SDL_FillRect(_currentBuf,&dstrect, (bitmask.test(dx*2+1) ? (bitmask.test(dx*2) ? c4 : c3) : (bitmask.test(dx*2) ? c2 : c1) ));
-            }
+            _storeRow(x, y, select(c1, c2, c3, c4, doubledBits(evenBits(mask)), doubledBits(oddBits(mask))));
         }
 
         void MvePlayer::_drawRow4colors1x2(uint32_t x, uint32_t y, uint8_t c1, uint8_t c2, uint8_t c3, uint8_t c4, uint8_t mask1, uint8_t mask2)
         {
-            std::bitset<8> bitmasks[2]={mask1,mask2};
-            SDL_Rect dstrect;
-            for (uint32_t dx = 0; dx < 8; dx++) {
-                dstrect.w = 1;
-                dstrect.h = 2;
-                dstrect.x = x + dx;
-                dstrect.y = y;
-                SDL_FillRect(_currentBuf,&dstrect, (bitmasks[dx/4].test((dx%4)*2+1) ? (bitmasks[dx/4].test((dx%4)*2) ? c4 : c3) : (bitmasks[dx/4].test((dx%4)*2) ? c2 : c1) ));
-            }
-
+            uint8_t low = evenBits(mask1) | (evenBits(mask2) << 4);
+            uint8_t high = oddBits(mask1) | (oddBits(mask2) << 4);
+            uint64_t row = select(c1, c2, c3, c4, low, high);
+            _storeRow(x, y, row);
+            _storeRow(x, y + 1, row);
         }
 
-
         void MvePlayer::_drawQuadrant(uint32_t x, uint32_t y, uint8_t c1, uint8_t c2, uint8_t mask1, uint8_t mask2)
         {
-            std::bitset<8> bitmask1(mask1);
-            std::bitset<8> bitmask2(mask2);
-            SDL_Rect dstrect;
-            for (uint32_t dy = 0; dy < 4; dy++) {
-                for (uint32_t dx = 0; dx < 4; dx++) {
-                    dstrect.w = 1;
-                    dstrect.h = 1;
-                    dstrect.x = x + dx;
-                    dstrect.y = y + dy;
-                    if (dy < 2) {
-                        SDL_FillRect(_currentBuf,&dstrect, (bitmask1.test(4*(dy%2)+dx) ? c2 : c1));
-                    } else {
-                        SDL_FillRect(_currentBuf,&dstrect, (bitmask2.test(4*(dy%2)+dx) ? c2 : c1));
-                    }
-                }
-            }
-
+            // 4 pixels per row, 2 rows per mask
+            _storeRow(x, y,     select(c1, c2, mask1 & 0x0F), 4);
+            _storeRow(x, y + 1, select(c1, c2, mask1 >> 4), 4);
+            _storeRow(x, y + 2, select(c1, c2, mask2 & 0x0F), 4);
+            _storeRow(x, y + 3, select(c1, c2, mask2 >> 4), 4);
         }
 
-
         void MvePlayer::_drawQuadrant4colors(uint32_t x, uint32_t y, uint8_t c1, uint8_t c2, uint8_t c3, uint8_t c4, uint8_t mask1, uint8_t mask2, uint8_t mask3, uint8_t mask4)
         {
-            std::bitset<8> bitmasks[4];
-            bitmasks[0] = mask1;
-            bitmasks[1] = mask2;
-            bitmasks[2] = mask3;
-            bitmasks[3] = mask4;
-            SDL_Rect dstrect;
+            uint8_t masks[4] = {mask1, mask2, mask3, mask4};
             for (uint32_t dy = 0; dy < 4; dy++) {
-                for (uint32_t dx = 0; dx < 4; dx++) {
-                    dstrect.w = 1;
-                    dstrect.h = 1;
-                    dstrect.x = x + dx;
-                    dstrect.y = y + dy;
-                    SDL_FillRect(_currentBuf,&dstrect, (bitmasks[dy].test(dx*2+1) ? (bitmasks[dy].test(dx*2) ? c4 : c3) : (bitmasks[dy].test(dx*2) ? c2 : c1) ));
-                }
+                _storeRow(x, y + dy, select(c1, c2, c3, c4, evenBits(masks[dy]), oddBits(masks[dy])), 4);
             }
         }
 
@@ -236,7 +303,6 @@ namespace Falltergeist
             uint32_t curMap = 0;
             SDL_Rect srcrect;
             SDL_Rect dstrect;
-            uint8_t color = 0;
             for (uint32_t y = 0; y < h;y++) {
                 for (uint32_t x = 0; x < w;x++) {
                     curMap = (y*w + x);
@@ -248,7 +314,7 @@ namespace Falltergeist
                             srcrect.h = 8;
                             srcrect.x = x*8;
                             srcrect.y = y*8;
-                            SDL_BlitSurface(_backBuf, &srcrect, _currentBuf, &srcrect);
+                            _copyBlock(_backBuf, &srcrect, &srcrect);
                             break;
                         case 0x1:
                             //copy from back-back buff -> copy from current frame -> do nothing
@@ -259,7 +325,7 @@ namespace Falltergeist
                             dstrect.h = 8;
                             dstrect.x = x*8;
                             dstrect.y = y*8;
-                            SDL_BlitSurface(_currentBuf, &srcrect, _currentBuf, &dstrect);
+                            _copyBlock(_currentBuf, &srcrect, &dstrect);
                             data++;
                             len--;
                             break;
@@ -269,7 +335,7 @@ namespace Falltergeist
                             dstrect.h = 8;
                             dstrect.x = x*8;
                             dstrect.y = y*8;
-                            SDL_BlitSurface(_currentBuf, &srcrect, _currentBuf, &dstrect);
+                            _copyBlock(_currentBuf, &srcrect, &dstrect);
                             data++;
                             len--;
                             break;
@@ -279,7 +345,7 @@ namespace Falltergeist
                             dstrect.h = 8;
                             dstrect.x = x*8;
                             dstrect.y = y*8;
-                            SDL_BlitSurface(_backBuf, &srcrect, _currentBuf, &dstrect);
+                            _copyBlock(_backBuf, &srcrect, &dstrect);
                             data++;
                             len--;
                             break;
@@ -292,7 +358,7 @@ namespace Falltergeist
                             dstrect.y = y*8;
                             srcrect.x = x*8 + (int8_t)data[0];
                             srcrect.y = y*8 + (int8_t)data[1];
-                            SDL_BlitSurface(_backBuf, &srcrect, _currentBuf, &dstrect);
+                            _copyBlock(_backBuf, &srcrect, &dstrect);
                             data += 2;
                             len -= 2;
                             break;
@@ -449,73 +515,48 @@ namespace Falltergeist
                             break;
                         //raw data
                         case 0xB:
-                            dstrect.w = 1;
-                            dstrect.h = 1;
                             for (uint32_t fy = 0; fy < 8; fy++) {
-                                for (uint32_t fx = 0; fx < 8; fx++) {
-                                    color=data[fy*8 + fx];
-                                    dstrect.x = x*8 + fx;
-                                    dstrect.y = y*8 + fy;
-                                    SDL_FillRect(_currentBuf, &dstrect, color);
-                                }
+                                std::memcpy((uint8_t*)_currentBuf->pixels + (y*8 + fy) * _currentBuf->pitch + x*8, data + fy*8, 8);
                             }
                             data += 64;
                             len -= 64;
                             break;
                         case 0xC:
-                            dstrect.w = 2;
-                            dstrect.h = 2;
                             for (uint32_t fy = 0; fy < 4; fy++) {
+                                uint8_t row[8];
                                 for (uint32_t fx = 0; fx < 4; fx++) {
-                                    color = data[fy*4 + fx];
-                                    dstrect.x = x*8 + fx*2;
-                                    dstrect.y = y*8 + fy*2;
-                                    SDL_FillRect(_currentBuf, &dstrect, color);
+                                    row[fx*2] = row[fx*2 + 1] = data[fy*4 + fx];
                                 }
+                                uint64_t pixels;
+                                std::memcpy(&pixels, row, 8);
+                                _storeRow(x*8, y*8 + fy*2, pixels);
+                                _storeRow(x*8, y*8 + fy*2 + 1, pixels);
                             }
                             data += 16;
                             len -= 16;
                             break;
                         case 0xD:
-                            dstrect.w = 4;
-                            dstrect.h = 4;
                             for (uint32_t fy = 0; fy < 2; fy++) {
-                                for (uint32_t fx = 0; fx < 2; fx++) {
-                                    color = data[fy*2 + fx];
-                                    dstrect.x = x*8 + fx*4;
-                                    dstrect.y = y*8 + fy*4;
-                                    SDL_FillRect(_currentBuf, &dstrect, color);
+                                uint64_t pixels = select(data[fy*2], data[fy*2 + 1], 0xF0);
+                                for (uint32_t row = 0; row < 4; row++) {
+                                    _storeRow(x*8, y*8 + fy*4 + row, pixels);
                                 }
                             }
                             data += 4;
                             len -= 4;
                             break;
                         case 0xE:
-                            dstrect.w = 8;
-                            dstrect.h = 8;
-                            color = data[0];
-                            dstrect.x = x*8;
-                            dstrect.y = y*8;
-                            SDL_FillRect(_currentBuf, &dstrect, color);
+                            for (uint32_t fy = 0; fy < 8; fy++) {
+                                _storeRow(x*8, y*8 + fy, splat(data[0]));
+                            }
                             data++;
                             len--;
                             break;
                         //check-board
                         case 0xF:
-                            dstrect.w = 1;
-                            dstrect.h = 1;
-                            uint32_t even = 0;
-                            for (uint32_t fy = 0; fy < 8; fy++)
-                            {
-                                for (uint32_t fx = 0; fx < 8; fx++)
-                                {
-                                    color = data[even%2];
-                                    dstrect.x = x*8 + fx;
-                                    dstrect.y = y*8 + fy;
-                                    SDL_FillRect(_currentBuf, &dstrect, color);
-                                    even++;
-                                }
-                                even++;
+                            for (uint32_t fy = 0; fy < 8; fy++) {
+                                // every row starts with the other color
+                                _storeRow(x*8, y*8 + fy, fy % 2 ? select(data[1], data[0], 0xAA) : select(data[0], data[1], 0xAA));
                             }
                             data += 2;
                             len -= 2;
@@ -552,13 +593,41 @@ namespace Falltergeist
             }
             _decodeFrame(data + 14, len - 14);
 
-            SDL_Surface* temp = SDL_ConvertSurfaceFormat(_currentBuf, SDL_PIXELFORMAT_RGBA8888, 0);
-            // Fill alpha channel with 0xFF since it is 0x00 at this point
-            for (auto i = 0; i < temp->w * temp->h; i++) {
-                ((int32_t*)temp->pixels)[i] = ((int32_t*)temp->pixels)[i] | 0xFF;
+            auto& rgba = _pending.rgba;
+            if (rgba.empty()) {
+                std::lock_guard<std::mutex> lock(_framesMutex);
+                if (!_spareFrames.empty()) {
+                    rgba = std::move(_spareFrames.back());
+                    _spareFrames.pop_back();
+                }
             }
-            _movie->loadFromSurface(temp);
-            SDL_FreeSurface(temp);
+            rgba.resize(_currentBuf->w * _currentBuf->h);
+            for (int y = 0; y < _currentBuf->h; y++) {
+                Graphics::expandPalette(
+                    (uint8_t*)_currentBuf->pixels + y * _currentBuf->pitch,
+                    &rgba[y * _currentBuf->w],
+                    _currentBuf->w,
+                    _palette.data()
+                );
+            }
+            _pending.width = _currentBuf->w;
+            _pending.height = _currentBuf->h;
+        }
+
+        void MvePlayer::_present(Frame& frame)
+        {
+            if (_presenting) {
+                SDL_Surface* temp = SDL_CreateRGBSurfaceFrom(
+                    frame.rgba.data(), frame.width, frame.height, 32, frame.width * 4,
+                    0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff
+                );
+                _movie->loadFromSurface(temp);
+                SDL_FreeSurface(temp);
+            }
+
+            std::lock_guard<std::mutex> lock(_framesMutex);
+            _spareFrames.push_back(std::move(frame.rgba));
+            frame.rgba.clear();
         }
 
         void MvePlayer::_setDecodingMap(uint8_t* data)
@@ -591,7 +660,9 @@ namespace Falltergeist
                 palette[i].g = *(pal++) << 2;
                 palette[i].b = *(pal++) << 2;
                 palette[i].a = 0;
+                _palette[i] = (palette[i].r << 24) | (palette[i].g << 16) | (palette[i].b << 8) | 0xFF;
             }
+            _palette[0] = 0xFF;
             int ret = 1;
             if (_currentBuf)
             {
@@ -609,7 +680,7 @@ namespace Falltergeist
 
         void MvePlayer::_sendVideoBuffer(uint8_t* data)
         {
-            _frame++;
+            _framesDecoded++;
         }
 
         void MvePlayer::_initVideoBuffer(uint8_t* data)
@@ -652,47 +723,58 @@ namespace Falltergeist
         {
         //  uint16_t flags=get_short(data+2);
         //  std::bitset<16> bit(flags);
-        //  uint16_t sample_rate=get_short(data+4); //always 22050
-            uint32_t buflen = get_int(data + 6);
-            _audioBuf = new int16_t[buflen];
-            _audioBufHead = 0;
-            _audioBufTail = 0;
-            _audioBufSize = buflen;
+            uint16_t sampleRate = get_short(data + 4); //always 22050
+            if (sampleRate > 0) {
+                _audioRate = sampleRate;
+            }
         }
 
-        void MvePlayer::_playAudio()
+        uint32_t MvePlayer::samplesLeft()
         {
+            return static_cast<uint32_t>(_audio.size());
         }
 
-
-        uint32_t MvePlayer::samplesLeft()
+        uint32_t MvePlayer::getAudio(uint8_t* data, uint32_t len)
         {
-            return _samplesReady;
+            uint32_t samples = len / sizeof(int16_t);
+            uint32_t res = static_cast<uint32_t>(_audio.read(reinterpret_cast<int16_t*>(data), samples));
+            // silence doesn't advance the clock, the video waits for the missing audio instead
+            std::memset(data + res * sizeof(int16_t), 0, (samples - res) * sizeof(int16_t));
+
+            _framesPlayed += res / AUDIO_CHANNELS;
+            _callbackFrames.store(samples / AUDIO_CHANNELS, std::memory_order_relaxed);
+            if (_framesPlayed > 0) {
+                _audioClock.store((static_cast<uint64_t>(SDL_GetTicks()) << 32) | _framesPlayed, std::memory_order_release);
+            }
+            return res;
         }
 
-        uint32_t MvePlayer::getAudio(uint8_t* data, uint32_t len)
+        int64_t MvePlayer::_audioTime()
         {
-            if (!_timerStarted)
-            {
-                return 0;
+            uint64_t clock = _audioClock.load(std::memory_order_acquire);
+            if (clock == 0) {
+                return -1;
             }
-            uint32_t res = 0;
-            int16_t *buf = (int16_t*)data;
-            while (res < len / 2)
-            {
-                if (_samplesReady <= 0) {
-                    break;
-                }
-                *buf = _audioBuf[_audioBufHead];
-                buf++;
-                _audioBufHead++;
-                if (_audioBufHead >= _audioBufSize) {
-                    _audioBufHead = 0;
-                }
-                res++;
-                _samplesReady--;
+            uint32_t ticks = static_cast<uint32_t>(clock >> 32);
+            int64_t frames = static_cast<uint32_t>(clock);
+            int64_t buffered = _callbackFrames.load(std::memory_order_relaxed);
+
+            // the last buffer started playing when the callback ran, extrapolate between the callbacks
+            int64_t handed = frames * 1000000 / _audioRate;
+            int64_t heard = (frames - buffered) * 1000000 / _audioRate + static_cast<int64_t>(SDL_GetTicks() - ticks) * 1000;
+            return std::max<int64_t>(0, std::min(heard, handed));
+        }
+
+        int64_t MvePlayer::_clock()
+        {
+            int64_t wall = static_cast<int64_t>(_millisecondsTracked * 1000);
+            int64_t audio = _audioTime();
+            if (audio >= 0 && _audio.size() > 0) {
+                _clockOffset = wall - audio;
+                return audio;
             }
-            return res;
+            // no audio yet or it ran dry, the timer continues from where the audio left off
+            return wall - _clockOffset;
         }
 
         void MvePlayer::_decodeAudio(uint8_t* data, uint32_t len)
@@ -703,18 +785,9 @@ namespace Falltergeist
             int16_t right = get_short(data + 2);
             data += 4;
 
-            _audioBuf[_audioBufTail] = left;
-            _audioBufTail++;
-            _samplesReady++;
-            if (_audioBufTail >= _audioBufSize) {
-                _audioBufTail = 0;
-            }
-            _audioBuf[_audioBufTail] = right;
-            _audioBufTail++;
-            _samplesReady++;
-            if (_audioBufTail >= _audioBufSize) {
-                _audioBufTail = 0;
-            }
+            _pcm.clear();
+            _pcm.push_back(left);
+            _pcm.push_back(right);
 
             for (int32_t i = 0; i < strlen/2-2; i++)
             {
@@ -722,31 +795,85 @@ namespace Falltergeist
                 {
                     left += audio_exp_table[data[i]];
                     left = clip_int16(left);
-                    _audioBuf[_audioBufTail] = left;
+                    _pcm.push_back(left);
                 }
                 else
                 {
                     right += audio_exp_table[data[i]];
                     right = clip_int16(right);
-                    _audioBuf[_audioBufTail] = right;
+                    _pcm.push_back(right);
                 }
-                _audioBufTail++;
-                _samplesReady++;
-                if (_audioBufTail >= _audioBufSize) {
-                    _audioBufTail = 0;
+            }
+
+            size_t written = _audio.write(_pcm.data(), _pcm.size());
+            if (written < _pcm.size()) {
+                Logger::warning("VIDEO") << "Movie audio queue is full, dropped " << (_pcm.size() - written) << " samples" << std::endl;
+            }
+            _framesQueued += written / AUDIO_CHANNELS;
+        }
+
+        bool MvePlayer::_readChunk()
+        {
+            if (_streamEnded) {
+                return false;
+            }
+
+            auto chunk = _mve->getNextChunk();
+            if (!chunk || static_cast<Chunk>(chunk->type()) == Chunk::END) {
+                _streamEnded = true;
+                return false;
+            }
+
+            // audio is queued as soon as it is read, so it never waits for the frame it was stored with
+            for (auto& opcode : chunk->opcodes())
+            {
+                switch (static_cast<Opcode>(opcode.type()))
+                {
+                    case Opcode::INIT_AUDIO_BUF:
+                        _initAudioBuffer(opcode.version(), opcode.data());
+                        break;
+                    case Opcode::AUDIO_DATA:
+                        _decodeAudio(opcode.data(), opcode.length());
+                        break;
+                    case Opcode::END_STREAM:
+                        _streamEnded = true;
+                        break;
+                    default:
+                        break;
                 }
             }
+            _chunks.push_back(std::move(chunk));
+            return true;
         }
 
-        void MvePlayer::_processChunk()
+        void MvePlayer::_readAhead()
         {
-            if (static_cast<Chunk>(_chunk->type()) == Chunk::END)
+            uint64_t lead = static_cast<uint64_t>(_audioRate) * AUDIO_LEAD_MS / 1000 + 2 * _callbackFrames.load(std::memory_order_relaxed);
+            while (_chunks.size() < MAX_READ_AHEAD) {
+                uint64_t played = static_cast<uint32_t>(_audioClock.load(std::memory_order_acquire));
+                if (!_chunks.empty() && _framesQueued - played >= lead) {
+                    break;
+                }
+                if (!_readChunk()) {
+                    break;
+                }
+            }
+        }
+
+        bool MvePlayer::_processChunk()
+        {
+            if (_chunks.empty()) {
+                _readChunk();
+            }
+            if (_chunks.empty())
             {
-                _finished = true;
-                return;
+                return false;
             }
 
-            auto& opcodes = _chunk->opcodes();
+            auto chunk = std::move(_chunks.front());
+            _chunks.pop_front();
+
+            auto& opcodes = chunk->opcodes();
             for (auto& opcode : opcodes)
             {
                 switch (static_cast<Opcode>(opcode.type()))
@@ -758,14 +885,13 @@ namespace Falltergeist
                         _timerStarted = true;
                         break;
                     case Opcode::END_STREAM:
-                        _finished = true;
-                        return;
+                        _pending.number = _framesDecoded;
+                        return true;
                         break;
                     case Opcode::INIT_AUDIO_BUF:
-                        _initAudioBuffer(opcode.version(), opcode.data());
+                        // queued by _readChunk
                         break;
                     case Opcode::START_AUDIO:
-                        _playAudio();
                         break;
                     case Opcode::INIT_VIDIO_BUF:
                         //can be called multiple times (intro and tanker)
@@ -776,8 +902,6 @@ namespace Falltergeist
                         //copy buffer to texture (with palette)
                         break;
                     case Opcode::AUDIO_DATA:
-                        _decodeAudio(opcode.data(), opcode.length());
-                        break;
                     case Opcode::AUDIO_SILENCE:
                         break;
                     case Opcode::INIT_VIDEO:
@@ -809,7 +933,51 @@ namespace Falltergeist
                         break;
                 }
             }
-            _chunk = _mve->getNextChunk();
+            _pending.number = _framesDecoded;
+            return true;
+        }
+
+        void MvePlayer::_queueFrame()
+        {
+            std::lock_guard<std::mutex> lock(_framesMutex);
+            _frames.push_back(std::move(_pending));
+            _pending = Frame();
+        }
+
+        void MvePlayer::_decoderLoop()
+        {
+            try {
+                while (true) {
+                    _readAhead();
+                    {
+                        std::unique_lock<std::mutex> lock(_framesMutex);
+                        // the audio lead is topped up at least every 10ms while the frame queue is full
+                        _framesChanged.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+                            return _decoderStopping || _frames.size() < FRAME_QUEUE;
+                        });
+                        if (_decoderStopping) {
+                            return;
+                        }
+                        if (_frames.size() >= FRAME_QUEUE) {
+                            continue;
+                        }
+                    }
+                    if (!_processChunk()) {
+                        break;
+                    }
+                    _queueFrame();
+                }
+            } catch (Exception* e) {
+                // some readers throw by pointer, the main thread gets a copy
+                std::lock_guard<std::mutex> lock(_framesMutex);
+                _decoderError = std::make_exception_ptr(Exception(e->what()));
+                delete e;
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(_framesMutex);
+                _decoderError = std::current_exception();
+            }
+            // the frames decoded before an error are still played
+            _decoded = true;
         }
 
         void MvePlayer::think(const float &deltaTime)
@@ -818,23 +986,76 @@ namespace Falltergeist
                 return;
             }
 
-            if (_millisecondsTracked >= _delay / 1000) // 66.728
+            _millisecondsTracked += deltaTime;
+
+            // ticks are presented when the audio played along with them is heard, _delay is in microseconds (66728).
+            // Only the latest due picture is uploaded after a stall
+            int64_t now = _clock();
+            Frame latest;
+            std::exception_ptr error;
             {
-                _millisecondsTracked -= _delay / 1000;
-                _processChunk();
+                std::lock_guard<std::mutex> lock(_framesMutex);
+                error.swap(_decoderError);
+                while (!_frames.empty() && now >= static_cast<int64_t>(_chunksPresented + 1) * _delay) {
+                    auto& next = _frames.front();
+                    _frame = next.number;
+                    if (!next.rgba.empty()) {
+                        if (!latest.rgba.empty()) {
+                            _spareFrames.push_back(std::move(latest.rgba));
+                        }
+                        latest = std::move(next);
+                    }
+                    _frames.pop_front();
+                    _chunksPresented++;
+                }
+                _finished = _decoded && _frames.empty();
             }
+            _framesChanged.notify_one();
 
-            _millisecondsTracked += deltaTime;
+            if (error) {
+                try {
+                    std::rethrow_exception(error);
+                } catch (const std::exception& e) {
+                    Logger::error("VIDEO") << "Movie decoding failed: " << e.what() << std::endl;
+                } catch (...) {
+                    Logger::error("VIDEO") << "Movie decoding failed" << std::endl;
+                }
+            }
+
+            if (!latest.rgba.empty()) {
+                _present(latest);
+            }
+
+            if (_finished && now >= static_cast<int64_t>(_framesQueued * 1000000 / _audioRate)) {
+                _drained = true;
+            }
         }
 
         bool MvePlayer::finished()
         {
-            return _finished;
+            return _finished && _drained;
         }
 
         uint32_t MvePlayer::frame()
         {
             return _frame;
         }
+
+        bool MvePlayer::decodeTick()
+        {
+            if (_presenting || _decoded) {
+                return false;
+            }
+            _readAhead();
+            if (!_processChunk()) {
+                _decoded = true;
+                return false;
+            }
+            _frame = _pending.number;
+            if (!_pending.rgba.empty()) {
+                _present(_pending);
+            }
+            return true;
+        }
     }
 }
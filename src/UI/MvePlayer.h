@@ -1,7 +1,17 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <ctime>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <SDL.h>
+#include "../Base/RingBuffer.h"
 #include "../Graphics/Movie.h"
 #include "../UI/Base.h"
 
@@ -20,7 +30,8 @@ namespace Falltergeist
         class MvePlayer : public Falltergeist::UI::Base
         {
             public:
-                MvePlayer(Format::Mve::File* mve);
+                // Without presenting, frames are only decoded when decodeTick() is called and never uploaded
+                MvePlayer(Format::Mve::File* mve, bool present = true);
 
                 ~MvePlayer() override;
 
@@ -28,8 +39,10 @@ namespace Falltergeist
 
                 void render(bool eggTransparency = false) override;
 
+                // Every frame was shown and the queued audio was played
                 bool finished();
 
+                // Called from the audio callback, fills the stream with silence on underrun
                 uint32_t getAudio(uint8_t* data, uint32_t len);
 
                 uint32_t samplesLeft();
@@ -37,32 +50,89 @@ namespace Falltergeist
                 // Current frame number
                 uint32_t frame();
 
+                // Decodes the next tick of a player which doesn't present, false at the end of the stream
+                bool decodeTick();
+
             private:
-                Format::Mve::File* _mve = nullptr;
+                // Result of one timer tick, the picture is only set when the chunk held video data
+                struct Frame
+                {
+                    std::vector<uint32_t> rgba;
+                    uint32_t width = 0;
+                    uint32_t height = 0;
+                    uint32_t number = 0;
+                };
 
-                std::unique_ptr<Format::Mve::Chunk> _chunk;
+                std::shared_ptr<Format::Mve::File> _mve;
+
+                // Chunks read ahead of the video, their audio is queued already. Decoder thread only
+                std::deque<std::unique_ptr<Format::Mve::Chunk>> _chunks;
 
                 Graphics::Movie* _movie;
 
-                bool _timerStarted = false;
+                std::atomic<bool> _timerStarted{false};
 
                 bool _finished = false;
 
-                uint8_t* _decodingMap = nullptr;
+                bool _streamEnded = false;
 
-                int16_t* _audioBuf = nullptr;
+                bool _drained = false;
+
+                uint8_t* _decodingMap = nullptr;
 
                 uint32_t  _frame = 0;
 
-                uint32_t _delay = 0;
+                // Frames sent by the decoder so far
+                uint32_t _framesDecoded = 0;
+
+                std::atomic<uint32_t> _delay{0};
+
+                // Decoded ticks waiting to be presented and picture buffers to reuse, guarded by _framesMutex
+                std::deque<Frame> _frames;
+
+                std::vector<std::vector<uint32_t>> _spareFrames;
+
+                std::mutex _framesMutex;
+
+                std::condition_variable _framesChanged;
+
+                // Tick the decoder is filling in
+                Frame _pending;
+
+                bool _presenting;
+
+                std::thread _decoder;
+
+                bool _decoderStopping = false;
+
+                // Set by the decoder after the last tick was queued
+                std::atomic<bool> _decoded{false};
 
-                uint32_t _audioBufHead = 0;
+                // What stopped the decoder, reported by think() on the main thread. Guarded by _framesMutex
+                std::exception_ptr _decoderError;
 
-                uint32_t _audioBufTail = 0;
+                // Decoded stereo PCM, written by the player and read by the audio callback
+                Falltergeist::Base::RingBuffer<int16_t> _audio;
 
-                uint32_t _audioBufSize = 0;
+                std::vector<int16_t> _pcm;
 
-                uint32_t _samplesReady = 0;
+                std::atomic<uint32_t> _audioRate{22050};
+
+                // Sample frames queued since the start, the queue position is the movie time of the next sample
+                std::atomic<uint64_t> _framesQueued{0};
+
+                // Sample frames handed to the mixer, only touched by the audio callback
+                uint32_t _framesPlayed = 0;
+
+                // SDL ticks of the last callback in the high half, _framesPlayed at that moment in the low half
+                std::atomic<uint64_t> _audioClock{0};
+
+                // Frames handed over per callback, they are heard one buffer later
+                std::atomic<uint32_t> _callbackFrames{0};
+
+                uint32_t _chunksPresented = 0;
+
+                int64_t _clockOffset = 0;
 
                 float _millisecondsTracked = 0;
 
@@ -70,7 +140,28 @@ namespace Falltergeist
 
                 SDL_Surface* _backBuf = nullptr;
 
-                void _processChunk();
+                // current palette as opaque RGBA8888 colors
+                std::array<uint32_t, 256> _palette = {};
+
+                // Decodes the next tick into _pending, false at the end of the stream
+                bool _processChunk();
+
+                bool _readChunk();
+
+                void _readAhead();
+
+                void _decoderLoop();
+
+                // Queues the finished tick, the decoder loop waits for room in the queue before decoding it
+                void _queueFrame();
+
+                void _present(Frame& frame);
+
+                // Movie time in microseconds, following the audio while it plays
+                int64_t _clock();
+
+                // Microseconds of audio heard so far, negative before playback started
+                int64_t _audioTime();
 
                 void _decodeVideo(uint8_t* data, uint32_t len);
 
@@ -86,8 +177,6 @@ namespace Falltergeist
 
                 void _initAudioBuffer(uint8_t version, uint8_t* data);
 
-                void _playAudio();
-
                 void _decodeAudio(uint8_t* data, uint32_t len);
 
                 enum class Chunk: uint16_t
@@ -126,7 +215,11 @@ namespace Falltergeist
                     UNKNOWN_0x15
                 };
 
-                //drawing helpers
+                //drawing helpers, the decoded frame is 8 bit indexed
+                void _storeRow(uint32_t x, uint32_t y, uint64_t row, uint32_t width = 8);
+
+                void _copyBlock(SDL_Surface* from, SDL_Rect* srcrect, SDL_Rect* dstrect);
+
                 void _drawRow(uint32_t x, uint32_t y, uint8_t c1, uint8_t c2, uint8_t mask);
 
                 void _drawRow2x2(uint32_t x, uint32_t y, uint8_t c1, uint8_t c2, uint8_t mask);
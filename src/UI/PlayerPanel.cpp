@@ -7,6 +7,7 @@
 #include "../Game/ItemObject.h"
 #include "../Graphics/Renderer.h"
 #include "../Input/Mouse.h"
+#include "../Simulation.h"
 #include "../State/ExitConfirm.h"
 #include "../State/GameMenu.h"
 #include "../State/Inventory.h"
@@ -158,7 +159,7 @@ namespace Falltergeist
                     if (_scrollingLog != 0)
                     {
                         _messageLog->setLineOffset(_messageLog->lineOffset() + _scrollingLog);
-                        _scrollingLogTimer = SDL_GetTicks();
+                        _scrollingLogTimer = Simulation::ticks();
                     }
                 });
 
@@ -264,12 +265,12 @@ namespace Falltergeist
                 itemUi->think(deltaTime);
             }
 
-            if (_scrollingLogTimer && (SDL_GetTicks() > _scrollingLogTimer + 150)
+            if (_scrollingLogTimer && (Simulation::ticks() > _scrollingLogTimer + 150)
                 && ((_scrollingLog < 0 && _messageLog->lineOffset() > 0)
                     || (_scrollingLog > 0 && _messageLog->lineOffset() < _messageLog->numLines() - 6)))
             {
                 _messageLog->setLineOffset(_messageLog->lineOffset() + _scrollingLog);
-                _scrollingLogTimer = SDL_GetTicks();
+                _scrollingLogTimer = Simulation::ticks();
             }
         }
 
@@ -20,6 +20,12 @@ namespace Falltergeist
             return false;
         }
 
+        bool Rectangle::hitSize(Size& size) const
+        {
+            size = Size(0, 0);
+            return true;
+        }
+
         const Size& Rectangle::size() const
         {
             return _size;
@@ -16,6 +16,7 @@ namespace Falltergeist
                 void render(bool eggTransparency = false) override;
 
                 bool opaque(const Point &pos) override;
+                bool hitSize(Size& size) const override;
 
                 const Size& size() const override;
 
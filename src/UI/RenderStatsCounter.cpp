@@ -0,0 +1,47 @@
+#include <cstdio>
+#include "../Graphics/RenderStats.h"
+#include "../UI/RenderStatsCounter.h"
+
+namespace Falltergeist
+{
+    namespace UI
+    {
+        using Graphics::RenderStats;
+
+        RenderStatsCounter::RenderStatsCounter(const Point& pos, RenderStats* stats) : TextArea(pos), _stats(stats)
+        {
+            setWidth(200);
+            setHorizontalAlign(TextArea::HorizontalAlign::RIGHT);
+        }
+
+        void RenderStatsCounter::think(const float &deltaTime)
+        {
+            _millisecondsTracked += deltaTime;
+            if (_millisecondsTracked < 500.0f) {
+                return;
+            }
+            _millisecondsTracked = 0;
+
+            auto& frame = _stats->lastFrame();
+            std::string text = "draws " + std::to_string(frame.drawCalls)
+                + " quads " + std::to_string(frame.quads)
+                + "\nbinds " + std::to_string(frame.textureBinds)
+                + " uploads " + std::to_string(frame.bufferCreations + frame.bufferUploads)
+                + " " + std::to_string(frame.uploadedBytes / 1024) + "K";
+
+            if (_stats->timing()) {
+                for (unsigned int i = 0; i != RenderStats::PASSES; ++i) {
+                    auto pass = static_cast<RenderStats::Pass>(i);
+                    auto time = _stats->passTime(pass);
+                    if (time < 0.0f) {
+                        continue;
+                    }
+                    char buffer[32];
+                    std::snprintf(buffer, sizeof(buffer), "%.2f", time);
+                    text += "\n" + std::string(RenderStats::passName(pass)) + " " + buffer + " ms";
+                }
+            }
+            setText(text);
+        }
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../UI/TextArea.h"
+
+namespace Falltergeist
+{
+    namespace Graphics
+    {
+        class RenderStats;
+    }
+    namespace UI
+    {
+        /**
+         * Shows the draw calls, binds and uploads of the last frame and the GPU times of the render passes,
+         * refreshed twice a second so the numbers can be read.
+         */
+        class RenderStatsCounter final : public TextArea
+        {
+            public:
+                RenderStatsCounter(const Point& pos, Graphics::RenderStats* stats);
+
+                virtual ~RenderStatsCounter() = default;
+
+                void think(const float &deltaTime) override;
+
+            private:
+                Graphics::RenderStats* _stats;
+
+                float _millisecondsTracked = 0;
+        };
+    }
+}
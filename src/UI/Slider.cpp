@@ -101,6 +101,11 @@ namespace Falltergeist {
             return pos >= Point(0, 0) && pos < size();
         }
 
+        bool Slider::hitSize(Size& size) const {
+            size = this->size();
+            return true;
+        }
+
         const Size& Slider::size() const {
             return _sliderSize;
         }
@@ -18,6 +18,7 @@ namespace Falltergeist {
             const Size& size() const override;
 
             bool opaque(const Point& pos) override;
+            bool hitSize(Size& size) const override;
 
             void render(bool eggTransparency) override;
 
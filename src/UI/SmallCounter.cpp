@@ -110,5 +110,11 @@ namespace Falltergeist
         {
             return false;
         }
+
+        bool SmallCounter::hitSize(Size& size) const
+        {
+            size = Size(0, 0);
+            return true;
+        }
     }
 }
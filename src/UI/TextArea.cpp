@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <map>
 #include <sstream>
+#include <tuple>
 #include <SDL.h>
 #include "../CrossPlatform.h"
 #include "../Event/Mouse.h"
@@ -7,6 +9,7 @@
 #include "../Graphics/Font.h"
 #include "../Graphics/Rect.h"
 #include "../ResourceManager.h"
+#include "../Simulation.h"
 #include "../UI/TextArea.h"
 
 namespace Falltergeist
@@ -15,9 +18,15 @@ namespace Falltergeist
     {
         using Graphics::Rect;
 
+        namespace
+        {
+            // Distinct layouts shared between text areas
+            const size_t LAYOUT_CACHE_SIZE = 1024;
+        }
+
         TextArea::TextArea(const Point& pos) : Base(pos)
         {
-            _timestampCreated = SDL_GetTicks();
+            _timestampCreated = Simulation::ticks();
 
         }
 
@@ -27,7 +36,7 @@ namespace Falltergeist
 
         TextArea::TextArea(const std::string& text, const Point& pos) : Base(pos)
         {
-            _timestampCreated = SDL_GetTicks();
+            _timestampCreated = Simulation::ticks();
             setText(text);
         }
 
@@ -58,13 +67,21 @@ namespace Falltergeist
             _changed = true;
             if (lines)
             {
-                _lines.clear();
+                _lines.reset();
             }
         }
 
         void TextArea::appendText(const std::string& text)
         {
+            // text following a line break can't change the lines before it, so only the appended part is laid out
+            bool continues = _lines && !_text.empty() && _text.back() == '\n';
             _text += text;
+            if (continues)
+            {
+                _appendLines(text);
+                _needUpdate();
+                return;
+            }
             _needUpdate(true);
         }
 
@@ -199,7 +216,7 @@ namespace Falltergeist
         int TextArea::numLines()
         {
             _updateLines();
-            return static_cast<int>(_lines.size());
+            return static_cast<int>(_lines->size());
         }
 
         void TextArea::setSize(const Size& size)
@@ -210,6 +227,7 @@ namespace Falltergeist
             // width affect line composition, so we need full update
             _needUpdate(_size.width() != size.width());
             _size = size;
+            _layoutChanged();
         }
 
         void TextArea::setWidth(int width)
@@ -225,41 +243,46 @@ namespace Falltergeist
             }
 
             _symbols.clear();
+            Size previousSize = _calculatedSize;
 
             if (_text.empty())
             {
                 _updateBuffers();
                 _calculatedSize = Size(0, 0);
                 _changed = false;
+                if (previousSize != _calculatedSize) {
+                    _layoutChanged();
+                }
                 return;
             }
 
             _updateLines();
+            const auto& lines = *_lines;
 
             // at positive offset, skip number of first lines
             auto lineBegin = std::min(
-                _lines.cbegin() + (_lineOffset > 0 ? _lineOffset : 0),
-                _lines.cend()
+                lines.cbegin() + (_lineOffset > 0 ? _lineOffset : 0),
+                lines.cend()
             );
-            auto lineEnd = _lines.cend();
+            auto lineEnd = lines.cend();
             if (_size.height())
             {
                 // calculate how much lines we can fit inside TextArea, taking vertical padding into account
                 auto activeHeight = _size.height() - _paddingTopLeft.height() - _paddingBottomRight.height();
 
-                if ((_lineOffset + ((activeHeight + font()->verticalGap()) / (font()->height() + font()->verticalGap()))) < (int)_lines.size())
+                if ((_lineOffset + ((activeHeight + font()->verticalGap()) / (font()->height() + font()->verticalGap()))) < (int)lines.size())
                 {
                     lineEnd = std::max(
                         std::min(
-                            _lines.cbegin() + _lineOffset + ((activeHeight + font()->verticalGap()) / (font()->height() + font()->verticalGap())),
-                            _lines.cend()
+                            lines.cbegin() + _lineOffset + ((activeHeight + font()->verticalGap()) / (font()->height() + font()->verticalGap())),
+                            lines.cend()
                         ),
-                        _lines.cbegin()
+                        lines.cbegin()
                     );
                 }
                 else
                 {
-                    lineEnd = _lines.cend();
+                    lineEnd = lines.cend();
                 }
             }
 
@@ -310,28 +333,69 @@ namespace Falltergeist
             }
             _updateBuffers();
             _changed = false;
+            if (previousSize != _calculatedSize) {
+                _layoutChanged();
+            }
         }
 
         void TextArea::_updateLines()
         {
             // check if already generated
-            if (!_lines.empty()) {
+            if (_lines) {
                 return;
             }
 
-            _lines.resize(1);
-
             // here we respect only horizontal padding in order to properly wrap lines; vertical is handled on higher level
             int x = _paddingTopLeft.width(),
-                y = 0,
+                maxWidth = _size.width() ? (_size.width() - _paddingBottomRight.width()) : 0;
+
+            // same messages are shown over and over (floating messages, dialog options, counters),
+            // so layouts are kept by everything they depend on
+            using LayoutKey = std::tuple<Graphics::Font*, std::string, int, int, bool>;
+            static std::map<LayoutKey, std::shared_ptr<std::vector<Line>>> layouts;
+
+            LayoutKey key(font(), _text, x, maxWidth, _wordWrap);
+            auto cached = layouts.find(key);
+            if (cached != layouts.end())
+            {
+                _lines = cached->second;
+                return;
+            }
+
+            auto layout = std::make_shared<std::vector<Line>>(1);
+            _layoutLines(_text, x, *layout);
+
+            if (layouts.size() >= LAYOUT_CACHE_SIZE)
+            {
+                // areas keep their layouts alive, only sharing with new ones is lost
+                layouts.clear();
+            }
+            layouts.emplace(std::move(key), layout);
+            _lines = std::move(layout);
+        }
+
+        void TextArea::_appendLines(const std::string& text)
+        {
+            // layouts shared with other areas are copied before they are extended
+            if (_lines.use_count() != 1)
+            {
+                _lines = std::make_shared<std::vector<Line>>(*_lines);
+            }
+            // after a line break the layout continues from the start of the empty last line
+            _layoutLines(text, 0, *_lines);
+        }
+
+        void TextArea::_layoutLines(const std::string& text, int x, std::vector<Line>& lines)
+        {
+            auto aFont = font();
+            int y = static_cast<int>(lines.size() - 1) * (aFont->height() + aFont->verticalGap()),
                 wordWidth = 0,
                 maxWidth = _size.width() ? (_size.width() - _paddingBottomRight.width()) : 0;
 
             // Parsing lines of text
             // Cutting lines when it is needed (\n or when exceeding _width)
-            std::istringstream istream(_text);
+            std::istringstream istream(text);
             std::string word, part;
-            auto aFont = font();
 
             // on first iteation, process only leading whitespaces
             while (!istream.eof() && isspace((int)istream.peek()))
@@ -370,17 +434,17 @@ namespace Falltergeist
 
                     if (ch == '\n' || (_wordWrap && maxWidth && x >= maxWidth))
                     {
-                        _lines.back().width = x;
+                        lines.back().width = x;
                         x = 0;
                         y += aFont->height() + aFont->verticalGap();
-                        _lines.emplace_back();
+                        lines.emplace_back();
                     }
 
                     if (ch == ' ' || ch == '\n') {
                         continue;
                     }
 
-                    Line& line = _lines.back();
+                    Line& line = lines.back();
                     Graphics::TextSymbol symbol {ch, {x, y}};
                     line.symbols.push_back(symbol);
                     x += aFont->glyphWidth(ch) + aFont->horizontalGap();
@@ -408,9 +472,7 @@ namespace Falltergeist
                 _updateSymbols();
             }
 
-            auto pos = position();
-
-            _textArea.render(pos,font(),_color, _outlineColor);
+            _textArea.render(position(), font(), _color, _outlineColor);
         }
 
         TextArea& TextArea::operator<<(const std::string& text)
@@ -516,53 +578,18 @@ namespace Falltergeist
 
         void TextArea::_updateBuffers()
         {
-            std::vector<glm::vec2> vertices;
-            std::vector<glm::vec2> UV;
-            std::vector<unsigned int> indexes;
-
-            int cnt = 0;
-            auto tex = font()->texture();
-            for ( auto symbol: _symbols )
-            {
-                auto textureX = static_cast<float>((symbol.chr % 16) * font()->width() + (symbol.chr % 16) * 2 + 1);
-                auto textureY = static_cast<float>((symbol.chr / 16) * font()->height() + (symbol.chr / 16) * 2 + 1);
-
-                Point drawPos = symbol.position;
-
-                glm::vec2 vertex_up_left    = glm::vec2( (float)drawPos.x()-1.0, (float)drawPos.y()-1.0 );
-                glm::vec2 vertex_up_right   = glm::vec2( (float)drawPos.x()+(float)font()->width()+1.0, (float)drawPos.y()-1.0 );
-                glm::vec2 vertex_down_left  = glm::vec2( (float)drawPos.x()-1.0, (float)drawPos.y()+(float)font()->height()+1.0 );
-                glm::vec2 vertex_down_right = glm::vec2( (float)drawPos.x()+(float)font()->width()+1.0, (float)drawPos.y()+(float)font()->height()+1.0 );
-
-                vertices.push_back(vertex_up_left   );
-                vertices.push_back(vertex_up_right  );
-                vertices.push_back(vertex_down_left );
-                vertices.push_back(vertex_down_right);
-
-                glm::vec2 tex_up_left    = glm::vec2( (textureX-1.0)/(float)tex->size().width(), (textureY-1.0)/(float)tex->size().height() );
-                glm::vec2 tex_up_right   = glm::vec2( (textureX+(float)font()->width()+1.0)/(float)tex->size().width(), (textureY-1.0)/(float)tex->size().height() );
-                glm::vec2 tex_down_left  = glm::vec2( (textureX-1.0)/(float)tex->size().width(), (textureY+(float)font()->height()+1.0)/(float)tex->size().height() );
-                glm::vec2 tex_down_right = glm::vec2( (textureX+(float)font()->width()+1.0)/(float)tex->size().width(), (textureY+(float)font()->height()+1.0)/(float)tex->size().height() );
-
-                UV.push_back(tex_up_left   );
-                UV.push_back(tex_up_right  );
-                UV.push_back(tex_down_left );
-                UV.push_back(tex_down_right);
-
-                indexes.push_back(cnt*4);
-                indexes.push_back(cnt*4+1);
-                indexes.push_back(cnt*4+2);
-                indexes.push_back(cnt*4+3);
-                indexes.push_back(cnt*4+2);
-                indexes.push_back(cnt*4+1);
-                cnt++;
-            }
-            _textArea.updateBuffers(vertices,UV,indexes);
+            _textArea.updateBuffers(_symbols, font());
         }
 
         bool TextArea::opaque(const Point &pos)
         {
             return Rect::inRect(pos, this->size());
         }
+
+        bool TextArea::hitSize(Size& size) const
+        {
+            size = this->size();
+            return true;
+        }
     }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include "../Graphics/Font.h"
@@ -202,6 +203,7 @@ namespace Falltergeist
             void render(bool eggTransparency = false) override;
 
             bool opaque(const Point &pos) override;
+            bool hitSize(Size& size) const override;
 
             unsigned int timestampCreated() const;
 
@@ -290,8 +292,9 @@ namespace Falltergeist
 
             /**
              * Lines of text. Cleared along with _changed flag when it is required to recalculate symbol positions.
+             * Layouts are shared between text areas showing the same text with the same font and width.
              */
-            std::vector<Line> _lines;
+            std::shared_ptr<std::vector<Line>> _lines;
 
             int _lineOffset = 0;
 
@@ -323,6 +326,16 @@ namespace Falltergeist
              */
             virtual void _updateLines();
 
+            /**
+             * Lays out lines appended after a line break at the end of the text.
+             */
+            void _appendLines(const std::string& text);
+
+            /**
+             * Lays out text into lines, continuing the last line at the given x.
+             */
+            void _layoutLines(const std::string& text, int x, std::vector<Line>& lines);
+
             /**
              * Call when it is required to recalculate symbol positions.
              * @param lines true to also rebuild line composition.
@@ -21,6 +21,8 @@ namespace Falltergeist
 
         void TextAreaList::addArea(std::unique_ptr<TextArea> area)
         {
+            // only the new area is laid out, scrolling reuses the measured heights
+            _tops.push_back(_tops.back() + area->textSize().height() + area->font()->verticalGap() * 2);
             _areas.push_back(std::move(area));
             _recalculatePositions();
         }
@@ -78,8 +80,8 @@ namespace Falltergeist
             _totalHeight = 0;
             _visibleCount = 0;
             for (unsigned int i = _areaIndex; i < _areas.size(); i++) {
-                _areas.at(i)->setPosition(position()+Size(0,_totalHeight));
-                _totalHeight+=_areas.at(i)->textSize().height()+_areas.at(i)->font()->verticalGap()*2;
+                _areas.at(i)->setPosition(position()+Size(0,_tops[i]-_tops[_areaIndex]));
+                _totalHeight = _tops[i+1]-_tops[_areaIndex];
 
                 if (_totalHeight>_size.height()) {
                     break;
@@ -43,6 +43,10 @@ namespace Falltergeist
 
                 int _totalHeight = 0;
 
+                // top of every area relative to the first one, measured once when the area is added;
+                // the last entry is the bottom of the last area
+                std::vector<int> _tops = {0};
+
                 void _recalculatePositions();
         };
     }
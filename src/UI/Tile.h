@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include "../Graphics/Point.h"
 
@@ -27,11 +28,10 @@ namespace Falltergeist
 
                 void setIndex(unsigned int value);
 
-                void enable();
+                // Connected roof region of the tile, see TileMap
+                uint32_t region() const;
 
-                void disable();
-
-                bool enabled();
+                void setRegion(uint32_t value);
 
             private:
                 unsigned int _index = 0;
@@ -40,7 +40,7 @@ namespace Falltergeist
 
                 Point _position;
 
-                bool _enabled = true;
+                uint32_t _region = 0;
         };
     }
 }
@@ -1,17 +1,33 @@
 ﻿#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <memory>
+#include <numeric>
+#include <set>
+#include <sstream>
 #include <vector>
 #include <SDL_image.h>
+#include "../Base/JobSystem.h"
+#include "../CrossPlatform.h"
+#include "../Format/Frm/File.h"
 #include "../Format/Lst/File.h"
+#include "../Format/Pal/File.h"
 #include "../Game/Game.h"
+#include "../Graphics/HitMask.h"
+#include "../Graphics/PaletteExpansion.h"
 #include "../Graphics/Point.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Tilemap.h"
 #include "../LocationCamera.h"
 #include "../Logger.h"
 #include "../ResourceManager.h"
+#include "../Settings.h"
 #include "../State/Location.h"
+#include "../Trace.h"
 #include "../UI/Tile.h"
 #include "../UI/TileMap.h"
 
@@ -19,6 +35,66 @@ namespace  Falltergeist
 {
     namespace UI
     {
+        namespace
+        {
+            const int TILE_WIDTH = 80;
+
+            const int TILE_HEIGHT = 36;
+
+            const char CACHE_MAGIC[4] = {'F', 'G', 'T', 'C'};
+
+            const uint32_t CACHE_VERSION = 1;
+
+            template<typename T>
+            bool readValue(std::ifstream& stream, T& value)
+            {
+                return (bool) stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+            }
+
+            template<typename T>
+            void writeValue(std::ofstream& stream, const T& value)
+            {
+                stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+
+            // Loose tile files in the Fallout data directory override the DAT files. Adding or removing one changes
+            // the modification time of the directory, which invalidates cached tiles along with the DAT files.
+            int64_t tileOverridesTime()
+            {
+                std::error_code error;
+                auto time = std::filesystem::last_write_time(CrossPlatform::findFalloutDataPath() + "/art/tiles", error);
+                return error ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+            }
+
+            // Rounds towards negative infinity, tiles may be placed left of or above the origin
+            int floorDivide(int value, int divisor)
+            {
+                return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+            }
+
+            // Calls job(first, last) over parts of [0, count) on the workers and this thread, returns once all are done
+            void parallelFor(size_t count, const std::function<void(size_t, size_t)>& job)
+            {
+                auto jobs = Game::Game::getInstance()->jobs();
+                if (count < 2 || !jobs || jobs->size() == 0)
+                {
+                    job(0, count);
+                    return;
+                }
+                size_t parts = std::min(count, static_cast<size_t>(jobs->size()) + 1);
+                size_t chunk = (count + parts - 1) / parts;
+                // every job has to finish before the buffers it writes go away, even if one of them failed
+                Falltergeist::Base::JobSystem::Group group(*jobs);
+                for (size_t first = chunk; first < count; first += chunk)
+                {
+                    size_t last = std::min(first + chunk, count);
+                    jobs->run([&job, first, last]() { job(first, last); }, &group);
+                }
+                job(0, std::min(chunk, count));
+                group.wait();
+            }
+        }
+
         TileMap::TileMap(std::shared_ptr<ILogger> logger)
         {
             this->logger = std::move(logger);
@@ -28,12 +104,27 @@ namespace  Falltergeist
         {
         }
 
+        void TileMap::prefetch()
+        {
+            auto tilesLst = ResourceManager::getInstance()->lstFileType("art/tiles/tiles.lst");
+            ResourceManager::getInstance()->requestPal("color.pal");
+
+            std::set<unsigned int> numbers;
+            for (auto& it : _tiles)
+            {
+                auto number = it.second->number();
+                if (number < tilesLst->strings()->size() && numbers.insert(number).second)
+                {
+                    ResourceManager::getInstance()->requestFrm("art/tiles/" + tilesLst->strings()->at(number));
+                }
+            }
+        }
+
         void TileMap::init()
         {
             std::vector<unsigned int> numbers;
 
-            std::vector<glm::vec2> vertices;
-            std::vector<glm::vec2> UV;
+            std::vector<Graphics::Tilemap::Tile> tiles;
 
             uint32_t maxW = Game::Game::getInstance()->renderer()->maxTextureSize() / 80;
             uint32_t maxH = Game::Game::getInstance()->renderer()->maxTextureSize() / 36;
@@ -41,143 +132,514 @@ namespace  Falltergeist
 
             logger->info() << "[GAME] Tilemap tiles " << _tiles.size() << std::endl;
 
+            // tile numbers are indexes into tiles.lst, so the unique index of every number fits into a flat table
+            auto tilesLst = ResourceManager::getInstance()->lstFileType("art/tiles/tiles.lst");
+            std::vector<int> indexes(tilesLst->strings()->size(), -1);
             for (auto& it : _tiles)
             {
                 auto& tile = it.second;
 
-                auto position = std::find(numbers.begin(), numbers.end(), tile->number());
-                if (position == numbers.end())
+                if (tile->number() >= indexes.size())
                 {
-                    tile->setIndex(static_cast<unsigned>(numbers.size()));
-                    numbers.push_back(tile->number());
+                    indexes.resize(tile->number() + 1, -1);
                 }
-                else
+                int& index = indexes[tile->number()];
+                if (index < 0)
                 {
-                    for (unsigned int i = 0; i != numbers.size(); ++i)
-                    {
-                        if (numbers.at(i) == tile->number())
-                        {
-                            tile->setIndex(i);
-                            break;
-                        }
-                    }
+                    index = static_cast<int>(numbers.size());
+                    numbers.push_back(tile->number());
                 }
+                tile->setIndex(static_cast<unsigned>(index));
+            }
+
+            _atlases = (uint32_t)std::ceil((float)numbers.size() / (float)_tilesPerAtlas);
 
+            // Atlases only cover the rows of tiles they hold, the last one is usually much smaller than the maximum.
+            // Layers of a texture array are all as large as the first atlas
+            bool layered = Graphics::Tilemap::layered(_atlases);
+            auto atlasSize = [&](uint32_t atlas)
+            {
+                if (layered)
+                {
+                    atlas = 0;
+                }
+                uint32_t count = std::min(static_cast<uint32_t>(numbers.size()) - atlas * _tilesPerAtlas, _tilesPerAtlas);
+                return Graphics::Size(std::min(count, maxW) * TILE_WIDTH, (count + maxW - 1) / maxW * TILE_HEIGHT);
+            };
+            std::vector<Graphics::Size> atlasSizes;
+            for (uint32_t i = 0; i != _atlases; ++i)
+            {
+                atlasSizes.push_back(atlasSize(i));
             }
 
+            _slots.clear();
             for (auto& it : _tiles)
             {
                 auto& tile = it.second;
-                // push vertices
-                float vx = static_cast<float>(tile->position().x());
-                float vy = static_cast<float>(tile->position().y());
-                float vw = static_cast<float>(vx + 80.0);
-                float vh = static_cast<float>(vy + 36.0);
-
-                vertices.push_back(glm::vec2(vx, vy));
-                vertices.push_back(glm::vec2(vw, vy));
-                vertices.push_back(glm::vec2(vx, vh));
-                vertices.push_back(glm::vec2(vw, vh));
-
-                //push tilecoords
+                _slots.push_back(tile.get());
+
                 uint32_t tIndex = tile->index() % _tilesPerAtlas;
+                auto& size = atlasSizes.at(tile->index() / _tilesPerAtlas);
 
                 float x = (float)((tIndex % maxW) * 80);
-                float fx = x / (float)Game::Game::getInstance()->renderer()->maxTextureSize();
+                float fx = x / (float)size.width();
 
                 float y = (float)((tIndex / maxW) * 36);
-                float fy = y / (float)Game::Game::getInstance()->renderer()->maxTextureSize();
-
-                float w = static_cast<float>(x + 80.0) / Game::Game::getInstance()->renderer()->maxTextureSize();
-                float h = static_cast<float>(y + 36.0) / Game::Game::getInstance()->renderer()->maxTextureSize();
+                float fy = y / (float)size.height();
 
-                UV.push_back(glm::vec2(fx, fy));
-                UV.push_back(glm::vec2(w, fy));
-                UV.push_back(glm::vec2(fx, h));
-                UV.push_back(glm::vec2(w, h));
+                float w = static_cast<float>(x + 80.0) / size.width();
+                float h = static_cast<float>(y + 36.0) / size.height();
 
+                tiles.push_back({
+                    glm::vec2(static_cast<float>(tile->position().x()), static_cast<float>(tile->position().y())),
+                    glm::vec4(fx, fy, w, h),
+                    static_cast<float>(tile->index() / _tilesPerAtlas)
+                });
             }
 
             // Can be empty if f.e. there is no roof on location
-            if (vertices.empty() || UV.empty()) {
+            if (tiles.empty()) {
                 _tilemap = nullptr;
             } else {
-                _tilemap = std::make_unique<Graphics::Tilemap>(vertices, UV);
+                _tilemap = std::make_unique<Graphics::Tilemap>(std::move(tiles), _atlases);
             }
 
+            _buildGrid();
+            _buildRegions();
+
             logger->info() << "[GAME] Tilemap uniq tiles " << numbers.size() << std::endl;
 
-            _atlases = (uint32_t)std::ceil((float)numbers.size() / (float)_tilesPerAtlas);
             logger->info() << "[GAME] Tilemap atlases " << _atlases << std::endl;
 
-            auto tilesLst = ResourceManager::getInstance()->lstFileType("art/tiles/tiles.lst");
+            // palette indexes of all unique tiles, TILE_WIDTH x TILE_HEIGHT each
+            std::vector<uint8_t> images;
+            std::string cachePath = _cachePath(numbers);
+            if (cachePath.empty() || !_readCache(cachePath, numbers, images))
+            {
+                // files are looked up here, so a recorded manifest lists them, and decoded by the workers
+                std::vector<Format::Frm::File*> frms;
+                frms.reserve(numbers.size());
+                for (auto number : numbers)
+                {
+                    frms.push_back(ResourceManager::getInstance()->frmFileType("art/tiles/" + tilesLst->strings()->at(number)));
+                }
+
+                // every tile has its own slot in the buffer, the workers never write the same bytes
+                images.resize(numbers.size() * TILE_WIDTH * TILE_HEIGHT);
+                parallelFor(frms.size(), [&frms, &images](size_t first, size_t last)
+                {
+                    for (size_t i = first; i != last; ++i)
+                    {
+                        auto frm = frms[i];
+
+                        // tile images are framed by a transparent border of one pixel
+                        if (!frm || frm->width() < TILE_WIDTH + 2 || frm->height() < TILE_HEIGHT + 2)
+                        {
+                            continue;
+                        }
+                        auto frmIndexes = frm->indexes();
+                        for (int y = 0; y != TILE_HEIGHT; ++y)
+                        {
+                            std::memcpy(&images[(i * TILE_HEIGHT + y) * TILE_WIDTH], &frmIndexes[(y + 1) * frm->width() + 1], TILE_WIDTH);
+                        }
+                    }
+                });
 
-            for (uint8_t i = 0; i < _atlases; i++)
+                if (!cachePath.empty())
+                {
+                    _writeCache(cachePath, numbers, images);
+                }
+            }
+
+            // GLES keeps the atlases indexed, a quarter of the memory and bandwidth, and looks colors up in the palette
+            if (Game::Game::getInstance()->renderer()->renderPath() == Graphics::Renderer::RenderPath::GLES2)
             {
-                SDL_Surface* tmp = SDL_CreateRGBSurface(0, Game::Game::getInstance()->renderer()->maxTextureSize(), Game::Game::getInstance()->renderer()->maxTextureSize(), 32, 0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
-                SDL_SetSurfaceBlendMode(tmp, SDL_BLENDMODE_NONE);
-                for (unsigned int j = _tilesPerAtlas*i; j < std::min((uint32_t)numbers.size(), (uint32_t)_tilesPerAtlas*(i + 1)); ++j)
+                std::vector<uint8_t> indexes;
+                for (uint32_t i = 0; i < _atlases; i++)
                 {
-                    auto frm = ResourceManager::getInstance()->frmFileType("art/tiles/" + tilesLst->strings()->at(numbers.at(j)));
-
-                    SDL_Surface* tileSurf = SDL_CreateRGBSurfaceFrom(frm->rgba(ResourceManager::getInstance()->palFileType("color.pal")), 82, 38, 32, 82 * 4, 0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
-                    SDL_SetSurfaceBlendMode(tileSurf, SDL_BLENDMODE_NONE);
-                    int x = (j % maxW) * 80;
-                    int y = (j / maxW) * 36;
-                    SDL_Rect srcrect = { 1,1,80,36 };
-                    SDL_Rect rect = { x,y,80,36 };
-                    SDL_BlitSurface(tileSurf, &srcrect, tmp, &rect);
-                    SDL_FreeSurface(tileSurf);
+                    auto& size = atlasSizes[i];
+                    indexes.assign(static_cast<size_t>(size.width()) * size.height(), 0);
+                    unsigned int first = _tilesPerAtlas*i;
+                    unsigned int count = std::min((uint32_t)numbers.size(), (uint32_t)_tilesPerAtlas*(i + 1)) - first;
+                    parallelFor(count, [&, first](size_t begin, size_t end)
+                    {
+                        for (unsigned int j = first + begin; j != first + end; ++j)
+                        {
+                            unsigned int slot = j % _tilesPerAtlas;
+                            int x = (slot % maxW) * TILE_WIDTH;
+                            int y = (slot / maxW) * TILE_HEIGHT;
+                            for (int row = 0; row != TILE_HEIGHT; ++row)
+                            {
+                                std::memcpy(
+                                    &indexes[(y + row) * size.width() + x],
+                                    &images[(j * TILE_HEIGHT + row) * TILE_WIDTH],
+                                    TILE_WIDTH
+                                );
+                            }
+                        }
+                    });
+                    if (_tilemap != nullptr) {
+                        _tilemap->addTexture(Graphics::Pixels(indexes.data(), size, Graphics::Pixels::Format::Indexed));
+                    }
                 }
+                return;
+            }
+
+            uint32_t palette[256];
+            auto pal = ResourceManager::getInstance()->palFileType("color.pal");
+            for (unsigned i = 0; i != 256; ++i)
+            {
+                palette[i] = *pal->color(i);
+            }
+
+            // atlas pixels are expanded into one buffer which is reused for every upload, tiles by the workers
+            std::vector<uint32_t> pixels;
+            for (uint32_t i = 0; i < _atlases; i++)
+            {
+                auto& size = atlasSizes[i];
+                pixels.assign(static_cast<size_t>(size.width()) * size.height(), 0);
+                unsigned int first = _tilesPerAtlas*i;
+                unsigned int count = std::min((uint32_t)numbers.size(), (uint32_t)_tilesPerAtlas*(i + 1)) - first;
+                parallelFor(count, [&, first](size_t begin, size_t end)
+                {
+                    for (unsigned int j = first + begin; j != first + end; ++j)
+                    {
+                        unsigned int slot = j % _tilesPerAtlas;
+                        int x = (slot % maxW) * TILE_WIDTH;
+                        int y = (slot / maxW) * TILE_HEIGHT;
+                        for (int row = 0; row != TILE_HEIGHT; ++row)
+                        {
+                            Graphics::expandPalette(
+                                &images[(j * TILE_HEIGHT + row) * TILE_WIDTH],
+                                &pixels[(y + row) * size.width() + x],
+                                TILE_WIDTH,
+                                palette
+                            );
+                        }
+                    }
+                });
                 //push new atlas
                 if (_tilemap != nullptr) {
-                    _tilemap->addTexture(tmp);
+                    _tilemap->addTexture(Graphics::Pixels(pixels.data(), size, Graphics::Pixels::Format::RGBA));
+                }
+            }
+        }
+
+        std::string TileMap::_cachePath(const std::vector<unsigned int>& numbers) const
+        {
+            auto resourceManager = ResourceManager::getInstance();
+            if (!Game::Game::getInstance()->settings()->locationCache() || resourceManager->cachePath().empty() || numbers.empty())
+            {
+                return "";
+            }
+
+            // tiles are numbered in the order they appear on the map, equal lists come from the same map and elevation
+            uint64_t hash = 14695981039346656037ULL;
+            for (auto number : numbers)
+            {
+                hash ^= number;
+                hash *= 1099511628211ULL;
+            }
+
+            std::ostringstream path;
+            path << resourceManager->cachePath() << "/tiles-" << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+            return path.str();
+        }
+
+        bool TileMap::_readCache(const std::string& path, const std::vector<unsigned int>& numbers, std::vector<uint8_t>& images) const
+        {
+            std::ifstream stream(path, std::ios_base::binary | std::ios_base::in);
+            if (!stream)
+            {
+                return false;
+            }
+
+            char magic[4];
+            uint32_t version = 0;
+            uint64_t dataStamp = 0;
+            int64_t overridesTime = 0;
+            uint32_t count = 0;
+            if (!stream.read(magic, sizeof(magic)) || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0
+                || !readValue(stream, version) || version != CACHE_VERSION
+                || !readValue(stream, dataStamp) || dataStamp != ResourceManager::getInstance()->dataStamp()
+                || !readValue(stream, overridesTime) || overridesTime != tileOverridesTime()
+                || !readValue(stream, count) || count != numbers.size())
+            {
+                return false;
+            }
+
+            std::vector<uint32_t> cachedNumbers(count);
+            if (!stream.read(reinterpret_cast<char*>(cachedNumbers.data()), count * sizeof(uint32_t))
+                || !std::equal(cachedNumbers.begin(), cachedNumbers.end(), numbers.begin()))
+            {
+                return false;
+            }
+
+            images.resize(static_cast<size_t>(count) * TILE_WIDTH * TILE_HEIGHT);
+            if (!stream.read(reinterpret_cast<char*>(images.data()), images.size()))
+            {
+                images.clear();
+                return false;
+            }
+            logger->info() << "[GAME] Tilemap images loaded from " << path << std::endl;
+            return true;
+        }
+
+        void TileMap::_writeCache(const std::string& path, const std::vector<unsigned int>& numbers, const std::vector<uint8_t>& images) const
+        {
+            // written next to the final file and renamed, so an interrupted write never leaves a broken cache
+            std::string temporaryPath = path + ".tmp";
+            {
+                std::ofstream stream(temporaryPath, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+                if (!stream)
+                {
+                    return;
+                }
+                stream.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+                writeValue(stream, CACHE_VERSION);
+                writeValue(stream, ResourceManager::getInstance()->dataStamp());
+                writeValue(stream, tileOverridesTime());
+                writeValue(stream, static_cast<uint32_t>(numbers.size()));
+                for (auto number : numbers)
+                {
+                    writeValue(stream, static_cast<uint32_t>(number));
                 }
-                //IMG_SavePNG(tmp, "text.png");
-                SDL_FreeSurface(tmp);
+                stream.write(reinterpret_cast<const char*>(images.data()), images.size());
+                if (!stream)
+                {
+                    logger->warning() << "[GAME] Can't write tilemap cache " << temporaryPath << std::endl;
+                    return;
+                }
+            }
+
+            std::error_code error;
+            std::filesystem::rename(temporaryPath, path, error);
+            if (error)
+            {
+                std::filesystem::remove(temporaryPath, error);
             }
         }
 
+        void TileMap::_buildGrid()
+        {
+            _cellStart.clear();
+            _cellSlots.clear();
+            _gridWidth = 0;
+            _gridHeight = 0;
+            _visibilityChanged = true;
+            if (_slots.empty())
+            {
+                return;
+            }
+
+            int minX = _slots.front()->position().x();
+            int minY = _slots.front()->position().y();
+            int maxX = minX;
+            int maxY = minY;
+            for (auto tile : _slots)
+            {
+                minX = std::min(minX, tile->position().x());
+                minY = std::min(minY, tile->position().y());
+                maxX = std::max(maxX, tile->position().x());
+                maxY = std::max(maxY, tile->position().y());
+            }
+            _gridOrigin = Point(minX, minY);
+            _gridWidth = _cellX(maxX) + 1;
+            _gridHeight = _cellY(maxY) + 1;
+
+            // counting sort of slots by cell
+            _cellStart.assign(static_cast<size_t>(_gridWidth) * _gridHeight + 1, 0);
+            for (auto tile : _slots)
+            {
+                _cellStart[_cellY(tile->position().y()) * _gridWidth + _cellX(tile->position().x()) + 1]++;
+            }
+            for (size_t i = 1; i < _cellStart.size(); ++i)
+            {
+                _cellStart[i] += _cellStart[i - 1];
+            }
+            std::vector<uint32_t> next(_cellStart.begin(), _cellStart.end() - 1);
+            _cellSlots.resize(_slots.size());
+            for (uint32_t slot = 0; slot != _slots.size(); ++slot)
+            {
+                auto tile = _slots[slot];
+                _cellSlots[next[_cellY(tile->position().y()) * _gridWidth + _cellX(tile->position().x())]++] = slot;
+            }
+        }
+
+        void TileMap::_buildRegions()
+        {
+            const unsigned int gridSize = 100;
+
+            std::vector<uint32_t> parent(_slots.size());
+            std::iota(parent.begin(), parent.end(), 0);
+            auto find = [&parent](uint32_t slot)
+            {
+                while (parent[slot] != slot)
+                {
+                    parent[slot] = parent[parent[slot]];
+                    slot = parent[slot];
+                }
+                return slot;
+            };
+
+            // every tile is joined with its neighbours to the left and above, those come first in the map order
+            std::vector<int> grid(gridSize * gridSize, -1);
+            uint32_t slot = 0;
+            for (auto& it : _tiles)
+            {
+                auto number = it.first;
+                if (number < gridSize * gridSize)
+                {
+                    grid[number] = static_cast<int>(slot);
+                    int neighbours[2] = {
+                        number % gridSize > 0 ? grid[number - 1] : -1,
+                        number >= gridSize ? grid[number - gridSize] : -1
+                    };
+                    for (auto neighbour : neighbours)
+                    {
+                        if (neighbour >= 0)
+                        {
+                            parent[find(slot)] = find(static_cast<uint32_t>(neighbour));
+                        }
+                    }
+                }
+                ++slot;
+            }
+
+            std::vector<int> regions(_slots.size(), -1);
+            _regionAtlases.clear();
+            for (slot = 0; slot != _slots.size(); ++slot)
+            {
+                int& region = regions[find(slot)];
+                if (region < 0)
+                {
+                    region = static_cast<int>(_regionAtlases.size());
+                    _regionAtlases.emplace_back();
+                }
+                _slots[slot]->setRegion(static_cast<uint32_t>(region));
+
+                auto& atlases = _regionAtlases[region];
+                uint32_t atlas = _slots[slot]->index() / _tilesPerAtlas;
+                if (std::find(atlases.begin(), atlases.end(), atlas) == atlases.end())
+                {
+                    atlases.push_back(atlas);
+                }
+            }
+            _hiddenRegions.assign(_regionAtlases.size(), false);
+            _hidden.clear();
+
+            logger->info() << "[GAME] Tilemap regions " << _regionAtlases.size() << std::endl;
+        }
+
+        void TileMap::_regionChanged(uint32_t region)
+        {
+            for (auto atlas : _regionAtlases[region])
+            {
+                if (atlas < _atlasChanged.size())
+                {
+                    _atlasChanged[atlas] = true;
+                }
+            }
+        }
+
+        int TileMap::_cellX(int x) const
+        {
+            return floorDivide(x - _gridOrigin.x(), TILE_WIDTH);
+        }
+
+        int TileMap::_cellY(int y) const
+        {
+            return floorDivide(y - _gridOrigin.y(), TILE_HEIGHT);
+        }
+
         void TileMap::render()
         {
             if (_tilemap == nullptr) {
                 return;
             }
+            Trace::Scope scope("TileMap::render");
 
             auto camera = Game::Game::getInstance()->locationState()->camera();
-            std::vector<std::vector<GLuint>> indexes;
-            for (uint8_t i = 0; i < _atlases; i++)
+            auto topLeft = camera->topLeft();
+            auto size = camera->size();
+
+            // tiles of the cells left of and above the camera may still reach into it
+            int cells[4] = {
+                std::max(_cellX(topLeft.x()) - 1, 0),
+                std::max(_cellY(topLeft.y()) - 1, 0),
+                std::min(_cellX(topLeft.x() + size.width()), _gridWidth - 1),
+                std::min(_cellY(topLeft.y() + size.height()), _gridHeight - 1)
+            };
+
+            if (_visibilityChanged || !std::equal(cells, cells + 4, _visibleCells))
             {
-                indexes.push_back(std::vector<GLuint>());
+                std::vector<uint32_t> visible;
+                for (int y = cells[1]; y <= cells[3]; ++y)
+                {
+                    for (int x = cells[0]; x <= cells[2]; ++x)
+                    {
+                        auto cell = static_cast<size_t>(y) * _gridWidth + x;
+                        visible.insert(visible.end(), _cellSlots.begin() + _cellStart[cell], _cellSlots.begin() + _cellStart[cell + 1]);
+                    }
+                }
+                // keep the map order, overlapping tile edges are drawn the same way as before
+                std::sort(visible.begin(), visible.end());
+
+                _cameraSlots.assign(_atlases, {});
+                for (auto slot : visible)
+                {
+                    _cameraSlots.at(_slots[slot]->index() / _tilesPerAtlas).push_back(slot);
+                }
+                _atlasChanged.assign(_atlases, true);
+                std::copy(cells, cells + 4, _visibleCells);
+                _visibilityChanged = false;
             }
-            int cnt = 0;
 
-            auto topLeft = camera->topLeft();
-            auto size = camera->size();
-            for (auto& it : _tiles)
+            // tiles of all atlases of a layered tilemap are drawn at once, the whole list changes with any of them
+            if (_tilemap->layered())
             {
-                auto& tile = it.second;
-                const Size tileSize = Size(80, 36);
-                if (tile->enabled() && Rect::intersects(tile->position(), tileSize, topLeft, size))
+                if (std::find(_atlasChanged.begin(), _atlasChanged.end(), true) != _atlasChanged.end())
                 {
-                    uint32_t aIndex = tile->index() / _tilesPerAtlas;
-                    indexes.at(aIndex).push_back(cnt * 4);
-                    indexes.at(aIndex).push_back(cnt * 4 + 1);
-                    indexes.at(aIndex).push_back(cnt * 4 + 2);
-                    indexes.at(aIndex).push_back(cnt * 4 + 3);
-                    indexes.at(aIndex).push_back(cnt * 4 + 2);
-                    indexes.at(aIndex).push_back(cnt * 4 + 1);
+                    std::vector<uint32_t> shown;
+                    for (uint32_t i = 0; i < _atlases; i++)
+                    {
+                        for (auto slot : _cameraSlots[i])
+                        {
+                            if (!_hiddenRegions[_slots[slot]->region()])
+                            {
+                                shown.push_back(slot);
+                            }
+                        }
+                    }
+                    std::sort(shown.begin(), shown.end());
+                    _tilemap->setTiles(0, shown);
+                    _atlasChanged.assign(_atlases, false);
                 }
-                cnt++;
+                _tilemap->render(topLeft, 0);
+                return;
             }
 
             for (uint32_t i = 0; i < _atlases; i++)
             {
-                //render atlas with indexes->at(atlasIndex)
-                if (indexes.at(i).empty()) {
+                if (!_atlasChanged[i])
+                {
                     continue;
                 }
-                _tilemap->render(topLeft, indexes.at(i), i);
+                std::vector<uint32_t> shown;
+                for (auto slot : _cameraSlots[i])
+                {
+                    if (!_hiddenRegions[_slots[slot]->region()])
+                    {
+                        shown.push_back(slot);
+                    }
+                }
+                _tilemap->setTiles(i, shown);
+                _atlasChanged[i] = false;
+            }
+
+            for (uint32_t i = 0; i < _atlases; i++)
+            {
+                _tilemap->render(topLeft, i);
             }
         }
 
@@ -193,11 +655,12 @@ namespace  Falltergeist
 
         void TileMap::enableAll()
         {
-            for (auto& tile : _tiles)
+            for (auto region : _hidden)
             {
-                tile.second->enable();
+                _hiddenRegions[region] = false;
+                _regionChanged(region);
             }
-
+            _hidden.clear();
         }
 
         std::map<unsigned int, std::unique_ptr<Tile>> &TileMap::tiles()
@@ -207,23 +670,17 @@ namespace  Falltergeist
 
         void TileMap::disable(unsigned int num)
         {
-            int x = num % 100;
-            int y = num / 100;
-            _floodDisable(x, y);
-        }
-
-        void TileMap::_floodDisable(int x, int y)
-        {
-            // TODO: this is basic 4-way floodfill
-            // maybe better replace it with scanlines or QuickFill
-            int num = y * 100 + x;
-            if (_tiles.count(num) && _tiles.at(num)->enabled())
+            auto it = _tiles.find(num);
+            if (it == _tiles.end())
             {
-                _tiles.at(num)->disable();
-                _floodDisable(x + 1, y);
-                _floodDisable(x - 1, y);
-                _floodDisable(x, y + 1);
-                _floodDisable(x, y - 1);
+                return;
+            }
+            auto region = it->second->region();
+            if (region < _hiddenRegions.size() && !_hiddenRegions[region])
+            {
+                _hiddenRegions[region] = true;
+                _hidden.push_back(region);
+                _regionChanged(region);
             }
         }
 
@@ -232,21 +689,27 @@ namespace  Falltergeist
             auto camera = Game::Game::getInstance()->locationState()->camera();
 
             auto tilesLst = ResourceManager::getInstance()->lstFileType("art/tiles/tiles.lst");
-            for (auto& it : _tiles)
+            auto point = pos + camera->topLeft();
+            const Size tileSize = Size(TILE_WIDTH, TILE_HEIGHT);
+            for (int y = std::max(_cellY(point.y()) - 1, 0); y <= std::min(_cellY(point.y()), _gridHeight - 1); ++y)
             {
-                auto& tile = it.second;
-                const Size tileSize = Size(80, 36);
-                if (tile->enabled() && Rect::inRect(pos + camera->topLeft(), tile->position(), tileSize))
+                for (int x = std::max(_cellX(point.x()) - 1, 0); x <= std::min(_cellX(point.x()), _gridWidth - 1); ++x)
                 {
-                    auto frm = ResourceManager::getInstance()->frmFileType("art/tiles/" + tilesLst->strings()->at(tile->number()));
-                    auto& mask = frm->mask(ResourceManager::getInstance()->palFileType("color.pal"));
-                    auto position = pos - tile->position() + camera->topLeft() + Point(1, 1);
-
-                    if ((position.y() * 82 + position.x()) > 0 && ((unsigned)(position.y() * 82 + position.x()) < mask.size()))
+                    auto cell = static_cast<size_t>(y) * _gridWidth + x;
+                    for (uint32_t i = _cellStart[cell]; i != _cellStart[cell + 1]; ++i)
                     {
-                        if (mask.at(position.y() * 82 + position.x()))
+                        auto tile = _slots[_cellSlots[i]];
+                        if (!_hiddenRegions[tile->region()] && Rect::inRect(point, tile->position(), tileSize))
                         {
-                            return true;
+                            auto frm = ResourceManager::getInstance()->frmFileType("art/tiles/" + tilesLst->strings()->at(tile->number()));
+                            auto mask = frm->mask(ResourceManager::getInstance()->palFileType("color.pal"));
+                            auto position = point - tile->position() + Point(1, 1);
+
+                            // negative positions wrap around and miss the mask
+                            if (mask->opaque(position.x(), position.y()))
+                            {
+                                return true;
+                            }
                         }
                     }
                 }
@@ -2,6 +2,8 @@
 
 #include <map>
 #include <memory>
+#include <string>
+#include <vector>
 #include "../Graphics/Point.h"
 #include "../Graphics/Rect.h"
 #include "../Graphics/Renderer.h"
@@ -34,12 +36,17 @@ namespace Falltergeist
 
                 void init();
 
+                // Starts loading images of all tiles in the background, init() waits for the pending ones.
+                void prefetch();
+
                 void setInside(bool inside);
 
                 bool inside();
 
+                // Shows every hidden region again
                 void enableAll();
 
+                // Hides the region of the tile with the given number, nothing if there is none
                 void disable(unsigned int num);
 
                 // Tests if there is a non-transparent pixel at the given point.
@@ -50,6 +57,42 @@ namespace Falltergeist
 
                 std::map<unsigned int, std::unique_ptr<Tile>> _tiles;
 
+                // Tiles in the order they were given to the Graphics::Tilemap, built by init()
+                std::vector<Tile*> _slots;
+
+                // Flat grid of tile sized cells over the tile positions. Every tile belongs to the cell containing
+                // its top left corner, so it can only overlap that cell and the next ones to the right and below.
+                // Slots of cell i are _cellSlots[_cellStart[i]] .. _cellSlots[_cellStart[i + 1]]
+                Point _gridOrigin;
+
+                int _gridWidth = 0;
+
+                int _gridHeight = 0;
+
+                std::vector<uint32_t> _cellStart;
+
+                std::vector<uint32_t> _cellSlots;
+
+                // Cells (left, top, right, bottom) the uploaded indexes were built for
+                int _visibleCells[4] = {0, 0, -1, -1};
+
+                // Set when the tiles have to be collected again even if the camera stays in the same cells
+                bool _visibilityChanged = true;
+
+                // Slots in the visible cells by atlas in map order, tiles of hidden regions included
+                std::vector<std::vector<uint32_t>> _cameraSlots;
+
+                // Atlases whose tiles have to be given to the Graphics::Tilemap again
+                std::vector<bool> _atlasChanged;
+
+                // Tiles connected by their edges form a region, a roof is hidden region by region while the player
+                // is under it. Regions are found once by init(), hiding one only touches the atlases it has tiles in
+                std::vector<bool> _hiddenRegions;
+
+                std::vector<uint32_t> _hidden;
+
+                std::vector<std::vector<uint32_t>> _regionAtlases;
+
                 uint32_t _tilesPerAtlas;
 
                 std::unique_ptr<Graphics::Tilemap> _tilemap;
@@ -58,7 +101,25 @@ namespace Falltergeist
 
                 bool _inside = false;
 
-                void _floodDisable(int x, int y);
+                void _buildGrid();
+
+                // Union-find over the tile numbers, which are y * 100 + x on the elevation grid
+                void _buildRegions();
+
+                void _regionChanged(uint32_t region);
+
+                // Cached palette indexes of the unique tiles, kept between runs unless disabled in the settings.
+                // Returns an empty path if there is nothing to cache.
+                std::string _cachePath(const std::vector<unsigned int>& numbers) const;
+
+                bool _readCache(const std::string& path, const std::vector<unsigned int>& numbers, std::vector<uint8_t>& images) const;
+
+                void _writeCache(const std::string& path, const std::vector<unsigned int>& numbers, const std::vector<uint8_t>& images) const;
+
+                // Column and row of the grid cell containing the point, not clamped to the grid
+                int _cellX(int x) const;
+
+                int _cellY(int y) const;
         };
     }
 }
@@ -0,0 +1,507 @@
+#include "../Base/ThreadPool.h"
+#include "../VFS/AsyncReader.h"
+#include "../VFS/MemoryFile.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #define FALLTERGEIST_IO_URING
+    #endif
+#endif
+
+#if defined(FALLTERGEIST_IO_URING)
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#elif defined(_WIN32) || defined(WIN32)
+    #include <windows.h>
+#endif
+
+namespace Falltergeist {
+    namespace VFS {
+        namespace {
+            // Reads the files on a few threads of its own, for platforms without a completion based API
+            class ThreadReader final : public AsyncReader {
+            public:
+                ThreadReader(unsigned int threads) : _pool(threads) {
+                }
+
+                void submit(std::vector<Request> requests) override {
+                    for (auto& request : requests) {
+                        _pool.enqueue([request = std::move(request)]() {
+                            std::ifstream stream(request.path, std::ios_base::binary | std::ios_base::ate);
+                            if (!stream.is_open()) {
+                                request.callback(nullptr);
+                                return;
+                            }
+                            std::vector<unsigned char> data(static_cast<size_t>(stream.tellg()));
+                            stream.seekg(0);
+                            if (!stream.read(reinterpret_cast<char*>(data.data()), data.size())) {
+                                request.callback(nullptr);
+                                return;
+                            }
+                            request.callback(_file(std::move(data)));
+                        });
+                    }
+                }
+
+                const std::string& name() const override {
+                    return _name;
+                }
+
+            private:
+                std::string _name = "threads";
+
+                // destroyed first, it finishes the queued reads
+                Base::ThreadPool _pool;
+            };
+
+#if defined(FALLTERGEIST_IO_URING)
+            class UringReader final : public AsyncReader {
+            public:
+                // nullptr if io_uring isn't available, e.g. on kernels before 5.1 or when it's disabled
+                static std::unique_ptr<UringReader> create(unsigned int queueDepth) {
+                    std::unique_ptr<UringReader> reader(new UringReader());
+                    if (!reader->_setup(queueDepth)) {
+                        return nullptr;
+                    }
+                    reader->_completions = std::thread([reader = reader.get()]() { reader->_complete(); });
+                    return reader;
+                }
+
+                ~UringReader() override {
+                    if (_completions.joinable()) {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _space.wait(lock, [this]() { return _inFlight == 0; });
+                        // wakes up the completion thread
+                        _push(nullptr);
+                        _enter(1);
+                        lock.unlock();
+                        _completions.join();
+                    }
+                    if (_sqes) {
+                        munmap(_sqes, _sqesSize);
+                    }
+                    if (_cqRing && _cqRing != _sqRing) {
+                        munmap(_cqRing, _cqRingSize);
+                    }
+                    if (_sqRing) {
+                        munmap(_sqRing, _sqRingSize);
+                    }
+                    if (_ring >= 0) {
+                        close(_ring);
+                    }
+                }
+
+                void submit(std::vector<Request> requests) override {
+                    // files are opened before taking the lock, the reads of other threads go on meanwhile
+                    std::vector<Read*> reads;
+                    for (auto& request : requests) {
+                        int fd = open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+                        struct stat info;
+                        if (fd < 0 || fstat(fd, &info) != 0) {
+                            if (fd >= 0) {
+                                close(fd);
+                            }
+                            request.callback(nullptr);
+                            continue;
+                        }
+                        if (info.st_size == 0) {
+                            close(fd);
+                            request.callback(_file(std::vector<unsigned char>()));
+                            continue;
+                        }
+                        auto read = new Read();
+                        read->fd = fd;
+                        read->data.resize(static_cast<size_t>(info.st_size));
+                        read->callback = std::move(request.callback);
+                        reads.push_back(read);
+                    }
+
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    unsigned int pushed = 0;
+                    for (auto read : reads) {
+                        if (_inFlight == _entries) {
+                            _enter(pushed);
+                            pushed = 0;
+                            _space.wait(lock, [this]() { return _inFlight < _entries; });
+                        }
+                        _inFlight++;
+                        _push(read);
+                        pushed++;
+                    }
+                    _enter(pushed);
+                }
+
+                const std::string& name() const override {
+                    return _name;
+                }
+
+            private:
+                struct Read {
+                    int fd = -1;
+
+                    std::vector<unsigned char> data;
+
+                    size_t offset = 0;
+
+                    iovec vector;
+
+                    Callback callback;
+                };
+
+                std::string _name = "io_uring";
+
+                int _ring = -1;
+
+                unsigned int _entries = 0;
+
+                void* _sqRing = nullptr;
+
+                size_t _sqRingSize = 0;
+
+                void* _cqRing = nullptr;
+
+                size_t _cqRingSize = 0;
+
+                io_uring_sqe* _sqes = nullptr;
+
+                size_t _sqesSize = 0;
+
+                unsigned int* _sqTail = nullptr;
+
+                unsigned int* _sqMask = nullptr;
+
+                unsigned int* _sqArray = nullptr;
+
+                unsigned int* _cqHead = nullptr;
+
+                unsigned int* _cqTail = nullptr;
+
+                unsigned int* _cqMask = nullptr;
+
+                io_uring_cqe* _cqes = nullptr;
+
+                // guards the submission ring and _inFlight
+                std::mutex _mutex;
+
+                std::condition_variable _space;
+
+                unsigned int _inFlight = 0;
+
+                std::thread _completions;
+
+                UringReader() = default;
+
+                bool _setup(unsigned int queueDepth) {
+                    io_uring_params params;
+                    std::memset(&params, 0, sizeof(params));
+                    _ring = static_cast<int>(syscall(__NR_io_uring_setup, std::max(queueDepth, 1u), &params));
+                    if (_ring < 0) {
+                        return false;
+                    }
+                    _entries = params.sq_entries;
+
+                    _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+                    _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                    bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                    if (singleMmap) {
+                        _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+                    }
+
+                    void* sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring, IORING_OFF_SQ_RING);
+                    if (sqRing == MAP_FAILED) {
+                        return false;
+                    }
+                    _sqRing = sqRing;
+                    _cqRing = _sqRing;
+                    if (!singleMmap) {
+                        void* cqRing = mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring, IORING_OFF_CQ_RING);
+                        if (cqRing == MAP_FAILED) {
+                            _cqRing = nullptr;
+                            return false;
+                        }
+                        _cqRing = cqRing;
+                    }
+                    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+                    void* sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring, IORING_OFF_SQES);
+                    if (sqes == MAP_FAILED) {
+                        return false;
+                    }
+                    _sqes = static_cast<io_uring_sqe*>(sqes);
+
+                    auto sq = static_cast<char*>(_sqRing);
+                    _sqTail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+                    _sqMask = reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+                    _sqArray = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+                    auto cq = static_cast<char*>(_cqRing);
+                    _cqHead = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+                    _cqTail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+                    _cqMask = reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+                    _cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+                    return true;
+                }
+
+                // Puts the rest of the read into the submission ring, a no-op without a read. _mutex has to be held
+                void _push(Read* read) {
+                    unsigned int tail = *_sqTail;
+                    unsigned int index = tail & *_sqMask;
+                    io_uring_sqe& sqe = _sqes[index];
+                    std::memset(&sqe, 0, sizeof(sqe));
+                    if (read) {
+                        read->vector.iov_base = read->data.data() + read->offset;
+                        read->vector.iov_len = read->data.size() - read->offset;
+                        // READV is there since the first io_uring kernel, READ only since 5.6
+                        sqe.opcode = IORING_OP_READV;
+                        sqe.fd = read->fd;
+                        sqe.addr = reinterpret_cast<uint64_t>(&read->vector);
+                        sqe.len = 1;
+                        sqe.off = read->offset;
+                    } else {
+                        sqe.opcode = IORING_OP_NOP;
+                    }
+                    sqe.user_data = reinterpret_cast<uint64_t>(read);
+                    _sqArray[index] = index;
+                    __atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+                }
+
+                // Hands the pushed entries to the kernel, _mutex has to be held
+                void _enter(unsigned int count) {
+                    while (count > 0) {
+                        int submitted = static_cast<int>(syscall(__NR_io_uring_enter, _ring, count, 0, 0, nullptr, 0));
+                        if (submitted < 0) {
+                            if (errno == EINTR) {
+                                continue;
+                            }
+                            // the entries stay in the ring, the next call submits them
+                            return;
+                        }
+                        count -= static_cast<unsigned int>(submitted);
+                    }
+                }
+
+                void _finish(Read* read, bool succeeded) {
+                    close(read->fd);
+                    read->callback(succeeded ? _file(std::move(read->data)) : nullptr);
+                    delete read;
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _inFlight--;
+                    }
+                    _space.notify_all();
+                }
+
+                void _complete() {
+                    std::vector<std::pair<Read*, int>> completed;
+                    while (true) {
+                        if (syscall(__NR_io_uring_enter, _ring, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+                            return;
+                        }
+
+                        unsigned int head = *_cqHead;
+                        unsigned int tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+                        completed.clear();
+                        for (; head != tail; ++head) {
+                            auto& cqe = _cqes[head & *_cqMask];
+                            completed.emplace_back(reinterpret_cast<Read*>(cqe.user_data), cqe.res);
+                        }
+                        __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+
+                        bool stopping = false;
+                        for (auto& completion : completed) {
+                            auto read = completion.first;
+                            int result = completion.second;
+                            if (!read) {
+                                stopping = true;
+                                continue;
+                            }
+                            if (result > 0) {
+                                read->offset += static_cast<size_t>(result);
+                            }
+                            // short reads and interrupted ones go on where they stopped
+                            if ((result > 0 && read->offset < read->data.size()) || result == -EINTR || result == -EAGAIN) {
+                                std::lock_guard<std::mutex> lock(_mutex);
+                                _push(read);
+                                _enter(1);
+                                continue;
+                            }
+                            _finish(read, result > 0);
+                        }
+                        if (stopping) {
+                            return;
+                        }
+                    }
+                }
+            };
+#elif defined(_WIN32) || defined(WIN32)
+            class IocpReader final : public AsyncReader {
+            public:
+                // nullptr if the completion port can't be created
+                static std::unique_ptr<IocpReader> create(unsigned int queueDepth) {
+                    HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+                    if (port == nullptr) {
+                        return nullptr;
+                    }
+                    std::unique_ptr<IocpReader> reader(new IocpReader());
+                    reader->_port = port;
+                    reader->_entries = (std::max)(queueDepth, 1u);
+                    reader->_completions = std::thread([reader = reader.get()]() { reader->_complete(); });
+                    return reader;
+                }
+
+                ~IocpReader() override {
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _space.wait(lock, [this]() { return _inFlight == 0; });
+                    }
+                    // a packet without an overlapped stops the completion thread
+                    PostQueuedCompletionStatus(_port, 0, 0, nullptr);
+                    _completions.join();
+                    CloseHandle(_port);
+                }
+
+                void submit(std::vector<Request> requests) override {
+                    for (auto& request : requests) {
+                        HANDLE file = CreateFileW(request.path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                                  FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+                        LARGE_INTEGER size;
+                        if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size) || CreateIoCompletionPort(file, _port, 0, 0) == nullptr) {
+                            if (file != INVALID_HANDLE_VALUE) {
+                                CloseHandle(file);
+                            }
+                            request.callback(nullptr);
+                            continue;
+                        }
+                        if (size.QuadPart == 0) {
+                            CloseHandle(file);
+                            request.callback(_file(std::vector<unsigned char>()));
+                            continue;
+                        }
+                        auto read = new Read();
+                        read->file = file;
+                        read->data.resize(static_cast<size_t>(size.QuadPart));
+                        read->callback = std::move(request.callback);
+                        {
+                            std::unique_lock<std::mutex> lock(_mutex);
+                            _space.wait(lock, [this]() { return _inFlight < _entries; });
+                            _inFlight++;
+                        }
+                        _start(read);
+                    }
+                }
+
+                const std::string& name() const override {
+                    return _name;
+                }
+
+            private:
+                struct Read {
+                    // first, the completion hands out its address
+                    OVERLAPPED overlapped;
+
+                    HANDLE file = INVALID_HANDLE_VALUE;
+
+                    std::vector<unsigned char> data;
+
+                    size_t offset = 0;
+
+                    Callback callback;
+                };
+
+                // largest single ReadFile, a DWORD can't hold the size of every file
+                static const DWORD MAX_READ = 1 << 30;
+
+                std::string _name = "IOCP";
+
+                HANDLE _port = nullptr;
+
+                unsigned int _entries = 0;
+
+                std::mutex _mutex;
+
+                std::condition_variable _space;
+
+                unsigned int _inFlight = 0;
+
+                std::thread _completions;
+
+                IocpReader() = default;
+
+                void _start(Read* read) {
+                    std::memset(&read->overlapped, 0, sizeof(read->overlapped));
+                    read->overlapped.Offset = static_cast<DWORD>(read->offset & 0xFFFFFFFF);
+                    read->overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(read->offset) >> 32);
+                    DWORD length = static_cast<DWORD>((std::min)(read->data.size() - read->offset, static_cast<size_t>(MAX_READ)));
+                    if (!ReadFile(read->file, read->data.data() + read->offset, length, nullptr, &read->overlapped) && GetLastError() != ERROR_IO_PENDING) {
+                        _finish(read, false);
+                    }
+                }
+
+                void _finish(Read* read, bool succeeded) {
+                    CloseHandle(read->file);
+                    read->callback(succeeded ? _file(std::move(read->data)) : nullptr);
+                    delete read;
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _inFlight--;
+                    }
+                    _space.notify_all();
+                }
+
+                void _complete() {
+                    while (true) {
+                        DWORD bytes = 0;
+                        ULONG_PTR key = 0;
+                        OVERLAPPED* overlapped = nullptr;
+                        BOOL succeeded = GetQueuedCompletionStatus(_port, &bytes, &key, &overlapped, INFINITE);
+                        if (overlapped == nullptr) {
+                            return;
+                        }
+                        auto read = reinterpret_cast<Read*>(overlapped);
+                        if (!succeeded || bytes == 0) {
+                            _finish(read, false);
+                            continue;
+                        }
+                        read->offset += bytes;
+                        if (read->offset < read->data.size()) {
+                            _start(read);
+                            continue;
+                        }
+                        _finish(read, true);
+                    }
+                }
+            };
+#endif
+        }
+
+        std::unique_ptr<AsyncReader> AsyncReader::create(unsigned int queueDepth) {
+#if defined(FALLTERGEIST_IO_URING)
+            if (auto reader = UringReader::create(queueDepth)) {
+                return reader;
+            }
+#elif defined(_WIN32) || defined(WIN32)
+            if (auto reader = IocpReader::create(queueDepth)) {
+                return reader;
+            }
+#endif
+            return std::make_unique<ThreadReader>(2);
+        }
+
+        std::shared_ptr<IFile> AsyncReader::_file(std::vector<unsigned char>&& data) {
+            auto file = std::make_shared<MemoryFile>();
+            file->_data = std::move(data);
+            file->_open(IFile::OpenMode::Read);
+            return file;
+        }
+    }
+}
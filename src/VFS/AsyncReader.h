@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../VFS/IFile.h"
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Falltergeist {
+    namespace VFS {
+        /**
+         * AsyncReader reads whole loose files into memory without blocking the thread which asks for them
+         * Reads go to io_uring on Linux and to an I/O completion port on Windows, so many of them are in flight
+         * at once while no thread waits on any. Elsewhere, or if the kernel refuses, a few threads read them one by one
+         * Callbacks are called on the completion thread of the reader and should only hand the file on,
+         * a file which can't be opened is reported right away on the thread which submitted it
+         */
+        class AsyncReader {
+        public:
+            // Opened file with the whole contents, nullptr if the file couldn't be read
+            typedef std::function<void(std::shared_ptr<IFile> file)> Callback;
+
+            struct Request {
+                std::filesystem::path path;
+
+                Callback callback;
+            };
+
+            // Best backend of the platform which works, with up to queueDepth reads in flight
+            static std::unique_ptr<AsyncReader> create(unsigned int queueDepth);
+
+            // Waits for the reads in flight and calls their callbacks
+            virtual ~AsyncReader() = default;
+
+            // Queues reads of all files at once, waits while queueDepth reads are in flight already
+            virtual void submit(std::vector<Request> requests) = 0;
+
+            virtual const std::string& name() const = 0;
+
+        protected:
+            // Opened memory file which takes over the contents
+            static std::shared_ptr<IFile> _file(std::vector<unsigned char>&& data);
+        };
+    }
+}
@@ -1,11 +1,14 @@
 #include "../VFS/DatArchiveDriver.h"
 #include "../VFS/DatArchiveFile.h"
-#include "../VFS/MemoryFile.h"
-#include "zlib.h"
+#include "../VFS/InflatingFile.h"
 
 namespace Falltergeist {
     namespace VFS {
-        DatArchiveDriver::DatArchiveDriver(const std::string& path) : _name("DatArchiveDriver"), _streamWrapper(DatArchiveStreamWrapper(path)) {
+        DatArchiveDriver::DatArchiveDriver(const std::string& path, std::shared_ptr<DatArchiveIndex> index)
+            : _name("DatArchiveDriver"), _streamWrapper(path), _index(index) {
+            if (!_index) {
+                _index = DatArchiveIndex::load(path);
+            }
         }
 
         const std::string& DatArchiveDriver::name() {
@@ -13,9 +16,12 @@ namespace Falltergeist {
         }
 
         bool DatArchiveDriver::exists(const std::string& path) {
-            std::string unixStylePath = path;
-            std::replace(unixStylePath.begin(), unixStylePath.end(), '\\','/');
-            return _streamWrapper.entries().count(path) != 0;
+            return _index->find(path) != nullptr;
+        }
+
+        uint64_t DatArchiveDriver::offset(const std::string& path) {
+            const DatArchiveEntry* entry = _index->find(path);
+            return entry ? entry->dataOffset : 0;
         }
 
         std::shared_ptr<IFile> DatArchiveDriver::open(const std::string& path, IFile::OpenMode mode) {
@@ -24,46 +30,23 @@ namespace Falltergeist {
                 return nullptr;
             }
 
-            std::string unixStylePath = path;
-            std::replace(unixStylePath.begin(), unixStylePath.end(), '\\','/');
+            const DatArchiveEntry* entryPtr = _index->find(path);
+            if (entryPtr == nullptr) {
+                return nullptr;
+            }
 
-            const DatArchiveEntry& entry = _streamWrapper.entries().at(path);
+            const DatArchiveEntry& entry = *entryPtr;
             if (entry.isCompressed) {
-                unsigned char* packedData = new unsigned char[entry.packedSize];
-                _streamWrapper.seek(entry.dataOffset);
-                _streamWrapper.readBytes(reinterpret_cast<char*>(packedData), entry.packedSize);
-
-                unsigned char* unpackedData = new unsigned char[entry.unpackedSize];
-
-                // unpacking
-                z_stream zStream;
-                zStream.total_in = entry.packedSize;
-                zStream.avail_in = entry.packedSize;
-                zStream.next_in = packedData;
-                zStream.total_out = zStream.avail_out = static_cast<uint32_t>(entry.unpackedSize);
-                zStream.next_out = unpackedData;
-                zStream.zalloc = Z_NULL;
-                zStream.zfree = Z_NULL;
-                zStream.opaque = Z_NULL;
-                inflateInit(&zStream);
-                inflate(&zStream, Z_FINISH);
-                inflateEnd(&zStream);
-
-                delete[] packedData;
-
-                auto file = std::make_shared<MemoryFile>();
-                file->_open(IFile::OpenMode::ReadWriteTruncate);
-                file->write(reinterpret_cast<const char*>(unpackedData), entry.unpackedSize);
-
-                delete[] unpackedData;
-
+                unsigned int dataOffset = entry.dataOffset;
+                auto file = std::make_shared<InflatingFile>(entry.packedSize, entry.unpackedSize, [=](unsigned int position, unsigned char* to, unsigned int size) -> unsigned int {
+                    return _streamWrapper.readBytesAt(dataOffset + position, reinterpret_cast<char*>(to), size);
+                });
                 file->_open(mode);
                 return file;
             }
 
-            auto file = std::make_shared<DatArchiveFile>(entry, [=](unsigned int seekPosition, unsigned char* to, unsigned char size)-> unsigned int {
-                _streamWrapper.seek(seekPosition);
-                return _streamWrapper.readBytes(reinterpret_cast<char*>(to), size);
+            auto file = std::make_shared<DatArchiveFile>(entry, [=](unsigned int seekPosition, unsigned char* to, unsigned int size)-> unsigned int {
+                return _streamWrapper.readBytesAt(seekPosition, reinterpret_cast<char*>(to), size);
             });
             file->_open(mode);
             return file;
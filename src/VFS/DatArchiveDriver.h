@@ -1,9 +1,8 @@
 #pragma once
 
 #include "../VFS/IDriver.h"
-#include "../VFS/DatArchiveEntry.h"
+#include "../VFS/DatArchiveIndex.h"
 #include "../VFS/DatArchiveStreamWrapper.h"
-#include <map>
 #include <memory>
 
 namespace Falltergeist {
@@ -14,7 +13,8 @@ namespace Falltergeist {
          */
         class DatArchiveDriver final : public IDriver {
         public:
-            DatArchiveDriver(const std::string& path);
+            // index is built from the archive if none is given
+            DatArchiveDriver(const std::string& path, std::shared_ptr<DatArchiveIndex> index = nullptr);
 
             ~DatArchiveDriver() override = default;
 
@@ -24,10 +24,14 @@ namespace Falltergeist {
 
             std::shared_ptr<IFile> open(const std::string& path, IFile::OpenMode mode) override;
 
+            uint64_t offset(const std::string& path) override;
+
         private:
             std::string _name;
 
             DatArchiveStreamWrapper _streamWrapper;
+
+            std::shared_ptr<DatArchiveIndex> _index;
         };
     }
 }
@@ -0,0 +1,253 @@
+#include "../VFS/DatArchiveIndex.h"
+#include "../Exception.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Falltergeist {
+    namespace VFS {
+        namespace {
+            const char CACHE_MAGIC[4] = {'F', 'G', 'D', 'I'};
+
+            const uint32_t CACHE_VERSION = 1;
+
+            template<typename T>
+            bool readValue(std::ifstream& stream, T& value) {
+                return (bool) stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+            }
+
+            template<typename T>
+            void writeValue(std::ofstream& stream, const T& value) {
+                stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+        }
+
+        std::shared_ptr<DatArchiveIndex> DatArchiveIndex::load(const std::string& archivePath, const std::string& cachePath) {
+            auto index = std::make_shared<DatArchiveIndex>();
+
+            std::error_code error;
+            uint64_t archiveSize = std::filesystem::file_size(archivePath, error);
+            if (error) {
+                throw Exception("DatArchiveIndex - can't open archive: " + archivePath);
+            }
+            int64_t archiveTime = std::filesystem::last_write_time(archivePath, error).time_since_epoch().count();
+
+            if (!cachePath.empty() && !error && index->_readCache(cachePath, archiveSize, archiveTime)) {
+                return index;
+            }
+
+            std::ifstream stream(archivePath, std::ios_base::binary | std::ios_base::in);
+            if (!stream.is_open()) {
+                throw Exception("DatArchiveIndex - can't open archive: " + archivePath);
+            }
+
+            // footer contains size of files tree and size of the whole archive
+            uint32_t filesTreeSize = 0;
+            uint32_t fileSizeInDatFile = 0;
+            stream.seekg(-8, std::ios_base::end);
+            readValue(stream, filesTreeSize);
+            readValue(stream, fileSizeInDatFile);
+            if (fileSizeInDatFile != archiveSize) {
+                throw Exception("DatArchiveIndex - wrong file size: " + std::to_string(fileSizeInDatFile) +
+                                " should be: " + std::to_string(archiveSize));
+            }
+            if (static_cast<uint64_t>(filesTreeSize) + 8 > archiveSize || filesTreeSize < 4) {
+                throw Exception("DatArchiveIndex - wrong files tree size: " + archivePath);
+            }
+
+            // reading the whole tree at once, it is parsed in memory
+            std::vector<char> filesTree(filesTreeSize);
+            stream.seekg(archiveSize - filesTreeSize - 8, std::ios_base::beg);
+            if (!stream.read(filesTree.data(), filesTreeSize)) {
+                throw Exception("DatArchiveIndex - can't read files tree: " + archivePath);
+            }
+
+            uint32_t filesCount = 0;
+            memcpy(&filesCount, filesTree.data(), sizeof(filesCount));
+            index->_parseFilesTree(filesTree.data() + 4, filesTree.size() - 4, filesCount);
+
+            if (!cachePath.empty() && !error) {
+                index->_writeCache(cachePath, archiveSize, archiveTime);
+            }
+
+            return index;
+        }
+
+        const DatArchiveEntry* DatArchiveIndex::find(const std::string& path) const {
+            std::string normalizedPath = normalizePath(path);
+            uint64_t pathHash = hash(normalizedPath);
+
+            auto it = std::lower_bound(_records.begin(), _records.end(), pathHash, [](const Record& record, uint64_t value) {
+                return record.hash < value;
+            });
+            for (; it != _records.end() && it->hash == pathHash; ++it) {
+                if (_names.compare(it->nameOffset, it->nameSize, normalizedPath) == 0) {
+                    return &it->entry;
+                }
+            }
+            return nullptr;
+        }
+
+        size_t DatArchiveIndex::size() const {
+            return _records.size();
+        }
+
+        std::vector<std::string> DatArchiveIndex::paths() const {
+            std::vector<const Record*> records;
+            records.reserve(_records.size());
+            for (auto& record : _records) {
+                records.push_back(&record);
+            }
+            std::sort(records.begin(), records.end(), [](const Record* a, const Record* b) {
+                return a->entry.dataOffset < b->entry.dataOffset;
+            });
+
+            std::vector<std::string> paths;
+            paths.reserve(records.size());
+            for (auto record : records) {
+                paths.push_back(_names.substr(record->nameOffset, record->nameSize));
+            }
+            return paths;
+        }
+
+        std::string DatArchiveIndex::normalizePath(const std::string& path) {
+            std::string normalizedPath = path;
+            std::replace(normalizedPath.begin(), normalizedPath.end(), '\\', '/');
+            std::transform(normalizedPath.begin(), normalizedPath.end(), normalizedPath.begin(), ::tolower);
+            return normalizedPath;
+        }
+
+        uint64_t DatArchiveIndex::hash(const std::string& normalizedPath) {
+            uint64_t value = 14695981039346656037ULL;
+            for (unsigned char c : normalizedPath) {
+                value ^= c;
+                value *= 1099511628211ULL;
+            }
+            return value;
+        }
+
+        void DatArchiveIndex::_parseFilesTree(const char* filesTree, size_t size, uint32_t filesCount) {
+            // every entry takes at least its name size and the 13 bytes after the name
+            if (filesCount > size / 17) {
+                throw Exception("DatArchiveIndex - wrong files count: " + std::to_string(filesCount));
+            }
+            _records.reserve(filesCount);
+
+            size_t offset = 0;
+            for (uint32_t i = 0; i != filesCount; ++i) {
+                uint32_t filenameSize = 0;
+                // filename size + filename + compression flag + unpacked size + packed size + data offset
+                if (offset + 4 > size) {
+                    throw Exception("DatArchiveIndex - files tree is truncated");
+                }
+                memcpy(&filenameSize, filesTree + offset, 4);
+                offset += 4;
+                if (offset + filenameSize + 13 > size) {
+                    throw Exception("DatArchiveIndex - files tree is truncated");
+                }
+
+                std::string filename = normalizePath(std::string(filesTree + offset, filenameSize));
+                offset += filenameSize;
+
+                Record record{};
+                record.hash = hash(filename);
+                record.nameOffset = static_cast<uint32_t>(_names.size());
+                record.nameSize = filenameSize;
+                record.entry.isCompressed = filesTree[offset] != 0;
+                memcpy(&record.entry.unpackedSize, filesTree + offset + 1, 4);
+                memcpy(&record.entry.packedSize, filesTree + offset + 5, 4);
+                memcpy(&record.entry.dataOffset, filesTree + offset + 9, 4);
+                offset += 13;
+
+                _names += filename;
+                _records.push_back(record);
+            }
+
+            // stable sort keeps the first entry with duplicated name in front, as the original parsers did
+            std::stable_sort(_records.begin(), _records.end(), [](const Record& a, const Record& b) {
+                return a.hash < b.hash;
+            });
+        }
+
+        bool DatArchiveIndex::_readCache(const std::string& cachePath, uint64_t archiveSize, int64_t archiveTime) {
+            std::ifstream stream(cachePath, std::ios_base::binary | std::ios_base::in);
+            if (!stream.is_open()) {
+                return false;
+            }
+
+            char magic[4];
+            uint32_t version = 0;
+            uint64_t cachedSize = 0;
+            int64_t cachedTime = 0;
+            uint32_t recordsCount = 0;
+            uint32_t namesSize = 0;
+            if (!stream.read(magic, sizeof(magic)) || memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0) {
+                return false;
+            }
+            if (!readValue(stream, version) || version != CACHE_VERSION) {
+                return false;
+            }
+            if (!readValue(stream, cachedSize) || !readValue(stream, cachedTime) || cachedSize != archiveSize || cachedTime != archiveTime) {
+                return false;
+            }
+            if (!readValue(stream, recordsCount) || !readValue(stream, namesSize)) {
+                return false;
+            }
+
+            // the counts have to describe the rest of the file exactly before anything is allocated for them
+            std::error_code error;
+            uint64_t cacheSize = std::filesystem::file_size(cachePath, error);
+            uint64_t headerSize = static_cast<uint64_t>(stream.tellg());
+            if (error || cacheSize < headerSize
+                || static_cast<uint64_t>(recordsCount) * sizeof(Record) + namesSize != cacheSize - headerSize) {
+                return false;
+            }
+
+            _records.resize(recordsCount);
+            _names.resize(namesSize);
+            if (!stream.read(reinterpret_cast<char*>(_records.data()), recordsCount * sizeof(Record)) || !stream.read(&_names[0], namesSize)
+                || !_validRecords(archiveSize)) {
+                _records.clear();
+                _names.clear();
+                return false;
+            }
+            return true;
+        }
+
+        bool DatArchiveIndex::_validRecords(uint64_t archiveSize) const {
+            uint64_t previousHash = 0;
+            for (auto& record : _records) {
+                if (static_cast<uint64_t>(record.nameOffset) + record.nameSize > _names.size()) {
+                    return false;
+                }
+                // find() relies on the order and on the hashes of the names
+                if (record.hash < previousHash || record.hash != hash(_names.substr(record.nameOffset, record.nameSize))) {
+                    return false;
+                }
+                previousHash = record.hash;
+                if (static_cast<uint64_t>(record.entry.dataOffset) + record.entry.packedSize > archiveSize) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void DatArchiveIndex::_writeCache(const std::string& cachePath, uint64_t archiveSize, int64_t archiveTime) const {
+            // cache is optional, any failure here just means the archive will be parsed again next time
+            std::ofstream stream(cachePath, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+            if (!stream.is_open()) {
+                return;
+            }
+
+            stream.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+            writeValue(stream, CACHE_VERSION);
+            writeValue(stream, archiveSize);
+            writeValue(stream, archiveTime);
+            writeValue(stream, static_cast<uint32_t>(_records.size()));
+            writeValue(stream, static_cast<uint32_t>(_names.size()));
+            stream.write(reinterpret_cast<const char*>(_records.data()), _records.size() * sizeof(Record));
+            stream.write(_names.data(), _names.size());
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../VFS/DatArchiveEntry.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Falltergeist {
+    namespace VFS {
+        /**
+         * DatArchiveIndex is a compact directory of a vanilla DAT archive
+         * Entries are kept in a flat array sorted by hash of the normalized (lowercase, unix style) path,
+         * so lookup is a binary search over hashes instead of a string map traversal
+         * The index can be persisted to a sidecar cache file keyed by archive size and modification time
+         */
+        class DatArchiveIndex final {
+        public:
+            // Reads index from the cache file if it is up to date, otherwise parses files tree of the archive
+            // and stores the result to the cache file. Empty cachePath disables the cache.
+            static std::shared_ptr<DatArchiveIndex> load(const std::string& archivePath, const std::string& cachePath = "");
+
+            DatArchiveIndex() = default;
+
+            DatArchiveIndex(const DatArchiveIndex& other) = delete;
+
+            DatArchiveIndex& operator=(const DatArchiveIndex& other) = delete;
+
+            // Returns entry by path or nullptr if there is no such entry, path is normalized before the lookup
+            const DatArchiveEntry* find(const std::string& path) const;
+
+            size_t size() const;
+
+            // Normalized paths of all entries ordered by data offset, reading them in order goes through the archive once
+            std::vector<std::string> paths() const;
+
+            static std::string normalizePath(const std::string& path);
+
+            // FNV-1a hash of normalized path
+            static uint64_t hash(const std::string& normalizedPath);
+
+        private:
+            struct Record {
+                uint64_t hash;
+                uint32_t nameOffset;
+                uint32_t nameSize;
+                DatArchiveEntry entry;
+            };
+
+            std::vector<Record> _records;
+
+            // all entry names stored one after another
+            std::string _names;
+
+            void _parseFilesTree(const char* filesTree, size_t size, uint32_t filesCount);
+
+            // Returns false if the cache file is outdated, truncated or corrupt, the archive is parsed again then
+            bool _readCache(const std::string& cachePath, uint64_t archiveSize, int64_t archiveTime);
+
+            // Whether every record read from the cache points into the names and the archive and is in hash order
+            bool _validRecords(uint64_t archiveSize) const;
+
+            void _writeCache(const std::string& cachePath, uint64_t archiveSize, int64_t archiveTime) const;
+        };
+    }
+}
@@ -1,9 +1,8 @@
 #pragma once
 
 #include <fstream>
-#include <stdint.h>
-#include <map>
-#include "../VFS/DatArchiveEntry.h"
+#include <mutex>
+#include <string>
 
 namespace Falltergeist {
     namespace VFS {
@@ -19,22 +18,13 @@ namespace Falltergeist {
 
             unsigned int readBytes(char* destination, unsigned int size);
 
-            const std::map<std::string, DatArchiveEntry>& entries() const;
+            // Reads bytes from the given absolute position, safe to call from multiple threads at once
+            unsigned int readBytesAt(unsigned int position, char* destination, unsigned int size);
 
         private:
-            uint32_t _actualFileSize = 0;
-
-            uint32_t _filesTreeSize = 0;
-
-            uint32_t _filesCount = 0;
-
             std::fstream _stream;
 
-            void _readUint8(uint8_t& dest);
-
-            void _readUint32(uint32_t& dest);
-
-            std::map<std::string, DatArchiveEntry> _entries;
+            std::mutex _streamMutex;
         };
     }
 }
@@ -0,0 +1,89 @@
+#include "../VFS/FileMapping.h"
+#include "../Exception.h"
+
+#if defined(_WIN32) || defined(WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Falltergeist {
+    namespace VFS {
+#if defined(_WIN32) || defined(WIN32)
+        FileMapping::FileMapping(const std::string& path) {
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                throw Exception("FileMapping - can't open file: " + path);
+            }
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+                CloseHandle(file);
+                throw Exception("FileMapping - can't map empty file: " + path);
+            }
+
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping == nullptr) {
+                CloseHandle(file);
+                throw Exception("FileMapping - can't create mapping: " + path);
+            }
+
+            void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (view == nullptr) {
+                CloseHandle(mapping);
+                CloseHandle(file);
+                throw Exception("FileMapping - can't map view of file: " + path);
+            }
+
+            _fileHandle = file;
+            _mappingHandle = mapping;
+            _data = static_cast<const unsigned char*>(view);
+            _size = static_cast<size_t>(fileSize.QuadPart);
+        }
+
+        FileMapping::~FileMapping() {
+            UnmapViewOfFile(_data);
+            CloseHandle(_mappingHandle);
+            CloseHandle(_fileHandle);
+        }
+#else
+        FileMapping::FileMapping(const std::string& path) {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd == -1) {
+                throw Exception("FileMapping - can't open file: " + path);
+            }
+
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) == -1 || fileStat.st_size == 0) {
+                close(fd);
+                throw Exception("FileMapping - can't map empty file: " + path);
+            }
+
+            void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            // The mapping keeps its own reference to the file, descriptor is not needed anymore
+            close(fd);
+            if (view == MAP_FAILED) {
+                throw Exception("FileMapping - can't map file: " + path);
+            }
+
+            _data = static_cast<const unsigned char*>(view);
+            _size = static_cast<size_t>(fileStat.st_size);
+        }
+
+        FileMapping::~FileMapping() {
+            munmap(const_cast<unsigned char*>(_data), _size);
+        }
+#endif
+
+        const unsigned char* FileMapping::data() const {
+            return _data;
+        }
+
+        size_t FileMapping::size() const {
+            return _size;
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace Falltergeist {
+    namespace VFS {
+        /**
+         * FileMapping maps the whole file into memory for read-only access
+         * It uses mmap on POSIX systems and MapViewOfFile on Windows
+         */
+        class FileMapping final {
+        public:
+            FileMapping(const std::string& path);
+
+            FileMapping(const FileMapping& other) = delete;
+
+            FileMapping(FileMapping&& other) = delete;
+
+            FileMapping& operator=(const FileMapping& other) = delete;
+
+            ~FileMapping();
+
+            const unsigned char* data() const;
+
+            size_t size() const;
+
+        private:
+            const unsigned char* _data = nullptr;
+
+            size_t _size = 0;
+
+#if defined(_WIN32) || defined(WIN32)
+            void* _fileHandle = nullptr;
+
+            void* _mappingHandle = nullptr;
+#endif
+        };
+    }
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <filesystem>
 #include <string>
 #include <memory>
 #include "../VFS/IFile.h"
@@ -15,6 +17,18 @@ namespace Falltergeist {
             virtual bool exists(const std::string& path) = 0;
 
             virtual std::shared_ptr<IFile> open(const std::string& path, IFile::OpenMode mode) = 0;
+
+            // Where the data of the file starts in the storage of the driver, reading files in this order seeks the least.
+            // Drivers without a single storage return 0 for all files.
+            virtual uint64_t offset(const std::string&) {
+                return 0;
+            }
+
+            // Real file which holds the data of the file, so it can be read without the driver.
+            // Empty if the file doesn't exist or has no file of its own, e.g. in an archive.
+            virtual std::filesystem::path nativePath(const std::string&) {
+                return std::filesystem::path();
+            }
         };
     }
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 namespace Falltergeist {
     namespace VFS {
         class IDriver;
@@ -38,6 +40,12 @@ namespace Falltergeist {
 
             virtual unsigned int write(const char* from, unsigned int size) = 0;
 
+            // Whole contents of the file if it is already resident in memory, nullptr otherwise.
+            // The returned pointer shares ownership of the backing storage, so it stays valid after the file is closed.
+            virtual std::shared_ptr<const unsigned char> contents() {
+                return nullptr;
+            }
+
         protected:
             friend class IDriver;
 
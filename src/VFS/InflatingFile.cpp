@@ -0,0 +1,154 @@
+#include "../Metrics.h"
+#include "../VFS/InflatingFile.h"
+#include <algorithm>
+#include "zlib.h"
+
+namespace Falltergeist {
+    namespace VFS {
+        namespace {
+            // size of packed data read at once
+            const unsigned int PACKED_CHUNK_SIZE = 16 * 1024;
+        }
+
+        InflatingFile::InflatingFile(unsigned int packedSize, unsigned int unpackedSize, const fnReadBytes& readPackedFunction)
+            : _packedSize(packedSize), _unpackedSize(unpackedSize), _readPackedFunction(readPackedFunction) {
+            _packedChunk.resize(std::min(packedSize, PACKED_CHUNK_SIZE));
+            _zStream = std::make_unique<z_stream>();
+            _zStream->next_in = Z_NULL;
+            _zStream->avail_in = 0;
+            _zStream->zalloc = Z_NULL;
+            _zStream->zfree = Z_NULL;
+            _zStream->opaque = Z_NULL;
+            inflateInit(_zStream.get());
+        }
+
+        InflatingFile::~InflatingFile() {
+            inflateEnd(_zStream.get());
+        }
+
+        unsigned int InflatingFile::size() {
+            return _unpackedSize;
+        }
+
+        void InflatingFile::_open(OpenMode mode) {
+            if (mode != OpenMode::Read) {
+                return;
+            }
+
+            _seekPosition = 0;
+            _isOpened = true;
+        }
+
+        bool InflatingFile::isOpened() {
+            return _isOpened;
+        }
+
+        void InflatingFile::_close() {
+            _isOpened = false;
+        }
+
+        unsigned int InflatingFile::seek(unsigned int position, IFile::SeekFrom seekFrom) {
+            if (!isOpened()) {
+                return 0;
+            }
+
+            if (seekFrom == SeekFrom::Begin) {
+                _seekPosition = position;
+            } else if (seekFrom == SeekFrom::End) {
+                _seekPosition = size() - std::min(position, size());
+            } else {
+                _seekPosition += position;
+            }
+
+            _seekPosition = std::min(_seekPosition, size());
+
+            return tell();
+        }
+
+        unsigned int InflatingFile::tell() {
+            if (!isOpened()) {
+                return 0;
+            }
+            return _seekPosition;
+        }
+
+        unsigned int InflatingFile::read(unsigned char* to, unsigned int size) {
+            if (!isOpened()) {
+                return 0;
+            }
+
+            unsigned int bytesAvailable = std::min(size, this->size() - tell());
+            if (bytesAvailable == 0) {
+                return 0;
+            }
+
+            if (_seekPosition < _unpackedPosition) {
+                _rewind();
+            }
+
+            // unpack and throw away everything up to the current position
+            unsigned char skipBuffer[4096];
+            while (_unpackedPosition < _seekPosition) {
+                unsigned int bytesToSkip = std::min<unsigned int>(sizeof(skipBuffer), _seekPosition - _unpackedPosition);
+                if (_inflate(skipBuffer, bytesToSkip) == 0) {
+                    return 0;
+                }
+            }
+
+            unsigned int bytesRead = _inflate(to, bytesAvailable);
+            _seekPosition += bytesRead;
+
+            return bytesRead;
+        }
+
+        unsigned int InflatingFile::read(char* to, unsigned int size) {
+            return read(reinterpret_cast<unsigned char*>(to), size);
+        }
+
+        unsigned int InflatingFile::write(const char* from, unsigned int size) {
+            // does not support write operations
+            return 0;
+        }
+
+        void InflatingFile::_rewind() {
+            inflateReset(_zStream.get());
+            _zStream->next_in = Z_NULL;
+            _zStream->avail_in = 0;
+            _unpackedPosition = 0;
+            _packedPosition = 0;
+        }
+
+        unsigned int InflatingFile::_inflate(unsigned char* to, unsigned int size) {
+            _zStream->next_out = to;
+            _zStream->avail_out = size;
+            while (_zStream->avail_out > 0) {
+                if (_zStream->avail_in == 0) {
+                    unsigned int packedBytesLeft = _packedSize - _packedPosition;
+                    if (packedBytesLeft == 0) {
+                        break;
+                    }
+                    unsigned int packedChunkSize = std::min<unsigned int>(_packedChunk.size(), packedBytesLeft);
+                    packedChunkSize = _readPackedFunction(_packedPosition, _packedChunk.data(), packedChunkSize);
+                    if (packedChunkSize == 0) {
+                        break;
+                    }
+                    _packedPosition += packedChunkSize;
+                    _zStream->next_in = _packedChunk.data();
+                    _zStream->avail_in = packedChunkSize;
+                }
+                if (inflate(_zStream.get(), Z_NO_FLUSH) != Z_OK) {
+                    // either end of data or broken data
+                    break;
+                }
+            }
+
+            unsigned int bytesUnpacked = size - _zStream->avail_out;
+            _unpackedPosition += bytesUnpacked;
+            if (Metrics::enabled()) {
+                static auto& inflated = Metrics::counter("resources.inflated_bytes");
+                inflated.add(bytesUnpacked);
+            }
+            return bytesUnpacked;
+        }
+    }
+}
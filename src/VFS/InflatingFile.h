@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../VFS/IFile.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct z_stream_s;
+
+namespace Falltergeist {
+    namespace VFS {
+        class DatArchiveDriver;
+        class MappedDatArchiveDriver;
+
+        /**
+         * InflatingFile provides read access to zlib compressed data
+         * Data is unpacked on demand while reading, so only a small chunk of packed data is kept in memory
+         * Seeking backwards restarts unpacking from the beginning
+         */
+        class InflatingFile final : public IFile {
+        public:
+            // reads packed data starting at the given position relative to the beginning of packed data
+            typedef std::function<unsigned int (unsigned int position, unsigned char* to, unsigned int size)> fnReadBytes;
+
+            InflatingFile(unsigned int packedSize, unsigned int unpackedSize, const fnReadBytes& readPackedFunction);
+
+            ~InflatingFile() override;
+
+            unsigned int size() override;
+
+            bool isOpened() override;
+
+            unsigned int seek(unsigned int position, SeekFrom seekFrom) override;
+
+            unsigned int tell() override;
+
+            unsigned int read(unsigned char* to, unsigned int size) override;
+
+            unsigned int read(char* to, unsigned int size) override;
+
+            unsigned int write(const char* from, unsigned int size) override;
+
+        protected:
+            friend class DatArchiveDriver;
+
+            friend class MappedDatArchiveDriver;
+
+            void _open(OpenMode mode) override;
+
+            void _close() override;
+
+        private:
+            bool _isOpened = false;
+
+            unsigned int _packedSize;
+
+            unsigned int _unpackedSize;
+
+            fnReadBytes _readPackedFunction;
+
+            unsigned int _seekPosition = 0;
+
+            // count of bytes unpacked so far
+            unsigned int _unpackedPosition = 0;
+
+            // count of packed bytes passed to zlib so far
+            unsigned int _packedPosition = 0;
+
+            std::vector<unsigned char> _packedChunk;
+
+            std::unique_ptr<z_stream_s> _zStream;
+
+            void _rewind();
+
+            // unpacks next bytes of data, returns count of bytes unpacked
+            unsigned int _inflate(unsigned char* to, unsigned int size);
+        };
+    }
+}
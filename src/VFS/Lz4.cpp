@@ -0,0 +1,160 @@
+#include "../VFS/Lz4.h"
+#include <cstdint>
+#include <cstring>
+
+namespace Falltergeist {
+    namespace VFS {
+        namespace Lz4 {
+            namespace {
+                const size_t MIN_MATCH = 4;
+
+                // the format requires the last bytes of a block to be literals and the last match to start before them
+                const size_t LAST_LITERALS = 5;
+
+                const size_t MATCH_LIMIT = 12;
+
+                const size_t MAX_OFFSET = 65535;
+
+                const unsigned int HASH_BITS = 16;
+
+                uint32_t read32(const unsigned char* data) {
+                    uint32_t value;
+                    std::memcpy(&value, data, sizeof(value));
+                    return value;
+                }
+
+                uint32_t hash(uint32_t sequence) {
+                    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+                }
+
+                void writeLength(size_t length, std::vector<unsigned char>& to) {
+                    for (; length >= 255; length -= 255) {
+                        to.push_back(255);
+                    }
+                    to.push_back(static_cast<unsigned char>(length));
+                }
+
+                void writeSequence(const unsigned char* literals, size_t literalsSize, size_t offset, size_t matchSize, std::vector<unsigned char>& to) {
+                    size_t matchCode = matchSize - MIN_MATCH;
+                    to.push_back(static_cast<unsigned char>(
+                        (literalsSize < 15 ? literalsSize : 15) << 4 | (matchSize == 0 ? 0 : (matchCode < 15 ? matchCode : 15))
+                    ));
+                    if (literalsSize >= 15) {
+                        writeLength(literalsSize - 15, to);
+                    }
+                    to.insert(to.end(), literals, literals + literalsSize);
+                    if (matchSize == 0) {
+                        return;
+                    }
+                    to.push_back(static_cast<unsigned char>(offset & 0xFF));
+                    to.push_back(static_cast<unsigned char>(offset >> 8));
+                    if (matchCode >= 15) {
+                        writeLength(matchCode - 15, to);
+                    }
+                }
+
+                // Reads the rest of a length following a nibble of 15
+                bool readLength(const unsigned char* from, size_t packedSize, size_t& position, size_t& length) {
+                    unsigned char byte;
+                    do {
+                        if (position == packedSize) {
+                            return false;
+                        }
+                        byte = from[position++];
+                        length += byte;
+                    } while (byte == 255);
+                    return true;
+                }
+            }
+
+            size_t compress(const unsigned char* from, size_t size, std::vector<unsigned char>& to) {
+                size_t start = to.size();
+                size_t anchor = 0;
+
+                if (size > MATCH_LIMIT) {
+                    // positions + 1 of the last sequences seen with a hash, 0 for none
+                    std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+                    size_t limit = size - MATCH_LIMIT;
+                    size_t position = 0;
+                    while (position < limit) {
+                        uint32_t sequence = read32(from + position);
+                        uint32_t& slot = table[hash(sequence)];
+                        size_t candidate = slot;
+                        slot = static_cast<uint32_t>(position + 1);
+
+                        if (candidate == 0 || position + 1 - candidate > MAX_OFFSET || read32(from + candidate - 1) != sequence) {
+                            position++;
+                            continue;
+                        }
+                        size_t match = candidate - 1;
+                        size_t matchSize = MIN_MATCH;
+                        while (position + matchSize < size - LAST_LITERALS && from[match + matchSize] == from[position + matchSize]) {
+                            matchSize++;
+                        }
+                        writeSequence(from + anchor, position - anchor, position - match, matchSize, to);
+                        position += matchSize;
+                        anchor = position;
+                    }
+                }
+
+                writeSequence(from + anchor, size - anchor, 0, 0, to);
+                return to.size() - start;
+            }
+
+            bool decompress(const unsigned char* from, size_t packedSize, unsigned char* to, size_t unpackedSize) {
+                size_t position = 0;
+                size_t unpacked = 0;
+                while (position < packedSize) {
+                    unsigned char token = from[position++];
+
+                    size_t literalsSize = token >> 4;
+                    if (literalsSize == 15 && !readLength(from, packedSize, position, literalsSize)) {
+                        return false;
+                    }
+                    if (literalsSize > packedSize - position || literalsSize > unpackedSize - unpacked) {
+                        return false;
+                    }
+                    std::memcpy(to + unpacked, from + position, literalsSize);
+                    position += literalsSize;
+                    unpacked += literalsSize;
+
+                    // the last sequence has no match
+                    if (position == packedSize) {
+                        break;
+                    }
+
+                    if (packedSize - position < 2) {
+                        return false;
+                    }
+                    size_t offset = from[position] | static_cast<size_t>(from[position + 1]) << 8;
+                    position += 2;
+                    if (offset == 0 || offset > unpacked) {
+                        return false;
+                    }
+
+                    size_t matchSize = token & 0x0F;
+                    if (matchSize == 15 && !readLength(from, packedSize, position, matchSize)) {
+                        return false;
+                    }
+                    matchSize += MIN_MATCH;
+                    if (matchSize > unpackedSize - unpacked) {
+                        return false;
+                    }
+
+                    unsigned char* output = to + unpacked;
+                    const unsigned char* match = output - offset;
+                    if (offset >= matchSize) {
+                        std::memcpy(output, match, matchSize);
+                    } else {
+                        // overlapping matches repeat the last offset bytes
+                        for (size_t i = 0; i != matchSize; ++i) {
+                            output[i] = match[i];
+                        }
+                    }
+                    unpacked += matchSize;
+                }
+                return unpacked == unpackedSize;
+            }
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Falltergeist {
+    namespace VFS {
+        /**
+         * Compression in the LZ4 block format, the layout of PackedArchive chunks
+         * The compressor is a greedy single probe matcher, packing takes a while but unpacking is a run of copies
+         */
+        namespace Lz4 {
+            // Appends the compressed block to the vector, returns its size
+            size_t compress(const unsigned char* from, size_t size, std::vector<unsigned char>& to);
+
+            // Returns false unless the block unpacks to exactly unpackedSize bytes
+            bool decompress(const unsigned char* from, size_t packedSize, unsigned char* to, size_t unpackedSize);
+        }
+    }
+}
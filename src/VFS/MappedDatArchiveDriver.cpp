@@ -0,0 +1,65 @@
+#include "../VFS/MappedDatArchiveDriver.h"
+#include "../VFS/FileMapping.h"
+#include "../VFS/InflatingFile.h"
+#include "../VFS/MappedFile.h"
+#include <cstring>
+
+namespace Falltergeist {
+    namespace VFS {
+        MappedDatArchiveDriver::MappedDatArchiveDriver(const std::string& path, std::shared_ptr<DatArchiveIndex> index)
+            : _name("MappedDatArchiveDriver"), _index(index) {
+            _mapping = std::make_shared<FileMapping>(path);
+            if (!_index) {
+                _index = DatArchiveIndex::load(path);
+            }
+        }
+
+        const std::string& MappedDatArchiveDriver::name() {
+            return _name;
+        }
+
+        bool MappedDatArchiveDriver::exists(const std::string& path) {
+            return _index->find(path) != nullptr;
+        }
+
+        uint64_t MappedDatArchiveDriver::offset(const std::string& path) {
+            const DatArchiveEntry* entry = _index->find(path);
+            return entry ? entry->dataOffset : 0;
+        }
+
+        std::shared_ptr<IFile> MappedDatArchiveDriver::open(const std::string& path, IFile::OpenMode mode) {
+            if (mode != IFile::OpenMode::Read) {
+                // Only read operations are supported
+                return nullptr;
+            }
+
+            const DatArchiveEntry* entryPtr = _index->find(path);
+            if (entryPtr == nullptr) {
+                return nullptr;
+            }
+
+            const DatArchiveEntry& entry = *entryPtr;
+            unsigned int storedSize = entry.isCompressed ? entry.packedSize : entry.unpackedSize;
+            if (static_cast<size_t>(entry.dataOffset) + storedSize > _mapping->size()) {
+                return nullptr;
+            }
+
+            const unsigned char* entryData = _mapping->data() + entry.dataOffset;
+
+            if (entry.isCompressed) {
+                // unpacking straight from the mapping
+                auto mapping = _mapping;
+                auto file = std::make_shared<InflatingFile>(entry.packedSize, entry.unpackedSize, [mapping, entryData](unsigned int position, unsigned char* to, unsigned int size) -> unsigned int {
+                    memcpy(to, entryData + position, size);
+                    return size;
+                });
+                file->_open(mode);
+                return file;
+            }
+
+            auto file = std::make_shared<MappedFile>(_mapping, entryData, entry.unpackedSize);
+            file->_open(mode);
+            return file;
+        }
+    }
+}
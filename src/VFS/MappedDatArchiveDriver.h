@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../VFS/IDriver.h"
+#include "../VFS/DatArchiveIndex.h"
+#include <memory>
+#include <string>
+
+namespace Falltergeist {
+    namespace VFS {
+        class FileMapping;
+
+        /**
+         * MappedDatArchiveDriver provides support for vanilla DAT archives through a memory mapping
+         * Uncompressed entries are served as views straight into the mapping without copying,
+         * there is no shared stream position between opened files
+         * It supports only read operations
+         */
+        class MappedDatArchiveDriver final : public IDriver {
+        public:
+            // index is built from the archive if none is given
+            MappedDatArchiveDriver(const std::string& path, std::shared_ptr<DatArchiveIndex> index = nullptr);
+
+            ~MappedDatArchiveDriver() override = default;
+
+            const std::string& name() override;
+
+            bool exists(const std::string& path) override;
+
+            std::shared_ptr<IFile> open(const std::string& path, IFile::OpenMode mode) override;
+
+            uint64_t offset(const std::string& path) override;
+
+        private:
+            std::string _name;
+
+            std::shared_ptr<FileMapping> _mapping;
+
+            std::shared_ptr<DatArchiveIndex> _index;
+        };
+    }
+}
@@ -0,0 +1,91 @@
+#include "../VFS/MappedFile.h"
+#include "../VFS/FileMapping.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Falltergeist {
+    namespace VFS {
+        MappedFile::MappedFile(const std::shared_ptr<FileMapping>& mapping, const unsigned char* data, unsigned int size)
+            : _mapping(mapping), _data(data), _size(size) {
+        }
+
+        unsigned int MappedFile::size() {
+            return _size;
+        }
+
+        void MappedFile::_open(OpenMode mode) {
+            if (mode != OpenMode::Read) {
+                return;
+            }
+
+            _seekPosition = 0;
+            _isOpened = true;
+        }
+
+        bool MappedFile::isOpened() {
+            return _isOpened;
+        }
+
+        void MappedFile::_close() {
+            _isOpened = false;
+        }
+
+        unsigned int MappedFile::seek(unsigned int position, IFile::SeekFrom seekFrom) {
+            if (!isOpened()) {
+                return 0;
+            }
+
+            if (seekFrom == SeekFrom::Begin) {
+                _seekPosition = position;
+            } else if (seekFrom == SeekFrom::End) {
+                _seekPosition = size() - std::min(position, size());
+            } else {
+                _seekPosition += position;
+            }
+
+            _seekPosition = std::min(_seekPosition, size());
+
+            return tell();
+        }
+
+        unsigned int MappedFile::tell() {
+            if (!isOpened()) {
+                return 0;
+            }
+            return _seekPosition;
+        }
+
+        unsigned int MappedFile::read(unsigned char* to, unsigned int size) {
+            if (!isOpened()) {
+                return 0;
+            }
+
+            unsigned int bytesAvailable = std::min(size, this->size() - tell());
+            if (bytesAvailable == 0) {
+                return 0;
+            }
+
+            memcpy(to, _data + tell(), bytesAvailable);
+            _seekPosition += bytesAvailable;
+
+            return bytesAvailable;
+        }
+
+        unsigned int MappedFile::read(char* to, unsigned int size) {
+            return read(reinterpret_cast<unsigned char*>(to), size);
+        }
+
+        unsigned int MappedFile::write(const char* from, unsigned int size) {
+            // does not support write operations
+            return 0;
+        }
+
+        const unsigned char* MappedFile::data() const {
+            return _data;
+        }
+
+        std::shared_ptr<const unsigned char> MappedFile::contents() {
+            return std::shared_ptr<const unsigned char>(_mapping, _data);
+        }
+    }
+}
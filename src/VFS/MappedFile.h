@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../VFS/IFile.h"
+#include <memory>
+
+namespace Falltergeist {
+    namespace VFS {
+        class FileMapping;
+        class MappedDatArchiveDriver;
+        class PackedArchiveDriver;
+
+        /**
+         * MappedFile is a read-only view into a FileMapping
+         * Every instance keeps its own seek position, so views never interfere with each other
+         */
+        class MappedFile final : public IFile {
+        public:
+            MappedFile(const std::shared_ptr<FileMapping>& mapping, const unsigned char* data, unsigned int size);
+
+            ~MappedFile() override = default;
+
+            unsigned int size() override;
+
+            bool isOpened() override;
+
+            unsigned int seek(unsigned int position, SeekFrom seekFrom) override;
+
+            unsigned int tell() override;
+
+            unsigned int read(unsigned char* to, unsigned int size) override;
+
+            unsigned int read(char* to, unsigned int size) override;
+
+            unsigned int write(const char* from, unsigned int size) override;
+
+            // Pointer to the file contents inside of the mapping
+            const unsigned char* data() const;
+
+            // Shares the mapping, no data is copied
+            std::shared_ptr<const unsigned char> contents() override;
+
+        protected:
+            friend class MappedDatArchiveDriver;
+
+            friend class PackedArchiveDriver;
+
+            void _open(OpenMode mode) override;
+
+            void _close() override;
+
+        private:
+            bool _isOpened = false;
+
+            unsigned int _seekPosition = 0;
+
+            std::shared_ptr<FileMapping> _mapping;
+
+            const unsigned char* _data;
+
+            unsigned int _size;
+        };
+    }
+}
@@ -1,3 +1,4 @@
+#include "../VFS/Lz4.h"
 #include "../VFS/MemoryDriver.h"
 
 namespace Falltergeist {
@@ -10,14 +11,22 @@ namespace Falltergeist {
         }
 
         bool MemoryDriver::exists(const std::string& path) {
-            return _files.count(path) != 0;
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _files.count(path) != 0 || _compressedFiles.count(path) != 0;
         }
 
         std::shared_ptr<IFile> MemoryDriver::open(const std::string& path, IFile::OpenMode mode) {
-            if (exists(path)) {
-                auto file = _files.at(path);
-                file->_open(mode);
-                return file;
+            if (mode == IFile::OpenMode::Read) {
+                if (auto file = openCompressed(path)) {
+                    return file;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto fileIt = _files.find(path);
+            if (fileIt != _files.end()) {
+                fileIt->second->_open(mode);
+                return fileIt->second;
             }
 
             std::shared_ptr<MemoryFile> file = std::make_shared<MemoryFile>();
@@ -25,5 +34,83 @@ namespace Falltergeist {
             _files.insert(std::make_pair(path, file));
             return file;
         }
+
+        void MemoryDriver::storeCompressed(const std::string& path, const unsigned char* data, size_t size) {
+            // compressed without holding the lock, the other copies stay available meanwhile
+            std::vector<unsigned char> packed;
+            Lz4::compress(data, size, packed);
+            packed.shrink_to_fit();
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto fileIt = _compressedFiles.find(path);
+            if (fileIt != _compressedFiles.end()) {
+                _compressedSize -= fileIt->second.data.size();
+                _compressedUses.erase(fileIt->second.use);
+                _compressedFiles.erase(fileIt);
+            }
+            if (packed.size() > _compressedBudget) {
+                return;
+            }
+            _compressedUses.push_front(path);
+            _compressedSize += packed.size();
+            _compressedFiles.emplace(path, CompressedFile{std::move(packed), size, _compressedUses.begin()});
+            _trimCompressed();
+        }
+
+        std::shared_ptr<IFile> MemoryDriver::openCompressed(const std::string& path) {
+            auto file = std::make_shared<MemoryFile>();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto fileIt = _compressedFiles.find(path);
+                if (fileIt == _compressedFiles.end()) {
+                    return nullptr;
+                }
+                _compressedUses.splice(_compressedUses.begin(), _compressedUses, fileIt->second.use);
+
+                auto& compressed = fileIt->second;
+                file->_data.resize(compressed.size);
+                if (!Lz4::decompress(compressed.data.data(), compressed.data.size(), file->_data.data(), compressed.size)) {
+                    return nullptr;
+                }
+            }
+            file->_open(IFile::OpenMode::Read);
+            return file;
+        }
+
+        void MemoryDriver::removeCompressed(const std::string& path) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto fileIt = _compressedFiles.find(path);
+            if (fileIt == _compressedFiles.end()) {
+                return;
+            }
+            _compressedSize -= fileIt->second.data.size();
+            _compressedUses.erase(fileIt->second.use);
+            _compressedFiles.erase(fileIt);
+        }
+
+        void MemoryDriver::setCompressedBudget(size_t bytes) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _compressedBudget = bytes;
+            _trimCompressed();
+        }
+
+        size_t MemoryDriver::compressedSize() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _compressedSize;
+        }
+
+        size_t MemoryDriver::compressedCount() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _compressedFiles.size();
+        }
+
+        void MemoryDriver::_trimCompressed() {
+            while (_compressedSize > _compressedBudget && !_compressedUses.empty()) {
+                auto fileIt = _compressedFiles.find(_compressedUses.back());
+                _compressedSize -= fileIt->second.data.size();
+                _compressedFiles.erase(fileIt);
+                _compressedUses.pop_back();
+            }
+        }
     }
 }
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "../VFS/IDriver.h"
 #include "../VFS/MemoryFile.h"
 
@@ -11,6 +15,8 @@ namespace Falltergeist {
          * MemoryDriver provides support for storing/accessing files stored in memory
          * Once file created it will be stored in memory even if it was closed
          * Therefore it can be reopened again without content loss
+         * Besides these it keeps read only copies compressed with LZ4 under a byte budget,
+         * the least recently stored or opened ones are dropped first
          */
         class MemoryDriver final : public IDriver {
         public:
@@ -24,10 +30,48 @@ namespace Falltergeist {
 
             std::shared_ptr<IFile> open(const std::string &path, IFile::OpenMode mode) override;
 
+            // Replaces the compressed copy of the file, nothing is kept if it doesn't fit into the budget
+            void storeCompressed(const std::string& path, const unsigned char* data, size_t size);
+
+            // Unpacks the compressed copy into a new file, nullptr if there is none
+            std::shared_ptr<IFile> openCompressed(const std::string& path);
+
+            void removeCompressed(const std::string& path);
+
+            void setCompressedBudget(size_t bytes);
+
+            // Compressed bytes and number of the compressed copies
+            size_t compressedSize();
+
+            size_t compressedCount();
+
         private:
+            struct CompressedFile {
+                std::vector<unsigned char> data;
+
+                size_t size;
+
+                std::list<std::string>::iterator use;
+            };
+
             std::string _name;
 
             std::map<std::string, std::shared_ptr<MemoryFile>> _files;
+
+            std::unordered_map<std::string, CompressedFile> _compressedFiles;
+
+            // most recently used first
+            std::list<std::string> _compressedUses;
+
+            size_t _compressedSize = 0;
+
+            size_t _compressedBudget = 0;
+
+            // guards the files, the VFS holds its own lock when opening but the compressed copies are managed directly
+            std::mutex _mutex;
+
+            // Drops least recently used copies until the rest fits into the budget, _mutex has to be held
+            void _trimCompressed();
         };
     }
 }
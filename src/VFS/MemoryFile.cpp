@@ -55,7 +55,7 @@ namespace Falltergeist {
                 return 0;
             }
 
-            memcpy(to, _data.data(), bytesAvailable);
+            memcpy(to, _data.data() + tell(), bytesAvailable);
             _seekPosition += bytesAvailable;
 
             return bytesAvailable;
@@ -38,6 +38,8 @@ namespace Falltergeist {
 
             friend class DatArchiveDriver;
 
+            friend class AsyncReader;
+
             void _open(OpenMode mode) override;
 
             void _close() override;
@@ -7,8 +7,8 @@ namespace Falltergeist {
     namespace VFS {
         using Utils::FormattedString;
 
-        NativeDriver::NativeDriver(const std::filesystem::path& basePath, std::shared_ptr<ILogger>(logger))
-            : _name("NativeDriver"), _basePath(basePath), _logger(logger) {
+        NativeDriver::NativeDriver(const std::filesystem::path& basePath, std::shared_ptr<ILogger>(logger), bool readOnly)
+            : _name("NativeDriver"), _basePath(basePath), _logger(logger), _readOnly(readOnly) {
         }
 
         const std::string& NativeDriver::name() {
@@ -22,11 +22,20 @@ namespace Falltergeist {
         }
 
         std::shared_ptr<IFile> NativeDriver::open(const std::string& path, IFile::OpenMode mode) {
+            if (_readOnly && mode != IFile::OpenMode::Read) {
+                return nullptr;
+            }
+
             _logger->debug() << FormattedString("[%s] Opening native file '%s'", name().c_str(), path.c_str()) << std::endl;
             std::filesystem::path fsPath = std::filesystem::absolute(_basePath) / std::filesystem::path(path);
             auto file = std::make_shared<NativeFile>(fsPath);
             file->_open(mode);
             return file;
         }
+
+        std::filesystem::path NativeDriver::nativePath(const std::string& path) {
+            std::filesystem::path fsPath = std::filesystem::absolute(_basePath) / std::filesystem::path(path);
+            return std::filesystem::is_regular_file(fsPath) ? fsPath : std::filesystem::path();
+        }
     }
 }
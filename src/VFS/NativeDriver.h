@@ -10,10 +10,11 @@ namespace Falltergeist {
         /**
          * NativeDriver provides support for accessing real file system path
          * It will search files relative to given basePath
+         * Read only driver refuses to open files for writing
          */
         class NativeDriver final : public IDriver {
         public:
-            NativeDriver(const std::filesystem::path& basePath, std::shared_ptr<ILogger> logger);
+            NativeDriver(const std::filesystem::path& basePath, std::shared_ptr<ILogger> logger, bool readOnly = false);
 
             ~NativeDriver() override = default;
 
@@ -23,12 +24,16 @@ namespace Falltergeist {
 
             std::shared_ptr<IFile> open(const std::string& path, IFile::OpenMode mode) override;
 
+            std::filesystem::path nativePath(const std::string& path) override;
+
         private:
             std::string _name;
 
             std::filesystem::path _basePath;
 
             std::shared_ptr<ILogger> _logger;
+
+            bool _readOnly;
         };
     }
 }
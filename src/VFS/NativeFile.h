@@ -8,6 +8,7 @@
 namespace Falltergeist {
     namespace VFS {
         class NativeDriver;
+        class OverlayDriver;
 
         class NativeFile final : public IFile {
         public:
@@ -32,6 +33,8 @@ namespace Falltergeist {
         protected:
             friend class NativeDriver;
 
+            friend class OverlayDriver;
+
             void _open(OpenMode mode) override;
 
             void _close() override;
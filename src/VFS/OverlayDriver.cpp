@@ -0,0 +1,317 @@
+#include "../VFS/OverlayDriver.h"
+#include "../VFS/DatArchiveIndex.h"
+#include "../VFS/NativeFile.h"
+#include "../Utils/FormattedString.h"
+#include <system_error>
+#include <vector>
+
+#if defined(_WIN32) || defined(WIN32)
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+namespace Falltergeist {
+    namespace VFS {
+        using Utils::FormattedString;
+
+        namespace {
+            // How often the watcher checks whether the driver is being destroyed, in milliseconds
+            const int WATCHER_TIMEOUT = 250;
+
+            std::string normalizePath(const std::filesystem::path& path) {
+                return DatArchiveIndex::normalizePath(path.generic_string());
+            }
+        }
+
+        OverlayDriver::OverlayDriver(const std::filesystem::path& basePath, std::shared_ptr<ILogger> logger)
+            : _name("OverlayDriver"), _logger(logger) {
+            std::error_code error;
+            _basePath = std::filesystem::absolute(basePath, error);
+            if (error || !std::filesystem::is_directory(_basePath, error)) {
+                _logger->warning() << FormattedString("[%s] Directory '%s' does not exist", name().c_str(), basePath.string().c_str()) << std::endl;
+                return;
+            }
+
+            _indexDirectory("");
+            _logger->info() << FormattedString("[%s] Indexed %zu files in '%s'", name().c_str(), _files.size(), _basePath.string().c_str()) << std::endl;
+
+            _watcher = std::thread([this]() { _watch(); });
+        }
+
+        OverlayDriver::~OverlayDriver() {
+            _stopping = true;
+            if (_watcher.joinable()) {
+                _watcher.join();
+            }
+        }
+
+        const std::string& OverlayDriver::name() {
+            return _name;
+        }
+
+        bool OverlayDriver::exists(const std::string& path) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _files.count(DatArchiveIndex::normalizePath(path)) != 0;
+        }
+
+        std::shared_ptr<IFile> OverlayDriver::open(const std::string& path, IFile::OpenMode mode) {
+            if (mode != IFile::OpenMode::Read) {
+                return nullptr;
+            }
+
+            std::filesystem::path fsPath;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _files.find(DatArchiveIndex::normalizePath(path));
+                if (it == _files.end()) {
+                    return nullptr;
+                }
+                fsPath = _basePath / it->second;
+            }
+
+            _logger->debug() << FormattedString("[%s] Opening overlay file '%s'", name().c_str(), path.c_str()) << std::endl;
+            auto file = std::make_shared<NativeFile>(fsPath);
+            file->_open(mode);
+            return file;
+        }
+
+        std::filesystem::path OverlayDriver::nativePath(const std::string& path) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _files.find(DatArchiveIndex::normalizePath(path));
+            return it == _files.end() ? std::filesystem::path() : _basePath / it->second;
+        }
+
+        void OverlayDriver::setChangeHandler(ChangeHandler handler) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _changeHandler = std::move(handler);
+        }
+
+        size_t OverlayDriver::size() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _files.size();
+        }
+
+        void OverlayDriver::_indexDirectory(const std::filesystem::path& relativePath) {
+            std::error_code error;
+            auto options = std::filesystem::directory_options::skip_permission_denied;
+            std::filesystem::recursive_directory_iterator it(_basePath / relativePath, options, error);
+            for (std::filesystem::recursive_directory_iterator end; !error && it != end; it.increment(error)) {
+                if (it->is_regular_file(error)) {
+                    _addFile(std::filesystem::relative(it->path(), _basePath, error));
+                }
+            }
+            if (error) {
+                _logger->warning() << FormattedString("[%s] Can't index directory '%s': %s", name().c_str(), (_basePath / relativePath).string().c_str(), error.message().c_str()) << std::endl;
+            }
+        }
+
+        void OverlayDriver::_removePath(const std::filesystem::path& relativePath) {
+            std::string path = normalizePath(relativePath);
+            std::string directoryPrefix = path + "/";
+
+            // It is not known anymore whether the path was a file or a directory
+            std::vector<std::string> removed;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                for (auto it = _files.begin(); it != _files.end();) {
+                    if (path.empty() || it->first == path || it->first.compare(0, directoryPrefix.size(), directoryPrefix) == 0) {
+                        removed.push_back(it->first);
+                        it = _files.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+
+            for (auto& removedPath : removed) {
+                _notify(removedPath);
+            }
+        }
+
+        void OverlayDriver::_addFile(const std::filesystem::path& relativePath) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _files[normalizePath(relativePath)] = relativePath;
+            }
+            _notify(relativePath);
+        }
+
+        void OverlayDriver::_notify(const std::filesystem::path& relativePath) {
+            ChangeHandler handler;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                handler = _changeHandler;
+            }
+            if (handler) {
+                handler(normalizePath(relativePath));
+            }
+        }
+
+#if defined(__linux__)
+        void OverlayDriver::_watch() {
+            int inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (inotify < 0) {
+                _logger->warning() << FormattedString("[%s] Can't initialize inotify, changes won't be tracked", name().c_str()) << std::endl;
+                return;
+            }
+
+            const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE;
+
+            // inotify is not recursive, every directory needs its own watch
+            std::unordered_map<int, std::filesystem::path> watches;
+            auto watchDirectory = [&](const std::filesystem::path& relativePath) {
+                std::error_code error;
+                auto addWatch = [&](const std::filesystem::path& path) {
+                    int watch = inotify_add_watch(inotify, (_basePath / path).c_str(), mask);
+                    if (watch >= 0) {
+                        watches[watch] = path;
+                    }
+                };
+                addWatch(relativePath);
+                auto options = std::filesystem::directory_options::skip_permission_denied;
+                std::filesystem::recursive_directory_iterator it(_basePath / relativePath, options, error);
+                for (std::filesystem::recursive_directory_iterator end; !error && it != end; it.increment(error)) {
+                    if (it->is_directory(error)) {
+                        addWatch(std::filesystem::relative(it->path(), _basePath, error));
+                    }
+                }
+            };
+            watchDirectory("");
+
+            alignas(struct inotify_event) char buffer[64 * 1024];
+            while (!_stopping) {
+                pollfd descriptor = {inotify, POLLIN, 0};
+                if (poll(&descriptor, 1, WATCHER_TIMEOUT) <= 0) {
+                    continue;
+                }
+
+                ssize_t length = read(inotify, buffer, sizeof(buffer));
+                for (ssize_t offset = 0; offset < length;) {
+                    auto event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+                    offset += sizeof(struct inotify_event) + event->len;
+
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        _logger->warning() << FormattedString("[%s] Change queue overflow, reindexing", name().c_str()) << std::endl;
+                        _removePath("");
+                        _indexDirectory("");
+                        continue;
+                    }
+                    if (event->mask & IN_IGNORED) {
+                        watches.erase(event->wd);
+                        continue;
+                    }
+
+                    auto watchIt = watches.find(event->wd);
+                    if (watchIt == watches.end() || event->len == 0) {
+                        continue;
+                    }
+                    std::filesystem::path path = watchIt->second / event->name;
+
+                    if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                        _removePath(path);
+                    } else if (event->mask & IN_ISDIR) {
+                        // Files could have been created before the watch was added, so index after watching
+                        watchDirectory(path);
+                        _indexDirectory(path);
+                    } else if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        _addFile(path);
+                    } else if (event->mask & IN_CLOSE_WRITE) {
+                        _notify(path);
+                    }
+                }
+            }
+
+            close(inotify);
+        }
+#elif defined(_WIN32) || defined(WIN32)
+        void OverlayDriver::_watch() {
+            HANDLE directory = CreateFileW(
+                _basePath.wstring().c_str(),
+                FILE_LIST_DIRECTORY,
+                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                nullptr,
+                OPEN_EXISTING,
+                FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                nullptr
+            );
+            if (directory == INVALID_HANDLE_VALUE) {
+                _logger->warning() << FormattedString("[%s] Can't watch directory, changes won't be tracked", name().c_str()) << std::endl;
+                return;
+            }
+
+            OVERLAPPED overlapped = {};
+            overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+            const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE;
+            alignas(DWORD) char buffer[64 * 1024];
+            while (!_stopping) {
+                ResetEvent(overlapped.hEvent);
+                if (!ReadDirectoryChangesW(directory, buffer, sizeof(buffer), TRUE, filter, nullptr, &overlapped, nullptr)) {
+                    break;
+                }
+
+                while (!_stopping && WaitForSingleObject(overlapped.hEvent, WATCHER_TIMEOUT) == WAIT_TIMEOUT) {
+                }
+
+                DWORD length = 0;
+                if (_stopping) {
+                    CancelIo(directory);
+                    GetOverlappedResult(directory, &overlapped, &length, TRUE);
+                    break;
+                }
+                if (!GetOverlappedResult(directory, &overlapped, &length, FALSE)) {
+                    break;
+                }
+
+                if (length == 0) {
+                    _logger->warning() << FormattedString("[%s] Change queue overflow, reindexing", name().c_str()) << std::endl;
+                    _removePath("");
+                    _indexDirectory("");
+                    continue;
+                }
+
+                for (DWORD offset = 0;;) {
+                    auto info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+                    std::filesystem::path path(std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+
+                    std::error_code error;
+                    switch (info->Action) {
+                        case FILE_ACTION_ADDED:
+                        case FILE_ACTION_RENAMED_NEW_NAME:
+                            if (std::filesystem::is_directory(_basePath / path, error)) {
+                                _indexDirectory(path);
+                            } else {
+                                _addFile(path);
+                            }
+                            break;
+                        case FILE_ACTION_REMOVED:
+                        case FILE_ACTION_RENAMED_OLD_NAME:
+                            _removePath(path);
+                            break;
+                        case FILE_ACTION_MODIFIED:
+                            if (std::filesystem::is_regular_file(_basePath / path, error)) {
+                                _notify(path);
+                            }
+                            break;
+                    }
+
+                    if (info->NextEntryOffset == 0) {
+                        break;
+                    }
+                    offset += info->NextEntryOffset;
+                }
+            }
+
+            CloseHandle(overlapped.hEvent);
+            CloseHandle(directory);
+        }
+#else
+        void OverlayDriver::_watch() {
+            _logger->info() << FormattedString("[%s] Changes are not tracked on this platform", name().c_str()) << std::endl;
+        }
+#endif
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../VFS/IDriver.h"
+#include "../VFS/IFile.h"
+#include "../ILogger.h"
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace Falltergeist {
+    namespace VFS {
+        /**
+         * OverlayDriver serves loose files from a directory which overrides archived data
+         * The directory is indexed once when the driver is created, lookups don't touch the file system
+         * Paths are matched case insensitively, both '/' and '\' are accepted as separators
+         * A watcher thread keeps the index up to date (inotify on Linux, ReadDirectoryChangesW on Windows),
+         * on other platforms the index is not refreshed
+         * It supports only read operations
+         */
+        class OverlayDriver final : public IDriver {
+        public:
+            // Called from the watcher thread with a normalized path of every added, removed or modified file
+            typedef std::function<void(const std::string& path)> ChangeHandler;
+
+            OverlayDriver(const std::filesystem::path& basePath, std::shared_ptr<ILogger> logger);
+
+            ~OverlayDriver() override;
+
+            const std::string& name() override;
+
+            bool exists(const std::string& path) override;
+
+            std::shared_ptr<IFile> open(const std::string& path, IFile::OpenMode mode) override;
+
+            std::filesystem::path nativePath(const std::string& path) override;
+
+            void setChangeHandler(ChangeHandler handler);
+
+            // Number of indexed files
+            size_t size();
+
+        private:
+            std::string _name;
+
+            std::filesystem::path _basePath;
+
+            std::shared_ptr<ILogger> _logger;
+
+            // normalized relative path -> real relative path
+            std::unordered_map<std::string, std::filesystem::path> _files;
+
+            ChangeHandler _changeHandler;
+
+            // guards _files and _changeHandler
+            std::mutex _mutex;
+
+            std::atomic<bool> _stopping{false};
+
+            std::thread _watcher;
+
+            // Indexes all files below the given directory, relative to the base path
+            void _indexDirectory(const std::filesystem::path& relativePath);
+
+            // Removes the file, or every file below it if it is a directory
+            void _removePath(const std::filesystem::path& relativePath);
+
+            void _addFile(const std::filesystem::path& relativePath);
+
+            void _notify(const std::filesystem::path& relativePath);
+
+            void _watch();
+        };
+    }
+}
@@ -0,0 +1,238 @@
+#include "../VFS/PackedArchiveDriver.h"
+#include "../Exception.h"
+#include "../VFS/DatArchiveIndex.h"
+#include "../VFS/FileMapping.h"
+#include "../VFS/Lz4.h"
+#include "../VFS/MappedFile.h"
+#include "../VFS/PackedFile.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Falltergeist {
+    namespace VFS {
+        namespace {
+            struct Header {
+                char magic[4];
+                uint32_t version;
+                uint32_t chunkSize;
+                uint32_t count;
+                uint64_t archiveSize;
+                int64_t archiveTime;
+                uint64_t directoryOffset;
+                uint32_t chunksCount;
+                uint32_t namesSize;
+            };
+        }
+
+        const char PackedArchiveDriver::MAGIC[4] = {'F', 'G', 'P', 'K'};
+
+        std::unique_ptr<PackedArchiveDriver> PackedArchiveDriver::open(const std::string& packPath, const std::string& archivePath) {
+            std::error_code error;
+            if (!std::filesystem::is_regular_file(packPath, error)) {
+                return nullptr;
+            }
+
+            std::shared_ptr<FileMapping> mapping;
+            try {
+                mapping = std::make_shared<FileMapping>(packPath);
+            } catch (const Exception&) {
+                return nullptr;
+            }
+
+            uint64_t archiveSize;
+            int64_t archiveTime;
+            _stamp(archivePath, archiveSize, archiveTime);
+
+            Header header;
+            if (mapping->size() < sizeof(header)) {
+                return nullptr;
+            }
+            std::memcpy(&header, mapping->data(), sizeof(header));
+            uint64_t directorySize = static_cast<uint64_t>(header.count) * sizeof(Record)
+                + (static_cast<uint64_t>(header.chunksCount) + 1) * sizeof(uint64_t) + header.namesSize;
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.chunkSize == 0
+                || header.archiveSize != archiveSize || header.archiveTime != archiveTime
+                || header.directoryOffset % alignof(Record) != 0 || header.directoryOffset + directorySize > mapping->size()) {
+                return nullptr;
+            }
+
+            std::unique_ptr<PackedArchiveDriver> driver(new PackedArchiveDriver());
+            driver->_chunkSize = header.chunkSize;
+            driver->_records = reinterpret_cast<const Record*>(mapping->data() + header.directoryOffset);
+            driver->_count = header.count;
+            driver->_chunks = reinterpret_cast<const uint64_t*>(driver->_records + header.count);
+            driver->_names = reinterpret_cast<const char*>(driver->_chunks + header.chunksCount + 1);
+
+            // chunks of a truncated pack must not point past the mapping
+            for (size_t i = 0; i != driver->_count; ++i) {
+                auto& record = driver->_records[i];
+                uint64_t chunks = (static_cast<uint64_t>(record.size) + header.chunkSize - 1) / header.chunkSize;
+                if (record.firstChunk + chunks > header.chunksCount || record.nameOffset + record.nameSize > header.namesSize) {
+                    return nullptr;
+                }
+            }
+            for (size_t i = 0; i != header.chunksCount; ++i) {
+                if (driver->_chunks[i] > driver->_chunks[i + 1] || driver->_chunks[i + 1] > header.directoryOffset) {
+                    return nullptr;
+                }
+            }
+            driver->_mapping = mapping;
+            return driver;
+        }
+
+        void PackedArchiveDriver::write(const std::string& packPath, const std::string& archivePath, IDriver& archive, const std::vector<std::string>& paths) {
+            // written next to the final file and renamed, so an interrupted write never leaves a broken pack
+            std::string temporaryPath = packPath + ".tmp";
+            std::ofstream stream(temporaryPath, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+            if (!stream) {
+                throw Exception("PackedArchiveDriver - can't write " + temporaryPath);
+            }
+
+            Header header = {};
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.chunkSize = CHUNK_SIZE;
+            _stamp(archivePath, header.archiveSize, header.archiveTime);
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            std::vector<Record> records;
+            std::vector<uint64_t> chunks;
+            std::string names;
+            std::vector<unsigned char> contents;
+            std::vector<unsigned char> packed;
+            uint64_t offset = sizeof(header);
+            for (auto& path : paths) {
+                auto file = archive.open(path, IFile::OpenMode::Read);
+                if (!file || !file->isOpened()) {
+                    throw Exception("PackedArchiveDriver - can't read " + path);
+                }
+                contents.resize(file->size());
+                if (file->read(contents.data(), file->size()) != file->size()) {
+                    throw Exception("PackedArchiveDriver - can't unpack " + path);
+                }
+
+                std::string normalizedPath = DatArchiveIndex::normalizePath(path);
+                Record record = {};
+                record.hash = DatArchiveIndex::hash(normalizedPath);
+                record.nameOffset = static_cast<uint32_t>(names.size());
+                record.nameSize = static_cast<uint32_t>(normalizedPath.size());
+                record.size = static_cast<uint32_t>(contents.size());
+                record.firstChunk = static_cast<uint32_t>(chunks.size());
+                records.push_back(record);
+                names += normalizedPath;
+
+                for (size_t position = 0; position < contents.size(); position += CHUNK_SIZE) {
+                    size_t chunkSize = std::min<size_t>(CHUNK_SIZE, contents.size() - position);
+                    packed.clear();
+                    // chunks which don't get smaller are stored, PackedFile tells them by their size
+                    if (Lz4::compress(contents.data() + position, chunkSize, packed) >= chunkSize) {
+                        packed.assign(contents.data() + position, contents.data() + position + chunkSize);
+                    }
+                    chunks.push_back(offset);
+                    stream.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+                    offset += packed.size();
+                }
+            }
+            chunks.push_back(offset);
+
+            std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+                return a.hash < b.hash;
+            });
+
+            uint64_t padding = (alignof(Record) - offset % alignof(Record)) % alignof(Record);
+            const char zeros[alignof(Record)] = {};
+            stream.write(zeros, padding);
+
+            header.count = static_cast<uint32_t>(records.size());
+            header.directoryOffset = offset + padding;
+            header.chunksCount = static_cast<uint32_t>(chunks.size() - 1);
+            header.namesSize = static_cast<uint32_t>(names.size());
+            stream.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+            stream.write(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(uint64_t));
+            stream.write(names.data(), names.size());
+            stream.seekp(0);
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.close();
+
+            std::error_code error;
+            if (!stream) {
+                std::filesystem::remove(temporaryPath, error);
+                throw Exception("PackedArchiveDriver - can't write " + temporaryPath);
+            }
+            std::filesystem::rename(temporaryPath, packPath, error);
+            if (error) {
+                std::filesystem::remove(temporaryPath, error);
+                throw Exception("PackedArchiveDriver - can't replace " + packPath + ": " + error.message());
+            }
+        }
+
+        PackedArchiveDriver::~PackedArchiveDriver() = default;
+
+        const std::string& PackedArchiveDriver::name() {
+            return _name;
+        }
+
+        bool PackedArchiveDriver::exists(const std::string& path) {
+            return _find(path) != nullptr;
+        }
+
+        uint64_t PackedArchiveDriver::offset(const std::string& path) {
+            const Record* record = _find(path);
+            return record && record->size != 0 ? _chunks[record->firstChunk] : 0;
+        }
+
+        std::shared_ptr<IFile> PackedArchiveDriver::open(const std::string& path, IFile::OpenMode mode) {
+            if (mode != IFile::OpenMode::Read) {
+                // Only read operations are supported
+                return nullptr;
+            }
+
+            const Record* record = _find(path);
+            if (record == nullptr) {
+                return nullptr;
+            }
+
+            const uint64_t* chunks = _chunks + record->firstChunk;
+
+            // a single stored chunk is a plain view into the pack, its contents are shared without copying
+            if (record->size == 0 || (record->size <= _chunkSize && chunks[1] - chunks[0] == record->size)) {
+                auto file = std::make_shared<MappedFile>(_mapping, _mapping->data() + (record->size == 0 ? 0 : chunks[0]), record->size);
+                file->_open(mode);
+                return file;
+            }
+
+            auto file = std::make_shared<PackedFile>(_mapping, chunks, _chunkSize, record->size);
+            file->_open(mode);
+            return file;
+        }
+
+        const PackedArchiveDriver::Record* PackedArchiveDriver::_find(const std::string& path) const {
+            std::string normalizedPath = DatArchiveIndex::normalizePath(path);
+            uint64_t pathHash = DatArchiveIndex::hash(normalizedPath);
+
+            auto end = _records + _count;
+            auto it = std::lower_bound(_records, end, pathHash, [](const Record& record, uint64_t value) {
+                return record.hash < value;
+            });
+            for (; it != end && it->hash == pathHash; ++it) {
+                if (normalizedPath.compare(0, std::string::npos, _names + it->nameOffset, it->nameSize) == 0) {
+                    return it;
+                }
+            }
+            return nullptr;
+        }
+
+        void PackedArchiveDriver::_stamp(const std::string& archivePath, uint64_t& size, int64_t& time) {
+            std::error_code error;
+            size = std::filesystem::file_size(archivePath, error);
+            if (error) {
+                size = 0;
+            }
+            auto writeTime = std::filesystem::last_write_time(archivePath, error);
+            time = error ? 0 : static_cast<int64_t>(writeTime.time_since_epoch().count());
+        }
+    }
+}
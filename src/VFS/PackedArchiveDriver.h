@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../VFS/IDriver.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Falltergeist {
+    namespace VFS {
+        class FileMapping;
+
+        /**
+         * PackedArchiveDriver reads a DAT archive repacked with LZ4, which unpacks many times faster than zlib
+         * Entries are split into chunks packed on their own with a table of their offsets, so seeking never
+         * unpacks more than one chunk. Paths are looked up like in a DatArchiveIndex
+         * A pack remembers the size and modification time of its DAT file and is only used with that one
+         */
+        class PackedArchiveDriver final : public IDriver {
+        public:
+            // Returns nullptr if there is no pack at the path, it is broken or made from another version of the archive
+            static std::unique_ptr<PackedArchiveDriver> open(const std::string& packPath, const std::string& archivePath);
+
+            // Repacks the files of the archive driver, throws Exception if the pack can't be written
+            static void write(const std::string& packPath, const std::string& archivePath, IDriver& archive, const std::vector<std::string>& paths);
+
+            ~PackedArchiveDriver() override;
+
+            const std::string& name() override;
+
+            bool exists(const std::string& path) override;
+
+            std::shared_ptr<IFile> open(const std::string& path, IFile::OpenMode mode) override;
+
+            uint64_t offset(const std::string& path) override;
+
+        private:
+            static const char MAGIC[4];
+
+            static const uint32_t VERSION = 1;
+
+            // unpacked size of all chunks but the last one of an entry
+            static const uint32_t CHUNK_SIZE = 64 * 1024;
+
+            struct Record {
+                uint64_t hash;
+                uint32_t nameOffset;
+                uint32_t nameSize;
+                uint32_t size;
+                uint32_t firstChunk;
+            };
+
+            PackedArchiveDriver() = default;
+
+            std::string _name = "PackedArchiveDriver";
+
+            std::shared_ptr<FileMapping> _mapping;
+
+            const Record* _records = nullptr;
+
+            size_t _count = 0;
+
+            const uint64_t* _chunks = nullptr;
+
+            const char* _names = nullptr;
+
+            uint32_t _chunkSize = CHUNK_SIZE;
+
+            const Record* _find(const std::string& path) const;
+
+            // Size and modification time of the archive, zero if it doesn't exist
+            static void _stamp(const std::string& archivePath, uint64_t& size, int64_t& time);
+        };
+    }
+}
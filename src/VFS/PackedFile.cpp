@@ -0,0 +1,117 @@
+#include "../VFS/PackedFile.h"
+#include "../VFS/FileMapping.h"
+#include "../VFS/Lz4.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Falltergeist {
+    namespace VFS {
+        PackedFile::PackedFile(const std::shared_ptr<FileMapping>& mapping, const uint64_t* chunks, unsigned int chunkSize, unsigned int size)
+            : _mapping(mapping), _chunks(chunks), _chunkSize(chunkSize), _size(size) {
+        }
+
+        unsigned int PackedFile::size() {
+            return _size;
+        }
+
+        void PackedFile::_open(OpenMode mode) {
+            if (mode != OpenMode::Read) {
+                return;
+            }
+
+            _seekPosition = 0;
+            _isOpened = true;
+        }
+
+        bool PackedFile::isOpened() {
+            return _isOpened;
+        }
+
+        void PackedFile::_close() {
+            _isOpened = false;
+        }
+
+        unsigned int PackedFile::seek(unsigned int position, IFile::SeekFrom seekFrom) {
+            if (!isOpened()) {
+                return 0;
+            }
+
+            if (seekFrom == SeekFrom::Begin) {
+                _seekPosition = position;
+            } else if (seekFrom == SeekFrom::End) {
+                _seekPosition = size() - std::min(position, size());
+            } else {
+                _seekPosition += position;
+            }
+
+            _seekPosition = std::min(_seekPosition, size());
+
+            return tell();
+        }
+
+        unsigned int PackedFile::tell() {
+            if (!isOpened()) {
+                return 0;
+            }
+            return _seekPosition;
+        }
+
+        unsigned int PackedFile::read(unsigned char* to, unsigned int size) {
+            if (!isOpened()) {
+                return 0;
+            }
+
+            unsigned int bytesLeft = std::min(size, this->size() - tell());
+            unsigned int bytesRead = 0;
+            while (bytesLeft > 0) {
+                unsigned int chunk = _seekPosition / _chunkSize;
+                unsigned int chunkPosition = _seekPosition % _chunkSize;
+                unsigned int chunkSize = std::min(_chunkSize, _size - chunk * _chunkSize);
+                unsigned int bytes = std::min(bytesLeft, chunkSize - chunkPosition);
+
+                // whole chunks are unpacked straight to the destination
+                if (chunkPosition == 0 && bytes == chunkSize) {
+                    if (!_unpack(chunk, to + bytesRead)) {
+                        break;
+                    }
+                } else {
+                    if (_unpackedChunk != chunk) {
+                        _chunk.resize(_chunkSize);
+                        _unpackedChunk = _unpack(chunk, _chunk.data()) ? chunk : -1;
+                        if (_unpackedChunk < 0) {
+                            break;
+                        }
+                    }
+                    std::memcpy(to + bytesRead, _chunk.data() + chunkPosition, bytes);
+                }
+
+                _seekPosition += bytes;
+                bytesRead += bytes;
+                bytesLeft -= bytes;
+            }
+            return bytesRead;
+        }
+
+        unsigned int PackedFile::read(char* to, unsigned int size) {
+            return read(reinterpret_cast<unsigned char*>(to), size);
+        }
+
+        unsigned int PackedFile::write(const char* from, unsigned int size) {
+            // does not support write operations
+            return 0;
+        }
+
+        bool PackedFile::_unpack(unsigned int chunk, unsigned char* to) const {
+            unsigned int chunkSize = std::min(_chunkSize, _size - chunk * _chunkSize);
+            const unsigned char* packed = _mapping->data() + _chunks[chunk];
+            uint64_t packedSize = _chunks[chunk + 1] - _chunks[chunk];
+
+            // chunks which don't get smaller are stored as they are
+            if (packedSize == chunkSize) {
+                std::memcpy(to, packed, chunkSize);
+                return true;
+            }
+            return Lz4::decompress(packed, packedSize, to, chunkSize);
+        }
+    }
+}
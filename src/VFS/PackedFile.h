@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../VFS/IFile.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Falltergeist {
+    namespace VFS {
+        class FileMapping;
+        class PackedArchiveDriver;
+
+        /**
+         * PackedFile reads an entry of a PackedArchiveDriver, unpacking the LZ4 chunks it is split into
+         * Any position can be reached by unpacking only the chunk containing it, the last unpacked chunk is kept
+         * for reads which don't cover whole chunks
+         */
+        class PackedFile final : public IFile {
+        public:
+            // chunks holds the offsets of the chunks in the mapping and the offset following the last one
+            PackedFile(const std::shared_ptr<FileMapping>& mapping, const uint64_t* chunks, unsigned int chunkSize, unsigned int size);
+
+            ~PackedFile() override = default;
+
+            unsigned int size() override;
+
+            bool isOpened() override;
+
+            unsigned int seek(unsigned int position, SeekFrom seekFrom) override;
+
+            unsigned int tell() override;
+
+            unsigned int read(unsigned char* to, unsigned int size) override;
+
+            unsigned int read(char* to, unsigned int size) override;
+
+            unsigned int write(const char* from, unsigned int size) override;
+
+        protected:
+            friend class PackedArchiveDriver;
+
+            void _open(OpenMode mode) override;
+
+            void _close() override;
+
+        private:
+            bool _isOpened = false;
+
+            unsigned int _seekPosition = 0;
+
+            std::shared_ptr<FileMapping> _mapping;
+
+            const uint64_t* _chunks;
+
+            unsigned int _chunkSize;
+
+            unsigned int _size;
+
+            std::vector<unsigned char> _chunk;
+
+            // index of the chunk in _chunk, -1 if none
+            int64_t _unpackedChunk = -1;
+
+            // Unpacks the chunk to the buffer which has room for all of its bytes, false if it is broken
+            bool _unpack(unsigned int chunk, unsigned char* to) const;
+        };
+    }
+}
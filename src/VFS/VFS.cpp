@@ -5,12 +5,33 @@ namespace Falltergeist {
     namespace VFS {
         using Utils::FormattedString;
 
+        namespace {
+            // Mount point "" matches every path, otherwise path should start with "<mount point>/"
+            bool matchesMountPoint(const std::string& path, const std::string& mountPoint) {
+                if (mountPoint.empty()) {
+                    return true;
+                }
+                return path.size() > mountPoint.size()
+                    && path.compare(0, mountPoint.size(), mountPoint) == 0
+                    && path[mountPoint.size()] == '/';
+            }
+
+            std::string pathInMountPoint(const std::string& path, const std::string& mountPoint) {
+                return mountPoint.empty() ? path : path.substr(mountPoint.length() + 1);
+            }
+        }
+
         VFS::VFS(std::shared_ptr<ILogger> logger) : _logger(logger) {
         }
 
         void VFS::addMount(const std::string& path, std::unique_ptr<IDriver>&& driver) {
+            std::lock_guard<std::mutex> lock(_mutex);
             _logger->debug() << FormattedString("Mount point '%s' was added with driver '%s'", path.c_str(), driver->name().c_str()) << std::endl;
             _mounts.insert(std::make_pair(path, std::move(driver)));
+
+            // new mount point may change resolution of any path
+            _resolvedPaths.clear();
+            _missingPaths.clear();
         }
 
         void VFS::addMount(const std::string& path, std::unique_ptr<IDriver>& driver) {
@@ -18,62 +39,113 @@ namespace Falltergeist {
         }
 
         bool VFS::exists(const std::string& pathToFile) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _findMount(pathToFile) != _mounts.end();
+        }
+
+        bool VFS::locate(const std::string& path, const IDriver*& driver, uint64_t& offset) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _findMount(path);
+            if (it == _mounts.end()) {
+                return false;
+            }
+            driver = it->second.get();
+            offset = it->second->offset(pathInMountPoint(path, it->first));
+            return true;
+        }
+
+        std::filesystem::path VFS::nativePath(const std::string& path) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _findMount(path);
+            if (it == _mounts.end()) {
+                return std::filesystem::path();
+            }
+            return it->second->nativePath(pathInMountPoint(path, it->first));
+        }
+
+        void VFS::invalidate(const std::string& path) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _resolvedPaths.erase(path);
+            _missingPaths.erase(path);
+        }
+
+        void VFS::invalidateAll() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _resolvedPaths.clear();
+            _missingPaths.clear();
+        }
+
+        VFS::Mounts::iterator VFS::_findMount(const std::string& path) {
+            auto resolvedIt = _resolvedPaths.find(path);
+            if (resolvedIt != _resolvedPaths.end()) {
+                return resolvedIt->second;
+            }
+            if (_missingPaths.count(path) != 0) {
+                return _mounts.end();
+            }
+
             for (auto it = _mounts.begin(); it != _mounts.end(); ++it) {
-                if (it->first.size() && pathToFile.find(it->first) == std::string::npos) {
-                    _logger->debug() << FormattedString(
-                        "Path '%s' does not match mount point '%s'(%s)",
-                        pathToFile.c_str(),
-                        it->first.c_str(),
-                        it->second->name().c_str()
-                    ) << std::endl;
+                if (!matchesMountPoint(path, it->first)) {
                     continue;
                 }
 
-                if (it->second->exists(it->first.size() ? pathToFile.substr(it->first.length()) : pathToFile)) {
+                if (it->second->exists(pathInMountPoint(path, it->first))) {
                     _logger->debug() << FormattedString(
                         "Path '%s' was found in mount point '%s'(%s)",
-                        pathToFile.c_str(),
+                        path.c_str(),
                         it->first.c_str(),
                         it->second->name().c_str()
                     ) << std::endl;
-                    return true;
+                    _resolvedPaths.emplace(path, it);
+                    return it;
                 }
             }
 
             _logger->debug() << FormattedString(
                 "Path '%s' was not found in any mount point",
-                pathToFile.c_str()
+                path.c_str()
             ) << std::endl;
-            return false;
+            _missingPaths.insert(path);
+            return _mounts.end();
         }
 
         std::shared_ptr<IFile> VFS::open(const std::string& path, IFile::OpenMode mode) {
+            std::lock_guard<std::mutex> lock(_mutex);
             if (_openedFiles.count(path) != 0) {
                 return _openedFiles.at(path);
             }
 
-            for (auto it = _mounts.begin(); it != _mounts.end(); ++it) {
-                if (it->first.size() && path.find(it->first) == std::string::npos) {
+            if (mode == IFile::OpenMode::Read || mode == IFile::OpenMode::ReadWrite) {
+                // File should exist in these modes
+                auto it = _findMount(path);
+                if (it == _mounts.end()) {
+                    return nullptr;
+                }
+
+                auto file = it->second->open(pathInMountPoint(path, it->first), mode);
+                if (!file) {
                     _logger->debug() << FormattedString(
-                        "Path '%s' does not match mount point '%s'(%s)",
+                        "Could not open file '%s' in mount point '%s'(%s)",
                         path.c_str(),
                         it->first.c_str(),
                         it->second->name().c_str()
                     ) << std::endl;
-                    continue;
+                    return nullptr;
+                }
+
+                if (mode != IFile::OpenMode::Read) {
+                    _openedFiles.emplace(std::make_pair(path, file));
                 }
+                return file;
+            }
+
+            // file may be created, resolution of the path can change
+            _resolvedPaths.erase(path);
+            _missingPaths.erase(path);
 
-                if (mode == IFile::OpenMode::Read || mode == IFile::OpenMode::ReadWrite) {
-                    // File should exist in these modes
-                    if (!it->second->exists(it->first.size() ? path.substr(it->first.length() + 1) : path)) {
-                        _logger->debug() << FormattedString(
-                            "File '%s' was not found in mount point '%s'(%s)",
-                            path.c_str(),
-                            it->first.c_str(),
-                            it->second->name().c_str()
-                        ) << std::endl;
-                        continue;
-                    }
+            for (auto it = _mounts.begin(); it != _mounts.end(); ++it) {
+                if (!matchesMountPoint(path, it->first)) {
+                    continue;
                 }
 
                 _logger->debug() << FormattedString(
@@ -82,7 +154,7 @@ namespace Falltergeist {
                     it->first.c_str(),
                     it->second->name().c_str()
                 ) << std::endl;
-                auto file = it->second->open(it->first.size() ? path.substr(it->first.length() + 1) : path, mode);
+                auto file = it->second->open(pathInMountPoint(path, it->first), mode);
                 if (file) {
                     _openedFiles.emplace(std::make_pair(path, file));
                     return file;
@@ -97,13 +169,14 @@ namespace Falltergeist {
             }
 
             _logger->debug() << FormattedString(
-                "File '%s' not found in any mount point",
+                "File '%s' can't be opened in any mount point",
                 path.c_str()
             ) << std::endl;
             return nullptr;
         }
 
         void VFS::close(std::shared_ptr<IFile>& file) {
+            std::lock_guard<std::mutex> lock(_mutex);
             file->_close();
 
             for (auto it = _openedFiles.begin(); it != _openedFiles.end(); ++it) {
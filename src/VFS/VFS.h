@@ -3,9 +3,13 @@
 #include "../VFS/IDriver.h"
 #include "../VFS/IFile.h"
 #include "../ILogger.h"
+#include <filesystem>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Falltergeist {
     namespace VFS {
@@ -23,18 +27,46 @@ namespace Falltergeist {
 
             void addMount(const std::string& mountPath, std::unique_ptr<IDriver>& driver);
 
+            // Results of lookups are cached, both found and missing paths, so repeated lookups don't touch drivers again
             bool exists(const std::string& pathToFile);
 
+            // Every file opened in Read mode gets its own handle with independent position,
+            // files opened for writing are shared until closed
             std::shared_ptr<IFile> open(const std::string& path, IFile::OpenMode mode = IFile::OpenMode::Read);
 
+            // Driver which serves the file and where its data starts in it, see IDriver::offset().
+            // Returns false if the file doesn't exist.
+            bool locate(const std::string& path, const IDriver*& driver, uint64_t& offset);
+
+            // Real file which holds the data of the file, see IDriver::nativePath()
+            std::filesystem::path nativePath(const std::string& path);
+
             void close(std::shared_ptr<IFile>& file);
 
+            // Forgets cached lookup result for the path, should be called when files change outside of the VFS
+            void invalidate(const std::string& path);
+
+            void invalidateAll();
+
         private:
-            std::multimap<std::string, std::unique_ptr<IDriver>> _mounts;
+            typedef std::multimap<std::string, std::unique_ptr<IDriver>> Mounts;
+
+            Mounts _mounts;
 
             std::map<std::string, std::shared_ptr<IFile>> _openedFiles;
 
+            // path -> mount point which contains it
+            std::unordered_map<std::string, Mounts::iterator> _resolvedPaths;
+
+            // paths which were not found in any mount point
+            std::unordered_set<std::string> _missingPaths;
+
+            // guards mounts, lookup caches and opened files
+            std::mutex _mutex;
+
             std::shared_ptr<ILogger> _logger;
+
+            Mounts::iterator _findMount(const std::string& path);
         };
     }
 }
@@ -1,6 +1,7 @@
 #include "../../VM/Handler/Opcode80A3Handler.h"
 #include "../../Audio/Mixer.h"
 #include "../../Game/Game.h"
+#include "../../Game/Object.h"
 #include "../../VM/Script.h"
 
 namespace Falltergeist
@@ -18,7 +19,11 @@ namespace Falltergeist
             {
                 logger->debug() << "[80A3] [=] void play_sfx(string* p1)" << std::endl;
                 auto name = _script->dataStack()->popString();
-                Game::Game::getInstance()->mixer()->playACMSound("sound/sfx/" + name + ".acm");
+                if (auto owner = _script->owner()) {
+                    owner->playSound("sound/sfx/" + name + ".acm");
+                } else {
+                    Game::Game::getInstance()->mixer()->playACMSound("sound/sfx/" + name + ".acm");
+                }
             }
         }
     }
@@ -27,10 +27,13 @@ namespace Falltergeist
                 auto position = _script->dataStack()->popInteger();
                 auto game = Game::Game::getInstance();
                 Game::Object *found = nullptr;
-                for (auto object : *game->locationState()->hexagonGrid()->at(position)->objects()) {
-                    if (object->PID() == PID && object->elevation() == elevation) {
-                        found = object;
-                        break;
+                // tiles outside of the grid hold nothing
+                if (auto hexagon = game->locationState()->hexagonGrid()->at(position)) {
+                    for (auto object : *hexagon->objects()) {
+                        if (object->PID() == PID && object->elevation() == elevation) {
+                            found = object;
+                            break;
+                        }
                     }
                 }
                 _script->dataStack()->push(found);
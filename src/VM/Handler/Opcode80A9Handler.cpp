@@ -28,10 +28,13 @@ namespace Falltergeist
                 auto elevation = dataStack->popInteger();
                 auto y = dataStack->popInteger();
                 auto x = dataStack->popInteger();
-                auto position = y * 200 + x;
+                auto position = y * HexagonGrid::MAP_COLUMNS + x;
                 auto game = Game::Game::getInstance();
                 auto player = game->player();
                 auto hexagon = game->locationState()->hexagonGrid()->at(position);
+                if (!hexagon) {
+                    _error("override_map_start - tile " + std::to_string(position) + " is outside of the map");
+                }
                 Game::Game::getInstance()->locationState()->moveObjectToHexagon(player.get(), hexagon);
                 //player->setPosition(position);
                 player->setOrientation(orientation);
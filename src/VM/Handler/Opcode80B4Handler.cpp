@@ -1,6 +1,7 @@
 #include <cstdlib>
 #include <ctime>
 #include "../../VM/Handler/Opcode80B4Handler.h"
+#include "../../Simulation.h"
 #include "../../VM/Script.h"
 
 namespace Falltergeist
@@ -19,7 +20,8 @@ namespace Falltergeist
                 logger->debug() << "[80B4] [+] int rand(int min, int max)" << std::endl;
                 auto max = _script->dataStack()->popInteger();
                 auto min = _script->dataStack()->popInteger();
-                _script->dataStack()->push(rand() % (max - min + 1) + min);
+                _script->dataStack()->push(Simulation::random() % (max - min + 1) + min);
+                _script->setUnrepeatable();
             }
         }
     }
@@ -28,6 +28,9 @@ namespace Falltergeist
                     _error("move_to: object is NULL");
                 }
                 auto hexagon = Game::Game::getInstance()->locationState()->hexagonGrid()->at(position);
+                if (!hexagon) {
+                    _error("move_to: tile " + std::to_string(position) + " is outside of the map");
+                }
                 Game::Game::getInstance()->locationState()->moveObjectToHexagon(object, hexagon);
                 object->setElevation(elevation);
                 if (object == Game::Game::getInstance()->player().get()) {
@@ -24,17 +24,9 @@ namespace Falltergeist
                 auto critter = dynamic_cast<Game::CritterObject *>(object);
                 auto container = dynamic_cast<Game::ContainerItemObject *>(object);
                 if (critter) {
-                    for (auto object : *critter->inventory()) {
-                        if (object->PID() == PID) {
-                            amount += object->amount();
-                        }
-                    }
+                    amount = critter->inventory()->amount(PID);
                 } else if (container) {
-                    for (auto object : *container->inventory()) {
-                        if (object->PID() == PID) {
-                            amount += object->amount();
-                        }
-                    }
+                    amount = container->inventory()->amount(PID);
                 } else {
                     _error("obj_is_carrying_obj_pid - invalid object type");
                 }
@@ -30,9 +30,12 @@ namespace Falltergeist
                 auto position = _script->dataStack()->popInteger();
                 auto game = Game::Game::getInstance();
                 int found = 0;
-                for (auto object : *game->locationState()->hexagonGrid()->at(position)->objects()) {
-                    if (object->PID() == PID && object->elevation() == elevation) {
-                        found = 1;
+                // tiles outside of the grid hold nothing
+                if (auto hexagon = game->locationState()->hexagonGrid()->at(position)) {
+                    for (auto object : *hexagon->objects()) {
+                        if (object->PID() == PID && object->elevation() == elevation) {
+                            found = 1;
+                        }
                     }
                 }
                 _script->dataStack()->push(found);
@@ -18,10 +18,7 @@ namespace Falltergeist
                 logger->debug() << "[80C2] [*] LVAR[num] = value" << std::endl;
                 auto value = _script->dataStack()->pop();
                 unsigned int num = _script->dataStack()->popInteger();
-                while (num >= _script->LVARS()->size()) {
-                    _script->LVARS()->push_back(StackValue(0));
-                }
-                _script->LVARS()->at(num) = value;
+                _script->setLVAR(num, value);
             }
         }
     }
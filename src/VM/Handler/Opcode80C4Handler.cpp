@@ -21,7 +21,7 @@ namespace Falltergeist
                 auto value = _script->dataStack()->popInteger();
                 auto num = _script->dataStack()->popInteger();
                 auto game = Game::Game::getInstance();
-                game->locationState()->setMVAR(num, value);
+                game->locationState()->setMVAR(num, value, _script);
             }
         }
     }
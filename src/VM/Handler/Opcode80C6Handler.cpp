@@ -21,7 +21,7 @@ namespace Falltergeist
                 auto value = _script->dataStack()->popInteger();
                 auto num = _script->dataStack()->popInteger();
                 auto game = Game::Game::getInstance();
-                game->setGVAR(num, value);
+                game->setGVAR(num, value, _script);
                 debug << "    num = " << num << ", value = " << value << std::endl;
             }
         }
@@ -32,17 +32,16 @@ namespace Falltergeist
                 // ANIMATE_INTERRUPT (16) - flag to interrupt current animation
                 auto critter = dynamic_cast<Game::CritterObject *>(object);
                 auto state = Game::Game::getInstance()->locationState();
-                if (state) {
-                    auto tileObj = state->hexagonGrid()->at(tile);
-                    auto path = state->hexagonGrid()->findPath(object->hexagon(), tileObj);
-                    if (path.size()) {
-                        critter->stopMovement();
-                        critter->setRunning((speed & 1) != 0);
-                        auto queue = critter->movementQueue();
-                        for (auto pathHexagon : path) {
-                            queue->push_back(pathHexagon);
+                auto tileObj = state ? state->hexagonGrid()->at(tile) : nullptr;
+                if (critter && tileObj) {
+                    // solved together with the other critters before the next think
+                    state->hexagonGrid()->queuePath(object->hexagon(), tileObj, 100, critter, [critter, speed](std::vector<Hexagon*>& path) {
+                        if (path.size()) {
+                            critter->stopMovement();
+                            critter->setRunning((speed & 1) != 0);
+                            critter->movementQueue()->swap(path);
                         }
-                    }
+                    });
                 }
             }
         }
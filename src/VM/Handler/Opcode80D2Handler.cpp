@@ -21,11 +21,15 @@ namespace Falltergeist
                 logger->debug() << "[80D2] [=] int tile_distance(int tile1, int tile2)" << std::endl;
                 auto tile1 = _script->dataStack()->popInteger();
                 auto tile2 = _script->dataStack()->popInteger();
-                if (tile1 < 0 || tile1 >= 200 * 200 || tile2 < 0 || tile2 >= 200 * 200) {
+                const int tiles = HexagonGrid::MAP_COLUMNS * HexagonGrid::MAP_ROWS;
+                if (tile1 < 0 || tile1 >= tiles || tile2 < 0 || tile2 >= tiles) {
                     _script->dataStack()->push(9999);
                 } else {
+                    // the distance follows from the numbers, the tiles may be outside of the grid
+                    Hexagon hexagon1(tile1);
+                    Hexagon hexagon2(tile2);
                     auto grid = Game::Game::getInstance()->locationState()->hexagonGrid();
-                    auto dist = grid->distance(grid->at(tile1), grid->at(tile2));
+                    auto dist = grid->distance(&hexagon1, &hexagon2);
                     _script->dataStack()->push(dist);
                 }
             }
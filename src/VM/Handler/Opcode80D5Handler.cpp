@@ -34,7 +34,8 @@ namespace Falltergeist
                     dataStack->push(start_tile);
                 } else {
                     auto grid = Game::Game::getInstance()->locationState()->hexagonGrid();
-                    auto hex = grid->hexInDirection(grid->at(start_tile), dir, distance);
+                    auto start = grid->at(start_tile);
+                    auto hex = start ? grid->hexInDirection(start, dir, distance) : nullptr;
                     if (hex) {
                         dataStack->push(hex->number());
 
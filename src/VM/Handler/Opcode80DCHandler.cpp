@@ -1,4 +1,10 @@
+#include <algorithm>
 #include "../../VM/Handler/Opcode80DCHandler.h"
+#include "../../Game/CritterObject.h"
+#include "../../Game/Game.h"
+#include "../../Game/Object.h"
+#include "../../PathFinding/HexagonGrid.h"
+#include "../../State/Location.h"
 #include "../../VM/Script.h"
 
 namespace Falltergeist
@@ -18,8 +24,22 @@ namespace Falltergeist
                     << "[80DC] [=] int obj_can_see_obj(GameObject* src_obj, GameObject* dst_obj)"
                     << std::endl
                 ;
-                _script->dataStack()->popObject();
-                _script->dataStack()->popObject();
+                auto destination = _script->dataStack()->popObject();
+                auto source = _script->dataStack()->popObject();
+                auto state = Game::Game::getInstance()->locationState();
+                if (state && source && destination && source->hexagon() && destination->hexagon()) {
+                    auto grid = state->hexagonGrid();
+                    // critters see as far as five hexagons per point of perception, other objects have no range
+                    if (auto critter = dynamic_cast<Game::CritterObject*>(source)) {
+                        auto range = static_cast<unsigned int>(std::max(critter->statTotal(STAT::PERCEPTION), 0)) * 5;
+                        if (grid->distance(source->hexagon(), destination->hexagon()) > range) {
+                            _script->dataStack()->push(0);
+                            return;
+                        }
+                    }
+                    _script->dataStack()->push(grid->canSee(source->hexagon(), destination->hexagon()) ? 1 : 0);
+                    return;
+                }
                 _script->dataStack()->push(1);
             }
         }
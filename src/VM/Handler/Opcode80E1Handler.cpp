@@ -20,7 +20,7 @@ namespace Falltergeist
                 logger->debug() << "[80E1] [*] int metarule3(int meta, int p1, int p2, int p3)" << std::endl;
                 auto dataStack = _script->dataStack();
 
-                auto arg3 = dataStack->pop();
+                dataStack->pop(); // p3, not used by any implemented metarule
                 auto arg2 = dataStack->pop();
                 auto arg1 = dataStack->pop();
                 auto meta = dataStack->popInteger();
@@ -32,6 +32,9 @@ namespace Falltergeist
                     _error("critter_attempt_placement - invalid critter pointer");
                 }
                 auto hexagon = Game::Game::getInstance()->locationState()->hexagonGrid()->at(position);
+                if (!hexagon) {
+                    _error("critter_attempt_placement - tile " + std::to_string(position) + " is outside of the map");
+                }
                 Game::Game::getInstance()->locationState()->moveObjectToHexagon(critter, hexagon);
                 critter->setElevation(elevation);
                 _script->dataStack()->push(1);
@@ -71,13 +71,8 @@ namespace Falltergeist
                 auto string = _script->dataStack()->popString();
                 auto object = _script->dataStack()->popObject();
 
-                auto floatMessage = std::make_unique<UI::TextArea>(string);
-                floatMessage->setWidth(200);
-                floatMessage->setWordWrap(true);
-                floatMessage->setHorizontalAlign(UI::TextArea::HorizontalAlign::CENTER);
-                floatMessage->setOutlineColor({0x00, 0x00, 0x00, 0xFF});
-                floatMessage->setFont("font1.aaf", color);
-                object->setFloatMessage(std::move(floatMessage));
+                object->setFloatMessage(string, color);
+                _script->setUnrepeatable();
 
             }
         }
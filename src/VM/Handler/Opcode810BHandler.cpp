@@ -42,31 +42,30 @@ namespace Falltergeist
                         if (auto critter = dynamic_cast<Game::CritterObject *>(object)) {
                             logger->info() << "Triggered critter PID = " << critter->PID() << std::endl;
 
-                            bool found = false;
-                            for (int i = 1; i < 6; i++) {
-                                if (!found) {
-                                    auto hexagons = Game::Game::getInstance()->locationState()->hexagonGrid()->ring(critter->hexagon(), i);
-
-                                    for (auto hexagon: hexagons) {
-                                        if (!found) {
-                                            auto position = hexagon->number();
-                                            auto objects = Game::Game::getInstance()->locationState()->hexagonGrid()->at(position)->objects();
-
-                                            for (auto object : *objects) {
-                                                if (object->type() == Game::Object::Type::SCENERY && object->PID() == PID_ELEVATOR_STUB) {
-                                                    if (auto elevatorStub = dynamic_cast<Game::ElevatorSceneryObject *>(object)) {
-                                                        logger->info() << "[ELEVATOR] stub found: type = " << (uint32_t)elevatorStub->elevatorType() << " level = " << (uint32_t)elevatorStub->elevatorLevel() << std::endl;
-                                                        found = true;
-                                                        auto elevatorDialog = new State::ElevatorDialog(std::make_shared<UI::ResourceManager>(), this->logger, elevatorStub->elevatorType(), elevatorStub->elevatorLevel());
-                                                        Game::Game::getInstance()->pushState(elevatorDialog);
-                                                    }
-                                                }
-                                            }        
-                                        }
+                            // the nearest stub within 5 hexagons
+                            auto location = Game::Game::getInstance()->locationState();
+                            std::vector<Game::Object*> nearby;
+                            location->objectsInRadius(critter->hexagon(), 5, nearby);
+                            Game::ElevatorSceneryObject* elevatorStub = nullptr;
+                            unsigned int nearest = 0;
+                            for (auto object : nearby) {
+                                if (object->type() != Game::Object::Type::SCENERY || object->PID() != PID_ELEVATOR_STUB) {
+                                    continue;
+                                }
+                                auto distance = location->hexagonGrid()->distance(critter->hexagon(), object->hexagon());
+                                if (auto stub = dynamic_cast<Game::ElevatorSceneryObject *>(object)) {
+                                    if (!elevatorStub || distance < nearest) {
+                                        elevatorStub = stub;
+                                        nearest = distance;
                                     }
                                 }
                             }
-                        } 
+                            if (elevatorStub) {
+                                logger->info() << "[ELEVATOR] stub found: type = " << (uint32_t)elevatorStub->elevatorType() << " level = " << (uint32_t)elevatorStub->elevatorLevel() << std::endl;
+                                auto elevatorDialog = new State::ElevatorDialog(std::make_shared<UI::ResourceManager>(), this->logger, elevatorStub->elevatorType(), elevatorStub->elevatorLevel());
+                                Game::Game::getInstance()->pushState(elevatorDialog);
+                            }
+                        }
 
                         result = -1;
                         break;
@@ -22,9 +22,9 @@ namespace Falltergeist
                 const int pid = _script->dataStack()->popInteger();
                 auto who = _script->dataStack()->popObject();
 
-                auto findItem = [&](std::vector<Game::ItemObject *> *container) -> Game::ItemObject* {
+                auto findItem = [&](Game::Inventory *container) -> Game::ItemObject* {
                     auto iterator = std::find_if(container->begin(), container->end(),
-                                                 [&](Game::ItemObject *&item) { return item->PID() == pid; });
+                                                 [&](Game::ItemObject *item) { return item->PID() == pid; });
                     if (iterator != container->end()) {
                         return *iterator;
                     } else {
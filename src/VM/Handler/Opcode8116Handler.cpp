@@ -34,7 +34,7 @@ namespace Falltergeist
 
                 item->setAmount(amount);
                 // who can be critter or container
-                std::vector<Game::ItemObject *> *inven = nullptr;
+                Game::Inventory *inven = nullptr;
                 if (auto critterObj = dynamic_cast<Game::CritterObject *>(invenObj)) {
                     inven = critterObj->inventory();
                 } else if (auto contObj = dynamic_cast<Game::ContainerItemObject *>(invenObj)) {
@@ -22,10 +22,10 @@ namespace Falltergeist
                 // TODO: error checking
                 auto to_index = _script->dataStack()->popInteger();
                 auto from_index = _script->dataStack()->popInteger();
-                auto grid = Game::Game::getInstance()->locationState()->hexagonGrid();
-                auto from_hex = grid->at(from_index);
-                auto to_hex = grid->at(to_index);
-                unsigned int rotation = from_hex->orientationTo(to_hex);
+                // only the positions are needed, the tiles may be outside of the grid
+                Hexagon from_hex(from_index);
+                Hexagon to_hex(to_index);
+                unsigned int rotation = from_hex.orientationTo(&to_hex);
                 _script->dataStack()->push(rotation);
             }
         }
@@ -16,8 +16,9 @@ namespace Falltergeist
 
             void Opcode9001::_run()
             {
-                unsigned int data = _script->script()->readValue();
-                unsigned short nextOpcode = _script->script()->readOpcode();
+                auto& instruction = _script->script()->instruction(_offset);
+                unsigned int data = instruction.operand;
+                unsigned short nextOpcode = _script->script()->instruction(_offset + instruction.length).opcode;
 
                 // Skip 4 readed bytes
                 _script->setProgramCounter(_script->programCounter() + 4);
@@ -27,11 +28,11 @@ namespace Falltergeist
                     case 0x8015: // set exported var value
                     case 0x8016: // export var
                     {
-                        _script->dataStack()->push(_script->script()->identifiers().at(data));
+                        _script->dataStack()->push(StackValue(_script->script()->identifiers().at(data)));
                         break;
                     }
                     default: {
-                        _script->dataStack()->push(_script->script()->strings().at(data));
+                        _script->dataStack()->push(StackValue(_script->script()->strings().at(data)));
                         break;
                     }
                 }
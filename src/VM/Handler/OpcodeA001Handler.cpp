@@ -21,7 +21,7 @@ namespace Falltergeist
                     float fValue;
                 } uValue;
 
-                uValue.iValue = _script->script()->readValue();
+                uValue.iValue = _script->script()->instruction(_offset).operand;
 
                 // Skip 4 bytes for read float value
                 _script->setProgramCounter(_script->programCounter() + 4);
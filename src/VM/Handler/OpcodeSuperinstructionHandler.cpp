@@ -0,0 +1,58 @@
+#include "../../VM/Handler/OpcodeSuperinstructionHandler.h"
+#include "../../Format/Int/File.h"
+#include "../../VM/Script.h"
+#include "../../VM/StackValue.h"
+
+namespace Falltergeist
+{
+    namespace VM
+    {
+        namespace Handler
+        {
+            OpcodeSuperinstruction::OpcodeSuperinstruction(
+                VM::Script *script,
+                Type type,
+                std::shared_ptr<ILogger> logger
+            ) : OpcodeHandler(script) {
+                _type = type;
+                this->logger = std::move(logger);
+            }
+
+            void OpcodeSuperinstruction::_run()
+            {
+                int value = _script->script()->instruction(_offset).operand;
+
+                // skip the pushed integer and the fused opcode
+                _script->setProgramCounter(_script->programCounter() + 4 + 2);
+
+                auto dataStack = _script->dataStack();
+                switch (_type) {
+                    case Type::PUSH_FETCH:
+                        dataStack->push(dataStack->values()->at(_script->DVARbase() + value));
+                        break;
+                    case Type::PUSH_STORE: {
+                        auto stored = dataStack->pop();
+                        dataStack->values()->at(_script->DVARbase() + value) = stored;
+                        break;
+                    }
+                    case Type::PUSH_FETCH_GLOBAL:
+                        dataStack->push(dataStack->values()->at(_script->SVARbase() + value));
+                        break;
+                    case Type::PUSH_STORE_GLOBAL: {
+                        auto stored = dataStack->pop();
+                        dataStack->values()->at(_script->SVARbase() + value) = stored;
+                        break;
+                    }
+                    case Type::PUSH_JUMP:
+                        _script->setProgramCounter(value);
+                        break;
+                }
+
+                logger->debug()
+                    << "[F00" << (int)_type << "] [*] push_d integer fused with the next opcode" << std::endl
+                    << "    value: " << std::to_string(value) << std::endl
+                ;
+            }
+        }
+    }
+}
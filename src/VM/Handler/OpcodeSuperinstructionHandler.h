@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../../ILogger.h"
+#include "../../VM/OpcodeHandler.h"
+
+namespace Falltergeist
+{
+    namespace VM
+    {
+        namespace Handler
+        {
+            // push_d integer fused with the following opcode, found by Int::File when decoding
+            class OpcodeSuperinstruction final : public OpcodeHandler
+            {
+                public:
+                    enum class Type {
+                        PUSH_FETCH = 1,     // 0xF001: push_d, op_fetch (8032)
+                        PUSH_STORE,         // 0xF002: push_d, op_store (8031)
+                        PUSH_FETCH_GLOBAL,  // 0xF003: push_d, op_fetch_global (8012)
+                        PUSH_STORE_GLOBAL,  // 0xF004: push_d, op_store_global (8013)
+                        PUSH_JUMP           // 0xF005: push_d, op_jmp (8004)
+                    };
+
+                    OpcodeSuperinstruction(VM::Script *script, Type type, std::shared_ptr<ILogger> logger);
+
+                private:
+                    std::shared_ptr<ILogger> logger;
+                    Type _type;
+
+                    void _run() override;
+            };
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#include <atomic>
+#include <unordered_map>
+#include "../VM/NativeScripts.h"
+
+namespace Falltergeist
+{
+    namespace VM
+    {
+        namespace
+        {
+            // created on first use, registrations run during static initialization in any order
+            std::unordered_map<uint64_t, NativeScripts::Function>& translations()
+            {
+                static std::unordered_map<uint64_t, NativeScripts::Function> translations;
+                return translations;
+            }
+
+            std::atomic<bool> translationsEnabled{true};
+        }
+
+        NativeScripts::Registration::Registration(uint64_t hash, Function function)
+        {
+            // a file translated twice keeps its first translation
+            translations().emplace(hash, function);
+        }
+
+        NativeScripts::Function NativeScripts::find(uint64_t hash)
+        {
+            auto it = translations().find(hash);
+            return it != translations().end() ? it->second : nullptr;
+        }
+
+        size_t NativeScripts::size()
+        {
+            return translations().size();
+        }
+
+        bool NativeScripts::enabled()
+        {
+            return translationsEnabled.load(std::memory_order_relaxed);
+        }
+
+        void NativeScripts::setEnabled(bool value)
+        {
+            translationsEnabled.store(value, std::memory_order_relaxed);
+        }
+    }
+}
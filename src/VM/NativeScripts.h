@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace Falltergeist
+{
+    namespace VM
+    {
+        class Script;
+
+        /**
+         * Translations of .INT files into C++ made by falltergeist_translate (see VM::Translator), compiled into the game
+         * from src/VM/Native. A script whose file has the hash of a translation runs it instead of being interpreted.
+         * Translations step through the interpreter for every opcode they don't inline, so they behave like it does.
+         */
+        class NativeScripts
+        {
+            public:
+                using Function = void (*)(Script& script);
+
+                // Static instances in the translated files register them before main()
+                class Registration
+                {
+                    public:
+                        Registration(uint64_t hash, Function function);
+                };
+
+                // nullptr if there is no translation of the file
+                static Function find(uint64_t hash);
+
+                // Number of translations compiled into the game
+                static size_t size();
+
+                // Disabled scripts are interpreted, to compare both with each other
+                static bool enabled();
+                static void setEnabled(bool value);
+
+                // Float pushed by push_d float, stored as its bits in the translated files
+                static float floatFromBits(uint32_t bits)
+                {
+                    float value;
+                    std::memcpy(&value, &bits, sizeof(value));
+                    return value;
+                }
+        };
+    }
+}
@@ -1,6 +1,7 @@
 #include "../VM/OpcodeFactory.h"
 #include <sstream>
 #include <memory>
+#include <vector>
 #include "../Exception.h"
 #include "../Logger.h"
 #include "../VM/Handler/Opcode8002.h"
@@ -182,6 +183,7 @@
 #include "../VM/Handler/Opcode9001Handler.h"
 #include "../VM/Handler/OpcodeC001Handler.h"
 #include "../VM/Handler/OpcodeA001Handler.h"
+#include "../VM/Handler/OpcodeSuperinstructionHandler.h"
 #include "../VM/Script.h"
 #include "../Game/Game.h"
 
@@ -191,8 +193,8 @@ namespace Falltergeist
     {
         std::unique_ptr<OpcodeHandler> OpcodeFactory::createOpcode(unsigned int number, VM::Script *script)
         {
-            auto logger = std::make_shared<Logger>();
-            auto game = Game::Game::getInstance();
+            // the logger keeps no state of its own, handlers share it
+            static auto logger = std::make_shared<Logger>();
 
             switch (number) {
                 case 0x8000:
@@ -437,7 +439,7 @@ namespace Falltergeist
                 case 0x80E9:
                     return std::make_unique<Handler::Opcode80E9>(script, logger);
                 case 0x80EA:
-                    return std::make_unique<Handler::Opcode80EA>(script, logger, game->gameTime());
+                    return std::make_unique<Handler::Opcode80EA>(script, logger, Game::Game::getInstance()->gameTime());
                 case 0x80EC:
                     return std::make_unique<Handler::Opcode80EC>(script, logger);
                 case 0x80EE:
@@ -592,6 +594,17 @@ namespace Falltergeist
                     return std::make_unique<Handler::OpcodeC001>(script, logger);
                 case 0xA001:
                     return std::make_unique<Handler::OpcodeA001>(script, logger);
+                // superinstructions, never stored in .INT files
+                case 0xF001:
+                    return std::make_unique<Handler::OpcodeSuperinstruction>(script, Handler::OpcodeSuperinstruction::Type::PUSH_FETCH, logger);
+                case 0xF002:
+                    return std::make_unique<Handler::OpcodeSuperinstruction>(script, Handler::OpcodeSuperinstruction::Type::PUSH_STORE, logger);
+                case 0xF003:
+                    return std::make_unique<Handler::OpcodeSuperinstruction>(script, Handler::OpcodeSuperinstruction::Type::PUSH_FETCH_GLOBAL, logger);
+                case 0xF004:
+                    return std::make_unique<Handler::OpcodeSuperinstruction>(script, Handler::OpcodeSuperinstruction::Type::PUSH_STORE_GLOBAL, logger);
+                case 0xF005:
+                    return std::make_unique<Handler::OpcodeSuperinstruction>(script, Handler::OpcodeSuperinstruction::Type::PUSH_JUMP, logger);
                 default: {
                     std::stringstream ss;
                     ss << "OpcodeFactory::createOpcode() - unimplemented opcode: " << std::hex << number;
@@ -599,5 +612,45 @@ namespace Falltergeist
                 }
             }
         }
+
+        OpcodeHandler* OpcodeFactory::handler(unsigned int number)
+        {
+            static std::vector<std::unique_ptr<OpcodeHandler>> handlers(SLOTS);
+
+            auto index = slot(number);
+            if (index == SLOTS) {
+                // throws for unimplemented opcodes
+                createOpcode(number, nullptr);
+                return nullptr;
+            }
+            auto& handler = handlers[index];
+            if (!handler) {
+                handler = createOpcode(number, nullptr);
+            }
+            return handler.get();
+        }
+
+        unsigned int OpcodeFactory::slot(unsigned int number)
+        {
+            if (number >= 0x8000 && number < 0x8200) {
+                return number - 0x8000;
+            }
+            switch (number) {
+                case 0x9001:
+                    return 0x200;
+                case 0xA001:
+                    return 0x201;
+                case 0xC001:
+                    return 0x202;
+                case 0xF001:
+                case 0xF002:
+                case 0xF003:
+                case 0xF004:
+                case 0xF005:
+                    return 0x203 + (number - 0xF001);
+                default:
+                    return SLOTS;
+            }
+        }
     }
 }
@@ -12,7 +12,16 @@ namespace Falltergeist
         class OpcodeFactory
         {
             public:
+                // Number of shared handler slots
+                static const unsigned int SLOTS = 0x208;
+
                 static std::unique_ptr<OpcodeHandler> createOpcode(unsigned int number, VM::Script *script);
+
+                // Handler shared by every script, created on first use, throws for unimplemented opcodes
+                static OpcodeHandler* handler(unsigned int number);
+
+                // Dense index of the opcode in the handler slots, SLOTS if the opcode has none
+                static unsigned int slot(unsigned int number);
         };
     }
 }
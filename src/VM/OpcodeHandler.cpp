@@ -10,7 +10,7 @@ namespace Falltergeist
     {
         OpcodeHandler::OpcodeHandler(VM::Script *script) : _script(script)
         {
-            _offset = script->programCounter();
+            _offset = script ? script->programCounter() : 0;
         }
 
         OpcodeHandler::~OpcodeHandler()
@@ -19,8 +19,26 @@ namespace Falltergeist
 
         void OpcodeHandler::run()
         {
-            _script->setProgramCounter(_script->programCounter() + 2);
-            _run();
+            run(_script);
+        }
+
+        void OpcodeHandler::run(VM::Script *script)
+        {
+            // a handler is entered again when a script called from it runs the same opcode
+            auto previousScript = _script;
+            auto previousOffset = _offset;
+            _script = script;
+            _offset = script->programCounter();
+            try {
+                _script->setProgramCounter(_script->programCounter() + 2);
+                _run();
+            } catch (...) {
+                _script = previousScript;
+                _offset = previousOffset;
+                throw;
+            }
+            _script = previousScript;
+            _offset = previousOffset;
         }
 
         void OpcodeHandler::_run()
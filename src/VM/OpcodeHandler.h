@@ -12,12 +12,16 @@ namespace Falltergeist
         class OpcodeHandler
         {
             public:
+                // script is nullptr for handlers shared by every script
                 OpcodeHandler(VM::Script *script);
 
                 virtual ~OpcodeHandler();
 
                 void run();
 
+                // Runs the instruction at the program counter of the given script
+                void run(VM::Script *script);
+
             protected:
                 VM::Script *_script;
                 unsigned int _offset;
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <unordered_map>
+#include <vector>
+#include "../VM/Profiler.h"
+
+namespace Falltergeist
+{
+    namespace VM
+    {
+        namespace
+        {
+            struct Stats
+            {
+                unsigned long long count = 0;
+                Profiler::Duration time = Profiler::Duration::zero();
+            };
+
+            // indexed by opcode
+            std::vector<Stats>& opcodes()
+            {
+                static std::vector<Stats> opcodes(0x10000);
+                return opcodes;
+            }
+
+            // keyed by "file:procedure"
+            std::unordered_map<std::string, Stats>& procedures()
+            {
+                static std::unordered_map<std::string, Stats> procedures;
+                return procedures;
+            }
+
+            long long microseconds(Profiler::Duration time)
+            {
+                return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+            }
+        }
+
+        bool Profiler::_enabled = false;
+
+        bool Profiler::enabled()
+        {
+            return _enabled;
+        }
+
+        void Profiler::setEnabled(bool enabled)
+        {
+            _enabled = enabled;
+        }
+
+        void Profiler::opcode(unsigned int opcode, Duration time)
+        {
+            auto& stats = opcodes().at(opcode & 0xFFFF);
+            ++stats.count;
+            stats.time += time;
+        }
+
+        void Profiler::procedure(const std::string& filename, const std::string& name, Duration time, bool finished)
+        {
+            auto& stats = procedures()[filename + ":" + name];
+            if (finished) {
+                ++stats.count;
+            }
+            stats.time += time;
+        }
+
+        void Profiler::reset()
+        {
+            opcodes().assign(0x10000, Stats());
+            procedures().clear();
+        }
+
+        bool Profiler::write(const std::string& filename)
+        {
+            std::ofstream stream(filename);
+            if (!stream) {
+                return false;
+            }
+
+            stream << "kind,name,count,time_us" << std::endl;
+
+            auto& opcodeStats = opcodes();
+            for (unsigned int opcode = 0; opcode != opcodeStats.size(); ++opcode) {
+                if (opcodeStats[opcode].count == 0) {
+                    continue;
+                }
+                stream << "opcode,0x" << std::hex << std::uppercase << opcode << std::dec << std::nouppercase << ","
+                       << opcodeStats[opcode].count << "," << microseconds(opcodeStats[opcode].time) << std::endl;
+            }
+
+            // hottest procedures first
+            std::vector<std::pair<std::string, Stats>> sorted(procedures().begin(), procedures().end());
+            std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, Stats>& a, const std::pair<std::string, Stats>& b) {
+                return a.second.time > b.second.time;
+            });
+            for (auto& procedure : sorted) {
+                stream << "procedure," << procedure.first << "," << procedure.second.count << "," << microseconds(procedure.second.time) << std::endl;
+            }
+            return true;
+        }
+    }
+}
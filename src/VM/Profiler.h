@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace Falltergeist
+{
+    namespace VM
+    {
+        /**
+         * Profiler collects how often opcodes run and procedures are called, and the time spent in them.
+         * It's disabled by default and costs a single check per instruction then.
+         * Procedure times are inclusive, they contain the procedures called from them.
+         */
+        class Profiler final
+        {
+            public:
+                using Duration = std::chrono::steady_clock::duration;
+
+                static bool enabled();
+
+                static void setEnabled(bool enabled);
+
+                static void opcode(unsigned int opcode, Duration time);
+
+                // finished is false for the parts of a procedure run before it's suspended
+                static void procedure(const std::string& filename, const std::string& name, Duration time, bool finished);
+
+                static void reset();
+
+                // Writes the collected data as CSV, returns false if the file cannot be written
+                static bool write(const std::string& filename);
+
+            private:
+                static bool _enabled;
+        };
+    }
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include "../VM/Scheduler.h"
+#include "../VM/Script.h"
+
+namespace Falltergeist
+{
+    namespace VM
+    {
+        Scheduler* Scheduler::_current = nullptr;
+
+        Scheduler::Scheduler(unsigned int budget) : _budget(budget)
+        {
+            _current = this;
+        }
+
+        Scheduler::~Scheduler()
+        {
+            if (_current == this) {
+                _current = nullptr;
+            }
+        }
+
+        Scheduler* Scheduler::current()
+        {
+            return _current;
+        }
+
+        unsigned int Scheduler::budget() const
+        {
+            return static_cast<unsigned int>(_budget.count());
+        }
+
+        void Scheduler::setBudget(unsigned int budget)
+        {
+            _budget = std::chrono::microseconds(budget);
+        }
+
+        void Scheduler::queue(Script* script, PROCEDURE procedure)
+        {
+            for (auto& call : _calls) {
+                if (call.script == script && call.procedure == procedure) {
+                    return;
+                }
+            }
+            _calls.push_back({script, procedure});
+        }
+
+        void Scheduler::cancel(Script* script)
+        {
+            _calls.erase(
+                std::remove_if(_calls.begin(), _calls.end(), [script](const Call& call) {
+                    return call.script == script;
+                }),
+                _calls.end()
+            );
+        }
+
+        void Scheduler::think()
+        {
+            auto deadline = std::chrono::steady_clock::now() + _budget;
+            while (!_calls.empty() && std::chrono::steady_clock::now() < deadline) {
+                // taken off the queue first, the procedure could queue or cancel calls
+                auto call = _calls.front();
+                _calls.pop_front();
+                if (!call.script->call(call.procedure, deadline)) {
+                    _calls.push_front(call);
+                    return;
+                }
+            }
+        }
+
+        size_t Scheduler::waiting() const
+        {
+            return _calls.size();
+        }
+    }
+}
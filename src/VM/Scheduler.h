@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include "../Format/Enums.h"
+
+namespace Falltergeist
+{
+    namespace VM
+    {
+        class Script;
+
+        /**
+         * Scheduler runs queued script procedures round-robin under a time budget per frame.
+         * A procedure which exceeds the budget is suspended and resumed first on the next frame.
+         */
+        class Scheduler final
+        {
+            public:
+                // budget is in microseconds
+                explicit Scheduler(unsigned int budget);
+
+                ~Scheduler();
+
+                Scheduler(const Scheduler&) = delete;
+
+                Scheduler& operator=(const Scheduler&) = delete;
+
+                // Scheduler of the current location, nullptr if there is none
+                static Scheduler* current();
+
+                unsigned int budget() const;
+
+                void setBudget(unsigned int budget);
+
+                // Does nothing if the same procedure of the script is already waiting
+                void queue(Script* script, PROCEDURE procedure);
+
+                // Drops the waiting procedures of the script
+                void cancel(Script* script);
+
+                // Runs waiting procedures until the queue is empty or the budget is spent
+                void think();
+
+                size_t waiting() const;
+
+            private:
+                struct Call
+                {
+                    Script* script;
+                    PROCEDURE procedure;
+                };
+
+                static Scheduler* _current;
+
+                std::chrono::microseconds _budget;
+
+                std::deque<Call> _calls;
+        };
+    }
+}
@@ -1,19 +1,28 @@
+#include <cstring>
 #include <ctime>
 #include <memory>
 #include <sstream>
+#include "../Base/Pool.h"
 #include "../Exception.h"
 #include "../Format/Int/File.h"
 #include "../Format/Int/Procedure.h"
 #include "../Format/Lst/File.h"
 #include "../Format/Msg/File.h"
 #include "../Format/Msg/Message.h"
+#include "../FrameStats.h"
 #include "../Game/Game.h"
 #include "../Game/Object.h"
 #include "../Logger.h"
+#include "../MemoryStats.h"
+#include "../Metrics.h"
 #include "../ResourceManager.h"
+#include "../Trace.h"
 #include "../VM/ErrorException.h"
 #include "../VM/HaltException.h"
+#include "../VM/NativeScripts.h"
 #include "../VM/OpcodeFactory.h"
+#include "../VM/Profiler.h"
+#include "../VM/Scheduler.h"
 #include "../VM/Script.h"
 #include "../VM/StackValue.h"
 
@@ -24,23 +33,197 @@ namespace Falltergeist
         Script::Script(Format::Int::File *script, Game::Object *owner)
         {
             _owner = owner;
-            _script = script;
+            _script = ResourceManager::getInstance()->pin(script);
             if (!_script) {
                 throw Exception("Script::VM() - script is null");
             }
+            _native = NativeScripts::find(_script->hash());
         }
 
         Script::Script(const std::string &filename, Game::Object *owner)
         {
             _owner = owner;
-            _script = ResourceManager::getInstance()->intFileType(filename);
+            _script = ResourceManager::getInstance()->pin(ResourceManager::getInstance()->intFileType(filename));
             if (!_script) {
                 throw Exception("Script::VM() - script is null: " + filename);
             }
+            _native = NativeScripts::find(_script->hash());
+        }
+
+        namespace
+        {
+            const uint32_t SNAPSHOT_MAGIC = 0x4D564746; // "FGVM"
+            const uint8_t SNAPSHOT_VERSION = 1;
+            const uint32_t NO_PROCEDURE = 0xFFFFFFFF;
+
+            // little endian, independent of the host
+            class SnapshotWriter
+            {
+                public:
+                    explicit SnapshotWriter(std::vector<uint8_t>& bytes) : _bytes(bytes)
+                    {
+                    }
+
+                    void uint8(uint8_t value)
+                    {
+                        _bytes.push_back(value);
+                    }
+
+                    void uint32(uint32_t value)
+                    {
+                        for (unsigned int i = 0; i != 4; ++i) {
+                            _bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+                        }
+                    }
+
+                    void string(const std::string& value)
+                    {
+                        uint32(static_cast<uint32_t>(value.size()));
+                        _bytes.insert(_bytes.end(), value.begin(), value.end());
+                    }
+
+                private:
+                    std::vector<uint8_t>& _bytes;
+            };
+
+            class SnapshotReader
+            {
+                public:
+                    explicit SnapshotReader(const std::vector<uint8_t>& bytes) : _bytes(bytes)
+                    {
+                    }
+
+                    uint8_t uint8()
+                    {
+                        _need(1);
+                        return _bytes[_position++];
+                    }
+
+                    uint32_t uint32()
+                    {
+                        _need(4);
+                        uint32_t value = 0;
+                        for (unsigned int i = 0; i != 4; ++i) {
+                            value |= static_cast<uint32_t>(_bytes[_position++]) << (i * 8);
+                        }
+                        return value;
+                    }
+
+                    std::string string()
+                    {
+                        uint32_t size = uint32();
+                        _need(size);
+                        std::string value(_bytes.begin() + _position, _bytes.begin() + _position + size);
+                        _position += size;
+                        return value;
+                    }
+
+                    bool finished() const
+                    {
+                        return _position == _bytes.size();
+                    }
+
+                private:
+                    const std::vector<uint8_t>& _bytes;
+                    size_t _position = 0;
+
+                    void _need(size_t size)
+                    {
+                        if (_bytes.size() - _position < size) {
+                            throw Exception("Script::restore() - snapshot is truncated");
+                        }
+                    }
+            };
+
+            void writeValues(SnapshotWriter& writer, const std::vector<StackValue>& values, const Script::ObjectWriter& objectId)
+            {
+                writer.uint32(static_cast<uint32_t>(values.size()));
+                for (auto& value : values) {
+                    writer.uint8(static_cast<uint8_t>(value.type()));
+                    switch (value.type()) {
+                        case StackValue::Type::INTEGER:
+                            writer.uint32(static_cast<uint32_t>(value.integerValue()));
+                            break;
+                        case StackValue::Type::FLOAT: {
+                            float floatValue = value.floatValue();
+                            uint32_t bits;
+                            std::memcpy(&bits, &floatValue, sizeof(bits));
+                            writer.uint32(bits);
+                            break;
+                        }
+                        case StackValue::Type::STRING:
+                            writer.string(value.stringValue());
+                            break;
+                        case StackValue::Type::OBJECT:
+                            writer.uint32(objectId(value.objectValue()));
+                            break;
+                    }
+                }
+            }
+
+            void readValues(SnapshotReader& reader, std::vector<StackValue>& values, const Script::ObjectReader& object)
+            {
+                uint32_t count = reader.uint32();
+                values.clear();
+                for (uint32_t i = 0; i != count; ++i) {
+                    switch (static_cast<StackValue::Type>(reader.uint8())) {
+                        case StackValue::Type::INTEGER:
+                            values.emplace_back(static_cast<int>(reader.uint32()));
+                            break;
+                        case StackValue::Type::FLOAT: {
+                            uint32_t bits = reader.uint32();
+                            float floatValue;
+                            std::memcpy(&floatValue, &bits, sizeof(floatValue));
+                            values.emplace_back(floatValue);
+                            break;
+                        }
+                        case StackValue::Type::STRING:
+                            values.emplace_back(reader.string());
+                            break;
+                        case StackValue::Type::OBJECT:
+                            values.emplace_back(object(reader.uint32()));
+                            break;
+                        default:
+                            throw Exception("Script::restore() - unknown value type");
+                    }
+                }
+            }
+
+            // never destroyed, scripts can outlive static objects at exit
+            Base::Pool<sizeof(Script)>* pool()
+            {
+                static auto pool = new Base::Pool<sizeof(Script)>();
+                return pool;
+            }
+        }
+
+        void* Script::operator new(size_t size)
+        {
+            MemoryStats::add(MemoryStats::Category::SCRIPTS, size);
+            if (size != sizeof(Script)) {
+                return ::operator new(size);
+            }
+            return pool()->allocate();
+        }
+
+        void Script::operator delete(void* pointer, size_t size)
+        {
+            if (!pointer) {
+                return;
+            }
+            MemoryStats::remove(MemoryStats::Category::SCRIPTS, size);
+            if (size != sizeof(Script)) {
+                ::operator delete(pointer);
+                return;
+            }
+            pool()->deallocate(pointer);
         }
 
         Script::~Script()
         {
+            if (auto scheduler = Scheduler::current()) {
+                scheduler->cancel(this);
+            }
         }
 
         std::string Script::filename()
@@ -53,19 +236,181 @@ namespace Falltergeist
             return _script->procedure(name) != nullptr;
         }
 
+        bool Script::hasFunction(PROCEDURE id)
+        {
+            return _script->procedure(id) != nullptr;
+        }
+
         void Script::call(const std::string &name)
+        {
+            _call(_script->procedure(name));
+        }
+
+        void Script::call(PROCEDURE id)
+        {
+            _call(_script->procedure(id));
+        }
+
+        bool Script::call(PROCEDURE id, Deadline deadline)
+        {
+            if (_suspended) {
+                return resume(deadline);
+            }
+            _overrides = false;
+            auto procedure = _script->procedure(id);
+            if (!procedure) {
+                return true;
+            }
+            _enter(procedure);
+            return _runUntil(deadline);
+        }
+
+        bool Script::resume(Deadline deadline)
+        {
+            if (!_suspended) {
+                return true;
+            }
+            _suspended = false;
+            return _runUntil(deadline);
+        }
+
+        bool Script::suspended() const
+        {
+            return _suspended;
+        }
+
+        std::vector<uint8_t> Script::snapshot(const ObjectWriter& objectId) const
+        {
+            std::vector<uint8_t> bytes;
+            SnapshotWriter writer(bytes);
+            writer.uint32(SNAPSHOT_MAGIC);
+            writer.uint8(SNAPSHOT_VERSION);
+            writer.string(_script->filename());
+            writer.uint8(static_cast<uint8_t>((_initialized ? 1 : 0) | (_overrides ? 2 : 0) | (_suspended ? 4 : 0)));
+            writer.uint32(_programCounter);
+            writer.uint32(static_cast<uint32_t>(_DVAR_base));
+            writer.uint32(static_cast<uint32_t>(_SVAR_base));
+
+            // suspended procedures are resumed after restoring, they need to be known for the profiler
+            uint32_t procedure = NO_PROCEDURE;
+            if (_procedure) {
+                procedure = static_cast<uint32_t>(_procedure - _script->procedures().data());
+            }
+            writer.uint32(procedure);
+
+            writeValues(writer, *_dataStack.values(), objectId);
+            writeValues(writer, *_returnStack.values(), objectId);
+            writeValues(writer, _LVARS, objectId);
+            return bytes;
+        }
+
+        void Script::restore(const std::vector<uint8_t>& snapshot, const ObjectReader& object)
+        {
+            SnapshotReader reader(snapshot);
+            if (reader.uint32() != SNAPSHOT_MAGIC || reader.uint8() != SNAPSHOT_VERSION) {
+                throw Exception("Script::restore() - not a script snapshot");
+            }
+            if (reader.string() != _script->filename()) {
+                throw Exception("Script::restore() - snapshot of another script");
+            }
+            uint8_t flags = reader.uint8();
+            uint32_t programCounter = reader.uint32();
+            if (programCounter > _script->size()) {
+                throw Exception("Script::restore() - program counter out of range");
+            }
+            size_t dvarBase = reader.uint32();
+            size_t svarBase = reader.uint32();
+            uint32_t procedure = reader.uint32();
+            if (procedure != NO_PROCEDURE && procedure >= _script->procedures().size()) {
+                throw Exception("Script::restore() - procedure out of range");
+            }
+
+            // read everything before changing the state, a broken snapshot leaves the script untouched
+            std::vector<StackValue> dataStack, returnStack, lvars;
+            readValues(reader, dataStack, object);
+            readValues(reader, returnStack, object);
+            readValues(reader, lvars, object);
+            if (!reader.finished()) {
+                throw Exception("Script::restore() - trailing data in snapshot");
+            }
+
+            _initialized = (flags & 1) != 0;
+            _overrides = (flags & 2) != 0;
+            _suspended = (flags & 4) != 0;
+            _programCounter = programCounter;
+            _DVAR_base = dvarBase;
+            _SVAR_base = svarBase;
+            _procedure = procedure != NO_PROCEDURE ? &_script->procedures()[procedure] : nullptr;
+            *_dataStack.values() = std::move(dataStack);
+            *_returnStack.values() = std::move(returnStack);
+            _LVARS = std::move(lvars);
+            ++_LVARSRevision;
+        }
+
+        bool Script::_runUntil(Deadline deadline)
+        {
+            auto started = std::chrono::steady_clock::now();
+            _hasDeadline = true;
+            _deadline = deadline;
+            run();
+            _hasDeadline = false;
+            if (Profiler::enabled() && _procedure) {
+                Profiler::procedure(_script->filename(), _procedure->name(), std::chrono::steady_clock::now() - started, !_suspended);
+            }
+            if (FrameStats::enabled() && _procedure) {
+                FrameStats::script(_script->filename(), _procedure->name());
+            }
+            if (_suspended) {
+                return false;
+            }
+            _leave();
+            return true;
+        }
+
+        void Script::_call(const Format::Int::Procedure* procedure)
         {
             _overrides = false;
-            auto procedure = _script->procedure(name);
+            _repeatable = true;
             if (!procedure) {
                 return;
             }
 
+            // the call could be made while another procedure is running or suspended at the program counter
+            auto programCounter = _programCounter;
+            auto hasDeadline = _hasDeadline;
+            auto suspended = _suspended;
+            auto current = _procedure;
+            _hasDeadline = false;
+            _suspended = false;
+
+            auto started = std::chrono::steady_clock::now();
+            _enter(procedure);
+            run();
+            _leave();
+            if (Profiler::enabled()) {
+                Profiler::procedure(_script->filename(), procedure->name(), std::chrono::steady_clock::now() - started, true);
+            }
+            if (FrameStats::enabled()) {
+                FrameStats::script(_script->filename(), procedure->name());
+            }
+
+            _hasDeadline = hasDeadline;
+            _suspended = suspended;
+            _procedure = current;
+            _programCounter = programCounter;
+        }
+
+        void Script::_enter(const Format::Int::Procedure* procedure)
+        {
+            _procedure = procedure;
             _programCounter = procedure->bodyOffset();
             _dataStack.push(0); // arguments counter;
             _returnStack.push(0); // return address
-            Logger::debug("SCRIPT") << "CALLED: " << name << " [" << _script->filename() << "]" << std::endl;
-            run();
+            Logger::debug("SCRIPT") << "CALLED: " << procedure->name() << " [" << _script->filename() << "]" << std::endl;
+        }
+
+        void Script::_leave()
+        {
             _dataStack.popInteger(); // remove function result
             Logger::debug("SCRIPT") << "Function ended" << std::endl;
 
@@ -86,35 +431,71 @@ namespace Falltergeist
 
         void Script::run()
         {
-            while (_programCounter != _script->size()) {
-                if (_programCounter == 0 && _initialized) {
-                    return;
-                }
-                auto offset = _programCounter;
-                _script->setPosition(_programCounter);
-                unsigned short opcode = _script->readOpcode();
-
-                std::unique_ptr<OpcodeHandler> opcodeHandler(OpcodeFactory::createOpcode(opcode, this));
-                try {
-                    opcodeHandler->run();
-                } catch (const HaltException &) {
-                    return;
-                } catch (const ErrorException &e) {
-                    Logger::error("SCRIPT") << e.what() << " in [" << std::hex << opcode << "] at "
-                                            << _script->filename() << ":0x" << offset << std::endl;
-                    _dataStack.values()->clear();
-                    _dataStack.push(0); // to end script properly
-                    return;
+            Trace::Scope scope("Script::run", _script->filename());
+            if (_native && NativeScripts::enabled()) {
+                _native(*this);
+                return;
+            }
+            // counted here rather than per step, one atomic add per run
+            uint64_t instructions = 0;
+            while (step()) {
+                instructions++;
+            }
+            if (Metrics::enabled()) {
+                static auto& executed = Metrics::counter("scripts.instructions");
+                executed.add(instructions);
+            }
+        }
+
+        bool Script::step()
+        {
+            if (_programCounter == _script->size()) {
+                return false;
+            }
+            if (_programCounter == 0 && _initialized) {
+                return false;
+            }
+            auto offset = _programCounter;
+            auto& instruction = _script->instruction(_programCounter);
+            unsigned short opcode = instruction.fused ? instruction.fused : instruction.opcode;
+
+            auto opcodeHandler = OpcodeFactory::handler(opcode);
+            const bool profiling = Profiler::enabled();
+            auto started = profiling ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+            try {
+                opcodeHandler->run(this);
+                if (profiling) {
+                    Profiler::opcode(opcode, std::chrono::steady_clock::now() - started);
                 }
+            } catch (const HaltException &) {
+                return false;
+            } catch (const ErrorException &e) {
+                Logger::error("SCRIPT") << e.what() << " in [" << std::hex << opcode << "] at "
+                                        << _script->filename() << ":0x" << offset << std::endl;
+                _dataStack.values()->clear();
+                _dataStack.push(0); // to end script properly
+                return false;
             }
+
+            // reading the clock is slower than most instructions
+            if (_hasDeadline && (++_instructions % 64) == 0 && std::chrono::steady_clock::now() >= _deadline) {
+                _suspended = true;
+                return false;
+            }
+            return true;
         }
 
-        std::string Script::msgMessage(int msg_file_num, int msg_num)
+        Format::Msg::File* Script::msgFile(int msg_file_num)
         {
             auto lst = ResourceManager::getInstance()->lstFileType("scripts/scripts.lst");
             auto scriptName = lst->strings()->at(msg_file_num - 1);
-            auto msg = ResourceManager::getInstance()->msgFileType(
+            return ResourceManager::getInstance()->msgFileType(
                     "text/english/dialog/" + scriptName.substr(0, scriptName.find(".int")).append(".msg"));
+        }
+
+        std::string Script::msgMessage(int msg_file_num, int msg_num)
+        {
+            auto msg = msgFile(msg_file_num);
             if (!msg) {
                 Logger::debug("SCRIPT")
                         << "Script::msgMessage(file, num) not found. file: " + std::to_string(msg_file_num) + " num: " +
@@ -126,10 +507,7 @@ namespace Falltergeist
 
         std::string Script::msgSpeech(int msg_file_num, int msg_num)
         {
-            auto lst = ResourceManager::getInstance()->lstFileType("scripts/scripts.lst");
-            auto scriptName = lst->strings()->at(msg_file_num - 1);
-            auto msg = ResourceManager::getInstance()->msgFileType(
-                    "text/english/dialog/" + scriptName.substr(0, scriptName.find(".int")).append(".msg"));
+            auto msg = msgFile(msg_file_num);
             if (!msg) {
                 Logger::debug("SCRIPT")
                         << "Script::msgSpeech(file, num) not found. file: " + std::to_string(msg_file_num) + " num: " +
@@ -141,7 +519,7 @@ namespace Falltergeist
 
         Format::Int::File *Script::script()
         {
-            return _script;
+            return _script.get();
         }
 
         unsigned int Script::programCounter()
@@ -247,6 +625,30 @@ namespace Falltergeist
             return _overrides;
         }
 
+        void Script::setLVAR(unsigned int number, const StackValue& value)
+        {
+            while (number >= _LVARS.size()) {
+                _LVARS.push_back(StackValue(0));
+            }
+            _LVARS[number] = value;
+            ++_LVARSRevision;
+        }
+
+        uint64_t Script::LVARSRevision() const
+        {
+            return _LVARSRevision;
+        }
+
+        bool Script::repeatable() const
+        {
+            return _repeatable;
+        }
+
+        void Script::setUnrepeatable()
+        {
+            _repeatable = false;
+        }
+
         void Script::setOverrides(bool Value)
         {
             _overrides = Value;
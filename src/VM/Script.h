@@ -1,6 +1,11 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 #include "../Format/Enums.h"
 #include "../VM/Stack.h"
 #include "../VM/StackValue.h"
@@ -15,6 +20,18 @@ namespace Falltergeist
         }
     }
 
+    namespace Format
+    {
+        namespace Int
+        {
+            class Procedure;
+        }
+        namespace Msg
+        {
+            class File;
+        }
+    }
+
     namespace Game
     {
         class Object;
@@ -27,6 +44,8 @@ namespace Falltergeist
          * VM uses 2 stacks (return stack and data stack).
          * Each operator from .INT script is handled by one of the Handler classes and it manipulates one or both stacks in some way.
          * Typical scripting command takes 0 or more arguments from the data stack and puts one return value to the same stack.
+         * The program is the shared Int::File and the opcode handlers are shared by every script, so a script only keeps
+         * its execution state. Scripts are allocated from a slab pool, maps create many of them at once.
          */
         class Script
         {
@@ -37,8 +56,16 @@ namespace Falltergeist
 
                 virtual ~Script();
 
+                static void* operator new(size_t size);
+
+                static void operator delete(void* pointer, size_t size);
+
                 void run();
 
+                // Runs the instruction at the program counter, false once run() would stop: at the end of the file,
+                // when the procedure halted, failed or was suspended. Native translations run through it
+                bool step();
+
                 void initialize();
 
                 bool initialized();
@@ -53,13 +80,42 @@ namespace Falltergeist
 
                 std::string msgSpeech(int msg_file_num, int msg_num);
 
+                // Dialog messages of the script with the given number in scripts.lst, nullptr if there are none
+                Format::Msg::File* msgFile(int msg_file_num);
+
                 // Returns filename of an .int script file
                 std::string filename();
 
                 bool hasFunction(const std::string &name);
 
+                bool hasFunction(PROCEDURE id);
+
                 void call(const std::string &name);
 
+                // same as call() with the name, without looking the procedure up by name
+                void call(PROCEDURE id);
+
+                using Deadline = std::chrono::steady_clock::time_point;
+
+                // Starts the procedure like call(), but suspends it at an instruction boundary once the deadline passes
+                // Returns true if the procedure has finished, otherwise it has to be continued with resume()
+                // Calls made while a procedure is suspended run to completion and share its call arguments
+                bool call(PROCEDURE id, Deadline deadline);
+
+                bool resume(Deadline deadline);
+
+                bool suspended() const;
+
+                // Objects referred to by the state are stored as ids, the caller decides how objects are identified
+                using ObjectWriter = std::function<uint32_t(Game::Object*)>;
+                using ObjectReader = std::function<Game::Object*(uint32_t)>;
+
+                // Binary snapshot of the execution state: program counter, stacks, local variables and variable bases
+                std::vector<uint8_t> snapshot(const ObjectWriter& objectId) const;
+
+                // Replaces the execution state with a snapshot of a script of the same file, throws if it's invalid
+                void restore(const std::vector<uint8_t>& snapshot, const ObjectReader& object);
+
                 Format::Int::File *script();
 
                 Game::Object *owner();
@@ -74,6 +130,19 @@ namespace Falltergeist
 
                 std::vector<StackValue> *LVARS();
 
+                // Grows the local variables up to the number, bumps LVARSRevision()
+                void setLVAR(unsigned int number, const StackValue& value);
+
+                // Counts every write of a local variable
+                uint64_t LVARSRevision() const;
+
+                // Whether the last call() would give the same result again while the variables stay the same:
+                // it drew no random numbers and showed no float messages. Memoised results need that
+                bool repeatable() const;
+
+                // Called by the handlers of the opcodes the result of which a memo can't repeat
+                void setUnrepeatable();
+
                 size_t DVARbase();
 
                 void setDVARBase(size_t Value);
@@ -106,15 +175,36 @@ namespace Falltergeist
 
                 int _fixedParam = 0;
                 int _actionUsed = 0;
-                Format::Int::File *_script = 0;
+                std::shared_ptr<Format::Int::File> _script;
                 bool _initialized = false;
                 bool _overrides = false;
                 Stack _dataStack;
                 Stack _returnStack;
                 std::vector<StackValue> _LVARS;
+                uint64_t _LVARSRevision = 0;
+                bool _repeatable = true;
                 unsigned int _programCounter = 0;
                 size_t _DVAR_base = 0;
                 size_t _SVAR_base = 0;
+
+                // set while a procedure started with a deadline runs
+                bool _hasDeadline = false;
+                Deadline _deadline;
+                bool _suspended = false;
+                unsigned int _instructions = 0;
+                // running or suspended procedure, for the profiler
+                const Format::Int::Procedure* _procedure = nullptr;
+
+                // translation of the file compiled into the game, see VM::NativeScripts
+                void (*_native)(Script& script) = nullptr;
+
+                void _call(const Format::Int::Procedure* procedure);
+
+                void _enter(const Format::Int::Procedure* procedure);
+
+                void _leave();
+
+                bool _runUntil(Deadline deadline);
         };
     }
 }
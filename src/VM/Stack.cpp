@@ -1,4 +1,5 @@
 #include <string>
+#include <utility>
 #include "../Exception.h"
 #include "../VM/Stack.h"
 #include "../VM/StackValue.h"
@@ -7,12 +8,37 @@ namespace Falltergeist
 {
     namespace VM
     {
+        namespace
+        {
+            const size_t RESERVED_VALUES = 32;
+            const size_t POOLED_STACKS = 512;
+
+            // never destroyed, stacks can outlive static objects at exit
+            std::vector<std::vector<StackValue>>& pool()
+            {
+                static auto pool = new std::vector<std::vector<StackValue>>();
+                return *pool;
+            }
+        }
+
         Stack::Stack()
         {
+            auto& stacks = pool();
+            if (!stacks.empty()) {
+                _values = std::move(stacks.back());
+                stacks.pop_back();
+            } else {
+                _values.reserve(RESERVED_VALUES);
+            }
         }
 
         Stack::~Stack()
         {
+            auto& stacks = pool();
+            if (_values.capacity() != 0 && stacks.size() < POOLED_STACKS) {
+                _values.clear();
+                stacks.push_back(std::move(_values));
+            }
         }
 
         void Stack::push(const StackValue &value)
@@ -20,7 +46,7 @@ namespace Falltergeist
             _values.push_back(value);
         }
 
-        const StackValue Stack::pop()
+        StackValue Stack::pop()
         {
             if (_values.size() == 0) {
                 throw Exception("Stack::pop() - stack is empty");
@@ -41,12 +67,7 @@ namespace Falltergeist
                 throw Exception("Stack::swap() - size is < 2");
             }
 
-            auto value1 = _values.back();
-            _values.pop_back();
-            auto value2 = _values.back();
-            _values.pop_back();
-            _values.push_back(value1);
-            _values.push_back(value2);
+            std::swap(_values[_values.size() - 1], _values[_values.size() - 2]);
         }
 
         std::vector<StackValue> *Stack::values()
@@ -54,7 +75,12 @@ namespace Falltergeist
             return &_values;
         }
 
-        const StackValue Stack::top()
+        const std::vector<StackValue> *Stack::values() const
+        {
+            return &_values;
+        }
+
+        StackValue Stack::top()
         {
             return _values.back();
         }
@@ -94,7 +120,7 @@ namespace Falltergeist
             push(StackValue(value));
         }
 
-        std::string Stack::popString()
+        const std::string &Stack::popString()
         {
             return pop().stringValue();
         }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace Falltergeist
@@ -33,27 +34,30 @@ namespace Falltergeist
 
                 void push(const std::string &value);
 
-                const StackValue pop();
+                StackValue pop();
 
                 int popInteger();
 
                 float popFloat();
 
-                std::string popString();
+                const std::string &popString();
 
                 Game::Object *popObject();
 
                 bool popLogical();
 
-                const StackValue top();
+                StackValue top();
 
                 std::vector<StackValue> *values();
 
+                const std::vector<StackValue> *values() const;
+
                 size_t size();
 
                 void swap();
 
             protected:
+                // storage taken from stacks destroyed before, so new scripts start with reserved stacks
                 std::vector<StackValue> _values;
         };
     }
@@ -2,6 +2,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include "../Game/Object.h"
 #include "../VM/ErrorException.h"
 #include "../VM/StackValue.h"
@@ -10,6 +11,19 @@ namespace Falltergeist
 {
     namespace VM
     {
+        static_assert(std::is_trivially_copyable<StackValue>::value, "stack values are copied as plain memory");
+        static_assert(sizeof(StackValue) <= 16, "stack values have to stay small");
+
+        uint32_t StackValue::intern(const std::string &value)
+        {
+            return Base::StringId(value).id();
+        }
+
+        const std::string &StackValue::string(uint32_t index)
+        {
+            return Base::StringId::fromId(index).str();
+        }
+
         StackValue::StackValue()
         {
             _type = Type::INTEGER;
@@ -31,7 +45,13 @@ namespace Falltergeist
         StackValue::StackValue(const std::string &value)
         {
             _type = Type::STRING;
-            _stringValue = value;
+            _stringIndex = intern(value);
+        }
+
+        StackValue::StackValue(Base::StringId value)
+        {
+            _type = Type::STRING;
+            _stringIndex = value.id();
         }
 
         StackValue::StackValue(Game::Object *value)
@@ -41,10 +61,6 @@ namespace Falltergeist
             _objectValue = value;
         }
 
-        StackValue::~StackValue()
-        {
-        }
-
         StackValue::Type StackValue::type() const
         {
             return _type;
@@ -73,13 +89,13 @@ namespace Falltergeist
             return _floatValue;
         }
 
-        std::string StackValue::stringValue() const
+        const std::string &StackValue::stringValue() const
         {
             if (_type != Type::STRING) {
                 throw ErrorException(
                     std::string("StackValue::stringValue() - stack value is not string, it is ") + typeName(_type));
             }
-            return _stringValue;
+            return string(_stringIndex);
         }
 
         Game::Object *StackValue::objectValue() const
@@ -105,7 +121,7 @@ namespace Falltergeist
                     return ss.str();
                 }
                 case Type::STRING:
-                    return _stringValue;
+                    return string(_stringIndex);
                 case Type::OBJECT:
                     return _objectValue ? _objectValue->name() : std::string(
                             "(null)"); // just in case, we should never create null object value
@@ -125,7 +141,7 @@ namespace Falltergeist
                 case Type::STRING: {
                     int result = 0;
                     try {
-                        result = std::stoi(_stringValue, nullptr, 0);
+                        result = std::stoi(string(_stringIndex), nullptr, 0);
                     }
                     catch (const std::invalid_argument &) {}
                     catch (const std::out_of_range &) {}
@@ -146,7 +162,7 @@ namespace Falltergeist
                 case Type::FLOAT:
                     return (bool) _floatValue;
                 case Type::STRING:
-                    return _stringValue.length() > 0;
+                    return !string(_stringIndex).empty();
                 case Type::OBJECT:
                     return _objectValue != nullptr;
             }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include "../Base/StringId.h"
 
 namespace Falltergeist
 {
@@ -10,10 +12,14 @@ namespace Falltergeist
     }
     namespace VM
     {
+        /**
+         * StackValue is a 16 byte tagged value, copied around as plain memory
+         * Strings are interned and referred to by their id in the engine string table, which is never shrunk
+         */
         class StackValue
         {
             public:
-                enum class Type
+                enum class Type : uint32_t
                 {
                     INTEGER = 1,
                     FLOAT,
@@ -29,9 +35,9 @@ namespace Falltergeist
 
                 StackValue(const std::string &value);
 
-                StackValue(Game::Object *value);
+                StackValue(Base::StringId value);
 
-                virtual ~StackValue();
+                StackValue(Game::Object *value);
 
                 Type type() const;
 
@@ -44,7 +50,7 @@ namespace Falltergeist
                 float floatValue() const;
 
                 // returns string value or throws exception if it's not string
-                std::string stringValue() const;
+                const std::string &stringValue() const;
 
                 // returns object pointer or throws exception if it's not object
                 Game::Object *objectValue() const;
@@ -61,14 +67,19 @@ namespace Falltergeist
 
                 static const char *typeName(Type type);
 
+                // Id of the string in the string table, equal strings share it
+                static uint32_t intern(const std::string &value);
+
+                static const std::string &string(uint32_t index);
+
             protected:
                 Type _type = Type::INTEGER;
                 union {
                     int32_t _intValue;
                     float _floatValue;
                     Game::Object *_objectValue;
+                    uint32_t _stringIndex;
                 };
-                std::string _stringValue;
         };
     }
 }
@@ -0,0 +1,181 @@
+#include <cstdio>
+#include <set>
+#include <sstream>
+#include <vector>
+#include "../Format/Int/File.h"
+#include "../Format/Int/Procedure.h"
+#include "../VM/OpcodeFactory.h"
+#include "../VM/Translator.h"
+
+namespace Falltergeist
+{
+    namespace VM
+    {
+        namespace
+        {
+            std::string hex(uint64_t value)
+            {
+                char buffer[24];
+                std::snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(value));
+                return buffer;
+            }
+
+            // offset of the instruction run after the one at offset, when it doesn't jump
+            size_t nextOffset(const Format::Int::File::Instruction& instruction, size_t offset)
+            {
+                // a fused push also runs the opcode after it
+                return offset + instruction.length + (instruction.fused ? 2 : 0);
+            }
+
+            // opcodes have the highest bit set, anything else is data following the code
+            bool isOpcode(const Format::Int::File::Instruction& instruction)
+            {
+                return (instruction.opcode & 0x8000) != 0 && OpcodeFactory::slot(instruction.opcode) != OpcodeFactory::SLOTS;
+            }
+        }
+
+        std::string Translator::translate(const Format::Int::File& file, const std::string& name)
+        {
+            // every instruction reachable from the procedures without computed jumps
+            std::set<size_t> offsets;
+            std::set<size_t> jumpTargets;
+            std::vector<size_t> pending;
+            for (auto& procedure : file.procedures()) {
+                for (auto offset : {procedure.bodyOffset(), procedure.conditionOffset()}) {
+                    if (offset != 0) {
+                        pending.push_back(offset);
+                    }
+                }
+            }
+            const size_t end = file.size() > 1 ? file.size() - 1 : 0;
+            while (!pending.empty()) {
+                size_t offset = pending.back();
+                pending.pop_back();
+                while (offset < end && !offsets.count(offset)) {
+                    auto& instruction = file.instruction(offset);
+                    if (!isOpcode(instruction)) {
+                        break;
+                    }
+                    offsets.insert(offset);
+                    if (instruction.fused == 0xF005) {
+                        if (instruction.operand < end) {
+                            jumpTargets.insert(instruction.operand);
+                            pending.push_back(instruction.operand);
+                        }
+                        break;
+                    }
+                    offset = nextOffset(instruction, offset);
+                }
+            }
+
+            std::ostringstream out;
+            out << "// Translated from " << name << " by falltergeist_translate, translate the file again instead of editing this one\n";
+            out << "#include \"../../VM/NativeScripts.h\"\n";
+            out << "#include \"../../VM/Script.h\"\n";
+            out << "#include \"../../VM/Stack.h\"\n";
+            out << "#include \"../../VM/StackValue.h\"\n";
+            out << "\n";
+            out << "namespace Falltergeist\n";
+            out << "{\n";
+            out << "    namespace VM\n";
+            out << "    {\n";
+            out << "        namespace\n";
+            out << "        {\n";
+            out << "            void run(Script& script)\n";
+            out << "            {\n";
+            out << "                while (true) {\n";
+            out << "                    switch (script.programCounter()) {\n";
+
+            const std::string indent = "                            ";
+            for (auto it = offsets.begin(); it != offsets.end(); ++it) {
+                size_t offset = *it;
+                auto& instruction = file.instruction(offset);
+                size_t next = nextOffset(instruction, offset);
+
+                out << "                        case " << hex(offset) << ":";
+                if (jumpTargets.count(offset)) {
+                    out << " l" << hex(offset) << ":";
+                }
+                out << "\n";
+
+                bool jumped = false;
+                switch (instruction.fused ? instruction.fused : instruction.opcode) {
+                    case 0xC001: // push_d integer
+                        out << indent << "script.dataStack()->push(StackValue(static_cast<int>(" << instruction.operand << "u)));\n";
+                        out << indent << "script.setProgramCounter(" << hex(next) << ");\n";
+                        break;
+                    case 0xA001: // push_d float
+                        out << indent << "script.dataStack()->push(StackValue(NativeScripts::floatFromBits(" << hex(instruction.operand) << ")));\n";
+                        out << indent << "script.setProgramCounter(" << hex(next) << ");\n";
+                        break;
+                    case 0xF001: // push_d integer, op_fetch
+                        out << indent << "script.dataStack()->push(script.dataStack()->values()->at(script.DVARbase() + " << instruction.operand << "));\n";
+                        out << indent << "script.setProgramCounter(" << hex(next) << ");\n";
+                        break;
+                    case 0xF002: // push_d integer, op_store
+                        out << indent << "{\n";
+                        out << indent << "    auto stored = script.dataStack()->pop();\n";
+                        out << indent << "    script.dataStack()->values()->at(script.DVARbase() + " << instruction.operand << ") = stored;\n";
+                        out << indent << "}\n";
+                        out << indent << "script.setProgramCounter(" << hex(next) << ");\n";
+                        break;
+                    case 0xF003: // push_d integer, op_fetch_global
+                        out << indent << "script.dataStack()->push(script.dataStack()->values()->at(script.SVARbase() + " << instruction.operand << "));\n";
+                        out << indent << "script.setProgramCounter(" << hex(next) << ");\n";
+                        break;
+                    case 0xF004: // push_d integer, op_store_global
+                        out << indent << "{\n";
+                        out << indent << "    auto stored = script.dataStack()->pop();\n";
+                        out << indent << "    script.dataStack()->values()->at(script.SVARbase() + " << instruction.operand << ") = stored;\n";
+                        out << indent << "}\n";
+                        out << indent << "script.setProgramCounter(" << hex(next) << ");\n";
+                        break;
+                    case 0xF005: // push_d integer, op_jmp
+                        // run by the interpreter, it counts it against the deadline of the procedure
+                        out << indent << "if (!script.step()) {\n";
+                        out << indent << "    return;\n";
+                        out << indent << "}\n";
+                        if (jumpTargets.count(instruction.operand)) {
+                            out << indent << "goto l" << hex(instruction.operand) << ";\n";
+                        } else {
+                            out << indent << "continue;\n";
+                        }
+                        jumped = true;
+                        break;
+                    default:
+                        out << indent << "if (!script.step()) {\n";
+                        out << indent << "    return;\n";
+                        out << indent << "}\n";
+                        out << indent << "if (script.programCounter() != " << hex(next) << ") {\n";
+                        out << indent << "    continue;\n";
+                        out << indent << "}\n";
+                        break;
+                }
+
+                if (!jumped) {
+                    auto following = std::next(it);
+                    if (following != offsets.end() && *following == next) {
+                        out << indent << "[[fallthrough]];\n";
+                    } else {
+                        out << indent << "continue;\n";
+                    }
+                }
+            }
+
+            out << "                        default:\n";
+            out << "                            if (!script.step()) {\n";
+            out << "                                return;\n";
+            out << "                            }\n";
+            out << "                            break;\n";
+            out << "                    }\n";
+            out << "                }\n";
+            out << "            }\n";
+            out << "\n";
+            out << "            const NativeScripts::Registration registration(" << hex(file.hash()) << "ull, &run);\n";
+            out << "        }\n";
+            out << "    }\n";
+            out << "}\n";
+            return out.str();
+        }
+    }
+}
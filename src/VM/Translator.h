@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+namespace Falltergeist
+{
+    namespace Format
+    {
+        namespace Int
+        {
+            class File;
+        }
+    }
+
+    namespace VM
+    {
+        /**
+         * Translator turns the bytecode of an .INT file into C++ for VM::NativeScripts.
+         * Instructions reached from the procedures become cases of a switch on the program counter which follow each other
+         * like the instructions do. Pushes and the fused variable opcodes are inlined, every other opcode runs its handler
+         * through Script::step(), so errors, halts, suspension and the profiler of those work like in the interpreter.
+         * Jumps to computed offsets and offsets the translation didn't reach are interpreted.
+         */
+        class Translator final
+        {
+            public:
+                // name is the file name of the script, for the comments of the source
+                static std::string translate(const Format::Int::File& file, const std::string& name);
+        };
+    }
+}
@@ -0,0 +1,70 @@
+// Translates .INT scripts of the game data into C++ for VM::NativeScripts, built on demand:
+//     cmake --build . --target falltergeist_translate
+//     falltergeist_translate [--output directory] [script]...
+// Scripts are the names of scripts.lst (like "artemple.int"), all of them without any. Every translation is written to
+// <directory>/<script>.cpp, src/VM/Native by default, and compiled into the game on the next build.
+// A translation only matches the exact file it was made from, scripts changed by mods are interpreted.
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../src/Exception.h"
+#include "../src/Format/Int/File.h"
+#include "../src/Format/Lst/File.h"
+#include "../src/Logger.h"
+#include "../src/ResourceManager.h"
+#include "../src/VM/Translator.h"
+
+using namespace Falltergeist;
+
+int main(int argc, char* argv[])
+{
+    Logger::setLevel(Logger::Level::LOG_WARNING);
+
+    std::string output = "src/VM/Native";
+    std::vector<std::string> scripts;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argument.rfind("--", 0) == 0) {
+            std::cerr << "Usage: " << argv[0] << " [--output directory] [script]..." << std::endl;
+            return 1;
+        } else {
+            scripts.push_back(argument);
+        }
+    }
+
+    try {
+        if (scripts.empty()) {
+            auto lst = ResourceManager::getInstance()->lstFileType("scripts/scripts.lst");
+            if (!lst) {
+                throw Exception("No scripts/scripts.lst in the game data");
+            }
+            scripts = *lst->strings();
+        }
+
+        size_t translated = 0;
+        for (auto& name : scripts) {
+            auto file = ResourceManager::getInstance()->intFileType("scripts/" + name);
+            if (!file) {
+                std::cerr << "Skipping " << name << ": not in the game data" << std::endl;
+                continue;
+            }
+            std::string path = output + "/" + name.substr(0, name.rfind('.')) + ".cpp";
+            std::ofstream stream(path, std::ios::binary);
+            if (!stream) {
+                throw Exception("Can't write " + path);
+            }
+            stream << VM::Translator::translate(*file, name);
+            translated++;
+        }
+        std::cout << translated << " scripts translated into " << output << std::endl;
+    } catch (const Exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    ResourceManager::getInstance()->shutdown();
+    return 0;
+}